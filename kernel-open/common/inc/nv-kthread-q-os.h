@@ -29,6 +29,8 @@
 #include <linux/sched.h>            // task_struct
 #include <linux/numa.h>             // NUMA_NO_NODE
 #include <linux/semaphore.h>
+#include <linux/wait.h>             // wait_queue_head_t
+#include <linux/mutex.h>
 
 #include "conftest.h"
 
@@ -52,6 +54,65 @@ struct nv_kthread_q_item
     struct list_head q_list_node;
     nv_q_func_t function_to_run;
     void *function_args;
+
+    // CPU hint used by nv_kthread_q_pool to pick the worker the item is
+    // queued to. Ignored by single-threaded nv_kthread_q instances.
+    int preferred_cpu;
+
+    // Set while the item is queued in one of the workers of a pool. The item
+    // can migrate between worker lists when it is stolen, so the pending state
+    // cannot be derived from the list node under a single worker's lock.
+    atomic_t is_pool_pending;
+};
+
+struct nv_kthread_q_pool_worker
+{
+    struct list_head q_list_head;
+    spinlock_t q_lock;
+
+    // Number of items in q_list_head. Read without the lock by idle workers
+    // looking for something to steal.
+    atomic_t num_items;
+
+    // Set while the worker is sleeping waiting for items
+    atomic_t is_idle;
+
+    // Set by schedulers that found another worker on the node busy, to wake
+    // this worker up so it steals the new item.
+    atomic_t steal_pending;
+
+    wait_queue_head_t q_wait;
+
+    struct task_struct *q_kthread;
+
+    nv_kthread_q_pool_t *pool;
+
+    // CPU this worker serves, and its NUMA node. Only workers on the same
+    // node steal from each other.
+    int cpu;
+    int node;
+
+    // Item used by nv_kthread_q_pool_flush. Flushes are serialized by the
+    // pool's flush_lock, so a single item per worker is enough.
+    nv_kthread_q_item_t flush_q_item;
+};
+
+struct nv_kthread_q_pool
+{
+    struct nv_kthread_q_pool_worker *workers;
+    unsigned num_workers;
+
+    // Maps each possible CPU to the index of the worker whose sub-queue items
+    // from, or with an affinity hint for, that CPU are added to.
+    unsigned *cpu_to_worker;
+
+    atomic_t main_loop_should_exit;
+
+    // Flush rendezvous state. See nv_kthread_q_pool_flush.
+    struct mutex flush_lock;
+    atomic_t flush_remaining;
+    atomic_t flush_generation;
+    wait_queue_head_t flush_wait;
 };
 
 
@@ -61,4 +122,6 @@ struct nv_kthread_q_item
 
 #define NV_KTHREAD_NO_NODE NUMA_NO_NODE
 
+#define NV_KTHREAD_NO_CPU (-1)
+
 #endif
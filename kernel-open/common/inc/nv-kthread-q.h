@@ -26,8 +26,10 @@
 
 struct nv_kthread_q;
 struct nv_kthread_q_item;
+struct nv_kthread_q_pool;
 typedef struct nv_kthread_q nv_kthread_q_t;
 typedef struct nv_kthread_q_item nv_kthread_q_item_t;
+typedef struct nv_kthread_q_pool nv_kthread_q_pool_t;
 
 typedef void (*nv_q_func_t)(void *args);
 
@@ -84,6 +86,18 @@ typedef void (*nv_q_func_t)(void *args);
 //    The nv_kthread_q_stop() routine will flush the queue, and safely stop
 //    the kthread, before returning.
 //
+// 5. Worker pools
+//
+//    A single nv_kthread_q is serviced by one kthread, which becomes the
+//    bottleneck when many CPUs schedule items at once. nv_kthread_q_pool is a
+//    multi-worker variant: each worker kthread owns a sub-queue, items are
+//    added to the sub-queue of the worker serving the CPU they are scheduled
+//    from (or the CPU given by nv_kthread_q_item_set_affinity()), and idle
+//    workers steal items from busy workers on the same NUMA node.
+//
+//    Items scheduled on a pool may run concurrently with each other, and in
+//    any order. Use a plain nv_kthread_q when ordering matters.
+//
 ////////////////////////////////////////////////////////////////////////////////
 
 //
@@ -199,6 +213,70 @@ void nv_kthread_q_item_init(nv_kthread_q_item_t *q_item,
 int nv_kthread_q_schedule_q_item(nv_kthread_q_t *q,
                                  nv_kthread_q_item_t *q_item);
 
+//
+// Initializes a worker pool. The pool gets one worker per online CPU of
+// preferred_node, or one per online CPU if preferred_node is
+// NV_KTHREAD_NO_NODE, capped to max_workers if max_workers is not zero.
+// Workers on a node are restricted to run on that node's CPUs, and their
+// stacks are preferably allocated on it.
+//
+// Each worker kthread is named "<qname>/<worker index>".
+//
+// Returns zero on success, or a negative errno on failure. It is safe to call
+// nv_kthread_q_pool_stop() on a pool that nv_kthread_q_pool_init_on_node()
+// failed for.
+//
+int nv_kthread_q_pool_init_on_node(nv_kthread_q_pool_t *pool,
+                                   const char *qname,
+                                   int preferred_node,
+                                   unsigned max_workers);
+
+//
+// Same as nv_kthread_q_pool_init_on_node() with NV_KTHREAD_NO_NODE.
+//
+int nv_kthread_q_pool_init(nv_kthread_q_pool_t *pool, const char *qname, unsigned max_workers);
+
+//
+// Flushes the pool and stops all of its workers. The rules are the same as for
+// nv_kthread_q_stop(). Calling it on a zero-initialized pool is a no-op.
+//
+void nv_kthread_q_pool_stop(nv_kthread_q_pool_t *pool);
+
+//
+// All items that were scheduled on the pool before nv_kthread_q_pool_flush was
+// called, and all items scheduled by those items, will have finished running
+// before this function returns. As with nv_kthread_q_flush(), the pool is
+// flushed twice so that self-rescheduling items can be stopped safely.
+//
+// The flush is a rendezvous: each worker stops taking new items once it reaches
+// the flush marker in its own sub-queue, until every worker has reached its
+// marker. Concurrent flushes of the same pool are serialized. This routine
+// must not be called from an item running on the same pool.
+//
+void nv_kthread_q_pool_flush(nv_kthread_q_pool_t *pool);
+
+//
+// Same semantics as nv_kthread_q_schedule_q_item(), for pools. The item is
+// added to the sub-queue of the worker serving its preferred CPU, if set, or
+// else the current CPU. It may then be stolen by another worker on the same
+// NUMA node.
+//
+// A q_item must not be scheduled on a pool and on a plain nv_kthread_q at the
+// same time.
+//
+int nv_kthread_q_pool_schedule_q_item(nv_kthread_q_pool_t *pool,
+                                      nv_kthread_q_item_t *q_item);
+
+//
+// Sets the CPU whose pool worker should preferably run the q_item. This is a
+// hint: the item can still be stolen by another worker on the same NUMA node,
+// and it is ignored by plain nv_kthread_q instances. Pass NV_KTHREAD_NO_CPU to
+// clear it. nv_kthread_q_item_init() clears the hint.
+//
+// Must not be called while the q_item is pending.
+//
+void nv_kthread_q_item_set_affinity(nv_kthread_q_item_t *q_item, int cpu);
+
 // Built-in test. Returns -1 if any subtest failed, or 0 upon success.
 int nv_kthread_q_run_self_test(void);
 
@@ -397,6 +397,33 @@ NV_STATUS nvUvmInterfacePmaAllocPages(void *pPma,
                                       UvmPmaAllocationOptions *pPmaAllocOptions,
                                       NvU64 *pPages);
 
+/*******************************************************************************
+    nvUvmInterfacePmaAllocPagesBatch
+
+    @brief Synchronous API for allocating pages from the PMA for several
+    requests at once. Each request may use a different page size and options.
+
+    Requests that fit in free memory are allocated under a single hold of the
+    PMA lock. The remaining requests are serviced one by one as if they were
+    passed to nvUvmInterfacePmaAllocPages, including eviction unless
+    prohibited by UVM_PMA_ALLOCATE_DONT_EVICT.
+
+    Arguments:
+        pPma[IN]             - Pointer to PMA object
+        pRequests[IN/OUT]    - Array of requests. Each request takes the same
+                               inputs as nvUvmInterfacePmaAllocPages, and its
+                               status field is set to the result of the
+                               request.
+        requestCount[IN]     - Number of requests in pRequests.
+
+    Error codes:
+        NV_OK if all the requests succeeded, or the status of the first request
+        that failed.
+*/
+NV_STATUS nvUvmInterfacePmaAllocPagesBatch(void *pPma,
+                                           UvmPmaAllocationRequest *pRequests,
+                                           NvLength requestCount);
+
 /*******************************************************************************
     nvUvmInterfacePmaPinPages
 
@@ -467,6 +494,24 @@ void nvUvmInterfacePmaFreePages(void *pPma,
                                 NvU64 pageSize,
                                 NvU32 flags);
 
+/*******************************************************************************
+    nvUvmInterfacePmaFreePagesBatch
+
+    This function frees several lists of pages allocated using PMA under a
+    single hold of the PMA lock. Physically contiguous pages are marked free as
+    a single range. This function does not fail, and must not be called from
+    PMA eviction.
+
+    Arguments:
+        pPma[IN]             - Pointer to PMA object
+        pRequests[IN]        - Array of requests. Each request takes the same
+                               inputs as nvUvmInterfacePmaFreePages.
+        requestCount[IN]     - Number of requests in pRequests.
+*/
+void nvUvmInterfacePmaFreePagesBatch(void *pPma,
+                                     UvmPmaFreeRequest *pRequests,
+                                     NvLength requestCount);
+
 /*******************************************************************************
     nvUvmInterfaceMemoryCpuMap
 
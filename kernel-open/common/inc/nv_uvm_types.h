@@ -757,6 +757,28 @@ typedef struct UvmPmaAllocationOptions_tag
     NvU32 resultFlags;          // valid if the allocation function returns NV_OK
 } UvmPmaAllocationOptions;
 
+// A single request of nvUvmInterfacePmaAllocPagesBatch. pageCount, pageSize,
+// options and pPages have the same meaning as the arguments of
+// nvUvmInterfacePmaAllocPages, and status holds the result of the request.
+typedef struct UvmPmaAllocationRequest_tag
+{
+    NvLength pageCount;
+    NvU64 pageSize;
+    UvmPmaAllocationOptions options;
+    NvU64 *pPages;
+    NV_STATUS status;
+} UvmPmaAllocationRequest;
+
+// A single request of nvUvmInterfacePmaFreePagesBatch, with the same meaning
+// as the arguments of nvUvmInterfacePmaFreePages.
+typedef struct UvmPmaFreeRequest_tag
+{
+    NvU64 *pPages;
+    NvLength pageCount;
+    NvU64 pageSize;
+    NvU32 flags;
+} UvmPmaFreeRequest;
+
 /*******************************************************************************
     uvmEventSuspend
     This function will be called by the GPU driver to signal to UVM that the
@@ -1108,6 +1130,8 @@ typedef UvmGpuPagingChannel *gpuPagingChannelHandle;
 typedef UvmGpuPagingChannelInfo gpuPagingChannelInfo;
 typedef UvmGpuPagingChannelAllocParams gpuPagingChannelAllocParams;
 typedef UvmPmaAllocationOptions gpuPmaAllocationOptions;
+typedef UvmPmaAllocationRequest gpuPmaAllocationRequest;
+typedef UvmPmaFreeRequest gpuPmaFreeRequest;
 typedef UvmGpuAccessBitsBufferAlloc gpuAccessBitsBufferAlloc;
 
 typedef struct UvmCslIv
@@ -29,6 +29,10 @@
 #include <linux/module.h>
 #include <linux/mm.h>
 #include <linux/bug.h>
+#include <linux/slab.h>
+#include <linux/cpumask.h>
+#include <linux/topology.h>
+#include <linux/wait.h>
 
 // Today's implementation is a little simpler and more limited than the
 // API description allows for in nv-kthread-q.h. Details include:
@@ -41,6 +45,10 @@
 // named kernel thread (kthread). You can then insert arbitrary functions
 // into the queue, and those functions will be run in the context of the
 // queue's kthread.
+//
+// nv_kthread_q_pool instances are serviced by several kthreads, each owning a
+// first-in, first-out sub-queue. Idle workers steal from the head of the
+// sub-queues of other workers on the same NUMA node.
 
 #define NVQ_WARN(fmt, ...)                                   \
     do {                                                     \
@@ -153,7 +161,7 @@ void nv_kthread_q_stop(nv_kthread_q_t *q)
 // This function is never invoked when there is no NUMA preference (preferred
 // node is NUMA_NO_NODE).
 static struct task_struct *thread_create_on_node(int (*threadfn)(void *data),
-                                                 nv_kthread_q_t *q,
+                                                 void *data,
                                                  int preferred_node,
                                                  const char *q_name)
 {
@@ -165,7 +173,7 @@ static struct task_struct *thread_create_on_node(int (*threadfn)(void *data),
     for (i = 0;; i++) {
         struct page *stack;
 
-        thread[i] = kthread_create_on_node(threadfn, q, preferred_node, q_name);
+        thread[i] = kthread_create_on_node(threadfn, data, preferred_node, q_name);
 
         if (unlikely(IS_ERR(thread[i]))) {
 
@@ -264,6 +272,13 @@ void nv_kthread_q_item_init(nv_kthread_q_item_t *q_item,
     INIT_LIST_HEAD(&q_item->q_list_node);
     q_item->function_to_run = function_to_run;
     q_item->function_args   = function_args;
+    q_item->preferred_cpu   = NV_KTHREAD_NO_CPU;
+    atomic_set(&q_item->is_pool_pending, 0);
+}
+
+void nv_kthread_q_item_set_affinity(nv_kthread_q_item_t *q_item, int cpu)
+{
+    q_item->preferred_cpu = cpu;
 }
 
 // Returns true (non-zero) if the q_item got scheduled, false otherwise.
@@ -315,3 +330,388 @@ void nv_kthread_q_flush(nv_kthread_q_t *q)
     _raw_q_flush(q);
     _raw_q_flush(q);
 }
+
+// Pops the first item of the worker's sub-queue. Flush items have to be run by
+// the worker they were queued to, so a thief leaves the sub-queue alone when
+// its head is the worker's flush item.
+static nv_kthread_q_item_t *_pool_worker_pop(struct nv_kthread_q_pool_worker *worker, bool is_steal)
+{
+    nv_kthread_q_item_t *q_item = NULL;
+    unsigned long flags;
+
+    if (atomic_read(&worker->num_items) == 0)
+        return NULL;
+
+    spin_lock_irqsave(&worker->q_lock, flags);
+
+    if (!list_empty(&worker->q_list_head)) {
+        q_item = list_first_entry(&worker->q_list_head,
+                                  nv_kthread_q_item_t,
+                                  q_list_node);
+
+        if (is_steal && q_item == &worker->flush_q_item) {
+            q_item = NULL;
+        }
+        else {
+            list_del_init(&q_item->q_list_node);
+            atomic_dec(&worker->num_items);
+        }
+    }
+
+    spin_unlock_irqrestore(&worker->q_lock, flags);
+
+    return q_item;
+}
+
+static nv_kthread_q_item_t *_pool_worker_steal(struct nv_kthread_q_pool_worker *worker)
+{
+    nv_kthread_q_pool_t *pool = worker->pool;
+    unsigned self = worker - pool->workers;
+    unsigned i;
+
+    for (i = 1; i < pool->num_workers; i++) {
+        struct nv_kthread_q_pool_worker *victim = &pool->workers[(self + i) % pool->num_workers];
+        nv_kthread_q_item_t *q_item;
+
+        if (victim->node != worker->node)
+            continue;
+
+        q_item = _pool_worker_pop(victim, true);
+        if (q_item)
+            return q_item;
+    }
+
+    return NULL;
+}
+
+static int _pool_main_loop(void *args)
+{
+    struct nv_kthread_q_pool_worker *worker = (struct nv_kthread_q_pool_worker *)args;
+    nv_kthread_q_pool_t *pool = worker->pool;
+
+    while (1) {
+        nv_kthread_q_item_t *q_item = _pool_worker_pop(worker, false);
+
+        if (!q_item)
+            q_item = _pool_worker_steal(worker);
+
+        if (!q_item) {
+            if (atomic_read(&pool->main_loop_should_exit))
+                break;
+
+            atomic_set(&worker->is_idle, 1);
+
+            // Interruptible for the same reason as in _main_loop. A pending
+            // steal request is consumed by the wake up, since the items may
+            // have been taken by another thief by the time we look for them.
+            while (wait_event_interruptible(worker->q_wait,
+                                            atomic_read(&worker->num_items) ||
+                                            atomic_xchg(&worker->steal_pending, 0) ||
+                                            atomic_read(&pool->main_loop_should_exit)))
+                NVQ_WARN("Interrupted during pool worker wait\n");
+
+            atomic_set(&worker->is_idle, 0);
+            continue;
+        }
+
+        // Clear the pending state before running the item, so that it can be
+        // rescheduled from its own callback. The barrier orders the clear
+        // against the callback's reads of the state it was scheduled for.
+        atomic_set(&q_item->is_pool_pending, 0);
+        smp_mb();
+
+        q_item->function_to_run(q_item->function_args);
+    }
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return 0;
+}
+
+// The worker serving the CPU, else a worker on the CPU's node, else any worker.
+// CPUs without their own worker are spread across the candidates.
+static unsigned _pool_cpu_to_worker(nv_kthread_q_pool_t *pool, int cpu)
+{
+    int node = cpu_to_node(cpu);
+    unsigned num_node_workers = 0;
+    unsigned i, n;
+
+    for (i = 0; i < pool->num_workers; i++) {
+        if (pool->workers[i].cpu == cpu)
+            return i;
+
+        if (pool->workers[i].node == node)
+            num_node_workers++;
+    }
+
+    if (num_node_workers == 0)
+        return cpu % pool->num_workers;
+
+    n = cpu % num_node_workers;
+    for (i = 0; i < pool->num_workers; i++) {
+        if (pool->workers[i].node != node)
+            continue;
+
+        if (n == 0)
+            break;
+
+        n--;
+    }
+
+    return i;
+}
+
+// If the worker an item was just added to is busy, wake up an idle worker on
+// the same node so it can steal the item.
+static void _pool_wake_thief(struct nv_kthread_q_pool_worker *worker)
+{
+    nv_kthread_q_pool_t *pool = worker->pool;
+    unsigned self = worker - pool->workers;
+    unsigned i;
+
+    if (atomic_read(&worker->is_idle))
+        return;
+
+    for (i = 1; i < pool->num_workers; i++) {
+        struct nv_kthread_q_pool_worker *thief = &pool->workers[(self + i) % pool->num_workers];
+
+        if (thief->node != worker->node || !atomic_read(&thief->is_idle))
+            continue;
+
+        atomic_set(&thief->steal_pending, 1);
+        wake_up(&thief->q_wait);
+        break;
+    }
+}
+
+// Returns true (non-zero) if the item was actually scheduled, and false if the
+// item was already pending in the pool.
+static int _raw_pool_schedule(struct nv_kthread_q_pool_worker *worker, nv_kthread_q_item_t *q_item)
+{
+    unsigned long flags;
+
+    if (atomic_cmpxchg(&q_item->is_pool_pending, 0, 1) != 0)
+        return 0;
+
+    spin_lock_irqsave(&worker->q_lock, flags);
+    list_add_tail(&q_item->q_list_node, &worker->q_list_head);
+    atomic_inc(&worker->num_items);
+    spin_unlock_irqrestore(&worker->q_lock, flags);
+
+    wake_up(&worker->q_wait);
+    _pool_wake_thief(worker);
+
+    return 1;
+}
+
+int nv_kthread_q_pool_schedule_q_item(nv_kthread_q_pool_t *pool,
+                                      nv_kthread_q_item_t *q_item)
+{
+    int cpu = q_item->preferred_cpu;
+
+    if (unlikely(atomic_read(&pool->main_loop_should_exit) || !pool->workers)) {
+        NVQ_WARN("Not allowed: nv_kthread_q_pool_schedule_q_item was "
+                   "called with a non-alive pool: 0x%p\n", pool);
+        return 0;
+    }
+
+    if (cpu < 0 || cpu >= nr_cpu_ids)
+        cpu = raw_smp_processor_id();
+
+    return _raw_pool_schedule(&pool->workers[pool->cpu_to_worker[cpu]], q_item);
+}
+
+// Each worker runs this when it reaches its flush item, and waits until all
+// other workers have reached theirs. A worker takes no new items while it
+// waits, so once the last worker arrives every item queued ahead of any flush
+// item, including items stolen by other workers, has finished running.
+static void _pool_flush_function(void *args)
+{
+    nv_kthread_q_pool_t *pool = (nv_kthread_q_pool_t *)args;
+    int generation = atomic_read(&pool->flush_generation);
+
+    if (atomic_dec_and_test(&pool->flush_remaining)) {
+        atomic_inc(&pool->flush_generation);
+        wake_up_all(&pool->flush_wait);
+    }
+    else {
+        wait_event(pool->flush_wait, atomic_read(&pool->flush_generation) != generation);
+    }
+}
+
+static void _raw_pool_flush(nv_kthread_q_pool_t *pool)
+{
+    int generation;
+    unsigned i;
+
+    // Flush items from two concurrent flushes could be queued in a different
+    // order on different workers, which would deadlock the rendezvous.
+    mutex_lock(&pool->flush_lock);
+
+    generation = atomic_read(&pool->flush_generation);
+    atomic_set(&pool->flush_remaining, pool->num_workers);
+
+    for (i = 0; i < pool->num_workers; i++)
+        _raw_pool_schedule(&pool->workers[i], &pool->workers[i].flush_q_item);
+
+    wait_event(pool->flush_wait, atomic_read(&pool->flush_generation) != generation);
+
+    mutex_unlock(&pool->flush_lock);
+}
+
+void nv_kthread_q_pool_flush(nv_kthread_q_pool_t *pool)
+{
+    if (unlikely(atomic_read(&pool->main_loop_should_exit) || !pool->workers)) {
+        NVQ_WARN("Not allowed: nv_kthread_q_pool_flush was called after "
+                   "nv_kthread_q_pool_stop. pool: 0x%p\n", pool);
+        return;
+    }
+
+    // Flushed twice for the same reason as nv_kthread_q_flush
+    _raw_pool_flush(pool);
+    _raw_pool_flush(pool);
+}
+
+static void _pool_stop_workers(nv_kthread_q_pool_t *pool)
+{
+    unsigned i;
+
+    atomic_set(&pool->main_loop_should_exit, 1);
+
+    for (i = 0; i < pool->num_workers; i++) {
+        struct nv_kthread_q_pool_worker *worker = &pool->workers[i];
+
+        if (!worker->q_kthread)
+            continue;
+
+        wake_up(&worker->q_wait);
+        kthread_stop(worker->q_kthread);
+        worker->q_kthread = NULL;
+    }
+
+    kfree(pool->cpu_to_worker);
+    kfree(pool->workers);
+    pool->cpu_to_worker = NULL;
+    pool->workers = NULL;
+    pool->num_workers = 0;
+}
+
+void nv_kthread_q_pool_stop(nv_kthread_q_pool_t *pool)
+{
+    unsigned i;
+
+    // check if the pool has been properly initialized
+    if (unlikely(!pool->workers))
+        return;
+
+    nv_kthread_q_pool_flush(pool);
+
+    for (i = 0; i < pool->num_workers; i++) {
+        if (unlikely(atomic_read(&pool->workers[i].num_items)))
+            NVQ_WARN("worker %u list not empty after flushing\n", i);
+    }
+
+    _pool_stop_workers(pool);
+}
+
+int nv_kthread_q_pool_init_on_node(nv_kthread_q_pool_t *pool,
+                                   const char *q_name,
+                                   int preferred_node,
+                                   unsigned max_workers)
+{
+    const struct cpumask *cpus = cpu_online_mask;
+    unsigned num_workers = 0;
+    unsigned i;
+    int cpu;
+
+    memset(pool, 0, sizeof(*pool));
+
+    mutex_init(&pool->flush_lock);
+    init_waitqueue_head(&pool->flush_wait);
+
+    if (preferred_node != NV_KTHREAD_NO_NODE)
+        cpus = cpumask_of_node(preferred_node);
+
+    for_each_cpu_and(cpu, cpus, cpu_online_mask)
+        num_workers++;
+
+    // Nodes without CPUs (for example, GPU memory nodes) fall back to all
+    // online CPUs.
+    if (num_workers == 0) {
+        cpus = cpu_online_mask;
+        num_workers = num_online_cpus();
+    }
+
+    if (max_workers != 0 && num_workers > max_workers)
+        num_workers = max_workers;
+
+    pool->workers = kzalloc_node(num_workers * sizeof(*pool->workers), GFP_KERNEL, preferred_node);
+    pool->cpu_to_worker = kzalloc_node(nr_cpu_ids * sizeof(*pool->cpu_to_worker), GFP_KERNEL, preferred_node);
+    if (!pool->workers || !pool->cpu_to_worker) {
+        kfree(pool->cpu_to_worker);
+        kfree(pool->workers);
+        pool->cpu_to_worker = NULL;
+        pool->workers = NULL;
+
+        return -ENOMEM;
+    }
+
+    i = 0;
+    for_each_cpu_and(cpu, cpus, cpu_online_mask) {
+        struct nv_kthread_q_pool_worker *worker = &pool->workers[i];
+
+        INIT_LIST_HEAD(&worker->q_list_head);
+        spin_lock_init(&worker->q_lock);
+        init_waitqueue_head(&worker->q_wait);
+        worker->pool = pool;
+        worker->cpu = cpu;
+        worker->node = cpu_to_node(cpu);
+        nv_kthread_q_item_init(&worker->flush_q_item, _pool_flush_function, pool);
+
+        if (++i == num_workers)
+            break;
+    }
+
+    // CPUs may have gone offline since they were counted
+    pool->num_workers = i;
+    if (pool->num_workers == 0) {
+        _pool_stop_workers(pool);
+        return -ENODEV;
+    }
+
+    for_each_possible_cpu(cpu)
+        pool->cpu_to_worker[cpu] = _pool_cpu_to_worker(pool, cpu);
+
+    for (i = 0; i < pool->num_workers; i++) {
+        struct nv_kthread_q_pool_worker *worker = &pool->workers[i];
+        struct task_struct *thread;
+        char worker_name[TASK_COMM_LEN];
+
+        snprintf(worker_name, sizeof(worker_name), "%s/%u", q_name, i);
+
+        // Workers always have a node, so go through the same stack placement
+        // workaround as node-bound queues.
+        thread = thread_create_on_node(_pool_main_loop, worker, worker->node, worker_name);
+        if (IS_ERR(thread)) {
+            int err = PTR_ERR(thread);
+
+            _pool_stop_workers(pool);
+
+            return err;
+        }
+
+        // Keep each worker on its node, so that stealing stays node-local
+        set_cpus_allowed_ptr(thread, cpumask_of_node(worker->node));
+
+        worker->q_kthread = thread;
+        wake_up_process(thread);
+    }
+
+    return 0;
+}
+
+int nv_kthread_q_pool_init(nv_kthread_q_pool_t *pool, const char *qname, unsigned max_workers)
+{
+    return nv_kthread_q_pool_init_on_node(pool, qname, NV_KTHREAD_NO_NODE, max_workers);
+}
@@ -29,6 +29,9 @@
 #include <linux/module.h>
 #include <linux/cpumask.h>
 #include <linux/mm.h>
+#include <linux/sort.h>
+#include <linux/math64.h>
+#include <linux/ktime.h>
 
 // If NV_BUILD_MODULE_INSTANCES is not defined, do it here in order to avoid
 // build warnings/errors when including nv-linux.h as it expects the definition
@@ -79,6 +82,10 @@
 #define NUM_TEST_Q_ITEMS                (100 * 1000)
 #define NUM_TEST_KTHREADS               8
 #define NUM_Q_ITEMS_IN_MULTITHREAD_TEST (NUM_TEST_Q_ITEMS * NUM_TEST_KTHREADS)
+#define NUM_POOL_TEST_Q_ITEMS           (10 * 1000)
+#define NUM_BENCH_Q_ITEMS               (16 * 1024)
+#define NUM_BENCH_ITEMS_PER_FLUSH       1024
+#define NUM_BENCH_FLUSHES               (NUM_BENCH_Q_ITEMS / NUM_BENCH_ITEMS_PER_FLUSH)
 
 // This exists in order to have a function to place a breakpoint on:
 static void on_nvq_assert(void)
@@ -541,6 +548,410 @@ static int _check_cpu_affinity_test(void)
     return 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Worker pool tests
+
+typedef struct pool_test_args
+{
+    nv_kthread_q_pool_t *test_pool;
+    atomic_t            *test_wide_accumulator;
+    atomic_t             per_thread_accumulator;
+    atomic_t             wrong_node_count;
+    int                  result;
+} pool_test_args_t;
+
+typedef struct pool_test_item
+{
+    nv_kthread_q_item_t  q_item;
+    pool_test_args_t    *args;
+} pool_test_item_t;
+
+static void _pool_callback(void *args)
+{
+    pool_test_item_t *item = (pool_test_item_t *)args;
+    int preferred_cpu = item->q_item.preferred_cpu;
+
+    // Workers only run on the CPUs of their node, and only steal from workers
+    // on the same node, so items with an affinity hint must run on the hinted
+    // CPU's node.
+    if (preferred_cpu != NV_KTHREAD_NO_CPU && cpu_to_node(preferred_cpu) != numa_node_id())
+        atomic_inc(&item->args->wrong_node_count);
+
+    atomic_inc(item->args->test_wide_accumulator);
+    atomic_inc(&item->args->per_thread_accumulator);
+}
+
+static int _pool_q_kthread_function(void *args)
+{
+    int i;
+    int cpu = cpumask_first(cpu_online_mask);
+    pool_test_args_t *pool_args = (pool_test_args_t *)args;
+    pool_test_item_t *items;
+    size_t alloc_size = NUM_POOL_TEST_Q_ITEMS * sizeof(*items);
+
+    items = vmalloc(alloc_size);
+    if (!items) {
+        pool_args->result = -ENOMEM;
+        goto done;
+    }
+
+    memset(items, 0, alloc_size);
+
+    for (i = 0; i < NUM_POOL_TEST_Q_ITEMS; ++i) {
+        items[i].args = pool_args;
+        nv_kthread_q_item_init(&items[i].q_item, _pool_callback, &items[i]);
+
+        // Every other item carries an affinity hint, cycling through the
+        // online CPUs.
+        if (i & 1) {
+            nv_kthread_q_item_set_affinity(&items[i].q_item, cpu);
+            cpu = cpumask_next(cpu, cpu_online_mask);
+            if (cpu >= nr_cpu_ids)
+                cpu = cpumask_first(cpu_online_mask);
+        }
+
+        if (!nv_kthread_q_pool_schedule_q_item(pool_args->test_pool, &items[i].q_item))
+            pool_args->result = -EINVAL;
+    }
+
+    nv_kthread_q_pool_flush(pool_args->test_pool);
+
+    if (atomic_read(&pool_args->per_thread_accumulator) != NUM_POOL_TEST_Q_ITEMS) {
+        NVQ_TEST_PRINT("per_thread_count: Expected: %d, actual: %d\n",
+                       NUM_POOL_TEST_Q_ITEMS,
+                       atomic_read(&pool_args->per_thread_accumulator));
+        pool_args->result = -EINVAL;
+    }
+
+    if (atomic_read(&pool_args->wrong_node_count) != 0) {
+        NVQ_TEST_PRINT("%d items ran outside the node of their preferred CPU\n",
+                       atomic_read(&pool_args->wrong_node_count));
+        pool_args->result = -EINVAL;
+    }
+
+done:
+    if (items)
+        vfree(items);
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return pool_args->result;
+}
+
+static int _pool_multithreaded_test(void)
+{
+    int i, j;
+    int result = 0;
+    struct task_struct *kthreads[NUM_TEST_KTHREADS];
+    pool_test_args_t pool_args[NUM_TEST_KTHREADS];
+    nv_kthread_q_pool_t local_pool;
+    atomic_t local_accumulator;
+
+    memset(pool_args, 0, sizeof(pool_args));
+    memset(kthreads, 0, sizeof(kthreads));
+    atomic_set(&local_accumulator, 0);
+
+    result = nv_kthread_q_pool_init(&local_pool, "nvq_test_pool", 0);
+    TEST_CHECK_RET(result == 0);
+
+    for (i = 0; i < NUM_TEST_KTHREADS; ++i) {
+        pool_args[i].test_pool             = &local_pool;
+        pool_args[i].test_wide_accumulator = &local_accumulator;
+
+        kthreads[i] = kthread_run(_pool_q_kthread_function,
+                                  &pool_args[i],
+                                  "nvq_test_kthread");
+
+        if (IS_ERR(kthreads[i]))
+            goto failed;
+    }
+
+    for (i = 0; i < NUM_TEST_KTHREADS; ++i)
+        result |= kthread_stop(kthreads[i]);
+
+    nv_kthread_q_pool_stop(&local_pool);
+
+    TEST_CHECK_RET(atomic_read(&local_accumulator) == NUM_POOL_TEST_Q_ITEMS * NUM_TEST_KTHREADS);
+    return result;
+
+failed:
+    NVQ_TEST_PRINT("kthread_run[%d] failed: errno: %ld\n",
+                   i, PTR_ERR(kthreads[i]));
+
+    for (j = 0; j < i; ++j)
+        kthread_stop(kthreads[j]);
+
+    nv_kthread_q_pool_stop(&local_pool);
+    return -1;
+}
+
+typedef struct pool_resched_args
+{
+    nv_kthread_q_pool_t test_pool;
+    nv_kthread_q_item_t q_item;
+    atomic_t            accumulator;
+    atomic_t            stop_rescheduling_callbacks;
+    int                 test_failure;
+} pool_resched_args_t;
+
+static void _pool_reschedule_callback(void *args)
+{
+    pool_resched_args_t *resched_args = (pool_resched_args_t *)args;
+
+    atomic_inc(&resched_args->accumulator);
+
+    if (atomic_read(&resched_args->stop_rescheduling_callbacks) == 0) {
+        // Hop to another CPU each time, so the item moves between sub-queues
+        int cpu = cpumask_next(raw_smp_processor_id(), cpu_online_mask);
+
+        if (cpu >= nr_cpu_ids)
+            cpu = cpumask_first(cpu_online_mask);
+
+        nv_kthread_q_item_set_affinity(&resched_args->q_item, cpu);
+
+        if (!nv_kthread_q_pool_schedule_q_item(&resched_args->test_pool, &resched_args->q_item)) {
+            NVQ_TEST_PRINT("Failed to re-schedule\n");
+            resched_args->test_failure = 1;
+        }
+    }
+}
+
+static int _pool_reschedule_from_own_callback_test(void)
+{
+    int result;
+    pool_resched_args_t resched_args;
+
+    memset(&resched_args, 0, sizeof(resched_args));
+
+    result = nv_kthread_q_pool_init(&resched_args.test_pool, "nvq_test_pool", 0);
+    TEST_CHECK_RET(result == 0);
+
+    nv_kthread_q_item_init(&resched_args.q_item, _pool_reschedule_callback, &resched_args);
+
+    TEST_CHECK_RET(nv_kthread_q_pool_schedule_q_item(&resched_args.test_pool, &resched_args.q_item));
+
+    while (atomic_read(&resched_args.accumulator) < NUM_RESCHEDULE_CALLBACKS)
+        schedule();
+
+    atomic_set(&resched_args.stop_rescheduling_callbacks, 1);
+
+    nv_kthread_q_pool_stop(&resched_args.test_pool);
+
+    TEST_CHECK_RET(resched_args.test_failure == 0);
+    TEST_CHECK_RET(atomic_read(&resched_args.accumulator) >= NUM_RESCHEDULE_CALLBACKS);
+
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Enqueue and flush benchmarks
+//
+// NUM_TEST_KTHREADS producers are released at once, and each schedules
+// NUM_BENCH_Q_ITEMS items, flushing every NUM_BENCH_ITEMS_PER_FLUSH items.
+// The latency of every schedule and flush call is recorded, and the aggregate
+// throughput and tail latencies are printed for both a single-threaded queue
+// and a worker pool.
+
+typedef struct bench_args
+{
+    nv_kthread_q_t      *test_q;
+    nv_kthread_q_pool_t *test_pool;
+    struct completion   *start;
+    atomic_t            *accumulator;
+
+    // Slices of the benchmark-wide latency arrays owned by this producer
+    u64                 *enqueue_ns;
+    u64                 *flush_ns;
+    int                  result;
+} bench_args_t;
+
+static void _bench_callback(void *args)
+{
+    atomic_inc((atomic_t *)args);
+}
+
+static int _bench_kthread_function(void *args)
+{
+    int i;
+    bench_args_t *bench_args = (bench_args_t *)args;
+    nv_kthread_q_item_t *q_items;
+    size_t alloc_size = NUM_BENCH_Q_ITEMS * sizeof(*q_items);
+
+    q_items = vmalloc(alloc_size);
+    if (!q_items) {
+        bench_args->result = -ENOMEM;
+        wait_for_completion(bench_args->start);
+        goto done;
+    }
+
+    memset(q_items, 0, alloc_size);
+    for (i = 0; i < NUM_BENCH_Q_ITEMS; ++i)
+        nv_kthread_q_item_init(&q_items[i], _bench_callback, bench_args->accumulator);
+
+    wait_for_completion(bench_args->start);
+
+    for (i = 0; i < NUM_BENCH_Q_ITEMS; ++i) {
+        int was_scheduled;
+        u64 start = ktime_to_ns(ktime_get());
+
+        if (bench_args->test_pool)
+            was_scheduled = nv_kthread_q_pool_schedule_q_item(bench_args->test_pool, &q_items[i]);
+        else
+            was_scheduled = nv_kthread_q_schedule_q_item(bench_args->test_q, &q_items[i]);
+
+        bench_args->enqueue_ns[i] = ktime_to_ns(ktime_get()) - start;
+
+        if (!was_scheduled)
+            bench_args->result = -EINVAL;
+
+        if ((i + 1) % NUM_BENCH_ITEMS_PER_FLUSH == 0) {
+            start = ktime_to_ns(ktime_get());
+
+            if (bench_args->test_pool)
+                nv_kthread_q_pool_flush(bench_args->test_pool);
+            else
+                nv_kthread_q_flush(bench_args->test_q);
+
+            bench_args->flush_ns[i / NUM_BENCH_ITEMS_PER_FLUSH] = ktime_to_ns(ktime_get()) - start;
+        }
+    }
+
+done:
+    if (q_items)
+        vfree(q_items);
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return bench_args->result;
+}
+
+static int _bench_cmp_u64(const void *a, const void *b)
+{
+    u64 x = *(const u64 *)a;
+    u64 y = *(const u64 *)b;
+
+    if (x < y)
+        return -1;
+
+    return x > y;
+}
+
+static void _bench_print_latencies(const char *bench_name, const char *op_name, u64 *latencies_ns, size_t count)
+{
+    sort(latencies_ns, count, sizeof(*latencies_ns), _bench_cmp_u64, NULL);
+
+    NVQ_TEST_PRINT("%s: %s latency ns: p50 %llu, p99 %llu, p99.9 %llu, max %llu\n",
+                   bench_name,
+                   op_name,
+                   latencies_ns[count / 2],
+                   latencies_ns[div_u64((u64)count * 99, 100)],
+                   latencies_ns[div_u64((u64)count * 999, 1000)],
+                   latencies_ns[count - 1]);
+}
+
+static int _bench_run(const char *bench_name, nv_kthread_q_t *q, nv_kthread_q_pool_t *pool)
+{
+    int i;
+    int result = 0;
+    struct task_struct *kthreads[NUM_TEST_KTHREADS];
+    bench_args_t bench_args[NUM_TEST_KTHREADS];
+    u64 *enqueue_ns;
+    u64 *flush_ns;
+    u64 elapsed_ns;
+    atomic_t accumulator;
+    DECLARE_COMPLETION_ONSTACK(start);
+
+    enqueue_ns = vmalloc(NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS * sizeof(*enqueue_ns));
+    flush_ns = vmalloc(NUM_TEST_KTHREADS * NUM_BENCH_FLUSHES * sizeof(*flush_ns));
+    if (!enqueue_ns || !flush_ns) {
+        result = -ENOMEM;
+        goto out;
+    }
+
+    memset(bench_args, 0, sizeof(bench_args));
+    atomic_set(&accumulator, 0);
+
+    for (i = 0; i < NUM_TEST_KTHREADS; ++i) {
+        bench_args[i].test_q      = q;
+        bench_args[i].test_pool   = pool;
+        bench_args[i].start       = &start;
+        bench_args[i].accumulator = &accumulator;
+        bench_args[i].enqueue_ns  = enqueue_ns + i * NUM_BENCH_Q_ITEMS;
+        bench_args[i].flush_ns    = flush_ns + i * NUM_BENCH_FLUSHES;
+
+        kthreads[i] = kthread_run(_bench_kthread_function, &bench_args[i], "nvq_bench_kthread");
+        if (IS_ERR(kthreads[i])) {
+            NVQ_TEST_PRINT("kthread_run[%d] failed: errno: %ld\n", i, PTR_ERR(kthreads[i]));
+            result = -1;
+            break;
+        }
+    }
+
+    elapsed_ns = ktime_to_ns(ktime_get());
+    complete_all(&start);
+
+    while (i-- > 0)
+        result |= kthread_stop(kthreads[i]);
+
+    elapsed_ns = ktime_to_ns(ktime_get()) - elapsed_ns;
+
+    if (result != 0)
+        goto out;
+
+    if (atomic_read(&accumulator) != NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS) {
+        NVQ_TEST_PRINT("%s: Expected %d items to run, actual: %d\n",
+                       bench_name,
+                       NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS,
+                       atomic_read(&accumulator));
+        result = -1;
+        goto out;
+    }
+
+    NVQ_TEST_PRINT("%s: %d producers, %d items in %llu us: %llu items/s\n",
+                   bench_name,
+                   NUM_TEST_KTHREADS,
+                   NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS,
+                   div_u64(elapsed_ns, 1000),
+                   div64_u64((u64)NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS * NSEC_PER_SEC, elapsed_ns ? elapsed_ns : 1));
+
+    _bench_print_latencies(bench_name, "enqueue", enqueue_ns, NUM_TEST_KTHREADS * NUM_BENCH_Q_ITEMS);
+    _bench_print_latencies(bench_name, "flush", flush_ns, NUM_TEST_KTHREADS * NUM_BENCH_FLUSHES);
+
+out:
+    if (flush_ns)
+        vfree(flush_ns);
+
+    if (enqueue_ns)
+        vfree(enqueue_ns);
+
+    return result;
+}
+
+static int _enqueue_flush_benchmark(void)
+{
+    int result;
+    nv_kthread_q_t local_q;
+    nv_kthread_q_pool_t local_pool;
+
+    result = nv_kthread_q_init(&local_q, "nvq_bench_q");
+    TEST_CHECK_RET(result == 0);
+
+    result = _bench_run("single queue", &local_q, NULL);
+    nv_kthread_q_stop(&local_q);
+    TEST_CHECK_RET(result == 0);
+
+    result = nv_kthread_q_pool_init(&local_pool, "nvq_bench_pool", 0);
+    TEST_CHECK_RET(result == 0);
+
+    result = _bench_run("worker pool", NULL, &local_pool);
+    nv_kthread_q_pool_stop(&local_pool);
+    TEST_CHECK_RET(result == 0);
+
+    return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Top-level test entry point
 
@@ -563,5 +974,14 @@ int nv_kthread_q_run_self_test(void)
     result = _check_cpu_affinity_test();
     TEST_CHECK_RET(result == 0);
 
+    result = _pool_multithreaded_test();
+    TEST_CHECK_RET(result == 0);
+
+    result = _pool_reschedule_from_own_callback_test();
+    TEST_CHECK_RET(result == 0);
+
+    result = _enqueue_flush_benchmark();
+    TEST_CHECK_RET(result == 0);
+
     return 0;
 }
@@ -0,0 +1,314 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_batch_sort.h"
+#include "uvm_kvmalloc.h"
+
+// Use the bucketed radix sort to preprocess fault and access counter batches.
+// When disabled, batches are sorted with a comparison sort.
+static int uvm_perf_batch_radix_sort = 1;
+module_param(uvm_perf_batch_radix_sort, int, S_IRUGO);
+
+// Buckets with fewer items than this are sorted with insertion sort, which is
+// faster than the radix passes for short inputs
+#define BATCH_SORT_INSERTION_THRESHOLD 32
+
+#define BATCH_SORT_RADIX_SIZE (1 << UVM_BATCH_SORT_RADIX_BITS)
+#define BATCH_SORT_RADIX_MASK (BATCH_SORT_RADIX_SIZE - 1)
+
+bool uvm_batch_sort_enabled(void)
+{
+    return uvm_perf_batch_radix_sort != 0;
+}
+
+NV_STATUS uvm_batch_sort_init(uvm_batch_sort_t *batch_sort, NvU32 max_items)
+{
+    memset(batch_sort, 0, sizeof(*batch_sort));
+
+    batch_sort->items = uvm_kvmalloc(max_items * sizeof(*batch_sort->items));
+    batch_sort->scratch = uvm_kvmalloc(max_items * sizeof(*batch_sort->scratch));
+    if (!batch_sort->items || !batch_sort->scratch) {
+        uvm_batch_sort_deinit(batch_sort);
+        return NV_ERR_NO_MEMORY;
+    }
+
+    batch_sort->max_items = max_items;
+
+    return NV_OK;
+}
+
+void uvm_batch_sort_deinit(uvm_batch_sort_t *batch_sort)
+{
+    uvm_kvfree(batch_sort->items);
+    uvm_kvfree(batch_sort->scratch);
+    batch_sort->items = NULL;
+    batch_sort->scratch = NULL;
+    batch_sort->max_items = 0;
+}
+
+static NvU32 find_or_add_bucket(uvm_batch_sort_t *batch_sort, const uvm_va_space_t *va_space, NvU32 gpu_id)
+{
+    uvm_batch_sort_bucket_t *bucket;
+    NvU32 i;
+
+    if (batch_sort->num_buckets > 0) {
+        bucket = &batch_sort->buckets[batch_sort->last_bucket];
+        if (bucket->va_space == va_space && bucket->gpu_id == gpu_id)
+            return batch_sort->last_bucket;
+    }
+
+    for (i = 0; i < batch_sort->num_buckets; ++i) {
+        bucket = &batch_sort->buckets[i];
+        if (bucket->va_space == va_space && bucket->gpu_id == gpu_id)
+            return i;
+    }
+
+    if (batch_sort->num_buckets == UVM_BATCH_SORT_MAX_BUCKETS) {
+        batch_sort->overflow = true;
+        return 0;
+    }
+
+    bucket = &batch_sort->buckets[batch_sort->num_buckets];
+    bucket->va_space = va_space;
+    bucket->gpu_id = gpu_id;
+    bucket->count = 0;
+
+    return batch_sort->num_buckets++;
+}
+
+void uvm_batch_sort_add(uvm_batch_sort_t *batch_sort,
+                        void *entry,
+                        const uvm_va_space_t *va_space,
+                        NvU32 gpu_id,
+                        NvU64 key,
+                        NvU8 sub_key)
+{
+    uvm_batch_sort_item_t *item;
+    NvU32 bucket;
+
+    UVM_ASSERT(batch_sort->num_items < batch_sort->max_items);
+
+    if (batch_sort->overflow)
+        return;
+
+    bucket = find_or_add_bucket(batch_sort, va_space, gpu_id);
+    if (batch_sort->overflow)
+        return;
+
+    batch_sort->last_bucket = bucket;
+    ++batch_sort->buckets[bucket].count;
+
+    item = &batch_sort->items[batch_sort->num_items++];
+    item->key = key;
+    item->entry = entry;
+    item->bucket = bucket;
+    item->sub_key = sub_key;
+}
+
+static bool bucket_less(const uvm_batch_sort_bucket_t *a, const uvm_batch_sort_bucket_t *b)
+{
+    if (a->va_space != b->va_space)
+        return (uintptr_t)a->va_space < (uintptr_t)b->va_space;
+
+    return a->gpu_id < b->gpu_id;
+}
+
+// Compute the output offset of each bucket. Buckets are ordered by VA space
+// and GPU id.
+static void compute_bucket_offsets(uvm_batch_sort_t *batch_sort)
+{
+    NvU8 order[UVM_BATCH_SORT_MAX_BUCKETS];
+    NvU32 offset = 0;
+    NvU32 i;
+
+    BUILD_BUG_ON(UVM_BATCH_SORT_MAX_BUCKETS > 256);
+
+    // Insertion sort of the (few) buckets
+    for (i = 0; i < batch_sort->num_buckets; ++i) {
+        NvU32 j = i;
+
+        while (j > 0 && bucket_less(&batch_sort->buckets[i], &batch_sort->buckets[order[j - 1]])) {
+            order[j] = order[j - 1];
+            --j;
+        }
+
+        order[j] = i;
+    }
+
+    for (i = 0; i < batch_sort->num_buckets; ++i) {
+        uvm_batch_sort_bucket_t *bucket = &batch_sort->buckets[order[i]];
+
+        bucket->offset = offset;
+        offset += bucket->count;
+    }
+
+    UVM_ASSERT(offset == batch_sort->num_items);
+}
+
+static bool item_less(const uvm_batch_sort_item_t *a, const uvm_batch_sort_item_t *b)
+{
+    if (a->key != b->key)
+        return a->key < b->key;
+
+    return a->sub_key < b->sub_key;
+}
+
+// Stable insertion sort by (key, sub_key)
+static void insertion_sort(uvm_batch_sort_item_t *items, NvU32 count)
+{
+    NvU32 i;
+
+    for (i = 1; i < count; ++i) {
+        uvm_batch_sort_item_t item = items[i];
+        NvU32 j = i;
+
+        while (j > 0 && item_less(&item, &items[j - 1])) {
+            items[j] = items[j - 1];
+            --j;
+        }
+
+        items[j] = item;
+    }
+}
+
+// Pseudo-shift used to select the sub-key as the digit of a radix pass
+#define BATCH_SORT_SUB_KEY_PASS 64
+
+static NvU32 item_digit(const uvm_batch_sort_item_t *item, unsigned shift)
+{
+    if (shift == BATCH_SORT_SUB_KEY_PASS)
+        return item->sub_key;
+
+    return (item->key >> shift) & BATCH_SORT_RADIX_MASK;
+}
+
+// Stable counting sort pass of src into dst by the digit at the given shift
+static void radix_pass(uvm_batch_sort_t *batch_sort,
+                       const uvm_batch_sort_item_t *src,
+                       uvm_batch_sort_item_t *dst,
+                       NvU32 count,
+                       unsigned shift)
+{
+    NvU32 *histogram = batch_sort->histogram;
+    NvU32 sum = 0;
+    NvU32 i;
+
+    memset(histogram, 0, sizeof(batch_sort->histogram));
+
+    for (i = 0; i < count; ++i)
+        ++histogram[item_digit(&src[i], shift)];
+
+    for (i = 0; i < BATCH_SORT_RADIX_SIZE; ++i) {
+        NvU32 digit_count = histogram[i];
+
+        histogram[i] = sum;
+        sum += digit_count;
+    }
+
+    for (i = 0; i < count; ++i)
+        dst[histogram[item_digit(&src[i], shift)]++] = src[i];
+}
+
+// LSD radix sort of a bucket by (key, sub_key). Passes over digits that are
+// the same in all the items of the bucket are skipped, so sorting addresses
+// within a small VA region only takes a few passes. The sorted items end up
+// either in items or in scratch, and the function returns which one.
+static uvm_batch_sort_item_t *radix_sort_bucket(uvm_batch_sort_t *batch_sort,
+                                                uvm_batch_sort_item_t *items,
+                                                uvm_batch_sort_item_t *scratch,
+                                                NvU32 count)
+{
+    uvm_batch_sort_item_t *src = items;
+    uvm_batch_sort_item_t *dst = scratch;
+    NvU64 key_and = ~0ULL;
+    NvU64 key_or = 0;
+    NvU8 sub_key_and = 0xff;
+    NvU8 sub_key_or = 0;
+    NvU64 key_diff;
+    unsigned shift;
+    NvU32 i;
+
+    BUILD_BUG_ON(sizeof(items->sub_key) * 8 > UVM_BATCH_SORT_RADIX_BITS);
+
+    if (count < BATCH_SORT_INSERTION_THRESHOLD) {
+        insertion_sort(items, count);
+        return items;
+    }
+
+    for (i = 0; i < count; ++i) {
+        key_and &= items[i].key;
+        key_or |= items[i].key;
+        sub_key_and &= items[i].sub_key;
+        sub_key_or |= items[i].sub_key;
+    }
+
+    if (sub_key_and != sub_key_or) {
+        radix_pass(batch_sort, src, dst, count, BATCH_SORT_SUB_KEY_PASS);
+        swap(src, dst);
+    }
+
+    key_diff = key_and ^ key_or;
+    for (shift = 0; shift < 64; shift += UVM_BATCH_SORT_RADIX_BITS) {
+        if (((key_diff >> shift) & BATCH_SORT_RADIX_MASK) == 0)
+            continue;
+
+        radix_pass(batch_sort, src, dst, count, shift);
+        swap(src, dst);
+    }
+
+    return src;
+}
+
+bool uvm_batch_sort_end(uvm_batch_sort_t *batch_sort, void **entries)
+{
+    NvU32 i;
+
+    if (batch_sort->overflow)
+        return false;
+
+    compute_bucket_offsets(batch_sort);
+
+    // Stable scatter of the items into their buckets
+    for (i = 0; i < batch_sort->num_items; ++i) {
+        uvm_batch_sort_bucket_t *bucket = &batch_sort->buckets[batch_sort->items[i].bucket];
+
+        batch_sort->scratch[bucket->offset++] = batch_sort->items[i];
+    }
+
+    for (i = 0; i < batch_sort->num_buckets; ++i) {
+        uvm_batch_sort_bucket_t *bucket = &batch_sort->buckets[i];
+        NvU32 start = bucket->offset - bucket->count;
+        uvm_batch_sort_item_t *sorted;
+        NvU32 j;
+
+        sorted = radix_sort_bucket(batch_sort,
+                                   batch_sort->scratch + start,
+                                   batch_sort->items + start,
+                                   bucket->count);
+
+        for (j = 0; j < bucket->count; ++j)
+            entries[start + j] = sorted[j].entry;
+    }
+
+    return true;
+}
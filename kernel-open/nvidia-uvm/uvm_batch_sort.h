@@ -0,0 +1,132 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#ifndef __UVM_BATCH_SORT_H__
+#define __UVM_BATCH_SORT_H__
+
+#include "uvm_common.h"
+#include "uvm_forward_decl.h"
+
+// Preprocessing sort shared by the replayable fault and the access counter
+// servicing paths.
+//
+// Entries are first bucketed by (VA space, GPU), and then each bucket is
+// radix-sorted by key and sub-key. The resulting order is the same as the one
+// obtained with a comparison sort by (VA space pointer, GPU ID, key, sub-key),
+// but the sort is stable, so entries with the same key (duplicate faults or
+// notifications on the same address) remain adjacent in arrival order.
+//
+// Only a limited number of distinct (VA space, GPU) pairs is supported per
+// batch. uvm_batch_sort_end() returns false if the batch exceeded it, and the
+// caller must fall back to a comparison sort.
+
+#define UVM_BATCH_SORT_MAX_BUCKETS 64
+
+#define UVM_BATCH_SORT_RADIX_BITS 8
+
+typedef struct
+{
+    // Primary sort key within the bucket (i.e. address)
+    NvU64 key;
+
+    // Caller's entry
+    void *entry;
+
+    NvU16 bucket;
+
+    // Secondary sort key (i.e. access type)
+    NvU8 sub_key;
+} uvm_batch_sort_item_t;
+
+typedef struct
+{
+    const uvm_va_space_t *va_space;
+
+    NvU32 gpu_id;
+
+    // Number of items in the bucket
+    NvU32 count;
+
+    // Index of the first item of the bucket in the sorted output
+    NvU32 offset;
+} uvm_batch_sort_bucket_t;
+
+typedef struct
+{
+    // Arrays of max_items elements. scratch is used as the ping-pong buffer of
+    // the radix sort passes.
+    uvm_batch_sort_item_t *items;
+
+    uvm_batch_sort_item_t *scratch;
+
+    NvU32 max_items;
+
+    NvU32 num_items;
+
+    uvm_batch_sort_bucket_t buckets[UVM_BATCH_SORT_MAX_BUCKETS];
+
+    NvU32 num_buckets;
+
+    // Index in buckets of the bucket of the last added item. Entries usually
+    // come in runs of the same VA space and GPU.
+    NvU32 last_bucket;
+
+    // Set when more than UVM_BATCH_SORT_MAX_BUCKETS buckets were needed
+    bool overflow;
+
+    // Digit histogram of the current radix sort pass
+    NvU32 histogram[1 << UVM_BATCH_SORT_RADIX_BITS];
+} uvm_batch_sort_t;
+
+// Whether the batch sort is enabled (uvm_perf_batch_radix_sort module
+// parameter). Callers use a comparison sort otherwise.
+bool uvm_batch_sort_enabled(void);
+
+NV_STATUS uvm_batch_sort_init(uvm_batch_sort_t *batch_sort, NvU32 max_items);
+
+void uvm_batch_sort_deinit(uvm_batch_sort_t *batch_sort);
+
+// Start a new batch
+static void uvm_batch_sort_begin(uvm_batch_sort_t *batch_sort)
+{
+    batch_sort->num_items = 0;
+    batch_sort->num_buckets = 0;
+    batch_sort->last_bucket = 0;
+    batch_sort->overflow = false;
+}
+
+// Add an entry to the batch. va_space may be NULL, and gpu_id is the value of
+// the GPU id, or 0 if there is no GPU.
+void uvm_batch_sort_add(uvm_batch_sort_t *batch_sort,
+                        void *entry,
+                        const uvm_va_space_t *va_space,
+                        NvU32 gpu_id,
+                        NvU64 key,
+                        NvU8 sub_key);
+
+// Sort the batch and store the entries in sorted order in the entries array,
+// which must have room for all the added entries. Returns false, without
+// touching entries, if the batch cannot be sorted (see above).
+bool uvm_batch_sort_end(uvm_batch_sort_t *batch_sort, void **entries);
+
+#endif // __UVM_BATCH_SORT_H__
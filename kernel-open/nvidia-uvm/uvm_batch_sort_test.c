@@ -0,0 +1,214 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "linux/sort.h"
+#include "uvm_batch_sort.h"
+#include "uvm_common.h"
+#include "uvm_kvmalloc.h"
+#include "uvm_test.h"
+#include "uvm_test_rng.h"
+
+#define BATCH_SORT_BENCHMARK_MAX_ENTRIES (1 << 20)
+
+// Synthetic fault. va_space is never dereferenced.
+typedef struct
+{
+    const uvm_va_space_t *va_space;
+    NvU32 gpu_id;
+    NvU64 address;
+    uvm_fault_access_type_t access_type;
+} synthetic_fault_t;
+
+// Same order as cmp_sort_fault_entry_by_va_space_gpu_address_access_type
+static int cmp_synthetic_fault(const void *_a, const void *_b)
+{
+    const synthetic_fault_t *a = *(const synthetic_fault_t **)_a;
+    const synthetic_fault_t *b = *(const synthetic_fault_t **)_b;
+    int result;
+
+    result = UVM_CMP_DEFAULT(a->va_space, b->va_space);
+    if (result != 0)
+        return result;
+
+    result = UVM_CMP_DEFAULT(a->gpu_id, b->gpu_id);
+    if (result != 0)
+        return result;
+
+    result = UVM_CMP_DEFAULT(a->address, b->address);
+    if (result != 0)
+        return result;
+
+    return b->access_type - a->access_type;
+}
+
+// Generate a fault stream resembling the GPU fault buffer contents: runs of
+// faults on consecutive pages from the same VA space and GPU, interleaved with
+// faults from other VA spaces and GPUs.
+static void generate_faults(uvm_test_rng_t *rng,
+                            synthetic_fault_t *faults,
+                            const UVM_TEST_BATCH_SORT_BENCHMARK_PARAMS *params)
+{
+    NvU32 i;
+
+    for (i = 0; i < params->num_entries; ++i) {
+        synthetic_fault_t *fault = &faults[i];
+
+        if (i > 0 && uvm_test_rng_range_32(rng, 0, 3) != 0) {
+            *fault = faults[i - 1];
+            fault->address += PAGE_SIZE * uvm_test_rng_range_32(rng, 0, 1);
+        }
+        else {
+            NvU32 va_space_index = uvm_test_rng_range_32(rng, 0, params->num_va_spaces - 1);
+
+            fault->va_space = (const uvm_va_space_t *)(NvUPtr)((va_space_index + 1) * PAGE_SIZE);
+            fault->gpu_id = uvm_test_rng_range_32(rng, 1, params->num_gpus);
+            fault->address = UVM_SIZE_1GB + PAGE_SIZE * (NvU64)uvm_test_rng_range_32(rng, 0, params->num_pages - 1);
+        }
+
+        fault->access_type = uvm_test_rng_range_32(rng, UVM_FAULT_ACCESS_TYPE_PREFETCH, UVM_FAULT_ACCESS_TYPE_COUNT - 1);
+    }
+}
+
+static NV_STATUS radix_sort_faults(uvm_batch_sort_t *batch_sort,
+                                   synthetic_fault_t **ordered,
+                                   NvU32 num_entries)
+{
+    NvU32 i;
+
+    uvm_batch_sort_begin(batch_sort);
+
+    for (i = 0; i < num_entries; ++i) {
+        uvm_batch_sort_add(batch_sort,
+                           ordered[i],
+                           ordered[i]->va_space,
+                           ordered[i]->gpu_id,
+                           ordered[i]->address,
+                           UVM_FAULT_ACCESS_TYPE_COUNT - 1 - ordered[i]->access_type);
+    }
+
+    TEST_CHECK_RET(uvm_batch_sort_end(batch_sort, (void **)ordered));
+
+    return NV_OK;
+}
+
+static NV_STATUS batch_sort_benchmark(UVM_TEST_BATCH_SORT_BENCHMARK_PARAMS *params,
+                                      synthetic_fault_t *faults,
+                                      synthetic_fault_t **radix_ordered,
+                                      synthetic_fault_t **comparison_ordered,
+                                      uvm_batch_sort_t *batch_sort)
+{
+    uvm_test_rng_t rng;
+    NvU64 start;
+    NvU32 iteration;
+    NvU32 i;
+
+    uvm_test_rng_init(&rng, params->seed);
+
+    params->radix_sort_ns = 0;
+    params->comparison_sort_ns = 0;
+
+    for (iteration = 0; iteration < params->iterations; ++iteration) {
+        generate_faults(&rng, faults, params);
+
+        for (i = 0; i < params->num_entries; ++i) {
+            radix_ordered[i] = &faults[i];
+            comparison_ordered[i] = &faults[i];
+        }
+
+        start = NV_GETTIME();
+        TEST_NV_CHECK_RET(radix_sort_faults(batch_sort, radix_ordered, params->num_entries));
+        params->radix_sort_ns += NV_GETTIME() - start;
+
+        start = NV_GETTIME();
+        sort(comparison_ordered, params->num_entries, sizeof(*comparison_ordered), cmp_synthetic_fault, NULL);
+        params->comparison_sort_ns += NV_GETTIME() - start;
+
+        // The comparison sort is not stable, so only the keys are compared
+        for (i = 0; i < params->num_entries; ++i) {
+            void *radix = radix_ordered + i;
+            void *comparison = comparison_ordered + i;
+
+            TEST_CHECK_RET(cmp_synthetic_fault(radix, comparison) == 0);
+        }
+
+        // Equal keys must keep their arrival order
+        for (i = 1; i < params->num_entries; ++i) {
+            if (cmp_synthetic_fault(radix_ordered + i - 1, radix_ordered + i) == 0)
+                TEST_CHECK_RET(radix_ordered[i - 1] < radix_ordered[i]);
+        }
+
+        if (fatal_signal_pending(current))
+            return NV_ERR_SIGNAL_PENDING;
+
+        cond_resched();
+    }
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_batch_sort_benchmark(UVM_TEST_BATCH_SORT_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    synthetic_fault_t *faults = NULL;
+    synthetic_fault_t **radix_ordered = NULL;
+    synthetic_fault_t **comparison_ordered = NULL;
+    uvm_batch_sort_t *batch_sort;
+
+    if (params->num_entries == 0 || params->num_entries > BATCH_SORT_BENCHMARK_MAX_ENTRIES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->num_va_spaces == 0 || params->num_gpus == 0 || params->num_pages == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    // Keep all the (VA space, GPU) pairs within the buckets supported by the
+    // radix sort
+    if (params->num_va_spaces > UVM_BATCH_SORT_MAX_BUCKETS ||
+        params->num_gpus > UVM_BATCH_SORT_MAX_BUCKETS ||
+        params->num_va_spaces * params->num_gpus > UVM_BATCH_SORT_MAX_BUCKETS)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    batch_sort = uvm_kvmalloc_zero(sizeof(*batch_sort));
+    if (!batch_sort)
+        return NV_ERR_NO_MEMORY;
+
+    TEST_NV_CHECK_GOTO(uvm_batch_sort_init(batch_sort, params->num_entries), done);
+
+    faults = uvm_kvmalloc(params->num_entries * sizeof(*faults));
+    radix_ordered = uvm_kvmalloc(params->num_entries * sizeof(*radix_ordered));
+    comparison_ordered = uvm_kvmalloc(params->num_entries * sizeof(*comparison_ordered));
+    if (!faults || !radix_ordered || !comparison_ordered) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    status = batch_sort_benchmark(params, faults, radix_ordered, comparison_ordered, batch_sort);
+
+done:
+    uvm_kvfree(comparison_ordered);
+    uvm_kvfree(radix_ordered);
+    uvm_kvfree(faults);
+    uvm_batch_sort_deinit(batch_sort);
+    uvm_kvfree(batch_sort);
+
+    return status;
+}
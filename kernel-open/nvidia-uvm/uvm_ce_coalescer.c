@@ -0,0 +1,180 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_ce_coalescer.h"
+#include "uvm_gpu.h"
+#include "uvm_hal.h"
+#include "uvm_push.h"
+
+// Merge the copies added to CE coalescers into fewer CE transfers. When
+// disabled, each copy is issued as its own transfer.
+static int uvm_perf_ce_coalescing = 1;
+module_param(uvm_perf_ce_coalescing, int, S_IRUGO);
+
+void uvm_ce_coalescer_init(uvm_ce_coalescer_t *coalescer, bool pipeline_first)
+{
+    memset(coalescer, 0, sizeof(*coalescer));
+    coalescer->pipeline_first = pipeline_first;
+}
+
+// Copies can only be merged if the addresses only differ in their offset
+static bool addresses_can_merge(uvm_gpu_address_t a, uvm_gpu_address_t b)
+{
+    if (a.is_virtual != b.is_virtual || a.is_unprotected != b.is_unprotected)
+        return false;
+
+    return a.is_virtual || a.aperture == b.aperture;
+}
+
+bool uvm_ce_coalescer_merge(uvm_ce_coalescer_t *coalescer,
+                            uvm_gpu_address_t dst,
+                            uvm_gpu_address_t src,
+                            NvU64 size)
+{
+    NvU64 dst_pitch;
+    NvU64 src_pitch;
+
+    UVM_ASSERT(size > 0);
+
+    if (coalescer->run.line_count == 0) {
+        coalescer->run.dst = dst;
+        coalescer->run.src = src;
+        coalescer->run.line_size = size;
+        coalescer->run.dst_pitch = 0;
+        coalescer->run.src_pitch = 0;
+        coalescer->run.line_count = 1;
+        return true;
+    }
+
+    if (!addresses_can_merge(coalescer->run.dst, dst) || !addresses_can_merge(coalescer->run.src, src))
+        return false;
+
+    if (coalescer->run.line_count == 1) {
+        // Extend the line if the copy is adjacent to it
+        if (dst.address == coalescer->run.dst.address + coalescer->run.line_size &&
+            src.address == coalescer->run.src.address + coalescer->run.line_size) {
+            coalescer->run.line_size += size;
+            return true;
+        }
+
+        // Otherwise, the copy becomes the second line of a strided run. The
+        // lines must not overlap, and the pitches need to fit in the CE
+        // methods.
+        if (size != coalescer->run.line_size || size > NV_U32_MAX)
+            return false;
+
+        if (dst.address < coalescer->run.dst.address + size || src.address < coalescer->run.src.address + size)
+            return false;
+
+        dst_pitch = dst.address - coalescer->run.dst.address;
+        src_pitch = src.address - coalescer->run.src.address;
+        if (dst_pitch > NV_U32_MAX || src_pitch > NV_U32_MAX)
+            return false;
+
+        coalescer->run.dst_pitch = dst_pitch;
+        coalescer->run.src_pitch = src_pitch;
+        coalescer->run.line_count = 2;
+        return true;
+    }
+
+    if (size != coalescer->run.line_size || coalescer->run.line_count == NV_U32_MAX)
+        return false;
+
+    if (dst.address != coalescer->run.dst.address + coalescer->run.line_count * coalescer->run.dst_pitch ||
+        src.address != coalescer->run.src.address + coalescer->run.line_count * coalescer->run.src_pitch)
+        return false;
+
+    coalescer->run.line_count++;
+    return true;
+}
+
+void uvm_ce_coalescer_flush(uvm_ce_coalescer_t *coalescer, uvm_push_t *push)
+{
+    uvm_gpu_t *gpu;
+
+    if (coalescer->run.line_count == 0)
+        return;
+
+    gpu = uvm_push_get_gpu(push);
+
+    if (coalescer->num_issued > 0 || coalescer->pipeline_first)
+        uvm_push_set_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+    else
+        UVM_ASSERT(!uvm_push_test_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED));
+
+    uvm_push_set_flag(push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+
+    if (coalescer->run.line_count == 1) {
+        gpu->parent->ce_hal->memcopy(push, coalescer->run.dst, coalescer->run.src, coalescer->run.line_size);
+    }
+    else {
+        gpu->parent->ce_hal->memcopy_strided(push,
+                                             coalescer->run.dst,
+                                             (NvU32)coalescer->run.dst_pitch,
+                                             coalescer->run.src,
+                                             (NvU32)coalescer->run.src_pitch,
+                                             (NvU32)coalescer->run.line_size,
+                                             coalescer->run.line_count);
+    }
+
+    coalescer->num_issued++;
+    coalescer->run.line_count = 0;
+}
+
+void uvm_ce_coalescer_add(uvm_ce_coalescer_t *coalescer,
+                          uvm_push_t *push,
+                          uvm_gpu_address_t dst,
+                          uvm_gpu_address_t src,
+                          NvU64 size)
+{
+    bool merged;
+
+    coalescer->num_requested++;
+
+    if (uvm_perf_ce_coalescing && uvm_ce_coalescer_merge(coalescer, dst, src, size))
+        return;
+
+    uvm_ce_coalescer_flush(coalescer, push);
+
+    merged = uvm_ce_coalescer_merge(coalescer, dst, src, size);
+    UVM_ASSERT(merged);
+
+    if (!uvm_perf_ce_coalescing)
+        uvm_ce_coalescer_flush(coalescer, push);
+}
+
+void uvm_ce_coalescer_end(uvm_ce_coalescer_t *coalescer, uvm_push_t *push)
+{
+    uvm_parent_gpu_t *parent_gpu = uvm_push_get_gpu(push)->parent;
+
+    uvm_ce_coalescer_flush(coalescer, push);
+
+    if (coalescer->num_requested == 0)
+        return;
+
+    atomic64_add(coalescer->num_requested, &parent_gpu->stats.num_ce_copies_requested);
+    atomic64_add(coalescer->num_issued, &parent_gpu->stats.num_ce_copies_issued);
+
+    coalescer->num_requested = 0;
+    coalescer->num_issued = 0;
+}
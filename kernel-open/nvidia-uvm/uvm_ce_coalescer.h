@@ -0,0 +1,105 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#ifndef __UVM_CE_COALESCER_H__
+#define __UVM_CE_COALESCER_H__
+
+#include "uvm_common.h"
+#include "uvm_forward_decl.h"
+#include "uvm_hal_types.h"
+
+// The CE coalescer gathers the copies of a push and merges them into fewer
+// CE transfers before they are written to the push. Each CE transfer has a
+// fixed cost in methods and CE launch overhead, which dominates the channel
+// time of copies of a few pages, like the per-page copies issued when
+// migrating VA blocks with fragmented physical storage.
+//
+// Copies are merged into a pending run, which can be either:
+// - A single line: a copy that starts right where the previous one ended, both
+//   in the source and the destination, extends the line.
+// - Multiple lines of the same size separated by a constant pitch in the
+//   source and in the destination: these are issued as a single multi-line
+//   transfer with uvm_hal_memcopy_strided_t.
+//
+// Copies that cannot be merged into the pending run flush it. Since the
+// pending run is written to the push at a later time, the caller must flush
+// the coalescer before pushing any work that needs to be ordered after the
+// copies.
+//
+// All the transfers are issued with UVM_PUSH_FLAG_NEXT_MEMBAR_NONE, and all
+// the transfers but the first one are pipelined. The caller must issue a
+// membar, usually implicitly on uvm_push_end, before the copied data can be
+// consumed.
+typedef struct
+{
+    // Pending run. Unused if line_count is 0.
+    struct
+    {
+        uvm_gpu_address_t dst;
+        uvm_gpu_address_t src;
+        NvU64 line_size;
+        NvU64 dst_pitch;
+        NvU64 src_pitch;
+        NvU32 line_count;
+    } run;
+
+    // Whether the first transfer issued by the coalescer is pipelined with the
+    // previous work in the push.
+    bool pipeline_first;
+
+    // Number of copies added to the coalescer
+    NvU64 num_requested;
+
+    // Number of CE transfers issued by the coalescer
+    NvU64 num_issued;
+} uvm_ce_coalescer_t;
+
+void uvm_ce_coalescer_init(uvm_ce_coalescer_t *coalescer, bool pipeline_first);
+
+// Try to merge the given copy into the pending run of the coalescer, starting
+// a new run if there is no pending run. Returns false if the copy cannot be
+// merged, in which case the coalescer is not modified.
+//
+// This only updates the bookkeeping of the run and does not push any work.
+bool uvm_ce_coalescer_merge(uvm_ce_coalescer_t *coalescer,
+                            uvm_gpu_address_t dst,
+                            uvm_gpu_address_t src,
+                            NvU64 size);
+
+// Add a copy of size bytes from src to dst to the coalescer. If the copy
+// cannot be merged into the pending run, the pending run is issued to the
+// given push first.
+void uvm_ce_coalescer_add(uvm_ce_coalescer_t *coalescer,
+                          uvm_push_t *push,
+                          uvm_gpu_address_t dst,
+                          uvm_gpu_address_t src,
+                          NvU64 size);
+
+// Issue the pending run, if any, to the given push.
+void uvm_ce_coalescer_flush(uvm_ce_coalescer_t *coalescer, uvm_push_t *push);
+
+// Flush the coalescer and add its counters to the statistics of the GPU of
+// the push. The coalescer can be reused after uvm_ce_coalescer_init.
+void uvm_ce_coalescer_end(uvm_ce_coalescer_t *coalescer, uvm_push_t *push);
+
+#endif // __UVM_CE_COALESCER_H__
@@ -21,6 +21,7 @@
 
 *******************************************************************************/
 
+#include "uvm_ce_coalescer.h"
 #include "uvm_channel.h"
 #include "uvm_global.h"
 #include "uvm_hal.h"
@@ -215,6 +216,100 @@ done:
     return status;
 }
 
+#define CE_TEST_STRIDED_LINES 8
+#define CE_TEST_STRIDED_LINE_SIZE 256
+#define CE_TEST_STRIDED_SRC_PITCH 1024
+#define CE_TEST_STRIDED_DST_PITCH 512
+
+// Copy the same strided lines twice: with a single multi-line transfer, and
+// one line at a time through a CE coalescer.
+static NV_STATUS test_memcopy_strided(uvm_gpu_t *gpu)
+{
+    NV_STATUS status;
+    uvm_rm_mem_t *mem = NULL;
+    uvm_ce_coalescer_t coalescer;
+    uvm_gpu_address_t src;
+    uvm_gpu_address_t dst;
+    uvm_push_t push;
+    NvU8 *cpu_ptr;
+    const size_t src_size = CE_TEST_STRIDED_LINES * CE_TEST_STRIDED_SRC_PITCH;
+    const size_t dst_size = CE_TEST_STRIDED_LINES * CE_TEST_STRIDED_DST_PITCH;
+    size_t i, j, k;
+
+    // TODO: Bug 3839176: the test is waived on Confidential Computing because
+    // it assumes that GPU can access system memory without using encryption.
+    if (g_uvm_global.conf_computing_enabled)
+        return NV_OK;
+
+    status = uvm_rm_mem_alloc_and_map_cpu(gpu, UVM_RM_MEM_TYPE_SYS, src_size + 2 * dst_size, 0, &mem);
+    TEST_CHECK_GOTO(status == NV_OK, done);
+
+    cpu_ptr = (NvU8 *)uvm_rm_mem_get_cpu_va(mem);
+    for (i = 0; i < src_size; i++)
+        cpu_ptr[i] = (NvU8)(i % 251) + 1;
+    memset(cpu_ptr + src_size, 0, 2 * dst_size);
+
+    status = uvm_push_begin(gpu->channel_manager, UVM_CHANNEL_TYPE_GPU_TO_CPU, &push, "Strided memcopy test");
+    TEST_CHECK_GOTO(status == NV_OK, done);
+
+    src = uvm_rm_mem_get_gpu_va(mem, gpu, uvm_channel_is_proxy(push.channel));
+    dst = src;
+    dst.address += src_size;
+
+    gpu->parent->ce_hal->memcopy_strided(&push,
+                                         dst,
+                                         CE_TEST_STRIDED_DST_PITCH,
+                                         src,
+                                         CE_TEST_STRIDED_SRC_PITCH,
+                                         CE_TEST_STRIDED_LINE_SIZE,
+                                         CE_TEST_STRIDED_LINES);
+
+    dst.address += dst_size;
+    uvm_ce_coalescer_init(&coalescer, false);
+    for (i = 0; i < CE_TEST_STRIDED_LINES; i++) {
+        uvm_gpu_address_t line_src = src;
+        uvm_gpu_address_t line_dst = dst;
+
+        line_src.address += i * CE_TEST_STRIDED_SRC_PITCH;
+        line_dst.address += i * CE_TEST_STRIDED_DST_PITCH;
+        uvm_ce_coalescer_add(&coalescer, &push, line_dst, line_src, CE_TEST_STRIDED_LINE_SIZE);
+    }
+    uvm_ce_coalescer_flush(&coalescer, &push);
+
+    status = uvm_push_end_and_wait(&push);
+    TEST_CHECK_GOTO(status == NV_OK, done);
+
+    for (k = 0; k < 2; k++) {
+        NvU8 *dst_ptr = cpu_ptr + src_size + k * dst_size;
+
+        for (i = 0; i < CE_TEST_STRIDED_LINES; i++) {
+            for (j = 0; j < CE_TEST_STRIDED_DST_PITCH; j++) {
+                NvU8 expected = 0;
+
+                if (j < CE_TEST_STRIDED_LINE_SIZE)
+                    expected = cpu_ptr[i * CE_TEST_STRIDED_SRC_PITCH + j];
+
+                if (dst_ptr[i * CE_TEST_STRIDED_DST_PITCH + j] != expected) {
+                    UVM_TEST_PRINT("Copy %zu line %zu offset %zu: value 0x%x instead of 0x%x, GPU %s\n",
+                                   k,
+                                   i,
+                                   j,
+                                   dst_ptr[i * CE_TEST_STRIDED_DST_PITCH + j],
+                                   expected,
+                                   uvm_gpu_name(gpu));
+                    status = NV_ERR_INVALID_STATE;
+                    goto done;
+                }
+            }
+        }
+    }
+
+done:
+    uvm_rm_mem_free(mem);
+
+    return status;
+}
+
 static void push_memset(uvm_push_t *push, uvm_gpu_address_t dst, NvU64 value, size_t element_size, size_t size)
 {
     switch (element_size) {
@@ -1242,6 +1337,7 @@ static NV_STATUS test_ce(uvm_va_space_t *va_space, bool skipTimestampTest)
         TEST_NV_CHECK_RET(test_non_pipelined(gpu));
         TEST_NV_CHECK_RET(test_membar(gpu));
         TEST_NV_CHECK_RET(test_memcpy_and_memset(gpu));
+        TEST_NV_CHECK_RET(test_memcopy_strided(gpu));
         TEST_NV_CHECK_RET(test_semaphore_reduction_inc(gpu));
         TEST_NV_CHECK_RET(test_semaphore_release(gpu));
 
@@ -1271,3 +1367,181 @@ done:
 
     return status;
 }
+
+static uvm_gpu_address_t coalescer_test_vid(NvU64 address)
+{
+    return uvm_gpu_address_physical(UVM_APERTURE_VID, address);
+}
+
+static uvm_gpu_address_t coalescer_test_sys(NvU64 address)
+{
+    return uvm_gpu_address_physical(UVM_APERTURE_SYS, address);
+}
+
+static NV_STATUS test_coalescer_adjacent(void)
+{
+    uvm_ce_coalescer_t coalescer;
+    NvU64 i;
+
+    uvm_ce_coalescer_init(&coalescer, false);
+
+    for (i = 0; i < 16; i++)
+        TEST_CHECK_RET(uvm_ce_coalescer_merge(&coalescer,
+                                              coalescer_test_vid(UVM_SIZE_1MB + i * PAGE_SIZE),
+                                              coalescer_test_sys(i * PAGE_SIZE),
+                                              PAGE_SIZE));
+
+    TEST_CHECK_RET(coalescer.run.line_count == 1);
+    TEST_CHECK_RET(coalescer.run.line_size == 16 * PAGE_SIZE);
+
+    // Copies of different sizes can be appended to a single line
+    TEST_CHECK_RET(uvm_ce_coalescer_merge(&coalescer,
+                                          coalescer_test_vid(UVM_SIZE_1MB + 16 * PAGE_SIZE),
+                                          coalescer_test_sys(16 * PAGE_SIZE),
+                                          3 * PAGE_SIZE));
+    TEST_CHECK_RET(coalescer.run.line_size == 19 * PAGE_SIZE);
+
+    // Adjacent in the destination only
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(UVM_SIZE_1MB + 19 * PAGE_SIZE),
+                                           coalescer_test_sys(20 * PAGE_SIZE),
+                                           PAGE_SIZE));
+
+    // Different aperture
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(UVM_SIZE_1MB + 19 * PAGE_SIZE),
+                                           coalescer_test_vid(19 * PAGE_SIZE),
+                                           PAGE_SIZE));
+
+    // Virtual and physical addresses
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           uvm_gpu_address_virtual(UVM_SIZE_1MB + 19 * PAGE_SIZE),
+                                           coalescer_test_sys(19 * PAGE_SIZE),
+                                           PAGE_SIZE));
+
+    // Failed merges don't modify the run
+    TEST_CHECK_RET(coalescer.run.line_count == 1);
+    TEST_CHECK_RET(coalescer.run.line_size == 19 * PAGE_SIZE);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_coalescer_strided(void)
+{
+    uvm_ce_coalescer_t coalescer;
+    NvU64 i;
+
+    uvm_ce_coalescer_init(&coalescer, false);
+
+    // Every other page in the source, packed in the destination
+    for (i = 0; i < 8; i++)
+        TEST_CHECK_RET(uvm_ce_coalescer_merge(&coalescer,
+                                              coalescer_test_vid(i * PAGE_SIZE),
+                                              coalescer_test_vid(UVM_SIZE_1MB + 2 * i * PAGE_SIZE),
+                                              PAGE_SIZE));
+
+    TEST_CHECK_RET(coalescer.run.line_count == 8);
+    TEST_CHECK_RET(coalescer.run.line_size == PAGE_SIZE);
+    TEST_CHECK_RET(coalescer.run.dst_pitch == PAGE_SIZE);
+    TEST_CHECK_RET(coalescer.run.src_pitch == 2 * PAGE_SIZE);
+
+    // A strided run cannot be extended with an adjacent copy
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(8 * PAGE_SIZE),
+                                           coalescer_test_vid(UVM_SIZE_1MB + 15 * PAGE_SIZE),
+                                           PAGE_SIZE));
+
+    // Nor with a line of a different size
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(8 * PAGE_SIZE),
+                                           coalescer_test_vid(UVM_SIZE_1MB + 16 * PAGE_SIZE),
+                                           2 * PAGE_SIZE));
+
+    TEST_CHECK_RET(uvm_ce_coalescer_merge(&coalescer,
+                                          coalescer_test_vid(8 * PAGE_SIZE),
+                                          coalescer_test_vid(UVM_SIZE_1MB + 16 * PAGE_SIZE),
+                                          PAGE_SIZE));
+    TEST_CHECK_RET(coalescer.run.line_count == 9);
+
+    // Lines cannot overlap or go backwards
+    uvm_ce_coalescer_init(&coalescer, false);
+    TEST_CHECK_RET(uvm_ce_coalescer_merge(&coalescer,
+                                          coalescer_test_vid(0),
+                                          coalescer_test_vid(UVM_SIZE_1MB),
+                                          2 * PAGE_SIZE));
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(PAGE_SIZE),
+                                           coalescer_test_vid(UVM_SIZE_1MB + 4 * PAGE_SIZE),
+                                           2 * PAGE_SIZE));
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(4 * PAGE_SIZE),
+                                           coalescer_test_vid(0),
+                                           2 * PAGE_SIZE));
+
+    // Pitches need to fit in 32 bits
+    TEST_CHECK_RET(!uvm_ce_coalescer_merge(&coalescer,
+                                           coalescer_test_vid(4 * PAGE_SIZE),
+                                           coalescer_test_vid(UVM_SIZE_1MB + 8 * UVM_SIZE_1GB),
+                                           2 * PAGE_SIZE));
+    TEST_CHECK_RET(coalescer.run.line_count == 1);
+
+    return NV_OK;
+}
+
+// Count the CE transfers needed for the given sequence of page copies, using
+// the coalescer merge logic without a push.
+static NvU64 coalescer_test_count_transfers(const NvU64 *dst_pages, const NvU64 *src_pages, size_t count)
+{
+    uvm_ce_coalescer_t coalescer;
+    NvU64 transfers = 0;
+    size_t i;
+
+    uvm_ce_coalescer_init(&coalescer, false);
+
+    for (i = 0; i < count; i++) {
+        uvm_gpu_address_t dst = coalescer_test_vid(dst_pages[i] * PAGE_SIZE);
+        uvm_gpu_address_t src = coalescer_test_sys(src_pages[i] * PAGE_SIZE);
+
+        if (uvm_ce_coalescer_merge(&coalescer, dst, src, PAGE_SIZE))
+            continue;
+
+        transfers++;
+        coalescer.run.line_count = 0;
+        uvm_ce_coalescer_merge(&coalescer, dst, src, PAGE_SIZE);
+    }
+
+    if (coalescer.run.line_count > 0)
+        transfers++;
+
+    return transfers;
+}
+
+static NV_STATUS test_coalescer_sequences(void)
+{
+    // Pages of a VA block backed by two 64K chunks in the destination, with
+    // an identity layout in the source: one transfer per chunk.
+    static const NvU64 chunks_dst[] = {0, 1, 2, 3, 32, 33, 34, 35};
+    static const NvU64 chunks_src[] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    // Fragmented residency: every third page migrates, followed by a run of
+    // adjacent pages and a single page elsewhere.
+    static const NvU64 fragmented_dst[] = {0, 3, 6, 9, 12, 13, 14, 15, 100};
+    static const NvU64 fragmented_src[] = {0, 3, 6, 9, 12, 13, 14, 15, 200};
+
+    TEST_CHECK_RET(coalescer_test_count_transfers(chunks_dst, chunks_src, ARRAY_SIZE(chunks_dst)) == 2);
+
+    // {0, 3, 6, 9, 12} is a strided run, {13, 14, 15} an adjacent one and
+    // {100} a single copy
+    TEST_CHECK_RET(coalescer_test_count_transfers(fragmented_dst, fragmented_src, ARRAY_SIZE(fragmented_dst)) == 3);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_ce_coalescer_sanity(UVM_TEST_CE_COALESCER_SANITY_PARAMS *params, struct file *filp)
+{
+    TEST_NV_CHECK_RET(test_coalescer_adjacent());
+    TEST_NV_CHECK_RET(test_coalescer_strided());
+    TEST_NV_CHECK_RET(test_coalescer_sequences());
+
+    return NV_OK;
+}
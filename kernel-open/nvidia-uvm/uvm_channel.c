@@ -85,6 +85,15 @@ module_param(uvm_channel_gpfifo_loc, charp, S_IRUGO);
 module_param(uvm_channel_gpput_loc, charp, S_IRUGO);
 module_param(uvm_channel_pushbuffer_loc, charp, S_IRUGO);
 
+// Bytes in flight, in MBs, above which pushes of the CPU_TO_GPU, GPU_TO_CPU
+// and GPU_INTERNAL channel types are redirected from their default CE to the
+// least loaded CE, if that halves the load. Large migrations made of many
+// pushes are then split across CEs. 0 disables the balancing across CEs.
+static unsigned uvm_channel_ce_balance_threshold_mb = 64;
+module_param(uvm_channel_ce_balance_threshold_mb, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(uvm_channel_ce_balance_threshold_mb,
+                 "CE bytes in flight, in MBs, above which copies are balanced across CEs. 0 disables balancing.");
+
 static NV_STATUS manager_create_procfs_dirs(uvm_channel_manager_t *manager);
 static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager);
 static NV_STATUS channel_create_procfs(uvm_channel_t *channel);
@@ -221,6 +230,10 @@ static NvU32 uvm_channel_update_progress_with_max(uvm_channel_t *channel,
         if (entry->type == UVM_GPFIFO_ENTRY_TYPE_NORMAL) {
             uvm_pushbuffer_mark_completed(channel, entry);
             list_add_tail(&entry->push_info->available_list_node, &channel->available_push_infos);
+
+            UVM_ASSERT(channel->bytes_in_flight >= entry->copy_bytes);
+            channel->bytes_in_flight -= entry->copy_bytes;
+            atomic64_sub(entry->copy_bytes, &channel->pool->bytes_in_flight);
         }
 
         gpu_get = (gpu_get + 1) % channel->num_gpfifo_entries;
@@ -580,6 +593,51 @@ done:
     return NV_OK;
 }
 
+// Claim a GPFIFO entry on the least loaded channel of the pool that has one
+// available. Channels are ranked by the bytes they have in flight, and then by
+// the number of available GPFIFO entries.
+static uvm_channel_t *channel_pool_claim_least_loaded(uvm_channel_pool_t *pool,
+                                                      uvm_channel_reserve_type_t reserve_type)
+{
+    uvm_channel_t *channel;
+    uvm_channel_t *best = NULL;
+    NvU32 best_available = 0;
+
+    channel_pool_lock(pool);
+
+    uvm_for_each_channel_in_pool(channel, pool) {
+        NvU32 available;
+
+        if (reserve_type == UVM_CHANNEL_RESERVE_WITH_P2P && channel->suspended_p2p)
+            continue;
+
+        available = channel_get_available_gpfifo_entries(channel);
+        if (available == 0)
+            continue;
+
+        if (best) {
+            if (channel->bytes_in_flight > best->bytes_in_flight)
+                continue;
+
+            if (channel->bytes_in_flight == best->bytes_in_flight && available <= best_available)
+                continue;
+        }
+
+        best = channel;
+        best_available = available;
+    }
+
+    if (best) {
+        bool claimed = try_claim_channel_locked(best, 1, reserve_type);
+
+        UVM_ASSERT(claimed);
+    }
+
+    channel_pool_unlock(pool);
+
+    return best;
+}
+
 // Reserve a channel in the specified pool
 static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
                                          uvm_channel_reserve_type_t reserve_type,
@@ -593,12 +651,10 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
     if (g_uvm_global.conf_computing_enabled)
         return channel_reserve_and_lock_in_pool(pool, reserve_type, channel_out);
 
-    uvm_for_each_channel_in_pool(channel, pool) {
-        // TODO: Bug 1764953: Prefer idle/less busy channels
-        if (try_claim_channel(channel, 1, reserve_type)) {
-            *channel_out = channel;
-            return NV_OK;
-        }
+    channel = channel_pool_claim_least_loaded(pool, reserve_type);
+    if (channel) {
+        *channel_out = channel;
+        return NV_OK;
     }
 
     uvm_spin_loop_init(&spin);
@@ -630,14 +686,66 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
     return NV_ERR_GENERIC;
 }
 
+// Return the pool to use for a push of the given type. This is the default pool
+// for the type, unless its CE is overloaded and another CE has at most half of
+// its load.
+//
+// All the usable CEs can access sysmem and peers (see ces_validate()), so any
+// CE pool can serve the copy types. GPU_TO_GPU copies stay on their pool as
+// its CE is picked based on the peer links, and MEMOPS care about latency
+// rather than bandwidth.
+static uvm_channel_pool_t *channel_manager_pool_for_type(uvm_channel_manager_t *manager, uvm_channel_type_t type)
+{
+    uvm_channel_pool_t *pool = manager->pool_to_use.default_for_type[type];
+    uvm_channel_pool_t *best_pool = pool;
+    uvm_channel_pool_t *candidate;
+    NvU64 threshold = (NvU64)uvm_channel_ce_balance_threshold_mb * UVM_SIZE_1MB;
+    NvU64 load;
+    NvU64 best_load;
+
+    if (threshold == 0 || g_uvm_global.conf_computing_enabled)
+        return pool;
+
+    if (type != UVM_CHANNEL_TYPE_CPU_TO_GPU &&
+        type != UVM_CHANNEL_TYPE_GPU_TO_CPU &&
+        type != UVM_CHANNEL_TYPE_GPU_INTERNAL)
+        return pool;
+
+    if (pool->pool_type != UVM_CHANNEL_POOL_TYPE_CE)
+        return pool;
+
+    load = atomic64_read(&pool->bytes_in_flight);
+    if (load < threshold)
+        return pool;
+
+    best_load = load;
+    uvm_for_each_pool_of_type(candidate, manager, UVM_CHANNEL_POOL_TYPE_CE) {
+        NvU64 candidate_load = atomic64_read(&candidate->bytes_in_flight);
+
+        if (candidate_load < best_load) {
+            best_pool = candidate;
+            best_load = candidate_load;
+        }
+    }
+
+    if (best_load > load / 2)
+        return pool;
+
+    atomic64_inc(&best_pool->num_balanced_pushes);
+
+    return best_pool;
+}
+
 NV_STATUS uvm_channel_reserve_type(uvm_channel_manager_t *manager, uvm_channel_type_t type, uvm_channel_t **channel_out)
 {
     uvm_channel_reserve_type_t reserve_type;
-    uvm_channel_pool_t *pool = manager->pool_to_use.default_for_type[type];
+    uvm_channel_pool_t *pool;
 
-    UVM_ASSERT(pool != NULL);
     UVM_ASSERT(type < UVM_CHANNEL_TYPE_COUNT);
 
+    pool = channel_manager_pool_for_type(manager, type);
+    UVM_ASSERT(pool != NULL);
+
     if (type == UVM_CHANNEL_TYPE_GPU_TO_GPU)
         reserve_type = UVM_CHANNEL_RESERVE_WITH_P2P;
     else
@@ -1553,6 +1661,10 @@ void uvm_channel_end_push(uvm_push_t *push)
     entry->push_info = &channel->push_infos[push->push_info_index];
     entry->type = UVM_GPFIFO_ENTRY_TYPE_NORMAL;
 
+    entry->copy_bytes = push->copy_bytes;
+    channel->bytes_in_flight += push->copy_bytes;
+    atomic64_add(push->copy_bytes, &channel->pool->bytes_in_flight);
+
     UVM_ASSERT(channel->current_gpfifo_count > 0);
     --channel->current_gpfifo_count;
 
@@ -3986,6 +4098,7 @@ void uvm_channel_manager_destroy(uvm_channel_manager_t *channel_manager)
     if (channel_manager == NULL)
         return;
 
+    proc_remove(channel_manager->procfs.ce_load);
     proc_remove(channel_manager->procfs.pending_pushes);
 
     if (uvm_channel_manager_is_wlc_ready(channel_manager))
@@ -4133,6 +4246,8 @@ static void uvm_channel_print_info(uvm_channel_t *channel, struct seq_file *s)
     UVM_SEQ_OR_DBG_PRINT(s, "GPPUT location     %s\n", get_gpput_location_string(channel));
     UVM_SEQ_OR_DBG_PRINT(s, "get                %u\n", channel->gpu_get);
     UVM_SEQ_OR_DBG_PRINT(s, "put                %u\n", channel->cpu_put);
+    UVM_SEQ_OR_DBG_PRINT(s, "available GPFIFOs  %u\n", channel_get_available_gpfifo_entries(channel));
+    UVM_SEQ_OR_DBG_PRINT(s, "bytes in flight    %llu\n", channel->bytes_in_flight);
     UVM_SEQ_OR_DBG_PRINT(s, "Semaphore GPU VA   0x%llx\n", uvm_channel_tracking_semaphore_get_gpu_va(channel));
     UVM_SEQ_OR_DBG_PRINT(s, "Semaphore CPU VA   0x%llx\n", (NvU64)uvm_gpu_semaphore_get_cpu_va(&channel->tracking_sem.semaphore));
 
@@ -4248,6 +4363,34 @@ static void channel_manager_print_pending_pushes(uvm_channel_manager_t *manager,
     }
 }
 
+static void channel_manager_print_ce_load(uvm_channel_manager_t *manager, struct seq_file *s)
+{
+    uvm_channel_pool_t *pool;
+
+    uvm_for_each_pool(pool, manager) {
+        uvm_channel_t *channel;
+
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "Pool %s engine %u: bytes in flight %lld, balanced pushes %lld\n",
+                             uvm_channel_pool_type_to_string(pool->pool_type),
+                             pool->engine_index,
+                             atomic64_read(&pool->bytes_in_flight),
+                             atomic64_read(&pool->num_balanced_pushes));
+
+        channel_pool_lock(pool);
+
+        uvm_for_each_channel_in_pool(channel, pool) {
+            UVM_SEQ_OR_DBG_PRINT(s,
+                                 "    %s: bytes in flight %llu, available GPFIFOs %u\n",
+                                 channel->name,
+                                 channel->bytes_in_flight,
+                                 channel_get_available_gpfifo_entries(channel));
+        }
+
+        channel_pool_unlock(pool);
+    }
+}
+
 static NV_STATUS manager_create_procfs_dirs(uvm_channel_manager_t *manager)
 {
     uvm_gpu_t *gpu = manager->gpu;
@@ -4284,6 +4427,27 @@ static int nv_procfs_read_manager_pending_pushes_entry(struct seq_file *s, void
 
 UVM_DEFINE_SINGLE_PROCFS_FILE(manager_pending_pushes_entry);
 
+static int nv_procfs_read_manager_ce_load(struct seq_file *s, void *v)
+{
+    uvm_channel_manager_t *manager = (uvm_channel_manager_t *)s->private;
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+        return -EAGAIN;
+
+    channel_manager_print_ce_load(manager, s);
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_manager_ce_load_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_manager_ce_load(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(manager_ce_load_entry);
+
 static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager)
 {
     uvm_gpu_t *gpu = manager->gpu;
@@ -4299,6 +4463,10 @@ static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager)
     if (manager->procfs.pending_pushes == NULL)
         return NV_ERR_OPERATING_SYSTEM;
 
+    manager->procfs.ce_load = NV_CREATE_PROC_FILE("ce_load", gpu->procfs.dir, manager_ce_load_entry, manager);
+    if (manager->procfs.ce_load == NULL)
+        return NV_ERR_OPERATING_SYSTEM;
+
     return NV_OK;
 }
 
@@ -187,6 +187,9 @@ struct uvm_gpfifo_entry_struct
 
     // Push info for the pending push that used this GPFIFO entry
     uvm_push_info_t *push_info;
+
+    // Bytes copied or set by the CE in the push, see uvm_push_t::copy_bytes
+    NvU64 copy_bytes;
 };
 
 // A channel pool is a set of channels that use the same engine. For example,
@@ -223,6 +226,16 @@ typedef struct
     // Pool type: Refer to the uvm_channel_pool_type_t enum.
     uvm_channel_pool_type_t pool_type;
 
+    // Sum of the bytes in flight of all the channels in the pool. Since all
+    // the channels of a CE pool share the same CE, this is the load of the CE
+    // as far as UVM is concerned. It can be read without holding the pool
+    // lock.
+    atomic64_t bytes_in_flight;
+
+    // Number of pushes of other channel types that were redirected to this
+    // pool because their default pool was overloaded.
+    atomic64_t num_balanced_pushes;
+
     // Lock protecting the state of channels in the pool.
     //
     // There are two pool lock types available: spinlock and mutex. The mutex
@@ -320,6 +333,10 @@ struct uvm_channel_struct
     // there is a free GPFIFO entry for it.
     NvU32 current_gpfifo_count;
 
+    // Bytes copied or set by the CE in the pushes submitted to the channel
+    // that haven't been completed yet. Protected by the pool lock.
+    NvU64 bytes_in_flight;
+
     // Array of uvm_push_info_t for all pending pushes on the channel
     uvm_push_info_t *push_infos;
 
@@ -460,6 +477,7 @@ struct uvm_channel_manager_struct
     {
         struct proc_dir_entry *channels_dir;
         struct proc_dir_entry *pending_pushes;
+        struct proc_dir_entry *ce_load;
     } procfs;
 
     struct
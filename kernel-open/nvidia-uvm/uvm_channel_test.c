@@ -1612,6 +1612,91 @@ error:
     return status;
 }
 
+// Check that the bytes written by CE methods are accounted to the push, and
+// that the bytes in flight of each pool match the sum over its channels.
+static NV_STATUS test_channel_bytes_in_flight(uvm_va_space_t *va_space)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_t *gpu;
+    uvm_rm_mem_t *mem = NULL;
+    const size_t buffer_size = 64 * 1024;
+
+    // The test relies on the GPU accessing system memory without encryption
+    if (g_uvm_global.conf_computing_enabled)
+        return NV_OK;
+
+    for_each_va_space_gpu(gpu, va_space) {
+        uvm_channel_pool_t *pool;
+        uvm_push_t push;
+        NvU64 gpu_va;
+
+        TEST_NV_CHECK_GOTO(uvm_rm_mem_alloc_and_map_all(gpu, UVM_RM_MEM_TYPE_SYS, buffer_size, 0, &mem), done);
+
+        TEST_NV_CHECK_GOTO(uvm_push_begin(gpu->channel_manager,
+                                          UVM_CHANNEL_TYPE_GPU_TO_CPU,
+                                          &push,
+                                          "bytes in flight"),
+                           done);
+
+        gpu_va = uvm_rm_mem_get_gpu_va(mem, gpu, uvm_channel_is_proxy(push.channel)).address;
+
+        TEST_CHECK_GOTO(push.copy_bytes == 0, end_push);
+
+        gpu->parent->ce_hal->memset_v_4(&push, gpu_va, 0, buffer_size / 2);
+        TEST_CHECK_GOTO(push.copy_bytes == buffer_size / 2, end_push);
+
+        if (!uvm_channel_is_proxy(push.channel)) {
+            gpu->parent->ce_hal->memcopy_v_to_v(&push, gpu_va + buffer_size / 2, gpu_va, buffer_size / 2);
+            TEST_CHECK_GOTO(push.copy_bytes == buffer_size, end_push);
+        }
+
+end_push:
+        if (status == NV_OK)
+            status = uvm_push_end_and_wait(&push);
+        else
+            uvm_push_end_and_wait(&push);
+
+        uvm_rm_mem_free(mem);
+        mem = NULL;
+
+        if (status != NV_OK)
+            goto done;
+
+        uvm_for_each_pool(pool, gpu->channel_manager) {
+            uvm_channel_t *channel;
+            NvU64 bytes_in_flight = 0;
+
+            uvm_for_each_channel_in_pool(channel, pool)
+                uvm_channel_update_progress_all(channel);
+
+            // The per channel and per pool counters are both updated with the
+            // pool lock held.
+            if (uvm_channel_pool_uses_mutex(pool))
+                uvm_mutex_lock(&pool->mutex);
+            else
+                uvm_spin_lock(&pool->spinlock);
+
+            uvm_for_each_channel_in_pool(channel, pool)
+                bytes_in_flight += channel->bytes_in_flight;
+
+            if (bytes_in_flight != atomic64_read(&pool->bytes_in_flight))
+                status = NV_ERR_INVALID_STATE;
+
+            if (uvm_channel_pool_uses_mutex(pool))
+                uvm_mutex_unlock(&pool->mutex);
+            else
+                uvm_spin_unlock(&pool->spinlock);
+
+            TEST_NV_CHECK_GOTO(status, done);
+        }
+    }
+
+done:
+    uvm_rm_mem_free(mem);
+
+    return status;
+}
+
 NV_STATUS uvm_test_channel_sanity(UVM_TEST_CHANNEL_SANITY_PARAMS *params, struct file *filp)
 {
     NV_STATUS status;
@@ -1636,6 +1721,10 @@ NV_STATUS uvm_test_channel_sanity(UVM_TEST_CHANNEL_SANITY_PARAMS *params, struct
     if (status != NV_OK)
         goto done;
 
+    status = test_channel_bytes_in_flight(va_space);
+    if (status != NV_OK)
+        goto done;
+
     status = test_conf_computing_channel_selection(va_space);
     if (status != NV_OK)
         goto done;
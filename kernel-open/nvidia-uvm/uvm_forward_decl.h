@@ -69,6 +69,8 @@ typedef struct uvm_va_block_retry_struct uvm_va_block_retry_t;
 typedef struct uvm_va_space_struct uvm_va_space_t;
 typedef struct uvm_va_space_mm_struct uvm_va_space_mm_t;
 
+typedef struct uvm_hmm_migrate_batch_struct uvm_hmm_migrate_batch_t;
+
 typedef struct uvm_make_resident_context_struct uvm_make_resident_context_t;
 
 typedef struct uvm_gpu_va_space_struct uvm_gpu_va_space_t;
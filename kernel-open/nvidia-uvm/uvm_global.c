@@ -109,6 +109,12 @@ NV_STATUS uvm_global_init(void)
         goto error;
     }
 
+    status = uvm_kvmalloc_procfs_init();
+    if (status != NV_OK) {
+        UVM_ERR_PRINT("uvm_kvmalloc_procfs_init() failed: %s\n", nvstatusToString(status));
+        goto error;
+    }
+
     status = uvm_rm_locked_call(nvUvmInterfaceSessionCreate(&g_uvm_global.rm_session_handle, &platform_info));
     if (status != NV_OK) {
         UVM_ERR_PRINT("nvUvmInterfaceSessionCreate() failed: %s\n", nvstatusToString(status));
@@ -137,6 +143,12 @@ NV_STATUS uvm_global_init(void)
         goto error;
     }
 
+    status = uvm_pmm_gpu_eviction_init();
+    if (status != NV_OK) {
+        UVM_ERR_PRINT("uvm_pmm_gpu_eviction_init() failed: %s\n", nvstatusToString(status));
+        goto error;
+    }
+
     status = uvm_mmu_init();
     if (status != NV_OK) {
         UVM_ERR_PRINT("uvm_mmu_init() failed: %s\n", nvstatusToString(status));
@@ -244,6 +256,7 @@ void uvm_global_exit(void)
     if (g_uvm_global.rm_session_handle != 0)
         uvm_rm_locked_call_void(nvUvmInterfaceSessionDestroy(g_uvm_global.rm_session_handle));
 
+    uvm_kvmalloc_procfs_exit();
     uvm_procfs_exit();
 
     nv_kthread_q_stop(&g_uvm_global.global_q);
@@ -558,6 +558,8 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
     NvU64 num_pages_in;
     NvU64 num_pages_out;
     NvU64 mapped_cpu_pages_size;
+    NvU64 num_ce_copies_requested;
+    NvU64 num_ce_copies_issued;
     NvU32 get;
     NvU32 put;
     NvU32 i;
@@ -637,7 +639,7 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_put                  %u\n",
                              gpu->parent->fault_buffer_hal->read_put(gpu->parent));
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_fault_batch_size     %u\n",
-                             gpu->parent->fault_buffer.max_batch_size);
+                             gpu->parent->fault_buffer.replayable.batch_control.batch_size);
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_replay_policy        %s\n",
                              uvm_perf_fault_replay_policy_string(gpu->parent->fault_buffer.replayable.replay_policy));
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_num_faults           %llu\n",
@@ -698,6 +700,12 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
                          mapped_cpu_pages_size / PAGE_SIZE,
                          mapped_cpu_pages_size / (1024u * 1024u));
 
+    num_ce_copies_requested = atomic64_read(&gpu->parent->stats.num_ce_copies_requested);
+    num_ce_copies_issued = atomic64_read(&gpu->parent->stats.num_ce_copies_issued);
+
+    UVM_SEQ_OR_DBG_PRINT(s, "ce_copies_requested                    %llu\n", num_ce_copies_requested);
+    UVM_SEQ_OR_DBG_PRINT(s, "ce_copies_issued                       %llu\n", num_ce_copies_issued);
+
     gpu_info_print_ce_caps(gpu, s);
 
     if (g_uvm_global.conf_computing_enabled) {
@@ -711,6 +719,8 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
 {
     NvU64 num_pages_in;
     NvU64 num_pages_out;
+    struct uvm_fault_batch_control_struct *batch_control = &parent_gpu->fault_buffer.replayable.batch_control;
+    unsigned i;
 
     UVM_ASSERT(uvm_procfs_is_debug_enabled());
 
@@ -738,6 +748,33 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
                          parent_gpu->fault_buffer.replayable.stats.num_replays);
     UVM_SEQ_OR_DBG_PRINT(s, "  start_ack_all        %llu\n",
                          parent_gpu->fault_buffer.replayable.stats.num_replays_ack_all);
+    UVM_SEQ_OR_DBG_PRINT(s, "batch_control:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  adaptive             %u\n", batch_control->enabled);
+    UVM_SEQ_OR_DBG_PRINT(s, "  batch_size           %u [%u:%u]\n",
+                         batch_control->batch_size,
+                         batch_control->min_batch_size,
+                         batch_control->max_batch_size);
+    UVM_SEQ_OR_DBG_PRINT(s, "  replay_policy        %s\n",
+                         uvm_perf_fault_replay_policy_string(parent_gpu->fault_buffer.replayable.replay_policy));
+    UVM_SEQ_OR_DBG_PRINT(s, "  duplicate_ratio      %u%%\n", batch_control->duplicate_ratio);
+    UVM_SEQ_OR_DBG_PRINT(s, "  ns_per_fault         %llu\n", batch_control->ns_per_fault);
+    UVM_SEQ_OR_DBG_PRINT(s, "  buffer_occupancy     %u%%\n", batch_control->occupancy);
+    UVM_SEQ_OR_DBG_PRINT(s, "  batches              %llu\n", batch_control->stats.num_batches);
+    for (i = 0; i < UVM_PERF_FAULT_REPLAY_POLICY_MAX; i++) {
+        UVM_SEQ_OR_DBG_PRINT(s, "    %-40s %llu\n",
+                             uvm_perf_fault_replay_policy_string(i),
+                             batch_control->stats.num_batches_per_policy[i]);
+    }
+    UVM_SEQ_OR_DBG_PRINT(s, "  grows                %llu\n", batch_control->stats.num_grows);
+    UVM_SEQ_OR_DBG_PRINT(s, "  shrinks              %llu\n", batch_control->stats.num_shrinks);
+    UVM_SEQ_OR_DBG_PRINT(s, "  policy_switches      %llu\n", batch_control->stats.num_policy_switches);
+    UVM_SEQ_OR_DBG_PRINT(s, "service_workers:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  workers              %u\n",
+                         parent_gpu->fault_buffer.replayable.service_workers.num_workers);
+    UVM_SEQ_OR_DBG_PRINT(s, "  dispatches           %llu\n",
+                         parent_gpu->fault_buffer.replayable.service_workers.stats.num_dispatches);
+    UVM_SEQ_OR_DBG_PRINT(s, "  blocks               %llu\n",
+                         parent_gpu->fault_buffer.replayable.service_workers.stats.num_blocks);
     UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults  %llu\n", parent_gpu->stats.num_non_replayable_faults);
     UVM_SEQ_OR_DBG_PRINT(s, "faults_by_access_type:\n");
     UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n",
@@ -3162,6 +3199,126 @@ uvm_gpu_link_type_t uvm_parent_gpu_peer_link_type(uvm_parent_gpu_t *parent_gpu0,
     return parent_peer_caps->link_type;
 }
 
+NvU16 uvm_processor_copy_bandwidth_gbps(uvm_va_space_t *va_space, uvm_processor_id_t id0, uvm_processor_id_t id1)
+{
+    uvm_gpu_t *gpu0;
+    uvm_gpu_t *gpu1;
+    NvU32 mbyte_per_s;
+
+    UVM_ASSERT(!uvm_id_equal(id0, id1));
+
+    if (!uvm_processor_mask_test(&va_space->can_copy_from[uvm_id_value(id0)], id1) &&
+        !uvm_processor_mask_test(&va_space->can_copy_from[uvm_id_value(id1)], id0))
+        return 0;
+
+    if (UVM_ID_IS_CPU(id0) || UVM_ID_IS_CPU(id1)) {
+        gpu0 = uvm_gpu_get(UVM_ID_IS_CPU(id0) ? id1 : id0);
+        mbyte_per_s = gpu0->parent->system_bus.link_rate_mbyte_per_s;
+    }
+    else {
+        gpu0 = uvm_gpu_get(id0);
+        gpu1 = uvm_gpu_get(id1);
+        if (uvm_gpus_are_smc_peers(gpu0, gpu1))
+            return NV_U16_MAX;
+
+        mbyte_per_s = parent_gpu_peer_caps(gpu0->parent, gpu1->parent)->total_link_line_rate_mbyte_per_s;
+    }
+
+    // Links with an unknown rate still allow copies
+    return max(min(mbyte_per_s / 1000, (NvU32)NV_U16_MAX), 1u);
+}
+
+typedef struct
+{
+    NvU32 parent;
+    NvU32 child;
+    NvU16 bandwidth;
+    NvU8 depth;
+    NvU8 children;
+    bool saturated;
+} broadcast_edge_t;
+
+// Edge ranking used by uvm_broadcast_plan: parents below their fanout first,
+// then wider links, then shallower parents, then parents with fewer children.
+static bool broadcast_edge_is_better(const broadcast_edge_t *edge, const broadcast_edge_t *best)
+{
+    if (best->parent == UVM_BROADCAST_NO_PARENT)
+        return true;
+
+    if (edge->saturated != best->saturated)
+        return !edge->saturated;
+
+    if (edge->bandwidth != best->bandwidth)
+        return edge->bandwidth > best->bandwidth;
+
+    if (edge->depth != best->depth)
+        return edge->depth < best->depth;
+
+    return edge->children < best->children;
+}
+
+void uvm_broadcast_plan(const uvm_broadcast_topology_t *topology,
+                        NvU32 root,
+                        NvU32 root_fanout,
+                        NvU32 fanout,
+                        uvm_broadcast_plan_t *plan)
+{
+    NvU8 children[UVM_BROADCAST_MAX_NODES] = {0};
+    NvU32 in_tree;
+    NvU32 i;
+
+    UVM_ASSERT(topology->num_nodes <= UVM_BROADCAST_MAX_NODES);
+    UVM_ASSERT(root < topology->num_nodes);
+
+    memset(plan->parent, UVM_BROADCAST_NO_PARENT, sizeof(plan->parent));
+    memset(plan->depth, 0, sizeof(plan->depth));
+
+    plan->order[0] = root;
+    plan->num_ordered = 1;
+    in_tree = 1u << root;
+
+    // Prim-style growth. With at most UVM_BROADCAST_MAX_NODES nodes the cubic
+    // cost is not a concern.
+    while (plan->num_ordered < topology->num_nodes) {
+        broadcast_edge_t best = { .parent = UVM_BROADCAST_NO_PARENT };
+
+        for (i = 0; i < plan->num_ordered; i++) {
+            NvU32 parent = plan->order[i];
+            NvU32 max_children = (parent == root) ? root_fanout : fanout;
+            broadcast_edge_t edge;
+            NvU32 child;
+
+            edge.parent = parent;
+            edge.depth = plan->depth[parent];
+            edge.children = children[parent];
+            edge.saturated = max_children != 0 && children[parent] >= max_children;
+
+            for (child = 0; child < topology->num_nodes; child++) {
+                if (in_tree & (1u << child))
+                    continue;
+
+                edge.child = child;
+                edge.bandwidth = topology->bandwidth[parent][child];
+                if (edge.bandwidth == 0)
+                    continue;
+
+                if (broadcast_edge_is_better(&edge, &best))
+                    best = edge;
+            }
+        }
+
+        // The remaining nodes have no link to the tree
+        if (best.parent == UVM_BROADCAST_NO_PARENT)
+            break;
+
+        plan->parent[best.child] = best.parent;
+        plan->depth[best.child] = plan->depth[best.parent] + 1;
+        plan->order[plan->num_ordered++] = best.child;
+        children[best.parent]++;
+        in_tree |= 1u << best.child;
+    }
+}
+
 uvm_aperture_t uvm_gpu_peer_aperture(uvm_gpu_t *local_gpu, uvm_gpu_t *remote_gpu)
 {
     uvm_parent_gpu_peer_t *parent_peer_caps;
@@ -45,6 +45,7 @@
 #include "uvm_va_block_types.h"
 #include "uvm_perf_module.h"
 #include "uvm_rb_tree.h"
+#include "uvm_batch_sort.h"
 #include "uvm_perf_prefetch.h"
 #include "nv-kthread-q.h"
 #include <linux/mmu_notifier.h>
@@ -297,6 +298,9 @@ struct uvm_fault_service_batch_context_struct
     // max_batch_size
     uvm_fault_buffer_entry_t **ordered_fault_cache;
 
+    // State of the bucketed radix sort used to generate ordered_fault_cache
+    uvm_batch_sort_t batch_sort;
+
     // Per uTLB fault information. Used for replay policies and fault
     // cancellation on Pascal
     uvm_fault_utlb_info_t *utlbs;
@@ -341,6 +345,48 @@ struct uvm_fault_service_batch_context_struct
     uvm_fault_buffer_entry_t *last_fault;
 };
 
+// VA block serviced by a fault service worker, and the index of its first
+// fault in ordered_fault_cache
+typedef struct
+{
+    uvm_va_block_t *va_block;
+
+    NvU32 first_fault_index;
+
+    NvU32 num_faults;
+} uvm_fault_service_block_t;
+
+// Worker used to service the VA blocks of a replayable fault batch in
+// parallel. See uvm_perf_fault_service_workers.
+typedef struct
+{
+    uvm_parent_gpu_t *parent_gpu;
+
+    // Queue with the thread that runs the worker. The first worker does not
+    // have a thread: its work is performed by the bottom half itself.
+    nv_kthread_q_t q;
+
+    nv_kthread_q_item_t q_item;
+
+    // Private batch context. It shares the fault arrays with the batch context
+    // of the bottom half, but counters and the tracker are private to the
+    // worker. They are folded into the bottom half batch context once all the
+    // workers are done.
+    uvm_fault_service_batch_context_t batch_context;
+
+    uvm_service_block_context_t *service_context;
+
+    // State of the current dispatch. The bottom half holds the locks on
+    // behalf of the workers until they are done.
+    uvm_gpu_t *gpu;
+
+    uvm_va_space_t *va_space;
+
+    struct mm_struct *mm;
+
+    NV_STATUS status;
+} uvm_fault_service_worker_t;
+
 struct uvm_ats_fault_invalidate_struct
 {
     bool            tlb_batch_pending;
@@ -382,10 +428,56 @@ typedef struct
         // that comes before the replay method.
         NvU32 replay_update_put_ratio;
 
+        // State of the feedback controller that resizes fault batches and
+        // switches between the batch replay policies at runtime. See
+        // uvm_perf_fault_batch_adaptive. All the fields are only updated with
+        // the replayable faults service lock held.
+        struct uvm_fault_batch_control_struct
+        {
+            bool enabled;
+
+            // Whether the controller may switch between
+            // UVM_PERF_FAULT_REPLAY_POLICY_BATCH and
+            // UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH. It is false if other
+            // policy was explicitly requested.
+            bool adapt_replay_policy;
+
+            // Number of entries fetched per batch. When the controller is
+            // disabled, this is always max_batch_size.
+            NvU32 batch_size;
+
+            // Bounds of batch_size
+            NvU32 min_batch_size;
+            NvU32 max_batch_size;
+
+            // Exponentially-weighted moving averages of the feedback signals:
+            // percentage of duplicate faults per fetched fault, service time
+            // per fetched fault and percentage of the fault buffer that was
+            // still pending after the batch was fetched.
+            NvU32 duplicate_ratio;
+            NvU64 ns_per_fault;
+            NvU32 occupancy;
+
+            struct
+            {
+                NvU64 num_batches;
+
+                NvU64 num_grows;
+
+                NvU64 num_shrinks;
+
+                NvU64 num_policy_switches;
+
+                NvU64 num_batches_per_policy[UVM_PERF_FAULT_REPLAY_POLICY_MAX];
+            } stats;
+        } batch_control;
+
         // Fault statistics. These fields are per-GPU and most of them are only
         // updated during fault servicing, and can be safely incremented.
         // Migrations may be triggered by different GPUs and need to be
-        // incremented using atomics
+        // incremented using atomics. When faults are serviced by multiple
+        // workers (see service_workers below) the non-atomic counters may miss
+        // some increments.
         struct
         {
             NvU64 num_prefetch_faults;
@@ -418,6 +510,31 @@ typedef struct
 
         // Information required to invalidate stale ATS PTEs from the GPU TLBs
         uvm_ats_fault_invalidate_t ats_invalidate;
+
+        // Pool of workers used to service the VA blocks of a batch in
+        // parallel. num_workers is 0 if faults are serviced serially.
+        struct
+        {
+            uvm_fault_service_worker_t *workers;
+
+            NvU32 num_workers;
+
+            // VA blocks of the current dispatch. The array has max_faults
+            // entries.
+            uvm_fault_service_block_t *blocks;
+
+            NvU32 num_blocks;
+
+            // Index of the next entry in blocks to be serviced
+            atomic_t next_block;
+
+            struct
+            {
+                NvU64 num_dispatches;
+
+                NvU64 num_blocks;
+            } stats;
+        } service_workers;
     } replayable;
 
     struct uvm_non_replayable_fault_buffer_struct
@@ -486,6 +603,9 @@ struct uvm_access_counter_service_batch_context_struct
 
     NvU32 num_notifications;
 
+    // State of the bucketed radix sort used to order notifications
+    uvm_batch_sort_t batch_sort;
+
     // Boolean used to avoid sorting the fault batch by instance_ptr if we
     // determine at fetch time that all the access counter notifications in
     // the batch report the same instance_ptr
@@ -1303,6 +1423,12 @@ struct uvm_parent_gpu_struct
         atomic64_t             num_pages_out;
 
         atomic64_t              num_pages_in;
+
+        // Copies requested to the CE coalescers of pushes on this GPU, and CE
+        // transfers actually issued for them. See uvm_ce_coalescer.h.
+        atomic64_t num_ce_copies_requested;
+
+        atomic64_t num_ce_copies_issued;
     } stats;
 
     // Structure to hold nvswitch specific information. In an nvswitch
@@ -1932,4 +2058,59 @@ typedef enum
 // PCIe BAR containing static framebuffer memory mappings for PCIe P2P
 int uvm_device_p2p_static_bar(uvm_parent_gpu_t *gpu);
 
+// Bandwidth in GB/s of copies between the memories of the two processors,
+// which must be registered in the same VA space. 0 is returned if the
+// processors can't copy directly between each other. SMC peers share memory
+// and report the maximum value.
+NvU16 uvm_processor_copy_bandwidth_gbps(uvm_va_space_t *va_space, uvm_processor_id_t id0, uvm_processor_id_t id1);
+
+// Broadcast copy planning.
+//
+// When the same data has to be copied from a source processor to several
+// destinations, as when read-duplicating pages to many GPUs, copying from the
+// source to every destination multiplies the bandwidth drawn from the source.
+// The planner instead builds a spanning tree over the copy topology rooted at
+// the source, in which destinations that already have a copy forward it to
+// the next ones.
+//
+// The planner is a pure function of the topology so it can be tested with
+// synthetic topologies.
+#define UVM_BROADCAST_MAX_NODES 32
+#define UVM_BROADCAST_NO_PARENT 0xff
+
+typedef struct
+{
+    NvU32 num_nodes;
+
+    // Copy bandwidth in GB/s between nodes i and j, 0 if they can't copy
+    // directly between each other. Must be symmetric.
+    NvU16 bandwidth[UVM_BROADCAST_MAX_NODES][UVM_BROADCAST_MAX_NODES];
+} uvm_broadcast_topology_t;
+
+typedef struct
+{
+    // Node each node receives its copy from. The root and nodes which can't be
+    // reached from the root have UVM_BROADCAST_NO_PARENT.
+    NvU8 parent[UVM_BROADCAST_MAX_NODES];
+
+    // Distance to the root in copies, 0 for the root and unreachable nodes
+    NvU8 depth[UVM_BROADCAST_MAX_NODES];
+
+    // Reachable nodes in copy order, starting with the root. Every node comes
+    // after its parent.
+    NvU8 order[UVM_BROADCAST_MAX_NODES];
+    NvU32 num_ordered;
+} uvm_broadcast_plan_t;
+
+// Compute the broadcast tree from root. Nodes are attached one at a time
+// through the widest link to any node already in the tree, preferring shallow
+// parents and then parents with fewer children. The root forwards to at most
+// root_fanout nodes and any other node to at most fanout nodes, unless a node
+// can only be reached through saturated parents. A fanout of 0 means no limit.
+void uvm_broadcast_plan(const uvm_broadcast_topology_t *topology,
+                        NvU32 root,
+                        NvU32 root_fanout,
+                        NvU32 fanout,
+                        uvm_broadcast_plan_t *plan);
+
 #endif // __UVM_GPU_H__
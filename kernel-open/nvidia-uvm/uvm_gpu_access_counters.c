@@ -33,6 +33,7 @@
 #include "uvm_va_range.h"
 #include "uvm_va_space_mm.h"
 #include "uvm_perf_module.h"
+#include "uvm_perf_tiering.h"
 #include "uvm_ats.h"
 #include "uvm_ats_faults.h"
 
@@ -483,6 +484,10 @@ NV_STATUS uvm_parent_gpu_init_access_counters(uvm_parent_gpu_t *parent_gpu, NvU3
         goto fail;
     }
 
+    status = uvm_batch_sort_init(&batch_context->batch_sort, access_counters->max_notifications);
+    if (status != NV_OK)
+        goto fail;
+
     return NV_OK;
 
 fail:
@@ -514,6 +519,7 @@ void uvm_parent_gpu_deinit_access_counters(uvm_parent_gpu_t *parent_gpu, NvU32 n
         access_counters->rm_info.accessCntrBufferHandle = 0;
         uvm_kvfree(batch_context->notification_cache);
         uvm_kvfree(batch_context->notifications);
+        uvm_batch_sort_deinit(&batch_context->batch_sort);
         batch_context->notification_cache = NULL;
         batch_context->notifications = NULL;
     }
@@ -1030,6 +1036,27 @@ static void preprocess_notifications(uvm_parent_gpu_t *parent_gpu,
 
     translate_notifications_instance_ptrs(parent_gpu, batch_context);
 
+    if (uvm_batch_sort_enabled()) {
+        uvm_batch_sort_t *batch_sort = &batch_context->batch_sort;
+        NvU32 i;
+
+        uvm_batch_sort_begin(batch_sort);
+
+        for (i = 0; i < batch_context->num_notifications; ++i) {
+            uvm_access_counter_buffer_entry_t *entry = batch_context->notifications[i];
+
+            uvm_batch_sort_add(batch_sort,
+                               entry,
+                               entry->va_space,
+                               entry->gpu ? uvm_id_value(entry->gpu->id) : 0,
+                               entry->address,
+                               0);
+        }
+
+        if (uvm_batch_sort_end(batch_sort, (void **)batch_context->notifications))
+            return;
+    }
+
     sort(batch_context->notifications,
          batch_context->num_notifications,
          sizeof(*batch_context->notifications),
@@ -1189,7 +1216,12 @@ static NV_STATUS service_va_block_locked(uvm_processor_id_t processor,
         if (!iter.migratable)
             continue;
 
-        thrashing_hint = uvm_perf_thrashing_get_hint(va_block, service_context->block_context, address, processor);
+        thrashing_hint = uvm_perf_thrashing_get_hint(va_block,
+                                                     service_context->block_context,
+                                                     address,
+                                                     processor,
+                                                     uvm_fault_access_type_mask_bit(UVM_FAULT_ACCESS_TYPE_PREFETCH),
+                                                     UVM_SERVICE_OPERATION_ACCESS_COUNTERS);
         if (thrashing_hint.type == UVM_PERF_THRASHING_HINT_TYPE_THROTTLE) {
             // If the page is throttling, ignore the access counter
             // notification
@@ -1288,6 +1320,12 @@ static NV_STATUS service_va_block_locked(uvm_processor_id_t processor,
                 if (status != NV_OK)
                     break;
             }
+
+            // Access counters only notify about memory that is accessed often,
+            // so let the eviction policy know that the memory the pages were
+            // migrated to is worth keeping.
+            if (status == NV_OK && UVM_ID_IS_GPU(processor))
+                uvm_va_block_mark_gpu_memory_hot(va_block, uvm_gpu_get(processor));
         }
     }
 
@@ -1448,6 +1486,11 @@ static NV_STATUS service_notifications_in_block(uvm_gpu_va_space_t *gpu_va_space
     // Atleast one notification should have been processed.
     UVM_ASSERT(index < *out_index);
 
+    // Let the tiering daemon know how hot the block is before the notified
+    // pages are serviced, since servicing filters out the pages that are
+    // already resident on the GPU.
+    uvm_perf_tiering_record_access_counters(va_block, gpu->id, uvm_page_mask_weight(accessed_pages));
+
     batch_context->block_service_context.access_counters_buffer_index = access_counters->index;
 
     status = service_notification_va_block_helper(mm, va_block, gpu->id, batch_context);
@@ -0,0 +1,324 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_common.h"
+#include "uvm_gpu.h"
+#include "uvm_kvmalloc.h"
+#include "uvm_test.h"
+#include "uvm_test_rng.h"
+
+#define NVLINK_GBPS 300
+#define PCIE_GBPS    16
+
+typedef struct
+{
+    uvm_broadcast_topology_t topology;
+    uvm_broadcast_plan_t plan;
+} broadcast_test_state_t;
+
+static void topology_init(uvm_broadcast_topology_t *topology, NvU32 num_nodes)
+{
+    memset(topology, 0, sizeof(*topology));
+    topology->num_nodes = num_nodes;
+}
+
+static void topology_link(uvm_broadcast_topology_t *topology, NvU32 i, NvU32 j, NvU16 bandwidth)
+{
+    topology->bandwidth[i][j] = bandwidth;
+    topology->bandwidth[j][i] = bandwidth;
+}
+
+static NvU32 plan_children(const uvm_broadcast_plan_t *plan, NvU32 num_nodes, NvU32 node)
+{
+    NvU32 count = 0;
+    NvU32 i;
+
+    for (i = 0; i < num_nodes; i++) {
+        if (plan->parent[i] == node)
+            ++count;
+    }
+
+    return count;
+}
+
+// Check the invariants of any plan: the ordered nodes form a tree rooted at
+// root over existing links, every node comes after its parent and the nodes
+// left out have no link to the tree.
+static NV_STATUS check_plan(const uvm_broadcast_topology_t *topology, const uvm_broadcast_plan_t *plan, NvU32 root)
+{
+    NvU32 in_tree = 0;
+    NvU32 node;
+    NvU32 i;
+
+    TEST_CHECK_RET(plan->num_ordered >= 1);
+    TEST_CHECK_RET(plan->num_ordered <= topology->num_nodes);
+    TEST_CHECK_RET(plan->order[0] == root);
+    TEST_CHECK_RET(plan->parent[root] == UVM_BROADCAST_NO_PARENT);
+    TEST_CHECK_RET(plan->depth[root] == 0);
+
+    in_tree = 1u << root;
+    for (i = 1; i < plan->num_ordered; i++) {
+        NvU32 parent;
+
+        node = plan->order[i];
+        TEST_CHECK_RET(node < topology->num_nodes);
+        TEST_CHECK_RET(!(in_tree & (1u << node)));
+
+        parent = plan->parent[node];
+        TEST_CHECK_RET(parent < topology->num_nodes);
+        TEST_CHECK_RET(in_tree & (1u << parent));
+        TEST_CHECK_RET(topology->bandwidth[parent][node] != 0);
+        TEST_CHECK_RET(plan->depth[node] == plan->depth[parent] + 1);
+
+        in_tree |= 1u << node;
+    }
+
+    for (node = 0; node < topology->num_nodes; node++) {
+        if (in_tree & (1u << node))
+            continue;
+
+        TEST_CHECK_RET(plan->parent[node] == UVM_BROADCAST_NO_PARENT);
+        for (i = 0; i < plan->num_ordered; i++)
+            TEST_CHECK_RET(topology->bandwidth[plan->order[i]][node] == 0);
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS test_all_to_all(broadcast_test_state_t *state)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+    NvU32 num_nodes = 8;
+    NvU32 i, j;
+
+    topology_init(topology, num_nodes);
+    for (i = 0; i < num_nodes; i++) {
+        for (j = i + 1; j < num_nodes; j++)
+            topology_link(topology, i, j, NVLINK_GBPS);
+    }
+
+    uvm_broadcast_plan(topology, 0, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan->num_ordered == num_nodes);
+
+    // The source is read once and the remaining 7 nodes form a full binary
+    // tree below its only child.
+    TEST_CHECK_RET(plan_children(plan, num_nodes, 0) == 1);
+    for (i = 1; i < num_nodes; i++) {
+        TEST_CHECK_RET(plan_children(plan, num_nodes, i) <= 2);
+        TEST_CHECK_RET(plan->depth[i] <= 3);
+    }
+
+    // Without fanout limits all the nodes copy from the source
+    uvm_broadcast_plan(topology, 0, 0, 0, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan_children(plan, num_nodes, 0) == num_nodes - 1);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_pcie_only(broadcast_test_state_t *state)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+    NvU32 num_nodes = 5;
+    NvU32 i;
+
+    // Node 0 is the CPU and the GPUs have no peer links. The root fanout has
+    // to be exceeded to reach all of them.
+    topology_init(topology, num_nodes);
+    for (i = 1; i < num_nodes; i++)
+        topology_link(topology, 0, i, PCIE_GBPS);
+
+    uvm_broadcast_plan(topology, 0, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan->num_ordered == num_nodes);
+
+    for (i = 1; i < num_nodes; i++)
+        TEST_CHECK_RET(plan->parent[i] == 0);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_nvlink_islands(broadcast_test_state_t *state)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+    NvU32 num_nodes = 9;
+    NvU32 from_root[2] = {0};
+    NvU32 i, j;
+
+    // Node 0 is the CPU, connected over PCIe to two islands of 4 GPUs with
+    // NVLink within each island.
+    topology_init(topology, num_nodes);
+    for (i = 1; i < num_nodes; i++) {
+        topology_link(topology, 0, i, PCIE_GBPS);
+        for (j = i + 1; j < num_nodes; j++) {
+            if ((i - 1) / 4 == (j - 1) / 4)
+                topology_link(topology, i, j, NVLINK_GBPS);
+        }
+    }
+
+    uvm_broadcast_plan(topology, 0, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan->num_ordered == num_nodes);
+
+    // Each island is entered once from the CPU and the copies within the
+    // island go over NVLink.
+    for (i = 1; i < num_nodes; i++) {
+        if (plan->parent[i] == 0)
+            from_root[(i - 1) / 4]++;
+        else
+            TEST_CHECK_RET(topology->bandwidth[plan->parent[i]][i] == NVLINK_GBPS);
+    }
+
+    TEST_CHECK_RET(from_root[0] == 1);
+    TEST_CHECK_RET(from_root[1] == 1);
+
+    // Rooted in an island, the other island is still entered only once
+    uvm_broadcast_plan(topology, 5, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 5));
+    TEST_CHECK_RET(plan->num_ordered == num_nodes);
+    TEST_CHECK_RET(plan_children(plan, num_nodes, 0) == 1);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_widest_link(broadcast_test_state_t *state)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+
+    topology_init(topology, 3);
+    topology_link(topology, 0, 1, 10);
+    topology_link(topology, 0, 2, 100);
+    topology_link(topology, 1, 2, 50);
+
+    uvm_broadcast_plan(topology, 0, 0, 0, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan->parent[2] == 0);
+    TEST_CHECK_RET(plan->parent[1] == 2);
+    TEST_CHECK_RET(plan->order[1] == 2);
+    TEST_CHECK_RET(plan->order[2] == 1);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_disconnected(broadcast_test_state_t *state)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+
+    // Node 2 has no links and nodes 3 and 4 only link to each other
+    topology_init(topology, 5);
+    topology_link(topology, 0, 1, NVLINK_GBPS);
+    topology_link(topology, 3, 4, NVLINK_GBPS);
+
+    uvm_broadcast_plan(topology, 1, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 1));
+    TEST_CHECK_RET(plan->num_ordered == 2);
+    TEST_CHECK_RET(plan->parent[0] == 1);
+    TEST_CHECK_RET(plan->parent[2] == UVM_BROADCAST_NO_PARENT);
+    TEST_CHECK_RET(plan->parent[3] == UVM_BROADCAST_NO_PARENT);
+    TEST_CHECK_RET(plan->parent[4] == UVM_BROADCAST_NO_PARENT);
+
+    // A single node topology only has the root
+    topology_init(topology, 1);
+    uvm_broadcast_plan(topology, 0, 1, 2, plan);
+    TEST_NV_CHECK_RET(check_plan(topology, plan, 0));
+    TEST_CHECK_RET(plan->num_ordered == 1);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_random(broadcast_test_state_t *state, NvU32 iterations, NvU32 seed)
+{
+    uvm_broadcast_topology_t *topology = &state->topology;
+    uvm_broadcast_plan_t *plan = &state->plan;
+    uvm_test_rng_t rng;
+    NvU32 iter;
+
+    uvm_test_rng_init(&rng, seed);
+
+    for (iter = 0; iter < iterations; iter++) {
+        NvU32 num_nodes = uvm_test_rng_range_32(&rng, 1, UVM_BROADCAST_MAX_NODES);
+        NvU32 root = uvm_test_rng_range_32(&rng, 0, num_nodes - 1);
+        NvU32 root_fanout = uvm_test_rng_range_32(&rng, 0, 3);
+        NvU32 fanout = uvm_test_rng_range_32(&rng, 0, 3);
+        bool full_mesh = uvm_test_rng_range_32(&rng, 0, 1);
+        NvU32 i, j;
+
+        topology_init(topology, num_nodes);
+        for (i = 0; i < num_nodes; i++) {
+            for (j = i + 1; j < num_nodes; j++) {
+                NvU16 bandwidth = uvm_test_rng_range_32(&rng, 0, NVLINK_GBPS);
+
+                if (full_mesh)
+                    bandwidth = max(bandwidth, (NvU16)1);
+
+                topology_link(topology, i, j, bandwidth);
+            }
+        }
+
+        uvm_broadcast_plan(topology, root, root_fanout, fanout, plan);
+        TEST_NV_CHECK_RET(check_plan(topology, plan, root));
+
+        if (!full_mesh)
+            continue;
+
+        // In a full mesh the last node added is never saturated, so the
+        // fanouts are always respected.
+        TEST_CHECK_RET(plan->num_ordered == num_nodes);
+        for (i = 0; i < num_nodes; i++) {
+            NvU32 max_children = (i == root) ? root_fanout : fanout;
+
+            if (max_children != 0)
+                TEST_CHECK_RET(plan_children(plan, num_nodes, i) <= max_children);
+        }
+    }
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_gpu_broadcast_plan(UVM_TEST_GPU_BROADCAST_PLAN_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status;
+    broadcast_test_state_t *state;
+
+    state = uvm_kvmalloc(sizeof(*state));
+    if (!state)
+        return NV_ERR_NO_MEMORY;
+
+    TEST_NV_CHECK_GOTO(test_all_to_all(state), out);
+    TEST_NV_CHECK_GOTO(test_pcie_only(state), out);
+    TEST_NV_CHECK_GOTO(test_nvlink_islands(state), out);
+    TEST_NV_CHECK_GOTO(test_widest_link(state), out);
+    TEST_NV_CHECK_GOTO(test_disconnected(state), out);
+    TEST_NV_CHECK_GOTO(test_random(state, params->iterations, params->seed), out);
+
+out:
+    uvm_kvfree(state);
+
+    return status;
+}
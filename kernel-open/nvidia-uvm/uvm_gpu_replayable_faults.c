@@ -36,6 +36,7 @@
 #include "uvm_va_space_mm.h"
 #include "uvm_procfs.h"
 #include "uvm_perf_thrashing.h"
+#include "uvm_perf_prefetch_stream.h"
 #include "uvm_gpu_non_replayable_faults.h"
 #include "uvm_ats_faults.h"
 #include "uvm_test.h"
@@ -115,6 +116,41 @@ module_param(uvm_perf_fault_max_throttle_per_service, uint, S_IRUGO);
 static unsigned uvm_perf_fault_coalesce = 1;
 module_param(uvm_perf_fault_coalesce, uint, S_IRUGO);
 
+// Enable the feedback controller that resizes fault batches between
+// uvm_perf_fault_batch_adaptive_min and uvm_perf_fault_batch_adaptive_max,
+// starting at uvm_perf_fault_batch_count. When the replay policy is
+// UVM_PERF_FAULT_REPLAY_POLICY_BATCH or UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH
+// the controller also switches between them depending on the ratio of
+// duplicate faults.
+static unsigned uvm_perf_fault_batch_adaptive = 0;
+module_param(uvm_perf_fault_batch_adaptive, uint, S_IRUGO);
+
+#define UVM_PERF_FAULT_BATCH_ADAPTIVE_MIN_DEFAULT 32
+#define UVM_PERF_FAULT_BATCH_ADAPTIVE_MAX_DEFAULT 1024
+
+static unsigned uvm_perf_fault_batch_adaptive_min = UVM_PERF_FAULT_BATCH_ADAPTIVE_MIN_DEFAULT;
+module_param(uvm_perf_fault_batch_adaptive_min, uint, S_IRUGO);
+
+static unsigned uvm_perf_fault_batch_adaptive_max = UVM_PERF_FAULT_BATCH_ADAPTIVE_MAX_DEFAULT;
+module_param(uvm_perf_fault_batch_adaptive_max, uint, S_IRUGO);
+
+#define UVM_PERF_FAULT_BATCH_ADAPTIVE_LATENCY_USEC_DEFAULT 500
+
+// Target service time of a batch. Batches are shrunk when the time it takes to
+// service a full batch exceeds the target, since faults fetched late in a
+// batch wait for all the previous ones to be serviced before being replayed.
+static unsigned uvm_perf_fault_batch_adaptive_latency_usec = UVM_PERF_FAULT_BATCH_ADAPTIVE_LATENCY_USEC_DEFAULT;
+module_param(uvm_perf_fault_batch_adaptive_latency_usec, uint, S_IRUGO);
+
+#define UVM_PERF_FAULT_SERVICE_WORKERS_MAX 16
+
+// Number of workers, including the bottom half, that service the VA blocks of
+// a replayable fault batch in parallel. 0 and 1 service batches serially.
+// Only faults on managed allocations are serviced in parallel, and only when
+// replays are issued per batch.
+static unsigned uvm_perf_fault_service_workers = 0;
+module_param(uvm_perf_fault_service_workers, uint, S_IRUGO);
+
 // This function is used for both the initial fault buffer initialization and
 // the power management resume path.
 static void fault_buffer_reinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
@@ -135,6 +171,133 @@ static void fault_buffer_reinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
         parent_gpu->arch_hal->disable_prefetch_faults(parent_gpu);
 }
 
+static void fault_batch_control_init(uvm_parent_gpu_t *parent_gpu)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    NvU32 min_batch_size;
+    NvU32 max_batch_size;
+
+    memset(&replayable_faults->batch_control, 0, sizeof(replayable_faults->batch_control));
+
+    replayable_faults->batch_control.enabled = uvm_perf_fault_batch_adaptive != 0;
+    replayable_faults->batch_control.batch_size = parent_gpu->fault_buffer.max_batch_size;
+    replayable_faults->batch_control.min_batch_size = parent_gpu->fault_buffer.max_batch_size;
+    replayable_faults->batch_control.max_batch_size = parent_gpu->fault_buffer.max_batch_size;
+
+    if (!replayable_faults->batch_control.enabled)
+        return;
+
+    max_batch_size = min(max(uvm_perf_fault_batch_adaptive_max, (NvU32)UVM_PERF_FAULT_BATCH_COUNT_MIN),
+                         replayable_faults->max_faults);
+    min_batch_size = min(max(uvm_perf_fault_batch_adaptive_min, (NvU32)UVM_PERF_FAULT_BATCH_COUNT_MIN),
+                         max_batch_size);
+
+    if (max_batch_size != uvm_perf_fault_batch_adaptive_max || min_batch_size != uvm_perf_fault_batch_adaptive_min) {
+        UVM_INFO_PRINT("Invalid uvm_perf_fault_batch_adaptive_min/max values on GPU %s: [%u:%u]. Using [%u:%u] instead\n",
+                       uvm_parent_gpu_name(parent_gpu),
+                       uvm_perf_fault_batch_adaptive_min,
+                       uvm_perf_fault_batch_adaptive_max,
+                       min_batch_size,
+                       max_batch_size);
+    }
+
+    replayable_faults->batch_control.min_batch_size = min_batch_size;
+    replayable_faults->batch_control.max_batch_size = max_batch_size;
+    replayable_faults->batch_control.batch_size = clamp(parent_gpu->fault_buffer.max_batch_size,
+                                                        min_batch_size,
+                                                        max_batch_size);
+    replayable_faults->batch_control.adapt_replay_policy =
+        replayable_faults->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH ||
+        replayable_faults->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH;
+}
+
+static void fault_service_worker_entry(void *args);
+
+// There is no error handling in this function. The caller is in charge of
+// calling fault_service_workers_deinit on failure.
+static NV_STATUS fault_service_workers_init(uvm_parent_gpu_t *parent_gpu)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    NvU32 num_workers = min(uvm_perf_fault_service_workers, (NvU32)UVM_PERF_FAULT_SERVICE_WORKERS_MAX);
+    NvU32 i;
+
+    if (num_workers != uvm_perf_fault_service_workers) {
+        UVM_INFO_PRINT("Invalid uvm_perf_fault_service_workers value on GPU %s: %u. Using %u instead\n",
+                       uvm_parent_gpu_name(parent_gpu),
+                       uvm_perf_fault_service_workers,
+                       num_workers);
+    }
+
+    if (num_workers < 2)
+        return NV_OK;
+
+    replayable_faults->service_workers.blocks =
+        uvm_kvmalloc(replayable_faults->max_faults * sizeof(*replayable_faults->service_workers.blocks));
+    if (!replayable_faults->service_workers.blocks)
+        return NV_ERR_NO_MEMORY;
+
+    replayable_faults->service_workers.workers =
+        uvm_kvmalloc_zero(num_workers * sizeof(*replayable_faults->service_workers.workers));
+    if (!replayable_faults->service_workers.workers)
+        return NV_ERR_NO_MEMORY;
+
+    for (i = 0; i < num_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &replayable_faults->service_workers.workers[i];
+        char kthread_name[TASK_COMM_LEN + 1];
+        NV_STATUS status;
+
+        worker->parent_gpu = parent_gpu;
+        uvm_tracker_init(&worker->batch_context.tracker);
+        ++replayable_faults->service_workers.num_workers;
+
+        worker->service_context = uvm_service_block_context_alloc(NULL);
+        if (!worker->service_context)
+            return NV_ERR_NO_MEMORY;
+
+        // The work of the first worker is performed by the bottom half
+        if (i == 0)
+            continue;
+
+        nv_kthread_q_item_init(&worker->q_item, fault_service_worker_entry, worker);
+
+        snprintf(kthread_name, sizeof(kthread_name), "UVM GPU%u W%u", uvm_parent_id_value(parent_gpu->id), i);
+        status = errno_to_nv_status(nv_kthread_q_init_on_node(&worker->q,
+                                                              kthread_name,
+                                                              parent_gpu->closest_cpu_numa_node));
+        if (status != NV_OK) {
+            UVM_ERR_PRINT("Failed in nv_kthread_q_init for fault service worker %u: %s, GPU %s\n",
+                          i,
+                          nvstatusToString(status),
+                          uvm_parent_gpu_name(parent_gpu));
+            return status;
+        }
+    }
+
+    return NV_OK;
+}
+
+static void fault_service_workers_deinit(uvm_parent_gpu_t *parent_gpu)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    NvU32 i;
+
+    for (i = 0; i < replayable_faults->service_workers.num_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &replayable_faults->service_workers.workers[i];
+
+        nv_kthread_q_stop(&worker->q);
+        uvm_service_block_context_free(worker->service_context);
+
+        UVM_ASSERT(uvm_tracker_is_empty(&worker->batch_context.tracker));
+        uvm_tracker_deinit(&worker->batch_context.tracker);
+    }
+
+    uvm_kvfree(replayable_faults->service_workers.workers);
+    uvm_kvfree(replayable_faults->service_workers.blocks);
+    replayable_faults->service_workers.workers = NULL;
+    replayable_faults->service_workers.blocks = NULL;
+    replayable_faults->service_workers.num_workers = 0;
+}
+
 // There is no error handling in this function. The caller is in charge of
 // calling fault_buffer_deinit_replayable_faults on failure.
 static NV_STATUS fault_buffer_init_replayable_faults(uvm_parent_gpu_t *parent_gpu)
@@ -176,6 +339,10 @@ static NV_STATUS fault_buffer_init_replayable_faults(uvm_parent_gpu_t *parent_gp
     if (!batch_context->ordered_fault_cache)
         return NV_ERR_NO_MEMORY;
 
+    status = uvm_batch_sort_init(&batch_context->batch_sort, replayable_faults->max_faults);
+    if (status != NV_OK)
+        return status;
+
     // This value must be initialized by HAL
     UVM_ASSERT(replayable_faults->utlb_count > 0);
 
@@ -212,6 +379,12 @@ static NV_STATUS fault_buffer_init_replayable_faults(uvm_parent_gpu_t *parent_gp
                        replayable_faults->replay_update_put_ratio);
     }
 
+    fault_batch_control_init(parent_gpu);
+
+    status = fault_service_workers_init(parent_gpu);
+    if (status != NV_OK)
+        return status;
+
     // Re-enable fault prefetching just in case it was disabled in a previous run
     parent_gpu->fault_buffer.prefetch_faults_enabled = parent_gpu->prefetch_fault_supported;
 
@@ -225,6 +398,8 @@ static void fault_buffer_deinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
     uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
     uvm_fault_service_batch_context_t *batch_context = &replayable_faults->batch_service_context;
 
+    fault_service_workers_deinit(parent_gpu);
+
     if (batch_context->fault_cache) {
         UVM_ASSERT(uvm_tracker_is_empty(&replayable_faults->replay_tracker));
         uvm_tracker_deinit(&replayable_faults->replay_tracker);
@@ -239,6 +414,7 @@ static void fault_buffer_deinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
     uvm_kvfree(batch_context->fault_cache);
     uvm_kvfree(batch_context->ordered_fault_cache);
     uvm_kvfree(batch_context->utlbs);
+    uvm_batch_sort_deinit(&batch_context->batch_sort);
     batch_context->fault_cache         = NULL;
     batch_context->ordered_fault_cache = NULL;
     batch_context->utlbs               = NULL;
@@ -888,7 +1064,7 @@ static NV_STATUS fetch_fault_buffer_entries(uvm_parent_gpu_t *parent_gpu,
 
     // Parse until get != put and have enough space to cache.
     while ((get != put) &&
-           (fetch_mode == FAULT_FETCH_MODE_ALL || fault_index < parent_gpu->fault_buffer.max_batch_size)) {
+           (fetch_mode == FAULT_FETCH_MODE_ALL || fault_index < replayable_faults->batch_control.batch_size)) {
         bool is_same_instance_ptr = true;
         uvm_fault_buffer_entry_t *current_entry = &fault_cache[fault_index];
         uvm_fault_utlb_info_t *current_tlb;
@@ -1019,6 +1195,42 @@ static int cmp_sort_fault_entry_by_va_space_gpu_address_access_type(const void *
     return cmp_access_type((*a)->fault_access_type, (*b)->fault_access_type);
 }
 
+// Sort ordered_fault_cache by va_space, GPU ID, fault address, and fault access
+// type. The bucketed radix sort produces the same order as the comparison sort,
+// except that faults with the same key keep their relative order.
+static void sort_fault_entries_by_va_space_gpu_address_access_type(uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
+    uvm_batch_sort_t *batch_sort = &batch_context->batch_sort;
+    NvU32 i;
+
+    if (uvm_batch_sort_enabled()) {
+        uvm_batch_sort_begin(batch_sort);
+
+        // Access types are sorted by decreasing "intrusiveness", see
+        // cmp_access_type
+        for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+            uvm_fault_buffer_entry_t *entry = ordered_fault_cache[i];
+
+            uvm_batch_sort_add(batch_sort,
+                               entry,
+                               entry->va_space,
+                               entry->gpu ? uvm_id_value(entry->gpu->id) : 0,
+                               entry->fault_address,
+                               UVM_FAULT_ACCESS_TYPE_COUNT - 1 - entry->fault_access_type);
+        }
+
+        if (uvm_batch_sort_end(batch_sort, (void **)ordered_fault_cache))
+            return;
+    }
+
+    sort(ordered_fault_cache,
+         batch_context->num_coalesced_faults,
+         sizeof(*ordered_fault_cache),
+         cmp_sort_fault_entry_by_va_space_gpu_address_access_type,
+         NULL);
+}
+
 // Translate all instance pointers to a VA space and GPU instance. Since the
 // buffer is ordered by instance_ptr, we minimize the number of translations.
 //
@@ -1168,11 +1380,7 @@ static NV_STATUS preprocess_fault_batch(uvm_parent_gpu_t *parent_gpu,
 
     // 3) sort by va_space, GPU ID, fault address (GPU already reports
     // 4K-aligned address), and access type.
-    sort(ordered_fault_cache,
-         batch_context->num_coalesced_faults,
-         sizeof(*ordered_fault_cache),
-         cmp_sort_fault_entry_by_va_space_gpu_address_access_type,
-         NULL);
+    sort_fault_entries_by_va_space_gpu_address_access_type(batch_context);
 
     return NV_OK;
 }
@@ -1376,6 +1584,7 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
                                                   uvm_va_block_t *va_block,
                                                   uvm_va_block_retry_t *va_block_retry,
                                                   uvm_fault_service_batch_context_t *batch_context,
+                                                  uvm_service_block_context_t *block_context,
                                                   NvU32 first_fault_index,
                                                   const bool hmm_migratable,
                                                   NvU32 *block_faults)
@@ -1386,10 +1595,8 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
     uvm_page_index_t last_page_index;
     NvU32 page_fault_count = 0;
     uvm_range_group_range_iter_t iter;
-    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
     uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
     uvm_fault_buffer_entry_t *first_fault_entry = ordered_fault_cache[first_fault_index];
-    uvm_service_block_context_t *block_context = &replayable_faults->block_service_context;
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
     const uvm_va_policy_t *policy;
     NvU64 end;
@@ -1524,7 +1731,9 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
         thrashing_hint = uvm_perf_thrashing_get_hint(va_block,
                                                      block_context->block_context,
                                                      current_entry->fault_address,
-                                                     gpu->id);
+                                                     gpu->id,
+                                                     service_access_type_mask,
+                                                     UVM_SERVICE_OPERATION_REPLAYABLE_FAULTS);
         if (thrashing_hint.type == UVM_PERF_THRASHING_HINT_TYPE_THROTTLE) {
             // Throttling is implemented by sleeping in the fault handler on
             // the CPU and by continuing to process faults on other pages on
@@ -1606,6 +1815,7 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
 static NV_STATUS service_fault_batch_block(uvm_gpu_t *gpu,
                                            uvm_va_block_t *va_block,
                                            uvm_fault_service_batch_context_t *batch_context,
+                                           uvm_service_block_context_t *fault_block_context,
                                            NvU32 first_fault_index,
                                            const bool hmm_migratable,
                                            NvU32 *block_faults)
@@ -1613,8 +1823,6 @@ static NV_STATUS service_fault_batch_block(uvm_gpu_t *gpu,
     NV_STATUS status;
     uvm_va_block_retry_t va_block_retry;
     NV_STATUS tracker_status;
-    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
-    uvm_service_block_context_t *fault_block_context = &replayable_faults->block_service_context;
 
     fault_block_context->operation = UVM_SERVICE_OPERATION_REPLAYABLE_FAULTS;
     fault_block_context->num_retries = 0;
@@ -1629,6 +1837,7 @@ static NV_STATUS service_fault_batch_block(uvm_gpu_t *gpu,
                                                                         va_block,
                                                                         &va_block_retry,
                                                                         batch_context,
+                                                                        fault_block_context,
                                                                         first_fault_index,
                                                                         hmm_migratable,
                                                                         block_faults));
@@ -1980,7 +2189,21 @@ static NV_STATUS service_fault_batch_dispatch(uvm_va_space_t *va_space,
         status = NV_ERR_INVALID_ADDRESS;
 
     if (status == NV_OK) {
-        status = service_fault_batch_block(gpu, va_block, batch_context, fault_index, hmm_migratable, block_faults);
+        uvm_service_block_context_t *service_context = &gpu->parent->fault_buffer.replayable.block_service_context;
+
+        status = service_fault_batch_block(gpu,
+                                           va_block,
+                                           batch_context,
+                                           service_context,
+                                           fault_index,
+                                           hmm_migratable,
+                                           block_faults);
+
+        // Prefetch the blocks ahead of sequential or strided fault streams
+        // that were trained by the faults just serviced. The migrations are
+        // added to the batch tracker, so they are waited on before the replay.
+        if (status == NV_OK && va_range)
+            status = uvm_perf_prefetch_stream_service_ahead(va_block, gpu, service_context, &batch_context->tracker);
     }
     else if ((status == NV_ERR_INVALID_ADDRESS) && uvm_ats_can_service_faults(gpu_va_space, mm)) {
         NvU64 outer = ~0ULL;
@@ -2223,6 +2446,230 @@ done:
     return status;
 }
 
+// Group the faults starting at fault_index into the VA blocks that they fall
+// in, and store them in the blocks array of the service workers. Grouping
+// stops at the first fault that does not belong to a managed VA range of the
+// given VA space and GPU. That fault, and the ones after it, are left to
+// service_fault_batch_dispatch().
+//
+// Returns the number of blocks found.
+static NvU32 service_fault_batch_partition(uvm_va_space_t *va_space,
+                                           uvm_gpu_t *gpu,
+                                           uvm_fault_service_batch_context_t *batch_context,
+                                           NvU32 fault_index)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
+    uvm_fault_service_block_t *blocks = replayable_faults->service_workers.blocks;
+    uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
+    NvU32 num_blocks = 0;
+    NvU32 i = fault_index;
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    while (i < batch_context->num_coalesced_faults) {
+        uvm_fault_buffer_entry_t *current_entry = ordered_fault_cache[i];
+        uvm_va_range_managed_t *managed_range;
+        uvm_va_block_t *va_block;
+        NV_STATUS status;
+
+        if (current_entry->va_space != va_space || current_entry->gpu != gpu || current_entry->is_fatal)
+            break;
+
+        managed_range = uvm_va_range_managed_find(va_space, current_entry->fault_address);
+        if (!managed_range)
+            break;
+
+        // Errors are reported by the serial path when it retries the fault
+        status = uvm_va_range_block_create(managed_range,
+                                           uvm_va_range_block_index(managed_range, current_entry->fault_address),
+                                           &va_block);
+        if (status != NV_OK)
+            break;
+
+        blocks[num_blocks].va_block = va_block;
+        blocks[num_blocks].first_fault_index = i;
+
+        // Unserviceable faults cannot share a VA block with serviceable faults
+        // so it is safe to group all the faults within the block.
+        for (++i;
+             i < batch_context->num_coalesced_faults &&
+             ordered_fault_cache[i]->va_space == va_space &&
+             ordered_fault_cache[i]->gpu == gpu &&
+             ordered_fault_cache[i]->fault_address <= va_block->end;
+             ++i)
+            ;
+
+        blocks[num_blocks].num_faults = i - blocks[num_blocks].first_fault_index;
+        ++num_blocks;
+    }
+
+    return num_blocks;
+}
+
+// Service VA blocks from the blocks array until all of them have been claimed
+// by a worker.
+static void fault_service_worker_run(uvm_fault_service_worker_t *worker)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &worker->parent_gpu->fault_buffer.replayable;
+    NvU32 block_index;
+
+    worker->status = NV_OK;
+
+    while ((block_index = atomic_inc_return(&replayable_faults->service_workers.next_block) - 1) <
+           replayable_faults->service_workers.num_blocks) {
+        uvm_fault_service_block_t *block = &replayable_faults->service_workers.blocks[block_index];
+        NvU32 block_faults;
+        NV_STATUS status;
+
+        status = service_fault_batch_block(worker->gpu,
+                                           block->va_block,
+                                           &worker->batch_context,
+                                           worker->service_context,
+                                           block->first_fault_index,
+                                           true,
+                                           &block_faults);
+        if (status == NV_OK) {
+            UVM_ASSERT(block_faults == block->num_faults);
+            status = uvm_perf_prefetch_stream_service_ahead(block->va_block,
+                                                            worker->gpu,
+                                                            worker->service_context,
+                                                            &worker->batch_context.tracker);
+        }
+
+        // Keep draining the blocks on error so that the other workers are not
+        // left with more work, but only report the first error.
+        if (status != NV_OK && worker->status == NV_OK)
+            worker->status = status;
+    }
+}
+
+static void fault_service_worker(void *args)
+{
+    uvm_fault_service_worker_t *worker = (uvm_fault_service_worker_t *)args;
+
+    // The mmap_lock and the VA space lock are held by the bottom half, which
+    // waits for this worker to complete before releasing them. Record their
+    // ownership so that lock assertions within the servicing path hold on
+    // this thread.
+    if (worker->mm)
+        uvm_record_lock_mmap_lock_read(worker->mm);
+    uvm_record_lock(&worker->va_space->lock, UVM_LOCK_FLAGS_MODE_SHARED);
+
+    fault_service_worker_run(worker);
+
+    uvm_record_unlock(&worker->va_space->lock, UVM_LOCK_FLAGS_MODE_SHARED);
+    if (worker->mm)
+        uvm_record_unlock_mmap_lock_read(worker->mm);
+}
+
+static void fault_service_worker_entry(void *args)
+{
+    UVM_ENTRY_VOID(fault_service_worker(args));
+}
+
+// Service the faults starting at fault_index on the workers of the GPU, one
+// VA block at a time. Faults are only serviced in parallel when they span at
+// least two VA blocks of managed VA ranges. block_faults is set to the number
+// of faults serviced, which is 0 if the serial path must be used instead.
+//
+// Replays are not issued per VA block, so this is not used with
+// UVM_PERF_FAULT_REPLAY_POLICY_BLOCK.
+//
+// Locking: the caller must hold the VA space lock in read mode, and the
+// mmap_lock if mm is not NULL.
+static NV_STATUS service_fault_batch_parallel(uvm_va_space_t *va_space,
+                                              uvm_gpu_va_space_t *gpu_va_space,
+                                              struct mm_struct *mm,
+                                              uvm_fault_service_batch_context_t *batch_context,
+                                              NvU32 fault_index,
+                                              NvU32 *block_faults)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_t *gpu = gpu_va_space->gpu;
+    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
+    NvU32 num_workers;
+    NvU32 num_blocks;
+    NvU32 i;
+
+    *block_faults = 0;
+
+    num_blocks = service_fault_batch_partition(va_space, gpu, batch_context, fault_index);
+    if (num_blocks < 2)
+        return NV_OK;
+
+    num_workers = min(replayable_faults->service_workers.num_workers, num_blocks);
+
+    replayable_faults->service_workers.num_blocks = num_blocks;
+    atomic_set(&replayable_faults->service_workers.next_block, 0);
+
+    for (i = 0; i < num_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &replayable_faults->service_workers.workers[i];
+        uvm_fault_service_batch_context_t *worker_batch_context = &worker->batch_context;
+
+        UVM_ASSERT(uvm_tracker_is_empty(&worker_batch_context->tracker));
+
+        worker_batch_context->fault_cache = batch_context->fault_cache;
+        worker_batch_context->ordered_fault_cache = batch_context->ordered_fault_cache;
+        worker_batch_context->utlbs = batch_context->utlbs;
+        worker_batch_context->num_coalesced_faults = batch_context->num_coalesced_faults;
+        worker_batch_context->batch_id = batch_context->batch_id;
+        worker_batch_context->fatal_va_space = batch_context->fatal_va_space;
+        worker_batch_context->fatal_gpu = batch_context->fatal_gpu;
+        worker_batch_context->has_throttled_faults = false;
+        worker_batch_context->num_invalid_prefetch_faults = 0;
+        worker_batch_context->num_duplicate_faults = 0;
+
+        worker->gpu = gpu;
+        worker->va_space = va_space;
+        worker->mm = mm;
+        uvm_va_block_context_init(worker->service_context->block_context, mm);
+
+        if (i > 0)
+            nv_kthread_q_schedule_q_item(&worker->q, &worker->q_item);
+    }
+
+    // The bottom half acts as the first worker
+    fault_service_worker_run(&replayable_faults->service_workers.workers[0]);
+
+    for (i = 0; i < num_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &replayable_faults->service_workers.workers[i];
+        uvm_fault_service_batch_context_t *worker_batch_context = &worker->batch_context;
+        NV_STATUS tracker_status;
+
+        if (i > 0)
+            nv_kthread_q_flush(&worker->q);
+
+        tracker_status = uvm_tracker_add_tracker_safe(&batch_context->tracker, &worker_batch_context->tracker);
+        uvm_tracker_clear(&worker_batch_context->tracker);
+
+        batch_context->num_duplicate_faults += worker_batch_context->num_duplicate_faults;
+        batch_context->num_invalid_prefetch_faults += worker_batch_context->num_invalid_prefetch_faults;
+        batch_context->has_throttled_faults |= worker_batch_context->has_throttled_faults;
+
+        if (!batch_context->fatal_va_space && worker_batch_context->fatal_va_space) {
+            batch_context->fatal_va_space = worker_batch_context->fatal_va_space;
+            batch_context->fatal_gpu = worker_batch_context->fatal_gpu;
+        }
+
+        if (status == NV_OK)
+            status = worker->status;
+        if (status == NV_OK)
+            status = tracker_status;
+
+        worker->gpu = NULL;
+        worker->va_space = NULL;
+        worker->mm = NULL;
+    }
+
+    for (i = 0; i < num_blocks; ++i)
+        *block_faults += replayable_faults->service_workers.blocks[i].num_faults;
+
+    ++replayable_faults->service_workers.stats.num_dispatches;
+    replayable_faults->service_workers.stats.num_blocks += num_blocks;
+
+    return status;
+}
+
 // Scan the ordered view of faults and group them by different va_blocks
 // (managed faults) and service faults for each va_block, in batch.
 // Service non-managed faults one at a time as they are encountered during the
@@ -2322,6 +2769,22 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
             continue;
         }
 
+        // Service the VA blocks of managed faults on the worker pool, if
+        // there is one. Anything that cannot be serviced by the workers falls
+        // back to the serial path below.
+        if (!replay_per_va_block &&
+            service_mode == FAULT_SERVICE_MODE_REGULAR &&
+            parent_gpu->fault_buffer.replayable.service_workers.num_workers > 1) {
+            status = service_fault_batch_parallel(va_space, gpu_va_space, mm, batch_context, i, &block_faults);
+            if (status != NV_OK)
+                goto fail;
+
+            if (block_faults > 0) {
+                i += block_faults;
+                continue;
+            }
+        }
+
         status = service_fault_batch_dispatch(va_space,
                                               gpu_va_space,
                                               batch_context,
@@ -2888,7 +3351,8 @@ static void enable_disable_prefetch_faults(uvm_parent_gpu_t *parent_gpu,
     // fault reporting. If the logic changes, the tests will have to be changed.
     if (parent_gpu->fault_buffer.prefetch_faults_enabled &&
         uvm_perf_reenable_prefetch_faults_lapse_msec > 0 &&
-        ((batch_context->num_invalid_prefetch_faults * 3 > parent_gpu->fault_buffer.max_batch_size * 2) ||
+        ((batch_context->num_invalid_prefetch_faults * 3 >
+          parent_gpu->fault_buffer.replayable.batch_control.batch_size * 2) ||
          (uvm_enable_builtin_tests &&
           parent_gpu->rm_info.isSimulated &&
           batch_context->num_invalid_prefetch_faults > 5))) {
@@ -2903,11 +3367,98 @@ static void enable_disable_prefetch_faults(uvm_parent_gpu_t *parent_gpu,
     }
 }
 
+// Number of entries in the fault buffer that were not fetched yet, according
+// to the cached GET/PUT values
+static NvU32 fault_buffer_num_pending(uvm_replayable_fault_buffer_t *replayable_faults)
+{
+    if (replayable_faults->cached_put >= replayable_faults->cached_get)
+        return replayable_faults->cached_put - replayable_faults->cached_get;
+
+    return replayable_faults->max_faults - replayable_faults->cached_get + replayable_faults->cached_put;
+}
+
+// Moving average that gives a weight of 1/4 to the new sample
+#define FAULT_BATCH_CONTROL_EWMA(average, sample) (((average) * 3 + (sample)) / 4)
+
+// Feed the results of the last serviced batch to the batch controller, which
+// computes the size of the next batch and, if allowed, its replay policy.
+//
+// Batches are doubled while there is a backlog of faults in the buffer that
+// can be serviced within the latency target, which amortizes the per-batch
+// costs (fetch, flush, replay and tracker waits) during fault storms. Batches
+// are halved when a full batch exceeds the latency target or when most of the
+// fetched faults are duplicates, which happens when warps keep re-faulting on
+// addresses that are waiting in a long batch.
+//
+// The duplicate ratio also picks the replay policy: flushing the buffer before
+// replaying discards duplicates but is only worth its cost when there are
+// many of them.
+static void fault_batch_control_update(uvm_parent_gpu_t *parent_gpu,
+                                       uvm_fault_service_batch_context_t *batch_context,
+                                       NvU32 num_pending,
+                                       NvU64 service_time_ns)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    struct uvm_fault_batch_control_struct *control = &replayable_faults->batch_control;
+    const NvU64 latency_target_ns = (NvU64)uvm_perf_fault_batch_adaptive_latency_usec * 1000;
+    const NvU32 duplicate_threshold = replayable_faults->replay_update_put_ratio;
+    NvU32 num_faults = batch_context->num_cached_faults;
+    NvU32 duplicate_ratio;
+    NvU64 batch_time_ns;
+
+    ++control->stats.num_batches;
+    ++control->stats.num_batches_per_policy[replayable_faults->replay_policy];
+
+    if (!control->enabled || num_faults == 0)
+        return;
+
+    duplicate_ratio = (NvU32)min((NvU64)batch_context->num_duplicate_faults * 100 / num_faults, 100ULL);
+
+    control->duplicate_ratio = FAULT_BATCH_CONTROL_EWMA(control->duplicate_ratio, duplicate_ratio);
+    control->ns_per_fault = FAULT_BATCH_CONTROL_EWMA(control->ns_per_fault, service_time_ns / num_faults);
+    control->occupancy = FAULT_BATCH_CONTROL_EWMA(control->occupancy,
+                                                  num_pending * 100 / replayable_faults->max_faults);
+
+    // Expected time to service a full batch of the current size
+    batch_time_ns = control->ns_per_fault * control->batch_size;
+
+    if (control->batch_size > control->min_batch_size &&
+        ((latency_target_ns && batch_time_ns > latency_target_ns) || control->duplicate_ratio > duplicate_threshold)) {
+        control->batch_size = max(control->batch_size / 2, control->min_batch_size);
+        ++control->stats.num_shrinks;
+    }
+    else if (control->batch_size < control->max_batch_size &&
+             num_faults >= control->batch_size &&
+             num_pending >= control->batch_size &&
+             (!latency_target_ns || batch_time_ns * 2 <= latency_target_ns) &&
+             control->duplicate_ratio <= duplicate_threshold / 2) {
+        control->batch_size = min(control->batch_size * 2, control->max_batch_size);
+        ++control->stats.num_grows;
+    }
+
+    if (control->adapt_replay_policy) {
+        uvm_perf_fault_replay_policy_t replay_policy = replayable_faults->replay_policy;
+
+        // Hysteresis between the two thresholds avoids flip-flopping
+        if (control->duplicate_ratio > duplicate_threshold)
+            replay_policy = UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH;
+        else if (control->duplicate_ratio < duplicate_threshold / 2)
+            replay_policy = UVM_PERF_FAULT_REPLAY_POLICY_BATCH;
+
+        if (replay_policy != replayable_faults->replay_policy) {
+            replayable_faults->replay_policy = replay_policy;
+            ++control->stats.num_policy_switches;
+        }
+    }
+}
+
 void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
 {
     NvU32 num_replays = 0;
     NvU32 num_batches = 0;
     NvU32 num_throttled = 0;
+    NvU32 num_pending;
+    NvU64 batch_start;
     NV_STATUS status = NV_OK;
     uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
     uvm_fault_service_batch_context_t *batch_context = &replayable_faults->batch_service_context;
@@ -2939,6 +3490,9 @@ void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
 
         ++batch_context->batch_id;
 
+        num_pending = fault_buffer_num_pending(replayable_faults);
+        batch_start = NV_GETTIME();
+
         status = preprocess_fault_batch(parent_gpu, batch_context);
 
         num_replays += batch_context->num_replays;
@@ -3006,6 +3560,8 @@ void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
                 break;
         }
 
+        fault_batch_control_update(parent_gpu, batch_context, num_pending, NV_GETTIME() - batch_start);
+
         if (batch_context->has_throttled_faults)
             ++num_throttled;
 
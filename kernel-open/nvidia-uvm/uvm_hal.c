@@ -84,6 +84,7 @@ static uvm_hal_class_ops_t ce_table[] =
             .memcopy_is_valid = uvm_hal_maxwell_ce_memcopy_is_valid,
             .memcopy_patch_src = uvm_hal_ce_memcopy_patch_src_stub,
             .memcopy = uvm_hal_maxwell_ce_memcopy,
+            .memcopy_strided = uvm_hal_maxwell_ce_memcopy_strided,
             .memcopy_v_to_v = uvm_hal_maxwell_ce_memcopy_v_to_v,
             .memset_is_valid = uvm_hal_maxwell_ce_memset_is_valid,
             .memset_1 = uvm_hal_maxwell_ce_memset_1,
@@ -118,6 +119,7 @@ static uvm_hal_class_ops_t ce_table[] =
             .semaphore_timestamp = uvm_hal_volta_ce_semaphore_timestamp,
             .semaphore_reduction_inc = uvm_hal_volta_ce_semaphore_reduction_inc,
             .memcopy = uvm_hal_volta_ce_memcopy,
+            .memcopy_strided = uvm_hal_volta_ce_memcopy_strided,
             .memset_1 = uvm_hal_volta_ce_memset_1,
             .memset_4 = uvm_hal_volta_ce_memset_4,
             .memset_8 = uvm_hal_volta_ce_memset_8,
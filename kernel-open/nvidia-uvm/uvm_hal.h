@@ -386,6 +386,33 @@ typedef void (*uvm_hal_memcopy_t)(uvm_push_t *push, uvm_gpu_address_t dst, uvm_g
 void uvm_hal_maxwell_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu_address_t src, size_t size);
 void uvm_hal_volta_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu_address_t src, size_t size);
 
+// Memcopy line_count lines of line_size bytes each in a single transfer. Line
+// i is copied from src + i * src_pitch to dst + i * dst_pitch. Lines cannot
+// overlap, so both pitches must be at least line_size.
+//
+// The same push flags as in uvm_hal_memcopy_t apply.
+typedef void (*uvm_hal_memcopy_strided_t)(uvm_push_t *push,
+                                          uvm_gpu_address_t dst,
+                                          NvU32 dst_pitch,
+                                          uvm_gpu_address_t src,
+                                          NvU32 src_pitch,
+                                          NvU32 line_size,
+                                          NvU32 line_count);
+void uvm_hal_maxwell_ce_memcopy_strided(uvm_push_t *push,
+                                        uvm_gpu_address_t dst,
+                                        NvU32 dst_pitch,
+                                        uvm_gpu_address_t src,
+                                        NvU32 src_pitch,
+                                        NvU32 line_size,
+                                        NvU32 line_count);
+void uvm_hal_volta_ce_memcopy_strided(uvm_push_t *push,
+                                      uvm_gpu_address_t dst,
+                                      NvU32 dst_pitch,
+                                      uvm_gpu_address_t src,
+                                      NvU32 src_pitch,
+                                      NvU32 line_size,
+                                      NvU32 line_count);
+
 // Simple wrapper for uvm_hal_memcopy_t with both addresses being virtual
 typedef void (*uvm_hal_memcopy_v_to_v_t)(uvm_push_t *push, NvU64 dst, NvU64 src, size_t size);
 void uvm_hal_maxwell_ce_memcopy_v_to_v(uvm_push_t *push, NvU64 dst, NvU64 src, size_t size);
@@ -854,6 +881,7 @@ struct uvm_ce_hal_struct
     uvm_hal_ce_memcopy_is_valid memcopy_is_valid;
     uvm_hal_ce_memcopy_patch_src memcopy_patch_src;
     uvm_hal_memcopy_t memcopy;
+    uvm_hal_memcopy_strided_t memcopy_strided;
     uvm_hal_memcopy_v_to_v_t memcopy_v_to_v;
     uvm_hal_ce_memset_is_valid memset_is_valid;
     uvm_hal_memset_1_t memset_1;
@@ -115,6 +115,33 @@ typedef struct
     uvm_page_mask_t same_devmem_page_mask;
 } uvm_hmm_migrate_event_t;
 
+// Number of va_blocks whose migrated source pages can be kept by a
+// uvm_hmm_migrate_batch_t. See uvm_hmm_migrate_ranges().
+#define UVM_HMM_MIGRATE_BATCH_BLOCKS_DEFAULT 4
+#define UVM_HMM_MIGRATE_BATCH_BLOCKS_MAX     64
+
+static unsigned uvm_hmm_migrate_batch_blocks __read_mostly = UVM_HMM_MIGRATE_BATCH_BLOCKS_DEFAULT;
+module_param(uvm_hmm_migrate_batch_blocks, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_hmm_migrate_batch_blocks,
+                 "Number of va_blocks whose copies can be in flight while migrating HMM allocations to a GPU. "
+                 "Values below 2 make each va_block wait for its copies before migrating the next one.");
+
+// Source pages of migrations to a GPU whose release is deferred until the
+// copies reading them complete.
+struct uvm_hmm_migrate_batch_struct
+{
+    // Work reading the source pages held by the batch
+    uvm_tracker_t tracker;
+
+    NvU32 num_chunks;
+
+    NvU32 max_chunks;
+
+    // CPU chunks of the source pages. The batch holds a reference on the page
+    // of each chunk.
+    uvm_cpu_chunk_t *chunks[];
+};
+
 typedef struct
 {
     uvm_processor_id_t processor_id;
@@ -774,6 +801,7 @@ static NV_STATUS hmm_migrate_range(uvm_va_block_t *va_block,
                                                                        region,
                                                                        dest_id,
                                                                        mode,
+                                                                       UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                                        out_tracker));
         if (status != NV_OK)
             break;
@@ -1892,6 +1920,130 @@ static NV_STATUS gpu_chunk_add(uvm_va_block_t *va_block,
     return NV_OK;
 }
 
+static uvm_hmm_migrate_batch_t *hmm_migrate_batch_alloc(NvU32 batch_blocks)
+{
+    uvm_hmm_migrate_batch_t *batch;
+    NvU32 max_chunks = min(batch_blocks, (NvU32)UVM_HMM_MIGRATE_BATCH_BLOCKS_MAX) * PAGES_PER_UVM_VA_BLOCK;
+
+    batch = uvm_kvmalloc(sizeof(*batch) + max_chunks * sizeof(batch->chunks[0]));
+    if (!batch)
+        return NULL;
+
+    uvm_tracker_init(&batch->tracker);
+    batch->num_chunks = 0;
+    batch->max_chunks = max_chunks;
+
+    return batch;
+}
+
+// Release the source pages held by the batch. If wait is false, the pages are
+// only released if the copies reading them have already completed.
+static NV_STATUS hmm_migrate_batch_release(uvm_hmm_migrate_batch_t *batch, bool wait)
+{
+    NV_STATUS status = NV_OK;
+    NvU32 i;
+
+    if (wait)
+        status = uvm_tracker_wait(&batch->tracker);
+    else if (!uvm_tracker_is_completed(&batch->tracker))
+        return NV_OK;
+
+    // As in sync_page_and_chunk_state(), the pages are released even if the
+    // wait failed.
+    for (i = 0; i < batch->num_chunks; i++) {
+        uvm_cpu_chunk_t *chunk = batch->chunks[i];
+        struct page *page = chunk->page;
+
+        // Freeing the chunk also removes its DMA mappings
+        uvm_cpu_chunk_free(chunk);
+        put_page(page);
+    }
+
+    batch->num_chunks = 0;
+    uvm_tracker_clear(&batch->tracker);
+
+    return status;
+}
+
+static void hmm_migrate_batch_free(uvm_hmm_migrate_batch_t *batch)
+{
+    if (!batch)
+        return;
+
+    UVM_ASSERT(batch->num_chunks == 0);
+
+    uvm_tracker_deinit(&batch->tracker);
+    uvm_kvfree(batch);
+}
+
+// Check whether the release of the source pages of a migration can be deferred
+// to the batch instead of waiting for the copies to complete. This requires
+// all the memory accessed by the copies to outlive migrate_vma_finalize(): the
+// migrated source pages must be system memory pages, which the batch keeps a
+// reference on, and all the destination GPU pages must have migrated so they
+// remain owned by the va_block, whose tracker orders any later use of them.
+static bool hmm_migrate_batch_can_defer(uvm_hmm_migrate_batch_t *batch,
+                                        const unsigned long *src_pfns,
+                                        const unsigned long *dst_pfns,
+                                        uvm_va_block_region_t region,
+                                        const uvm_page_mask_t *migrated_pages,
+                                        const uvm_page_mask_t *same_devmem_page_mask)
+{
+    uvm_page_index_t page_index;
+    NvU32 num_pages = 0;
+
+    if (!batch)
+        return false;
+
+    for_each_va_block_page_in_region(page_index, region) {
+        struct page *src_page;
+        struct page *dst_page;
+
+        if (uvm_page_mask_test(same_devmem_page_mask, page_index))
+            continue;
+
+        dst_page = migrate_pfn_to_page(dst_pfns[page_index]);
+        if (dst_page && (!is_device_private_page(dst_page) || !uvm_page_mask_test(migrated_pages, page_index)))
+            return false;
+
+        src_page = migrate_pfn_to_page(src_pfns[page_index]);
+        if (src_page && uvm_page_mask_test(migrated_pages, page_index)) {
+            if (is_device_private_page(src_page))
+                return false;
+
+            num_pages++;
+        }
+    }
+
+    return batch->num_chunks + num_pages <= batch->max_chunks;
+}
+
+// Detach the CPU chunk of a migrated source page from the va_block and hand it
+// to the batch along with a reference on the page. This keeps the page and its
+// DMA mappings alive after migrate_vma_finalize() until the batch is released.
+static void hmm_migrate_batch_add_page(uvm_hmm_migrate_batch_t *batch,
+                                       uvm_va_block_t *va_block,
+                                       uvm_page_index_t page_index,
+                                       struct page *page)
+{
+    int nid = page_to_nid(page);
+    uvm_cpu_chunk_t *chunk = uvm_cpu_chunk_get_chunk_for_page(va_block, nid, page_index);
+
+    if (!chunk)
+        return;
+
+    UVM_ASSERT(!uvm_processor_mask_test(&va_block->resident, UVM_ID_CPU) ||
+               !uvm_va_block_cpu_is_page_resident_on(va_block, NUMA_NO_NODE, page_index));
+    UVM_ASSERT(uvm_cpu_chunk_get_size(chunk) == PAGE_SIZE);
+    UVM_ASSERT(chunk->page == page);
+    UVM_ASSERT(batch->num_chunks < batch->max_chunks);
+
+    uvm_cpu_chunk_remove_from_block(va_block, chunk, nid, page_index);
+
+    get_page(page);
+    batch->chunks[batch->num_chunks++] = chunk;
+}
+
 // This is called just before calling migrate_vma_finalize() in order to wait
 // for GPU operations to complete and update the va_block state to match which
 // pages migrated (or not) and therefore which pages will be released by
@@ -1901,21 +2053,29 @@ static NV_STATUS gpu_chunk_add(uvm_va_block_t *va_block,
 // and dst_pfns and therefore appear to migrate_vma_*() to be not migrating.
 // 'region' is the page index region of all migrated, non-migrated, and
 // same_devmem_page_mask pages.
+// 'batch' is optional. If not NULL, the wait may be skipped by handing the
+// migrated source pages over to the batch instead.
 static NV_STATUS sync_page_and_chunk_state(uvm_va_block_t *va_block,
                                            const unsigned long *src_pfns,
                                            const unsigned long *dst_pfns,
                                            uvm_va_block_region_t region,
                                            const uvm_page_mask_t *migrated_pages,
-                                           const uvm_page_mask_t *same_devmem_page_mask)
+                                           const uvm_page_mask_t *same_devmem_page_mask,
+                                           uvm_hmm_migrate_batch_t *batch)
 {
     uvm_page_index_t page_index;
-    NV_STATUS status;
+    NV_STATUS status = NV_OK;
+
+    if (!hmm_migrate_batch_can_defer(batch, src_pfns, dst_pfns, region, migrated_pages, same_devmem_page_mask) ||
+        uvm_tracker_add_tracker_safe(&batch->tracker, &va_block->tracker) != NV_OK)
+        batch = NULL;
 
     // Wait for the GPU to finish. migrate_vma_finalize() will release the
     // migrated source pages (or non migrating destination pages), so GPU
     // opererations must be finished by then. Also, we unmap the source or
     // destination so DMAs must be complete before DMA unmapping.
-    status = uvm_tracker_wait(&va_block->tracker);
+    if (!batch)
+        status = uvm_tracker_wait(&va_block->tracker);
 
     for_each_va_block_page_in_region(page_index, region) {
         struct page *src_page;
@@ -1931,6 +2091,8 @@ static NV_STATUS sync_page_and_chunk_state(uvm_va_block_t *va_block,
         if (src_page && uvm_page_mask_test(migrated_pages, page_index)) {
             if (is_device_private_page(src_page))
                 gpu_chunk_remove(va_block, page_index, src_page);
+            else if (batch)
+                hmm_migrate_batch_add_page(batch, va_block, page_index, src_page);
             else
                 hmm_va_block_cpu_page_unpopulate(va_block, page_index, src_page);
         }
@@ -2355,7 +2517,8 @@ static NV_STATUS uvm_hmm_devmem_fault_finalize_and_map(uvm_hmm_devmem_fault_cont
                                                dst_pfns,
                                                region,
                                                page_mask,
-                                               &devmem_fault_context->same_devmem_page_mask);
+                                               &devmem_fault_context->same_devmem_page_mask,
+                                               NULL);
 
     return status == NV_OK ? tracker_status : status;
 }
@@ -2995,7 +3158,8 @@ static NV_STATUS uvm_hmm_gpu_fault_finalize_and_map(uvm_hmm_gpu_fault_event_t *u
                                                dst_pfns,
                                                region,
                                                page_mask,
-                                               &uvm_hmm_gpu_fault_event->same_devmem_page_mask);
+                                               &uvm_hmm_gpu_fault_event->same_devmem_page_mask,
+                                               NULL);
 
     return status == NV_OK ? tracker_status : status;
 }
@@ -3248,7 +3412,8 @@ static NV_STATUS uvm_hmm_migrate_finalize(uvm_hmm_migrate_event_t *uvm_hmm_migra
                                      dst_pfns,
                                      region,
                                      page_mask,
-                                     &uvm_hmm_migrate_event->same_devmem_page_mask);
+                                     &uvm_hmm_migrate_event->same_devmem_page_mask,
+                                     UVM_ID_IS_GPU(dest_id) ? va_block_context->hmm.migrate_batch : NULL);
 }
 
 // Note that migrate_vma_*() doesn't handle asynchronous migrations so the
@@ -3399,13 +3564,14 @@ NV_STATUS uvm_hmm_va_block_migrate_locked(uvm_va_block_t *va_block,
     return status;
 }
 
-NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
-                                 uvm_service_block_context_t *service_context,
-                                 NvU64 base,
-                                 NvU64 length,
-                                 uvm_processor_id_t dest_id,
-                                 uvm_migrate_mode_t mode,
-                                 uvm_tracker_t *out_tracker)
+static NV_STATUS hmm_migrate_ranges(uvm_va_space_t *va_space,
+                                    uvm_service_block_context_t *service_context,
+                                    NvU64 base,
+                                    NvU64 length,
+                                    uvm_processor_id_t dest_id,
+                                    uvm_migrate_mode_t mode,
+                                    NvU32 batch_blocks,
+                                    uvm_tracker_t *out_tracker)
 {
     struct mm_struct *mm;
     uvm_va_block_t *va_block;
@@ -3413,6 +3579,7 @@ NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
     NvU64 addr, end, last_address;
     NV_STATUS status = NV_OK;
     uvm_va_block_context_t *block_context = service_context->block_context;
+    uvm_hmm_migrate_batch_t *batch = NULL;
 
     if (!uvm_hmm_is_enabled(va_space))
         return NV_ERR_INVALID_ADDRESS;
@@ -3424,12 +3591,26 @@ NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
 
     last_address = base + length - 1;
 
+    // Migrations to a GPU are pipelined across va_blocks. Rather than waiting
+    // for the copies of each va_block before releasing its source pages, the
+    // pages are handed over to a batch and released once the copies complete.
+    // This overlaps the CPU work of migrate_vma_*() on a va_block with the
+    // copies of the previous ones, and coalesces the waits and DMA unmaps.
+    // If the batch can't be allocated, each va_block waits for its copies.
+    if (UVM_ID_IS_GPU(dest_id) &&
+        batch_blocks > 1 &&
+        !g_uvm_global.conf_computing_enabled &&
+        UVM_VA_BLOCK_ALIGN_DOWN(base) != UVM_VA_BLOCK_ALIGN_DOWN(last_address))
+        batch = hmm_migrate_batch_alloc(batch_blocks);
+
+    block_context->hmm.migrate_batch = batch;
+
     for (addr = base; addr < last_address; addr = end + 1) {
         struct vm_area_struct *vma;
 
         status = hmm_va_block_find_create(va_space, addr, false, &block_context->hmm.vma, &va_block);
         if (status != NV_OK)
-            return status;
+            break;
 
         end = va_block->end;
         if (end > last_address)
@@ -3442,11 +3623,47 @@ NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
         status = hmm_migrate_range(va_block, &va_block_retry, service_context, dest_id, addr, end, mode, out_tracker);
         if (status != NV_OK)
             break;
+
+        // Make room for the pages of the next va_block. Only wait for the
+        // copies if the batch is full.
+        if (batch) {
+            status = hmm_migrate_batch_release(batch, batch->num_chunks + PAGES_PER_UVM_VA_BLOCK > batch->max_chunks);
+            if (status != NV_OK)
+                break;
+        }
+    }
+
+    if (batch) {
+        NV_STATUS batch_status = hmm_migrate_batch_release(batch, true);
+
+        if (status == NV_OK)
+            status = batch_status;
+
+        block_context->hmm.migrate_batch = NULL;
+        hmm_migrate_batch_free(batch);
     }
 
     return status;
 }
 
+NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
+                                 uvm_service_block_context_t *service_context,
+                                 NvU64 base,
+                                 NvU64 length,
+                                 uvm_processor_id_t dest_id,
+                                 uvm_migrate_mode_t mode,
+                                 uvm_tracker_t *out_tracker)
+{
+    return hmm_migrate_ranges(va_space,
+                              service_context,
+                              base,
+                              length,
+                              dest_id,
+                              mode,
+                              uvm_hmm_migrate_batch_blocks,
+                              out_tracker);
+}
+
 NV_STATUS uvm_hmm_va_block_evict_chunk_prep(uvm_va_block_t *va_block,
                                             uvm_va_block_context_t *va_block_context,
                                             uvm_gpu_chunk_t *gpu_chunk,
@@ -3826,6 +4043,99 @@ NV_STATUS uvm_test_split_invalidate_delay(UVM_TEST_SPLIT_INVALIDATE_DELAY_PARAMS
     return NV_OK;
 }
 
+NV_STATUS uvm_test_hmm_migrate_benchmark(UVM_TEST_HMM_MIGRATE_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_service_block_context_t *service_context = NULL;
+    uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    struct mm_struct *mm;
+    uvm_gpu_t *gpu;
+    NvU32 batch_blocks = params->batch_blocks ? params->batch_blocks : uvm_hmm_migrate_batch_blocks;
+    NvU64 to_gpu_ns = 0;
+    NvU64 to_cpu_ns = 0;
+    NvU64 total_bytes;
+    NvU32 i;
+    NV_STATUS status = NV_OK;
+
+    if (params->iterations == 0 || params->length == 0 || uvm_api_range_invalid(params->base, params->length))
+        return NV_ERR_INVALID_ARGUMENT;
+
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    if (!mm || !uvm_hmm_is_enabled(va_space)) {
+        status = NV_ERR_INVALID_STATE;
+        goto out;
+    }
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu || !uvm_processor_has_memory(gpu->id)) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto out;
+    }
+
+    service_context = uvm_service_block_context_alloc(mm);
+    if (!service_context) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    service_context->prefetch_hint.residency = UVM_ID_INVALID;
+
+    // Each iteration prefetches the whole range to the GPU and then migrates
+    // it back to the CPU, so both directions copy the full length.
+    for (i = 0; i < params->iterations; i++) {
+        NvU64 start = NV_GETTIME();
+
+        status = hmm_migrate_ranges(va_space,
+                                    service_context,
+                                    params->base,
+                                    params->length,
+                                    gpu->id,
+                                    UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                    batch_blocks,
+                                    &tracker);
+        if (status == NV_OK)
+            status = uvm_tracker_wait(&tracker);
+        if (status != NV_OK)
+            goto out;
+
+        to_gpu_ns += NV_GETTIME() - start;
+
+        start = NV_GETTIME();
+
+        status = hmm_migrate_ranges(va_space,
+                                    service_context,
+                                    params->base,
+                                    params->length,
+                                    UVM_ID_CPU,
+                                    UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                    batch_blocks,
+                                    &tracker);
+        if (status == NV_OK)
+            status = uvm_tracker_wait(&tracker);
+        if (status != NV_OK)
+            goto out;
+
+        to_cpu_ns += NV_GETTIME() - start;
+    }
+
+    // Bytes per nanosecond are GB/s, report MB/s to keep some precision
+    total_bytes = params->length * params->iterations;
+    params->to_gpu_ns = to_gpu_ns;
+    params->to_cpu_ns = to_cpu_ns;
+    params->to_gpu_mb_per_s = to_gpu_ns ? total_bytes * 1000 / to_gpu_ns : 0;
+    params->to_cpu_mb_per_s = to_cpu_ns ? total_bytes * 1000 / to_cpu_ns : 0;
+
+out:
+    uvm_tracker_wait_deinit(&tracker);
+    uvm_service_block_context_free(service_context);
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+    return status;
+}
+
 NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                 struct mm_struct *mm,
                                 UVM_TEST_VA_RANGE_INFO_PARAMS *params)
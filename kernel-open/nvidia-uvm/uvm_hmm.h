@@ -310,6 +310,12 @@ typedef struct
     // The caller is not required to set
     // service_context->va_block_context->hmm.vma.
     //
+    // Migrations to a GPU release the source pages of each va_block lazily,
+    // once their copies complete, so that up to uvm_hmm_migrate_batch_blocks
+    // va_blocks can have copies in flight. All the copies are complete when
+    // this function returns, but the GPU mapping work may still be pending in
+    // out_tracker.
+    //
     // Locking: the va_space->va_space_mm.mm mmap_lock must be locked and
     // the va_space read lock must be held.
     NV_STATUS uvm_hmm_migrate_ranges(uvm_va_space_t *va_space,
@@ -386,6 +392,8 @@ typedef struct
     NV_STATUS uvm_test_split_invalidate_delay(UVM_TEST_SPLIT_INVALIDATE_DELAY_PARAMS *params,
                                               struct file *filp);
 
+    NV_STATUS uvm_test_hmm_migrate_benchmark(UVM_TEST_HMM_MIGRATE_BENCHMARK_PARAMS *params, struct file *filp);
+
     NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                     struct mm_struct *mm,
                                     UVM_TEST_VA_RANGE_INFO_PARAMS *params);
@@ -654,6 +662,12 @@ typedef struct
         return NV_ERR_INVALID_STATE;
     }
 
+    static NV_STATUS uvm_test_hmm_migrate_benchmark(UVM_TEST_HMM_MIGRATE_BENCHMARK_PARAMS *params,
+                                                    struct file *filp)
+    {
+        return NV_ERR_INVALID_STATE;
+    }
+
     static NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                            struct mm_struct *mm,
                                            UVM_TEST_VA_RANGE_INFO_PARAMS *params)
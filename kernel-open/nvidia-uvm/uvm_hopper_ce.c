@@ -282,6 +282,8 @@ static void hopper_memset_common(uvm_push_t *push,
                    push->channel->name,
                    uvm_gpu_name(gpu));
 
+    push->copy_bytes += num_elements * memset_element_size;
+
     launch_dma_dst_type = hopper_memset_push_phys_mode(push, dst);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
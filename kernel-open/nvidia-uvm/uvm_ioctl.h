@@ -1035,6 +1035,84 @@ typedef struct
     NV_STATUS       rmStatus;                                                  // OUT
 } UVM_DISCARD_PARAMS;
 
+//
+// Initialize an event queue made of per-CPU rings of UvmEventEntry_V2 entries.
+//
+// Each CPU owns one ring of queueBufferSize entries, and is its only producer,
+// so events are recorded without any lock shared across CPUs. queueBuffer
+// holds the rings back to back, and controlBuffer holds one
+// UvmToolsEventControlData per ring, in the same order. Every ring is consumed
+// independently with the same protocol as a regular queue. Events within a
+// ring are in recording order, so consumers that need a global order merge
+// the rings by event timestamp. Events recorded while a ring is full are
+// counted in the dropped counters of the ring, they never stall the producer.
+//
+// ringCount must be at least the number of possible CPU ids. On return it is
+// set to the number of rings used by the driver, which is also the required
+// minimum when NV_ERR_INVALID_ARGUMENT is returned because of it.
+//
+// The remaining tools ioctls apply to the queue as for queues created with
+// UVM_TOOLS_INIT_EVENT_TRACKER_V2. The notification threshold applies to each
+// ring individually.
+//
+#define UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU                          UVM_IOCTL_BASE(81)
+typedef struct
+{
+    NvU64           queueBuffer        NV_ALIGN_BYTES(8); // IN
+    NvU64           queueBufferSize    NV_ALIGN_BYTES(8); // IN, entries per ring
+    NvU64           controlBuffer      NV_ALIGN_BYTES(8); // IN
+    NvU32           ringCount;                            // IN/OUT
+    NvU32           uvmFd;                                // IN
+    NV_STATUS       rmStatus;                             // OUT
+} UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU_PARAMS;
+
+//
+// Vectored version of UVM_MIGRATE.
+//
+// ranges points to an array of numRanges UVM_MIGRATE_BATCHED_RANGE, each of
+// them with the same meaning as the corresponding UVM_MIGRATE parameters,
+// except that zero-length ranges are not allowed. flags, semaphoreAddress and
+// semaphorePayload apply to the whole vector, so the semaphore is released
+// once all the ranges have been migrated.
+//
+// Ranges are migrated in order, under a single acquisition of the driver
+// locks. The copies of a range are pushed without waiting for the copies of
+// the previous ranges to complete. Consecutive ranges that are contiguous in
+// VA and have the same destination are migrated together.
+//
+// numRangesDone is set to the number of ranges that were migrated. If an
+// error is returned, it applies to the range at index numRangesDone, or to the
+// ranges that follow it if they were coalesced with it. In particular, if
+// NV_WARN_NOTHING_TO_DO or NV_ERR_MORE_PROCESSING_REQUIRED are returned,
+// userSpaceStart and userSpaceLength have the same meaning as for UVM_MIGRATE,
+// and the remaining ranges must be submitted again after handling them. The
+// semaphore is not released if an error is returned.
+//
+#define UVM_MIGRATE_BATCHED_MAX_RANGES                                4096
+
+typedef struct
+{
+    NvU64           base               NV_ALIGN_BYTES(8); // IN
+    NvU64           length             NV_ALIGN_BYTES(8); // IN
+    NvProcessorUuid destinationUuid;                      // IN
+    NvS32           cpuNumaNode;                          // IN
+    NvU32           padding;
+} UVM_MIGRATE_BATCHED_RANGE;
+
+#define UVM_MIGRATE_BATCHED                                           UVM_IOCTL_BASE(82)
+typedef struct
+{
+    NvU64           ranges             NV_ALIGN_BYTES(8); // IN
+    NvU64           numRanges          NV_ALIGN_BYTES(8); // IN
+    NvU32           flags;                                // IN
+    NvU64           semaphoreAddress   NV_ALIGN_BYTES(8); // IN
+    NvU32           semaphorePayload;                     // IN
+    NvU64           numRangesDone      NV_ALIGN_BYTES(8); // OUT
+    NvU64           userSpaceStart     NV_ALIGN_BYTES(8); // OUT
+    NvU64           userSpaceLength    NV_ALIGN_BYTES(8); // OUT
+    NV_STATUS       rmStatus;                             // OUT
+} UVM_MIGRATE_BATCHED_PARAMS;
+
 //
 // Temporary ioctls which should be removed before UVM 8 release
 // Number backwards from 2047 - highest custom ioctl function number
@@ -26,6 +26,8 @@
 #include "uvm_global.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_rb_tree.h"
+#include "uvm_api.h"
+#include "uvm_procfs.h"
 
 // To implement realloc for vmalloc-based allocations we need to track the size
 // of the original allocation. We can do that by allocating a header along with
@@ -90,15 +92,215 @@ MODULE_PARM_DESC(uvm_leak_checker,
                  "Enable uvm memory leak checking. "
                  "0 = disabled, 1 = count total bytes allocated and freed, 2 = per-allocation origin tracking.");
 
+// Small kmalloc allocations are recycled through per-CPU magazines, one per
+// size class. A magazine is a bounded stack of free objects of exactly the
+// class size, as reported by ksize(), so any kmalloc-based allocation freed by
+// uvm_kvfree whose ksize() matches a class can be recycled regardless of which
+// path allocated it. The classes mirror the kmalloc caches, so serving a
+// request from the next class up doesn't use more memory than kmalloc would.
+//
+// The magazines only cache objects: a full magazine releases to kmalloc, and
+// objects are not moved between CPUs.
+static const size_t g_kvmalloc_size_classes[] = {32, 64, 96, 128, 192, 256, 512};
+
+#define UVM_KVMALLOC_NUM_SIZE_CLASSES ARRAY_SIZE(g_kvmalloc_size_classes)
+#define UVM_KVMALLOC_MAGAZINE_MAX_SIZE 64
+
+typedef struct
+{
+    NvU64 hits;
+    NvU64 misses;
+    NvU64 frees_cached;
+    NvU64 frees_released;
+
+    // Sum of the requested sizes of all allocations served by the class. Used
+    // to compute internal fragmentation.
+    NvU64 requested_bytes;
+} uvm_kvmalloc_class_stats_t;
+
+typedef struct
+{
+    struct
+    {
+        NvU32 count;
+        void *objects[UVM_KVMALLOC_MAGAZINE_MAX_SIZE];
+    } magazines[UVM_KVMALLOC_NUM_SIZE_CLASSES];
+
+    uvm_kvmalloc_class_stats_t stats[UVM_KVMALLOC_NUM_SIZE_CLASSES];
+} uvm_kvmalloc_cpu_cache_t;
+
+struct uvm_kvmalloc_cache_stats_struct
+{
+    NvU64 allocs;
+    NvU64 frees;
+};
+
+static struct
+{
+    uvm_kvmalloc_cpu_cache_t __percpu *cpu_caches;
+
+    // Maximum number of objects in each magazine. 0 if the magazines are
+    // disabled.
+    unsigned magazine_size;
+
+    // List of all named caches, for procfs
+    spinlock_t caches_lock;
+    struct list_head caches;
+
+    struct proc_dir_entry *procfs_file;
+} g_uvm_kvmalloc_magazines;
+
+static unsigned uvm_kvmalloc_magazine_size = 16;
+module_param(uvm_kvmalloc_magazine_size, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_kvmalloc_magazine_size,
+                 "Maximum number of free objects cached per CPU in each uvm_kvmalloc size class. 0 disables the "
+                 "per-CPU magazines.");
+
+#define UVM_KVMALLOC_STATS_FILE_NAME "kvmalloc_stats"
+
+static NV_STATUS magazines_init(void)
+{
+    spin_lock_init(&g_uvm_kvmalloc_magazines.caches_lock);
+    INIT_LIST_HEAD(&g_uvm_kvmalloc_magazines.caches);
+
+    if (uvm_kvmalloc_magazine_size > UVM_KVMALLOC_MAGAZINE_MAX_SIZE) {
+        UVM_INFO_PRINT("Invalid value uvm_kvmalloc_magazine_size = %u, using %u instead\n",
+                       uvm_kvmalloc_magazine_size,
+                       UVM_KVMALLOC_MAGAZINE_MAX_SIZE);
+        uvm_kvmalloc_magazine_size = UVM_KVMALLOC_MAGAZINE_MAX_SIZE;
+    }
+
+    // The stats are kept in the per-CPU caches, so they are allocated even if
+    // the magazines are disabled.
+    g_uvm_kvmalloc_magazines.cpu_caches = alloc_percpu(uvm_kvmalloc_cpu_cache_t);
+    if (!g_uvm_kvmalloc_magazines.cpu_caches)
+        return NV_ERR_NO_MEMORY;
+
+    g_uvm_kvmalloc_magazines.magazine_size = uvm_kvmalloc_magazine_size;
+
+    return NV_OK;
+}
+
+static void magazines_exit(void)
+{
+    int cpu;
+    size_t size_class;
+
+    if (!g_uvm_kvmalloc_magazines.cpu_caches)
+        return;
+
+    UVM_ASSERT(list_empty(&g_uvm_kvmalloc_magazines.caches));
+
+    for_each_possible_cpu(cpu) {
+        uvm_kvmalloc_cpu_cache_t *cpu_cache = per_cpu_ptr(g_uvm_kvmalloc_magazines.cpu_caches, cpu);
+
+        for (size_class = 0; size_class < UVM_KVMALLOC_NUM_SIZE_CLASSES; size_class++) {
+            while (cpu_cache->magazines[size_class].count > 0)
+                kfree(cpu_cache->magazines[size_class].objects[--cpu_cache->magazines[size_class].count]);
+        }
+    }
+
+    free_percpu(g_uvm_kvmalloc_magazines.cpu_caches);
+    g_uvm_kvmalloc_magazines.cpu_caches = NULL;
+    g_uvm_kvmalloc_magazines.magazine_size = 0;
+}
+
+// Returns the smallest size class that fits size, or -1 if size is not served
+// by the magazines.
+static int magazine_size_class(size_t size)
+{
+    int size_class;
+
+    if (g_uvm_kvmalloc_magazines.magazine_size == 0 || size == 0)
+        return -1;
+
+    for (size_class = 0; size_class < UVM_KVMALLOC_NUM_SIZE_CLASSES; size_class++) {
+        if (size <= g_kvmalloc_size_classes[size_class])
+            return size_class;
+    }
+
+    return -1;
+}
+
+static void *magazine_alloc(int size_class, size_t size, bool zero_memory)
+{
+    uvm_kvmalloc_cpu_cache_t *cpu_cache;
+    unsigned long irq_flags;
+    void *p = NULL;
+
+    // uvm_kvfree may be called from interrupt context
+    local_irq_save(irq_flags);
+
+    cpu_cache = this_cpu_ptr(g_uvm_kvmalloc_magazines.cpu_caches);
+    if (cpu_cache->magazines[size_class].count > 0) {
+        p = cpu_cache->magazines[size_class].objects[--cpu_cache->magazines[size_class].count];
+        cpu_cache->stats[size_class].hits++;
+    }
+    else {
+        cpu_cache->stats[size_class].misses++;
+    }
+
+    cpu_cache->stats[size_class].requested_bytes += size;
+
+    local_irq_restore(irq_flags);
+
+    if (!p) {
+        p = kmalloc(g_kvmalloc_size_classes[size_class], NV_UVM_GFP_FLAGS);
+        if (!p)
+            return NULL;
+    }
+
+    if (zero_memory)
+        memset(p, 0, size);
+
+    return p;
+}
+
+// Returns true if p was cached in a magazine, in which case it must not be
+// freed.
+static bool magazine_free(void *p)
+{
+    size_t size = ksize(p);
+    uvm_kvmalloc_cpu_cache_t *cpu_cache;
+    unsigned long irq_flags;
+    bool cached = false;
+    int size_class = magazine_size_class(size);
+
+    if (size_class < 0 || g_kvmalloc_size_classes[size_class] != size)
+        return false;
+
+    local_irq_save(irq_flags);
+
+    cpu_cache = this_cpu_ptr(g_uvm_kvmalloc_magazines.cpu_caches);
+    if (cpu_cache->magazines[size_class].count < g_uvm_kvmalloc_magazines.magazine_size) {
+        cpu_cache->magazines[size_class].objects[cpu_cache->magazines[size_class].count++] = p;
+        cpu_cache->stats[size_class].frees_cached++;
+        cached = true;
+    }
+    else {
+        cpu_cache->stats[size_class].frees_released++;
+    }
+
+    local_irq_restore(irq_flags);
+
+    return cached;
+}
+
 NV_STATUS uvm_kvmalloc_init(void)
 {
+    NV_STATUS status = magazines_init();
+    if (status != NV_OK)
+        return status;
+
     if (uvm_leak_checker >= UVM_KVMALLOC_LEAK_CHECK_ORIGIN) {
         spin_lock_init(&g_uvm_leak_checker.lock);
         uvm_rb_tree_init(&g_uvm_leak_checker.allocation_info);
 
         g_uvm_leak_checker.info_cache = NV_KMEM_CACHE_CREATE("uvm_kvmalloc_info_t", uvm_kvmalloc_info_t);
-        if (!g_uvm_leak_checker.info_cache)
+        if (!g_uvm_leak_checker.info_cache) {
+            magazines_exit();
             return NV_ERR_NO_MEMORY;
+        }
     }
 
     g_malloc_initialized = true;
@@ -148,6 +350,8 @@ void uvm_kvmalloc_exit(void)
         kmem_cache_destroy_safe(&g_uvm_leak_checker.info_cache);
     }
 
+    magazines_exit();
+
     g_malloc_initialized = false;
 }
 
@@ -258,6 +462,11 @@ static void *alloc_internal(size_t size, bool zero_memory)
     BUILD_BUG_ON(sizeof(uvm_vmalloc_hdr_t) != offsetof(uvm_vmalloc_hdr_t, ptr));
 
     if (size <= UVM_KMALLOC_THRESHOLD) {
+        int size_class = magazine_size_class(size);
+
+        if (size_class >= 0)
+            return magazine_alloc(size_class, size, zero_memory);
+
         if (zero_memory)
             return kzalloc(size, NV_UVM_GFP_FLAGS);
         return kmalloc(size, NV_UVM_GFP_FLAGS);
@@ -305,7 +514,7 @@ void uvm_kvfree(void *p)
 
     if (is_vmalloc_addr(p))
         vfree(get_hdr(p));
-    else
+    else if (!magazine_free(p))
         kfree(p);
 }
 
@@ -410,3 +619,209 @@ size_t uvm_kvsize(void *p)
         return get_hdr(p)->alloc_size;
     return ksize(p);
 }
+
+NV_STATUS uvm_kvmalloc_cache_init(uvm_kvmalloc_cache_t *cache, const char *name, size_t object_size)
+{
+    unsigned long irq_flags;
+
+    memset(cache, 0, sizeof(*cache));
+
+    cache->stats = alloc_percpu(struct uvm_kvmalloc_cache_stats_struct);
+    if (!cache->stats)
+        return NV_ERR_NO_MEMORY;
+
+    cache->kmem_cache = nv_kmem_cache_create(name, object_size, 0);
+    if (!cache->kmem_cache) {
+        free_percpu(cache->stats);
+        cache->stats = NULL;
+        return NV_ERR_NO_MEMORY;
+    }
+
+    cache->name = name;
+    cache->object_size = object_size;
+
+    spin_lock_irqsave(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+    list_add_tail(&cache->list_node, &g_uvm_kvmalloc_magazines.caches);
+    spin_unlock_irqrestore(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+
+    return NV_OK;
+}
+
+void uvm_kvmalloc_cache_deinit(uvm_kvmalloc_cache_t *cache)
+{
+    unsigned long irq_flags;
+
+    if (!cache->kmem_cache)
+        return;
+
+    spin_lock_irqsave(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+    list_del(&cache->list_node);
+    spin_unlock_irqrestore(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+
+    kmem_cache_destroy_safe(&cache->kmem_cache);
+    free_percpu(cache->stats);
+    cache->stats = NULL;
+}
+
+void *uvm_kvmalloc_cache_alloc(uvm_kvmalloc_cache_t *cache)
+{
+    void *p = kmem_cache_alloc(cache->kmem_cache, NV_UVM_GFP_FLAGS);
+
+    if (p)
+        this_cpu_inc(cache->stats->allocs);
+
+    return p;
+}
+
+void *uvm_kvmalloc_cache_alloc_zero(uvm_kvmalloc_cache_t *cache)
+{
+    void *p = nv_kmem_cache_zalloc(cache->kmem_cache, NV_UVM_GFP_FLAGS);
+
+    if (p)
+        this_cpu_inc(cache->stats->allocs);
+
+    return p;
+}
+
+void uvm_kvmalloc_cache_free(uvm_kvmalloc_cache_t *cache, void *p)
+{
+    if (!p)
+        return;
+
+    this_cpu_inc(cache->stats->frees);
+    kmem_cache_free(cache->kmem_cache, p);
+}
+
+static int nv_procfs_read_kvmalloc_stats(struct seq_file *s, void *v)
+{
+    uvm_kvmalloc_class_stats_t totals[UVM_KVMALLOC_NUM_SIZE_CLASSES];
+    NvU64 idle_objects[UVM_KVMALLOC_NUM_SIZE_CLASSES];
+    uvm_kvmalloc_cache_t *cache;
+    unsigned long irq_flags;
+    size_t size_class;
+    int cpu;
+
+    memset(totals, 0, sizeof(totals));
+    memset(idle_objects, 0, sizeof(idle_objects));
+
+    // The per-CPU values are read without synchronization, so the totals are
+    // only approximate while allocations are in flight.
+    for_each_possible_cpu(cpu) {
+        uvm_kvmalloc_cpu_cache_t *cpu_cache = per_cpu_ptr(g_uvm_kvmalloc_magazines.cpu_caches, cpu);
+
+        for (size_class = 0; size_class < UVM_KVMALLOC_NUM_SIZE_CLASSES; size_class++) {
+            uvm_kvmalloc_class_stats_t *stats = &cpu_cache->stats[size_class];
+
+            totals[size_class].hits += READ_ONCE(stats->hits);
+            totals[size_class].misses += READ_ONCE(stats->misses);
+            totals[size_class].frees_cached += READ_ONCE(stats->frees_cached);
+            totals[size_class].frees_released += READ_ONCE(stats->frees_released);
+            totals[size_class].requested_bytes += READ_ONCE(stats->requested_bytes);
+            idle_objects[size_class] += READ_ONCE(cpu_cache->magazines[size_class].count);
+        }
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, "magazine_size %u\n", g_uvm_kvmalloc_magazines.magazine_size);
+
+    // internal_frag_pct is the share of the bytes handed out by a class that
+    // was not requested. idle_kb is memory held in the magazines.
+    UVM_SEQ_OR_DBG_PRINT(s,
+                         "%-12s %-14s %-14s %-14s %-14s %-18s %-10s\n",
+                         "size_class",
+                         "hits",
+                         "misses",
+                         "frees_cached",
+                         "frees_released",
+                         "internal_frag_pct",
+                         "idle_kb");
+
+    for (size_class = 0; size_class < UVM_KVMALLOC_NUM_SIZE_CLASSES; size_class++) {
+        NvU64 class_bytes = (totals[size_class].hits + totals[size_class].misses) * g_kvmalloc_size_classes[size_class];
+        NvU64 frag_pct = 0;
+
+        if (class_bytes > totals[size_class].requested_bytes)
+            frag_pct = div64_u64((class_bytes - totals[size_class].requested_bytes) * 100, class_bytes);
+
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "%-12zu %-14llu %-14llu %-14llu %-14llu %-18llu %-10llu\n",
+                             g_kvmalloc_size_classes[size_class],
+                             totals[size_class].hits,
+                             totals[size_class].misses,
+                             totals[size_class].frees_cached,
+                             totals[size_class].frees_released,
+                             frag_pct,
+                             (idle_objects[size_class] * g_kvmalloc_size_classes[size_class]) / 1024);
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, "\n%-32s %-12s %-14s %-14s %-14s\n", "cache", "object_size", "allocs", "frees", "in_use");
+
+    spin_lock_irqsave(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+
+    list_for_each_entry(cache, &g_uvm_kvmalloc_magazines.caches, list_node) {
+        NvU64 allocs = 0;
+        NvU64 frees = 0;
+
+        for_each_possible_cpu(cpu) {
+            allocs += READ_ONCE(per_cpu_ptr(cache->stats, cpu)->allocs);
+            frees += READ_ONCE(per_cpu_ptr(cache->stats, cpu)->frees);
+        }
+
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "%-32s %-12zu %-14llu %-14llu %-14lld\n",
+                             cache->name,
+                             cache->object_size,
+                             allocs,
+                             frees,
+                             (long long)(allocs - frees));
+    }
+
+    spin_unlock_irqrestore(&g_uvm_kvmalloc_magazines.caches_lock, irq_flags);
+
+    return 0;
+}
+
+static int nv_procfs_read_kvmalloc_stats_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_kvmalloc_stats(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(kvmalloc_stats_entry);
+
+NV_STATUS uvm_kvmalloc_procfs_init(void)
+{
+    if (!uvm_procfs_is_enabled())
+        return NV_OK;
+
+    g_uvm_kvmalloc_magazines.procfs_file = NV_CREATE_PROC_FILE(UVM_KVMALLOC_STATS_FILE_NAME,
+                                                               uvm_procfs_get_cpu_base_dir(),
+                                                               kvmalloc_stats_entry,
+                                                               NULL);
+    if (!g_uvm_kvmalloc_magazines.procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
+
+void uvm_kvmalloc_procfs_exit(void)
+{
+    proc_remove(g_uvm_kvmalloc_magazines.procfs_file);
+    g_uvm_kvmalloc_magazines.procfs_file = NULL;
+}
+
+void uvm_kvmalloc_get_magazine_stats(NvU64 *hits, NvU64 *misses)
+{
+    size_t size_class;
+    int cpu;
+
+    *hits = 0;
+    *misses = 0;
+
+    for_each_possible_cpu(cpu) {
+        uvm_kvmalloc_cpu_cache_t *cpu_cache = per_cpu_ptr(g_uvm_kvmalloc_magazines.cpu_caches, cpu);
+
+        for (size_class = 0; size_class < UVM_KVMALLOC_NUM_SIZE_CLASSES; size_class++) {
+            *hits += READ_ONCE(cpu_cache->stats[size_class].hits);
+            *misses += READ_ONCE(cpu_cache->stats[size_class].misses);
+        }
+    }
+}
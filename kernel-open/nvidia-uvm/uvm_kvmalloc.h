@@ -70,6 +70,39 @@ void *__uvm_kvrealloc(void *p, size_t new_size, const char *file, int line, cons
 // p must not be NULL.
 size_t uvm_kvsize(void *p);
 
+// Named kmem_cache-backed pool for frequently allocated fixed-size objects.
+// Allocation and free counts of every pool are reported in the kvmalloc_stats
+// procfs file, next to the statistics of the uvm_kvmalloc per-CPU magazines.
+typedef struct
+{
+    const char *name;
+    size_t object_size;
+    struct kmem_cache *kmem_cache;
+    struct uvm_kvmalloc_cache_stats_struct __percpu *stats;
+    struct list_head list_node;
+} uvm_kvmalloc_cache_t;
+
+// name must remain valid until uvm_kvmalloc_cache_deinit. It is safe to call
+// uvm_kvmalloc_cache_deinit on a zero-initialized cache or one for which
+// uvm_kvmalloc_cache_init failed.
+NV_STATUS uvm_kvmalloc_cache_init(uvm_kvmalloc_cache_t *cache, const char *name, size_t object_size);
+void uvm_kvmalloc_cache_deinit(uvm_kvmalloc_cache_t *cache);
+
+#define UVM_KVMALLOC_CACHE_INIT(__cache, __type) uvm_kvmalloc_cache_init(__cache, #__type, sizeof(__type))
+
+void *uvm_kvmalloc_cache_alloc(uvm_kvmalloc_cache_t *cache);
+void *uvm_kvmalloc_cache_alloc_zero(uvm_kvmalloc_cache_t *cache);
+void uvm_kvmalloc_cache_free(uvm_kvmalloc_cache_t *cache, void *p);
+
+// The procfs file is created after uvm_kvmalloc_init since the procfs layer is
+// initialized later.
+NV_STATUS uvm_kvmalloc_procfs_init(void);
+void uvm_kvmalloc_procfs_exit(void);
+
+// Sum of the per-CPU magazine hits and misses across all size classes
+void uvm_kvmalloc_get_magazine_stats(NvU64 *hits, NvU64 *misses);
+
 NV_STATUS uvm_test_kvmalloc(UVM_TEST_KVMALLOC_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_kvmalloc_benchmark(UVM_TEST_KVMALLOC_BENCHMARK_PARAMS *params, struct file *filp);
 
 #endif // __UVM_KVMALLOC_H__
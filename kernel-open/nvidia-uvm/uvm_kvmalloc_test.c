@@ -25,6 +25,7 @@
 #include "uvm_linux.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_test.h"
+#include "uvm_test_rng.h"
 
 typedef enum
 {
@@ -61,7 +62,10 @@ static NV_STATUS check_alloc(void *p, size_t size)
 
 static NV_STATUS test_uvm_kvmalloc(void)
 {
-    static const size_t sizes[] = {0, UVM_KMALLOC_THRESHOLD, UVM_KMALLOC_THRESHOLD + 1};
+    // The small sizes are served by the per-CPU magazines. Since the same size
+    // is allocated and freed back to back, ALLOC_TYPE_ZALLOC likely gets the
+    // object scribbled on by ALLOC_TYPE_MALLOC.
+    static const size_t sizes[] = {0, 1, 64, 200, UVM_KMALLOC_THRESHOLD, UVM_KMALLOC_THRESHOLD + 1};
     uint8_t *p;
     uint8_t expected;
     size_t i, j, size;
@@ -175,10 +179,160 @@ static NV_STATUS test_uvm_kvrealloc(void)
     return NV_OK;
 }
 
+typedef struct
+{
+    NvU64 value;
+    uint8_t bytes[40];
+} test_cache_object_t;
+
+static NV_STATUS test_uvm_kvmalloc_cache(void)
+{
+    uvm_kvmalloc_cache_t cache;
+    test_cache_object_t *objects[8] = {0};
+    NV_STATUS status;
+    size_t i, j;
+
+    status = UVM_KVMALLOC_CACHE_INIT(&cache, test_cache_object_t);
+    if (status != NV_OK)
+        return status;
+
+    for (i = 0; i < ARRAY_SIZE(objects); i++) {
+        objects[i] = uvm_kvmalloc_cache_alloc(&cache);
+        if (!objects[i]) {
+            status = NV_ERR_NO_MEMORY;
+            goto done;
+        }
+
+        memset(objects[i], 0xff, sizeof(*objects[i]));
+    }
+
+    for (i = 0; i < ARRAY_SIZE(objects); i++) {
+        uvm_kvmalloc_cache_free(&cache, objects[i]);
+        objects[i] = uvm_kvmalloc_cache_alloc_zero(&cache);
+        if (!objects[i]) {
+            status = NV_ERR_NO_MEMORY;
+            goto done;
+        }
+
+        TEST_CHECK_GOTO(objects[i]->value == 0, done);
+        for (j = 0; j < sizeof(objects[i]->bytes); j++)
+            TEST_CHECK_GOTO(objects[i]->bytes[j] == 0, done);
+    }
+
+done:
+    for (i = 0; i < ARRAY_SIZE(objects); i++) {
+        if (objects[i])
+            uvm_kvmalloc_cache_free(&cache, objects[i]);
+    }
+
+    uvm_kvmalloc_cache_deinit(&cache);
+
+    return status;
+}
+
 NV_STATUS uvm_test_kvmalloc(UVM_TEST_KVMALLOC_PARAMS *params, struct file *filp)
 {
     NV_STATUS status = test_uvm_kvmalloc();
     if (status != NV_OK)
         return status;
+
+    status = test_uvm_kvmalloc_cache();
+    if (status != NV_OK)
+        return status;
+
     return test_uvm_kvrealloc();
 }
+
+// Replay the same random sequence of frees and allocations with either
+// uvm_kvmalloc or kmalloc. Returns the elapsed time in ns.
+static NV_STATUS kvmalloc_benchmark_run(UVM_TEST_KVMALLOC_BENCHMARK_PARAMS *params,
+                                        void **objects,
+                                        bool use_kvmalloc,
+                                        NvU64 *elapsed_ns)
+{
+    uvm_test_rng_t rng;
+    NV_STATUS status = NV_OK;
+    NvU64 start;
+    NvU32 i;
+
+    uvm_test_rng_init(&rng, params->seed);
+
+    start = NV_GETTIME();
+
+    for (i = 0; i < params->iterations; i++) {
+        NvU32 index = uvm_test_rng_range_32(&rng, 0, params->num_live_objects - 1);
+        size_t size = uvm_test_rng_range_32(&rng, 1, params->max_size);
+
+        if (use_kvmalloc) {
+            uvm_kvfree(objects[index]);
+            objects[index] = uvm_kvmalloc(size);
+        }
+        else {
+            kfree(objects[index]);
+            objects[index] = kmalloc(size, NV_UVM_GFP_FLAGS);
+        }
+
+        if (!objects[index]) {
+            status = NV_ERR_NO_MEMORY;
+            break;
+        }
+
+        // Touch the allocation like a real user would
+        *(NvU8 *)objects[index] = (NvU8)i;
+    }
+
+    *elapsed_ns = NV_GETTIME() - start;
+
+    for (i = 0; i < params->num_live_objects; i++) {
+        if (use_kvmalloc)
+            uvm_kvfree(objects[i]);
+        else
+            kfree(objects[i]);
+
+        objects[i] = NULL;
+    }
+
+    return status;
+}
+
+NV_STATUS uvm_test_kvmalloc_benchmark(UVM_TEST_KVMALLOC_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status;
+    void **objects;
+    NvU64 hits_before, misses_before, hits_after, misses_after;
+    NvU64 elapsed_ns;
+
+    if (params->iterations == 0 || params->num_live_objects == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    // Only kmalloc-based allocations are compared
+    if (params->max_size == 0 || params->max_size > UVM_KMALLOC_THRESHOLD)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    objects = uvm_kvmalloc_zero(params->num_live_objects * sizeof(*objects));
+    if (!objects)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_kvmalloc_get_magazine_stats(&hits_before, &misses_before);
+
+    status = kvmalloc_benchmark_run(params, objects, true, &elapsed_ns);
+    if (status != NV_OK)
+        goto done;
+
+    uvm_kvmalloc_get_magazine_stats(&hits_after, &misses_after);
+
+    params->kvmalloc_ns_per_op = elapsed_ns / params->iterations;
+    params->magazine_hits = hits_after - hits_before;
+    params->magazine_misses = misses_after - misses_before;
+
+    status = kvmalloc_benchmark_run(params, objects, false, &elapsed_ns);
+    if (status != NV_OK)
+        goto done;
+
+    params->kmalloc_ns_per_op = elapsed_ns / params->iterations;
+
+done:
+    uvm_kvfree(objects);
+
+    return status;
+}
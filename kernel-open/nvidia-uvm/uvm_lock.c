@@ -27,7 +27,7 @@
 
 const char *uvm_lock_order_to_string(uvm_lock_order_t lock_order)
 {
-    BUILD_BUG_ON(UVM_LOCK_ORDER_COUNT != 38);
+    BUILD_BUG_ON(UVM_LOCK_ORDER_COUNT != 39);
 
     switch (lock_order) {
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_INVALID);
@@ -40,6 +40,7 @@ const char *uvm_lock_order_to_string(uvm_lock_order_t lock_order)
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_SERIALIZE_WRITERS);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE);
+        UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_VA_SPACE_RANGE);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_EXT_RANGE_TREE);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_GPU_SEMAPHORE_POOL);
         UVM_ENUM_STRING_CASE(UVM_LOCK_ORDER_RM_API);
@@ -267,6 +268,80 @@ bool __uvm_check_locked(void *lock, uvm_lock_order_t lock_order, uvm_lock_flags_
     return true;
 }
 
+bool __uvm_record_range_lock(void *lock, uvm_lock_order_t lock_order, NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+{
+    bool correct = true;
+    uvm_thread_context_lock_t *uvm_context = uvm_thread_context_lock_get();
+
+    if (!uvm_context) {
+        UVM_ERR_PRINT("Failed to acquire the thread context when recording range lock of %s\n",
+                      uvm_lock_order_to_string(lock_order));
+        return false;
+    }
+
+    if (uvm_context->skip_lock_tracking > 0)
+        return true;
+
+    // The thread context only has room for the range of a single range lock
+    if (lock_order != UVM_LOCK_ORDER_VA_SPACE_RANGE) {
+        UVM_ERR_PRINT("Acquiring a range lock (0x%llx) with unsupported lock order %s\n",
+                      (NvU64)lock,
+                      uvm_lock_order_to_string(lock_order));
+        return false;
+    }
+
+    if (start > end) {
+        UVM_ERR_PRINT("Acquiring range lock %s with an invalid range [0x%llx, 0x%llx]\n",
+                      uvm_lock_order_to_string(lock_order),
+                      start,
+                      end);
+        correct = false;
+    }
+
+    if (!test_bit(UVM_LOCK_ORDER_VA_SPACE, uvm_context->acquired_lock_orders)) {
+        UVM_ERR_PRINT("Acquiring range lock %s without the VA space lock held\n",
+                      uvm_lock_order_to_string(lock_order));
+        correct = false;
+    }
+    else if (test_bit(UVM_LOCK_ORDER_VA_SPACE, uvm_context->exclusive_acquired_lock_orders)) {
+        UVM_ERR_PRINT("Acquiring range lock %s with the VA space lock held in write mode\n",
+                      uvm_lock_order_to_string(lock_order));
+        correct = false;
+    }
+
+    if (!__uvm_record_lock(lock, lock_order, flags))
+        correct = false;
+
+    uvm_context->acquired_range_start = start;
+    uvm_context->acquired_range_end = end;
+
+    return correct;
+}
+
+bool __uvm_check_range_locked(void *lock, uvm_lock_order_t lock_order, NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+{
+    uvm_thread_context_lock_t *uvm_context;
+
+    if (!__uvm_check_locked(lock, lock_order, flags))
+        return false;
+
+    uvm_context = uvm_thread_context_lock_get();
+    if (uvm_context->skip_lock_tracking > 0)
+        return true;
+
+    if (start < uvm_context->acquired_range_start || end > uvm_context->acquired_range_end) {
+        UVM_ERR_PRINT("Range [0x%llx, 0x%llx] not covered by the acquired range [0x%llx, 0x%llx] of lock %s\n",
+                      start,
+                      end,
+                      uvm_context->acquired_range_start,
+                      uvm_context->acquired_range_end,
+                      uvm_lock_order_to_string(lock_order));
+        return false;
+    }
+
+    return true;
+}
+
 bool __uvm_locking_initialized(void)
 {
     return uvm_thread_context_global_initialized();
@@ -369,3 +444,96 @@ void uvm_bit_locks_deinit(uvm_bit_locks_t *bit_locks)
     kfree(bit_locks->bits);
     memset(bit_locks, 0, sizeof(*bit_locks));
 }
+
+// An entry can be granted once no held range overlaps it and no entry queued
+// ahead of it overlaps it either, so overlapping requests are granted in
+// arrival order. Entries not queued yet are behind all the queued ones.
+static bool range_lock_entry_can_grant(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry)
+{
+    uvm_range_lock_entry_t *waiter;
+
+    if (uvm_range_tree_iter_first(&range_lock->held, entry->node.start, entry->node.end))
+        return false;
+
+    list_for_each_entry(waiter, &range_lock->waiters, waiter_node) {
+        if (waiter == entry)
+            break;
+
+        if (uvm_ranges_overlap(waiter->node.start, waiter->node.end, entry->node.start, entry->node.end))
+            return false;
+    }
+
+    return true;
+}
+
+static void range_lock_entry_grant(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry)
+{
+    NV_STATUS status = uvm_range_tree_add(&range_lock->held, &entry->node);
+
+    UVM_ASSERT_MSG(status == NV_OK,
+                   "Granting range lock [0x%llx, 0x%llx] failed: %s\n",
+                   entry->node.start,
+                   entry->node.end,
+                   nvstatusToString(status));
+}
+
+void uvm_range_lock(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry, NvU64 start, NvU64 end)
+{
+    bool granted;
+
+    entry->node.start = start;
+    entry->node.end = end;
+    entry->granted = false;
+
+    uvm_record_range_lock(range_lock, start, end, UVM_LOCK_FLAGS_MODE_EXCLUSIVE);
+
+    spin_lock(&range_lock->lock);
+
+    granted = range_lock_entry_can_grant(range_lock, entry);
+    if (granted) {
+        range_lock_entry_grant(range_lock, entry);
+        entry->granted = true;
+    }
+    else {
+        list_add_tail(&entry->waiter_node, &range_lock->waiters);
+    }
+
+    spin_unlock(&range_lock->lock);
+
+    // Pairs with the smp_store_release() in uvm_range_unlock() so that the
+    // writes of the previous holder are visible once the range is granted.
+    if (!granted)
+        wait_event(range_lock->wait_queue, smp_load_acquire(&entry->granted));
+}
+
+void uvm_range_unlock(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry)
+{
+    uvm_range_lock_entry_t *waiter, *waiter_next;
+    bool wake = false;
+
+    UVM_ASSERT(entry->granted);
+
+    uvm_record_unlock(range_lock, UVM_LOCK_FLAGS_MODE_EXCLUSIVE);
+
+    spin_lock(&range_lock->lock);
+
+    uvm_range_tree_remove(&range_lock->held, &entry->node);
+
+    // Only waiters whose range overlaps the released one can become
+    // grantable, but the check is cheap enough to redo for all of them. A
+    // waiter granted here is in the tree when the later waiters are checked.
+    list_for_each_entry_safe(waiter, waiter_next, &range_lock->waiters, waiter_node) {
+        if (!range_lock_entry_can_grant(range_lock, waiter))
+            continue;
+
+        list_del(&waiter->waiter_node);
+        range_lock_entry_grant(range_lock, waiter);
+        smp_store_release(&waiter->granted, true);
+        wake = true;
+    }
+
+    spin_unlock(&range_lock->lock);
+
+    if (wake)
+        wake_up_all(&range_lock->wait_queue);
+}
@@ -27,6 +27,7 @@
 #include "uvm_forward_decl.h"
 #include "uvm_linux.h"
 #include "uvm_common.h"
+#include "uvm_range_tree.h"
 
 // --------------------------- UVM Locking Order ---------------------------- //
 //
@@ -245,6 +246,20 @@
 //      Write mode: Modification of the range state such as mmap and changes to
 //      logical permissions or location preferences. RM calls are never allowed.
 //
+// - VA space range lock
+//      Order: UVM_LOCK_ORDER_VA_SPACE_RANGE
+//      Exclusive lock over address ranges (uvm_va_space_t::range_lock)
+//
+//      Acquired with the VA space lock held in read mode, for operations that
+//      change per-range state without changing the VA range tree, and that
+//      only need to exclude each other when their address ranges overlap.
+//      Holders of ranges that don't overlap run concurrently, and with all
+//      other VA space lock readers. Operations which need to split or
+//      otherwise modify VA ranges still take the VA space lock in write mode,
+//      which excludes all range lock holders.
+//
+//      A thread holds at most one range at a time.
+//
 // - External Allocation Tree lock
 //      Order: UVM_LOCK_ORDER_EXT_RANGE_TREE
 //      Exclusive lock (mutex) per external VA range, per GPU.
@@ -510,6 +525,7 @@ typedef enum
     UVM_LOCK_ORDER_VA_SPACE_SERIALIZE_WRITERS,
     UVM_LOCK_ORDER_VA_SPACE_READ_ACQUIRE_WRITE_RELEASE_LOCK,
     UVM_LOCK_ORDER_VA_SPACE,
+    UVM_LOCK_ORDER_VA_SPACE_RANGE,
     UVM_LOCK_ORDER_EXT_RANGE_TREE,
     UVM_LOCK_ORDER_GPU_SEMAPHORE_POOL,
     UVM_LOCK_ORDER_RM_API,
@@ -580,6 +596,17 @@ bool __uvm_check_locked(void *lock, uvm_lock_order_t lock_order, uvm_lock_flags_
 // Check that no locks are held with the given lock order
 bool __uvm_check_unlocked_order(uvm_lock_order_t lock_order);
 
+// Record locking the [start, end] range of a range lock. On top of the checks
+// of __uvm_record_lock, this validates the range and that range locks of
+// order UVM_LOCK_ORDER_VA_SPACE_RANGE are acquired with the VA space lock held
+// in read mode. The range is remembered until the matching
+// __uvm_record_unlock.
+bool __uvm_record_range_lock(void *lock, uvm_lock_order_t lock_order, NvU64 start, NvU64 end, uvm_lock_flags_t flags);
+
+// Check that the range lock is held by the current thread, in the given mode,
+// for a range covering [start, end].
+bool __uvm_check_range_locked(void *lock, uvm_lock_order_t lock_order, NvU64 start, NvU64 end, uvm_lock_flags_t flags);
+
 // Check that a lock of the given order can be locked, i.e. that no locks are
 // held with the given or deeper lock order.  Allow for out-of-order locking
 // when checking for a trylock.
@@ -614,6 +641,13 @@ bool __uvm_locking_initialized(void);
             uvm_record_unlock_raw((lock), (lock)->lock_order, (flags) | UVM_LOCK_FLAGS_OUT_OF_ORDER)
   #define uvm_record_downgrade(lock) uvm_record_downgrade_raw((lock), (lock)->lock_order)
 
+  #define uvm_record_range_lock(lock, start, end, flags)                                            \
+      UVM_ASSERT_MSG(__uvm_record_range_lock((lock), (lock)->lock_order, (start), (end), (flags)), \
+                     "Locking violation\n")
+
+  #define uvm_check_range_locked(lock, start, end, flags) \
+      __uvm_check_range_locked((lock), (lock)->lock_order, (start), (end), (flags))
+
   // Check whether a UVM lock (a lock that has a lock_order member) is held in
   // the given mode.
   #define uvm_check_locked(lock, flags) __uvm_check_locked((lock), (lock)->lock_order, (flags))
@@ -669,6 +703,15 @@ bool __uvm_locking_initialized(void);
   #define uvm_record_unlock_out_of_order                UVM_IGNORE_EXPR2
   #define uvm_record_downgrade                          UVM_IGNORE_EXPR
 
+  static void uvm_record_range_lock(void *lock, NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+  {
+  }
+
+  static bool uvm_check_range_locked(void *lock, NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+  {
+      return false;
+  }
+
   static bool uvm_check_locked(void *lock, uvm_lock_flags_t flags)
   {
       return false;
@@ -1277,4 +1320,67 @@ static void __uvm_bit_unlock(uvm_bit_locks_t *bit_locks, unsigned long bit)
     uvm_record_unlock(_bit_locks, UVM_LOCK_FLAGS_MODE_EXCLUSIVE); \
 })
 
+// Range locks are exclusive locks over inclusive address ranges. The held
+// ranges are kept in a uvm_range_tree, which also guarantees that they never
+// overlap. Requests which can't be granted right away are queued in arrival
+// order, and a queued request is granted once its range is not held and no
+// request queued ahead of it overlaps it. This keeps overlapping requests
+// FIFO, while requests for disjoint ranges never wait on each other.
+typedef struct
+{
+    // Protects held and waiters
+    spinlock_t lock;
+
+    // Tree of uvm_range_lock_entry_t::node for the granted ranges
+    uvm_range_tree_t held;
+
+    // List of uvm_range_lock_entry_t waiting for their range, in arrival order
+    struct list_head waiters;
+
+    wait_queue_head_t wait_queue;
+
+#if UVM_IS_DEBUG()
+    uvm_lock_order_t lock_order;
+#endif
+} uvm_range_lock_t;
+
+// Per-acquisition state, provided by the caller (usually on the stack) and
+// passed back to uvm_range_unlock.
+typedef struct
+{
+    // In the held tree once granted
+    uvm_range_tree_node_t node;
+
+    // In the waiters list until granted
+    struct list_head waiter_node;
+
+    bool granted;
+} uvm_range_lock_entry_t;
+
+#define uvm_range_lock_init(range_lock, order) ({                   \
+        uvm_range_lock_t *_range_lock_ = (range_lock);              \
+        spin_lock_init(&_range_lock_->lock);                        \
+        uvm_range_tree_init(&_range_lock_->held);                   \
+        INIT_LIST_HEAD(&_range_lock_->waiters);                     \
+        init_waitqueue_head(&_range_lock_->wait_queue);             \
+        uvm_lock_debug_init(_range_lock_, order);                   \
+    })
+
+#define uvm_range_lock_deinit(range_lock) ({                        \
+        uvm_range_lock_t *_range_lock_ = (range_lock);              \
+        UVM_ASSERT(uvm_range_tree_empty(&_range_lock_->held));      \
+        UVM_ASSERT(list_empty(&_range_lock_->waiters));             \
+    })
+
+// Acquire [start, end], sleeping until no other thread holds an overlapping
+// range.
+void uvm_range_lock(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry, NvU64 start, NvU64 end);
+
+void uvm_range_unlock(uvm_range_lock_t *range_lock, uvm_range_lock_entry_t *entry);
+
+// Assert that the current thread holds a range of range_lock covering
+// [start, end].
+#define uvm_assert_range_locked(range_lock, start, end) \
+        UVM_ASSERT(uvm_check_range_locked((range_lock), (start), (end), UVM_LOCK_FLAGS_MODE_EXCLUSIVE))
+
 #endif // __UVM_LOCK_H__
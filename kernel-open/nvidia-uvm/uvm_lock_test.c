@@ -21,10 +21,14 @@
 
 *******************************************************************************/
 
+#include "uvm_api.h"
 #include "uvm_test.h"
+#include "uvm_test_rng.h"
 #include "uvm_lock.h"
 #include "uvm_global.h"
 #include "uvm_thread_context.h"
+#include "uvm_va_range.h"
+#include "uvm_va_space.h"
 
 #define UVM_LOCK_ORDER_FIRST  (UVM_LOCK_ORDER_INVALID + 1)
 #define UVM_LOCK_ORDER_SECOND (UVM_LOCK_ORDER_INVALID + 2)
@@ -410,6 +414,103 @@ static NV_STATUS test_try_locking_out_of_order(void)
     return NV_OK;
 }
 
+static bool fake_range_lock(NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+{
+    return __uvm_record_range_lock((void*)(long)UVM_LOCK_ORDER_VA_SPACE_RANGE,
+                                   UVM_LOCK_ORDER_VA_SPACE_RANGE,
+                                   start,
+                                   end,
+                                   flags);
+}
+
+static bool fake_check_range_locked(NvU64 start, NvU64 end, uvm_lock_flags_t flags)
+{
+    return __uvm_check_range_locked((void*)(long)UVM_LOCK_ORDER_VA_SPACE_RANGE,
+                                    UVM_LOCK_ORDER_VA_SPACE_RANGE,
+                                    start,
+                                    end,
+                                    flags);
+}
+
+static NV_STATUS test_range_locking(void)
+{
+    // Range locks require the VA space lock in read mode
+    TEST_CHECK_RET(!fake_range_lock(0, 10, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    TEST_CHECK_RET(fake_lock(UVM_LOCK_ORDER_VA_SPACE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(!fake_range_lock(0, 10, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    TEST_CHECK_RET(fake_lock(UVM_LOCK_ORDER_VA_SPACE, UVM_LOCK_FLAGS_MODE_SHARED));
+
+    // Inverted range
+    TEST_CHECK_RET(!fake_range_lock(10, 0, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    TEST_CHECK_RET(fake_range_lock(0x1000, 0x1fff, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_check_range_locked(0x1000, 0x1fff, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_check_range_locked(0x1800, 0x18ff, UVM_LOCK_FLAGS_MODE_ANY));
+    TEST_CHECK_RET(!fake_check_range_locked(0x1000, 0x1fff, UVM_LOCK_FLAGS_MODE_SHARED));
+    TEST_CHECK_RET(!fake_check_range_locked(0x0fff, 0x1fff, UVM_LOCK_FLAGS_MODE_ANY));
+    TEST_CHECK_RET(!fake_check_range_locked(0x1000, 0x2000, UVM_LOCK_FLAGS_MODE_ANY));
+
+    // A thread only holds one range at a time
+    TEST_CHECK_RET(!fake_range_lock(0x3000, 0x3fff, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    // Deeper locks can be taken under the range lock, but not the other way
+    // around
+    TEST_CHECK_RET(fake_range_lock(0x1000, 0x1fff, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_lock(UVM_LOCK_ORDER_VA_BLOCK, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_BLOCK, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    TEST_CHECK_RET(fake_lock(UVM_LOCK_ORDER_VA_BLOCK, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(!fake_range_lock(0x1000, 0x1fff, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock_out_of_order(UVM_LOCK_ORDER_VA_SPACE_RANGE, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_BLOCK, UVM_LOCK_FLAGS_MODE_EXCLUSIVE));
+
+    TEST_CHECK_RET(fake_unlock(UVM_LOCK_ORDER_VA_SPACE, UVM_LOCK_FLAGS_MODE_SHARED));
+
+    TEST_CHECK_RET(__uvm_thread_check_all_unlocked());
+
+    return NV_OK;
+}
+
+static NV_STATUS test_range_lock_uncontended(void)
+{
+    uvm_rw_semaphore_t va_space_lock;
+    uvm_range_lock_t range_lock;
+    uvm_range_lock_entry_t entry;
+
+    uvm_init_rwsem(&va_space_lock, UVM_LOCK_ORDER_VA_SPACE);
+    uvm_range_lock_init(&range_lock, UVM_LOCK_ORDER_VA_SPACE_RANGE);
+
+    uvm_down_read(&va_space_lock);
+
+    uvm_range_lock(&range_lock, &entry, 0x1000, 0x1fff);
+    TEST_CHECK_RET(entry.granted);
+    uvm_assert_range_locked(&range_lock, 0x1000, 0x1fff);
+    TEST_CHECK_RET(uvm_range_tree_iter_first(&range_lock.held, 0, ~0ULL) == &entry.node);
+    uvm_range_unlock(&range_lock, &entry);
+    TEST_CHECK_RET(uvm_range_tree_empty(&range_lock.held));
+
+    uvm_range_lock(&range_lock, &entry, 0, ~0ULL);
+    TEST_CHECK_RET(entry.granted);
+    uvm_assert_range_locked(&range_lock, 0x1000, 0x1fff);
+    uvm_range_unlock(&range_lock, &entry);
+
+    uvm_up_read(&va_space_lock);
+
+    uvm_range_lock_deinit(&range_lock);
+
+    TEST_CHECK_RET(__uvm_thread_check_all_unlocked());
+
+    return NV_OK;
+}
+
 static NV_STATUS run_all_lock_tests(void)
 {
     // The test needs all locks to be released initially
@@ -435,6 +536,8 @@ static NV_STATUS run_all_lock_tests(void)
     TEST_CHECK_RET(test_downgrading_when_different_instance_held() == NV_OK);
     TEST_CHECK_RET(test_downgrading_when_locked_as_shared() == NV_OK);
     TEST_CHECK_RET(test_try_locking_out_of_order() == NV_OK);
+    TEST_CHECK_RET(test_range_locking() == NV_OK);
+    TEST_CHECK_RET(test_range_lock_uncontended() == NV_OK);
 
     return NV_OK;
 }
@@ -458,3 +561,429 @@ NV_STATUS uvm_test_lock_sanity(UVM_TEST_LOCK_SANITY_PARAMS *params, struct file
 
     return status;
 }
+
+// Each thread of the range lock benchmark operates on slots of
+// RANGE_LOCK_BENCH_SLOT_SIZE bytes. Slot ownership is tracked separately from
+// the locks to catch exclusion violations.
+#define RANGE_LOCK_BENCH_SLOT_SIZE       (64 * 1024ULL)
+#define RANGE_LOCK_BENCH_MAX_THREADS     64
+#define RANGE_LOCK_BENCH_MAX_SLOTS       (2 * RANGE_LOCK_BENCH_MAX_THREADS)
+#define RANGE_LOCK_BENCH_MAX_RANGE_SLOTS 4
+
+typedef struct
+{
+    uvm_rw_semaphore_t va_space_lock;
+    uvm_range_lock_t range_lock;
+
+    // Writers use the range lock under the VA space lock in read mode.
+    // Otherwise they take the VA space lock in write mode, as if the range
+    // lock didn't exist.
+    bool use_range_lock;
+
+    const UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params;
+    NvU32 num_slots;
+
+    // Set while owned by a writer
+    atomic_t slot_owners[RANGE_LOCK_BENCH_MAX_SLOTS];
+
+    struct completion start;
+} range_lock_bench_t;
+
+typedef struct
+{
+    range_lock_bench_t *bench;
+    NvU32 index;
+    NV_STATUS status;
+} range_lock_bench_thread_t;
+
+static bool range_lock_bench_claim(range_lock_bench_t *bench, NvU32 first_slot, NvU32 num_slots)
+{
+    NvU32 i;
+
+    for (i = first_slot; i < first_slot + num_slots; i++) {
+        if (atomic_cmpxchg(&bench->slot_owners[i], 0, 1) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+static void range_lock_bench_release(range_lock_bench_t *bench, NvU32 first_slot, NvU32 num_slots)
+{
+    NvU32 i;
+
+    for (i = first_slot; i < first_slot + num_slots; i++)
+        atomic_set(&bench->slot_owners[i], 0);
+}
+
+// Readers stand in for fault servicing, which only takes the VA space lock in
+// read mode. Writers stand in for policy changes on [start, end].
+static NV_STATUS range_lock_bench_op(range_lock_bench_t *bench, NvU32 first_slot, NvU32 num_slots, bool write)
+{
+    const UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params = bench->params;
+    NvU64 start = first_slot * RANGE_LOCK_BENCH_SLOT_SIZE;
+    NvU64 end = start + num_slots * RANGE_LOCK_BENCH_SLOT_SIZE - 1;
+    uvm_range_lock_entry_t entry;
+    bool claimed;
+
+    if (!write) {
+        uvm_down_read(&bench->va_space_lock);
+
+        if (params->hold_ns)
+            ndelay(params->hold_ns);
+
+        uvm_up_read(&bench->va_space_lock);
+
+        return NV_OK;
+    }
+
+    if (bench->use_range_lock) {
+        uvm_down_read(&bench->va_space_lock);
+        uvm_range_lock(&bench->range_lock, &entry, start, end);
+    }
+    else {
+        uvm_down_write(&bench->va_space_lock);
+    }
+
+    claimed = range_lock_bench_claim(bench, first_slot, num_slots);
+
+    if (claimed) {
+        if (params->hold_ns)
+            ndelay(params->hold_ns);
+
+        range_lock_bench_release(bench, first_slot, num_slots);
+    }
+
+    if (bench->use_range_lock) {
+        uvm_range_unlock(&bench->range_lock, &entry);
+        uvm_up_read(&bench->va_space_lock);
+    }
+    else {
+        uvm_up_write(&bench->va_space_lock);
+    }
+
+    if (!claimed) {
+        UVM_TEST_PRINT("Exclusion violation on [0x%llx, 0x%llx]\n", start, end);
+        return NV_ERR_INVALID_STATE;
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS range_lock_bench_thread(range_lock_bench_thread_t *thread)
+{
+    range_lock_bench_t *bench = thread->bench;
+    const UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params = bench->params;
+    uvm_test_rng_t rng;
+    NvU32 i;
+
+    uvm_test_rng_init(&rng, params->seed + thread->index);
+
+    for (i = 0; i < params->iterations; i++) {
+        bool write = uvm_test_rng_range_32(&rng, 1, 100) <= params->write_percent;
+        NvU32 first_slot;
+        NvU32 num_slots;
+        NV_STATUS status;
+
+        if (params->disjoint) {
+            // Each thread owns two slots and never overlaps any other thread
+            num_slots = uvm_test_rng_range_32(&rng, 1, 2);
+            first_slot = 2 * thread->index + 2 - num_slots;
+        }
+        else {
+            num_slots = uvm_test_rng_range_32(&rng, 1, RANGE_LOCK_BENCH_MAX_RANGE_SLOTS);
+            first_slot = uvm_test_rng_range_32(&rng, 0, bench->num_slots - num_slots);
+        }
+
+        status = range_lock_bench_op(bench, first_slot, num_slots, write);
+        if (status != NV_OK)
+            return status;
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS range_lock_bench_thread_entry(range_lock_bench_thread_t *thread)
+{
+    UVM_ENTRY_RET(range_lock_bench_thread(thread));
+}
+
+static int range_lock_bench_kthread(void *arg)
+{
+    range_lock_bench_thread_t *thread = arg;
+
+    wait_for_completion(&thread->bench->start);
+
+    thread->status = range_lock_bench_thread_entry(thread);
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return 0;
+}
+
+// Run the benchmark with num_threads threads and return the average time per
+// operation, measured from the start of the first to the end of the last
+// thread.
+static NV_STATUS range_lock_bench_run(range_lock_bench_t *bench, NvU64 *ns_per_op)
+{
+    const UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params = bench->params;
+    struct task_struct **kthreads;
+    range_lock_bench_thread_t *threads;
+    NV_STATUS status = NV_OK;
+    NvU64 start_time;
+    NvU32 i;
+
+    kthreads = uvm_kvmalloc_zero(params->num_threads * sizeof(*kthreads));
+    threads = uvm_kvmalloc_zero(params->num_threads * sizeof(*threads));
+    if (!kthreads || !threads) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    for (i = 0; i < RANGE_LOCK_BENCH_MAX_SLOTS; i++)
+        atomic_set(&bench->slot_owners[i], 0);
+
+    init_completion(&bench->start);
+
+    for (i = 0; i < params->num_threads; i++) {
+        threads[i].bench = bench;
+        threads[i].index = i;
+
+        kthreads[i] = kthread_run(range_lock_bench_kthread, &threads[i], "uvm_range_lock_bench");
+        if (IS_ERR(kthreads[i])) {
+            status = errno_to_nv_status(PTR_ERR(kthreads[i]));
+            break;
+        }
+    }
+
+    start_time = NV_GETTIME();
+    complete_all(&bench->start);
+
+    while (i-- > 0) {
+        kthread_stop(kthreads[i]);
+
+        if (status == NV_OK)
+            status = threads[i].status;
+    }
+
+    if (status == NV_OK)
+        *ns_per_op = (NV_GETTIME() - start_time) / ((NvU64)params->num_threads * params->iterations);
+
+out:
+    uvm_kvfree(threads);
+    uvm_kvfree(kthreads);
+
+    return status;
+}
+
+NV_STATUS uvm_test_range_lock_benchmark(UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    range_lock_bench_t *bench;
+    NV_STATUS status;
+
+    if (params->num_threads == 0 ||
+        params->num_threads > RANGE_LOCK_BENCH_MAX_THREADS ||
+        params->iterations == 0 ||
+        params->write_percent > 100 ||
+        params->hold_ns > NSEC_PER_MSEC)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    bench = uvm_kvmalloc_zero(sizeof(*bench));
+    if (!bench)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_init_rwsem(&bench->va_space_lock, UVM_LOCK_ORDER_VA_SPACE);
+    uvm_range_lock_init(&bench->range_lock, UVM_LOCK_ORDER_VA_SPACE_RANGE);
+    bench->params = params;
+    bench->num_slots = 2 * params->num_threads;
+
+    bench->use_range_lock = false;
+    status = range_lock_bench_run(bench, &params->rwsem_ns_per_op);
+    if (status != NV_OK)
+        goto out;
+
+    bench->use_range_lock = true;
+    status = range_lock_bench_run(bench, &params->range_lock_ns_per_op);
+
+out:
+    uvm_range_lock_deinit(&bench->range_lock);
+    uvm_kvfree(bench);
+
+    return status;
+}
+
+// Threads of the read duplication race test toggle read duplication on
+// overlapping spans of the same managed allocation through the ioctl entry
+// points, so that both the range-locked and the write-locked paths race with
+// each other.
+typedef struct
+{
+    struct file *filp;
+    NvU64 base;
+    NvU64 length;
+    NvU32 iterations;
+    NvU32 seed;
+    struct completion *start;
+
+    // Whether the last operation of the thread enabled read duplication
+    bool enabled;
+
+    NV_STATUS status;
+} read_dup_race_thread_t;
+
+static NV_STATUS read_dup_race_thread(read_dup_race_thread_t *thread)
+{
+    uvm_test_rng_t rng;
+    NvU32 i;
+
+    uvm_test_rng_init(&rng, thread->seed);
+
+    for (i = 0; i < thread->iterations; i++) {
+        bool enable = uvm_test_rng_range_32(&rng, 0, 1);
+        NV_STATUS status;
+
+        if (enable) {
+            UVM_ENABLE_READ_DUPLICATION_PARAMS params = { .requestedBase = thread->base, .length = thread->length };
+
+            status = uvm_api_enable_read_duplication(&params, thread->filp);
+        }
+        else {
+            UVM_DISABLE_READ_DUPLICATION_PARAMS params = { .requestedBase = thread->base, .length = thread->length };
+
+            status = uvm_api_disable_read_duplication(&params, thread->filp);
+        }
+
+        if (status != NV_OK)
+            return status;
+
+        thread->enabled = enable;
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS read_dup_race_thread_entry(read_dup_race_thread_t *thread)
+{
+    UVM_ENTRY_RET(read_dup_race_thread(thread));
+}
+
+static int read_dup_race_kthread(void *arg)
+{
+    read_dup_race_thread_t *thread = arg;
+
+    wait_for_completion(thread->start);
+
+    thread->status = read_dup_race_thread_entry(thread);
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return 0;
+}
+
+static NV_STATUS read_dup_race_get_policy(uvm_va_space_t *va_space,
+                                          NvU64 addr,
+                                          uvm_read_duplication_policy_t *policy)
+{
+    uvm_va_range_managed_t *managed_range;
+
+    uvm_va_space_down_read(va_space);
+
+    managed_range = uvm_va_range_managed_find(va_space, addr);
+    if (managed_range)
+        *policy = managed_range->policy.read_duplication;
+
+    uvm_va_space_up_read(va_space);
+
+    return managed_range ? NV_OK : NV_ERR_INVALID_ADDRESS;
+}
+
+NV_STATUS uvm_test_read_duplication_race(UVM_TEST_READ_DUPLICATION_RACE_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    const NvU64 end = params->base + params->length;
+    const NvU64 mid = params->base + UVM_PAGE_ALIGN_DOWN(params->length / 2);
+    read_dup_race_thread_t threads[2];
+    struct task_struct *kthreads[2];
+    struct completion start;
+    uvm_read_duplication_policy_t first_guard, last_guard, policy, expected;
+    bool check_policy;
+    NvU64 addr;
+    NV_STATUS status = NV_OK;
+    NvU32 i;
+
+    if (!PAGE_ALIGNED(params->base) ||
+        !PAGE_ALIGNED(params->length) ||
+        params->length < 4 * PAGE_SIZE ||
+        params->iterations == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    // The first and last pages are never part of a span, so their policy must
+    // not change.
+    status = read_dup_race_get_policy(va_space, params->base, &first_guard);
+    if (status != NV_OK)
+        return status;
+
+    status = read_dup_race_get_policy(va_space, end - PAGE_SIZE, &last_guard);
+    if (status != NV_OK)
+        return status;
+
+    init_completion(&start);
+
+    // Thread 0 sets the whole span, thread 1 only its upper half. Thread 1
+    // regularly finds no split needed at mid because the range around it was
+    // just given the same policy by thread 0, while thread 0 changes it again.
+    for (i = 0; i < ARRAY_SIZE(threads); i++) {
+        threads[i].filp = filp;
+        threads[i].base = i == 0 ? params->base + PAGE_SIZE : mid;
+        threads[i].length = end - PAGE_SIZE - threads[i].base;
+        threads[i].iterations = params->iterations;
+        threads[i].seed = params->seed + i;
+        threads[i].start = &start;
+        threads[i].enabled = false;
+        threads[i].status = NV_OK;
+
+        kthreads[i] = kthread_run(read_dup_race_kthread, &threads[i], "uvm_read_dup_race");
+        if (IS_ERR(kthreads[i])) {
+            status = errno_to_nv_status(PTR_ERR(kthreads[i]));
+            break;
+        }
+    }
+
+    complete_all(&start);
+
+    while (i-- > 0) {
+        kthread_stop(kthreads[i]);
+
+        if (status == NV_OK)
+            status = threads[i].status;
+    }
+
+    if (status != NV_OK)
+        return status;
+
+    // Read duplication policies are not applied on integrated GPUs
+    uvm_va_space_down_read(va_space);
+    check_policy = !uvm_va_space_has_integrated_gpu(va_space);
+    uvm_va_space_up_read(va_space);
+
+    if (!check_policy)
+        return NV_OK;
+
+    TEST_NV_CHECK_RET(read_dup_race_get_policy(va_space, params->base, &policy));
+    TEST_CHECK_RET(policy == first_guard);
+
+    TEST_NV_CHECK_RET(read_dup_race_get_policy(va_space, end - PAGE_SIZE, &policy));
+    TEST_CHECK_RET(policy == last_guard);
+
+    // Only thread 0 sets the lower half, so its last operation must be what
+    // sticks there.
+    expected = threads[0].enabled ? UVM_READ_DUPLICATION_ENABLED : UVM_READ_DUPLICATION_DISABLED;
+    for (addr = params->base + PAGE_SIZE; addr < mid; addr += PAGE_SIZE) {
+        TEST_NV_CHECK_RET(read_dup_race_get_policy(va_space, addr, &policy));
+        TEST_CHECK_RET(policy == expected);
+    }
+
+    return NV_OK;
+}
@@ -271,6 +271,8 @@ void uvm_hal_maxwell_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu
     if (uvm_gpu_get_injected_nvlink_error(gpu) != NV_OK && uvm_gpu_address_is_peer(gpu, dst))
         size = 0;
 
+    push->copy_bytes += size;
+
     gpu->parent->ce_hal->memcopy_patch_src(push, &src);
 
     launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
@@ -309,6 +311,70 @@ void uvm_hal_maxwell_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu
     maxwell_membar_after_transfer(push);
 }
 
+void uvm_hal_maxwell_ce_memcopy_strided(uvm_push_t *push,
+                                        uvm_gpu_address_t dst,
+                                        NvU32 dst_pitch,
+                                        uvm_gpu_address_t src,
+                                        NvU32 src_pitch,
+                                        NvU32 line_size,
+                                        NvU32 line_count)
+{
+    uvm_gpu_t *gpu = uvm_push_get_gpu(push);
+
+    NvU32 pipelined_value;
+    NvU32 launch_dma_src_dst_type;
+    NvU32 launch_dma_plc_mode;
+    NvU32 copy_type_value;
+
+    UVM_ASSERT(line_count > 0);
+    UVM_ASSERT(line_size <= dst_pitch);
+    UVM_ASSERT(line_size <= src_pitch);
+
+    UVM_ASSERT_MSG(gpu->parent->ce_hal->memcopy_is_valid(push, dst, src),
+                   "Memcopy validation failed in channel %s, GPU %s.\n",
+                   push->channel->name,
+                   uvm_gpu_name(gpu));
+
+    // See uvm_hal_maxwell_ce_memcopy
+    if (uvm_gpu_get_injected_nvlink_error(gpu) != NV_OK && uvm_gpu_address_is_peer(gpu, dst)) {
+        line_size = 0;
+        line_count = 1;
+    }
+
+    push->copy_bytes += (NvU64)line_size * line_count;
+
+    gpu->parent->ce_hal->memcopy_patch_src(push, &src);
+
+    launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
+    launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
+    copy_type_value = gpu->parent->ce_hal->memcopy_copy_type(dst, src);
+
+    if (uvm_push_get_and_reset_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED))
+        pipelined_value = HWCONST(B0B5, LAUNCH_DMA, DATA_TRANSFER_TYPE, PIPELINED);
+    else
+        pipelined_value = HWCONST(B0B5, LAUNCH_DMA, DATA_TRANSFER_TYPE, NON_PIPELINED);
+
+    gpu->parent->ce_hal->offset_in_out(push, src.address, dst.address);
+
+    NV_PUSH_4U(B0B5, PITCH_IN, src_pitch,
+                     PITCH_OUT, dst_pitch,
+                     LINE_LENGTH_IN, line_size,
+                     LINE_COUNT, line_count);
+
+    NV_PUSH_1U(B0B5, LAUNCH_DMA,
+       HWCONST(B0B5, LAUNCH_DMA, SRC_MEMORY_LAYOUT, PITCH) |
+       HWCONST(B0B5, LAUNCH_DMA, DST_MEMORY_LAYOUT, PITCH) |
+       HWCONST(B0B5, LAUNCH_DMA, MULTI_LINE_ENABLE, TRUE) |
+       HWCONST(B0B5, LAUNCH_DMA, REMAP_ENABLE, FALSE) |
+       HWCONST(B0B5, LAUNCH_DMA, FLUSH_ENABLE, FALSE) |
+       launch_dma_src_dst_type |
+       launch_dma_plc_mode |
+       copy_type_value |
+       pipelined_value);
+
+    maxwell_membar_after_transfer(push);
+}
+
 void uvm_hal_maxwell_ce_memcopy_v_to_v(uvm_push_t *push, NvU64 dst_va, NvU64 src_va, size_t size)
 {
     uvm_push_get_gpu(push)->parent->ce_hal->memcopy(push,
@@ -343,6 +409,8 @@ static void memset_common(uvm_push_t *push, uvm_gpu_address_t dst, size_t size,
                    push->channel->name,
                    uvm_gpu_name(gpu));
 
+    push->copy_bytes += size * memset_element_size;
+
     launch_dma_dst_type = maxwell_memset_push_phys_mode(push, dst);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
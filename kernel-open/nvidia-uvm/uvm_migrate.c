@@ -199,6 +199,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                       uvm_va_block_region_t region,
                                       uvm_processor_id_t dest_id,
                                       uvm_migrate_mode_t mode,
+                                      uvm_make_resident_cause_t cause,
                                       uvm_tracker_t *out_tracker)
 {
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
@@ -217,7 +218,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                  service_context,
                                                  dest_id,
                                                  region,
-                                                 UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                 cause);
     }
     else {
         uvm_va_policy_t *policy = &va_block->managed_range->policy;
@@ -235,7 +236,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                                    region,
                                                                    make_resident_mask,
                                                                    NULL,
-                                                                   UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                                   cause);
             }
 
             // We've read-duplicated all non-discarded pages.
@@ -248,7 +249,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                     region,
                                                     make_resident_mask,
                                                     NULL,
-                                                    UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                    cause);
             }
         }
         else {
@@ -259,7 +260,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                 region,
                                                 NULL,
                                                 NULL,
-                                                UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                cause);
         }
     }
 
@@ -484,6 +485,7 @@ static NV_STATUS uvm_va_range_migrate_multi_block(uvm_va_range_managed_t *manage
                                                                      region,
                                                                      dest_id,
                                                                      mode,
+                                                                     UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                                      out_tracker));
         if (status != NV_OK)
             return status;
@@ -875,9 +877,175 @@ void uvm_migrate_exit(void)
     uvm_migrate_pageable_exit();
 }
 
-NV_STATUS uvm_api_migrate(UVM_MIGRATE_PARAMS *params, struct file *filp)
+// Look up the destination of a migration, and check that it can be used for
+// the given range. *out_dest_gpu is set to NULL if the destination is the CPU.
+static NV_STATUS migrate_get_destination(uvm_va_space_t *va_space,
+                                         const NvProcessorUuid *destination_uuid,
+                                         int cpu_numa_node,
+                                         NvU32 flags,
+                                         NvU64 base,
+                                         NvU64 length,
+                                         uvm_gpu_t **out_dest_gpu)
+{
+    uvm_gpu_t *dest_gpu = NULL;
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    if (!uvm_uuid_is_cpu(destination_uuid)) {
+        if (flags & UVM_MIGRATE_FLAG_NO_GPU_VA_SPACE)
+            dest_gpu = uvm_va_space_get_gpu_by_uuid(va_space, destination_uuid);
+        else
+            dest_gpu = uvm_va_space_get_gpu_by_uuid_with_gpu_va_space(va_space, destination_uuid);
+
+        if (!dest_gpu)
+            return NV_ERR_INVALID_DEVICE;
+
+        if (length > 0 && !uvm_gpu_can_address(dest_gpu, base, length))
+            return NV_ERR_OUT_OF_RANGE;
+    }
+    else {
+        // If cpu_numa_node is not -1, we only check that it is a valid node in
+        // the system, it has memory, and it doesn't correspond to a GPU node.
+        //
+        // For pageable memory, this is fine because alloc_pages_node will clamp
+        // the allocation to cpuset_current_mems_allowed when uvm_migrate
+        //_pageable is called from process context (uvm_migrate) when dst_id is
+        // CPU. UVM bottom half calls uvm_migrate_pageable with CPU dst_id only
+        // when the VMA memory policy is set to dst_node_id and dst_node_id is
+        // not NUMA_NO_NODE.
+        if (cpu_numa_node != -1 &&
+            (!nv_numa_node_has_memory(cpu_numa_node) ||
+             !node_isset(cpu_numa_node, node_possible_map) ||
+             uvm_va_space_find_gpu_with_memory_node_id(va_space, cpu_numa_node)))
+            return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    *out_dest_gpu = dest_gpu;
+
+    return NV_OK;
+}
+
+// Migrate [base, base + length) to dest_gpu, or to the CPU if dest_gpu is
+// NULL. type must be the result of uvm_api_range_type_check on the range.
+static NV_STATUS migrate_range(uvm_va_space_t *va_space,
+                               struct mm_struct *mm,
+                               NvU64 base,
+                               NvU64 length,
+                               uvm_api_range_type_t type,
+                               uvm_gpu_t *dest_gpu,
+                               int cpu_numa_node,
+                               NvU32 flags,
+                               NvU64 *user_space_start,
+                               NvU64 *user_space_length,
+                               uvm_tracker_t *tracker_ptr,
+                               uvm_processor_mask_t *gpus_to_check_for_nvlink_errors)
+{
+    uvm_processor_id_t dest_id = dest_gpu ? dest_gpu->id : UVM_ID_CPU;
+
+    // Migration to an integrated GPU is equivalent to migration to that
+    // GPUs nearest NUMA node.
+    if (dest_gpu && dest_gpu->parent->is_integrated_gpu) {
+        dest_id = UVM_ID_CPU;
+        cpu_numa_node = dest_gpu->parent->closest_cpu_numa_node;
+    }
+
+    if (type == UVM_API_RANGE_TYPE_INVALID)
+        return NV_ERR_INVALID_ADDRESS;
+
+    if (type == UVM_API_RANGE_TYPE_ATS) {
+        uvm_migrate_args_t uvm_migrate_args =
+        {
+            .va_space                           = va_space,
+            .mm                                 = mm,
+            .start                              = base,
+            .length                             = length,
+            .dst_id                             = dest_id,
+            .dst_node_id                        = cpu_numa_node,
+            .populate_permissions               = UVM_POPULATE_PERMISSIONS_INHERIT,
+            .populate_flags                     = UVM_POPULATE_PAGEABLE_FLAG_SKIP_PROT_CHECK,
+            .cause                              = UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
+            .skip_mapped                        = false,
+            .populate_on_cpu_alloc_failures     = false,
+            .populate_on_migrate_vma_failures   = true,
+            .user_space_start                   = user_space_start,
+            .user_space_length                  = user_space_length,
+            .gpus_to_check_for_nvlink_errors    = gpus_to_check_for_nvlink_errors,
+            .fail_on_unresolved_sto_errors      = false,
+        };
+
+        if (dest_gpu && dest_gpu->parent->cdmm_enabled) {
+            uvm_migrate_args.dst_id = UVM_ID_CPU;
+            uvm_migrate_args.dst_node_id = dest_gpu->parent->closest_cpu_numa_node;
+            uvm_migrate_args.populate_on_cpu_alloc_failures = true;
+        }
+
+        return uvm_migrate_pageable(&uvm_migrate_args);
+    }
+
+    return uvm_migrate(va_space,
+                       mm,
+                       base,
+                       length,
+                       dest_id,
+                       (UVM_ID_IS_CPU(dest_id) ? cpu_numa_node : NUMA_NO_NODE),
+                       flags,
+                       uvm_va_space_iter_managed_first(va_space, base, base),
+                       tracker_ptr,
+                       gpus_to_check_for_nvlink_errors);
+}
+
+// Return true if the range at index next of the batch can be migrated together
+// with the ranges accumulated in [base, base + length), which all go to the
+// same destination as first.
+static bool migrate_batch_can_coalesce(uvm_va_space_t *va_space,
+                                       struct mm_struct *mm,
+                                       const UVM_MIGRATE_BATCHED_RANGE *first,
+                                       const UVM_MIGRATE_BATCHED_RANGE *next,
+                                       NvU64 base,
+                                       NvU64 length,
+                                       uvm_api_range_type_t type,
+                                       uvm_gpu_t *dest_gpu)
+{
+    if (next->base != base + length)
+        return false;
+
+    if (!uvm_uuid_eq(&next->destinationUuid, &first->destinationUuid) || next->cpuNumaNode != first->cpuNumaNode)
+        return false;
+
+    // Let the range fail on its own if the destination cannot address it
+    if (dest_gpu && !uvm_gpu_can_address(dest_gpu, next->base, next->length))
+        return false;
+
+    // Managed and pageable memory take different paths
+    return uvm_api_range_type_check(va_space, mm, next->base, next->length) == type;
+}
+
+// Common implementation of UVM_MIGRATE and UVM_MIGRATE_BATCHED. The ranges are
+// migrated in order, under a single hold of the VA space lock and of
+// mmap_lock. The work for all of them is accumulated in a single tracker, so
+// the copies of a range are pushed without waiting for the previous ones to
+// complete, and the semaphore, if any, is released once the work for all the
+// ranges is done.
+//
+// Ranges must have been validated with uvm_api_range_invalid, except for
+// zero-length ranges, which only validate the destination. Consecutive ranges
+// that are contiguous in VA and go to the same destination are coalesced into
+// a single migration.
+//
+// On return, *out_num_done is the number of ranges that were migrated. On
+// error, the range at index *out_num_done and the ranges coalesced with it
+// caused the error, and user_space_start and user_space_length are set as for
+// UVM_MIGRATE.
+static NV_STATUS migrate_batch(uvm_va_space_t *va_space,
+                               const UVM_MIGRATE_BATCHED_RANGE *ranges,
+                               NvU64 num_ranges,
+                               NvU32 flags,
+                               NvU64 semaphore_address,
+                               NvU32 semaphore_payload,
+                               NvU64 *out_num_done,
+                               NvU64 *user_space_start,
+                               NvU64 *user_space_length)
 {
-    uvm_va_space_t *va_space = uvm_va_space_get(filp);
     uvm_tracker_t tracker = UVM_TRACKER_INIT();
     uvm_tracker_t *tracker_ptr = NULL;
     uvm_gpu_t *dest_gpu = NULL;
@@ -885,25 +1053,16 @@ NV_STATUS uvm_api_migrate(UVM_MIGRATE_PARAMS *params, struct file *filp)
     struct mm_struct *mm;
     NV_STATUS status = NV_OK;
     bool flush_events = false;
-    const bool synchronous = !(params->flags & UVM_MIGRATE_FLAG_ASYNC);
-    int cpu_numa_node = (int)params->cpuNumaNode;
+    const bool synchronous = !(flags & UVM_MIGRATE_FLAG_ASYNC);
     uvm_processor_mask_t *gpus_to_check_for_nvlink_errors = NULL;
+    NvU64 i;
 
-    // We temporarily allow 0 length in the IOCTL parameters as a signal to
-    // only release the semaphore. This is because user-space is in charge of
-    // migrating pageable memory in some cases.
-    //
-    // TODO: Bug 2419180: do not allow 0 length migrations when we fully switch
-    // to migrate_vma for all types of vmas.
-    if (params->length > 0 || synchronous || params->semaphoreAddress == 0) {
-        if (uvm_api_range_invalid(params->base, params->length))
-            return NV_ERR_INVALID_ADDRESS;
-    }
+    *out_num_done = 0;
 
-    if (params->flags & ~UVM_MIGRATE_FLAGS_ALL)
+    if (flags & ~UVM_MIGRATE_FLAGS_ALL)
         return NV_ERR_INVALID_ARGUMENT;
 
-    if ((params->flags & UVM_MIGRATE_FLAGS_TEST_ALL) && !uvm_enable_builtin_tests) {
+    if ((flags & UVM_MIGRATE_FLAGS_TEST_ALL) && !uvm_enable_builtin_tests) {
         UVM_INFO_PRINT("Test flag set for UVM_MIGRATE. Did you mean to insmod with uvm_enable_builtin_tests=1?\n");
         return NV_ERR_INVALID_ARGUMENT;
     }
@@ -919,21 +1078,21 @@ NV_STATUS uvm_api_migrate(UVM_MIGRATE_PARAMS *params, struct file *filp)
     uvm_va_space_down_read(va_space);
 
     if (synchronous) {
-        if (params->semaphoreAddress != 0) {
+        if (semaphore_address != 0) {
             status = NV_ERR_INVALID_ARGUMENT;
             goto done;
         }
     }
     else {
-        if (params->semaphoreAddress == 0) {
-            if (params->semaphorePayload != 0) {
+        if (semaphore_address == 0) {
+            if (semaphore_payload != 0) {
                 status = NV_ERR_INVALID_ARGUMENT;
                 goto done;
             }
         }
         else {
-            sema_va_range = uvm_va_range_semaphore_pool_find(va_space, params->semaphoreAddress);
-            if (!IS_ALIGNED(params->semaphoreAddress, sizeof(params->semaphorePayload)) ||
+            sema_va_range = uvm_va_range_semaphore_pool_find(va_space, semaphore_address);
+            if (!IS_ALIGNED(semaphore_address, sizeof(semaphore_payload)) ||
                     !sema_va_range) {
                 status = NV_ERR_INVALID_ADDRESS;
                 goto done;
@@ -941,105 +1100,59 @@ NV_STATUS uvm_api_migrate(UVM_MIGRATE_PARAMS *params, struct file *filp)
         }
     }
 
-    if (!uvm_uuid_is_cpu(&params->destinationUuid)) {
-        if (params->flags & UVM_MIGRATE_FLAG_NO_GPU_VA_SPACE)
-            dest_gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->destinationUuid);
-        else
-            dest_gpu = uvm_va_space_get_gpu_by_uuid_with_gpu_va_space(va_space, &params->destinationUuid);
-
-        if (!dest_gpu) {
-            status = NV_ERR_INVALID_DEVICE;
-            goto done;
-        }
-
-        if (params->length > 0 && !uvm_gpu_can_address(dest_gpu, params->base, params->length)) {
-            status = NV_ERR_OUT_OF_RANGE;
-            goto done;
-        }
-    }
-    else {
-        // If cpu_numa_node is not -1, we only check that it is a valid node in
-        // the system, it has memory, and it doesn't correspond to a GPU node.
-        //
-        // For pageable memory, this is fine because alloc_pages_node will clamp
-        // the allocation to cpuset_current_mems_allowed when uvm_migrate
-        //_pageable is called from process context (uvm_migrate) when dst_id is
-        // CPU. UVM bottom half calls uvm_migrate_pageable with CPU dst_id only
-        // when the VMA memory policy is set to dst_node_id and dst_node_id is
-        // not NUMA_NO_NODE.
-        if (cpu_numa_node != -1 &&
-            (!nv_numa_node_has_memory(cpu_numa_node) ||
-             !node_isset(cpu_numa_node, node_possible_map) ||
-             uvm_va_space_find_gpu_with_memory_node_id(va_space, cpu_numa_node))) {
-            status = NV_ERR_INVALID_ARGUMENT;
-            goto done;
-        }
-    }
-
-    UVM_ASSERT(status == NV_OK);
-
     // If we're synchronous or if we need to release a semaphore, use a tracker.
-    if (synchronous || params->semaphoreAddress)
+    if (synchronous || semaphore_address)
         tracker_ptr = &tracker;
 
-    if (params->length > 0) {
+    i = 0;
+    while (i < num_ranges) {
+        const UVM_MIGRATE_BATCHED_RANGE *range = &ranges[i];
+        NvU64 base = range->base;
+        NvU64 length = range->length;
         uvm_api_range_type_t type;
-        uvm_processor_id_t dest_id = dest_gpu ? dest_gpu->id : UVM_ID_CPU;
+        NvU64 next;
+
+        status = migrate_get_destination(va_space,
+                                         &range->destinationUuid,
+                                         range->cpuNumaNode,
+                                         flags,
+                                         base,
+                                         length,
+                                         &dest_gpu);
+        if (status != NV_OK)
+            break;
 
-        // Migration to an integrated GPU is equivalent to migration to that
-        // GPUs nearest NUMA node.
-        if (dest_gpu && dest_gpu->parent->is_integrated_gpu) {
-            dest_id = UVM_ID_CPU;
-            cpu_numa_node = dest_gpu->parent->closest_cpu_numa_node;
+        if (length == 0) {
+            *out_num_done = ++i;
+            continue;
         }
 
-        type = uvm_api_range_type_check(va_space, mm, params->base, params->length);
-        if (type == UVM_API_RANGE_TYPE_INVALID) {
-            status = NV_ERR_INVALID_ADDRESS;
-            goto done;
-        }
+        type = uvm_api_range_type_check(va_space, mm, base, length);
 
-        if (type == UVM_API_RANGE_TYPE_ATS) {
-            uvm_migrate_args_t uvm_migrate_args =
-            {
-                .va_space                           = va_space,
-                .mm                                 = mm,
-                .start                              = params->base,
-                .length                             = params->length,
-                .dst_id                             = dest_id,
-                .dst_node_id                        = cpu_numa_node,
-                .populate_permissions               = UVM_POPULATE_PERMISSIONS_INHERIT,
-                .populate_flags                     = UVM_POPULATE_PAGEABLE_FLAG_SKIP_PROT_CHECK,
-                .cause                              = UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
-                .skip_mapped                        = false,
-                .populate_on_cpu_alloc_failures     = false,
-                .populate_on_migrate_vma_failures   = true,
-                .user_space_start                   = &params->userSpaceStart,
-                .user_space_length                  = &params->userSpaceLength,
-                .gpus_to_check_for_nvlink_errors    = gpus_to_check_for_nvlink_errors,
-                .fail_on_unresolved_sto_errors      = false,
-            };
-
-            if (dest_gpu && dest_gpu->parent->cdmm_enabled) {
-                uvm_migrate_args.dst_id = UVM_ID_CPU;
-                uvm_migrate_args.dst_node_id = dest_gpu->parent->closest_cpu_numa_node;
-                uvm_migrate_args.populate_on_cpu_alloc_failures = true;
-            }
+        for (next = i + 1; next < num_ranges; next++) {
+            if (!migrate_batch_can_coalesce(va_space, mm, range, &ranges[next], base, length, type, dest_gpu))
+                break;
 
-            status = uvm_migrate_pageable(&uvm_migrate_args);
-        }
-        else {
-            status = uvm_migrate(va_space,
-                                 mm,
-                                 params->base,
-                                 params->length,
-                                 dest_id,
-                                 (UVM_ID_IS_CPU(dest_id) ? cpu_numa_node : NUMA_NO_NODE),
-                                 params->flags,
-                                 uvm_va_space_iter_managed_first(va_space, params->base, params->base),
-                                 tracker_ptr,
-                                 gpus_to_check_for_nvlink_errors);
+            length += ranges[next].length;
         }
+
+        status = migrate_range(va_space,
+                               mm,
+                               base,
+                               length,
+                               type,
+                               dest_gpu,
+                               range->cpuNumaNode,
+                               flags,
+                               user_space_start,
+                               user_space_length,
+                               tracker_ptr,
+                               gpus_to_check_for_nvlink_errors);
+        if (status != NV_OK)
+            break;
+
+        i = next;
+        *out_num_done = i;
     }
 
 done:
@@ -1056,10 +1169,11 @@ done:
         uvm_up_read_mmap_lock_out_of_order(mm);
 
     if (tracker_ptr) {
-        // If requested, release semaphore
-        if (params->semaphoreAddress && (status == NV_OK)) {
-            status = semaphore_release(params->semaphoreAddress,
-                                       params->semaphorePayload,
+        // If requested, release semaphore. The destination of the last range
+        // is used as a hint for the GPU doing the release.
+        if (semaphore_address && (status == NV_OK)) {
+            status = semaphore_release(semaphore_address,
+                                       semaphore_payload,
                                        sema_va_range,
                                        dest_gpu,
                                        tracker_ptr);
@@ -1100,6 +1214,83 @@ done:
     return status;
 }
 
+NV_STATUS uvm_api_migrate(UVM_MIGRATE_PARAMS *params, struct file *filp)
+{
+    UVM_MIGRATE_BATCHED_RANGE range = {0};
+    NvU64 num_done;
+    const bool synchronous = !(params->flags & UVM_MIGRATE_FLAG_ASYNC);
+
+    // We temporarily allow 0 length in the IOCTL parameters as a signal to
+    // only release the semaphore. This is because user-space is in charge of
+    // migrating pageable memory in some cases.
+    //
+    // TODO: Bug 2419180: do not allow 0 length migrations when we fully switch
+    // to migrate_vma for all types of vmas.
+    if (params->length > 0 || synchronous || params->semaphoreAddress == 0) {
+        if (uvm_api_range_invalid(params->base, params->length))
+            return NV_ERR_INVALID_ADDRESS;
+    }
+
+    range.base = params->base;
+    range.length = params->length;
+    range.destinationUuid = params->destinationUuid;
+    range.cpuNumaNode = params->cpuNumaNode;
+
+    return migrate_batch(uvm_va_space_get(filp),
+                         &range,
+                         1,
+                         params->flags,
+                         params->semaphoreAddress,
+                         params->semaphorePayload,
+                         &num_done,
+                         &params->userSpaceStart,
+                         &params->userSpaceLength);
+}
+
+NV_STATUS uvm_api_migrate_batched(UVM_MIGRATE_BATCHED_PARAMS *params, struct file *filp)
+{
+    UVM_MIGRATE_BATCHED_RANGE *ranges;
+    NV_STATUS status;
+    NvU64 i;
+
+    params->numRangesDone = 0;
+
+    if (params->numRanges == 0 || params->numRanges > UVM_MIGRATE_BATCHED_MAX_RANGES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    ranges = uvm_kvmalloc(sizeof(*ranges) * params->numRanges);
+    if (!ranges)
+        return NV_ERR_NO_MEMORY;
+
+    if (copy_from_user(ranges, (const void __user *)params->ranges, sizeof(*ranges) * params->numRanges)) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    // Unlike UVM_MIGRATE, zero-length ranges are not allowed
+    for (i = 0; i < params->numRanges; i++) {
+        if (uvm_api_range_invalid(ranges[i].base, ranges[i].length)) {
+            status = NV_ERR_INVALID_ADDRESS;
+            goto out;
+        }
+    }
+
+    status = migrate_batch(uvm_va_space_get(filp),
+                           ranges,
+                           params->numRanges,
+                           params->flags,
+                           params->semaphoreAddress,
+                           params->semaphorePayload,
+                           &params->numRangesDone,
+                           &params->userSpaceStart,
+                           &params->userSpaceLength);
+
+out:
+    uvm_kvfree(ranges);
+
+    return status;
+}
+
 NV_STATUS uvm_api_migrate_range_group(UVM_MIGRATE_RANGE_GROUP_PARAMS *params, struct file *filp)
 {
     NV_STATUS status = NV_OK;
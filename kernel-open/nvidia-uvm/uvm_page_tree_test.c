@@ -2905,3 +2905,152 @@ done:
 
     return status;
 }
+
+// Model the first mapping of num_blocks consecutive VA blocks starting at
+// start: each block gets its 2M entry and allocates a big page table under it.
+// The time spent is returned in out_ns.
+static NV_STATUS prebuild_benchmark_first_touch(uvm_page_tree_t *tree,
+                                                NvU64 start,
+                                                NvU32 num_blocks,
+                                                uvm_page_table_range_t *parents,
+                                                uvm_page_table_range_t *children,
+                                                NvU64 *out_ns)
+{
+    NvU64 start_time = NV_GETTIME();
+    NvU32 i;
+
+    for (i = 0; i < num_blocks; i++) {
+        NvU64 address = start + (NvU64)i * UVM_PAGE_SIZE_2M;
+
+        TEST_NV_CHECK_RET(test_page_tree_get_ptes(tree, UVM_PAGE_SIZE_2M, address, UVM_PAGE_SIZE_2M, &parents[i]));
+        TEST_NV_CHECK_RET(test_page_tree_alloc_table(tree, UVM_PAGE_SIZE_64K, &parents[i], &children[i]));
+    }
+
+    *out_ns = NV_GETTIME() - start_time;
+
+    return NV_OK;
+}
+
+static void prebuild_benchmark_put(uvm_page_tree_t *tree,
+                                   NvU32 num_blocks,
+                                   uvm_page_table_range_t *parents,
+                                   uvm_page_table_range_t *children)
+{
+    NvU32 i;
+
+    for (i = 0; i < num_blocks; i++) {
+        uvm_page_tree_put_ptes(tree, &children[i]);
+        uvm_page_tree_put_ptes(tree, &parents[i]);
+    }
+}
+
+static NV_STATUS prebuild_benchmark(uvm_gpu_t *gpu, UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK_PARAMS *params)
+{
+    NV_STATUS status = NV_OK;
+    uvm_page_tree_t tree;
+    uvm_page_table_range_vec_t *range_vec = NULL;
+    uvm_page_table_range_t *parents;
+    uvm_page_table_range_t *children;
+    NvU64 size = (NvU64)params->num_blocks * UVM_PAGE_SIZE_2M;
+
+    // Start at a 1G boundary to measure a fresh set of upper directories
+    NvU64 start = UVM_SIZE_1GB;
+    NvU64 start_time;
+
+    TEST_CHECK_RET(fake_gpu_init_pascal(gpu) == NV_OK);
+
+    parents = uvm_kvmalloc_zero(sizeof(*parents) * params->num_blocks);
+    children = uvm_kvmalloc_zero(sizeof(*children) * params->num_blocks);
+    if (!parents || !children) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    // Lazy: all the directories are allocated on first touch
+    TEST_NV_CHECK_GOTO(test_page_tree_init(gpu, BIG_PAGE_SIZE_PASCAL, &tree), done);
+    TEST_NV_CHECK_GOTO(prebuild_benchmark_first_touch(&tree, start, params->num_blocks, parents, children, &params->lazy_ns),
+                       done_tree);
+    prebuild_benchmark_put(&tree, params->num_blocks, parents, children);
+    uvm_page_tree_deinit(&tree);
+
+    memset(parents, 0, sizeof(*parents) * params->num_blocks);
+    memset(children, 0, sizeof(*children) * params->num_blocks);
+
+    // Prebuilt: the directories down to the 2M entries exist before the first
+    // touch of any block.
+    TEST_NV_CHECK_GOTO(test_page_tree_init(gpu, BIG_PAGE_SIZE_PASCAL, &tree), done);
+
+    start_time = NV_GETTIME();
+    TEST_NV_CHECK_GOTO(uvm_page_table_range_vec_create(&tree,
+                                                       start,
+                                                       size,
+                                                       UVM_PAGE_SIZE_2M,
+                                                       UVM_PMM_ALLOC_FLAGS_NONE,
+                                                       &range_vec),
+                       done_tree);
+    params->prebuild_ns = NV_GETTIME() - start_time;
+
+    TEST_NV_CHECK_GOTO(prebuild_benchmark_first_touch(&tree,
+                                                      start,
+                                                      params->num_blocks,
+                                                      parents,
+                                                      children,
+                                                      &params->prebuilt_first_touch_ns),
+                       done_tree);
+    prebuild_benchmark_put(&tree, params->num_blocks, parents, children);
+
+done_tree:
+    uvm_page_table_range_vec_destroy(range_vec);
+
+    // Like the rest of the page tree tests, the tree is leaked on error as the
+    // destructor would likely assert.
+    if (status == NV_OK)
+        uvm_page_tree_deinit(&tree);
+
+done:
+    uvm_kvfree(children);
+    uvm_kvfree(parents);
+
+    return status;
+}
+
+NV_STATUS uvm_test_page_tree_prebuild_benchmark(UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK_PARAMS *params,
+                                                struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_parent_gpu_t *parent_gpu;
+    uvm_gpu_t *gpu;
+
+    // Keep the range within the first 512G PDE3 entry
+    if (params->num_blocks == 0 || params->num_blocks > (UVM_SIZE_1TB / 2 - UVM_SIZE_1GB) / UVM_PAGE_SIZE_2M)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    parent_gpu = uvm_kvmalloc_zero(sizeof(*parent_gpu));
+    if (!parent_gpu)
+        return NV_ERR_NO_MEMORY;
+
+    gpu = uvm_kvmalloc_zero(sizeof(*gpu));
+    if (!gpu) {
+        uvm_kvfree(parent_gpu);
+        return NV_ERR_NO_MEMORY;
+    }
+
+    parent_gpu->gpus[0] = gpu;
+    gpu->parent = parent_gpu;
+
+    // The fake GPU relies on global state, see uvm_test_page_tree
+    uvm_mutex_lock(&g_uvm_global.global_lock);
+
+    TEST_NV_CHECK_GOTO(fake_tlb_invals_alloc(), done);
+    TEST_NV_CHECK_GOTO(prebuild_benchmark(gpu, params), done);
+
+done:
+    fake_tlb_invals_free();
+
+    uvm_mutex_unlock(&g_uvm_global.global_lock);
+
+    uvm_kvfree(gpu);
+    uvm_kvfree(parent_gpu);
+
+    return status;
+}
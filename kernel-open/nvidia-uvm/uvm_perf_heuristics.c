@@ -25,6 +25,8 @@
 #include "uvm_perf_heuristics.h"
 #include "uvm_perf_thrashing.h"
 #include "uvm_perf_prefetch.h"
+#include "uvm_perf_prefetch_stream.h"
+#include "uvm_perf_tiering.h"
 #include "uvm_gpu_access_counters.h"
 #include "uvm_va_space.h"
 
@@ -40,6 +42,14 @@ NV_STATUS uvm_perf_heuristics_init(void)
     if (status != NV_OK)
         return status;
 
+    status = uvm_perf_prefetch_stream_init();
+    if (status != NV_OK)
+        return status;
+
+    status = uvm_perf_tiering_init();
+    if (status != NV_OK)
+        return status;
+
     status = uvm_perf_access_counters_init();
     if (status != NV_OK)
         return status;
@@ -49,6 +59,7 @@ NV_STATUS uvm_perf_heuristics_init(void)
 
 void uvm_perf_heuristics_exit(void)
 {
+    uvm_perf_tiering_exit();
     uvm_perf_access_counters_exit();
     uvm_perf_thrashing_exit();
 }
@@ -75,6 +86,12 @@ NV_STATUS uvm_perf_heuristics_load(uvm_va_space_t *va_space)
     if (status != NV_OK)
         return status;
     status = uvm_perf_access_counters_load(va_space);
+    if (status != NV_OK)
+        return status;
+    status = uvm_perf_prefetch_stream_load(va_space);
+    if (status != NV_OK)
+        return status;
+    status = uvm_perf_tiering_load(va_space);
     if (status != NV_OK)
         return status;
 
@@ -93,6 +110,7 @@ void uvm_perf_heuristics_stop(uvm_va_space_t *va_space)
     uvm_assert_lockable_order(UVM_LOCK_ORDER_VA_SPACE);
 
     // Prefetch heuristics don't need a stop operation for now
+    uvm_perf_tiering_stop(va_space);
     uvm_perf_thrashing_stop(va_space);
 }
 
@@ -100,6 +118,8 @@ void uvm_perf_heuristics_unload(uvm_va_space_t *va_space)
 {
     uvm_assert_rwsem_locked_write(&va_space->lock);
 
+    uvm_perf_tiering_unload(va_space);
+    uvm_perf_prefetch_stream_unload(va_space);
     uvm_perf_access_counters_unload(va_space);
     uvm_perf_thrashing_unload(va_space);
 }
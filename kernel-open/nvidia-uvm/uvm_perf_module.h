@@ -47,6 +47,10 @@
 // provides thrashing prevention mechanisms
 // - UVM_PERF_MODULE_TYPE_ACCESS_COUNTERS: migrates memory using access counter
 // notifications
+// - UVM_PERF_MODULE_TYPE_PREFETCH_STREAM: detects sequential and strided fault
+// streams and prefetches memory ahead of them
+// - UVM_PERF_MODULE_TYPE_TIERING: tracks how hot VA blocks are and migrates
+// them between vidmem and sysmem in the background
 typedef enum
 {
     UVM_PERF_MODULE_FIRST_TYPE     = 0,
@@ -54,6 +58,8 @@ typedef enum
     UVM_PERF_MODULE_TYPE_TEST      = UVM_PERF_MODULE_FIRST_TYPE,
     UVM_PERF_MODULE_TYPE_THRASHING,
     UVM_PERF_MODULE_TYPE_ACCESS_COUNTERS,
+    UVM_PERF_MODULE_TYPE_PREFETCH_STREAM,
+    UVM_PERF_MODULE_TYPE_TIERING,
 
     UVM_PERF_MODULE_TYPE_COUNT,
 } uvm_perf_module_type_t;
@@ -25,6 +25,7 @@
 #include "uvm_perf_events.h"
 #include "uvm_perf_module.h"
 #include "uvm_perf_prefetch.h"
+#include "uvm_perf_prefetch_stream.h"
 #include "uvm_perf_utils.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_va_block.h"
@@ -442,6 +443,10 @@ static NvU32 uvm_perf_prefetch_prenotify_fault_migrations(uvm_va_block_t *va_blo
                               bitmap_tree,
                               &va_block_context->scratch_page_mask,
                               prefetch_pages);
+
+        // Add the pages that sequential or strided fault streams are expected
+        // to touch next, which may be too sparse for the bitmap tree to pick up
+        uvm_perf_prefetch_stream_get_block_mask(va_block, new_residency, max_prefetch_region, prefetch_pages);
     }
 
     // Do not prefetch pages that are going to be migrated/populated due to a
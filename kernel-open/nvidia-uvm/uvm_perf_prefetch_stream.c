@@ -0,0 +1,758 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_linux.h"
+#include "uvm_global.h"
+#include "uvm_perf_events.h"
+#include "uvm_perf_module.h"
+#include "uvm_perf_prefetch.h"
+#include "uvm_perf_prefetch_stream.h"
+#include "uvm_perf_thrashing.h"
+#include "uvm_perf_utils.h"
+#include "uvm_kvmalloc.h"
+#include "uvm_range_group.h"
+#include "uvm_va_block.h"
+#include "uvm_va_range.h"
+#include "uvm_va_space.h"
+
+//
+// Tunables for stream prefetching (configurable via module parameters)
+//
+
+#define UVM_PERF_PREFETCH_STREAM_ENABLE_DEFAULT 0
+
+// Enable/disable the stream prefetcher. It is only used when the bitmap tree
+// prefetcher is enabled, too.
+static unsigned uvm_perf_prefetch_stream_enable = UVM_PERF_PREFETCH_STREAM_ENABLE_DEFAULT;
+
+#define UVM_PERF_PREFETCH_STREAM_CONFIDENCE_DEFAULT 2
+#define UVM_PERF_PREFETCH_STREAM_CONFIDENCE_MAX     15
+
+// Number of faults that need to match the stride of a stream before it starts
+// predicting accesses
+//
+// Valid values 1-15
+static unsigned uvm_perf_prefetch_stream_confidence = UVM_PERF_PREFETCH_STREAM_CONFIDENCE_DEFAULT;
+
+#define UVM_PERF_PREFETCH_STREAM_DISTANCE_DEFAULT 32
+#define UVM_PERF_PREFETCH_STREAM_DISTANCE_MAX     512
+
+// Prefetch distance, in units of UVM_PERF_PREFETCH_STREAM_GRANULARITY. The
+// default value prefetches one VA block ahead of a sequential stream.
+//
+// Valid values 1-512
+static unsigned uvm_perf_prefetch_stream_distance = UVM_PERF_PREFETCH_STREAM_DISTANCE_DEFAULT;
+
+module_param(uvm_perf_prefetch_stream_enable, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_confidence, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_distance, uint, S_IRUGO);
+
+static bool g_uvm_perf_prefetch_stream_enable;
+static unsigned g_uvm_perf_prefetch_stream_confidence;
+static unsigned g_uvm_perf_prefetch_stream_distance;
+
+// Faults further apart than this from every stream start a new stream
+#define UVM_PERF_PREFETCH_STREAM_MAX_STRIDE (64ULL * 1024 * 1024)
+
+// Faults within this distance of the last fault of a stream are considered
+// sequential even if there are skipped granules in between, since pages that
+// were already resident or prefetched do not fault.
+#define UVM_PERF_PREFETCH_STREAM_SEQUENTIAL_GAP (4 * UVM_PERF_PREFETCH_STREAM_GRANULARITY)
+
+// Per-VA space stream table. The table is trained from fault events, which
+// can be notified concurrently from several fault servicing threads holding
+// the VA space lock in read mode, so it is protected by a spinlock.
+typedef struct
+{
+    uvm_spinlock_t lock;
+
+    uvm_perf_prefetch_stream_table_t table;
+} va_space_prefetch_stream_info_t;
+
+// Performance heuristics module for stream prefetching
+static uvm_perf_module_t g_module_prefetch_stream;
+
+static void prefetch_stream_fault_cb(uvm_va_space_t *va_space,
+                                     uvm_perf_event_t event_id,
+                                     uvm_perf_event_data_t *event_data);
+static void prefetch_stream_range_destroy_cb(uvm_va_space_t *va_space,
+                                             uvm_perf_event_t event_id,
+                                             uvm_perf_event_data_t *event_data);
+
+static uvm_perf_module_event_callback_desc_t g_callbacks_prefetch_stream[] = {
+    { UVM_PERF_EVENT_FAULT, prefetch_stream_fault_cb },
+    { UVM_PERF_EVENT_RANGE_DESTROY, prefetch_stream_range_destroy_cb },
+};
+
+static NvU64 abs_delta(NvS64 delta)
+{
+    return delta < 0 ? -(NvU64)delta : (NvU64)delta;
+}
+
+static bool stream_is_sequential(const uvm_perf_prefetch_stream_t *stream)
+{
+    return abs_delta(stream->stride) == UVM_PERF_PREFETCH_STREAM_GRANULARITY;
+}
+
+static void stream_reset_issued(uvm_perf_prefetch_stream_t *stream)
+{
+    stream->issued_start = ~0ULL;
+    stream->issued_end = 0;
+}
+
+static bool stream_has_issued(const uvm_perf_prefetch_stream_t *stream)
+{
+    return stream->issued_start <= stream->issued_end;
+}
+
+static void stream_init(uvm_perf_prefetch_stream_t *stream, uvm_processor_id_t processor, NvU64 address, NvU64 clock)
+{
+    memset(stream, 0, sizeof(*stream));
+
+    stream->processor = processor;
+    stream->last_address = address;
+    stream->lru_stamp = clock;
+    stream_reset_issued(stream);
+}
+
+// Number of strides predicted ahead of a strided stream
+static NvU32 stream_depth(const uvm_perf_prefetch_stream_table_t *table, const uvm_perf_prefetch_stream_t *stream)
+{
+    NvU64 depth = table->params.distance / abs_delta(stream->stride);
+
+    return (NvU32)clamp(depth, 1ULL, (NvU64)UVM_PERF_PREFETCH_STREAM_MAX_DEPTH);
+}
+
+// Check whether a fault at the given distance from the last fault of the
+// stream continues it. Faults on granules predicted by the stream do not
+// happen once the prefetches complete, so the next observed fault of a
+// confident stream is expected right after the prefetched windows.
+static bool stream_matches(const uvm_perf_prefetch_stream_table_t *table,
+                           const uvm_perf_prefetch_stream_t *stream,
+                           NvS64 delta)
+{
+    NvU64 distance = abs_delta(delta);
+    NvU64 stride = abs_delta(stream->stride);
+
+    if (stride == 0 || delta == 0)
+        return false;
+
+    if ((delta > 0) != (stream->stride > 0))
+        return false;
+
+    if (stream_is_sequential(stream))
+        return distance <= table->params.distance + UVM_PERF_PREFETCH_STREAM_SEQUENTIAL_GAP;
+
+    if (distance % stride != 0)
+        return false;
+
+    return distance / stride <= stream_depth(table, stream) + 1;
+}
+
+void uvm_perf_prefetch_stream_table_init(uvm_perf_prefetch_stream_table_t *table)
+{
+    size_t i;
+
+    memset(table, 0, sizeof(*table));
+
+    for (i = 0; i < ARRAY_SIZE(table->streams); ++i)
+        table->streams[i].processor = UVM_ID_INVALID;
+
+    table->params.confidence_threshold = g_uvm_perf_prefetch_stream_confidence;
+    table->params.distance = (NvU64)g_uvm_perf_prefetch_stream_distance * UVM_PERF_PREFETCH_STREAM_GRANULARITY;
+    table->params.max_stride = UVM_PERF_PREFETCH_STREAM_MAX_STRIDE;
+}
+
+uvm_perf_prefetch_stream_t *uvm_perf_prefetch_stream_train(uvm_perf_prefetch_stream_table_t *table,
+                                                           uvm_processor_id_t processor,
+                                                           NvU64 address)
+{
+    uvm_perf_prefetch_stream_t *candidate = NULL;
+    uvm_perf_prefetch_stream_t *victim = NULL;
+    NvU64 candidate_distance = 0;
+    NvS64 delta;
+    size_t i;
+
+    UVM_ASSERT(UVM_ID_IS_VALID(processor));
+
+    address = UVM_ALIGN_DOWN(address, UVM_PERF_PREFETCH_STREAM_GRANULARITY);
+
+    ++table->clock;
+
+    for (i = 0; i < ARRAY_SIZE(table->streams); ++i) {
+        uvm_perf_prefetch_stream_t *stream = &table->streams[i];
+
+        // Replace free entries first, then the least-recently used one
+        if (!UVM_ID_IS_VALID(stream->processor)) {
+            if (!victim || UVM_ID_IS_VALID(victim->processor))
+                victim = stream;
+
+            continue;
+        }
+
+        if (!victim || (UVM_ID_IS_VALID(victim->processor) && stream->lru_stamp < victim->lru_stamp))
+            victim = stream;
+
+        if (!uvm_id_equal(stream->processor, processor))
+            continue;
+
+        delta = address - stream->last_address;
+
+        // Several faults on the same granule are a single training event
+        if (delta == 0) {
+            stream->lru_stamp = table->clock;
+            return stream;
+        }
+
+        if (stream_matches(table, stream, delta)) {
+            UVM_PERF_SATURATING_INC(stream->confidence);
+            stream->last_address = address;
+            stream->lru_stamp = table->clock;
+            return stream;
+        }
+
+        // Confident streams are not retrained by unrelated faults. They age
+        // out through LRU replacement if they stop being used.
+        if (stream->confidence >= table->params.confidence_threshold)
+            continue;
+
+        if (abs_delta(delta) <= table->params.max_stride &&
+            (!candidate || abs_delta(delta) < candidate_distance)) {
+            candidate = stream;
+            candidate_distance = abs_delta(delta);
+        }
+    }
+
+    if (candidate) {
+        delta = address - candidate->last_address;
+
+        // Small gaps are folded into a sequential stride
+        if (abs_delta(delta) <= UVM_PERF_PREFETCH_STREAM_SEQUENTIAL_GAP)
+            candidate->stride = delta > 0 ? UVM_PERF_PREFETCH_STREAM_GRANULARITY : -UVM_PERF_PREFETCH_STREAM_GRANULARITY;
+        else
+            candidate->stride = delta;
+
+        candidate->confidence = 1;
+        candidate->last_address = address;
+        candidate->lru_stamp = table->clock;
+        stream_reset_issued(candidate);
+
+        return candidate;
+    }
+
+    UVM_ASSERT(victim);
+
+    stream_init(victim, processor, address, table->clock);
+
+    return victim;
+}
+
+NvU32 uvm_perf_prefetch_stream_predict(const uvm_perf_prefetch_stream_table_t *table,
+                                       const uvm_perf_prefetch_stream_t *stream,
+                                       uvm_perf_prefetch_stream_window_t *out_windows)
+{
+    const NvU64 granularity = UVM_PERF_PREFETCH_STREAM_GRANULARITY;
+    NvU64 stride;
+    NvU32 depth;
+    NvU32 i;
+
+    if (!UVM_ID_IS_VALID(stream->processor) ||
+        stream->stride == 0 ||
+        stream->confidence < table->params.confidence_threshold) {
+        return 0;
+    }
+
+    if (stream_is_sequential(stream)) {
+        if (stream->stride > 0) {
+            out_windows[0].start = stream->last_address + granularity;
+            out_windows[0].end = out_windows[0].start + table->params.distance - 1;
+
+            // Overflow
+            if (out_windows[0].start < stream->last_address || out_windows[0].end < out_windows[0].start)
+                return 0;
+        }
+        else {
+            if (stream->last_address == 0)
+                return 0;
+
+            out_windows[0].end = stream->last_address - 1;
+            out_windows[0].start = stream->last_address > table->params.distance ?
+                                   stream->last_address - table->params.distance :
+                                   0;
+        }
+
+        return 1;
+    }
+
+    stride = abs_delta(stream->stride);
+    depth = stream_depth(table, stream);
+
+    for (i = 0; i < depth; ++i) {
+        NvU64 offset = stride * (i + 1);
+        NvU64 target;
+
+        if (stream->stride > 0) {
+            target = stream->last_address + offset;
+            if (target < stream->last_address || target + granularity - 1 < target)
+                break;
+        }
+        else {
+            if (stream->last_address < offset)
+                break;
+
+            target = stream->last_address - offset;
+        }
+
+        out_windows[i].start = target;
+        out_windows[i].end = target + granularity - 1;
+    }
+
+    return i;
+}
+
+NvU32 uvm_perf_prefetch_stream_next_windows(const uvm_perf_prefetch_stream_table_t *table,
+                                            uvm_perf_prefetch_stream_t *stream,
+                                            uvm_perf_prefetch_stream_window_t *out_windows)
+{
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    NvU64 span_start;
+    NvU64 span_end;
+    NvU32 count;
+    NvU32 num_windows = 0;
+    NvU32 i;
+
+    count = uvm_perf_prefetch_stream_predict(table, stream, windows);
+    if (count == 0)
+        return 0;
+
+    span_start = min(windows[0].start, windows[count - 1].start);
+    span_end = max(windows[0].end, windows[count - 1].end);
+
+    for (i = 0; i < count; ++i) {
+        uvm_perf_prefetch_stream_window_t window = windows[i];
+
+        if (stream_has_issued(stream)) {
+            // Fully issued
+            if (window.start >= stream->issued_start && window.end <= stream->issued_end)
+                continue;
+
+            // Trim the portion that overlaps the issued span
+            if (window.start >= stream->issued_start && window.start <= stream->issued_end)
+                window.start = stream->issued_end + 1;
+            else if (window.end >= stream->issued_start && window.end <= stream->issued_end)
+                window.end = stream->issued_start - 1;
+        }
+
+        out_windows[num_windows++] = window;
+    }
+
+    // Extend the issued span if the new windows are contiguous with it, or
+    // start over if the stream moved elsewhere.
+    if (stream_has_issued(stream) &&
+        span_start <= stream->issued_end + 1 &&
+        span_end + 1 >= stream->issued_start) {
+        stream->issued_start = min(stream->issued_start, span_start);
+        stream->issued_end = max(stream->issued_end, span_end);
+    }
+    else {
+        stream->issued_start = span_start;
+        stream->issued_end = span_end;
+    }
+
+    return num_windows;
+}
+
+// Get the stream prefetching struct for the given VA space if it exists
+//
+// The caller must ensure that the va_space cannot be deleted, for the
+// duration of this call. Holding either the va_block or va_space lock will do
+// that.
+static va_space_prefetch_stream_info_t *va_space_prefetch_stream_info_get_or_null(uvm_va_space_t *va_space)
+{
+    return uvm_perf_module_type_data(va_space->perf_modules_data, UVM_PERF_MODULE_TYPE_PREFETCH_STREAM);
+}
+
+// Whether the stream was last trained by a fault within [start, end]
+static bool stream_in_range(const uvm_perf_prefetch_stream_t *stream, NvU64 start, NvU64 end)
+{
+    return UVM_ID_IS_VALID(stream->processor) &&
+           stream->last_address + UVM_PERF_PREFETCH_STREAM_GRANULARITY - 1 >= start &&
+           stream->last_address <= end;
+}
+
+static void prefetch_stream_fault_cb(uvm_va_space_t *va_space,
+                                     uvm_perf_event_t event_id,
+                                     uvm_perf_event_data_t *event_data)
+{
+    va_space_prefetch_stream_info_t *info = va_space_prefetch_stream_info_get_or_null(va_space);
+    uvm_processor_id_t proc_id = event_data->fault.proc_id;
+    NvU64 address;
+
+    UVM_ASSERT(g_uvm_perf_prefetch_stream_enable);
+    UVM_ASSERT(event_id == UVM_PERF_EVENT_FAULT);
+
+    // Faults without a block are fatal, so they do not belong to any stream
+    if (!info || !event_data->fault.block)
+        return;
+
+    if (UVM_ID_IS_CPU(proc_id)) {
+        address = event_data->fault.cpu.fault_va;
+    }
+    else {
+        uvm_fault_buffer_entry_t *buffer_entry = event_data->fault.gpu.buffer_entry;
+
+        // Duplicates carry no new information and HW prefetch faults are
+        // speculative, so none of them train the table.
+        if (event_data->fault.gpu.is_duplicate || buffer_entry->fault_access_type == UVM_FAULT_ACCESS_TYPE_PREFETCH)
+            return;
+
+        address = buffer_entry->fault_address;
+    }
+
+    uvm_spin_lock(&info->lock);
+    uvm_perf_prefetch_stream_train(&info->table, proc_id, address);
+    uvm_spin_unlock(&info->lock);
+}
+
+static void prefetch_stream_range_destroy_cb(uvm_va_space_t *va_space,
+                                             uvm_perf_event_t event_id,
+                                             uvm_perf_event_data_t *event_data)
+{
+    va_space_prefetch_stream_info_t *info = va_space_prefetch_stream_info_get_or_null(va_space);
+    uvm_va_range_t *va_range = event_data->range_destroy.range;
+    size_t i;
+
+    UVM_ASSERT(g_uvm_perf_prefetch_stream_enable);
+    UVM_ASSERT(event_id == UVM_PERF_EVENT_RANGE_DESTROY);
+
+    if (!info)
+        return;
+
+    // Drop the streams that are walking the destroyed range so that their
+    // entries can be reused right away
+    uvm_spin_lock(&info->lock);
+
+    for (i = 0; i < ARRAY_SIZE(info->table.streams); ++i) {
+        uvm_perf_prefetch_stream_t *stream = &info->table.streams[i];
+
+        if (stream_in_range(stream, va_range->node.start, va_range->node.end))
+            stream->processor = UVM_ID_INVALID;
+    }
+
+    uvm_spin_unlock(&info->lock);
+}
+
+bool uvm_perf_prefetch_stream_get_block_mask(uvm_va_block_t *va_block,
+                                             uvm_processor_id_t new_residency,
+                                             uvm_va_block_region_t max_prefetch_region,
+                                             uvm_page_mask_t *prefetch_mask)
+{
+    uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    va_space_prefetch_stream_info_t *info = va_space_prefetch_stream_info_get_or_null(va_space);
+    NvU64 region_start = uvm_va_block_region_start(va_block, max_prefetch_region);
+    NvU64 region_end = uvm_va_block_region_end(va_block, max_prefetch_region);
+    bool added = false;
+    size_t i;
+
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    if (!info || max_prefetch_region.outer == max_prefetch_region.first)
+        return false;
+
+    uvm_spin_lock(&info->lock);
+
+    for (i = 0; i < ARRAY_SIZE(info->table.streams); ++i) {
+        uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+        const uvm_perf_prefetch_stream_t *stream = &info->table.streams[i];
+        NvU32 count;
+        NvU32 j;
+
+        if (!uvm_id_equal(stream->processor, new_residency) ||
+            !stream_in_range(stream, va_block->start, va_block->end)) {
+            continue;
+        }
+
+        count = uvm_perf_prefetch_stream_predict(&info->table, stream, windows);
+        for (j = 0; j < count; ++j) {
+            NvU64 start = max(windows[j].start, region_start);
+            NvU64 end = min(windows[j].end, region_end);
+
+            if (start > end)
+                continue;
+
+            uvm_page_mask_region_fill(prefetch_mask, uvm_va_block_region_from_start_end(va_block, start, end));
+            added = true;
+        }
+    }
+
+    uvm_spin_unlock(&info->lock);
+
+    return added;
+}
+
+static NV_STATUS prefetch_stream_migrate_block_locked(uvm_va_block_t *va_block,
+                                                      uvm_va_block_retry_t *va_block_retry,
+                                                      uvm_gpu_t *gpu,
+                                                      uvm_va_block_region_t region,
+                                                      uvm_service_block_context_t *service_context,
+                                                      uvm_tracker_t *out_tracker)
+{
+    const uvm_page_mask_t *thrashing_pages;
+
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    // The block may have been destroyed while it was unlocked
+    if (uvm_va_block_is_dead(va_block))
+        return NV_OK;
+
+    // Never prefetch pages that are thrashing, like the bitmap tree prefetcher
+    thrashing_pages = uvm_perf_thrashing_get_thrashing_pages(va_block);
+    if (thrashing_pages && !uvm_page_mask_region_empty(thrashing_pages, region))
+        return NV_OK;
+
+    if (uvm_va_block_gpu_state_get(va_block, gpu->id)) {
+        const uvm_page_mask_t *resident_mask = uvm_va_block_resident_mask_get(va_block, gpu->id, NUMA_NO_NODE);
+
+        if (uvm_page_mask_region_full(resident_mask, region))
+            return NV_OK;
+    }
+
+    return uvm_va_block_migrate_locked(va_block,
+                                       va_block_retry,
+                                       service_context,
+                                       region,
+                                       gpu->id,
+                                       UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                       UVM_MAKE_RESIDENT_CAUSE_PREFETCH,
+                                       out_tracker);
+}
+
+static NV_STATUS prefetch_stream_migrate_window(uvm_va_range_managed_t *managed_range,
+                                                uvm_va_block_t *faulting_block,
+                                                uvm_gpu_t *gpu,
+                                                NvU64 start,
+                                                NvU64 end,
+                                                uvm_service_block_context_t *service_context,
+                                                uvm_tracker_t *out_tracker)
+{
+    uvm_va_space_t *va_space = managed_range->va_range.va_space;
+    const uvm_va_policy_t *policy = &managed_range->policy;
+    size_t first_index;
+    size_t last_index;
+    size_t i;
+
+    start = max(start, managed_range->va_range.node.start);
+    end = min(end, managed_range->va_range.node.end);
+    if (start > end)
+        return NV_OK;
+
+    // Do not prefetch pages out of the preferred location
+    if (UVM_ID_IS_VALID(policy->preferred_location) && !uvm_id_equal(policy->preferred_location, gpu->id))
+        return NV_OK;
+
+    first_index = uvm_va_range_block_index(managed_range, start);
+    last_index = uvm_va_range_block_index(managed_range, end);
+
+    for (i = first_index; i <= last_index; ++i) {
+        uvm_va_block_retry_t va_block_retry;
+        uvm_va_block_region_t region;
+        uvm_va_block_t *va_block;
+        NvU64 block_start;
+        NvU64 block_end;
+        NV_STATUS status;
+
+        status = uvm_va_range_block_create(managed_range, i, &va_block);
+        if (status != NV_OK)
+            return status;
+
+        // The faulting block is covered by the prefetch hint computed while
+        // servicing its faults
+        if (va_block == faulting_block)
+            continue;
+
+        block_start = max(start, va_block->start);
+        block_end = min(end, va_block->end);
+
+        if (!uvm_range_group_all_migratable(va_space, block_start, block_end))
+            continue;
+
+        region = uvm_va_block_region_from_start_end(va_block, block_start, block_end);
+
+        status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                         &va_block_retry,
+                                         prefetch_stream_migrate_block_locked(va_block,
+                                                                              &va_block_retry,
+                                                                              gpu,
+                                                                              region,
+                                                                              service_context,
+                                                                              out_tracker));
+        if (status != NV_OK)
+            return status;
+    }
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_perf_prefetch_stream_service_ahead(uvm_va_block_t *va_block,
+                                                 uvm_gpu_t *gpu,
+                                                 uvm_service_block_context_t *service_context,
+                                                 uvm_tracker_t *out_tracker)
+{
+    uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    va_space_prefetch_stream_info_t *info = va_space_prefetch_stream_info_get_or_null(va_space);
+    uvm_va_range_managed_t *managed_range;
+    NvU64 block_start;
+    NvU64 block_end;
+    size_t i;
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    // Only managed allocations are prefetched ahead of the faulting block
+    if (!info || !uvm_perf_prefetch_enabled(va_space) || uvm_va_block_is_hmm(va_block))
+        return NV_OK;
+
+    uvm_mutex_lock(&va_block->lock);
+    managed_range = uvm_va_block_is_dead(va_block) ? NULL : va_block->managed_range;
+    block_start = va_block->start;
+    block_end = va_block->end;
+    uvm_mutex_unlock(&va_block->lock);
+
+    if (!managed_range)
+        return NV_OK;
+
+    for (i = 0; i < ARRAY_SIZE(info->table.streams); ++i) {
+        uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+        NvU32 count = 0;
+        NvU32 j;
+
+        uvm_spin_lock(&info->lock);
+
+        if (uvm_id_equal(info->table.streams[i].processor, gpu->id) &&
+            stream_in_range(&info->table.streams[i], block_start, block_end))
+            count = uvm_perf_prefetch_stream_next_windows(&info->table, &info->table.streams[i], windows);
+
+        uvm_spin_unlock(&info->lock);
+
+        for (j = 0; j < count; ++j) {
+            NV_STATUS status = prefetch_stream_migrate_window(managed_range,
+                                                              va_block,
+                                                              gpu,
+                                                              windows[j].start,
+                                                              windows[j].end,
+                                                              service_context,
+                                                              out_tracker);
+
+            // Prefetching is opportunistic. Only report global errors.
+            if (status != NV_OK)
+                return uvm_global_get_status();
+        }
+    }
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_perf_prefetch_stream_load(uvm_va_space_t *va_space)
+{
+    va_space_prefetch_stream_info_t *info;
+    NV_STATUS status;
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (!g_uvm_perf_prefetch_stream_enable)
+        return NV_OK;
+
+    // Allocate the per-VA space state before registering the module so that
+    // an allocation failure doesn't leave the event callbacks registered.
+    info = uvm_kvmalloc_zero(sizeof(*info));
+    if (!info)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_spin_lock_init(&info->lock, UVM_LOCK_ORDER_LEAF);
+    uvm_perf_prefetch_stream_table_init(&info->table);
+
+    status = uvm_perf_module_load(&g_module_prefetch_stream, va_space);
+    if (status != NV_OK) {
+        uvm_kvfree(info);
+        return status;
+    }
+
+    uvm_perf_module_type_set_data(va_space->perf_modules_data, info, UVM_PERF_MODULE_TYPE_PREFETCH_STREAM);
+
+    return NV_OK;
+}
+
+void uvm_perf_prefetch_stream_unload(uvm_va_space_t *va_space)
+{
+    va_space_prefetch_stream_info_t *info = va_space_prefetch_stream_info_get_or_null(va_space);
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (!g_uvm_perf_prefetch_stream_enable)
+        return;
+
+    uvm_perf_module_unload(&g_module_prefetch_stream, va_space);
+
+    if (info) {
+        uvm_perf_module_type_unset_data(va_space->perf_modules_data, UVM_PERF_MODULE_TYPE_PREFETCH_STREAM);
+        uvm_kvfree(info);
+    }
+}
+
+NV_STATUS uvm_perf_prefetch_stream_init(void)
+{
+    g_uvm_perf_prefetch_stream_enable = uvm_perf_prefetch_stream_enable != 0;
+
+    if (uvm_perf_prefetch_stream_confidence >= 1 &&
+        uvm_perf_prefetch_stream_confidence <= UVM_PERF_PREFETCH_STREAM_CONFIDENCE_MAX) {
+        g_uvm_perf_prefetch_stream_confidence = uvm_perf_prefetch_stream_confidence;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_prefetch_stream_confidence. Using %u instead\n",
+                       uvm_perf_prefetch_stream_confidence,
+                       UVM_PERF_PREFETCH_STREAM_CONFIDENCE_DEFAULT);
+
+        g_uvm_perf_prefetch_stream_confidence = UVM_PERF_PREFETCH_STREAM_CONFIDENCE_DEFAULT;
+    }
+
+    if (uvm_perf_prefetch_stream_distance >= 1 &&
+        uvm_perf_prefetch_stream_distance <= UVM_PERF_PREFETCH_STREAM_DISTANCE_MAX) {
+        g_uvm_perf_prefetch_stream_distance = uvm_perf_prefetch_stream_distance;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_prefetch_stream_distance. Using %u instead\n",
+                       uvm_perf_prefetch_stream_distance,
+                       UVM_PERF_PREFETCH_STREAM_DISTANCE_DEFAULT);
+
+        g_uvm_perf_prefetch_stream_distance = UVM_PERF_PREFETCH_STREAM_DISTANCE_DEFAULT;
+    }
+
+    if (g_uvm_perf_prefetch_stream_enable) {
+        uvm_perf_module_init("perf_prefetch_stream",
+                             UVM_PERF_MODULE_TYPE_PREFETCH_STREAM,
+                             g_callbacks_prefetch_stream,
+                             ARRAY_SIZE(g_callbacks_prefetch_stream),
+                             &g_module_prefetch_stream);
+    }
+
+    return NV_OK;
+}
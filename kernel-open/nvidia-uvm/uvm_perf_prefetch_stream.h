@@ -0,0 +1,179 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#ifndef __UVM_PERF_PREFETCH_STREAM_H__
+#define __UVM_PERF_PREFETCH_STREAM_H__
+
+#include "uvm_linux.h"
+#include "uvm_forward_decl.h"
+#include "uvm_processors.h"
+#include "uvm_tracker.h"
+#include "uvm_va_block_types.h"
+
+// Stream prefetching complements the bitmap tree prefetcher in
+// uvm_perf_prefetch.c. The bitmap tree only looks at the density of faults
+// within a single VA block, so accesses that walk memory with a fixed stride
+// or that stream sequentially across many blocks still take at least one fault
+// per block. The stream prefetcher keeps a small per-VA space table of access
+// streams, trained by fault events, which learns the distance between
+// consecutive faults of a processor. Once a stream is confident, it predicts
+// the address windows that will be accessed next. Those windows are merged
+// into the prefetch hint of the faulting block, and the windows that fall in
+// VA blocks ahead of the faulting one are migrated from the replayable fault
+// servicing path.
+//
+// All addresses tracked by the predictor are aligned to
+// UVM_PERF_PREFETCH_STREAM_GRANULARITY, so that multiple faults within the same
+// big page collapse into a single training event.
+
+#define UVM_PERF_PREFETCH_STREAM_GRANULARITY UVM_PAGE_SIZE_64K
+
+// Number of streams tracked per VA space
+#define UVM_PERF_PREFETCH_STREAM_TABLE_SIZE 16
+
+// Maximum number of strides predicted ahead of a strided stream
+#define UVM_PERF_PREFETCH_STREAM_MAX_DEPTH 4
+
+// Address window predicted by a stream. Both ends are inclusive.
+typedef struct
+{
+    NvU64 start;
+    NvU64 end;
+} uvm_perf_prefetch_stream_window_t;
+
+typedef struct
+{
+    // Granularity-aligned address of the last fault that trained the stream
+    NvU64 last_address;
+
+    // Signed distance in bytes between trained faults. A stride of
+    // +/-UVM_PERF_PREFETCH_STREAM_GRANULARITY denotes a sequential stream. 0
+    // means that the stream has only been trained once.
+    NvS64 stride;
+
+    // Bounds of the last window handed out by
+    // uvm_perf_prefetch_stream_next_windows, used to avoid issuing the same
+    // prefetch more than once.
+    NvU64 issued_start;
+    NvU64 issued_end;
+
+    // Value of the table clock when the stream was last trained. Used to pick
+    // the least-recently used stream for replacement.
+    NvU64 lru_stamp;
+
+    // Processor whose faults train the stream. UVM_ID_INVALID if the entry is
+    // not in use.
+    uvm_processor_id_t processor;
+
+    // Number of consecutive faults that matched the stride of the stream
+    NvU8 confidence;
+} uvm_perf_prefetch_stream_t;
+
+typedef struct
+{
+    uvm_perf_prefetch_stream_t streams[UVM_PERF_PREFETCH_STREAM_TABLE_SIZE];
+
+    // Incremented on every training event
+    NvU64 clock;
+
+    // Snapshot of the tunables, so that the predictor can be driven with
+    // different parameters from tests.
+    struct
+    {
+        // Minimum confidence required to predict accesses
+        NvU8 confidence_threshold;
+
+        // Number of bytes prefetched ahead of a sequential stream. Also used
+        // to compute the number of strides prefetched ahead of a strided
+        // stream.
+        NvU64 distance;
+
+        // Maximum stride that can be learned. Faults further apart than this
+        // from any stream start a new stream.
+        NvU64 max_stride;
+    } params;
+} uvm_perf_prefetch_stream_table_t;
+
+// Global initialization function (no clean up needed).
+NV_STATUS uvm_perf_prefetch_stream_init(void);
+
+// Per-VA space initialization/cleanup, called from the perf heuristics
+// load/unload functions.
+//
+// Locking: the VA space lock must be held in write mode.
+NV_STATUS uvm_perf_prefetch_stream_load(uvm_va_space_t *va_space);
+void uvm_perf_prefetch_stream_unload(uvm_va_space_t *va_space);
+
+// Initialize the given table with the global tunables.
+void uvm_perf_prefetch_stream_table_init(uvm_perf_prefetch_stream_table_t *table);
+
+// Train the table with a fault from the given processor on the given address.
+// Returns the stream that was trained, which is either an existing stream
+// whose stride matches the fault, or a newly-allocated one.
+//
+// The table is a pure data structure: callers are in charge of serialization.
+uvm_perf_prefetch_stream_t *uvm_perf_prefetch_stream_train(uvm_perf_prefetch_stream_table_t *table,
+                                                           uvm_processor_id_t processor,
+                                                           NvU64 address);
+
+// Compute the windows predicted by the given stream. Returns the number of
+// windows written to out_windows, which must have room for
+// UVM_PERF_PREFETCH_STREAM_MAX_DEPTH entries. Returns 0 if the stream is not
+// confident enough.
+NvU32 uvm_perf_prefetch_stream_predict(const uvm_perf_prefetch_stream_table_t *table,
+                                       const uvm_perf_prefetch_stream_t *stream,
+                                       uvm_perf_prefetch_stream_window_t *out_windows);
+
+// Same as uvm_perf_prefetch_stream_predict, but windows (or portions of them)
+// already returned by a previous call for this stream are skipped. The issued
+// bounds of the stream are updated.
+NvU32 uvm_perf_prefetch_stream_next_windows(const uvm_perf_prefetch_stream_table_t *table,
+                                            uvm_perf_prefetch_stream_t *stream,
+                                            uvm_perf_prefetch_stream_window_t *out_windows);
+
+// Add to prefetch_mask the pages within max_prefetch_region of the given block
+// that are predicted to be accessed by new_residency. Returns true if any page
+// was added.
+//
+// Locking: the caller must hold the VA space lock and the VA block lock.
+bool uvm_perf_prefetch_stream_get_block_mask(uvm_va_block_t *va_block,
+                                             uvm_processor_id_t new_residency,
+                                             uvm_va_block_region_t max_prefetch_region,
+                                             uvm_page_mask_t *prefetch_mask);
+
+// Migrate to the given GPU the predicted windows of the streams trained by
+// the given block that fall in VA blocks of the same managed VA range ahead
+// of it. Prefetching is opportunistic, so errors are only returned if they
+// are global fatal errors.
+//
+// service_context is reused to perform the migrations, so it must not be in
+// use by the caller.
+//
+// Locking: the caller must hold the VA space lock in at least read mode, and
+// must not hold any VA block lock.
+NV_STATUS uvm_perf_prefetch_stream_service_ahead(uvm_va_block_t *va_block,
+                                                 uvm_gpu_t *gpu,
+                                                 uvm_service_block_context_t *service_context,
+                                                 uvm_tracker_t *out_tracker);
+
+#endif
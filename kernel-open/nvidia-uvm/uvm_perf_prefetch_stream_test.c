@@ -0,0 +1,500 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "linux/sort.h"
+#include "uvm_common.h"
+#include "uvm_kvmalloc.h"
+#include "uvm_perf_prefetch_stream.h"
+#include "uvm_test.h"
+#include "uvm_test_rng.h"
+
+#define GRANULE UVM_PERF_PREFETCH_STREAM_GRANULARITY
+
+static void table_init_for_test(uvm_perf_prefetch_stream_table_t *table, NvU8 confidence, NvU64 distance)
+{
+    uvm_perf_prefetch_stream_table_init(table);
+
+    table->params.confidence_threshold = confidence;
+    table->params.distance = distance;
+}
+
+// Train the table with count faults starting at base and separated by stride,
+// and return the stream trained by the last one
+static uvm_perf_prefetch_stream_t *train_pattern(uvm_perf_prefetch_stream_table_t *table,
+                                                 uvm_processor_id_t processor,
+                                                 NvU64 base,
+                                                 NvS64 stride,
+                                                 NvU32 count)
+{
+    uvm_perf_prefetch_stream_t *stream = NULL;
+    NvU32 i;
+
+    for (i = 0; i < count; ++i)
+        stream = uvm_perf_prefetch_stream_train(table, processor, base + i * stride);
+
+    return stream;
+}
+
+static NV_STATUS test_sequential(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_perf_prefetch_stream_t *stream;
+    const NvU64 base = 1ULL << 32;
+
+    table_init_for_test(&table, 2, 8 * GRANULE);
+
+    // A single fault does not predict anything
+    stream = train_pattern(&table, UVM_ID_CPU, base, GRANULE, 1);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 0);
+
+    // Neither does a stream below the confidence threshold
+    stream = train_pattern(&table, UVM_ID_CPU, base + GRANULE, GRANULE, 1);
+    TEST_CHECK_RET(stream->stride == GRANULE);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 0);
+
+    stream = train_pattern(&table, UVM_ID_CPU, base + 2 * GRANULE, GRANULE, 1);
+    TEST_CHECK_RET(stream->confidence == 2);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 1);
+    TEST_CHECK_RET(windows[0].start == base + 3 * GRANULE);
+    TEST_CHECK_RET(windows[0].end == base + 11 * GRANULE - 1);
+
+    // Offsets within a granule do not affect training
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 2 * GRANULE + PAGE_SIZE);
+    TEST_CHECK_RET(stream->confidence == 2);
+    TEST_CHECK_RET(stream->last_address == base + 2 * GRANULE);
+
+    // Faults right after the prefetched window keep the stream going
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 11 * GRANULE);
+    TEST_CHECK_RET(stream->confidence == 3);
+    TEST_CHECK_RET(stream->stride == GRANULE);
+
+    // Small gaps are folded into the sequential stride
+    table_init_for_test(&table, 2, 8 * GRANULE);
+    stream = train_pattern(&table, UVM_ID_CPU, base, 2 * GRANULE, 3);
+    TEST_CHECK_RET(stream->stride == GRANULE);
+    TEST_CHECK_RET(stream->confidence == 2);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_descending(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_perf_prefetch_stream_t *stream;
+    const NvU64 base = 1ULL << 32;
+
+    table_init_for_test(&table, 2, 8 * GRANULE);
+
+    stream = train_pattern(&table, UVM_ID_CPU, base, -(NvS64)GRANULE, 3);
+    TEST_CHECK_RET(stream->stride == -(NvS64)GRANULE);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 1);
+    TEST_CHECK_RET(windows[0].end == base - 2 * GRANULE - 1);
+    TEST_CHECK_RET(windows[0].start == base - 10 * GRANULE);
+
+    // Windows are clamped at address 0
+    table_init_for_test(&table, 2, 8 * GRANULE);
+    stream = train_pattern(&table, UVM_ID_CPU, 4 * GRANULE, -(NvS64)GRANULE, 3);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 1);
+    TEST_CHECK_RET(windows[0].start == 0);
+    TEST_CHECK_RET(windows[0].end == 2 * GRANULE - 1);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_strided(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_perf_prefetch_stream_t *stream;
+    const NvU64 base = 1ULL << 32;
+    const NvS64 stride = 16 * GRANULE;
+    NvU32 count;
+    NvU32 i;
+
+    table_init_for_test(&table, 2, 32 * GRANULE);
+
+    stream = train_pattern(&table, UVM_ID_CPU, base, stride, 3);
+    TEST_CHECK_RET(stream->stride == stride);
+    TEST_CHECK_RET(stream->confidence == 2);
+
+    // distance / stride windows of one granule each
+    count = uvm_perf_prefetch_stream_predict(&table, stream, windows);
+    TEST_CHECK_RET(count == 2);
+    for (i = 0; i < count; ++i) {
+        TEST_CHECK_RET(windows[i].start == base + (i + 3) * stride);
+        TEST_CHECK_RET(windows[i].end == windows[i].start + GRANULE - 1);
+    }
+
+    // The next fault after the predicted strides continues the stream
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 5 * stride);
+    TEST_CHECK_RET(stream->confidence == 3);
+    TEST_CHECK_RET(stream->last_address == base + 5 * stride);
+
+    // But a fault that is not a multiple of the stride does not
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 5 * stride + 3 * GRANULE);
+    TEST_CHECK_RET(stream->confidence == 0);
+    TEST_CHECK_RET(stream->stride == 0);
+
+    // Large strides are capped at UVM_PERF_PREFETCH_STREAM_MAX_DEPTH windows
+    // but always predict at least one
+    table_init_for_test(&table, 2, 512 * GRANULE);
+    stream = train_pattern(&table, UVM_ID_CPU, base, 8 * GRANULE, 3);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == UVM_PERF_PREFETCH_STREAM_MAX_DEPTH);
+
+    table_init_for_test(&table, 2, 2 * GRANULE);
+    stream = train_pattern(&table, UVM_ID_CPU, base, 64 * GRANULE, 3);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 1);
+
+    // Strides above max_stride are never learned
+    table_init_for_test(&table, 2, 32 * GRANULE);
+    stream = train_pattern(&table, UVM_ID_CPU, base, table.params.max_stride + GRANULE, 4);
+    TEST_CHECK_RET(stream->stride == 0);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_interleaved(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_perf_prefetch_stream_t *stream_a = NULL;
+    uvm_perf_prefetch_stream_t *stream_b = NULL;
+    uvm_perf_prefetch_stream_t *stream_gpu = NULL;
+    const NvU64 base_a = 1ULL << 32;
+    const NvU64 base_b = 1ULL << 40;
+    uvm_processor_id_t gpu_id = uvm_gpu_id_from_index(0);
+    NvU32 i;
+
+    table_init_for_test(&table, 2, 8 * GRANULE);
+
+    // Two ascending streams and a GPU stream over the same addresses as the
+    // first one are tracked independently
+    for (i = 0; i < 4; ++i) {
+        stream_a = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base_a + i * GRANULE);
+        stream_b = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base_b - i * 8 * GRANULE);
+        stream_gpu = uvm_perf_prefetch_stream_train(&table, gpu_id, base_a + i * 16 * GRANULE);
+    }
+
+    TEST_CHECK_RET(stream_a != stream_b && stream_a != stream_gpu && stream_b != stream_gpu);
+
+    TEST_CHECK_RET(uvm_id_equal(stream_a->processor, UVM_ID_CPU));
+    TEST_CHECK_RET(stream_a->stride == GRANULE);
+    TEST_CHECK_RET(stream_a->confidence == 3);
+
+    TEST_CHECK_RET(stream_b->stride == -8 * (NvS64)GRANULE);
+    TEST_CHECK_RET(stream_b->confidence == 3);
+
+    TEST_CHECK_RET(uvm_id_equal(stream_gpu->processor, gpu_id));
+    TEST_CHECK_RET(stream_gpu->stride == 16 * GRANULE);
+    TEST_CHECK_RET(stream_gpu->confidence == 3);
+
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream_a, windows) == 1);
+    TEST_CHECK_RET(windows[0].start == base_a + 4 * GRANULE);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_random(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_test_rng_t rng;
+    NvU32 i;
+
+    table_init_for_test(&table, 3, 32 * GRANULE);
+    uvm_test_rng_init(&rng, 0);
+
+    // Faults uniformly distributed over a large range rarely line up, so
+    // no stream becomes confident
+    for (i = 0; i < 10000; ++i) {
+        NvU64 address = uvm_test_rng_range_64(&rng, 0, (1ULL << 48) - 1);
+        uvm_perf_prefetch_stream_t *stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, address);
+
+        TEST_CHECK_RET(uvm_perf_prefetch_stream_predict(&table, stream, windows) == 0);
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS test_replacement(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_t *stream;
+    uvm_perf_prefetch_stream_t *first;
+    const NvU64 base = 1ULL << 32;
+    const NvU64 spacing = 1ULL << 30;
+    NvU32 i;
+
+    table_init_for_test(&table, 2, 8 * GRANULE);
+
+    // Fill the table with streams too far apart to be related
+    first = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base);
+    for (i = 1; i < UVM_PERF_PREFETCH_STREAM_TABLE_SIZE; ++i) {
+        stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + i * spacing);
+        TEST_CHECK_RET(stream != first);
+    }
+
+    // Touch the first stream so that it's not the LRU
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base);
+    TEST_CHECK_RET(stream == first);
+
+    // A new stream replaces the LRU one, which was created second
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + UVM_PERF_PREFETCH_STREAM_TABLE_SIZE * spacing);
+    TEST_CHECK_RET(stream != first);
+    TEST_CHECK_RET(stream->last_address == base + UVM_PERF_PREFETCH_STREAM_TABLE_SIZE * spacing);
+
+    for (i = 0; i < ARRAY_SIZE(table.streams); ++i)
+        TEST_CHECK_RET(table.streams[i].last_address != base + spacing);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_next_windows(void)
+{
+    uvm_perf_prefetch_stream_table_t table;
+    uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+    uvm_perf_prefetch_stream_t *stream;
+    uvm_perf_prefetch_stream_t *first;
+    const NvU64 base = 1ULL << 32;
+    const NvU64 distance = 8 * GRANULE;
+
+    table_init_for_test(&table, 2, distance);
+
+    stream = train_pattern(&table, UVM_ID_CPU, base, GRANULE, 3);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_next_windows(&table, stream, windows) == 1);
+    TEST_CHECK_RET(windows[0].start == base + 3 * GRANULE);
+    TEST_CHECK_RET(windows[0].end == base + 3 * GRANULE + distance - 1);
+
+    // Nothing new to issue until the stream advances
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_next_windows(&table, stream, windows) == 0);
+
+    // Only the part of the window not issued yet is returned
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 3 * GRANULE);
+    TEST_CHECK_RET(uvm_perf_prefetch_stream_next_windows(&table, stream, windows) == 1);
+    TEST_CHECK_RET(windows[0].start == base + 3 * GRANULE + distance);
+    TEST_CHECK_RET(windows[0].end == base + 4 * GRANULE + distance - 1);
+
+    // A distant fault does not disturb a confident stream, it starts a new
+    // one with nothing issued
+    first = stream;
+    stream = uvm_perf_prefetch_stream_train(&table, UVM_ID_CPU, base + 3 * GRANULE + 3 * distance);
+    TEST_CHECK_RET(stream != first);
+    TEST_CHECK_RET(stream->confidence == 0);
+    TEST_CHECK_RET(stream->issued_start > stream->issued_end);
+    TEST_CHECK_RET(first->confidence == 3);
+    TEST_CHECK_RET(first->issued_end == base + 4 * GRANULE + distance - 1);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_perf_prefetch_stream_sanity(UVM_TEST_PERF_PREFETCH_STREAM_SANITY_PARAMS *params,
+                                               struct file *filp)
+{
+    TEST_NV_CHECK_RET(test_sequential());
+    TEST_NV_CHECK_RET(test_descending());
+    TEST_NV_CHECK_RET(test_strided());
+    TEST_NV_CHECK_RET(test_interleaved());
+    TEST_NV_CHECK_RET(test_random());
+    TEST_NV_CHECK_RET(test_replacement());
+    TEST_NV_CHECK_RET(test_next_windows());
+
+    return NV_OK;
+}
+
+typedef enum
+{
+    REPLAY_GRANULE_UNTOUCHED = 0,
+    REPLAY_GRANULE_PREDICTED,
+    REPLAY_GRANULE_TOUCHED,
+} replay_granule_state_t;
+
+typedef struct
+{
+    NvU64 address;
+    replay_granule_state_t state;
+} replay_granule_t;
+
+static int replay_granule_cmp(const void *a, const void *b)
+{
+    const replay_granule_t *granule_a = a;
+    const replay_granule_t *granule_b = b;
+
+    if (granule_a->address < granule_b->address)
+        return -1;
+
+    return granule_a->address > granule_b->address;
+}
+
+// Returns the first granule whose address is not lower than the given address
+static size_t replay_granule_lower_bound(const replay_granule_t *granules, size_t count, NvU64 address)
+{
+    size_t first = 0;
+
+    while (count > 0) {
+        size_t half = count / 2;
+
+        if (granules[first + half].address < address) {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+static void replay_issue_windows(replay_granule_t *granules,
+                                 size_t num_granules,
+                                 const uvm_perf_prefetch_stream_window_t *windows,
+                                 NvU32 num_windows,
+                                 UVM_TEST_PERF_PREFETCH_STREAM_REPLAY_PARAMS *params)
+{
+    NvU32 i;
+
+    for (i = 0; i < num_windows; ++i) {
+        NvU64 window_granules = (windows[i].end - windows[i].start + 1) / GRANULE;
+        size_t index = replay_granule_lower_bound(granules, num_granules, windows[i].start);
+
+        // Granules that are resident already are not prefetched again
+        for (; index < num_granules && granules[index].address <= windows[i].end; ++index) {
+            --window_granules;
+
+            if (granules[index].state != REPLAY_GRANULE_UNTOUCHED)
+                continue;
+
+            granules[index].state = REPLAY_GRANULE_PREDICTED;
+            ++params->predicted_granules;
+        }
+
+        // The remaining granules of the window are never accessed
+        params->predicted_granules += window_granules;
+    }
+}
+
+NV_STATUS uvm_test_perf_prefetch_stream_replay(UVM_TEST_PERF_PREFETCH_STREAM_REPLAY_PARAMS *params,
+                                               struct file *filp)
+{
+    UVM_TEST_PERF_PREFETCH_STREAM_ACCESS *accesses = NULL;
+    replay_granule_t *granules = NULL;
+    uvm_perf_prefetch_stream_table_t *table = NULL;
+    size_t num_granules = 0;
+    NV_STATUS status = NV_OK;
+    NvU64 i;
+
+    if (params->num_accesses == 0 || params->num_accesses > UVM_TEST_PERF_PREFETCH_STREAM_MAX_ACCESSES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->confidence_threshold > NV_U8_MAX)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    accesses = uvm_kvmalloc(params->num_accesses * sizeof(*accesses));
+    granules = uvm_kvmalloc(params->num_accesses * sizeof(*granules));
+    table = uvm_kvmalloc(sizeof(*table));
+    if (!accesses || !granules || !table) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    if (copy_from_user(accesses,
+                       (const void __user *)params->accesses,
+                       params->num_accesses * sizeof(*accesses))) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto done;
+    }
+
+    for (i = 0; i < params->num_accesses; ++i) {
+        if (accesses[i].processor >= UVM_ID_MAX_PROCESSORS) {
+            status = NV_ERR_INVALID_ARGUMENT;
+            goto done;
+        }
+
+        granules[i].address = UVM_ALIGN_DOWN(accesses[i].address, GRANULE);
+        granules[i].state = REPLAY_GRANULE_UNTOUCHED;
+    }
+
+    // Build the sorted set of granules in the trace
+    sort(granules, params->num_accesses, sizeof(*granules), replay_granule_cmp, NULL);
+    for (i = 0; i < params->num_accesses; ++i) {
+        if (num_granules == 0 || granules[num_granules - 1].address != granules[i].address)
+            granules[num_granules++] = granules[i];
+    }
+
+    uvm_perf_prefetch_stream_table_init(table);
+    if (params->confidence_threshold != 0)
+        table->params.confidence_threshold = params->confidence_threshold;
+    if (params->distance != 0)
+        table->params.distance = (NvU64)params->distance * GRANULE;
+
+    params->accessed_granules = num_granules;
+    params->faults = 0;
+    params->predicted_granules = 0;
+    params->useful_granules = 0;
+
+    for (i = 0; i < params->num_accesses; ++i) {
+        NvU64 address = UVM_ALIGN_DOWN(accesses[i].address, GRANULE);
+        replay_granule_t *granule = &granules[replay_granule_lower_bound(granules, num_granules, address)];
+
+        UVM_ASSERT(granule->address == address);
+
+        if (granule->state == REPLAY_GRANULE_UNTOUCHED) {
+            uvm_perf_prefetch_stream_window_t windows[UVM_PERF_PREFETCH_STREAM_MAX_DEPTH];
+            uvm_perf_prefetch_stream_t *stream;
+            NvU32 num_windows;
+
+            // Only faults train the predictor
+            granule->state = REPLAY_GRANULE_TOUCHED;
+            ++params->faults;
+
+            stream = uvm_perf_prefetch_stream_train(table, uvm_id_from_value(accesses[i].processor), address);
+            num_windows = uvm_perf_prefetch_stream_next_windows(table, stream, windows);
+            replay_issue_windows(granules, num_granules, windows, num_windows, params);
+        }
+        else if (granule->state == REPLAY_GRANULE_PREDICTED) {
+            granule->state = REPLAY_GRANULE_TOUCHED;
+            ++params->useful_granules;
+        }
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto done;
+        }
+    }
+
+    if (params->predicted_granules)
+        params->accuracy_percent = (NvU32)(params->useful_granules * 100 / params->predicted_granules);
+    else
+        params->accuracy_percent = 0;
+
+    params->coverage_percent = (NvU32)(params->useful_granules * 100 / params->accessed_granules);
+
+done:
+    uvm_kvfree(table);
+    uvm_kvfree(granules);
+    uvm_kvfree(accesses);
+
+    return status;
+}
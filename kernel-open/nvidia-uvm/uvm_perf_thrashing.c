@@ -43,6 +43,10 @@
 #define PAGE_THRASHING_THROTTLING_END_TIME_STAMP_BITS 58
 #define PAGE_THRASHING_THROTTLING_COUNT_BITS          8
 
+#define PAGE_THRASHING_ACCESS_COUNT_BITS 4
+#define PAGE_THRASHING_ACCESS_COUNT_MAX  ((1 << PAGE_THRASHING_ACCESS_COUNT_BITS) - 1)
+#define PAGE_THRASHING_CLASS_BITS        2
+
 // Per-page thrashing detection structure.
 typedef struct
 {
@@ -73,6 +77,29 @@ typedef struct
         NvU8                        throttling_count : PAGE_THRASHING_THROTTLING_COUNT_BITS;
     };
 
+    struct
+    {
+        // Saturating counters of the read (including prefetch) and write
+        // (including atomic) accesses to the page. Both counters are halved
+        // when either of them saturates, so they track recent history.
+        NvU8                               num_reads : PAGE_THRASHING_ACCESS_COUNT_BITS;
+
+        NvU8                              num_writes : PAGE_THRASHING_ACCESS_COUNT_BITS;
+
+        bool                             has_atomics : 1;
+
+        // More than one processor has written to the page
+        bool                        multiple_writers : 1;
+
+        // Access pattern class of the page (UvmEventThrashingClass)
+        NvU8                         thrashing_class : PAGE_THRASHING_CLASS_BITS;
+    };
+
+    // Last processor that wrote to the page, and the time of the write
+    uvm_processor_id_t                last_writer_id;
+
+    NvU64                      last_write_time_stamp;
+
     // Processors accessing this page
     uvm_processor_mask_t                  processors;
 
@@ -199,6 +226,12 @@ typedef struct
         NvU64                                 pin_ns;
 
         NvS8                              lapse_stat;
+
+        // Whether thrashing pages are classified by access pattern to select
+        // the mitigation
+        bool                                classify;
+
+        unsigned                   read_mostly_ratio;
     } params;
 
     uvm_va_space_t                         *va_space;
@@ -220,6 +253,14 @@ typedef struct
 
     // Number of times a page was pinned on a different processor while thrashing
     atomic64_t num_pin_remote;
+
+    // Number of times a read-mostly thrashing page was read-duplicated to this
+    // processor
+    atomic64_t num_read_duplicate;
+
+    // Number of times a pinned producer-consumer page was released so that it
+    // could migrate to this processor
+    atomic64_t num_remigrate;
 } processor_thrashing_stats_t;
 
 // Pre-allocated thrashing stats structure for the CPU. This is only valid if
@@ -315,6 +356,21 @@ static unsigned uvm_perf_thrashing_pin = UVM_PERF_THRASHING_PIN_DEFAULT;
 
 static unsigned uvm_perf_thrashing_max_resets = UVM_PERF_THRASHING_MAX_RESETS_DEFAULT;
 
+#define UVM_PERF_THRASHING_CLASSIFY_DEFAULT 0
+
+// Enable/disable the classification of thrashing pages by access pattern. When
+// disabled, all thrashing pages are throttled and then pinned.
+static unsigned uvm_perf_thrashing_classify = UVM_PERF_THRASHING_CLASSIFY_DEFAULT;
+
+#define UVM_PERF_THRASHING_READ_MOSTLY_RATIO_DEFAULT 8
+#define UVM_PERF_THRASHING_READ_MOSTLY_RATIO_MAX     PAGE_THRASHING_ACCESS_COUNT_MAX
+
+// Minimum ratio of reads to writes for a thrashing page to be classified as
+// read-mostly
+//
+// Maximum value is UVM_PERF_THRASHING_READ_MOSTLY_RATIO_MAX
+static unsigned uvm_perf_thrashing_read_mostly_ratio = UVM_PERF_THRASHING_READ_MOSTLY_RATIO_DEFAULT;
+
 // Module parameters for the tunables
 module_param(uvm_perf_thrashing_enable,        uint, S_IRUGO);
 module_param(uvm_perf_thrashing_threshold,     uint, S_IRUGO);
@@ -325,6 +381,8 @@ module_param(uvm_perf_thrashing_nap,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_epoch,         uint, S_IRUGO);
 module_param(uvm_perf_thrashing_pin,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_max_resets,    uint, S_IRUGO);
+module_param(uvm_perf_thrashing_classify,      uint, S_IRUGO);
+module_param(uvm_perf_thrashing_read_mostly_ratio, uint, S_IRUGO);
 
 // See map_remote_on_atomic_fault uvm_va_block.c
 unsigned uvm_perf_map_remote_on_native_atomics_fault = 0;
@@ -341,6 +399,8 @@ static NvU64 g_uvm_perf_thrashing_nap;
 static NvU64 g_uvm_perf_thrashing_epoch;
 static NvU64 g_uvm_perf_thrashing_pin;
 static unsigned g_uvm_perf_thrashing_max_resets;
+static bool g_uvm_perf_thrashing_classify;
+static unsigned g_uvm_perf_thrashing_read_mostly_ratio;
 
 // Helper macros to initialize thrashing parameters from module parameters
 //
@@ -441,6 +501,8 @@ static int nv_procfs_read_thrashing_stats(struct seq_file *s, void *v)
     UVM_SEQ_OR_DBG_PRINT(s, "throttle      %llu\n", (NvU64)atomic64_read(&processor_stats->num_throttle));
     UVM_SEQ_OR_DBG_PRINT(s, "pin_local     %llu\n", (NvU64)atomic64_read(&processor_stats->num_pin_local));
     UVM_SEQ_OR_DBG_PRINT(s, "pin_remote    %llu\n", (NvU64)atomic64_read(&processor_stats->num_pin_remote));
+    UVM_SEQ_OR_DBG_PRINT(s, "read_dup      %llu\n", (NvU64)atomic64_read(&processor_stats->num_read_duplicate));
+    UVM_SEQ_OR_DBG_PRINT(s, "remigrate     %llu\n", (NvU64)atomic64_read(&processor_stats->num_remigrate));
 
     uvm_up_read(&g_uvm_global.pm.lock);
 
@@ -604,6 +666,9 @@ static void va_space_thrashing_info_init_params(va_space_thrashing_info_t *va_sp
     }
 
     va_space_thrashing->params.max_resets    = g_uvm_perf_thrashing_max_resets;
+
+    va_space_thrashing->params.classify          = g_uvm_perf_thrashing_classify;
+    va_space_thrashing->params.read_mostly_ratio = g_uvm_perf_thrashing_read_mostly_ratio;
 }
 
 // Create the thrashing detection struct for the given VA space
@@ -1084,6 +1149,10 @@ static void thrashing_reset_page(va_space_thrashing_info_t *va_space_thrashing,
     page_thrashing->num_thrashing_events  = 0;
     uvm_processor_mask_zero(&page_thrashing->processors);
 
+    // Keep the access counters so that the page is classified right away if it
+    // starts thrashing again, but report the class again when that happens
+    page_thrashing->thrashing_class       = UvmEventThrashingClassInvalid;
+
     if (uvm_page_mask_test_and_clear(&block_thrashing->thrashing_pages, page_index))
         --block_thrashing->num_thrashing_pages;
 
@@ -1352,6 +1421,7 @@ void thrashing_event_cb(uvm_va_space_t *va_space, uvm_perf_event_t event_id, uvm
         for (page_index = 0; page_index < num_block_pages; ++page_index) {
             block_thrashing->pages[page_index].pinned_residency_id = UVM_ID_INVALID;
             block_thrashing->pages[page_index].do_not_throttle_processor_id = UVM_ID_INVALID;
+            block_thrashing->pages[page_index].last_writer_id = UVM_ID_INVALID;
         }
     }
 
@@ -1476,6 +1546,139 @@ static bool preferred_location_is_thrashing(uvm_processor_id_t preferred_locatio
     return uvm_processor_mask_test(&page_thrashing->processors, preferred_location);
 }
 
+// Classify the access pattern of a thrashing page from its access history:
+//
+// - Read-mostly: writes are rare compared to reads (or there are none). These
+//   pages are best served by duplicating them on the readers.
+// - Write-shared: several processors write to the page, or there are atomics.
+//   Only a single copy can exist, so the page is throttled and then pinned.
+// - Producer-consumer: a single processor writes the page and the rest read
+//   it. The readers are mapped remotely to the memory of the writer.
+static UvmEventThrashingClass thrashing_classify(NvU8 num_reads,
+                                                 NvU8 num_writes,
+                                                 bool has_atomics,
+                                                 bool multiple_writers,
+                                                 unsigned read_mostly_ratio)
+{
+    if (num_reads == 0 && num_writes == 0)
+        return UvmEventThrashingClassInvalid;
+
+    if (!has_atomics && (unsigned)num_writes * read_mostly_ratio <= num_reads)
+        return UvmEventThrashingClassReadMostly;
+
+    if (has_atomics || multiple_writers)
+        return UvmEventThrashingClassWriteShared;
+
+    return UvmEventThrashingClassProducerConsumer;
+}
+
+static void thrashing_record_access(page_thrashing_info_t *page_thrashing,
+                                    uvm_processor_id_t requester,
+                                    NvU32 access_type_mask,
+                                    NvU64 time_stamp)
+{
+    uvm_fault_access_type_t access_type = uvm_fault_access_type_mask_highest(access_type_mask);
+
+    if (page_thrashing->num_reads == PAGE_THRASHING_ACCESS_COUNT_MAX ||
+        page_thrashing->num_writes == PAGE_THRASHING_ACCESS_COUNT_MAX) {
+        page_thrashing->num_reads  /= 2;
+        page_thrashing->num_writes /= 2;
+    }
+
+    if (access_type <= UVM_FAULT_ACCESS_TYPE_READ) {
+        ++page_thrashing->num_reads;
+        return;
+    }
+
+    ++page_thrashing->num_writes;
+
+    if (access_type >= UVM_FAULT_ACCESS_TYPE_ATOMIC_WEAK)
+        page_thrashing->has_atomics = true;
+
+    if (UVM_ID_IS_VALID(page_thrashing->last_writer_id) && !uvm_id_equal(page_thrashing->last_writer_id, requester))
+        page_thrashing->multiple_writers = true;
+
+    page_thrashing->last_writer_id        = requester;
+    page_thrashing->last_write_time_stamp = time_stamp;
+}
+
+static UvmEventThrashingMitigation thrashing_class_mitigation(UvmEventThrashingClass thrashing_class,
+                                                              bool can_read_duplicate)
+{
+    switch (thrashing_class) {
+        case UvmEventThrashingClassReadMostly:
+            return can_read_duplicate ? UvmEventThrashingMitigationReadDuplicate : UvmEventThrashingMitigationPin;
+        case UvmEventThrashingClassProducerConsumer:
+            return UvmEventThrashingMitigationMapRemote;
+        case UvmEventThrashingClassWriteShared:
+            return UvmEventThrashingMitigationPin;
+        default:
+            return UvmEventThrashingMitigationInvalid;
+    }
+}
+
+// Update the access pattern class of the page and notify tools on changes.
+// Returns the current class of the page.
+static UvmEventThrashingClass thrashing_update_class(va_space_thrashing_info_t *va_space_thrashing,
+                                                     uvm_va_block_t *va_block,
+                                                     page_thrashing_info_t *page_thrashing,
+                                                     uvm_page_index_t page_index,
+                                                     uvm_processor_id_t requester,
+                                                     bool can_read_duplicate)
+{
+    uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    UvmEventThrashingClass thrashing_class = thrashing_classify(page_thrashing->num_reads,
+                                                                page_thrashing->num_writes,
+                                                                page_thrashing->has_atomics,
+                                                                page_thrashing->multiple_writers,
+                                                                va_space_thrashing->params.read_mostly_ratio);
+
+    if (thrashing_class == page_thrashing->thrashing_class)
+        return thrashing_class;
+
+    page_thrashing->thrashing_class = thrashing_class;
+
+    uvm_tools_record_thrashing_classified(va_space,
+                                          uvm_va_block_cpu_page_address(va_block, page_index),
+                                          PAGE_SIZE,
+                                          requester,
+                                          thrashing_class,
+                                          thrashing_class_mitigation(thrashing_class, can_read_duplicate),
+                                          page_thrashing->num_reads,
+                                          page_thrashing->num_writes);
+
+    return thrashing_class;
+}
+
+// Producer-consumer pages are pinned on the writer so that readers access the
+// freshly produced data remotely, instead of bouncing the page back and forth.
+static bool get_hint_for_producer_consumer(va_space_thrashing_info_t *va_space_thrashing,
+                                           uvm_va_block_t *va_block,
+                                           page_thrashing_info_t *page_thrashing,
+                                           uvm_page_index_t page_index,
+                                           uvm_processor_id_t requester,
+                                           uvm_perf_thrashing_hint_t *hint)
+{
+    uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    uvm_processor_id_t writer = page_thrashing->last_writer_id;
+    const uvm_va_policy_t *policy = uvm_va_policy_get(va_block, uvm_va_block_cpu_page_address(va_block, page_index));
+
+    // The preferred location logic takes precedence
+    if (UVM_ID_IS_VALID(policy->preferred_location))
+        return false;
+
+    if (UVM_ID_IS_INVALID(writer) || !uvm_processor_has_memory(writer))
+        return false;
+
+    if (!thrashing_processors_can_access(va_space, page_thrashing, writer))
+        return false;
+
+    hint->type = UVM_PERF_THRASHING_HINT_TYPE_PIN;
+    hint->pin.residency = writer;
+
+    return true;
+}
+
 static uvm_perf_thrashing_hint_t get_hint_for_migration_thrashing(va_space_thrashing_info_t *va_space_thrashing,
                                                                   uvm_va_block_t *va_block,
                                                                   uvm_va_block_context_t *va_block_context,
@@ -1661,10 +1864,19 @@ static void adjust_thrashing_lapse(va_space_thrashing_info_t *ti, NvU64 lapse)
 //   thrashing due to revocation events (mainly due to system-wide atomics). In
 //   that case we keep the page pinned while applying the same algorithm as in
 //   Phase1.
+//
+// When classification is enabled, thrashing pages are classified by access
+// pattern (see thrashing_classify) and Phase1/Phase2 are replaced by the
+// mitigation of the class: read-mostly pages are read-duplicated and
+// producer-consumer pages are pinned on the writer, and released again when
+// access counters show that the writer is done with them. Write-shared pages
+// use the default algorithm.
 uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
                                                       uvm_va_block_context_t *va_block_context,
                                                       NvU64 address,
-                                                      uvm_processor_id_t requester)
+                                                      uvm_processor_id_t requester,
+                                                      NvU32 access_type_mask,
+                                                      uvm_service_operation_t operation)
 {
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
     va_space_thrashing_info_t *va_space_thrashing = va_space_thrashing_info_get(va_space);
@@ -1674,6 +1886,8 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
     uvm_page_index_t page_index = uvm_va_block_cpu_page_index(va_block, address);
     NvU64 time_stamp;
     NvU64 last_time_stamp;
+    UvmEventThrashingClass thrashing_class = UvmEventThrashingClassInvalid;
+    bool can_read_duplicate = false;
 
     hint.type = UVM_PERF_THRASHING_HINT_TYPE_NONE;
 
@@ -1725,6 +1939,10 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
 
     page_thrashing = &block_thrashing->pages[page_index];
 
+    // Access counter notifications do not carry the type of the access
+    if (operation != UVM_SERVICE_OPERATION_ACCESS_COUNTERS)
+        thrashing_record_access(page_thrashing, requester, access_type_mask, time_stamp);
+
     // Not enough thrashing events yet
     if (page_thrashing->num_thrashing_events < va_space_thrashing->params.threshold)
         goto done;
@@ -1763,6 +1981,25 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
     // Update throttling heuristics
     thrashing_throttle_update(va_space_thrashing, va_block, page_thrashing, requester, time_stamp);
 
+    // TODO: Bug 3660922: HMM will need to look up the policy when read
+    // duplication is supported.
+    if (va_space_thrashing->params.classify && !uvm_va_block_is_hmm(va_block)) {
+        const uvm_va_policy_t *policy = uvm_va_policy_get(va_block, address);
+
+        // The preferred location logic takes precedence on the preferred
+        // location itself, which always gets the page
+        can_read_duplicate = policy->read_duplication != UVM_READ_DUPLICATION_DISABLED &&
+                             uvm_va_space_can_read_duplicate(va_space, NULL) &&
+                             !uvm_id_equal(requester, policy->preferred_location);
+
+        thrashing_class = thrashing_update_class(va_space_thrashing,
+                                                 va_block,
+                                                 page_thrashing,
+                                                 page_index,
+                                                 requester,
+                                                 can_read_duplicate);
+    }
+
     if (page_thrashing->pinned &&
         page_thrashing->has_revocation_events &&
         !uvm_id_equal(requester, page_thrashing->do_not_throttle_processor_id)) {
@@ -1774,7 +2011,43 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
         // throttle the execution of the processors.
         hint.type = UVM_PERF_THRASHING_HINT_TYPE_THROTTLE;
     }
-    else {
+    else if (thrashing_class == UvmEventThrashingClassReadMostly &&
+             can_read_duplicate &&
+             !page_thrashing->pinned &&
+             operation != UVM_SERVICE_OPERATION_ACCESS_COUNTERS &&
+             uvm_fault_access_type_mask_highest(access_type_mask) <= UVM_FAULT_ACCESS_TYPE_READ) {
+        // The resulting read duplication resets the thrashing state of the
+        // page, see thrashing_event_cb
+        hint.type = UVM_PERF_THRASHING_HINT_TYPE_READ_DUPLICATE;
+        PROCESSOR_THRASHING_STATS_INC(requester, num_read_duplicate);
+    }
+    else if (thrashing_class == UvmEventThrashingClassProducerConsumer &&
+             operation == UVM_SERVICE_OPERATION_ACCESS_COUNTERS &&
+             page_thrashing->pinned &&
+             !uvm_id_equal(requester, page_thrashing->last_writer_id) &&
+             time_stamp - page_thrashing->last_write_time_stamp > va_space_thrashing->params.lapse_ns) {
+        // The writer has not touched the page for a while and the consumer
+        // keeps accessing it remotely. Release the page so that it can be
+        // migrated to the consumer.
+        uvm_tools_record_thrashing_classified(va_space,
+                                              address,
+                                              PAGE_SIZE,
+                                              requester,
+                                              thrashing_class,
+                                              UvmEventThrashingMitigationRemigrate,
+                                              page_thrashing->num_reads,
+                                              page_thrashing->num_writes);
+
+        thrashing_reset_page(va_space_thrashing, va_block, block_thrashing, page_index);
+        PROCESSOR_THRASHING_STATS_INC(requester, num_remigrate);
+    }
+    else if (thrashing_class != UvmEventThrashingClassProducerConsumer ||
+             !get_hint_for_producer_consumer(va_space_thrashing,
+                                             va_block,
+                                             page_thrashing,
+                                             page_index,
+                                             requester,
+                                             &hint)) {
         hint = get_hint_for_migration_thrashing(va_space_thrashing,
                                                 va_block,
                                                 va_block_context,
@@ -2062,6 +2335,14 @@ NV_STATUS uvm_perf_thrashing_init(void)
 
     INIT_THRASHING_PARAMETER(uvm_perf_thrashing_max_resets, UVM_PERF_THRASHING_MAX_RESETS_DEFAULT);
 
+    INIT_THRASHING_PARAMETER_TOGGLE(uvm_perf_thrashing_classify, UVM_PERF_THRASHING_CLASSIFY_DEFAULT);
+
+    INIT_THRASHING_PARAMETER_NONZERO_MAX(uvm_perf_thrashing_read_mostly_ratio,
+                                         UVM_PERF_THRASHING_READ_MOSTLY_RATIO_DEFAULT,
+                                         UVM_PERF_THRASHING_READ_MOSTLY_RATIO_MAX);
+
+    BUILD_BUG_ON(UvmEventNumThrashingClasses > (1 << PAGE_THRASHING_CLASS_BITS));
+
     g_va_block_thrashing_info_cache = NV_KMEM_CACHE_CREATE("uvm_block_thrashing_info_t", block_thrashing_info_t);
     if (!g_va_block_thrashing_info_cache) {
         status = NV_ERR_NO_MEMORY;
@@ -2211,3 +2492,72 @@ done_unlock_va_space:
 
     return status;
 }
+
+static NV_STATUS test_thrashing_classify(void)
+{
+    const unsigned ratio = UVM_PERF_THRASHING_READ_MOSTLY_RATIO_DEFAULT;
+
+    // No accesses recorded
+    TEST_CHECK_RET(thrashing_classify(0, 0, false, false, ratio) == UvmEventThrashingClassInvalid);
+
+    // Reads only, or rare writes
+    TEST_CHECK_RET(thrashing_classify(1, 0, false, false, ratio) == UvmEventThrashingClassReadMostly);
+    TEST_CHECK_RET(thrashing_classify(ratio, 1, false, false, ratio) == UvmEventThrashingClassReadMostly);
+    TEST_CHECK_RET(thrashing_classify(ratio, 1, false, true, ratio) == UvmEventThrashingClassReadMostly);
+
+    // Frequent writes from a single processor
+    TEST_CHECK_RET(thrashing_classify(ratio - 1, 1, false, false, ratio) == UvmEventThrashingClassProducerConsumer);
+    TEST_CHECK_RET(thrashing_classify(0, 1, false, false, ratio) == UvmEventThrashingClassProducerConsumer);
+
+    // Frequent writes from several processors, or atomics
+    TEST_CHECK_RET(thrashing_classify(ratio - 1, 1, false, true, ratio) == UvmEventThrashingClassWriteShared);
+    TEST_CHECK_RET(thrashing_classify(PAGE_THRASHING_ACCESS_COUNT_MAX, 1, true, false, ratio) ==
+                   UvmEventThrashingClassWriteShared);
+    TEST_CHECK_RET(thrashing_classify(0, 1, true, false, ratio) == UvmEventThrashingClassWriteShared);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_thrashing_record_access(void)
+{
+    page_thrashing_info_t page_thrashing = {0};
+    unsigned i;
+
+    page_thrashing.last_writer_id = UVM_ID_INVALID;
+
+    // Counters are halved on saturation
+    for (i = 0; i < PAGE_THRASHING_ACCESS_COUNT_MAX; ++i)
+        thrashing_record_access(&page_thrashing, UVM_ID_CPU, UVM_FAULT_ACCESS_TYPE_READ, i);
+
+    TEST_CHECK_RET(page_thrashing.num_reads == PAGE_THRASHING_ACCESS_COUNT_MAX);
+
+    thrashing_record_access(&page_thrashing, UVM_ID_CPU, UVM_FAULT_ACCESS_TYPE_PREFETCH, i++);
+    TEST_CHECK_RET(page_thrashing.num_reads == PAGE_THRASHING_ACCESS_COUNT_MAX / 2 + 1);
+    TEST_CHECK_RET(page_thrashing.num_writes == 0);
+
+    // A single writer
+    thrashing_record_access(&page_thrashing, UVM_ID_CPU, UVM_FAULT_ACCESS_TYPE_WRITE, i);
+    TEST_CHECK_RET(page_thrashing.num_writes == 1);
+    TEST_CHECK_RET(uvm_id_equal(page_thrashing.last_writer_id, UVM_ID_CPU));
+    TEST_CHECK_RET(page_thrashing.last_write_time_stamp == i);
+    TEST_CHECK_RET(!page_thrashing.multiple_writers);
+    TEST_CHECK_RET(!page_thrashing.has_atomics);
+
+    // A second writer
+    thrashing_record_access(&page_thrashing, uvm_gpu_id_from_index(0), UVM_FAULT_ACCESS_TYPE_ATOMIC_STRONG, i + 1);
+    TEST_CHECK_RET(page_thrashing.num_writes == 2);
+    TEST_CHECK_RET(uvm_id_equal(page_thrashing.last_writer_id, uvm_gpu_id_from_index(0)));
+    TEST_CHECK_RET(page_thrashing.multiple_writers);
+    TEST_CHECK_RET(page_thrashing.has_atomics);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_perf_thrashing_classify_sanity(UVM_TEST_PERF_THRASHING_CLASSIFY_SANITY_PARAMS *params,
+                                                  struct file *filp)
+{
+    TEST_NV_CHECK_RET(test_thrashing_classify());
+    TEST_NV_CHECK_RET(test_thrashing_record_access());
+
+    return NV_OK;
+}
@@ -27,6 +27,7 @@
 #include "uvm_linux.h"
 #include "uvm_extern_decl.h"
 #include "uvm_forward_decl.h"
+#include "uvm_hal_types.h"
 #include "uvm_processors.h"
 #include "uvm_va_block_types.h"
 
@@ -43,9 +44,9 @@ typedef enum
     // sleeping or handing other faults)
     UVM_PERF_THRASHING_HINT_TYPE_THROTTLE = 2,
 
-    // TODO: Bug 1877578: Implement heuristics-driven read-duplication
-    // Add a thrashing hint type to read-duplicate a page when it is being
-    // accessed read-only from different processors
+    // Read-duplicate the page on the calling processor. Only returned for
+    // read accesses to pages classified as read-mostly.
+    UVM_PERF_THRASHING_HINT_TYPE_READ_DUPLICATE = 3,
 } uvm_perf_thrashing_hint_type_t;
 
 typedef struct
@@ -73,11 +74,18 @@ typedef struct
     };
 } uvm_perf_thrashing_hint_t;
 
-// Obtain a hint to prevent thrashing on the page with given address
+// Obtain a hint to prevent thrashing on the page with given address.
+// access_type_mask holds the types of all the accesses being serviced on the
+// page, which are used to classify the access pattern of thrashing pages. operation identifies the
+// servicing path; access counter notifications are not used for
+// classification, but they can trigger the remigration of pages pinned due to
+// producer-consumer thrashing.
 uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
                                                       uvm_va_block_context_t *va_block_context,
                                                       NvU64 address,
-                                                      uvm_processor_id_t requester);
+                                                      uvm_processor_id_t requester,
+                                                      NvU32 access_type_mask,
+                                                      uvm_service_operation_t operation);
 
 // Obtain a pointer to a mask with the processors that are thrashing on the
 // given page. This function assumes that thrashing has been just reported on
@@ -0,0 +1,1203 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_linux.h"
+#include "uvm_global.h"
+#include "uvm_gpu.h"
+#include "uvm_kvmalloc.h"
+#include "uvm_perf_events.h"
+#include "uvm_perf_module.h"
+#include "uvm_perf_thrashing.h"
+#include "uvm_perf_tiering.h"
+#include "uvm_pmm_gpu.h"
+#include "uvm_range_group.h"
+#include "uvm_test.h"
+#include "uvm_tracker.h"
+#include "uvm_va_block.h"
+#include "uvm_va_policy.h"
+#include "uvm_va_range.h"
+#include "uvm_va_space.h"
+#include "uvm_va_space_mm.h"
+
+//
+// Tunables for the tiering daemon (configurable via module parameters)
+//
+
+#define UVM_PERF_TIERING_ENABLE_DEFAULT 0
+
+// Enable/disable the tiering daemon
+static unsigned uvm_perf_tiering_enable = UVM_PERF_TIERING_ENABLE_DEFAULT;
+
+#define UVM_PERF_TIERING_PERIOD_MSEC_DEFAULT 100
+#define UVM_PERF_TIERING_PERIOD_MSEC_MIN     10
+#define UVM_PERF_TIERING_PERIOD_MSEC_MAX     10000
+
+// Time between two consecutive scans of the daemon
+//
+// Valid values 10-10000
+static unsigned uvm_perf_tiering_period_msec = UVM_PERF_TIERING_PERIOD_MSEC_DEFAULT;
+
+#define UVM_PERF_TIERING_HALF_LIFE_MSEC_DEFAULT 1000
+#define UVM_PERF_TIERING_HALF_LIFE_MSEC_MAX     60000
+
+// Time it takes for the heat of a block that is not accessed anymore to halve
+//
+// Valid values 1-60000
+static unsigned uvm_perf_tiering_half_life_msec = UVM_PERF_TIERING_HALF_LIFE_MSEC_DEFAULT;
+
+#define UVM_PERF_TIERING_HOT_THRESHOLD_DEFAULT 64
+
+// Heat at or above which a remote-mapped block is promoted to the vidmem of
+// the GPU that accesses it. Every page reported by a fault or by an access
+// counter notification adds one unit of heat.
+static unsigned uvm_perf_tiering_hot_threshold = UVM_PERF_TIERING_HOT_THRESHOLD_DEFAULT;
+
+#define UVM_PERF_TIERING_COLD_THRESHOLD_DEFAULT 1
+
+// Heat at or below which a block resident in vidmem can be demoted. It must be
+// smaller than uvm_perf_tiering_hot_threshold.
+static unsigned uvm_perf_tiering_cold_threshold = UVM_PERF_TIERING_COLD_THRESHOLD_DEFAULT;
+
+#define UVM_PERF_TIERING_HIGH_WATERMARK_DEFAULT 90
+
+// Percentage of the vidmem of a GPU in use above which cold blocks are
+// demoted out of it, and hot blocks are not promoted to it anymore
+//
+// Valid values 1-100
+static unsigned uvm_perf_tiering_high_watermark = UVM_PERF_TIERING_HIGH_WATERMARK_DEFAULT;
+
+#define UVM_PERF_TIERING_BATCH_MB_DEFAULT 32
+#define UVM_PERF_TIERING_BATCH_MB_MAX     1024
+
+// Maximum number of MBs migrated by the daemon in each period
+//
+// Valid values 1-1024
+static unsigned uvm_perf_tiering_batch_mb = UVM_PERF_TIERING_BATCH_MB_DEFAULT;
+
+#define UVM_PERF_TIERING_MAX_SCAN_DEFAULT 256
+#define UVM_PERF_TIERING_MAX_SCAN_MAX     4096
+
+// Maximum number of blocks scanned by the daemon in each period
+//
+// Valid values 1-4096
+static unsigned uvm_perf_tiering_max_scan = UVM_PERF_TIERING_MAX_SCAN_DEFAULT;
+
+module_param(uvm_perf_tiering_enable, uint, S_IRUGO);
+module_param(uvm_perf_tiering_period_msec, uint, S_IRUGO);
+module_param(uvm_perf_tiering_half_life_msec, uint, S_IRUGO);
+module_param(uvm_perf_tiering_hot_threshold, uint, S_IRUGO);
+module_param(uvm_perf_tiering_cold_threshold, uint, S_IRUGO);
+module_param(uvm_perf_tiering_high_watermark, uint, S_IRUGO);
+module_param(uvm_perf_tiering_batch_mb, uint, S_IRUGO);
+module_param(uvm_perf_tiering_max_scan, uint, S_IRUGO);
+
+static bool g_uvm_perf_tiering_enable;
+static unsigned long g_uvm_perf_tiering_period_jiffies;
+static NvU64 g_uvm_perf_tiering_half_life_ns;
+static unsigned g_uvm_perf_tiering_hot_threshold;
+static unsigned g_uvm_perf_tiering_cold_threshold;
+static unsigned g_uvm_perf_tiering_high_watermark;
+static NvU64 g_uvm_perf_tiering_batch_bytes;
+static unsigned g_uvm_perf_tiering_max_scan;
+
+// Per-block tiering state. Everything but list_entry is protected by the VA
+// block lock.
+typedef struct
+{
+    uvm_va_block_t *va_block;
+
+    // Entry in the list of tracked blocks of the VA space. Protected by the
+    // lock of the VA space tiering state.
+    struct list_head list_entry;
+
+    // Heat of the block at last_update_time_stamp
+    NvU32 heat;
+
+    NvU64 last_update_time_stamp;
+
+    // Processor that accessed the block most recently
+    uvm_processor_id_t last_processor;
+} block_tiering_info_t;
+
+// Per-VA space tiering state
+typedef struct
+{
+    uvm_va_space_t *va_space;
+
+    // Blocks with tiering state, in scan order. The daemon moves the blocks it
+    // scans to the tail of the list.
+    struct list_head blocks;
+
+    NvU32 num_blocks;
+
+    // Protects blocks and num_blocks
+    uvm_spinlock_t lock;
+
+    struct delayed_work dwork;
+
+    // Flag used to avoid scheduling the daemon during VA space teardown.
+    // Protected by the VA space lock.
+    bool in_va_space_teardown;
+
+    // State only used by the daemon, which never runs concurrently with
+    // itself
+
+    uvm_service_block_context_t *service_context;
+
+    // Blocks picked for the current scan
+    uvm_va_block_t **scan_blocks;
+
+    // GPUs whose vidmem usage is above the high watermark
+    uvm_processor_mask_t pressured_gpus;
+
+    // Bytes migrated by the daemon. These are not tools counters because the
+    // size of the tools counter buffer is part of the user space ABI.
+    atomic64_t bytes_promoted;
+    atomic64_t bytes_demoted;
+} va_space_tiering_info_t;
+
+// Migration performed by the daemon on a block
+typedef struct
+{
+    uvm_gpu_id_t gpu_id;
+
+    NvU64 bytes;
+
+    bool promotion;
+} tiering_migration_t;
+
+static struct kmem_cache *g_block_tiering_info_cache __read_mostly;
+
+// Performance heuristics module for tiering
+static uvm_perf_module_t g_module_tiering;
+
+static void tiering_fault_cb(uvm_va_space_t *va_space, uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data);
+static void tiering_block_destroy_cb(uvm_va_space_t *va_space,
+                                     uvm_perf_event_t event_id,
+                                     uvm_perf_event_data_t *event_data);
+
+static uvm_perf_module_event_callback_desc_t g_callbacks_tiering[] = {
+    { UVM_PERF_EVENT_BLOCK_DESTROY, tiering_block_destroy_cb },
+    { UVM_PERF_EVENT_MODULE_UNLOAD, tiering_block_destroy_cb },
+    { UVM_PERF_EVENT_BLOCK_SHRINK , tiering_block_destroy_cb },
+    { UVM_PERF_EVENT_FAULT,         tiering_fault_cb         }
+};
+
+// Get the tiering struct for the given VA space if it exists
+//
+// The caller must ensure that the va_space cannot be deleted, for the
+// duration of this call. Holding either the va_block or va_space lock will do
+// that.
+static va_space_tiering_info_t *va_space_tiering_info_get_or_null(uvm_va_space_t *va_space)
+{
+    return uvm_perf_module_type_data(va_space->perf_modules_data, UVM_PERF_MODULE_TYPE_TIERING);
+}
+
+// Get the tiering struct for the given block
+static block_tiering_info_t *tiering_info_get(uvm_va_block_t *va_block)
+{
+    uvm_assert_mutex_locked(&va_block->lock);
+    return uvm_perf_module_type_data(va_block->perf_modules_data, UVM_PERF_MODULE_TYPE_TIERING);
+}
+
+// Get the tiering struct for the given block or create it if it does not
+// exist. Newly-created structs are added to the list of tracked blocks of the
+// VA space, and the daemon is scheduled if the list was empty.
+static block_tiering_info_t *tiering_info_get_create(va_space_tiering_info_t *va_space_tiering,
+                                                     uvm_va_block_t *va_block)
+{
+    block_tiering_info_t *block_tiering = tiering_info_get(va_block);
+
+    if (block_tiering)
+        return block_tiering;
+
+    block_tiering = nv_kmem_cache_zalloc(g_block_tiering_info_cache, NV_UVM_GFP_FLAGS);
+    if (!block_tiering)
+        return NULL;
+
+    block_tiering->va_block = va_block;
+    block_tiering->last_processor = UVM_ID_INVALID;
+    block_tiering->last_update_time_stamp = NV_GETTIME();
+
+    uvm_perf_module_type_set_data(va_block->perf_modules_data, block_tiering, UVM_PERF_MODULE_TYPE_TIERING);
+
+    uvm_spin_lock(&va_space_tiering->lock);
+
+    list_add_tail(&block_tiering->list_entry, &va_space_tiering->blocks);
+    if (va_space_tiering->num_blocks++ == 0 && !va_space_tiering->in_va_space_teardown)
+        schedule_delayed_work(&va_space_tiering->dwork, g_uvm_perf_tiering_period_jiffies);
+
+    uvm_spin_unlock(&va_space_tiering->lock);
+
+    return block_tiering;
+}
+
+static void tiering_info_destroy(va_space_tiering_info_t *va_space_tiering, uvm_va_block_t *va_block)
+{
+    block_tiering_info_t *block_tiering = tiering_info_get(va_block);
+
+    if (!block_tiering)
+        return;
+
+    uvm_spin_lock(&va_space_tiering->lock);
+
+    list_del(&block_tiering->list_entry);
+    UVM_ASSERT(va_space_tiering->num_blocks > 0);
+    --va_space_tiering->num_blocks;
+
+    uvm_spin_unlock(&va_space_tiering->lock);
+
+    uvm_perf_module_type_unset_data(va_block->perf_modules_data, UVM_PERF_MODULE_TYPE_TIERING);
+    kmem_cache_free(g_block_tiering_info_cache, block_tiering);
+}
+
+// Decay the given heat after elapsed_ns, halving it every half_life_ns. The
+// decay within the last, partial half-life is approximated linearly:
+// 2^-x ~= 1 - x/2 for x in [0, 1).
+static NvU32 tiering_decay_heat(NvU32 heat, NvU64 elapsed_ns, NvU64 half_life_ns)
+{
+    NvU64 half_lives = elapsed_ns / half_life_ns;
+    NvU64 fraction;
+
+    if (half_lives >= 32)
+        return 0;
+
+    heat >>= half_lives;
+
+    // Fraction of the last half-life elapsed, in 1/1024 units, so that the
+    // multiplication below cannot overflow
+    fraction = ((elapsed_ns - half_lives * half_life_ns) * 1024) / half_life_ns;
+
+    return heat - (NvU32)(((NvU64)heat * fraction) / 2048);
+}
+
+// Bring the heat of the block up to date and return it
+static NvU32 tiering_update_heat(block_tiering_info_t *block_tiering, NvU64 now)
+{
+    if (now > block_tiering->last_update_time_stamp) {
+        block_tiering->heat = tiering_decay_heat(block_tiering->heat,
+                                                 now - block_tiering->last_update_time_stamp,
+                                                 g_uvm_perf_tiering_half_life_ns);
+        block_tiering->last_update_time_stamp = now;
+    }
+
+    return block_tiering->heat;
+}
+
+static void tiering_heat_up(block_tiering_info_t *block_tiering, uvm_processor_id_t processor, NvU32 amount)
+{
+    NvU32 heat = tiering_update_heat(block_tiering, NV_GETTIME());
+
+    block_tiering->heat = heat > U32_MAX - amount ? U32_MAX : heat + amount;
+    block_tiering->last_processor = processor;
+}
+
+static void tiering_fault_cb(uvm_va_space_t *va_space, uvm_perf_event_t event_id, uvm_perf_event_data_t *event_data)
+{
+    va_space_tiering_info_t *va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+    uvm_va_block_t *va_block = event_data->fault.block;
+    uvm_processor_id_t proc_id = event_data->fault.proc_id;
+    block_tiering_info_t *block_tiering;
+
+    UVM_ASSERT(g_uvm_perf_tiering_enable);
+    UVM_ASSERT(event_id == UVM_PERF_EVENT_FAULT);
+
+    // Only managed blocks are tracked, since the daemon relies on blocks not
+    // being destroyed while it holds the VA space lock in read mode. That is
+    // not the case for HMM blocks.
+    if (!va_space_tiering || !va_block || uvm_va_block_is_hmm(va_block))
+        return;
+
+    // Duplicates carry no new information and HW prefetch faults are
+    // speculative
+    if (UVM_ID_IS_GPU(proc_id) &&
+        (event_data->fault.gpu.is_duplicate ||
+         event_data->fault.gpu.buffer_entry->fault_access_type == UVM_FAULT_ACCESS_TYPE_PREFETCH))
+        return;
+
+    block_tiering = tiering_info_get_create(va_space_tiering, va_block);
+    if (block_tiering)
+        tiering_heat_up(block_tiering, proc_id, 1);
+}
+
+static void tiering_block_destroy_cb(uvm_va_space_t *va_space,
+                                     uvm_perf_event_t event_id,
+                                     uvm_perf_event_data_t *event_data)
+{
+    va_space_tiering_info_t *va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+    uvm_va_block_t *va_block;
+
+    UVM_ASSERT(g_uvm_perf_tiering_enable);
+
+    UVM_ASSERT(event_id == UVM_PERF_EVENT_BLOCK_DESTROY ||
+               event_id == UVM_PERF_EVENT_BLOCK_SHRINK ||
+               event_id == UVM_PERF_EVENT_MODULE_UNLOAD);
+
+    if (event_id == UVM_PERF_EVENT_BLOCK_DESTROY)
+        va_block = event_data->block_destroy.block;
+    else if (event_id == UVM_PERF_EVENT_BLOCK_SHRINK)
+        va_block = event_data->block_shrink.block;
+    else
+        va_block = event_data->module_unload.block;
+
+    if (!va_block || !va_space_tiering)
+        return;
+
+    tiering_info_destroy(va_space_tiering, va_block);
+}
+
+void uvm_perf_tiering_record_access_counters(uvm_va_block_t *va_block, uvm_gpu_id_t gpu_id, NvU32 num_pages)
+{
+    uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
+    va_space_tiering_info_t *va_space_tiering;
+    block_tiering_info_t *block_tiering;
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    if (!g_uvm_perf_tiering_enable || uvm_va_block_is_hmm(va_block) || num_pages == 0)
+        return;
+
+    va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+    if (!va_space_tiering)
+        return;
+
+    block_tiering = tiering_info_get_create(va_space_tiering, va_block);
+    if (block_tiering)
+        tiering_heat_up(block_tiering, gpu_id, num_pages);
+}
+
+static bool tiering_gpu_under_pressure(uvm_gpu_t *gpu)
+{
+    const UvmPmaStatistics *pma_stats = gpu->pmm.pma_stats;
+    NvU64 total_bytes;
+    NvU64 free_bytes;
+
+    if (!pma_stats)
+        return false;
+
+    total_bytes = READ_ONCE(pma_stats->numPages2m) * UVM_CHUNK_SIZE_2M;
+    free_bytes = READ_ONCE(pma_stats->numFreePages64k) * UVM_CHUNK_SIZE_64K;
+    if (total_bytes == 0 || free_bytes >= total_bytes)
+        return false;
+
+    return (total_bytes - free_bytes) * 100 >= total_bytes * g_uvm_perf_tiering_high_watermark;
+}
+
+// Pick the first blocks in the list of tracked blocks, up to the maximum scan
+// size, and move them to the tail of the list so that the next scan resumes
+// after them.
+static NvU32 tiering_pick_blocks(va_space_tiering_info_t *va_space_tiering)
+{
+    NvU32 count;
+    NvU32 i;
+
+    uvm_spin_lock(&va_space_tiering->lock);
+
+    count = min(va_space_tiering->num_blocks, g_uvm_perf_tiering_max_scan);
+    for (i = 0; i < count; ++i) {
+        block_tiering_info_t *block_tiering = list_first_entry(&va_space_tiering->blocks,
+                                                               block_tiering_info_t,
+                                                               list_entry);
+
+        va_space_tiering->scan_blocks[i] = block_tiering->va_block;
+        list_move_tail(&block_tiering->list_entry, &va_space_tiering->blocks);
+    }
+
+    uvm_spin_unlock(&va_space_tiering->lock);
+
+    return count;
+}
+
+// Select a GPU under pressure the cold block can be demoted from. Returns
+// UVM_ID_INVALID if there is none.
+static uvm_gpu_id_t tiering_demotion_gpu(va_space_tiering_info_t *va_space_tiering,
+                                         uvm_va_block_t *va_block,
+                                         const uvm_va_policy_t *policy,
+                                         uvm_va_block_context_t *va_block_context)
+{
+    uvm_processor_mask_t *candidates = &va_block_context->caller_processor_mask;
+    uvm_gpu_id_t gpu_id;
+
+    if (!uvm_processor_mask_and(candidates, &va_block->resident, &va_space_tiering->pressured_gpus))
+        return UVM_ID_INVALID;
+
+    // Memory is never demoted out of its preferred location
+    for_each_gpu_id_in_mask(gpu_id, candidates) {
+        if (!uvm_id_equal(policy->preferred_location, gpu_id))
+            return gpu_id;
+    }
+
+    return UVM_ID_INVALID;
+}
+
+// Whether the hot block can be promoted to the given GPU
+static bool tiering_can_promote(va_space_tiering_info_t *va_space_tiering,
+                                uvm_va_block_t *va_block,
+                                const uvm_va_policy_t *policy,
+                                uvm_processor_id_t gpu_id)
+{
+    uvm_va_space_t *va_space = va_space_tiering->va_space;
+
+    if (!UVM_ID_IS_GPU(gpu_id))
+        return false;
+
+    if (uvm_processor_mask_test(&va_space_tiering->pressured_gpus, gpu_id))
+        return false;
+
+    if (!uvm_processor_mask_test(&va_space->registered_gpu_va_spaces, gpu_id))
+        return false;
+
+    // Only remote-mapped memory is promoted
+    if (!uvm_processor_mask_test(&va_block->mapped, gpu_id))
+        return false;
+
+    // Memory is never promoted out of its preferred location
+    return !UVM_ID_IS_VALID(policy->preferred_location) || uvm_id_equal(policy->preferred_location, gpu_id);
+}
+
+// Map the given promoted pages on the GPU they were promoted to, with the
+// highest permission that doesn't require revoking other processors.
+static NV_STATUS tiering_map_promoted_pages(uvm_va_block_t *va_block,
+                                            uvm_va_block_context_t *va_block_context,
+                                            uvm_va_block_region_t region,
+                                            const uvm_page_mask_t *pages,
+                                            uvm_gpu_id_t gpu_id)
+{
+    uvm_prot_t prot;
+    uvm_page_index_t page_index;
+    NV_STATUS status = NV_OK;
+
+    for (prot = UVM_PROT_READ_ONLY; prot <= UVM_PROT_READ_WRITE_ATOMIC; ++prot)
+        va_block_context->mask_by_prot[prot - 1].count = 0;
+
+    for_each_va_block_page_in_region_mask(page_index, pages, region) {
+        prot = uvm_va_block_page_compute_highest_permission(va_block, va_block_context, gpu_id, page_index);
+        if (prot == UVM_PROT_NONE)
+            continue;
+
+        if (va_block_context->mask_by_prot[prot - 1].count++ == 0)
+            uvm_page_mask_zero(&va_block_context->mask_by_prot[prot - 1].page_mask);
+
+        uvm_page_mask_set(&va_block_context->mask_by_prot[prot - 1].page_mask, page_index);
+    }
+
+    for (prot = UVM_PROT_READ_ONLY; prot <= UVM_PROT_READ_WRITE_ATOMIC; ++prot) {
+        if (va_block_context->mask_by_prot[prot - 1].count == 0)
+            continue;
+
+        status = uvm_va_block_map(va_block,
+                                  va_block_context,
+                                  gpu_id,
+                                  region,
+                                  &va_block_context->mask_by_prot[prot - 1].page_mask,
+                                  prot,
+                                  UvmEventMapRemoteCauseInvalid,
+                                  &va_block->tracker);
+        if (status != NV_OK)
+            break;
+    }
+
+    return status;
+}
+
+// Migrate exactly the given pages of the block to dest_id. Promoted pages are
+// also mapped on the GPU they were promoted to. Only the pages that actually
+// changed residency are reported in out_bytes.
+static NV_STATUS tiering_migrate_pages_locked(uvm_va_block_t *va_block,
+                                              uvm_va_block_retry_t *va_block_retry,
+                                              uvm_service_block_context_t *service_context,
+                                              const uvm_page_mask_t *pages,
+                                              uvm_processor_id_t dest_id,
+                                              uvm_make_resident_cause_t cause,
+                                              NvU64 *out_bytes)
+{
+    uvm_va_block_context_t *va_block_context = service_context->block_context;
+    uvm_page_mask_t *did_migrate_mask = &va_block_context->make_resident.pages_changed_residency;
+    uvm_va_block_region_t region = uvm_va_block_region_from_mask(va_block, pages);
+    NV_STATUS status;
+
+    *out_bytes = 0;
+
+    uvm_page_mask_zero(did_migrate_mask);
+    uvm_processor_mask_zero(&va_block_context->make_resident.all_involved_processors);
+
+    status = uvm_va_block_make_resident(va_block,
+                                        va_block_retry,
+                                        va_block_context,
+                                        dest_id,
+                                        region,
+                                        pages,
+                                        NULL,
+                                        cause);
+
+    uvm_processor_mask_or(&service_context->gpus_to_check_for_nvlink_errors,
+                          &service_context->gpus_to_check_for_nvlink_errors,
+                          &va_block_context->make_resident.all_involved_processors);
+
+    if (status != NV_OK)
+        return status;
+
+    *out_bytes = (NvU64)uvm_page_mask_region_weight(did_migrate_mask, region) * PAGE_SIZE;
+
+    if (cause == UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION)
+        status = tiering_map_promoted_pages(va_block, va_block_context, region, pages, dest_id);
+
+    return status;
+}
+
+static NV_STATUS tiering_service_block_locked(va_space_tiering_info_t *va_space_tiering,
+                                              uvm_va_block_t *va_block,
+                                              uvm_va_block_retry_t *va_block_retry,
+                                              NvU64 budget,
+                                              tiering_migration_t *out_migration,
+                                              uvm_tracker_t *out_tracker)
+{
+    uvm_va_space_t *va_space = va_space_tiering->va_space;
+    uvm_service_block_context_t *service_context = va_space_tiering->service_context;
+    uvm_page_mask_t *pages = &service_context->block_context->caller_page_mask;
+    block_tiering_info_t *block_tiering;
+    const uvm_va_policy_t *policy;
+    uvm_va_block_region_t region;
+    uvm_processor_id_t dest_id;
+    uvm_make_resident_cause_t cause;
+    uvm_page_index_t page_index;
+    uvm_gpu_id_t gpu_id;
+    NvU64 max_pages;
+    NvU64 num_pages = 0;
+    NvU64 bytes;
+    NvU32 heat;
+    NV_STATUS status;
+    NV_STATUS tracker_status;
+
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    out_migration->bytes = 0;
+
+    // The block may have been destroyed while it was unlocked
+    block_tiering = tiering_info_get(va_block);
+    if (!block_tiering || uvm_va_block_is_dead(va_block))
+        return NV_OK;
+
+    heat = tiering_update_heat(block_tiering, NV_GETTIME());
+
+    // Stop tracking blocks that have cooled down completely and have nothing
+    // left to demote. They are tracked again on their next access.
+    if (heat == 0 && uvm_processor_mask_get_gpu_count(&va_block->resident) == 0) {
+        tiering_info_destroy(va_space_tiering, va_block);
+        return NV_OK;
+    }
+
+    if (budget < PAGE_SIZE)
+        return NV_OK;
+
+    policy = &va_block->managed_range->policy;
+
+    // Read duplication and thrashing mitigation already decide where the
+    // pages live
+    if (uvm_va_policy_is_read_duplicate(policy, va_space) || uvm_perf_thrashing_get_thrashing_pages(va_block))
+        return NV_OK;
+
+    if (heat <= g_uvm_perf_tiering_cold_threshold) {
+        gpu_id = tiering_demotion_gpu(va_space_tiering, va_block, policy, service_context->block_context);
+        if (UVM_ID_IS_INVALID(gpu_id))
+            return NV_OK;
+
+        uvm_page_mask_copy(pages, uvm_va_block_resident_mask_get(va_block, gpu_id, NUMA_NO_NODE));
+        dest_id = UVM_ID_CPU;
+        cause = UVM_MAKE_RESIDENT_CAUSE_TIERING_DEMOTION;
+    }
+    else if (heat >= g_uvm_perf_tiering_hot_threshold &&
+             tiering_can_promote(va_space_tiering, va_block, policy, block_tiering->last_processor)) {
+        gpu_id = block_tiering->last_processor;
+
+        uvm_page_mask_copy(pages, uvm_va_block_map_mask_get(va_block, gpu_id));
+        if (uvm_va_block_gpu_state_get(va_block, gpu_id))
+            uvm_page_mask_andnot(pages, pages, uvm_va_block_resident_mask_get(va_block, gpu_id, NUMA_NO_NODE));
+
+        dest_id = gpu_id;
+        cause = UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION;
+    }
+    else {
+        return NV_OK;
+    }
+
+    // Only migrate as much as the remaining budget allows
+    max_pages = budget / PAGE_SIZE;
+    for_each_va_block_page_in_mask(page_index, pages, va_block) {
+        if (num_pages++ >= max_pages)
+            uvm_page_mask_clear(pages, page_index);
+    }
+
+    if (num_pages == 0)
+        return NV_OK;
+
+    region = uvm_va_block_region_from_mask(va_block, pages);
+    if (!uvm_range_group_all_migratable(va_space,
+                                        uvm_va_block_region_start(va_block, region),
+                                        uvm_va_block_region_end(va_block, region)))
+        return NV_OK;
+
+    status = tiering_migrate_pages_locked(va_block,
+                                          va_block_retry,
+                                          service_context,
+                                          pages,
+                                          dest_id,
+                                          cause,
+                                          &bytes);
+
+    tracker_status = uvm_tracker_add_tracker_safe(out_tracker, &va_block->tracker);
+    if (status == NV_OK)
+        status = tracker_status;
+
+    if (status != NV_OK)
+        return status;
+
+    out_migration->gpu_id = gpu_id;
+    out_migration->bytes = bytes;
+    out_migration->promotion = (cause == UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION);
+
+    return NV_OK;
+}
+
+static void tiering_daemon(struct work_struct *work)
+{
+    struct delayed_work *dwork = to_delayed_work(work);
+    va_space_tiering_info_t *va_space_tiering = container_of(dwork, va_space_tiering_info_t, dwork);
+    uvm_va_space_t *va_space = va_space_tiering->va_space;
+    uvm_service_block_context_t *service_context = va_space_tiering->service_context;
+    uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    NvU64 budget = g_uvm_perf_tiering_batch_bytes;
+    struct mm_struct *mm;
+    uvm_gpu_t *gpu;
+    NvU32 num_blocks;
+    NvU32 i;
+
+    // The mmap_lock must be taken before the VA space lock. Holding the VA
+    // space lock also keeps the scanned blocks from being destroyed, since
+    // only managed blocks are tracked.
+    mm = uvm_va_space_mm_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    if (va_space_tiering->in_va_space_teardown)
+        goto out;
+
+    uvm_processor_mask_zero(&va_space_tiering->pressured_gpus);
+    for_each_va_space_gpu(gpu, va_space) {
+        if (tiering_gpu_under_pressure(gpu))
+            uvm_processor_mask_set(&va_space_tiering->pressured_gpus, gpu->id);
+    }
+
+    num_blocks = tiering_pick_blocks(va_space_tiering);
+    uvm_processor_mask_zero(&service_context->gpus_to_check_for_nvlink_errors);
+
+    for (i = 0; i < num_blocks; ++i) {
+        uvm_va_block_t *va_block = va_space_tiering->scan_blocks[i];
+        tiering_migration_t migration;
+        uvm_va_block_retry_t va_block_retry;
+        NV_STATUS status;
+
+        uvm_va_block_context_init(service_context->block_context, mm);
+
+        // The migration path is shared with the fault servicing paths, which
+        // check for prefetch information that is not used here
+        service_context->prefetch_hint.residency = UVM_ID_INVALID;
+
+        status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                         &va_block_retry,
+                                         tiering_service_block_locked(va_space_tiering,
+                                                                      va_block,
+                                                                      &va_block_retry,
+                                                                      budget,
+                                                                      &migration,
+                                                                      &tracker));
+
+        // The daemon is opportunistic, so blocks that fail to migrate are
+        // just skipped. Memory allocation failures are expected when vidmem
+        // is under pressure.
+        if (status != NV_OK || migration.bytes == 0)
+            continue;
+
+        if (migration.promotion)
+            atomic64_add(migration.bytes, &va_space_tiering->bytes_promoted);
+        else
+            atomic64_add(migration.bytes, &va_space_tiering->bytes_demoted);
+
+        budget -= min(budget, migration.bytes);
+    }
+
+    // Wait for the migrations of this period, so that the next period does
+    // not queue more copies behind them
+    (void)uvm_tracker_wait_deinit(&tracker);
+
+    uvm_spin_lock(&va_space_tiering->lock);
+
+    if (va_space_tiering->num_blocks > 0)
+        schedule_delayed_work(&va_space_tiering->dwork, g_uvm_perf_tiering_period_jiffies);
+
+    uvm_spin_unlock(&va_space_tiering->lock);
+
+out:
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_release_unlock(va_space, mm);
+}
+
+static void tiering_daemon_entry(struct work_struct *work)
+{
+    UVM_ENTRY_VOID(tiering_daemon(work));
+}
+
+static void va_space_tiering_info_destroy(uvm_va_space_t *va_space)
+{
+    va_space_tiering_info_t *va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+
+    if (!va_space_tiering)
+        return;
+
+    uvm_perf_module_type_unset_data(va_space->perf_modules_data, UVM_PERF_MODULE_TYPE_TIERING);
+    uvm_service_block_context_free(va_space_tiering->service_context);
+    uvm_kvfree(va_space_tiering->scan_blocks);
+    uvm_kvfree(va_space_tiering);
+}
+
+NV_STATUS uvm_perf_tiering_load(uvm_va_space_t *va_space)
+{
+    va_space_tiering_info_t *va_space_tiering;
+    NV_STATUS status;
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (!g_uvm_perf_tiering_enable)
+        return NV_OK;
+
+    va_space_tiering = uvm_kvmalloc_zero(sizeof(*va_space_tiering));
+    if (!va_space_tiering)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_perf_module_type_set_data(va_space->perf_modules_data, va_space_tiering, UVM_PERF_MODULE_TYPE_TIERING);
+
+    va_space_tiering->va_space = va_space;
+    INIT_LIST_HEAD(&va_space_tiering->blocks);
+    uvm_spin_lock_init(&va_space_tiering->lock, UVM_LOCK_ORDER_LEAF);
+    INIT_DELAYED_WORK(&va_space_tiering->dwork, tiering_daemon_entry);
+
+    va_space_tiering->scan_blocks = uvm_kvmalloc(g_uvm_perf_tiering_max_scan * sizeof(*va_space_tiering->scan_blocks));
+    va_space_tiering->service_context = uvm_service_block_context_alloc(NULL);
+    if (!va_space_tiering->scan_blocks || !va_space_tiering->service_context) {
+        va_space_tiering_info_destroy(va_space);
+        return NV_ERR_NO_MEMORY;
+    }
+
+    // Register the module last, so that failing to set up the VA space state
+    // doesn't leave the event callbacks registered.
+    status = uvm_perf_module_load(&g_module_tiering, va_space);
+    if (status != NV_OK)
+        va_space_tiering_info_destroy(va_space);
+
+    return status;
+}
+
+void uvm_perf_tiering_stop(uvm_va_space_t *va_space)
+{
+    va_space_tiering_info_t *va_space_tiering;
+
+    if (!g_uvm_perf_tiering_enable)
+        return;
+
+    uvm_va_space_down_write(va_space);
+    va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+
+    // Prevent the daemon from being scheduled again
+    if (va_space_tiering)
+        va_space_tiering->in_va_space_teardown = true;
+
+    uvm_va_space_up_write(va_space);
+
+    // Cancel any pending work. va_space_tiering can be safely accessed because
+    // it is only freed by uvm_perf_tiering_unload, which is called later in
+    // the teardown path.
+    if (va_space_tiering)
+        (void)cancel_delayed_work_sync(&va_space_tiering->dwork);
+}
+
+void uvm_perf_tiering_unload(uvm_va_space_t *va_space)
+{
+    va_space_tiering_info_t *va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    if (!g_uvm_perf_tiering_enable)
+        return;
+
+    // Unloading the module destroys the tiering state of all blocks
+    uvm_perf_module_unload(&g_module_tiering, va_space);
+
+    if (va_space_tiering) {
+        UVM_ASSERT(list_empty(&va_space_tiering->blocks));
+        UVM_ASSERT(va_space_tiering->num_blocks == 0);
+
+        va_space_tiering_info_destroy(va_space);
+    }
+}
+
+// Return value if it is within [min_value, max_value], or the default value
+// otherwise
+static unsigned tiering_param_in_range(const char *name,
+                                       unsigned value,
+                                       unsigned min_value,
+                                       unsigned max_value,
+                                       unsigned default_value)
+{
+    if (value >= min_value && value <= max_value)
+        return value;
+
+    UVM_INFO_PRINT("Invalid value %u for %s. Using %u instead\n", value, name, default_value);
+
+    return default_value;
+}
+
+NV_STATUS uvm_perf_tiering_init(void)
+{
+    unsigned value;
+
+    g_uvm_perf_tiering_enable = uvm_perf_tiering_enable != 0;
+
+    value = tiering_param_in_range("uvm_perf_tiering_period_msec",
+                                   uvm_perf_tiering_period_msec,
+                                   UVM_PERF_TIERING_PERIOD_MSEC_MIN,
+                                   UVM_PERF_TIERING_PERIOD_MSEC_MAX,
+                                   UVM_PERF_TIERING_PERIOD_MSEC_DEFAULT);
+    g_uvm_perf_tiering_period_jiffies = msecs_to_jiffies(value);
+
+    value = tiering_param_in_range("uvm_perf_tiering_half_life_msec",
+                                   uvm_perf_tiering_half_life_msec,
+                                   1,
+                                   UVM_PERF_TIERING_HALF_LIFE_MSEC_MAX,
+                                   UVM_PERF_TIERING_HALF_LIFE_MSEC_DEFAULT);
+    g_uvm_perf_tiering_half_life_ns = (NvU64)value * 1000 * 1000;
+
+    g_uvm_perf_tiering_high_watermark = tiering_param_in_range("uvm_perf_tiering_high_watermark",
+                                                               uvm_perf_tiering_high_watermark,
+                                                               1,
+                                                               100,
+                                                               UVM_PERF_TIERING_HIGH_WATERMARK_DEFAULT);
+
+    value = tiering_param_in_range("uvm_perf_tiering_batch_mb",
+                                   uvm_perf_tiering_batch_mb,
+                                   1,
+                                   UVM_PERF_TIERING_BATCH_MB_MAX,
+                                   UVM_PERF_TIERING_BATCH_MB_DEFAULT);
+    g_uvm_perf_tiering_batch_bytes = (NvU64)value * 1024 * 1024;
+
+    g_uvm_perf_tiering_max_scan = tiering_param_in_range("uvm_perf_tiering_max_scan",
+                                                         uvm_perf_tiering_max_scan,
+                                                         1,
+                                                         UVM_PERF_TIERING_MAX_SCAN_MAX,
+                                                         UVM_PERF_TIERING_MAX_SCAN_DEFAULT);
+
+    if (uvm_perf_tiering_cold_threshold < uvm_perf_tiering_hot_threshold) {
+        g_uvm_perf_tiering_cold_threshold = uvm_perf_tiering_cold_threshold;
+        g_uvm_perf_tiering_hot_threshold = uvm_perf_tiering_hot_threshold;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid values %u/%u for uvm_perf_tiering_cold_threshold/uvm_perf_tiering_hot_threshold. "
+                       "Using %u/%u instead\n",
+                       uvm_perf_tiering_cold_threshold,
+                       uvm_perf_tiering_hot_threshold,
+                       UVM_PERF_TIERING_COLD_THRESHOLD_DEFAULT,
+                       UVM_PERF_TIERING_HOT_THRESHOLD_DEFAULT);
+
+        g_uvm_perf_tiering_cold_threshold = UVM_PERF_TIERING_COLD_THRESHOLD_DEFAULT;
+        g_uvm_perf_tiering_hot_threshold = UVM_PERF_TIERING_HOT_THRESHOLD_DEFAULT;
+    }
+
+    if (!g_uvm_perf_tiering_enable)
+        return NV_OK;
+
+    g_block_tiering_info_cache = NV_KMEM_CACHE_CREATE("uvm_block_tiering_info_t", block_tiering_info_t);
+    if (!g_block_tiering_info_cache)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_perf_module_init("perf_tiering",
+                         UVM_PERF_MODULE_TYPE_TIERING,
+                         g_callbacks_tiering,
+                         ARRAY_SIZE(g_callbacks_tiering),
+                         &g_module_tiering);
+
+    return NV_OK;
+}
+
+void uvm_perf_tiering_exit(void)
+{
+    kmem_cache_destroy_safe(&g_block_tiering_info_cache);
+}
+
+static NV_STATUS test_tiering_decay_heat(void)
+{
+    const NvU64 half_life_ns = 1000 * 1000;
+    NvU32 prev_heat = 1024;
+    NvU64 elapsed_ns;
+
+    TEST_CHECK_RET(tiering_decay_heat(1024, 0, half_life_ns) == 1024);
+    TEST_CHECK_RET(tiering_decay_heat(1024, half_life_ns, half_life_ns) == 512);
+    TEST_CHECK_RET(tiering_decay_heat(1024, 2 * half_life_ns, half_life_ns) == 256);
+    TEST_CHECK_RET(tiering_decay_heat(1024, half_life_ns / 2, half_life_ns) == 768);
+    TEST_CHECK_RET(tiering_decay_heat(U32_MAX, 31 * half_life_ns, half_life_ns) == 1);
+    TEST_CHECK_RET(tiering_decay_heat(U32_MAX, 32 * half_life_ns, half_life_ns) == 0);
+    TEST_CHECK_RET(tiering_decay_heat(U32_MAX, ~0ULL, half_life_ns) == 0);
+
+    // Heat never increases over time
+    for (elapsed_ns = 0; elapsed_ns <= 12 * half_life_ns; elapsed_ns += half_life_ns / 16) {
+        NvU32 heat = tiering_decay_heat(1024, elapsed_ns, half_life_ns);
+
+        TEST_CHECK_RET(heat <= prev_heat);
+        prev_heat = heat;
+    }
+
+    TEST_CHECK_RET(prev_heat == 0);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_tiering_heat_up(void)
+{
+    block_tiering_info_t block_tiering;
+    NvU64 now = NV_GETTIME();
+
+    memset(&block_tiering, 0, sizeof(block_tiering));
+    block_tiering.last_processor = UVM_ID_INVALID;
+    block_tiering.last_update_time_stamp = now;
+
+    tiering_heat_up(&block_tiering, UVM_ID_CPU, 10);
+    TEST_CHECK_RET(block_tiering.heat <= 10);
+    TEST_CHECK_RET(block_tiering.heat > 0);
+    TEST_CHECK_RET(uvm_id_equal(block_tiering.last_processor, UVM_ID_CPU));
+
+    // Heat saturates
+    block_tiering.heat = U32_MAX;
+    block_tiering.last_update_time_stamp = NV_GETTIME();
+    tiering_heat_up(&block_tiering, uvm_gpu_id_from_index(0), U32_MAX);
+    TEST_CHECK_RET(block_tiering.heat >= U32_MAX / 2);
+    TEST_CHECK_RET(uvm_id_equal(block_tiering.last_processor, uvm_gpu_id_from_index(0)));
+
+    // Time going backwards does not change the heat
+    block_tiering.heat = 100;
+    block_tiering.last_update_time_stamp = ~0ULL;
+    TEST_CHECK_RET(tiering_update_heat(&block_tiering, now) == 100);
+
+    return NV_OK;
+}
+
+// Migrate the sparse pages to dest_id and check that exactly those pages
+// changed residency, leaving dest_id with expected_resident.
+static NV_STATUS test_tiering_migrate_sparse_locked(uvm_va_block_t *va_block,
+                                                    uvm_va_block_retry_t *va_block_retry,
+                                                    uvm_service_block_context_t *service_context,
+                                                    const uvm_page_mask_t *sparse,
+                                                    uvm_processor_id_t dest_id,
+                                                    uvm_make_resident_cause_t cause,
+                                                    const uvm_page_mask_t *expected_resident)
+{
+    uvm_page_mask_t *pages = &service_context->block_context->caller_page_mask;
+    NvU64 bytes;
+    NV_STATUS status;
+
+    uvm_page_mask_copy(pages, sparse);
+    status = tiering_migrate_pages_locked(va_block, va_block_retry, service_context, pages, dest_id, cause, &bytes);
+    if (status != NV_OK)
+        return status;
+
+    TEST_CHECK_RET(bytes == (NvU64)uvm_page_mask_weight(sparse) * PAGE_SIZE);
+    TEST_CHECK_RET(uvm_page_mask_equal(uvm_va_block_resident_mask_get(va_block, dest_id, NUMA_NO_NODE),
+                                       expected_resident));
+
+    // Promoted pages must be mapped on the GPU again
+    if (cause == UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION)
+        TEST_CHECK_RET(uvm_page_mask_subset(sparse, uvm_va_block_map_mask_get(va_block, dest_id)));
+
+    return uvm_tracker_wait(&va_block->tracker);
+}
+
+static NV_STATUS test_tiering_sparse_migrate(uvm_va_block_t *va_block,
+                                            uvm_service_block_context_t *service_context,
+                                            uvm_gpu_t *gpu)
+{
+    uvm_page_mask_t *gpu_resident = NULL;
+    uvm_page_mask_t *sparse = NULL;
+    uvm_page_mask_t *remaining = NULL;
+    uvm_va_block_retry_t va_block_retry;
+    uvm_page_index_t page_index;
+    NV_STATUS status = NV_OK;
+
+    gpu_resident = uvm_kvmalloc(sizeof(*gpu_resident));
+    sparse = uvm_kvmalloc(sizeof(*sparse));
+    remaining = uvm_kvmalloc(sizeof(*remaining));
+    if (!gpu_resident || !sparse || !remaining) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    uvm_mutex_lock(&va_block->lock);
+    if (uvm_processor_mask_test(&va_block->resident, UVM_ID_CPU))
+        status = NV_ERR_INVALID_STATE;
+    else
+        uvm_page_mask_copy(gpu_resident, uvm_va_block_resident_mask_get(va_block, gpu->id, NUMA_NO_NODE));
+    uvm_mutex_unlock(&va_block->lock);
+
+    if (status != NV_OK)
+        goto out;
+
+    // Every other page resident on the GPU
+    uvm_page_mask_zero(sparse);
+    for_each_va_block_page_in_mask(page_index, gpu_resident, va_block) {
+        if (page_index % 2 == 0)
+            uvm_page_mask_set(sparse, page_index);
+    }
+
+    if (!uvm_page_mask_andnot(remaining, gpu_resident, sparse)) {
+        status = NV_ERR_INVALID_STATE;
+        goto out;
+    }
+
+    // Demoting must move the sparse pages to the CPU and nothing else
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     test_tiering_migrate_sparse_locked(va_block,
+                                                                        &va_block_retry,
+                                                                        service_context,
+                                                                        sparse,
+                                                                        UVM_ID_CPU,
+                                                                        UVM_MAKE_RESIDENT_CAUSE_TIERING_DEMOTION,
+                                                                        sparse));
+    if (status != NV_OK)
+        goto out;
+
+    uvm_mutex_lock(&va_block->lock);
+    if (!uvm_page_mask_equal(uvm_va_block_resident_mask_get(va_block, gpu->id, NUMA_NO_NODE), remaining)) {
+        UVM_TEST_PRINT("Tiering demotion moved pages outside of the mask\n");
+        status = NV_ERR_INVALID_STATE;
+    }
+    uvm_mutex_unlock(&va_block->lock);
+
+    if (status != NV_OK)
+        goto out;
+
+    // Promoting them back must restore the original GPU residency
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     test_tiering_migrate_sparse_locked(va_block,
+                                                                        &va_block_retry,
+                                                                        service_context,
+                                                                        sparse,
+                                                                        gpu->id,
+                                                                        UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION,
+                                                                        gpu_resident));
+    if (status != NV_OK)
+        goto out;
+
+    uvm_mutex_lock(&va_block->lock);
+    if (!uvm_page_mask_empty(uvm_va_block_resident_mask_get(va_block, UVM_ID_CPU, NUMA_NO_NODE))) {
+        UVM_TEST_PRINT("Tiering promotion left pages resident on the CPU\n");
+        status = NV_ERR_INVALID_STATE;
+    }
+    uvm_mutex_unlock(&va_block->lock);
+
+out:
+    uvm_kvfree(remaining);
+    uvm_kvfree(sparse);
+    uvm_kvfree(gpu_resident);
+
+    return status;
+}
+
+NV_STATUS uvm_test_perf_tiering_sparse_migrate(UVM_TEST_PERF_TIERING_SPARSE_MIGRATE_PARAMS *params,
+                                               struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_service_block_context_t *service_context = NULL;
+    uvm_va_block_t *va_block;
+    struct mm_struct *mm;
+    uvm_gpu_t *gpu;
+    NV_STATUS status;
+
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto out;
+    }
+
+    status = uvm_va_block_find(va_space, params->lookup_address, &va_block);
+    if (status != NV_OK)
+        goto out;
+
+    if (uvm_va_block_is_hmm(va_block)) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    service_context = uvm_service_block_context_alloc(mm);
+    if (!service_context) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    service_context->prefetch_hint.residency = UVM_ID_INVALID;
+    uvm_processor_mask_zero(&service_context->gpus_to_check_for_nvlink_errors);
+
+    status = test_tiering_sparse_migrate(va_block, service_context, gpu);
+
+    uvm_service_block_context_free(service_context);
+
+out:
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+    return status;
+}
+
+NV_STATUS uvm_test_perf_tiering_stats(UVM_TEST_PERF_TIERING_STATS_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    va_space_tiering_info_t *va_space_tiering;
+
+    uvm_va_space_down_read(va_space);
+
+    va_space_tiering = va_space_tiering_info_get_or_null(va_space);
+    params->enabled = va_space_tiering != NULL;
+    params->bytes_promoted = va_space_tiering ? atomic64_read(&va_space_tiering->bytes_promoted) : 0;
+    params->bytes_demoted = va_space_tiering ? atomic64_read(&va_space_tiering->bytes_demoted) : 0;
+
+    uvm_va_space_up_read(va_space);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_perf_tiering_sanity(UVM_TEST_PERF_TIERING_SANITY_PARAMS *params, struct file *filp)
+{
+    TEST_NV_CHECK_RET(test_tiering_decay_heat());
+    TEST_NV_CHECK_RET(test_tiering_heat_up());
+
+    return NV_OK;
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#ifndef __UVM_PERF_TIERING_H__
+#define __UVM_PERF_TIERING_H__
+
+#include "uvm_linux.h"
+#include "uvm_forward_decl.h"
+#include "uvm_processors.h"
+
+// The tiering daemon migrates memory between vidmem and sysmem in the
+// background, instead of waiting for faults or access counter notifications
+// to do so on the critical path.
+//
+// Every managed VA block accessed by a processor gets a heat score, which is
+// increased by fault events and by access counter notifications, and decays
+// exponentially over time. A per-VA space delayed work item periodically
+// scans a bounded number of the tracked blocks and:
+// - Demotes cold blocks to sysmem, if they are resident on a GPU whose vidmem
+//   usage is above the high watermark.
+// - Promotes hot blocks that are remote-mapped by the GPU that accesses them
+//   the most, if that GPU is not under pressure. Promotions and demotions
+//   are limited to a number of bytes per period, so that the daemon does not
+//   steal the copy engine bandwidth needed by fault servicing.
+//
+// The bytes promoted and demoted by the daemon are reported through
+// UVM_TEST_PERF_TIERING_STATS.
+
+// Global initialization/cleanup functions.
+NV_STATUS uvm_perf_tiering_init(void);
+void uvm_perf_tiering_exit(void);
+
+// Per-VA space initialization/cleanup, called from the perf heuristics
+// load/stop/unload functions.
+//
+// Locking: the VA space lock must be held in write mode for load and unload,
+// and must not be held for stop.
+NV_STATUS uvm_perf_tiering_load(uvm_va_space_t *va_space);
+void uvm_perf_tiering_stop(uvm_va_space_t *va_space);
+void uvm_perf_tiering_unload(uvm_va_space_t *va_space);
+
+// Heat up the given block with num_pages pages accessed by the given GPU,
+// as reported by access counter notifications.
+//
+// Locking: the caller must hold the VA space lock and the VA block lock.
+void uvm_perf_tiering_record_access_counters(uvm_va_block_t *va_block, uvm_gpu_id_t gpu_id, NvU32 num_pages);
+
+#endif
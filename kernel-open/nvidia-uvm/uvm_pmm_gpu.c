@@ -1405,10 +1405,29 @@ static void chunk_start_eviction(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
 
     list_del_init(&chunk->list);
     uvm_gpu_chunk_set_in_eviction(chunk, true);
+
+    uvm_pmm_eviction_on_evict(&pmm->root_chunks.eviction, &root_chunk->eviction);
+}
+
+// Identity of the data backed by a root chunk of a VA block, used by the
+// eviction policy to recognize the data if it comes back after eviction.
+static NvU64 root_chunk_eviction_key(uvm_va_block_t *va_block)
+{
+    // VA blocks using root chunks are UVM_CHUNK_SIZE_MAX aligned, so the
+    // lowest bit is always free to make the key non-zero.
+    return (va_block->start ^ (NvU64)(uintptr_t)uvm_va_block_get_va_space(va_block)) | 1;
 }
 
 static void root_chunk_update_eviction_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk, uvm_pmm_alloc_list_t alloc_list)
 {
+    uvm_pmm_eviction_policy_t policy = UVM_PMM_EVICTION_POLICY_LRU;
+    NvU64 key = 0;
+
+    if (alloc_list == UVM_PMM_ALLOC_LIST_USED && chunk->va_block) {
+        policy = uvm_va_block_get_va_space(chunk->va_block)->pmm_eviction_policy;
+        key = root_chunk_eviction_key(chunk->va_block);
+    }
+
     uvm_spin_lock(&pmm->list_lock);
 
     UVM_ASSERT(uvm_gpu_chunk_get_size(chunk) == UVM_CHUNK_SIZE_MAX);
@@ -1422,6 +1441,38 @@ static void root_chunk_update_eviction_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t
         UVM_ASSERT(!list_empty(&chunk->list));
 
         list_move_tail(&chunk->list, &pmm->root_chunks.alloc_list[alloc_list]);
+
+        if (key != 0) {
+            uvm_pmm_eviction_on_use(&pmm->root_chunks.eviction,
+                                    &root_chunk_from_chunk(pmm, chunk)->eviction,
+                                    policy,
+                                    key);
+        }
+    }
+
+    uvm_spin_unlock(&pmm->list_lock);
+}
+
+static void root_chunk_update_eviction_state(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk, bool hot)
+{
+    uvm_gpu_root_chunk_t *root_chunk = root_chunk_from_chunk(pmm, chunk);
+
+    UVM_ASSERT(uvm_gpu_chunk_get_size(chunk) == UVM_CHUNK_SIZE_MAX);
+    UVM_ASSERT(uvm_gpu_chunk_is_user(chunk));
+
+    // Only frequency-aware policies track accesses. The policy of the chunk
+    // is read without the lock to keep the LRU policy free of any overhead.
+    // A stale value only means that a single access is missed.
+    if (READ_ONCE(root_chunk->eviction.policy) == UVM_PMM_EVICTION_POLICY_LRU)
+        return;
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    if (!chunk_is_root_chunk_pinned(pmm, chunk) && !chunk_is_in_eviction(pmm, chunk)) {
+        if (hot)
+            uvm_pmm_eviction_on_hint(&pmm->root_chunks.eviction, &root_chunk->eviction);
+        else
+            uvm_pmm_eviction_on_access(&pmm->root_chunks.eviction, &root_chunk->eviction);
     }
 
     uvm_spin_unlock(&pmm->list_lock);
@@ -1432,6 +1483,16 @@ void uvm_pmm_gpu_mark_root_chunk_used(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk
     root_chunk_update_eviction_list(pmm, chunk, UVM_PMM_ALLOC_LIST_USED);
 }
 
+void uvm_pmm_gpu_mark_root_chunk_accessed(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
+{
+    root_chunk_update_eviction_state(pmm, chunk, false);
+}
+
+void uvm_pmm_gpu_mark_root_chunk_hot(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
+{
+    root_chunk_update_eviction_state(pmm, chunk, true);
+}
+
 void uvm_pmm_gpu_mark_root_chunk_unused(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
 {
     root_chunk_update_eviction_list(pmm, chunk, UVM_PMM_ALLOC_LIST_UNUSED);
@@ -1459,14 +1520,35 @@ static uvm_pmm_alloc_list_t get_alloc_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *
     return UVM_PMM_ALLOC_LIST_COUNT;
 }
 
-static uvm_gpu_chunk_t *get_first_allocated_chunk(uvm_pmm_gpu_t *pmm)
+static uvm_pmm_eviction_state_t *root_chunk_eviction_state(struct list_head *node)
+{
+    uvm_gpu_chunk_t *chunk = list_entry(node, uvm_gpu_chunk_t, list);
+
+    return &container_of(chunk, uvm_gpu_root_chunk_t, chunk)->eviction;
+}
+
+static uvm_gpu_chunk_t *pick_allocated_chunk(uvm_pmm_gpu_t *pmm)
 {
     uvm_pmm_alloc_list_t alloc_list;
 
     uvm_assert_spinlock_locked(&pmm->list_lock);
 
     for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++) {
-        uvm_gpu_chunk_t *chunk = list_first_chunk(&pmm->root_chunks.alloc_list[alloc_list]);
+        struct list_head *list = &pmm->root_chunks.alloc_list[alloc_list];
+        uvm_gpu_chunk_t *chunk;
+
+        // Only used chunks hold data worth protecting, so the eviction policy
+        // is not consulted for the other lists.
+        if (alloc_list == UVM_PMM_ALLOC_LIST_USED) {
+            struct list_head *node = uvm_pmm_eviction_pick(&pmm->root_chunks.eviction,
+                                                           list,
+                                                           root_chunk_eviction_state);
+            chunk = node ? list_entry(node, uvm_gpu_chunk_t, list) : NULL;
+        }
+        else {
+            chunk = list_first_chunk(list);
+        }
+
         if (chunk)
             return chunk;
     }
@@ -1501,7 +1583,7 @@ static uvm_gpu_root_chunk_t *pick_root_chunk_to_evict(uvm_pmm_gpu_t *pmm)
     // TODO: Bug 1765193: Move the chunks to the tail of the used list whenever
     // they get mapped.
     if (!chunk)
-        chunk = get_first_allocated_chunk(pmm);
+        chunk = pick_allocated_chunk(pmm);
 
     if (chunk)
         chunk_start_eviction(pmm, chunk);
@@ -1976,7 +2058,24 @@ NV_STATUS alloc_root_chunk(uvm_pmm_gpu_t *pmm,
     // flush out any pending allocs.
     uvm_down_read(&pmm->pma_lock);
 
-    status = nvUvmInterfacePmaAllocPages(pmm->pma, num_chunks, UVM_CHUNK_SIZE_MAX, &options, pas);
+    if (used_kmem_cache) {
+        UvmPmaAllocationRequest request = {
+            .pageCount = num_chunks,
+            .pageSize = UVM_CHUNK_SIZE_MAX,
+            .options = options,
+            .pPages = pas,
+        };
+
+        // The batch interface allocates the whole batch under a single hold
+        // of the PMA lock, and marks physically contiguous chunks with a
+        // single range update.
+        status = nvUvmInterfacePmaAllocPagesBatch(pmm->pma, &request, 1);
+        options = request.options;
+    }
+    else {
+        status = nvUvmInterfacePmaAllocPages(pmm->pma, num_chunks, UVM_CHUNK_SIZE_MAX, &options, pas);
+    }
+
     if (status != NV_OK)
         goto exit_unlock;
 
@@ -2020,16 +2119,16 @@ exit_unlock:
     return status;
 }
 
-void free_root_chunk(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, free_root_chunk_mode_t free_mode)
+// Waits for the pending work on a TEMP_PINNED root chunk and hands it over to
+// PMA as far as PMM's state is concerned. The caller must hold the PMA lock in
+// read mode, and is responsible for freeing the chunk back to PMA if needed.
+static void root_chunk_make_pma_owned(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk)
 {
     NV_STATUS status;
     uvm_gpu_t *gpu = uvm_pmm_to_gpu(pmm);
     uvm_gpu_chunk_t *chunk = &root_chunk->chunk;
-    NvU32 flags = 0;
 
-    // Acquire the PMA lock for read so that uvm_pmm_gpu_pma_evict_range() can
-    // flush out any pending frees.
-    uvm_down_read(&pmm->pma_lock);
+    uvm_assert_rwsem_locked_read(&pmm->pma_lock);
 
     root_chunk_lock(pmm, root_chunk);
 
@@ -2054,6 +2153,18 @@ void free_root_chunk(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, free_
     uvm_spin_unlock(&pmm->list_lock);
 
     root_chunk_unlock(pmm, root_chunk);
+}
+
+void free_root_chunk(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, free_root_chunk_mode_t free_mode)
+{
+    uvm_gpu_chunk_t *chunk = &root_chunk->chunk;
+    NvU32 flags = 0;
+
+    // Acquire the PMA lock for read so that uvm_pmm_gpu_pma_evict_range() can
+    // flush out any pending frees.
+    uvm_down_read(&pmm->pma_lock);
+
+    root_chunk_make_pma_owned(pmm, root_chunk);
 
     if (free_mode == FREE_ROOT_CHUNK_MODE_SKIP_PMA_FREE) {
         uvm_up_read(&pmm->pma_lock);
@@ -2276,6 +2387,9 @@ static void chunk_free_locked(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
     chunk->va_block = NULL;
     chunk->is_zero = false;
 
+    if (!chunk->parent)
+        uvm_pmm_eviction_state_reset(&pmm->root_chunks.eviction, &root_chunk->eviction);
+
     if (chunk->state == UVM_PMM_GPU_CHUNK_STATE_TEMP_PINNED)
         chunk_unpin(pmm, chunk, UVM_PMM_GPU_CHUNK_STATE_FREE);
     else
@@ -2457,6 +2571,103 @@ bool free_next_available_root_chunk(uvm_pmm_gpu_t *pmm, uvm_pmm_gpu_memory_type_
     return false;
 }
 
+// Moves up to max_chunks free root chunks of the given type from the free list
+// of the given zero type to addresses, pinning them temporarily like
+// free_next_available_root_chunk does. Returns the number of chunks taken.
+static NvU32 take_free_root_chunks(uvm_pmm_gpu_t *pmm,
+                                   uvm_pmm_gpu_memory_type_t type,
+                                   uvm_pmm_list_zero_t zero_type,
+                                   UvmGpuPointer *addresses,
+                                   NvU32 max_chunks)
+{
+    struct list_head *free_list = find_free_list(pmm, type, UVM_CHUNK_SIZE_MAX, zero_type);
+    uvm_gpu_chunk_t *chunk;
+    NvU32 count = 0;
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    while (count < max_chunks && (chunk = list_first_chunk(free_list))) {
+        list_del_init(&chunk->list);
+        UVM_ASSERT(chunk->state == UVM_PMM_GPU_CHUNK_STATE_FREE);
+        UVM_ASSERT(chunk->is_zero == (zero_type == UVM_PMM_LIST_ZERO));
+        UVM_ASSERT(chunk->type == type);
+
+        chunk_pin(pmm, chunk);
+        addresses[count++] = chunk->address;
+    }
+
+    uvm_spin_unlock(&pmm->list_lock);
+
+    return count;
+}
+
+// Frees a batch of the root chunks of the given type that sit in the free
+// lists back to PMA, with a single call to nvUvmInterfacePmaFreePagesBatch.
+// Returns true if any root chunk was freed, or false otherwise.
+static bool free_available_root_chunks_batch(uvm_pmm_gpu_t *pmm, uvm_pmm_gpu_memory_type_t type)
+{
+    const NvU32 max_chunks = 1 << uvm_perf_pma_batch_nonpinned_order;
+    UvmPmaFreeRequest requests[UVM_PMM_LIST_ZERO_COUNT];
+    NvLength num_requests = 0;
+    UvmGpuPointer *addresses;
+    NvU32 num_non_zero;
+    NvU32 num_chunks;
+    NvU32 i;
+
+    UVM_ASSERT(uvm_chunk_find_last_size(pmm->chunk_sizes[type]) == UVM_CHUNK_SIZE_MAX);
+
+    // The cache doesn't exist if PMM initialization failed before creating it
+    if (!g_pma_address_batch_cache_ref.cache)
+        return free_next_available_root_chunk(pmm, type);
+
+    addresses = kmem_cache_alloc(g_pma_address_batch_cache_ref.cache, NV_UVM_GFP_FLAGS);
+    if (!addresses)
+        return free_next_available_root_chunk(pmm, type);
+
+    // Non-zero chunks go first, so that each request has a single zero flag
+    num_non_zero = take_free_root_chunks(pmm, type, UVM_PMM_LIST_NO_ZERO, addresses, max_chunks);
+    num_chunks = num_non_zero + take_free_root_chunks(pmm,
+                                                      type,
+                                                      UVM_PMM_LIST_ZERO,
+                                                      addresses + num_non_zero,
+                                                      max_chunks - num_non_zero);
+
+    if (num_chunks > 0) {
+        // Acquire the PMA lock for read so that uvm_pmm_gpu_pma_evict_range()
+        // can flush out any pending frees.
+        uvm_down_read(&pmm->pma_lock);
+
+        for (i = 0; i < num_chunks; ++i)
+            root_chunk_make_pma_owned(pmm, root_chunk_from_address(pmm, addresses[i]));
+
+        if (num_non_zero > 0) {
+            requests[num_requests++] = (UvmPmaFreeRequest) {
+                .pPages = addresses,
+                .pageCount = num_non_zero,
+                .pageSize = UVM_CHUNK_SIZE_MAX,
+                .flags = 0,
+            };
+        }
+
+        if (num_chunks > num_non_zero) {
+            requests[num_requests++] = (UvmPmaFreeRequest) {
+                .pPages = addresses + num_non_zero,
+                .pageCount = num_chunks - num_non_zero,
+                .pageSize = UVM_CHUNK_SIZE_MAX,
+                .flags = UVM_PMA_FREE_IS_ZERO,
+            };
+        }
+
+        nvUvmInterfacePmaFreePagesBatch(pmm->pma, requests, num_requests);
+
+        uvm_up_read(&pmm->pma_lock);
+    }
+
+    kmem_cache_free(g_pma_address_batch_cache_ref.cache, addresses);
+
+    return num_chunks > 0;
+}
+
 // Get free list for the given chunk size and type
 struct list_head *find_free_list(uvm_pmm_gpu_t *pmm,
                                  uvm_pmm_gpu_memory_type_t type,
@@ -3448,6 +3659,8 @@ NV_STATUS uvm_pmm_gpu_init(uvm_pmm_gpu_t *pmm)
     for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++)
         INIT_LIST_HEAD(&pmm->root_chunks.alloc_list[alloc_list]);
 
+    uvm_pmm_eviction_init(&pmm->root_chunks.eviction);
+
     INIT_LIST_HEAD(&pmm->root_chunks.va_block_lazy_free);
     nv_kthread_q_item_init(&pmm->root_chunks.va_block_lazy_free_q_item, process_lazy_free_entry, pmm);
 
@@ -3544,7 +3757,7 @@ static void release_free_root_chunks(uvm_pmm_gpu_t *pmm)
     for (type = 0; type < UVM_PMM_GPU_MEMORY_TYPE_COUNT; ++type) {
         uvm_pmm_list_zero_t zero_type;
 
-        while (free_next_available_root_chunk(pmm, type))
+        while (free_available_root_chunks_batch(pmm, type))
             ;
 
         for (zero_type = 0; zero_type < UVM_PMM_LIST_ZERO_COUNT; ++zero_type)
@@ -3846,6 +4059,289 @@ out:
     return status;
 }
 
+static NvU64 test_pma_batch_page_size(UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS *params, NvU32 i)
+{
+    if (params->mixed_page_sizes && (i & 1))
+        return UVM_PAGE_SIZE_2M;
+
+    return params->page_size;
+}
+
+static NvU32 test_pma_batch_free_flags(UvmPmaAllocationOptions *options)
+{
+    return (options->resultFlags & UVM_PMA_ALLOCATE_RESULT_IS_ZERO) ? UVM_PMA_FREE_IS_ZERO : 0;
+}
+
+static NV_STATUS test_pma_batch_single(uvm_gpu_t *gpu,
+                                       UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS *params,
+                                       UvmPmaAllocationRequest *requests,
+                                       NvU64 *alloc_ns,
+                                       NvU64 *free_ns)
+{
+    NV_STATUS status = NV_OK;
+    NvU64 start;
+    NvU32 allocated;
+    NvU32 i;
+
+    start = NV_GETTIME();
+    for (allocated = 0; allocated < params->num_requests; allocated++) {
+        UvmPmaAllocationRequest *request = &requests[allocated];
+
+        status = nvUvmInterfacePmaAllocPages(gpu->pmm.pma,
+                                             request->pageCount,
+                                             request->pageSize,
+                                             &request->options,
+                                             request->pPages);
+        if (status != NV_OK)
+            break;
+    }
+    *alloc_ns += NV_GETTIME() - start;
+
+    start = NV_GETTIME();
+    for (i = 0; i < allocated; i++) {
+        UvmPmaAllocationRequest *request = &requests[i];
+
+        nvUvmInterfacePmaFreePages(gpu->pmm.pma,
+                                   request->pPages,
+                                   request->pageCount,
+                                   request->pageSize,
+                                   test_pma_batch_free_flags(&request->options));
+    }
+    *free_ns += NV_GETTIME() - start;
+
+    return status;
+}
+
+static NV_STATUS test_pma_batch_batched(uvm_gpu_t *gpu,
+                                        UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS *params,
+                                        UvmPmaAllocationRequest *requests,
+                                        UvmPmaFreeRequest *free_requests,
+                                        NvU64 *alloc_ns,
+                                        NvU64 *free_ns)
+{
+    NV_STATUS status;
+    NvU64 start;
+    NvU32 count = 0;
+    NvU32 i;
+
+    start = NV_GETTIME();
+    status = nvUvmInterfacePmaAllocPagesBatch(gpu->pmm.pma, requests, params->num_requests);
+    *alloc_ns += NV_GETTIME() - start;
+
+    // Even on failure, the requests that succeeded hold pages that need to be
+    // freed.
+    for (i = 0; i < params->num_requests; i++) {
+        if (requests[i].status != NV_OK)
+            continue;
+
+        free_requests[count].pPages = requests[i].pPages;
+        free_requests[count].pageCount = requests[i].pageCount;
+        free_requests[count].pageSize = requests[i].pageSize;
+        free_requests[count].flags = test_pma_batch_free_flags(&requests[i].options);
+        count++;
+    }
+
+    start = NV_GETTIME();
+    nvUvmInterfacePmaFreePagesBatch(gpu->pmm.pma, free_requests, count);
+    *free_ns += NV_GETTIME() - start;
+
+    return status;
+}
+
+NV_STATUS uvm_test_pma_batch_benchmark(UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_t *gpu;
+    NvU64 *pages = NULL;
+    UvmPmaAllocationRequest *requests = NULL;
+    UvmPmaFreeRequest *free_requests = NULL;
+    NvU64 single_alloc_ns = 0;
+    NvU64 batch_alloc_ns = 0;
+    NvU64 single_free_ns = 0;
+    NvU64 batch_free_ns = 0;
+    NvU64 total_pages;
+    NvU32 iter;
+    NvU32 i;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+
+    if (params->num_requests == 0 || params->num_requests > 4096)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->pages_per_request == 0 || params->pages_per_request > 4096)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->iterations == 0 || params->iterations > 1000)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->page_size != UVM_PAGE_SIZE_64K && params->page_size != UVM_PAGE_SIZE_2M)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    pages = uvm_kvmalloc(sizeof(*pages) * params->num_requests * params->pages_per_request);
+    requests = uvm_kvmalloc_zero(sizeof(*requests) * params->num_requests);
+    free_requests = uvm_kvmalloc_zero(sizeof(*free_requests) * params->num_requests);
+    if (!pages || !requests || !free_requests) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    for (iter = 0; iter < params->iterations; iter++) {
+        for (i = 0; i < params->num_requests; i++) {
+            memset(&requests[i], 0, sizeof(requests[i]));
+            requests[i].pageCount = params->pages_per_request;
+            requests[i].pageSize = test_pma_batch_page_size(params, i);
+            requests[i].options.flags = UVM_PMA_ALLOCATE_PINNED | UVM_PMA_ALLOCATE_DONT_EVICT;
+            requests[i].pPages = pages + (NvU64)i * params->pages_per_request;
+        }
+
+        status = test_pma_batch_single(gpu, params, requests, &single_alloc_ns, &single_free_ns);
+        if (status != NV_OK)
+            goto out;
+
+        for (i = 0; i < params->num_requests; i++)
+            requests[i].options.resultFlags = 0;
+
+        status = test_pma_batch_batched(gpu, params, requests, free_requests, &batch_alloc_ns, &batch_free_ns);
+        if (status != NV_OK)
+            goto out;
+    }
+
+    total_pages = (NvU64)params->num_requests * params->pages_per_request * params->iterations;
+    params->single_alloc_pages_per_s = single_alloc_ns ? total_pages * NSEC_PER_SEC / single_alloc_ns : 0;
+    params->batch_alloc_pages_per_s = batch_alloc_ns ? total_pages * NSEC_PER_SEC / batch_alloc_ns : 0;
+    params->single_free_pages_per_s = single_free_ns ? total_pages * NSEC_PER_SEC / single_free_ns : 0;
+    params->batch_free_pages_per_s = batch_free_ns ? total_pages * NSEC_PER_SEC / batch_free_ns : 0;
+
+out:
+    uvm_kvfree(free_requests);
+    uvm_kvfree(requests);
+    uvm_kvfree(pages);
+    uvm_gpu_release(gpu);
+
+    return status;
+}
+
+#define PMA_CONTENTION_BENCH_MAX_THREADS 256
+
+typedef struct
+{
+    uvm_gpu_t *gpu;
+    const UVM_TEST_PMA_CONTENTION_BENCHMARK_PARAMS *params;
+    struct completion *start;
+    NV_STATUS status;
+} pma_contention_bench_thread_t;
+
+static NV_STATUS pma_contention_bench_thread(pma_contention_bench_thread_t *thread)
+{
+    const UVM_TEST_PMA_CONTENTION_BENCHMARK_PARAMS *params = thread->params;
+    UvmPmaAllocationOptions options = {0};
+    NV_STATUS status;
+    NvU64 page;
+    NvU32 i;
+
+    for (i = 0; i < params->iterations; i++) {
+        options.flags = UVM_PMA_ALLOCATE_PINNED | UVM_PMA_ALLOCATE_DONT_EVICT;
+        options.resultFlags = 0;
+
+        status = nvUvmInterfacePmaAllocPages(thread->gpu->pmm.pma, 1, params->page_size, &options, &page);
+        if (status != NV_OK)
+            return status;
+
+        nvUvmInterfacePmaFreePages(thread->gpu->pmm.pma,
+                                   &page,
+                                   1,
+                                   params->page_size,
+                                   test_pma_batch_free_flags(&options));
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS pma_contention_bench_thread_entry(pma_contention_bench_thread_t *thread)
+{
+    UVM_ENTRY_RET(pma_contention_bench_thread(thread));
+}
+
+static int pma_contention_bench_kthread(void *arg)
+{
+    pma_contention_bench_thread_t *thread = arg;
+
+    wait_for_completion(thread->start);
+
+    thread->status = pma_contention_bench_thread_entry(thread);
+
+    while (!kthread_should_stop())
+        schedule();
+
+    return 0;
+}
+
+NV_STATUS uvm_test_pma_contention_benchmark(UVM_TEST_PMA_CONTENTION_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_t *gpu;
+    struct task_struct **kthreads = NULL;
+    pma_contention_bench_thread_t *threads = NULL;
+    NvU64 start_time;
+    NvU32 i;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    DECLARE_COMPLETION_ONSTACK(start);
+
+    if (params->num_threads == 0 ||
+        params->num_threads > PMA_CONTENTION_BENCH_MAX_THREADS ||
+        params->iterations == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->page_size != UVM_PAGE_SIZE_64K && params->page_size != UVM_PAGE_SIZE_2M)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    kthreads = uvm_kvmalloc_zero(params->num_threads * sizeof(*kthreads));
+    threads = uvm_kvmalloc_zero(params->num_threads * sizeof(*threads));
+    if (!kthreads || !threads) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    for (i = 0; i < params->num_threads; i++) {
+        threads[i].gpu = gpu;
+        threads[i].params = params;
+        threads[i].start = &start;
+
+        kthreads[i] = kthread_run(pma_contention_bench_kthread, &threads[i], "uvm_pma_contention_bench");
+        if (IS_ERR(kthreads[i])) {
+            status = errno_to_nv_status(PTR_ERR(kthreads[i]));
+            break;
+        }
+    }
+
+    start_time = NV_GETTIME();
+    complete_all(&start);
+
+    while (i-- > 0) {
+        kthread_stop(kthreads[i]);
+
+        if (status == NV_OK)
+            status = threads[i].status;
+    }
+
+    if (status == NV_OK)
+        params->ns_per_op = (NV_GETTIME() - start_time) / ((NvU64)params->num_threads * params->iterations);
+
+out:
+    uvm_kvfree(threads);
+    uvm_kvfree(kthreads);
+    uvm_gpu_release(gpu);
+
+    return status;
+}
+
 NV_STATUS uvm_test_pmm_alloc_free_root(UVM_TEST_PMM_ALLOC_FREE_ROOT_PARAMS *params, struct file *filp)
 {
     NV_STATUS status = NV_OK;
@@ -53,6 +53,7 @@
 
 #include "uvm_forward_decl.h"
 #include "uvm_lock.h"
+#include "uvm_pmm_gpu_eviction.h"
 #include "uvm_processors.h"
 #include "uvm_tracker.h"
 #include "uvm_va_block_types.h"
@@ -349,6 +350,12 @@ typedef struct uvm_gpu_root_chunk_struct
     //
     // Protected by the corresponding root chunk bit lock.
     uvm_tracker_t tracker;
+
+    // State used by the eviction policy to pick victims among user root
+    // chunks.
+    //
+    // Protected by PMM's list_lock.
+    uvm_pmm_eviction_state_t eviction;
 } uvm_gpu_root_chunk_t;
 
 typedef struct uvm_pmm_gpu_struct
@@ -379,6 +386,13 @@ typedef struct uvm_pmm_gpu_struct
         // LRU lists for picking which root chunks to evict
         struct list_head alloc_list[UVM_PMM_ALLOC_LIST_COUNT];
 
+        // Eviction policy state shared by all the root chunks. Chunks on
+        // UVM_PMM_ALLOC_LIST_USED are picked for eviction according to the
+        // policy of the VA space owning them. See uvm_pmm_gpu_eviction.h.
+        //
+        // Protected by list_lock.
+        uvm_pmm_eviction_t eviction;
+
         // List of chunks needing to be lazily freed and a queue for processing
         // the list. TODO: Bug 3881835: revisit whether to use nv_kthread_q_t or
         // workqueue.
@@ -575,6 +589,20 @@ void uvm_pmm_gpu_mark_chunk_evicted(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
 // Allow that state to make this API easy to use for the caller.
 void uvm_pmm_gpu_mark_root_chunk_used(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
 
+// Mark a used root chunk as accessed again, which makes it less likely to be
+// evicted under frequency-aware eviction policies.
+//
+// If the chunk is pinned or selected for eviction, this won't do anything.
+void uvm_pmm_gpu_mark_root_chunk_accessed(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
+
+// Hint that the data in a used root chunk is being accessed heavily, for
+// example because access counters requested its migration to the GPU. This
+// makes the chunk less likely to be evicted under frequency-aware eviction
+// policies.
+//
+// If the chunk is pinned or selected for eviction, this won't do anything.
+void uvm_pmm_gpu_mark_root_chunk_hot(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
+
 // Mark an allocated user chunk as unused
 void uvm_pmm_gpu_mark_root_chunk_unused(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
 
@@ -0,0 +1,291 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#include "uvm_linux.h"
+#include "uvm_common.h"
+#include "uvm_pmm_gpu_eviction.h"
+
+#include <linux/hash.h>
+
+//
+// Tunables for root chunk eviction (configurable via module parameters)
+//
+
+#define UVM_PMM_EVICTION_POLICY_DEFAULT UVM_PMM_EVICTION_POLICY_LRU
+
+// Eviction policy of new VA spaces: 0 for LRU, 1 for CLOCK-Pro. Tests can
+// override the policy of a VA space with UVM_TEST_SET_PMM_EVICTION_POLICY.
+static unsigned uvm_perf_pmm_eviction_policy = UVM_PMM_EVICTION_POLICY_DEFAULT;
+
+#define UVM_PMM_EVICTION_MAX_FREQUENCY_DEFAULT 3
+
+// Maximum number of passes of the clock hand that a frequently-used root chunk
+// survives
+//
+// Valid values 1-255
+static unsigned uvm_perf_pmm_eviction_max_frequency = UVM_PMM_EVICTION_MAX_FREQUENCY_DEFAULT;
+
+#define UVM_PMM_EVICTION_MAX_SCAN_DEFAULT 64
+#define UVM_PMM_EVICTION_MAX_SCAN_MAX     4096
+
+// Maximum number of root chunks visited per eviction
+//
+// Valid values 1-4096
+static unsigned uvm_perf_pmm_eviction_max_scan = UVM_PMM_EVICTION_MAX_SCAN_DEFAULT;
+
+#define UVM_PMM_EVICTION_HOT_PERCENT_DEFAULT 50
+
+// Percentage of the root chunks tracked by the CLOCK-Pro policy that can be
+// hot before hot chunks start being aged
+//
+// Valid values 1-99
+static unsigned uvm_perf_pmm_eviction_hot_percent = UVM_PMM_EVICTION_HOT_PERCENT_DEFAULT;
+
+module_param(uvm_perf_pmm_eviction_policy, uint, S_IRUGO);
+module_param(uvm_perf_pmm_eviction_max_frequency, uint, S_IRUGO);
+module_param(uvm_perf_pmm_eviction_max_scan, uint, S_IRUGO);
+module_param(uvm_perf_pmm_eviction_hot_percent, uint, S_IRUGO);
+
+static uvm_pmm_eviction_policy_t g_uvm_pmm_eviction_policy;
+static NvU8 g_uvm_pmm_eviction_max_frequency;
+static NvU32 g_uvm_pmm_eviction_max_scan;
+static NvU32 g_uvm_pmm_eviction_hot_percent;
+
+NV_STATUS uvm_pmm_gpu_eviction_init(void)
+{
+    if (uvm_perf_pmm_eviction_policy < UVM_PMM_EVICTION_POLICY_COUNT) {
+        g_uvm_pmm_eviction_policy = uvm_perf_pmm_eviction_policy;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_eviction_policy. Using %u instead\n",
+                       uvm_perf_pmm_eviction_policy,
+                       UVM_PMM_EVICTION_POLICY_DEFAULT);
+
+        g_uvm_pmm_eviction_policy = UVM_PMM_EVICTION_POLICY_DEFAULT;
+    }
+
+    if (uvm_perf_pmm_eviction_max_frequency >= 1 && uvm_perf_pmm_eviction_max_frequency <= NV_U8_MAX) {
+        g_uvm_pmm_eviction_max_frequency = uvm_perf_pmm_eviction_max_frequency;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_eviction_max_frequency. Using %u instead\n",
+                       uvm_perf_pmm_eviction_max_frequency,
+                       UVM_PMM_EVICTION_MAX_FREQUENCY_DEFAULT);
+
+        g_uvm_pmm_eviction_max_frequency = UVM_PMM_EVICTION_MAX_FREQUENCY_DEFAULT;
+    }
+
+    if (uvm_perf_pmm_eviction_max_scan >= 1 && uvm_perf_pmm_eviction_max_scan <= UVM_PMM_EVICTION_MAX_SCAN_MAX) {
+        g_uvm_pmm_eviction_max_scan = uvm_perf_pmm_eviction_max_scan;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_eviction_max_scan. Using %u instead\n",
+                       uvm_perf_pmm_eviction_max_scan,
+                       UVM_PMM_EVICTION_MAX_SCAN_DEFAULT);
+
+        g_uvm_pmm_eviction_max_scan = UVM_PMM_EVICTION_MAX_SCAN_DEFAULT;
+    }
+
+    if (uvm_perf_pmm_eviction_hot_percent >= 1 && uvm_perf_pmm_eviction_hot_percent <= 99) {
+        g_uvm_pmm_eviction_hot_percent = uvm_perf_pmm_eviction_hot_percent;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_eviction_hot_percent. Using %u instead\n",
+                       uvm_perf_pmm_eviction_hot_percent,
+                       UVM_PMM_EVICTION_HOT_PERCENT_DEFAULT);
+
+        g_uvm_pmm_eviction_hot_percent = UVM_PMM_EVICTION_HOT_PERCENT_DEFAULT;
+    }
+
+    return NV_OK;
+}
+
+uvm_pmm_eviction_policy_t uvm_pmm_eviction_default_policy(void)
+{
+    return g_uvm_pmm_eviction_policy;
+}
+
+void uvm_pmm_eviction_init(uvm_pmm_eviction_t *eviction)
+{
+    memset(eviction, 0, sizeof(*eviction));
+
+    eviction->params.max_frequency = g_uvm_pmm_eviction_max_frequency;
+    eviction->params.max_scan = g_uvm_pmm_eviction_max_scan;
+    eviction->params.hot_percent = g_uvm_pmm_eviction_hot_percent;
+}
+
+static void state_set_hot(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state, bool hot)
+{
+    if (state->hot == hot)
+        return;
+
+    if (hot) {
+        ++eviction->num_hot;
+    }
+    else {
+        UVM_ASSERT(eviction->num_hot > 0);
+        --eviction->num_hot;
+    }
+
+    state->hot = hot;
+}
+
+void uvm_pmm_eviction_state_reset(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state)
+{
+    state_set_hot(eviction, state, false);
+
+    if (state->key != 0) {
+        UVM_ASSERT(eviction->num_tracked > 0);
+        --eviction->num_tracked;
+    }
+
+    state->key = 0;
+    state->frequency = 0;
+    state->policy = UVM_PMM_EVICTION_POLICY_LRU;
+}
+
+static NvU64 *ghost_entry(uvm_pmm_eviction_t *eviction, NvU64 key)
+{
+    BUILD_BUG_ON(!is_power_of_2(UVM_PMM_EVICTION_GHOSTS));
+
+    return &eviction->ghosts[hash_64(key, ilog2(UVM_PMM_EVICTION_GHOSTS))];
+}
+
+static void frequency_inc(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state)
+{
+    if (state->frequency < eviction->params.max_frequency)
+        ++state->frequency;
+}
+
+static bool too_many_hot(uvm_pmm_eviction_t *eviction)
+{
+    return eviction->num_hot * 100 > eviction->num_tracked * eviction->params.hot_percent;
+}
+
+void uvm_pmm_eviction_on_use(uvm_pmm_eviction_t *eviction,
+                             uvm_pmm_eviction_state_t *state,
+                             uvm_pmm_eviction_policy_t policy,
+                             NvU64 key)
+{
+    NvU64 *ghost;
+
+    UVM_ASSERT(policy < UVM_PMM_EVICTION_POLICY_COUNT);
+    UVM_ASSERT(key != 0);
+
+    if (policy != UVM_PMM_EVICTION_POLICY_CLOCK_PRO) {
+        uvm_pmm_eviction_state_reset(eviction, state);
+        state->policy = policy;
+        return;
+    }
+
+    if (state->key == key) {
+        frequency_inc(eviction, state);
+        return;
+    }
+
+    uvm_pmm_eviction_state_reset(eviction, state);
+
+    state->key = key;
+    state->policy = policy;
+    ++eviction->num_tracked;
+
+    // The data was evicted recently and it is needed again: its reuse distance
+    // is shorter than the memory size, so protect it
+    ghost = ghost_entry(eviction, key);
+    if (*ghost == key) {
+        *ghost = 0;
+        state_set_hot(eviction, state, true);
+        ++eviction->stats.num_ghost_hits;
+    }
+}
+
+void uvm_pmm_eviction_on_access(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state)
+{
+    if (state->policy == UVM_PMM_EVICTION_POLICY_CLOCK_PRO)
+        frequency_inc(eviction, state);
+}
+
+void uvm_pmm_eviction_on_hint(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state)
+{
+    if (state->policy != UVM_PMM_EVICTION_POLICY_CLOCK_PRO)
+        return;
+
+    state_set_hot(eviction, state, true);
+    frequency_inc(eviction, state);
+    ++eviction->stats.num_hints;
+}
+
+void uvm_pmm_eviction_on_evict(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state)
+{
+    if (state->policy == UVM_PMM_EVICTION_POLICY_CLOCK_PRO && state->key != 0)
+        *ghost_entry(eviction, state->key) = state->key;
+
+    uvm_pmm_eviction_state_reset(eviction, state);
+}
+
+struct list_head *uvm_pmm_eviction_pick(uvm_pmm_eviction_t *eviction,
+                                        struct list_head *list,
+                                        uvm_pmm_eviction_state_t *(*get_state)(struct list_head *node))
+{
+    NvU32 scanned;
+
+    if (list_empty(list))
+        return NULL;
+
+    for (scanned = 0; scanned < eviction->params.max_scan; ++scanned) {
+        struct list_head *node = list->next;
+        uvm_pmm_eviction_state_t *state = get_state(node);
+
+        if (state->policy != UVM_PMM_EVICTION_POLICY_CLOCK_PRO)
+            return node;
+
+        if (state->hot) {
+            // Age hot chunks only when there are too many of them
+            if (too_many_hot(eviction)) {
+                if (state->frequency > 0) {
+                    --state->frequency;
+                }
+                else {
+                    state_set_hot(eviction, state, false);
+                    ++eviction->stats.num_demotions;
+                }
+            }
+        }
+        else if (state->frequency > 0) {
+            // Reused since the last pass of the hand
+            state->frequency = 0;
+            state_set_hot(eviction, state, true);
+            ++eviction->stats.num_promotions;
+        }
+        else {
+            return node;
+        }
+
+        list_move_tail(node, list);
+        ++eviction->stats.num_second_chances;
+    }
+
+    ++eviction->stats.num_scan_limit;
+
+    return list->next;
+}
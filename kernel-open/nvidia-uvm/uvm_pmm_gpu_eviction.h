@@ -0,0 +1,165 @@
+/*******************************************************************************
+    Copyright (c) 2025 NVIDIA Corporation
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+        The above copyright notice and this permission notice shall be
+        included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+    DEALINGS IN THE SOFTWARE.
+
+*******************************************************************************/
+
+#ifndef __UVM_PMM_GPU_EVICTION_H__
+#define __UVM_PMM_GPU_EVICTION_H__
+
+#include "uvm_linux.h"
+
+// Eviction policies for the root chunks of user memory in PMM. The policy of a
+// root chunk is the policy of the VA space that owns its data, and it decides
+// whether the chunk can be picked for eviction when it reaches the head of the
+// UVM_PMM_ALLOC_LIST_USED list. See pick_root_chunk_to_evict() in
+// uvm_pmm_gpu.c.
+//
+// UVM_PMM_EVICTION_POLICY_LRU evicts the least-recently used root chunk, which
+// is the historical PMM behavior. A single streaming pass over a working set
+// larger than vidmem flushes all the frequently-used chunks out of the GPU.
+//
+// UVM_PMM_EVICTION_POLICY_CLOCK_PRO is a simplified CLOCK-Pro. The USED list
+// acts as the clock, and its head is the hand. Every root chunk has a reuse
+// frequency that grows each time its VA block becomes resident on the GPU
+// again, or gets more pages migrated into it. Chunks are either cold or hot:
+// - Cold chunks with zero frequency are evicted when the hand reaches them.
+// - Cold chunks that were reused since the last pass of the hand are promoted
+//   to hot and moved to the tail.
+// - Chunks whose data was evicted recently, and which are allocated again for
+//   the same data, start hot. Evicted chunks are remembered in a small table of
+//   non-resident "ghost" entries, which plays the role of the CLOCK-Pro test
+//   period.
+// - Access counter notifications that migrate data to the GPU mark the
+//   destination chunk hot.
+// Hot chunks are skipped by the hand as long as they do not exceed the hot
+// share of the tracked chunks. Otherwise, the hand ages them by decrementing
+// their frequency, and demotes them to cold once it reaches zero. This keeps
+// the hot working set resident through streaming passes of any length.
+//
+// The structures below are pure data structures: PMM protects them with its
+// list_lock, and tests drive them directly to simulate eviction traces.
+typedef enum
+{
+    UVM_PMM_EVICTION_POLICY_LRU = 0,
+    UVM_PMM_EVICTION_POLICY_CLOCK_PRO,
+    UVM_PMM_EVICTION_POLICY_COUNT
+} uvm_pmm_eviction_policy_t;
+
+// Number of entries in the table of recently-evicted chunks. Must be a power
+// of two.
+#define UVM_PMM_EVICTION_GHOSTS 2048
+
+// Per root chunk eviction state
+typedef struct
+{
+    // Identity of the data backed by the chunk, used to recognize it when it
+    // is allocated again after being evicted. 0 if the chunk does not back any
+    // data.
+    NvU64 key;
+
+    // Number of passes of the clock hand that the chunk survives
+    NvU8 frequency;
+
+    // uvm_pmm_eviction_policy_t of the VA space that owns the data
+    NvU8 policy;
+
+    bool hot;
+} uvm_pmm_eviction_state_t;
+
+typedef struct
+{
+    // Direct-mapped table of keys of recently-evicted chunks
+    NvU64 ghosts[UVM_PMM_EVICTION_GHOSTS];
+
+    struct
+    {
+        // Maximum value of uvm_pmm_eviction_state_t::frequency
+        NvU8 max_frequency;
+
+        // Maximum number of chunks visited by the hand per eviction. If no
+        // victim is found, the chunk at the head is evicted.
+        NvU32 max_scan;
+
+        // Percentage of the tracked chunks that can be hot before the hand
+        // starts demoting them
+        NvU32 hot_percent;
+    } params;
+
+    // Number of chunks that back data under the CLOCK-Pro policy, and how
+    // many of them are hot
+    NvU64 num_tracked;
+    NvU64 num_hot;
+
+    struct
+    {
+        NvU64 num_second_chances;
+
+        NvU64 num_promotions;
+
+        NvU64 num_demotions;
+
+        NvU64 num_ghost_hits;
+
+        NvU64 num_hints;
+
+        NvU64 num_scan_limit;
+    } stats;
+} uvm_pmm_eviction_t;
+
+// Global initialization function (no clean up needed).
+NV_STATUS uvm_pmm_gpu_eviction_init(void);
+
+// Policy used by new VA spaces, selected by uvm_perf_pmm_eviction_policy
+uvm_pmm_eviction_policy_t uvm_pmm_eviction_default_policy(void);
+
+// Initialize the given eviction tracking with the global tunables
+void uvm_pmm_eviction_init(uvm_pmm_eviction_t *eviction);
+
+// Reset the state of a chunk that no longer backs any data
+void uvm_pmm_eviction_state_reset(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state);
+
+// Called when the data identified by key, which belongs to a VA space with the
+// given policy, becomes resident in the chunk. If the chunk already backs that
+// data, this counts as a reuse.
+void uvm_pmm_eviction_on_use(uvm_pmm_eviction_t *eviction,
+                             uvm_pmm_eviction_state_t *state,
+                             uvm_pmm_eviction_policy_t policy,
+                             NvU64 key);
+
+// Called when more data becomes resident in a chunk that is already in use
+void uvm_pmm_eviction_on_access(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state);
+
+// Called when an external heuristic, like access counters, reports that the
+// data backed by the chunk is being used heavily
+void uvm_pmm_eviction_on_hint(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state);
+
+// Called when the chunk is picked for eviction. The state is reset.
+void uvm_pmm_eviction_on_evict(uvm_pmm_eviction_t *eviction, uvm_pmm_eviction_state_t *state);
+
+// Pick the victim from a list ordered from least to most recently used. The
+// chunks that survive the pass of the hand are moved to the tail of the list.
+// get_state returns the eviction state of the chunk embedding the given list
+// node. Returns NULL if the list is empty.
+struct list_head *uvm_pmm_eviction_pick(uvm_pmm_eviction_t *eviction,
+                                        struct list_head *list,
+                                        uvm_pmm_eviction_state_t *(*get_state)(struct list_head *node));
+
+#endif
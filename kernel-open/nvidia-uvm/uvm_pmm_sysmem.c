@@ -21,18 +21,364 @@
 
 *******************************************************************************/
 
+#include "uvm_global.h"
 #include "uvm_gpu.h"
 #include "uvm_pmm_sysmem.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_va_block.h"
 #include "uvm_va_space.h"
+#include "uvm_procfs.h"
 
 static int uvm_cpu_chunk_allocation_sizes = UVM_CPU_CHUNK_SIZES;
 module_param(uvm_cpu_chunk_allocation_sizes, uint, S_IRUGO | S_IWUSR);
 MODULE_PARM_DESC(uvm_cpu_chunk_allocation_sizes, "OR'ed value of all CPU chunk allocation sizes.");
 
+// Number of 2M chunks kept in reserve on each NUMA node with memory. 2M
+// allocations are done with __GFP_NORETRY so, under fragmentation, VA blocks
+// are frequently backed by 64K or 4K chunks instead, which multiplies the
+// number of DMA and IOMMU mappings required on every GPU. When a 2M allocation
+// fails, the chunk is taken from the reserve instead. The reserve is refilled
+// by a background thread whose allocations are allowed to reclaim and compact
+// memory. Note that the pages in the reserve are not charged to the memory
+// cgroup of the process that ends up using them. 0 disables the reserve.
+#define UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_DEFAULT 0
+#define UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_MAX     256
+
+static unsigned uvm_cpu_chunk_reserve_2m_per_node = UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_DEFAULT;
+module_param(uvm_cpu_chunk_reserve_2m_per_node, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_cpu_chunk_reserve_2m_per_node,
+                 "Number of 2M CPU chunks kept in reserve on each NUMA node. 0 disables the reserve.");
+
+// Replace the CPU chunks of a 2M VA block with a single 2M chunk when the
+// chunks are smaller than 2M and the block becomes fully resident on a GPU.
+// See uvm_cpu_chunk_merge_enabled().
+static int uvm_cpu_chunk_merge_gpu_resident = 0;
+module_param(uvm_cpu_chunk_merge_gpu_resident, int, S_IRUGO);
+MODULE_PARM_DESC(uvm_cpu_chunk_merge_gpu_resident,
+                 "Replace the small CPU chunks of VA blocks fully resident on a GPU with a 2M chunk.");
+
+#define CPU_CHUNK_RESERVE_ORDER (get_order(UVM_CHUNK_SIZE_2M))
+
+// Number of entries in the allocation size histograms: one per power of two
+// between PAGE_SIZE and 2M.
+#define CPU_CHUNK_SIZE_CLASS_COUNT (ilog2(UVM_CHUNK_SIZE_2M) - PAGE_SHIFT + 1)
+
+#define CPU_CHUNK_STATS_FILE_NAME "sysmem_chunk_stats"
+
+typedef struct
+{
+    // Protects pages and count
+    uvm_spinlock_t lock;
+
+    // List of 2M compound pages, linked through their lru field
+    struct list_head pages;
+
+    NvU32 count;
+} cpu_chunk_reserve_node_t;
+
+static struct
+{
+    // Per NUMA node reserves, indexed by node id. NULL if the reserve is
+    // disabled.
+    cpu_chunk_reserve_node_t *nodes;
+
+    nv_kthread_q_t refill_q;
+
+    nv_kthread_q_item_t refill_q_item;
+} g_cpu_chunk_reserve;
+
+static struct
+{
+    // Number of allocations requested for each chunk size
+    atomic64_t requested[CPU_CHUNK_SIZE_CLASS_COUNT];
+
+    // Number of chunks of each size successfully allocated, including those
+    // taken from the reserve
+    atomic64_t allocated[CPU_CHUNK_SIZE_CLASS_COUNT];
+
+    // 2M allocations that failed and were served from the reserve
+    atomic64_t reserve_hits;
+
+    // 2M allocations that failed and found the reserve empty
+    atomic64_t reserve_misses;
+
+    // 2M chunks added to the reserve by the background thread
+    atomic64_t reserve_refills;
+
+    // 2M allocations of the background thread that failed
+    atomic64_t reserve_refill_failures;
+
+    // VA blocks whose CPU chunks were replaced by a single 2M chunk
+    atomic64_t merges;
+
+    struct proc_dir_entry *procfs_file;
+} g_cpu_chunk_stats;
+
+static NvU32 cpu_chunk_size_class(uvm_chunk_size_t size)
+{
+    UVM_ASSERT(size >= PAGE_SIZE);
+    UVM_ASSERT(size <= UVM_CHUNK_SIZE_2M);
+
+    return ilog2(size) - PAGE_SHIFT;
+}
+
+static bool cpu_chunk_reserve_enabled(void)
+{
+    return g_cpu_chunk_reserve.nodes != NULL;
+}
+
+static void cpu_chunk_reserve_refill(void *args)
+{
+    int nid;
+
+    for_each_node_state(nid, N_MEMORY) {
+        cpu_chunk_reserve_node_t *node = &g_cpu_chunk_reserve.nodes[nid];
+
+        while (true) {
+            struct page *page;
+            NvU32 count;
+
+            uvm_spin_lock(&node->lock);
+            count = node->count;
+            uvm_spin_unlock(&node->lock);
+
+            if (count >= uvm_cpu_chunk_reserve_2m_per_node)
+                break;
+
+            // Unlike uvm_cpu_chunk_alloc_page(), __GFP_NORETRY is not used so
+            // that the kernel is allowed to reclaim and compact memory to
+            // satisfy the allocation. Latency does not matter here.
+            page = alloc_pages_node(nid,
+                                    NV_UVM_GFP_FLAGS | GFP_HIGHUSER | __GFP_COMP | __GFP_THISNODE | __GFP_NOWARN,
+                                    CPU_CHUNK_RESERVE_ORDER);
+            if (!page) {
+                atomic64_inc(&g_cpu_chunk_stats.reserve_refill_failures);
+                break;
+            }
+
+            uvm_spin_lock(&node->lock);
+            list_add_tail(&page->lru, &node->pages);
+            node->count++;
+            uvm_spin_unlock(&node->lock);
+
+            atomic64_inc(&g_cpu_chunk_stats.reserve_refills);
+
+            cond_resched();
+        }
+    }
+}
+
+static void cpu_chunk_reserve_schedule_refill(void)
+{
+    // The refill is skipped if it is already pending.
+    nv_kthread_q_schedule_q_item(&g_cpu_chunk_reserve.refill_q, &g_cpu_chunk_reserve.refill_q_item);
+}
+
+static struct page *cpu_chunk_reserve_take_from_node(int nid)
+{
+    cpu_chunk_reserve_node_t *node = &g_cpu_chunk_reserve.nodes[nid];
+    struct page *page = NULL;
+
+    uvm_spin_lock(&node->lock);
+
+    if (!list_empty(&node->pages)) {
+        page = list_first_entry(&node->pages, struct page, lru);
+        list_del(&page->lru);
+        node->count--;
+    }
+
+    uvm_spin_unlock(&node->lock);
+
+    return page;
+}
+
+// Take a 2M page from the reserve. If nid is NUMA_NO_NODE, the reserve of the
+// local node is tried first. The reserves of other nodes are only tried if the
+// allocation is not strict.
+static struct page *cpu_chunk_reserve_take(int nid, uvm_cpu_chunk_alloc_flags_t alloc_flags)
+{
+    struct page *page;
+    int other_nid;
+
+    if (!cpu_chunk_reserve_enabled())
+        return NULL;
+
+    if (nid == NUMA_NO_NODE) {
+        nid = numa_mem_id();
+        alloc_flags &= ~UVM_CPU_CHUNK_ALLOC_FLAGS_STRICT;
+    }
+
+    page = cpu_chunk_reserve_take_from_node(nid);
+    if (!page && !(alloc_flags & UVM_CPU_CHUNK_ALLOC_FLAGS_STRICT)) {
+        for_each_node_state(other_nid, N_MEMORY) {
+            if (other_nid == nid)
+                continue;
+
+            page = cpu_chunk_reserve_take_from_node(other_nid);
+            if (page)
+                break;
+        }
+    }
+
+    if (page) {
+        atomic64_inc(&g_cpu_chunk_stats.reserve_hits);
+
+        if (alloc_flags & UVM_CPU_CHUNK_ALLOC_FLAGS_ZERO) {
+            size_t i;
+
+            for (i = 0; i < UVM_CHUNK_SIZE_2M / PAGE_SIZE; i++)
+                clear_highpage(page + i);
+
+            SetPageDirty(page);
+        }
+    }
+    else {
+        atomic64_inc(&g_cpu_chunk_stats.reserve_misses);
+    }
+
+    cpu_chunk_reserve_schedule_refill();
+
+    return page;
+}
+
+static NV_STATUS cpu_chunk_reserve_init(void)
+{
+    NV_STATUS status;
+    int nid;
+
+    if (uvm_cpu_chunk_reserve_2m_per_node > UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_MAX) {
+        UVM_INFO_PRINT("Invalid value %u for uvm_cpu_chunk_reserve_2m_per_node. Using %u instead\n",
+                       uvm_cpu_chunk_reserve_2m_per_node,
+                       UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_MAX);
+        uvm_cpu_chunk_reserve_2m_per_node = UVM_CPU_CHUNK_RESERVE_2M_PER_NODE_MAX;
+    }
+
+    if (uvm_cpu_chunk_reserve_2m_per_node == 0 || !(uvm_cpu_chunk_allocation_sizes & UVM_CHUNK_SIZE_2M))
+        return NV_OK;
+
+    g_cpu_chunk_reserve.nodes = uvm_kvmalloc_zero(sizeof(*g_cpu_chunk_reserve.nodes) * MAX_NUMNODES);
+    if (!g_cpu_chunk_reserve.nodes)
+        return NV_ERR_NO_MEMORY;
+
+    for_each_possible_uvm_node(nid) {
+        uvm_spin_lock_init(&g_cpu_chunk_reserve.nodes[nid].lock, UVM_LOCK_ORDER_LEAF);
+        INIT_LIST_HEAD(&g_cpu_chunk_reserve.nodes[nid].pages);
+    }
+
+    status = errno_to_nv_status(nv_kthread_q_init(&g_cpu_chunk_reserve.refill_q, "UVM CPU chunk reserve"));
+    if (status != NV_OK) {
+        uvm_kvfree(g_cpu_chunk_reserve.nodes);
+        g_cpu_chunk_reserve.nodes = NULL;
+        return status;
+    }
+
+    nv_kthread_q_item_init(&g_cpu_chunk_reserve.refill_q_item, cpu_chunk_reserve_refill, NULL);
+    cpu_chunk_reserve_schedule_refill();
+
+    return NV_OK;
+}
+
+static void cpu_chunk_reserve_exit(void)
+{
+    int nid;
+
+    if (!cpu_chunk_reserve_enabled())
+        return;
+
+    nv_kthread_q_stop(&g_cpu_chunk_reserve.refill_q);
+
+    for_each_possible_uvm_node(nid) {
+        cpu_chunk_reserve_node_t *node = &g_cpu_chunk_reserve.nodes[nid];
+        struct page *page, *next;
+
+        list_for_each_entry_safe(page, next, &node->pages, lru) {
+            list_del(&page->lru);
+            __free_pages(page, CPU_CHUNK_RESERVE_ORDER);
+        }
+    }
+
+    uvm_kvfree(g_cpu_chunk_reserve.nodes);
+    g_cpu_chunk_reserve.nodes = NULL;
+}
+
+static int nv_procfs_read_cpu_chunk_stats(struct seq_file *s, void *v)
+{
+    uvm_chunk_size_t size;
+    int nid;
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+        return -EAGAIN;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "%-16s %-16s %-16s\n", "chunk_size_kb", "requested", "allocated");
+    for_each_chunk_size(size, UVM_CPU_CHUNK_SIZES) {
+        NvU32 size_class = cpu_chunk_size_class(size);
+
+        UVM_SEQ_OR_DBG_PRINT(s,
+                             "%-16u %-16llu %-16llu\n",
+                             size / 1024,
+                             (NvU64)atomic64_read(&g_cpu_chunk_stats.requested[size_class]),
+                             (NvU64)atomic64_read(&g_cpu_chunk_stats.allocated[size_class]));
+    }
+
+    UVM_SEQ_OR_DBG_PRINT(s, "reserve_2m_per_node      %u\n", cpu_chunk_reserve_enabled() ?
+                                                                   uvm_cpu_chunk_reserve_2m_per_node : 0);
+    UVM_SEQ_OR_DBG_PRINT(s, "reserve_hits             %llu\n",
+                         (NvU64)atomic64_read(&g_cpu_chunk_stats.reserve_hits));
+    UVM_SEQ_OR_DBG_PRINT(s, "reserve_misses           %llu\n",
+                         (NvU64)atomic64_read(&g_cpu_chunk_stats.reserve_misses));
+    UVM_SEQ_OR_DBG_PRINT(s, "reserve_refills          %llu\n",
+                         (NvU64)atomic64_read(&g_cpu_chunk_stats.reserve_refills));
+    UVM_SEQ_OR_DBG_PRINT(s, "reserve_refill_failures  %llu\n",
+                         (NvU64)atomic64_read(&g_cpu_chunk_stats.reserve_refill_failures));
+    UVM_SEQ_OR_DBG_PRINT(s, "merges_2m                %llu\n",
+                         (NvU64)atomic64_read(&g_cpu_chunk_stats.merges));
+
+    if (cpu_chunk_reserve_enabled()) {
+        for_each_node_state(nid, N_MEMORY) {
+            UVM_SEQ_OR_DBG_PRINT(s,
+                                 "reserve_node_%-3d         %u\n",
+                                 nid,
+                                 READ_ONCE(g_cpu_chunk_reserve.nodes[nid].count));
+        }
+    }
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_cpu_chunk_stats_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_cpu_chunk_stats(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(cpu_chunk_stats_entry);
+
+static NV_STATUS cpu_chunk_stats_init(void)
+{
+    if (!uvm_procfs_is_enabled())
+        return NV_OK;
+
+    g_cpu_chunk_stats.procfs_file = NV_CREATE_PROC_FILE(CPU_CHUNK_STATS_FILE_NAME,
+                                                        uvm_procfs_get_cpu_base_dir(),
+                                                        cpu_chunk_stats_entry,
+                                                        NULL);
+    if (!g_cpu_chunk_stats.procfs_file)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    return NV_OK;
+}
+
+static void cpu_chunk_stats_exit(void)
+{
+    proc_remove(g_cpu_chunk_stats.procfs_file);
+    g_cpu_chunk_stats.procfs_file = NULL;
+}
+
 NV_STATUS uvm_pmm_sysmem_init(void)
 {
+    NV_STATUS status;
+
     // Ensure that only supported CPU chunk sizes are enabled.
     uvm_cpu_chunk_allocation_sizes &= UVM_CPU_CHUNK_SIZES;
     if (!uvm_cpu_chunk_allocation_sizes || !(uvm_cpu_chunk_allocation_sizes & PAGE_SIZE)) {
@@ -42,11 +388,33 @@ NV_STATUS uvm_pmm_sysmem_init(void)
         uvm_cpu_chunk_allocation_sizes = UVM_CPU_CHUNK_SIZES;
     }
 
+    status = cpu_chunk_stats_init();
+    if (status != NV_OK)
+        return status;
+
+    status = cpu_chunk_reserve_init();
+    if (status != NV_OK) {
+        cpu_chunk_stats_exit();
+        return status;
+    }
+
     return NV_OK;
 }
 
 void uvm_pmm_sysmem_exit(void)
 {
+    cpu_chunk_reserve_exit();
+    cpu_chunk_stats_exit();
+}
+
+bool uvm_cpu_chunk_merge_enabled(void)
+{
+    return uvm_cpu_chunk_merge_gpu_resident != 0 && (uvm_cpu_chunk_get_allocation_sizes() & UVM_CHUNK_SIZE_2M);
+}
+
+void uvm_cpu_chunk_merge_record(void)
+{
+    atomic64_inc(&g_cpu_chunk_stats.merges);
 }
 
 uvm_chunk_sizes_mask_t uvm_cpu_chunk_get_allocation_sizes(void)
@@ -516,7 +884,12 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_chunk_size_t alloc_size,
 
     UVM_ASSERT(new_chunk);
 
+    atomic64_inc(&g_cpu_chunk_stats.requested[cpu_chunk_size_class(alloc_size)]);
+
     page = uvm_cpu_chunk_alloc_page(alloc_size, nid, alloc_flags);
+    if (!page && alloc_size == UVM_CHUNK_SIZE_2M)
+        page = cpu_chunk_reserve_take(nid, alloc_flags);
+
     if (!page)
         return NV_ERR_NO_MEMORY;
 
@@ -529,6 +902,8 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_chunk_size_t alloc_size,
     chunk->common.type = UVM_CPU_CHUNK_TYPE_PHYSICAL;
     chunk->common.page = page;
 
+    atomic64_inc(&g_cpu_chunk_stats.allocated[cpu_chunk_size_class(alloc_size)]);
+
     *new_chunk = &chunk->common;
     return NV_OK;
 }
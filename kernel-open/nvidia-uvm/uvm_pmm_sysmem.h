@@ -196,6 +196,11 @@ uvm_chunk_sizes_mask_t uvm_cpu_chunk_get_allocation_sizes(void);
 // If the value of nid is NUMA_NO_NODE, the chunk will be allocated from any
 // of the allowed memory nodes by the process policy.
 //
+// If a 2M allocation cannot be satisfied by the kernel and the 2M chunk
+// reserve is enabled (see uvm_cpu_chunk_reserve_2m_per_node), the chunk is
+// taken from the reserve of the requested node, or of any node if the
+// allocation is not strict.
+//
 // If a CPU chunk allocation succeeds, NV_OK is returned. new_chunk will be set
 // to point to the newly allocated chunk. On failure, NV_ERR_NO_MEMORY is
 // returned.
@@ -224,6 +229,16 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_chunk_size_t alloc_size,
 NV_STATUS uvm_cpu_chunk_alloc_hmm(struct page *page,
                                   uvm_cpu_chunk_t **new_chunk);
 
+// Returns true if the CPU chunks of a VA block that becomes fully resident on
+// a GPU should be replaced with a single 2M chunk when they are smaller than
+// 2M. This is controlled by the uvm_cpu_chunk_merge_gpu_resident module
+// parameter.
+bool uvm_cpu_chunk_merge_enabled(void);
+
+// Account for a VA block whose CPU chunks were replaced with a single 2M
+// chunk in the CPU chunk statistics.
+void uvm_cpu_chunk_merge_record(void);
+
 // Convert a physical chunk to an HMM chunk.
 static void uvm_cpu_chunk_make_hmm(uvm_cpu_chunk_t *chunk)
 {
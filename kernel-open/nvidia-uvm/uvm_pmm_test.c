@@ -1120,3 +1120,349 @@ out:
     uvm_va_space_up_read(va_space);
     return status;
 }
+
+typedef struct
+{
+    struct list_head list;
+
+    uvm_pmm_eviction_state_t state;
+
+    // Index of the VA block backed by the chunk
+    NvU32 block;
+} eviction_sim_chunk_t;
+
+typedef struct
+{
+    NvU64 hits;
+    NvU64 misses;
+    NvU64 evictions;
+} eviction_sim_result_t;
+
+static uvm_pmm_eviction_state_t *eviction_sim_state(struct list_head *node)
+{
+    return &list_entry(node, eviction_sim_chunk_t, list)->state;
+}
+
+// Simulate a GPU with room for capacity root chunks, and replay the given
+// trace of VA block uses on it. The chunks of the simulated GPU are managed
+// like the ones in UVM_PMM_ALLOC_LIST_USED: they are moved to the tail of the
+// list when used, and victims are picked with uvm_pmm_eviction_pick().
+static NV_STATUS eviction_simulate(uvm_pmm_eviction_t *eviction,
+                                   uvm_pmm_eviction_policy_t policy,
+                                   const NvU32 *trace,
+                                   NvU64 num_uses,
+                                   NvU32 num_blocks,
+                                   NvU32 capacity,
+                                   eviction_sim_result_t *result)
+{
+    eviction_sim_chunk_t *chunks;
+    eviction_sim_chunk_t **block_chunks;
+    NvU32 num_allocated = 0;
+    NV_STATUS status = NV_OK;
+    LIST_HEAD(used);
+    NvU64 i;
+
+    UVM_ASSERT(capacity > 0);
+
+    memset(result, 0, sizeof(*result));
+
+    chunks = uvm_kvmalloc_zero(capacity * sizeof(*chunks));
+    block_chunks = uvm_kvmalloc_zero(num_blocks * sizeof(*block_chunks));
+    if (!chunks || !block_chunks) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    for (i = 0; i < num_uses; ++i) {
+        NvU32 block = trace[i];
+        eviction_sim_chunk_t *chunk = block_chunks[block];
+
+        UVM_ASSERT(block < num_blocks);
+
+        if (chunk) {
+            ++result->hits;
+            list_move_tail(&chunk->list, &used);
+        }
+        else {
+            ++result->misses;
+
+            if (num_allocated < capacity) {
+                chunk = &chunks[num_allocated++];
+            }
+            else {
+                struct list_head *node = uvm_pmm_eviction_pick(eviction, &used, eviction_sim_state);
+
+                chunk = list_entry(node, eviction_sim_chunk_t, list);
+                list_del(&chunk->list);
+                uvm_pmm_eviction_on_evict(eviction, &chunk->state);
+                block_chunks[chunk->block] = NULL;
+                ++result->evictions;
+            }
+
+            chunk->block = block;
+            block_chunks[block] = chunk;
+            list_add_tail(&chunk->list, &used);
+        }
+
+        // Keys must be non-zero
+        uvm_pmm_eviction_on_use(eviction, &chunk->state, policy, (NvU64)block + 1);
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto done;
+        }
+    }
+
+done:
+    uvm_kvfree(block_chunks);
+    uvm_kvfree(chunks);
+
+    return status;
+}
+
+// Use fixed parameters so that the results of the tests do not depend on the
+// module parameters
+static void eviction_test_init(uvm_pmm_eviction_t *eviction)
+{
+    uvm_pmm_eviction_init(eviction);
+
+    eviction->params.max_frequency = 3;
+    eviction->params.max_scan = 64;
+    eviction->params.hot_percent = 50;
+}
+
+static NV_STATUS test_eviction_state(uvm_pmm_eviction_t *eviction)
+{
+    eviction_sim_chunk_t chunks[3];
+    struct list_head *node;
+    LIST_HEAD(list);
+    NvU32 i;
+
+    eviction_test_init(eviction);
+
+    memset(chunks, 0, sizeof(chunks));
+    for (i = 0; i < ARRAY_SIZE(chunks); ++i)
+        list_add_tail(&chunks[i].list, &list);
+
+    // LRU chunks are not tracked and the head is always picked
+    uvm_pmm_eviction_on_use(eviction, &chunks[0].state, UVM_PMM_EVICTION_POLICY_LRU, 1);
+    uvm_pmm_eviction_on_access(eviction, &chunks[0].state);
+    uvm_pmm_eviction_on_hint(eviction, &chunks[0].state);
+    TEST_CHECK_RET(chunks[0].state.key == 0);
+    TEST_CHECK_RET(!chunks[0].state.hot);
+    TEST_CHECK_RET(eviction->num_tracked == 0);
+    TEST_CHECK_RET(uvm_pmm_eviction_pick(eviction, &list, eviction_sim_state) == &chunks[0].list);
+
+    // New data starts cold
+    for (i = 0; i < ARRAY_SIZE(chunks); ++i)
+        uvm_pmm_eviction_on_use(eviction, &chunks[i].state, UVM_PMM_EVICTION_POLICY_CLOCK_PRO, i + 1);
+
+    TEST_CHECK_RET(eviction->num_tracked == ARRAY_SIZE(chunks));
+    TEST_CHECK_RET(eviction->num_hot == 0);
+    TEST_CHECK_RET(chunks[0].state.frequency == 0);
+
+    // Reuse is counted, up to the maximum frequency
+    uvm_pmm_eviction_on_use(eviction, &chunks[0].state, UVM_PMM_EVICTION_POLICY_CLOCK_PRO, 1);
+    TEST_CHECK_RET(chunks[0].state.frequency == 1);
+    for (i = 0; i < eviction->params.max_frequency + 1; ++i)
+        uvm_pmm_eviction_on_access(eviction, &chunks[0].state);
+    TEST_CHECK_RET(chunks[0].state.frequency == eviction->params.max_frequency);
+
+    // The reused chunk is promoted and skipped, the next cold one is picked
+    node = uvm_pmm_eviction_pick(eviction, &list, eviction_sim_state);
+    TEST_CHECK_RET(node == &chunks[1].list);
+    TEST_CHECK_RET(chunks[0].state.hot);
+    TEST_CHECK_RET(chunks[0].state.frequency == 0);
+    TEST_CHECK_RET(eviction->num_hot == 1);
+    TEST_CHECK_RET(list_last_entry(&list, eviction_sim_chunk_t, list) == &chunks[0]);
+
+    // Evicted data is remembered, and it comes back hot
+    list_del(node);
+    uvm_pmm_eviction_on_evict(eviction, &chunks[1].state);
+    TEST_CHECK_RET(chunks[1].state.key == 0);
+    TEST_CHECK_RET(eviction->num_tracked == ARRAY_SIZE(chunks) - 1);
+
+    uvm_pmm_eviction_on_use(eviction, &chunks[1].state, UVM_PMM_EVICTION_POLICY_CLOCK_PRO, 2);
+    list_add_tail(node, &list);
+    TEST_CHECK_RET(chunks[1].state.hot);
+    TEST_CHECK_RET(eviction->num_hot == 2);
+
+    // A hint makes a chunk hot, too. With all the chunks hot, the hand ages
+    // and demotes them until one of them becomes evictable.
+    uvm_pmm_eviction_on_hint(eviction, &chunks[2].state);
+    TEST_CHECK_RET(chunks[2].state.hot);
+    TEST_CHECK_RET(eviction->num_hot == 3);
+
+    node = uvm_pmm_eviction_pick(eviction, &list, eviction_sim_state);
+    TEST_CHECK_RET(node);
+    TEST_CHECK_RET(!eviction_sim_state(node)->hot);
+    TEST_CHECK_RET(eviction->stats.num_demotions > 0);
+
+    // A policy change drops the tracking
+    for (i = 0; i < ARRAY_SIZE(chunks); ++i)
+        uvm_pmm_eviction_on_use(eviction, &chunks[i].state, UVM_PMM_EVICTION_POLICY_LRU, i + 1);
+
+    TEST_CHECK_RET(eviction->num_tracked == 0);
+    TEST_CHECK_RET(eviction->num_hot == 0);
+
+    return NV_OK;
+}
+
+// A hot working set is used between streaming passes over data that does not
+// fit in the GPU. LRU evicts the working set during each pass, CLOCK-Pro
+// should keep it resident.
+static NV_STATUS test_eviction_scan_resistance(uvm_pmm_eviction_t *eviction)
+{
+    const NvU32 capacity = 64;
+    const NvU32 hot_blocks = capacity / 2;
+    const NvU32 stream_blocks = capacity * 4;
+    const NvU32 rounds = 16;
+    const NvU32 num_blocks = hot_blocks + stream_blocks * rounds;
+    const NvU64 num_uses = (NvU64)(hot_blocks + stream_blocks) * rounds;
+    eviction_sim_result_t lru;
+    eviction_sim_result_t clock_pro;
+    NvU32 *trace;
+    NvU64 num_trace = 0;
+    NvU32 next_stream_block = hot_blocks;
+    NV_STATUS status;
+    NvU32 round;
+    NvU32 i;
+
+    trace = uvm_kvmalloc(num_uses * sizeof(*trace));
+    if (!trace)
+        return NV_ERR_NO_MEMORY;
+
+    for (round = 0; round < rounds; ++round) {
+        for (i = 0; i < hot_blocks; ++i)
+            trace[num_trace++] = i;
+        for (i = 0; i < stream_blocks; ++i)
+            trace[num_trace++] = next_stream_block++;
+    }
+
+    UVM_ASSERT(num_trace == num_uses);
+
+    eviction_test_init(eviction);
+    status = eviction_simulate(eviction, UVM_PMM_EVICTION_POLICY_LRU, trace, num_uses, num_blocks, capacity, &lru);
+    TEST_NV_CHECK_GOTO(status, done);
+
+    eviction_test_init(eviction);
+    status = eviction_simulate(eviction,
+                               UVM_PMM_EVICTION_POLICY_CLOCK_PRO,
+                               trace,
+                               num_uses,
+                               num_blocks,
+                               capacity,
+                               &clock_pro);
+    TEST_NV_CHECK_GOTO(status, done);
+
+    TEST_CHECK_GOTO(lru.hits == 0, done);
+
+    // The working set needs to be evicted once to be detected by the ghost
+    // entries. Allow for a few collisions in the ghost table.
+    TEST_CHECK_GOTO(clock_pro.hits >= (NvU64)hot_blocks * (rounds - 2) / 2, done);
+    TEST_CHECK_GOTO(clock_pro.hits + clock_pro.misses == num_uses, done);
+
+done:
+    uvm_kvfree(trace);
+
+    return status;
+}
+
+NV_STATUS uvm_test_pmm_eviction_sanity(UVM_TEST_PMM_EVICTION_SANITY_PARAMS *params, struct file *filp)
+{
+    uvm_pmm_eviction_t *eviction;
+    NV_STATUS status;
+
+    eviction = uvm_kvmalloc(sizeof(*eviction));
+    if (!eviction)
+        return NV_ERR_NO_MEMORY;
+
+    status = test_eviction_state(eviction);
+    if (status == NV_OK)
+        status = test_eviction_scan_resistance(eviction);
+
+    uvm_kvfree(eviction);
+
+    return status;
+}
+
+NV_STATUS uvm_test_pmm_eviction_simulate(UVM_TEST_PMM_EVICTION_SIMULATE_PARAMS *params, struct file *filp)
+{
+    uvm_pmm_eviction_t *eviction = NULL;
+    eviction_sim_result_t result;
+    NvU32 *trace = NULL;
+    NV_STATUS status;
+    NvU64 i;
+
+    if (params->num_uses == 0 || params->num_uses > UVM_TEST_PMM_EVICTION_SIMULATE_MAX_USES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->num_blocks == 0 || params->num_blocks > UVM_TEST_PMM_EVICTION_SIMULATE_MAX_BLOCKS)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->capacity == 0 || params->capacity > params->num_blocks)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->policy >= UVM_TEST_PMM_EVICTION_POLICY_MAX)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    BUILD_BUG_ON((int)UVM_TEST_PMM_EVICTION_POLICY_MAX != (int)UVM_PMM_EVICTION_POLICY_COUNT);
+
+    eviction = uvm_kvmalloc(sizeof(*eviction));
+    trace = uvm_kvmalloc(params->num_uses * sizeof(*trace));
+    if (!eviction || !trace) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    if (copy_from_user(trace, (const void __user *)params->trace, params->num_uses * sizeof(*trace))) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto done;
+    }
+
+    for (i = 0; i < params->num_uses; ++i) {
+        if (trace[i] >= params->num_blocks) {
+            status = NV_ERR_INVALID_ARGUMENT;
+            goto done;
+        }
+    }
+
+    uvm_pmm_eviction_init(eviction);
+
+    status = eviction_simulate(eviction,
+                               params->policy,
+                               trace,
+                               params->num_uses,
+                               params->num_blocks,
+                               params->capacity,
+                               &result);
+    if (status != NV_OK)
+        goto done;
+
+    params->hits = result.hits;
+    params->misses = result.misses;
+    params->evictions = result.evictions;
+    params->ghost_hits = eviction->stats.num_ghost_hits;
+    params->promotions = eviction->stats.num_promotions;
+    params->demotions = eviction->stats.num_demotions;
+
+done:
+    uvm_kvfree(trace);
+    uvm_kvfree(eviction);
+
+    return status;
+}
+
+NV_STATUS uvm_test_set_pmm_eviction_policy(UVM_TEST_SET_PMM_EVICTION_POLICY_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+
+    if (params->policy >= UVM_TEST_PMM_EVICTION_POLICY_MAX)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    uvm_va_space_down_write(va_space);
+    va_space->pmm_eviction_policy = params->policy;
+    uvm_va_space_up_write(va_space);
+
+    return NV_OK;
+}
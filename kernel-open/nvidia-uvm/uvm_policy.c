@@ -157,6 +157,49 @@ static NV_STATUS split_span_as_needed(uvm_va_space_t *va_space,
     return split_as_needed(va_space, end_addr, split_needed_cb, data);
 }
 
+// Returns true if split_as_needed() would have to split the VA range
+// containing addr, or would fail. addr must be the start or the exclusive end
+// of a span covered by managed ranges, so if addr is not in a VA range, any HMM
+// policy containing it starts at addr and doesn't need a split either.
+static bool split_is_needed(uvm_va_space_t *va_space,
+                            NvU64 addr,
+                            uvm_va_policy_is_split_needed_t split_needed_cb,
+                            void *data)
+{
+    uvm_va_range_managed_t *managed_range;
+    uvm_va_range_t *va_range;
+
+    UVM_ASSERT(PAGE_ALIGNED(addr));
+
+    va_range = uvm_va_range_find(va_space, addr);
+    if (!va_range)
+        return false;
+
+    if (addr == va_range->node.start)
+        return false;
+
+    managed_range = uvm_va_range_to_managed_or_null(va_range);
+    if (!managed_range)
+        return true;
+
+    return split_needed_cb(&managed_range->policy, data);
+}
+
+// Returns true if split_span_as_needed() would have to change the VA ranges.
+// Unlike split_span_as_needed(), this only requires the VA space lock in read
+// mode.
+static bool split_span_is_needed(uvm_va_space_t *va_space,
+                                 NvU64 start_addr,
+                                 NvU64 end_addr,
+                                 uvm_va_policy_is_split_needed_t split_needed_cb,
+                                 void *data)
+{
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    return split_is_needed(va_space, start_addr, split_needed_cb, data) ||
+           split_is_needed(va_space, end_addr, split_needed_cb, data);
+}
+
 typedef struct
 {
     uvm_processor_id_t processor_id;
@@ -860,6 +903,125 @@ static bool read_duplication_is_split_needed(const uvm_va_policy_t *policy, void
     return policy->read_duplication != new_policy;
 }
 
+// Update the blocks of managed_range to its current read duplication policy.
+// This does the same as uvm_va_range_set_read_duplication() and
+// uvm_va_range_unset_read_duplication(), which can't be used by
+// read_duplication_set_range_locked() since they expect the policy to not be
+// updated yet, and since they use the VA space block context.
+static NV_STATUS read_duplication_update_blocks(uvm_va_range_managed_t *managed_range,
+                                                uvm_va_block_context_t *va_block_context)
+{
+    uvm_va_space_t *va_space = managed_range->va_range.va_space;
+    bool enable = managed_range->policy.read_duplication == UVM_READ_DUPLICATION_ENABLED;
+    uvm_va_block_t *va_block;
+
+    uvm_assert_range_locked(&va_space->range_lock,
+                            managed_range->va_range.node.start,
+                            managed_range->va_range.node.end);
+
+    for_each_va_block_in_va_range(managed_range, va_block) {
+        NV_STATUS status;
+
+        if (enable)
+            status = uvm_va_block_set_read_duplication(va_block, va_block_context);
+        else
+            status = uvm_va_block_unset_read_duplication(va_block, va_block_context);
+
+        if (status != NV_OK)
+            return status;
+    }
+
+    return NV_OK;
+}
+
+// Set the read duplication policy of [base, base + length) with the VA space
+// lock held in read mode and the range locked, so that policy changes on
+// other ranges and fault servicing aren't blocked while the blocks are
+// updated. This is only possible if the span is covered by managed ranges and
+// none of them needs to be split. Otherwise NV_WARN_MORE_PROCESSING_REQUIRED is
+// returned, and the caller has to take the VA space lock in write mode.
+static NV_STATUS read_duplication_set_range_locked(uvm_va_space_t *va_space,
+                                                   struct mm_struct *mm,
+                                                   NvU64 base,
+                                                   NvU64 length,
+                                                   uvm_read_duplication_policy_t new_policy)
+{
+    const NvU64 last_address = base + length - 1;
+    uvm_range_lock_entry_t range_lock_entry;
+    uvm_va_block_context_t *va_block_context;
+    uvm_va_range_managed_t *managed_range;
+    NV_STATUS status = NV_OK;
+
+    if (uvm_api_range_invalid(base, length))
+        return NV_WARN_MORE_PROCESSING_REQUIRED;
+
+    va_block_context = uvm_va_block_context_alloc(mm);
+    if (!va_block_context)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_va_space_down_read(va_space);
+
+    if (uvm_api_range_type_check(va_space, mm, base, length) != UVM_API_RANGE_TYPE_MANAGED ||
+        uvm_va_space_has_integrated_gpu(va_space)) {
+        status = NV_WARN_MORE_PROCESSING_REQUIRED;
+        goto out;
+    }
+
+    uvm_range_lock(&va_space->range_lock, &range_lock_entry, base, last_address);
+
+    // The split check has to be done with the range locked, since other range
+    // lock holders may change the policy of the ranges at the ends of the
+    // span until then.
+    if (split_span_is_needed(va_space, base, last_address + 1, read_duplication_is_split_needed, &new_policy)) {
+        status = NV_WARN_MORE_PROCESSING_REQUIRED;
+        goto out_unlock;
+    }
+
+    uvm_for_each_va_range_managed_in_contig(managed_range, va_space, base, last_address) {
+        // Since no split is needed, ranges which are not fully covered already
+        // have the new policy and are left alone. The ranges updated below are
+        // then all covered by the range lock.
+        if (managed_range->policy.read_duplication == new_policy)
+            continue;
+
+        UVM_ASSERT(managed_range->va_range.node.start >= base);
+        UVM_ASSERT(managed_range->va_range.node.end <= last_address);
+
+        // Unlike on the write-locked path, the policy is updated before the
+        // blocks, since faults may be serviced concurrently. They look up the
+        // policy under the block lock, so faults on a block serviced after it
+        // has been updated observe the new policy, and any state created by
+        // earlier faults is handled by the update.
+        WRITE_ONCE(managed_range->policy.read_duplication, new_policy);
+
+        // If the va_space cannot currently read duplicate, only change the
+        // user state. All memory should already have read duplication unset.
+        if (!uvm_va_space_can_read_duplicate(va_space, NULL))
+            continue;
+
+        if (new_policy == UVM_READ_DUPLICATION_ENABLED) {
+            status = read_duplication_update_blocks(managed_range, va_block_context);
+            if (status != NV_OK)
+                break;
+        }
+        else {
+            // If unsetting read duplication fails, the return status is not
+            // propagated back to the caller
+            (void)read_duplication_update_blocks(managed_range, va_block_context);
+        }
+    }
+
+out_unlock:
+    uvm_range_unlock(&va_space->range_lock, &range_lock_entry);
+
+out:
+    uvm_va_space_up_read(va_space);
+
+    uvm_va_block_context_free(va_block_context);
+
+    return status;
+}
+
 static NV_STATUS read_duplication_set(uvm_va_space_t *va_space, NvU64 base, NvU64 length, bool enable)
 {
     struct mm_struct *mm;
@@ -870,8 +1032,18 @@ static NV_STATUS read_duplication_set(uvm_va_space_t *va_space, NvU64 base, NvU6
 
     UVM_ASSERT(va_space);
 
+    // Note that we never set the policy back to UNSET
+    new_policy = enable ? UVM_READ_DUPLICATION_ENABLED : UVM_READ_DUPLICATION_DISABLED;
+
     // We need mmap_lock as we may create CPU mappings
     mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+
+    // Policy changes which don't split VA ranges don't need to take the VA
+    // space lock in write mode.
+    status = read_duplication_set_range_locked(va_space, mm, base, length, new_policy);
+    if (status != NV_WARN_MORE_PROCESSING_REQUIRED)
+        goto out;
+
     uvm_va_space_down_write(va_space);
 
     type = uvm_api_range_type_check(va_space, mm, base, length);
@@ -890,9 +1062,6 @@ static NV_STATUS read_duplication_set(uvm_va_space_t *va_space, NvU64 base, NvU6
         goto done;
     }
 
-    // Note that we never set the policy back to UNSET
-    new_policy = enable ? UVM_READ_DUPLICATION_ENABLED : UVM_READ_DUPLICATION_DISABLED;
-
     status = split_span_as_needed(va_space,
                                   base,
                                   last_address + 1,
@@ -942,6 +1111,8 @@ static NV_STATUS read_duplication_set(uvm_va_space_t *va_space, NvU64 base, NvU6
 
 done:
     uvm_va_space_up_write(va_space);
+
+out:
     uvm_va_space_mm_or_current_release_unlock(va_space, mm);
     return status;
 }
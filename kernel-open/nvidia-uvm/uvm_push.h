@@ -109,6 +109,11 @@ struct uvm_push_struct
 
     // Channel to use for indirect submission
     uvm_channel_t *launch_channel;
+
+    // Number of bytes written by CE memcopy and memset methods in the push.
+    // Used by the channel manager to balance the load across channels and
+    // CEs.
+    NvU64 copy_bytes;
 };
 
 #define UVM_PUSH_ACQUIRE_INFO_MAX_ENTRIES 16
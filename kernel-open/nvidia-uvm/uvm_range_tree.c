@@ -95,6 +95,76 @@ static uvm_range_tree_node_t *range_node_find(uvm_range_tree_t *tree,
     return node;
 }
 
+// Version of range_node_find which first looks up addr around the cached node
+// and falls back to walking the tree, updating the cached node on a tree walk
+// hit. The next pointer is set as in range_node_find.
+static uvm_range_tree_node_t *range_node_find_cached(uvm_range_tree_t *tree,
+                                                     NvU64 addr,
+                                                     uvm_range_tree_node_t **next)
+{
+    uvm_range_tree_node_t *cached = READ_ONCE(tree->cached_node);
+    uvm_range_tree_node_t *node;
+
+    if (cached) {
+        uvm_range_tree_node_t *lower, *upper;
+
+        if (addr >= cached->start && addr <= cached->end) {
+            if (next)
+                *next = uvm_range_tree_next(tree, cached);
+            return cached;
+        }
+
+        // Find the two nodes around cached that bracket addr. If addr falls
+        // in one of them or in the hole between them, the tree walk can be
+        // skipped.
+        if (addr > cached->end) {
+            lower = cached;
+            upper = uvm_range_tree_next(tree, cached);
+            if (upper && addr >= upper->start) {
+                if (addr > upper->end)
+                    goto walk;
+
+                node = upper;
+                goto found;
+            }
+        }
+        else {
+            lower = uvm_range_tree_prev(tree, cached);
+            upper = cached;
+            if (lower && addr <= lower->end) {
+                if (addr < lower->start)
+                    goto walk;
+
+                node = lower;
+                goto found;
+            }
+        }
+
+        // addr is in the hole between lower and upper
+        if (next)
+            *next = upper;
+        return NULL;
+    }
+
+walk:
+    node = range_node_find(tree, addr, NULL, next);
+    if (node && READ_ONCE(tree->cached_node) != node)
+        WRITE_ONCE(tree->cached_node, node);
+
+    return node;
+
+found:
+    if (next)
+        *next = uvm_range_tree_next(tree, node);
+
+    // Skip the store when the cache already points at node so that lookups
+    // hitting the same node from many threads don't bounce the cache line.
+    if (READ_ONCE(tree->cached_node) != node)
+        WRITE_ONCE(tree->cached_node, node);
+
+    return node;
+}
+
 void uvm_range_tree_init(uvm_range_tree_t *tree)
 {
     memset(tree, 0, sizeof(*tree));
@@ -210,7 +280,7 @@ uvm_range_tree_node_t *uvm_range_tree_merge_next(uvm_range_tree_t *tree, uvm_ran
 
 uvm_range_tree_node_t *uvm_range_tree_find(uvm_range_tree_t *tree, NvU64 addr)
 {
-    return range_node_find(tree, addr, NULL, NULL);
+    return range_node_find_cached(tree, addr, NULL);
 }
 
 uvm_range_tree_node_t *uvm_range_tree_iter_first(uvm_range_tree_t *tree, NvU64 start, NvU64 end)
@@ -219,7 +289,7 @@ uvm_range_tree_node_t *uvm_range_tree_iter_first(uvm_range_tree_t *tree, NvU64 s
 
     UVM_ASSERT(start <= end);
 
-    node = range_node_find(tree, start, NULL, &next);
+    node = range_node_find_cached(tree, start, &next);
     if (node)
         return node;
 
@@ -42,6 +42,16 @@ typedef struct uvm_range_tree_struct
     // to avoid calling rb_next and rb_prev frequently, particularly while
     // iterating.
     struct list_head head;
+
+    // Node returned by the last lookup that had to walk the tree, or NULL.
+    // Lookups first check this node and its neighbors in address order, which
+    // covers repeated and sequential accesses without walking the tree.
+    //
+    // Lookups only run concurrently with other lookups, so the node is always
+    // in the tree. It is updated with WRITE_ONCE() since concurrent lookups may
+    // race to update it, and only when it changes to avoid bouncing the cache
+    // line between readers.
+    struct uvm_range_tree_node_struct *cached_node;
 } uvm_range_tree_t;
 
 typedef struct uvm_range_tree_node_struct
@@ -64,6 +74,9 @@ NV_STATUS uvm_range_tree_add(uvm_range_tree_t *tree, uvm_range_tree_node_t *node
 
 static void uvm_range_tree_remove(uvm_range_tree_t *tree, uvm_range_tree_node_t *node)
 {
+    if (tree->cached_node == node)
+        tree->cached_node = NULL;
+
     rb_erase(&node->rb_node, &tree->rb_root);
     list_del(&node->list);
 }
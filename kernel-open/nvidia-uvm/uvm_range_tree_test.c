@@ -894,6 +894,78 @@ static NV_STATUS rtt_index_merge_check_next_val(rtt_state_t *state, NvU64 addr)
     return rtt_index_merge_check_next(state, index);
 }
 
+// Lookups served from around the cached node must match a full tree walk, and
+// removing the cached node must drop it from the cache.
+static NV_STATUS rtt_directed_cached_lookups(rtt_state_t *state)
+{
+    uvm_range_tree_t *tree = &state->tree;
+    uvm_range_tree_node_t *node;
+
+    MEM_NV_CHECK_RET(rtt_range_add_check_val(state,  10, 19), NV_OK);
+    MEM_NV_CHECK_RET(rtt_range_add_check_val(state,  30, 39), NV_OK);
+    MEM_NV_CHECK_RET(rtt_range_add_check_val(state,  40, 49), NV_OK); // [10-19] [30-39][40-49]
+
+    // Hits in the cached node and its neighbors
+    node = uvm_range_tree_find(tree, 35);
+    TEST_CHECK_RET(node && node->start == 30);
+    TEST_CHECK_RET(tree->cached_node == node);
+    node = uvm_range_tree_find(tree, 45);
+    TEST_CHECK_RET(node && node->start == 40);
+    TEST_CHECK_RET(tree->cached_node == node);
+    node = uvm_range_tree_find(tree, 30);
+    TEST_CHECK_RET(node && node->start == 30);
+    TEST_CHECK_RET(tree->cached_node == node);
+
+    // Holes around the cached node don't change it
+    TEST_CHECK_RET(uvm_range_tree_find(tree, 25) == NULL);
+    TEST_CHECK_RET(uvm_range_tree_find(tree, 50) == NULL);
+    TEST_CHECK_RET(uvm_range_tree_find(tree, 5) == NULL);
+    TEST_CHECK_RET(tree->cached_node == node);
+
+    // Holes and nodes farther away
+    node = uvm_range_tree_iter_first(tree, 20, 29);
+    TEST_CHECK_RET(node == NULL);
+    node = uvm_range_tree_iter_first(tree, 0, 12);
+    TEST_CHECK_RET(node && node->start == 10);
+    node = uvm_range_tree_iter_first(tree, 50, ULLONG_MAX);
+    TEST_CHECK_RET(node == NULL);
+    node = uvm_range_tree_iter_first(tree, 20, 30);
+    TEST_CHECK_RET(node && node->start == 30);
+
+    node = uvm_range_tree_find(tree, 15);
+    TEST_CHECK_RET(node && node->start == 10);
+    node = uvm_range_tree_find(tree, 49);
+    TEST_CHECK_RET(node && node->start == 40);
+    TEST_CHECK_RET(tree->cached_node == node);
+
+    // Removing the cached node. The checks done by the helpers may cache
+    // other nodes, but never the removed one. Its pointer is only compared.
+    MEM_NV_CHECK_RET(rtt_index_remove_check_val(state, 40), NV_OK);   // [10-19] [30-39]
+    TEST_CHECK_RET(tree->cached_node != node);
+    TEST_CHECK_RET(uvm_range_tree_find(tree, 45) == NULL);
+
+    // Merging the cached node away
+    MEM_NV_CHECK_RET(rtt_range_add_check_val(state, 20, 29), NV_OK);  // [10-19][20-29][30-39]
+    node = uvm_range_tree_find(tree, 35);
+    TEST_CHECK_RET(node && tree->cached_node == node);
+    MEM_NV_CHECK_RET(rtt_index_merge_check_next_val(state, 20), NV_OK); // [10-19][20-----39]
+    TEST_CHECK_RET(tree->cached_node != node);
+    node = uvm_range_tree_find(tree, 35);
+    TEST_CHECK_RET(node && node->start == 20);
+
+    // Splitting the cached node
+    MEM_NV_CHECK_RET(rtt_node_split_check_val(state, 24), NV_OK);     // [10-19][20-24][25-39]
+    node = uvm_range_tree_find(tree, 35);
+    TEST_CHECK_RET(node && node->start == 25);
+    node = uvm_range_tree_find(tree, 22);
+    TEST_CHECK_RET(node && node->start == 20);
+
+    MEM_NV_CHECK_RET(rtt_remove_all_check(state), NV_OK);
+    TEST_CHECK_RET(tree->cached_node == NULL);
+
+    return NV_OK;
+}
+
 static NV_STATUS rtt_directed(rtt_state_t *state)
 {
     uvm_range_tree_node_t *node, *next;
@@ -995,6 +1067,8 @@ static NV_STATUS rtt_directed(rtt_state_t *state)
     MEM_NV_CHECK_RET(rtt_range_add_check_val(state,   11, 15), NV_OK);                     //   [4][5--9][10][11-15][16]
     MEM_NV_CHECK_RET(rtt_remove_all_check(state),              NV_OK);
 
+    TEST_NV_CHECK_RET(rtt_directed_cached_lookups(state));
+
     return NV_OK;
 }
 
@@ -1714,3 +1788,182 @@ NV_STATUS uvm_test_range_tree_random(UVM_TEST_RANGE_TREE_RANDOM_PARAMS *params,
     rtt_state_destroy(state);
     return status;
 }
+
+// ---------------------------- Benchmark ---------------------------- //
+
+// Benchmark ranges are RTT_BENCH_RANGE_SIZE bytes long and start every
+// RTT_BENCH_STRIDE bytes, so half of the address space is covered by holes.
+#define RTT_BENCH_RANGE_SIZE  (64 * 1024ULL)
+#define RTT_BENCH_STRIDE      (2 * RTT_BENCH_RANGE_SIZE)
+#define RTT_BENCH_MAX_RANGES  (1024 * 1024)
+#define RTT_BENCH_MAX_ITERS   (4 * 1024 * 1024)
+
+// Number of ranges of the window used by UVM_TEST_RANGE_TREE_LOCALITY_HOT, and
+// number of lookups before the window moves.
+#define RTT_BENCH_HOT_RANGES  16
+#define RTT_BENCH_HOT_PERIOD  1024
+
+static void rtt_bench_gen_addrs(uvm_test_rng_t *rng,
+                                UVM_TEST_RANGE_TREE_LOCALITY locality,
+                                NvU32 num_ranges,
+                                NvU64 *addrs,
+                                NvU32 count)
+{
+    NvU64 max_addr = num_ranges * RTT_BENCH_STRIDE;
+    NvU32 hot_base = 0;
+    NvU32 i;
+
+    for (i = 0; i < count; i++) {
+        NvU32 range_index;
+
+        switch (locality) {
+            case UVM_TEST_RANGE_TREE_LOCALITY_SEQUENTIAL:
+                // Eight lookups per stride, half of them in the hole
+                addrs[i] = (i * (RTT_BENCH_STRIDE / 8)) % max_addr;
+                continue;
+
+            case UVM_TEST_RANGE_TREE_LOCALITY_HOT:
+                if (i % RTT_BENCH_HOT_PERIOD == 0) {
+                    NvU32 max_base = num_ranges > RTT_BENCH_HOT_RANGES ? num_ranges - RTT_BENCH_HOT_RANGES : 0;
+                    hot_base = uvm_test_rng_range_32(rng, 0, max_base);
+                }
+
+                range_index = min(num_ranges, (NvU32)RTT_BENCH_HOT_RANGES);
+                range_index = hot_base + uvm_test_rng_range_32(rng, 0, range_index - 1);
+                break;
+
+            default:
+                range_index = uvm_test_rng_range_32(rng, 0, num_ranges - 1);
+                break;
+        }
+
+        addrs[i] = range_index * RTT_BENCH_STRIDE + uvm_test_rng_range_64(rng, 0, RTT_BENCH_STRIDE - 1);
+    }
+}
+
+// Check every lookup against the expected layout, outside of the timed loops
+static NV_STATUS rtt_bench_verify(uvm_range_tree_t *tree,
+                                  uvm_range_tree_node_t *nodes,
+                                  NvU32 num_ranges,
+                                  NvU64 *addrs,
+                                  NvU32 count)
+{
+    NvU32 i;
+
+    for (i = 0; i < count; i++) {
+        NvU64 range_index = addrs[i] / RTT_BENCH_STRIDE;
+        bool in_range = (addrs[i] % RTT_BENCH_STRIDE) < RTT_BENCH_RANGE_SIZE;
+        uvm_range_tree_node_t *expected_first;
+
+        TEST_CHECK_RET(uvm_range_tree_find(tree, addrs[i]) == (in_range ? &nodes[range_index] : NULL));
+
+        if (in_range)
+            expected_first = &nodes[range_index];
+        else if (range_index + 1 < num_ranges)
+            expected_first = &nodes[range_index + 1];
+        else
+            expected_first = NULL;
+
+        TEST_CHECK_RET(uvm_range_tree_iter_first(tree, addrs[i], addrs[i] + RTT_BENCH_STRIDE - 1) == expected_first);
+    }
+
+    return NV_OK;
+}
+
+static NvU64 rtt_bench_find(uvm_range_tree_t *tree, NvU64 *addrs, NvU32 count, bool nocache, NvU32 *hits)
+{
+    NvU64 start_time = NV_GETTIME();
+    NvU32 i;
+
+    *hits = 0;
+
+    for (i = 0; i < count; i++) {
+        if (nocache)
+            tree->cached_node = NULL;
+
+        if (uvm_range_tree_find(tree, addrs[i]))
+            ++*hits;
+    }
+
+    return NV_GETTIME() - start_time;
+}
+
+static NvU64 rtt_bench_iter_first(uvm_range_tree_t *tree, NvU64 *addrs, NvU32 count, NvU32 *hits)
+{
+    NvU64 start_time = NV_GETTIME();
+    NvU32 i;
+
+    *hits = 0;
+
+    for (i = 0; i < count; i++) {
+        if (uvm_range_tree_iter_first(tree, addrs[i], addrs[i] + RTT_BENCH_STRIDE - 1))
+            ++*hits;
+    }
+
+    return NV_GETTIME() - start_time;
+}
+
+NV_STATUS uvm_test_range_tree_benchmark(UVM_TEST_RANGE_TREE_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    uvm_range_tree_t tree;
+    uvm_range_tree_node_t *nodes;
+    uvm_test_rng_t rng;
+    NvU64 *addrs;
+    NvU32 locality;
+    NvU32 i;
+    NV_STATUS status = NV_OK;
+
+    if (params->num_ranges == 0 ||
+        params->num_ranges > RTT_BENCH_MAX_RANGES ||
+        params->iterations == 0 ||
+        params->iterations > RTT_BENCH_MAX_ITERS)
+        return NV_ERR_INVALID_PARAMETER;
+
+    nodes = uvm_kvmalloc_zero(params->num_ranges * sizeof(*nodes));
+    addrs = uvm_kvmalloc(params->iterations * sizeof(*addrs));
+    if (!nodes || !addrs) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    uvm_range_tree_init(&tree);
+    uvm_test_rng_init(&rng, params->seed);
+
+    for (i = 0; i < params->num_ranges; i++) {
+        nodes[i].start = i * RTT_BENCH_STRIDE;
+        nodes[i].end = nodes[i].start + RTT_BENCH_RANGE_SIZE - 1;
+        TEST_NV_CHECK_GOTO(uvm_range_tree_add(&tree, &nodes[i]), out);
+    }
+
+    for (locality = 0; locality < UVM_TEST_RANGE_TREE_LOCALITY_COUNT; locality++) {
+        NvU32 find_hits, nocache_hits, iter_hits;
+        NvU64 ns;
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto out;
+        }
+
+        rtt_bench_gen_addrs(&rng, locality, params->num_ranges, addrs, params->iterations);
+
+        TEST_NV_CHECK_GOTO(rtt_bench_verify(&tree, nodes, params->num_ranges, addrs, params->iterations), out);
+
+        ns = rtt_bench_find(&tree, addrs, params->iterations, false, &find_hits);
+        params->find_ns_per_op[locality] = ns / params->iterations;
+
+        ns = rtt_bench_find(&tree, addrs, params->iterations, true, &nocache_hits);
+        params->find_nocache_ns_per_op[locality] = ns / params->iterations;
+
+        ns = rtt_bench_iter_first(&tree, addrs, params->iterations, &iter_hits);
+        params->iter_first_ns_per_op[locality] = ns / params->iterations;
+
+        TEST_CHECK_GOTO(find_hits == nocache_hits, out);
+        TEST_CHECK_GOTO(iter_hits >= find_hits, out);
+    }
+
+out:
+    uvm_kvfree(addrs);
+    uvm_kvfree(nodes);
+
+    return status;
+}
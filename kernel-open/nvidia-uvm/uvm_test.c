@@ -360,6 +360,30 @@ long uvm_test_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_VA_BLOCK_DISCARD_STATUS,      uvm_test_va_block_discard_status);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_GET_ALLOC_LIST,           uvm_test_pmm_get_alloc_list);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_DUMP_ACCESS_BITS,             uvm_test_dump_access_bits);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_PREFETCH_STREAM_SANITY,  uvm_test_perf_prefetch_stream_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_PREFETCH_STREAM_REPLAY,  uvm_test_perf_prefetch_stream_replay);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_EVICTION_SANITY,          uvm_test_pmm_eviction_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_EVICTION_SIMULATE,        uvm_test_pmm_eviction_simulate);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_SET_PMM_EVICTION_POLICY,      uvm_test_set_pmm_eviction_policy);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_TOOLS_EVENT_BENCHMARK,        uvm_test_tools_event_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK, uvm_test_page_tree_prebuild_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_CE_COALESCER_SANITY,          uvm_test_ce_coalescer_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_THRASHING_CLASSIFY_SANITY,
+                                       uvm_test_perf_thrashing_classify_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_BATCH_SORT_BENCHMARK,         uvm_test_batch_sort_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_TIERING_SANITY,          uvm_test_perf_tiering_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_TIERING_SPARSE_MIGRATE,  uvm_test_perf_tiering_sparse_migrate);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_KVMALLOC_BENCHMARK,           uvm_test_kvmalloc_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_RANGE_LOCK_BENCHMARK,         uvm_test_range_lock_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_RANGE_TREE_BENCHMARK,         uvm_test_range_tree_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GPU_BROADCAST_PLAN,           uvm_test_gpu_broadcast_plan);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_TRACKER_BENCHMARK,            uvm_test_tracker_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_HMM_MIGRATE_BENCHMARK,        uvm_test_hmm_migrate_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMA_BATCH_BENCHMARK,          uvm_test_pma_batch_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMA_CONTENTION_BENCHMARK,     uvm_test_pma_contention_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_READ_DUPLICATION_RACE,        uvm_test_read_duplication_race);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PERF_TIERING_STATS,           uvm_test_perf_tiering_stats);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_VA_BLOCK_CPU_CHUNK_MERGE,     uvm_test_va_block_cpu_chunk_merge);
     }
 
     return -EINVAL;
@@ -102,24 +102,34 @@ long uvm_test_ioctl(struct file *filp, unsigned int cmd, unsigned long arg);
 
 NV_STATUS uvm_test_range_tree_directed(UVM_TEST_RANGE_TREE_DIRECTED_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_range_tree_random(UVM_TEST_RANGE_TREE_RANDOM_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_range_tree_benchmark(UVM_TEST_RANGE_TREE_BENCHMARK_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_range_allocator_sanity(UVM_TEST_RANGE_ALLOCATOR_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_page_tree(UVM_TEST_PAGE_TREE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_page_tree_prebuild_benchmark(UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK_PARAMS *params,
+                                                struct file *filp);
 NV_STATUS uvm_test_rm_mem_sanity(UVM_TEST_RM_MEM_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_mem_sanity(UVM_TEST_MEM_SANITY_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_gpu_semaphore_sanity(UVM_TEST_GPU_SEMAPHORE_SANITY_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_tracker_sanity(UVM_TEST_TRACKER_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_tracker_benchmark(UVM_TEST_TRACKER_BENCHMARK_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_push_sanity(UVM_TEST_PUSH_SANITY_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_channel_sanity(UVM_TEST_CHANNEL_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_channel_stress(UVM_TEST_CHANNEL_STRESS_PARAMS *params, struct file *filp);
 
+NV_STATUS uvm_test_gpu_broadcast_plan(UVM_TEST_GPU_BROADCAST_PLAN_PARAMS *params, struct file *filp);
+
 NV_STATUS uvm_test_ce_sanity(UVM_TEST_CE_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_batch_sort_benchmark(UVM_TEST_BATCH_SORT_BENCHMARK_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_ce_coalescer_sanity(UVM_TEST_CE_COALESCER_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_host_sanity(UVM_TEST_HOST_SANITY_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_lock_sanity(UVM_TEST_LOCK_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_range_lock_benchmark(UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_read_duplication_race(UVM_TEST_READ_DUPLICATION_RACE_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_perf_utils_sanity(UVM_TEST_PERF_UTILS_SANITY_PARAMS *params, struct file *filp);
 
@@ -128,6 +138,9 @@ NV_STATUS uvm_test_pmm_sanity(UVM_TEST_PMM_SANITY_PARAMS *params, struct file *f
 NV_STATUS uvm_test_pmm_check_leak(UVM_TEST_PMM_CHECK_LEAK_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_pmm_async_alloc(UVM_TEST_PMM_ASYNC_ALLOC_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_pma_alloc_free(UVM_TEST_PMA_ALLOC_FREE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pma_batch_benchmark(UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pma_contention_benchmark(UVM_TEST_PMA_CONTENTION_BENCHMARK_PARAMS *params,
+                                            struct file *filp);
 NV_STATUS uvm_test_pma_get_batch_size(UVM_TEST_PMA_GET_BATCH_SIZE_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_pmm_alloc_free_root(UVM_TEST_PMM_ALLOC_FREE_ROOT_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_pmm_inject_pma_evict_error(UVM_TEST_PMM_INJECT_PMA_EVICT_ERROR_PARAMS *params, struct file *filp);
@@ -154,6 +167,8 @@ NV_STATUS uvm_test_flush_deferred_work(UVM_TEST_FLUSH_DEFERRED_WORK_PARAMS *para
 NV_STATUS uvm_test_set_page_prefetch_policy(UVM_TEST_SET_PAGE_PREFETCH_POLICY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_get_page_thrashing_policy(UVM_TEST_GET_PAGE_THRASHING_POLICY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_set_page_thrashing_policy(UVM_TEST_SET_PAGE_THRASHING_POLICY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_perf_thrashing_classify_sanity(UVM_TEST_PERF_THRASHING_CLASSIFY_SANITY_PARAMS *params,
+                                                  struct file *filp);
 
 NV_STATUS uvm_test_range_group_tree(UVM_TEST_RANGE_GROUP_TREE_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_range_group_range_info(UVM_TEST_RANGE_GROUP_RANGE_INFO_PARAMS *params, struct file *filp);
@@ -189,6 +204,17 @@ NV_STATUS uvm_test_register_unload_state_buffer(UVM_TEST_REGISTER_UNLOAD_STATE_B
 NV_STATUS uvm_test_rb_tree_directed(UVM_TEST_RB_TREE_DIRECTED_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_rb_tree_random(UVM_TEST_RB_TREE_RANDOM_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_dump_access_bits(UVM_TEST_DUMP_ACCESS_BITS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_perf_prefetch_stream_sanity(UVM_TEST_PERF_PREFETCH_STREAM_SANITY_PARAMS *params,
+                                               struct file *filp);
+NV_STATUS uvm_test_perf_prefetch_stream_replay(UVM_TEST_PERF_PREFETCH_STREAM_REPLAY_PARAMS *params,
+                                               struct file *filp);
+NV_STATUS uvm_test_perf_tiering_sanity(UVM_TEST_PERF_TIERING_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_perf_tiering_sparse_migrate(UVM_TEST_PERF_TIERING_SPARSE_MIGRATE_PARAMS *params,
+                                               struct file *filp);
+NV_STATUS uvm_test_perf_tiering_stats(UVM_TEST_PERF_TIERING_STATS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pmm_eviction_sanity(UVM_TEST_PMM_EVICTION_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pmm_eviction_simulate(UVM_TEST_PMM_EVICTION_SIMULATE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_set_pmm_eviction_policy(UVM_TEST_SET_PMM_EVICTION_POLICY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_sec2_sanity(UVM_TEST_SEC2_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_sec2_cpu_gpu_roundtrip(UVM_TEST_SEC2_CPU_GPU_ROUNDTRIP_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_cpu_chunk_api(UVM_TEST_CPU_CHUNK_API_PARAMS *params, struct file *filp);
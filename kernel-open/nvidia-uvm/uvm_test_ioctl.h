@@ -1581,6 +1581,443 @@ typedef struct
     NV_STATUS rmStatus;                                  // Out
 } UVM_TEST_DUMP_ACCESS_BITS_PARAMS;
 
+#define UVM_TEST_PERF_PREFETCH_STREAM_SANITY             UVM_TEST_IOCTL_BASE(113)
+typedef struct
+{
+    NV_STATUS rmStatus;                                  // Out
+} UVM_TEST_PERF_PREFETCH_STREAM_SANITY_PARAMS;
+
+typedef struct
+{
+    NvU64 address   NV_ALIGN_BYTES(8);
+    NvU32 processor;
+    NvU32 padding;
+} UVM_TEST_PERF_PREFETCH_STREAM_ACCESS;
+
+#define UVM_TEST_PERF_PREFETCH_STREAM_MAX_ACCESSES       (1024 * 1024)
+
+// Replay an access trace through the stream prefetcher and report how well
+// its predictions match the trace. Accesses to granules that have not been
+// accessed or predicted before are counted as faults and train the predictor.
+// Predicted granules are assumed to be prefetched immediately.
+//
+// processor is an index in the range [0, UVM_ID_MAX_PROCESSORS), with 0 being
+// the CPU.
+#define UVM_TEST_PERF_PREFETCH_STREAM_REPLAY             UVM_TEST_IOCTL_BASE(114)
+typedef struct
+{
+    // Pointer to an array of UVM_TEST_PERF_PREFETCH_STREAM_ACCESS
+    NvU64 accesses                      NV_ALIGN_BYTES(8); // In
+    NvU64 num_accesses                  NV_ALIGN_BYTES(8); // In
+
+    // 0 selects the value of the corresponding module parameter
+    NvU32 confidence_threshold;                            // In
+    NvU32 distance;                                        // In, in units of 64K
+
+    // Number of distinct granules in the trace
+    NvU64 accessed_granules             NV_ALIGN_BYTES(8); // Out
+
+    // Accesses that were neither accessed nor predicted before
+    NvU64 faults                        NV_ALIGN_BYTES(8); // Out
+
+    // Granules predicted by the prefetcher, and how many of them were
+    // accessed later on
+    NvU64 predicted_granules            NV_ALIGN_BYTES(8); // Out
+    NvU64 useful_granules               NV_ALIGN_BYTES(8); // Out
+
+    // useful_granules / predicted_granules
+    NvU32 accuracy_percent;                                // Out
+
+    // useful_granules / accessed_granules
+    NvU32 coverage_percent;                                // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PERF_PREFETCH_STREAM_REPLAY_PARAMS;
+
+#define UVM_TEST_PMM_EVICTION_SANITY                     UVM_TEST_IOCTL_BASE(115)
+typedef struct
+{
+    NV_STATUS rmStatus;                                  // Out
+} UVM_TEST_PMM_EVICTION_SANITY_PARAMS;
+
+typedef enum
+{
+    UVM_TEST_PMM_EVICTION_POLICY_LRU = 0,
+    UVM_TEST_PMM_EVICTION_POLICY_CLOCK_PRO,
+    UVM_TEST_PMM_EVICTION_POLICY_MAX
+} UVM_TEST_PMM_EVICTION_POLICY;
+
+#define UVM_TEST_PMM_EVICTION_SIMULATE_MAX_USES          (16 * 1024 * 1024)
+#define UVM_TEST_PMM_EVICTION_SIMULATE_MAX_BLOCKS        (1024 * 1024)
+
+// Replay a trace of root chunk uses through the PMM eviction policy code on a
+// simulated GPU with room for capacity root chunks. Each entry of the trace is
+// the index of a VA block, smaller than num_blocks, that needs to be resident
+// on the GPU. Uses of blocks that are not resident allocate a root chunk,
+// evicting another block if the simulated GPU is full.
+#define UVM_TEST_PMM_EVICTION_SIMULATE                   UVM_TEST_IOCTL_BASE(116)
+typedef struct
+{
+    // Pointer to an array of NvU32 VA block indices
+    NvU64 trace                         NV_ALIGN_BYTES(8); // In
+    NvU64 num_uses                      NV_ALIGN_BYTES(8); // In
+    NvU32 num_blocks;                                      // In
+    NvU32 capacity;                                        // In
+    NvU32 policy;                                          // In (UVM_TEST_PMM_EVICTION_POLICY)
+
+    NvU64 hits                          NV_ALIGN_BYTES(8); // Out
+    NvU64 misses                        NV_ALIGN_BYTES(8); // Out
+    NvU64 evictions                     NV_ALIGN_BYTES(8); // Out
+    NvU64 ghost_hits                    NV_ALIGN_BYTES(8); // Out
+    NvU64 promotions                    NV_ALIGN_BYTES(8); // Out
+    NvU64 demotions                     NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PMM_EVICTION_SIMULATE_PARAMS;
+
+// Set the eviction policy of the GPU root chunks of the VA space. It only
+// applies to chunks whose VA blocks become resident after this call.
+#define UVM_TEST_SET_PMM_EVICTION_POLICY                 UVM_TEST_IOCTL_BASE(117)
+typedef struct
+{
+    NvU32 policy;                                        // In (UVM_TEST_PMM_EVICTION_POLICY)
+    NV_STATUS rmStatus;                                  // Out
+} UVM_TEST_SET_PMM_EVICTION_POLICY_PARAMS;
+
+// Record iterations GPU fault events in the V2 tools queues of the VA space,
+// doing the same work per event as the fault servicing path, and report the
+// time spent. Events are only recorded if the GPU fault event is enabled in a
+// queue. Running it from multiple threads concurrently with either a regular
+// or a per-CPU queue measures the overhead of each transport under
+// contention.
+#define UVM_TEST_TOOLS_EVENT_BENCHMARK                   UVM_TEST_IOCTL_BASE(118)
+typedef struct
+{
+    NvU32 iterations;                                      // In
+
+    NvU64 total_ns                      NV_ALIGN_BYTES(8); // Out
+    NvU64 ns_per_event                  NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_TOOLS_EVENT_BENCHMARK_PARAMS;
+
+// Measure the first-touch cost of num_blocks consecutive VA blocks on a fake
+// Pascal page tree, with and without prebuilding the page directories of the
+// whole range first (see uvm_perf_va_range_prebuild_pdes). First touch of a
+// block is modeled as getting its 2M entry and allocating its big page table,
+// as done by VA blocks on their first mapping.
+//
+// lazy_ns is the first-touch time of all the blocks on an empty tree.
+// prebuild_ns is the time spent prebuilding the directories of the range, and
+// prebuilt_first_touch_ns is the first-touch time of all the blocks after
+// that.
+#define UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK            UVM_TEST_IOCTL_BASE(119)
+typedef struct
+{
+    NvU32 num_blocks;                                      // In
+
+    NvU64 lazy_ns                       NV_ALIGN_BYTES(8); // Out
+    NvU64 prebuild_ns                   NV_ALIGN_BYTES(8); // Out
+    NvU64 prebuilt_first_touch_ns       NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PAGE_TREE_PREBUILD_BENCHMARK_PARAMS;
+
+// Unit test of the merge logic of the CE coalescer. It doesn't need any GPU.
+#define UVM_TEST_CE_COALESCER_SANITY                     UVM_TEST_IOCTL_BASE(120)
+typedef struct
+{
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_CE_COALESCER_SANITY_PARAMS;
+
+// Unit test of the access pattern classification of thrashing pages. It
+// doesn't need any GPU.
+#define UVM_TEST_PERF_THRASHING_CLASSIFY_SANITY          UVM_TEST_IOCTL_BASE(121)
+typedef struct
+{
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PERF_THRASHING_CLASSIFY_SANITY_PARAMS;
+
+// Compare the bucketed radix sort used to preprocess fault and access counter
+// batches against the comparison sort, on synthetic fault streams. Both sorts
+// are checked to produce the same order. It doesn't need any GPU.
+#define UVM_TEST_BATCH_SORT_BENCHMARK                    UVM_TEST_IOCTL_BASE(122)
+typedef struct
+{
+    NvU32 num_entries;                                     // In
+    NvU32 num_va_spaces;                                   // In
+    NvU32 num_gpus;                                        // In
+
+    // Size in pages of the address range faulted by each VA space. Smaller
+    // ranges produce more duplicate addresses.
+    NvU32 num_pages;                                       // In
+    NvU32 iterations;                                      // In
+    NvU32 seed;                                            // In
+
+    NvU64 radix_sort_ns                 NV_ALIGN_BYTES(8); // Out
+    NvU64 comparison_sort_ns            NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_BATCH_SORT_BENCHMARK_PARAMS;
+
+// Unit tests of the heat tracking of the tiering daemon. It doesn't need any
+// GPU.
+#define UVM_TEST_PERF_TIERING_SANITY                     UVM_TEST_IOCTL_BASE(123)
+typedef struct
+{
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PERF_TIERING_SANITY_PARAMS;
+
+// Stress uvm_kvmalloc with a working set of num_live_objects allocations of
+// random sizes up to max_size. Each iteration frees a random live allocation
+// and replaces it with a new one, which is written to. The same sequence is
+// then replayed with plain kmalloc/kfree for comparison.
+//
+// magazine_hits and magazine_misses are the per-CPU magazine hits and misses
+// observed during the uvm_kvmalloc run. They include allocations made
+// concurrently by other threads.
+#define UVM_TEST_KVMALLOC_BENCHMARK                      UVM_TEST_IOCTL_BASE(124)
+typedef struct
+{
+    NvU32 iterations;                                      // In
+    NvU32 num_live_objects;                                // In
+    NvU32 max_size;                                        // In
+    NvU32 seed;                                            // In
+
+    NvU64 kvmalloc_ns_per_op            NV_ALIGN_BYTES(8); // Out
+    NvU64 kmalloc_ns_per_op             NV_ALIGN_BYTES(8); // Out
+    NvU64 magazine_hits                 NV_ALIGN_BYTES(8); // Out
+    NvU64 magazine_misses               NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_KVMALLOC_BENCHMARK_PARAMS;
+
+// Compare the VA space range lock against serializing writers on the VA space
+// lock. num_threads kernel threads each perform iterations lock/unlock
+// operations on ranges of 64K slots, holding each range for hold_ns. A
+// write_percent share of the operations are writes, which take either the VA
+// space lock in write mode or the range lock under the VA space lock in read
+// mode. The others are reads, which only take the VA space lock in read mode
+// like fault servicing does. If disjoint is set, the ranges of different
+// threads never overlap. Otherwise they are random ranges of up to 4 slots out
+// of 2 * num_threads slots.
+//
+// Exclusion between writers is verified along the way, and
+// NV_ERR_INVALID_STATE is returned if two overlapping writers are observed.
+#define UVM_TEST_RANGE_LOCK_BENCHMARK                    UVM_TEST_IOCTL_BASE(125)
+typedef struct
+{
+    NvU32 num_threads;                                     // In
+    NvU32 iterations;                                      // In
+    NvU32 write_percent;                                   // In
+    NvU32 hold_ns;                                         // In
+    NvU32 seed;                                            // In
+    NvBool disjoint;                                       // In
+
+    NvU64 range_lock_ns_per_op          NV_ALIGN_BYTES(8); // Out
+    NvU64 rwsem_ns_per_op               NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_RANGE_LOCK_BENCHMARK_PARAMS;
+
+// Keep this in sync with the localities handled in uvm_range_tree_test.c
+typedef enum
+{
+    // Addresses walk the ranges in increasing order, several lookups per range
+    UVM_TEST_RANGE_TREE_LOCALITY_SEQUENTIAL = 0,
+
+    // Lookups stay within a small window of ranges which moves periodically
+    UVM_TEST_RANGE_TREE_LOCALITY_HOT,
+
+    // Uniformly random addresses over all ranges
+    UVM_TEST_RANGE_TREE_LOCALITY_RANDOM,
+
+    UVM_TEST_RANGE_TREE_LOCALITY_COUNT
+} UVM_TEST_RANGE_TREE_LOCALITY;
+
+// Measure uvm_range_tree_find() and uvm_range_tree_iter_first() throughput on a
+// tree of num_ranges ranges, for each of the access localities. The *_nocache
+// results drop the tree's last-hit cache before every lookup, so they measure
+// the cost of walking the tree.
+#define UVM_TEST_RANGE_TREE_BENCHMARK                    UVM_TEST_IOCTL_BASE(126)
+typedef struct
+{
+    NvU32 num_ranges;                                                                   // In
+    NvU32 iterations;                                                                   // In
+    NvU32 seed;                                                                         // In
+
+    NvU64 find_ns_per_op[UVM_TEST_RANGE_TREE_LOCALITY_COUNT]         NV_ALIGN_BYTES(8); // Out
+    NvU64 find_nocache_ns_per_op[UVM_TEST_RANGE_TREE_LOCALITY_COUNT] NV_ALIGN_BYTES(8); // Out
+    NvU64 iter_first_ns_per_op[UVM_TEST_RANGE_TREE_LOCALITY_COUNT]   NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                                                 // Out
+} UVM_TEST_RANGE_TREE_BENCHMARK_PARAMS;
+
+// Check uvm_broadcast_plan() on directed topologies and on iterations random
+// topologies. It doesn't need any GPU.
+#define UVM_TEST_GPU_BROADCAST_PLAN                      UVM_TEST_IOCTL_BASE(127)
+typedef struct
+{
+    NvU32 iterations;                                      // In
+    NvU32 seed;                                            // In
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_GPU_BROADCAST_PLAN_PARAMS;
+
+// Time merging trackers with uvm_tracker_add_tracker() and waiting on
+// completed trackers with uvm_tracker_wait(). The trackers have an entry for
+// each channel of the GPUs registered in the VA space, and the merged trackers
+// share a quarter of their channels.
+#define UVM_TEST_TRACKER_BENCHMARK                       UVM_TEST_IOCTL_BASE(128)
+typedef struct
+{
+    NvU32 iterations;                                      // In
+
+    NvU32 num_entries;                                     // Out
+    NvU64 merge_ns_per_op               NV_ALIGN_BYTES(8); // Out
+    NvU64 wait_ns_per_op                NV_ALIGN_BYTES(8); // Out
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_TRACKER_BENCHMARK_PARAMS;
+
+// Measure the bandwidth of migrating an HMM allocation of the calling process
+// to a GPU and back to the CPU. Each iteration migrates the whole range
+// [base, base + length) to the GPU and then back to the CPU.
+//
+// batch_blocks overrides the uvm_hmm_migrate_batch_blocks module parameter if
+// non-zero. A value of 1 makes each va_block wait for its copies before the
+// next one is migrated.
+#define UVM_TEST_HMM_MIGRATE_BENCHMARK                   UVM_TEST_IOCTL_BASE(129)
+typedef struct
+{
+    NvU64 base                          NV_ALIGN_BYTES(8); // In
+    NvU64 length                        NV_ALIGN_BYTES(8); // In
+    NvProcessorUuid gpu_uuid;                              // In
+    NvU32 iterations;                                      // In
+    NvU32 batch_blocks;                                    // In
+
+    NvU64 to_gpu_ns                     NV_ALIGN_BYTES(8); // Out
+    NvU64 to_cpu_ns                     NV_ALIGN_BYTES(8); // Out
+    NvU64 to_gpu_mb_per_s               NV_ALIGN_BYTES(8); // Out
+    NvU64 to_cpu_mb_per_s               NV_ALIGN_BYTES(8); // Out
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_HMM_MIGRATE_BENCHMARK_PARAMS;
+
+// Compare batched PMA allocations and frees against the equivalent sequence of
+// single calls. num_requests requests of pages_per_request pages each are
+// allocated and freed one call at a time, then with one batched call each way.
+// If mixed_page_sizes is set, every odd request uses 2MB pages instead of
+// page_size. Pages are allocated pinned and without eviction.
+//
+// The out rates are in pages per second, averaged over iterations.
+#define UVM_TEST_PMA_BATCH_BENCHMARK                     UVM_TEST_IOCTL_BASE(130)
+typedef struct
+{
+    NvProcessorUuid gpu_uuid;                              // In
+    NvU64 page_size                     NV_ALIGN_BYTES(8); // In
+    NvU32 num_requests;                                    // In
+    NvU32 pages_per_request;                               // In
+    NvU32 mixed_page_sizes;                                // In
+    NvU32 iterations;                                      // In
+
+    NvU64 single_alloc_pages_per_s      NV_ALIGN_BYTES(8); // Out
+    NvU64 batch_alloc_pages_per_s       NV_ALIGN_BYTES(8); // Out
+    NvU64 single_free_pages_per_s       NV_ALIGN_BYTES(8); // Out
+    NvU64 batch_free_pages_per_s        NV_ALIGN_BYTES(8); // Out
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PMA_BATCH_BENCHMARK_PARAMS;
+
+// Measure PMA allocation throughput under contention. num_threads kernel
+// threads each allocate and free a single pinned page of page_size iterations
+// times, all against the PMA of the given GPU. ns_per_op is the wall time of
+// the whole run divided by the total number of alloc/free pairs.
+//
+// On GPUs whose memory is onlined as a NUMA node, the per-CPU magazines in
+// front of PMA serve most of these allocations. Their hit ratio and drain
+// counts are reported in /proc/driver/nvidia/gpus/<pci>/numa_magazines.
+#define UVM_TEST_PMA_CONTENTION_BENCHMARK                UVM_TEST_IOCTL_BASE(131)
+typedef struct
+{
+    NvProcessorUuid gpu_uuid;                              // In
+    NvU64 page_size                     NV_ALIGN_BYTES(8); // In
+    NvU32 num_threads;                                     // In
+    NvU32 iterations;                                      // In
+
+    NvU64 ns_per_op                     NV_ALIGN_BYTES(8); // Out
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PMA_CONTENTION_BENCHMARK_PARAMS;
+
+// Sparse tiering migrations. Every other page of the VA block containing
+// lookup_address that is resident on the given GPU is demoted to the CPU, and
+// then promoted back. The test checks that only those pages change residency,
+// that no CPU memory is populated for the rest, and that the promoted pages
+// are mapped on the GPU again.
+//
+// The block must be resident on the GPU and not on the CPU. It doesn't need
+// the tiering daemon to be enabled.
+#define UVM_TEST_PERF_TIERING_SPARSE_MIGRATE             UVM_TEST_IOCTL_BASE(132)
+typedef struct
+{
+    NvU64 lookup_address                NV_ALIGN_BYTES(8); // In
+    NvProcessorUuid gpu_uuid;                              // In
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PERF_TIERING_SPARSE_MIGRATE_PARAMS;
+
+// Race UvmEnableReadDuplication and UvmDisableReadDuplication calls on
+// overlapping spans of the managed allocation [base, base + length). One
+// kernel thread toggles read duplication on the whole allocation except its
+// first and last pages, and another on the upper half of that span, each
+// making iterations random calls. Afterwards, the policy of the first and last
+// pages must be unchanged, and the lower half of the span must have the policy
+// of the first thread's last call.
+//
+// length must be at least 4 pages.
+#define UVM_TEST_READ_DUPLICATION_RACE                   UVM_TEST_IOCTL_BASE(133)
+typedef struct
+{
+    NvU64 base                          NV_ALIGN_BYTES(8); // In
+    NvU64 length                        NV_ALIGN_BYTES(8); // In
+    NvU32 iterations;                                      // In
+    NvU32 seed;                                            // In
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_READ_DUPLICATION_RACE_PARAMS;
+
+// Bytes migrated by the tiering daemon of the VA space. enabled is NV_FALSE,
+// and the byte counts are zero, if the daemon is disabled.
+#define UVM_TEST_PERF_TIERING_STATS                      UVM_TEST_IOCTL_BASE(134)
+typedef struct
+{
+    NvBool enabled;                                        // Out
+    NvU64 bytes_promoted                NV_ALIGN_BYTES(8); // Out
+    NvU64 bytes_demoted                 NV_ALIGN_BYTES(8); // Out
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_PERF_TIERING_STATS_PARAMS;
+
+// Check that the CPU chunks of a 2M VA block are merged into a single 2M chunk
+// once the block has been fully resident on the GPU. lookup_address must be
+// within a 2M-aligned, 2M-sized managed VA block. The block is first populated
+// on the CPU with 4K chunks, migrated to the GPU and migrated back to the CPU,
+// which must then be backed by one 2M chunk. The merge is forced on the block
+// regardless of the uvm_cpu_chunk_merge_gpu_resident module parameter. The
+// test does nothing if 2M isn't one of the CPU chunk allocation sizes.
+//
+// Error returns:
+// NV_ERR_INVALID_ADDRESS
+//  - lookup_address doesn't match a 2M managed VA block
+// NV_ERR_INVALID_DEVICE
+//  - gpu_uuid isn't registered in the VA space
+// NV_ERR_INVALID_STATE
+//  - The block was already populated, or its CPU chunks weren't merged
+#define UVM_TEST_VA_BLOCK_CPU_CHUNK_MERGE                UVM_TEST_IOCTL_BASE(135)
+typedef struct
+{
+    NvU64 lookup_address                NV_ALIGN_BYTES(8); // In
+    NvProcessorUuid gpu_uuid;                              // In
+
+    NV_STATUS rmStatus;                                    // Out
+} UVM_TEST_VA_BLOCK_CPU_CHUNK_MERGE_PARAMS;
+
 #ifdef __cplusplus
 }
 #endif
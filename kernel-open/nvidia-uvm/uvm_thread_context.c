@@ -632,6 +632,9 @@ static void thread_context_move(uvm_thread_context_t *dst, uvm_thread_context_t
         bitmap_zero(src_context_lock->out_of_order_acquired_lock_orders, UVM_LOCK_ORDER_COUNT);
 
         memcpy(dst_context_lock->acquired, src_context_lock->acquired, acquired_size);
+
+        dst_context_lock->acquired_range_start = src_context_lock->acquired_range_start;
+        dst_context_lock->acquired_range_end = src_context_lock->acquired_range_end;
     }
 }
 
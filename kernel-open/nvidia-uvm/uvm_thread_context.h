@@ -53,6 +53,11 @@ struct uvm_thread_context_lock_struct
     // The value at a given index is undefined if the corresponding bit is not
     // set in acquired_locked_orders.
     void **acquired;
+
+    // Inclusive address range of the acquired UVM_LOCK_ORDER_VA_SPACE_RANGE
+    // range lock. Undefined if the lock order is not acquired.
+    NvU64 acquired_range_start;
+    NvU64 acquired_range_end;
 };
 
 // UVM thread contexts provide thread local storage for all logical threads
@@ -51,6 +51,27 @@ typedef struct
     NvU32 put_behind;
 } uvm_tools_queue_snapshot_t;
 
+// Ring of a per-CPU queue. Only the CPU that owns the ring writes to it, with
+// preemption disabled.
+typedef struct
+{
+    // Entries of the ring, within the queue buffer of the queue
+    void *buffer;
+
+    // Control data of the ring, within the control buffer of the queue
+    UvmToolsEventControlData *control;
+
+    // Kernel copy of put_behind. The copy in control is only published to the
+    // consumer, since it can be modified from user space.
+    NvU32 put;
+
+    // Same as in uvm_tools_queue_t. is_wakeup_get_valid is also cleared by
+    // poll without synchronization, which can at worst cause a spurious
+    // wakeup.
+    bool is_wakeup_get_valid;
+    NvU32 wakeup_get;
+} uvm_tools_queue_ring_t;
+
 typedef struct
 {
     uvm_spinlock_t lock;
@@ -68,6 +89,12 @@ typedef struct
     wait_queue_head_t wait_queue;
     bool is_wakeup_get_valid;
     NvU32 wakeup_get;
+
+    // Per-CPU rings, indexed by CPU id. NULL for regular queues. When set,
+    // queue_buffer and control hold ring_count rings, and lock only protects
+    // notification_threshold.
+    uvm_tools_queue_ring_t *rings;
+    NvU32 ring_count;
 } uvm_tools_queue_t;
 
 typedef struct
@@ -373,12 +400,46 @@ static void remove_event_tracker(uvm_va_space_t *va_space,
     *subscribed_mask &= ~list_mask;
 }
 
-static bool queue_needs_wakeup(uvm_tools_queue_t *queue, uvm_tools_queue_snapshot_t *sn)
+static bool ring_needs_wakeup(uvm_tools_queue_t *queue, NvU32 put_behind, NvU32 get_ahead)
 {
     NvU32 queue_mask = queue->queue_buffer_count - 1;
 
+    return ((queue->queue_buffer_count + put_behind - get_ahead) & queue_mask) >= READ_ONCE(queue->notification_threshold);
+}
+
+static bool queue_needs_wakeup(uvm_tools_queue_t *queue, uvm_tools_queue_snapshot_t *sn)
+{
     uvm_assert_spinlock_locked(&queue->lock);
-    return ((queue->queue_buffer_count + sn->put_behind - sn->get_ahead) & queue_mask) >= queue->notification_threshold;
+    return ring_needs_wakeup(queue, sn->put_behind, sn->get_ahead);
+}
+
+// Returns true if any ring of the per-CPU queue reached the notification
+// threshold. If clear_wakeup is true, the wakeup state of the rings is also
+// reset so that producers signal the wait queue again.
+static bool per_cpu_queue_needs_wakeup(uvm_tools_queue_t *queue, bool clear_wakeup)
+{
+    bool needs_wakeup = false;
+    NvU32 i;
+
+    for (i = 0; i < queue->ring_count; i++) {
+        uvm_tools_queue_ring_t *ring = &queue->rings[i];
+        NvU32 put_behind = atomic_read((atomic_t *)&ring->control->put_behind);
+        NvU32 get_ahead = atomic_read((atomic_t *)&ring->control->get_ahead);
+
+        if (clear_wakeup)
+            WRITE_ONCE(ring->is_wakeup_get_valid, false);
+
+        if (ring_needs_wakeup(queue, put_behind, get_ahead))
+            needs_wakeup = true;
+    }
+
+    return needs_wakeup;
+}
+
+// Number of rings in the buffers of the queue, 1 for regular queues
+static NvU32 queue_ring_count(uvm_tools_queue_t *queue)
+{
+    return queue->rings ? queue->ring_count : 1;
 }
 
 static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
@@ -395,7 +456,7 @@ static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
             uvm_tools_queue_t *queue = &event_tracker->queue;
             NvU64 buffer_size;
 
-            buffer_size = queue->queue_buffer_count * event_tracker->entry_size;
+            buffer_size = (NvU64)queue->queue_buffer_count * event_tracker->entry_size * queue_ring_count(queue);
 
             remove_event_tracker(va_space,
                                  queue->queue_nodes,
@@ -412,8 +473,10 @@ static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
             if (queue->control != NULL) {
                 unmap_user_pages(queue->control_buffer_pages,
                                  queue->control,
-                                 sizeof(UvmToolsEventControlData));
+                                 sizeof(UvmToolsEventControlData) * queue_ring_count(queue));
             }
+
+            uvm_kvfree(queue->rings);
         }
         else {
             uvm_tools_counter_t *counters = &event_tracker->counter;
@@ -498,14 +561,77 @@ unlock:
     uvm_spin_unlock(&queue->lock);
 }
 
+// Lock-free version of enqueue_event for per-CPU queues. The ring of the
+// current CPU has a single producer as long as preemption is disabled, and
+// events are only recorded from process context with the tools lock held.
+static void enqueue_event_per_cpu(const void *entry, size_t entry_size, NvU8 eventType, uvm_tools_queue_t *queue)
+{
+    uvm_tools_queue_ring_t *ring;
+    UvmToolsEventControlData *ctrl;
+    NvU32 queue_size = queue->queue_buffer_count;
+    NvU32 queue_mask = queue_size - 1;
+    NvU32 get_behind;
+    NvU32 get_ahead;
+    NvU32 put;
+    unsigned cpu;
+
+    // See enqueue_event
+    nv_speculation_barrier();
+
+    cpu = get_cpu();
+    UVM_ASSERT(cpu < queue->ring_count);
+
+    ring = &queue->rings[cpu];
+    ctrl = ring->control;
+
+    // ctrl is mapped into user space with read and write permissions, so its
+    // values cannot be trusted. put is kept in the ring, and get_behind is
+    // masked.
+    get_behind = atomic_read((atomic_t *)&ctrl->get_behind) & queue_mask;
+    put = ring->put;
+
+    // one free element means that the ring is full
+    if (((queue_size + get_behind - put) & queue_mask) == 1) {
+        atomic64_inc((atomic64_t *)&ctrl->dropped + eventType);
+        goto out;
+    }
+
+    memcpy((char *)ring->buffer + put * entry_size, entry, entry_size);
+
+    put = (put + 1) & queue_mask;
+    ring->put = put;
+
+    // Publish the entry before the put pointers, the consumer may be running
+    // on a different CPU.
+    smp_wmb();
+    atomic_set((atomic_t *)&ctrl->put_ahead, put);
+    atomic_set((atomic_t *)&ctrl->put_behind, put);
+
+    get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+
+    if (ring_needs_wakeup(queue, put, get_ahead) &&
+        !(READ_ONCE(ring->is_wakeup_get_valid) && ring->wakeup_get == get_ahead)) {
+        ring->wakeup_get = get_ahead;
+        WRITE_ONCE(ring->is_wakeup_get_valid, true);
+        wake_up_all(&queue->wait_queue);
+    }
+
+out:
+    put_cpu();
+}
+
 static void uvm_tools_enqueue_event(struct list_head *head, const void *entry, size_t entry_size, NvU8 eventType)
 {
     uvm_tools_queue_t *queue;
 
     UVM_ASSERT(eventType < UvmEventNumTypesAll);
 
-    list_for_each_entry(queue, head + eventType, queue_nodes[eventType])
-        enqueue_event(entry, entry_size, eventType, queue);
+    list_for_each_entry(queue, head + eventType, queue_nodes[eventType]) {
+        if (queue->rings)
+            enqueue_event_per_cpu(entry, entry_size, eventType, queue);
+        else
+            enqueue_event(entry, entry_size, eventType, queue);
+    }
 }
 
 static void uvm_tools_record_event(uvm_va_space_t *va_space, const UvmEventEntry *entry)
@@ -677,6 +803,7 @@ static long uvm_tools_unlocked_ioctl(struct file *filp, unsigned int cmd, unsign
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_ENABLE_COUNTERS,            uvm_api_tools_enable_counters);
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_DISABLE_COUNTERS,           uvm_api_tools_disable_counters);
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_INIT_EVENT_TRACKER_V2,      uvm_api_tools_init_event_tracker_v2);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU, uvm_api_tools_init_event_tracker_per_cpu);
     }
 
     uvm_thread_assert_all_unlocked();
@@ -703,6 +830,13 @@ static unsigned uvm_tools_poll(struct file *filp, poll_table *wait)
     if (!tracker_is_queue(event_tracker))
         return POLLERR;
 
+    if (event_tracker->queue.rings) {
+        if (per_cpu_queue_needs_wakeup(&event_tracker->queue, true))
+            flags = POLLIN | POLLRDNORM;
+
+        goto wait;
+    }
+
     uvm_spin_lock(&event_tracker->queue.lock);
 
     event_tracker->queue.is_wakeup_get_valid = false;
@@ -715,6 +849,7 @@ static unsigned uvm_tools_poll(struct file *filp, poll_table *wait)
 
     uvm_spin_unlock(&event_tracker->queue.lock);
 
+wait:
     poll_wait(filp, &event_tracker->queue.wait_queue, wait);
     return flags;
 }
@@ -1122,6 +1257,8 @@ static UvmEventMigrationCause g_make_resident_to_tools_migration_cause[UVM_MAKE_
     [UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE]          = UvmEventMigrationCauseUser,
     [UVM_MAKE_RESIDENT_CAUSE_API_SET_RANGE_GROUP]  = UvmEventMigrationCauseCoherence,
     [UVM_MAKE_RESIDENT_CAUSE_API_HINT]             = UvmEventMigrationCauseUser,
+    [UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION]    = UvmEventMigrationCauseAccessCounters,
+    [UVM_MAKE_RESIDENT_CAUSE_TIERING_DEMOTION]     = UvmEventMigrationCauseEviction,
 };
 
 static void uvm_tools_record_migration_cpu_to_cpu(uvm_va_space_t *va_space, uvm_perf_event_data_t *event_data)
@@ -1756,6 +1893,67 @@ void uvm_tools_record_thrashing(uvm_va_space_t *va_space,
     uvm_up_read(&va_space->tools.lock);
 }
 
+void uvm_tools_record_thrashing_classified(uvm_va_space_t *va_space,
+                                           NvU64 address,
+                                           size_t region_size,
+                                           uvm_processor_id_t processor,
+                                           UvmEventThrashingClass thrashing_class,
+                                           UvmEventThrashingMitigation mitigation,
+                                           NvU8 num_reads,
+                                           NvU8 num_writes)
+{
+    UVM_ASSERT(address);
+    UVM_ASSERT(PAGE_ALIGNED(address));
+    UVM_ASSERT(region_size > 0);
+    UVM_ASSERT(UVM_ID_IS_VALID(processor));
+    UVM_ASSERT(thrashing_class < UvmEventNumThrashingClasses);
+    UVM_ASSERT(mitigation < UvmEventNumThrashingMitigations);
+
+    uvm_assert_rwsem_locked(&va_space->lock);
+
+    if (!va_space->tools.enabled)
+        return;
+
+    uvm_down_read(&va_space->tools.lock);
+    if (tools_is_event_enabled_v1(va_space, UvmEventTypeThrashingClassified)) {
+        UvmEventEntry entry;
+        UvmEventThrashingClassifiedInfo *info = &entry.eventData.thrashingClassified;
+
+        memset(&entry, 0, sizeof(entry));
+
+        info->eventType      = UvmEventTypeThrashingClassified;
+        info->thrashingClass = thrashing_class;
+        info->mitigation     = mitigation;
+        info->processorIndex = uvm_parent_id_value_from_processor_id(processor);
+        info->numReads       = num_reads;
+        info->numWrites      = num_writes;
+        info->address        = address;
+        info->size           = region_size;
+        info->timeStamp      = NV_GETTIME();
+
+        uvm_tools_record_event(va_space, &entry);
+    }
+    if (tools_is_event_enabled_v2(va_space, UvmEventTypeThrashingClassified)) {
+        UvmEventEntry_V2 entry;
+        UvmEventThrashingClassifiedInfo_V2 *info = &entry.eventData.thrashingClassified;
+
+        memset(&entry, 0, sizeof(entry));
+
+        info->eventType      = UvmEventTypeThrashingClassified;
+        info->thrashingClass = thrashing_class;
+        info->mitigation     = mitigation;
+        info->processorIndex = uvm_id_value(processor);
+        info->numReads       = num_reads;
+        info->numWrites      = num_writes;
+        info->address        = address;
+        info->size           = region_size;
+        info->timeStamp      = NV_GETTIME();
+
+        uvm_tools_record_event_v2(va_space, &entry);
+    }
+    uvm_up_read(&va_space->tools.lock);
+}
+
 void uvm_tools_record_throttling_start(uvm_va_space_t *va_space, NvU64 address, uvm_processor_id_t processor)
 {
     UVM_ASSERT(address);
@@ -2020,12 +2218,16 @@ done:
     uvm_up_read(&va_space->tools.lock);
 }
 
+// ring_count is the number of per-CPU rings of the queue, or 0 for regular
+// queues and counters.
 static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *params,
                                       size_t entry_size,
+                                      NvU32 ring_count,
                                       struct file *filp)
 {
     NV_STATUS status = NV_OK;
     uvm_tools_event_tracker_t *event_tracker;
+    NvU32 i;
 
     event_tracker = nv_kmem_cache_zalloc(g_tools_event_tracker_cache, NV_UVM_GFP_FLAGS);
     if (event_tracker == NULL)
@@ -2077,7 +2279,19 @@ static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *pa
             goto fail;
         }
 
-        buffer_size = queue->queue_buffer_count * entry_size;
+        // The rings must be set up before mapping the buffers, since their
+        // count determines the size of the mappings on destruction.
+        if (ring_count > 0) {
+            queue->rings = uvm_kvmalloc_zero(sizeof(*queue->rings) * ring_count);
+            if (!queue->rings) {
+                status = NV_ERR_NO_MEMORY;
+                goto fail;
+            }
+
+            queue->ring_count = ring_count;
+        }
+
+        buffer_size = (NvU64)queue->queue_buffer_count * entry_size * queue_ring_count(queue);
 
         status = map_user_pages(params->queueBuffer,
                                 buffer_size,
@@ -2087,12 +2301,17 @@ static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *pa
             goto fail;
 
         status = map_user_pages(params->controlBuffer,
-                                sizeof(UvmToolsEventControlData),
+                                sizeof(UvmToolsEventControlData) * queue_ring_count(queue),
                                 (void **)&queue->control,
                                 &queue->control_buffer_pages);
 
         if (status != NV_OK)
             goto fail;
+
+        for (i = 0; i < ring_count; i++) {
+            queue->rings[i].buffer = (char *)queue->queue_buffer + (NvU64)i * queue->queue_buffer_count * entry_size;
+            queue->rings[i].control = queue->control + i;
+        }
     }
     else {
         uvm_tools_counter_t *counter = &event_tracker->counter;
@@ -2124,12 +2343,38 @@ NV_STATUS uvm_api_tools_init_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_PARAMS *
 
     BUILD_BUG_ON(!__same_type(params, params_v2));
 
-    return create_event_tracker(params_v2, sizeof(UvmEventEntry), filp);
+    return create_event_tracker(params_v2, sizeof(UvmEventEntry), 0, filp);
 }
 
 NV_STATUS uvm_api_tools_init_event_tracker_v2(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *params, struct file *filp)
 {
-    return create_event_tracker(params, sizeof(UvmEventEntry_V2), filp);
+    return create_event_tracker(params, sizeof(UvmEventEntry_V2), 0, filp);
+}
+
+NV_STATUS uvm_api_tools_init_event_tracker_per_cpu(UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU_PARAMS *params, struct file *filp)
+{
+    UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS params_v2 = {0};
+    NvU32 ring_count = nr_cpu_ids;
+
+    // Rings are indexed by CPU id, so there must be one for every possible CPU
+    // id. Extra rings provided by the caller are left unused.
+    if (params->ringCount < ring_count) {
+        params->ringCount = ring_count;
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    // Per-CPU trackers can only be queues
+    if (params->queueBufferSize == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    params->ringCount = ring_count;
+
+    params_v2.queueBuffer = params->queueBuffer;
+    params_v2.queueBufferSize = params->queueBufferSize;
+    params_v2.controlBuffer = params->controlBuffer;
+    params_v2.uvmFd = params->uvmFd;
+
+    return create_event_tracker(&params_v2, sizeof(UvmEventEntry_V2), ring_count, filp);
 }
 
 NV_STATUS uvm_api_tools_set_notification_threshold(UVM_TOOLS_SET_NOTIFICATION_THRESHOLD_PARAMS *params, struct file *filp)
@@ -2143,7 +2388,14 @@ NV_STATUS uvm_api_tools_set_notification_threshold(UVM_TOOLS_SET_NOTIFICATION_TH
 
     uvm_spin_lock(&event_tracker->queue.lock);
 
-    event_tracker->queue.notification_threshold = params->notificationThreshold;
+    WRITE_ONCE(event_tracker->queue.notification_threshold, params->notificationThreshold);
+
+    if (event_tracker->queue.rings) {
+        if (per_cpu_queue_needs_wakeup(&event_tracker->queue, false))
+            wake_up_all(&event_tracker->queue.wait_queue);
+
+        goto unlock;
+    }
 
     ctrl = event_tracker->queue.control;
     sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
@@ -2152,6 +2404,7 @@ NV_STATUS uvm_api_tools_set_notification_threshold(UVM_TOOLS_SET_NOTIFICATION_TH
     if (queue_needs_wakeup(&event_tracker->queue, &sn))
         wake_up_all(&event_tracker->queue.wait_queue);
 
+unlock:
     uvm_spin_unlock(&event_tracker->queue.lock);
 
     return NV_OK;
@@ -2645,6 +2898,51 @@ NV_STATUS uvm_test_inject_tools_event_v2(UVM_TEST_INJECT_TOOLS_EVENT_V2_PARAMS *
     return NV_OK;
 }
 
+NV_STATUS uvm_test_tools_event_benchmark(UVM_TEST_TOOLS_EVENT_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    NvU32 i;
+    NvU64 start;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+
+    if (params->iterations == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    start = NV_GETTIME();
+
+    // Mirror the work done per fault by uvm_tools_record_fault and
+    // record_gpu_fault_instance
+    for (i = 0; i < params->iterations; i++) {
+        uvm_down_read(&va_space->tools.lock);
+
+        if (tools_is_event_enabled_v2(va_space, UvmEventTypeGpuFault)) {
+            UvmEventEntry_V2 entry;
+            UvmEventGpuFaultInfo_V2 *info = &entry.eventData.gpuFault;
+            memset(&entry, 0, sizeof(entry));
+
+            info->eventType     = UvmEventTypeGpuFault;
+            info->gpuIndex      = uvm_id_value(uvm_gpu_id_from_index(0));
+            info->faultType     = UvmFaultTypeInvalidPte;
+            info->accessType    = UvmEventMemoryAccessTypeRead;
+            info->clientType    = UvmEventFaultClientTypeGpc;
+            info->address       = (NvU64)i * PAGE_SIZE;
+            info->timeStamp     = NV_GETTIME();
+            info->batchId       = i;
+
+            uvm_tools_record_event_v2(va_space, &entry);
+        }
+
+        uvm_up_read(&va_space->tools.lock);
+
+        if (fatal_signal_pending(current))
+            return NV_ERR_SIGNAL_PENDING;
+    }
+
+    params->total_ns = NV_GETTIME() - start;
+    params->ns_per_event = params->total_ns / params->iterations;
+
+    return NV_OK;
+}
+
 NV_STATUS uvm_test_increment_tools_counter(UVM_TEST_INCREMENT_TOOLS_COUNTER_PARAMS *params, struct file *filp)
 {
     NvU32 i;
@@ -34,6 +34,7 @@
 
 NV_STATUS uvm_test_inject_tools_event(UVM_TEST_INJECT_TOOLS_EVENT_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_inject_tools_event_v2(UVM_TEST_INJECT_TOOLS_EVENT_V2_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_tools_event_benchmark(UVM_TEST_TOOLS_EVENT_BENCHMARK_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_increment_tools_counter(UVM_TEST_INCREMENT_TOOLS_COUNTER_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_tools_flush_replay_events(UVM_TEST_TOOLS_FLUSH_REPLAY_EVENTS_PARAMS *params, struct file *filp);
 
@@ -77,6 +78,17 @@ void uvm_tools_record_thrashing(uvm_va_space_t *va_space,
                                 size_t region_size,
                                 const uvm_processor_mask_t *processors);
 
+// Record a thrashing classification or mitigation decision for the memory
+// region. processor is the processor whose access triggered the decision.
+void uvm_tools_record_thrashing_classified(uvm_va_space_t *va_space,
+                                           NvU64 address,
+                                           size_t region_size,
+                                           uvm_processor_id_t processor,
+                                           UvmEventThrashingClass thrashing_class,
+                                           UvmEventThrashingMitigation mitigation,
+                                           NvU8 num_reads,
+                                           NvU8 num_writes);
+
 void uvm_tools_record_throttling_start(uvm_va_space_t *va_space, NvU64 address, uvm_processor_id_t processor);
 
 void uvm_tools_record_throttling_end(uvm_va_space_t *va_space, NvU64 address, uvm_processor_id_t processor);
@@ -53,14 +53,38 @@ uvm_tracker_entry_t *uvm_tracker_get_entries(uvm_tracker_t *tracker)
     }
 }
 
-static uvm_tracker_entry_t *get_new_entry(uvm_tracker_t *tracker)
+// Entries are kept sorted by channel so that lookups can use a binary search
+// and trackers can be merged in a single pass. Return the index of the entry
+// for channel, or of the position it would need to be inserted at.
+static NvU32 find_entry_index(uvm_tracker_t *tracker, uvm_channel_t *channel)
 {
-    NV_STATUS status = uvm_tracker_reserve(tracker, 1);
-    if (status != NV_OK)
-        return NULL;
-    UVM_ASSERT(tracker->size < tracker->max_size);
+    uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 low = 0;
+    NvU32 high = tracker->size;
+
+    while (low < high) {
+        NvU32 mid = low + (high - low) / 2;
+
+        if ((uintptr_t)entries[mid].channel < (uintptr_t)channel)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+// Reserve space for min_free_entries, removing completed entries first if the
+// entries array would have to grow otherwise. Trackers that are passed around
+// many pushes accumulate entries for channels that have long completed, and
+// dropping them is cheaper than growing the array and walking the stale
+// entries on every wait.
+static NV_STATUS reserve_compacting(uvm_tracker_t *tracker, NvU32 min_free_entries)
+{
+    if (tracker->size + min_free_entries > tracker->max_size)
+        uvm_tracker_remove_completed(tracker);
 
-    return &uvm_tracker_get_entries(tracker)[tracker->size++];
+    return uvm_tracker_reserve(tracker, min_free_entries);
 }
 
 NV_STATUS uvm_tracker_init_from(uvm_tracker_t *dst, uvm_tracker_t *src)
@@ -136,20 +160,27 @@ NV_STATUS uvm_tracker_add_push(uvm_tracker_t *tracker, uvm_push_t *push)
 
 NV_STATUS uvm_tracker_add_entry(uvm_tracker_t *tracker, uvm_tracker_entry_t *new_entry)
 {
-    uvm_tracker_entry_t *tracker_entry;
+    NV_STATUS status;
+    uvm_tracker_entry_t *entries;
+    NvU32 index = find_entry_index(tracker, new_entry->channel);
 
-    for_each_tracker_entry(tracker_entry, tracker) {
-        if (tracker_entry->channel == new_entry->channel) {
-            tracker_entry->value = max(tracker_entry->value, new_entry->value);
-            return NV_OK;
-        }
+    entries = uvm_tracker_get_entries(tracker);
+    if (index < tracker->size && entries[index].channel == new_entry->channel) {
+        entries[index].value = max(entries[index].value, new_entry->value);
+        return NV_OK;
     }
 
-    tracker_entry = get_new_entry(tracker);
-    if (tracker_entry == NULL)
-        return NV_ERR_NO_MEMORY;
+    status = reserve_compacting(tracker, 1);
+    if (status != NV_OK)
+        return status;
+
+    // Compaction and growing may have moved the entries
+    index = find_entry_index(tracker, new_entry->channel);
+    entries = uvm_tracker_get_entries(tracker);
 
-    *tracker_entry = *new_entry;
+    memmove(&entries[index + 1], &entries[index], (tracker->size - index) * sizeof(*entries));
+    entries[index] = *new_entry;
+    tracker->size++;
 
     return NV_OK;
 }
@@ -175,30 +206,42 @@ void uvm_tracker_overwrite_with_push(uvm_tracker_t *tracker, uvm_push_t *push)
     uvm_tracker_overwrite_with_entry(tracker, &entry);
 }
 
-static NV_STATUS reserve_for_entries_from_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
+// Number of entries dst would have after adding all the entries from src
+static NvU32 merged_size(uvm_tracker_t *dst, uvm_tracker_t *src)
 {
-    NvU32 needed_free_entries = 0;
-    uvm_tracker_entry_t *src_entry, *dst_entry;
-
-    for_each_tracker_entry(src_entry, src) {
-        bool found = false;
-        for_each_tracker_entry(dst_entry, dst) {
-            if (dst_entry->channel == src_entry->channel) {
-                found = true;
-                break;
-            }
+    uvm_tracker_entry_t *dst_entries = uvm_tracker_get_entries(dst);
+    uvm_tracker_entry_t *src_entries = uvm_tracker_get_entries(src);
+    NvU32 size = dst->size + src->size;
+    NvU32 i = 0;
+    NvU32 j = 0;
+
+    while (i < dst->size && j < src->size) {
+        uintptr_t dst_channel = (uintptr_t)dst_entries[i].channel;
+        uintptr_t src_channel = (uintptr_t)src_entries[j].channel;
+
+        if (dst_channel == src_channel) {
+            --size;
+            ++i;
+            ++j;
+        }
+        else if (dst_channel < src_channel) {
+            ++i;
+        }
+        else {
+            ++j;
         }
-        if (!found)
-            needed_free_entries++;
     }
 
-    return uvm_tracker_reserve(dst, needed_free_entries);
+    return size;
 }
 
 NV_STATUS uvm_tracker_add_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
 {
     NV_STATUS status;
-    uvm_tracker_entry_t *src_entry;
+    uvm_tracker_entry_t *dst_entries;
+    uvm_tracker_entry_t *src_entries;
+    NvU32 new_size;
+    NvU32 i, j, k;
 
     UVM_ASSERT(dst != NULL);
 
@@ -211,21 +254,55 @@ NV_STATUS uvm_tracker_add_tracker(uvm_tracker_t *dst, uvm_tracker_t *src)
     if (uvm_tracker_is_empty(src))
         return NV_OK;
 
-    status = uvm_tracker_reserve(dst, src->size);
-    if (status == NV_ERR_NO_MEMORY) {
+    new_size = merged_size(dst, src);
+    if (new_size > dst->max_size) {
         uvm_tracker_remove_completed(dst);
+        new_size = merged_size(dst, src);
+    }
+
+    status = uvm_tracker_reserve(dst, new_size - dst->size);
+    if (status == NV_ERR_NO_MEMORY) {
         uvm_tracker_remove_completed(src);
-        status = reserve_for_entries_from_tracker(dst, src);
+        new_size = merged_size(dst, src);
+        status = uvm_tracker_reserve(dst, new_size - dst->size);
     }
 
     if (status != NV_OK)
         return status;
 
-    for_each_tracker_entry(src_entry, src) {
-        status = uvm_tracker_add_entry(dst, src_entry);
-        UVM_ASSERT_MSG(status == NV_OK, "Expected success with reserved memory but got error %d\n", status);
+    // Merge the two sorted arrays from the back so that it can be done in
+    // place.
+    dst_entries = uvm_tracker_get_entries(dst);
+    src_entries = uvm_tracker_get_entries(src);
+    i = dst->size;
+    j = src->size;
+    k = new_size;
+
+    while (j > 0) {
+        uvm_tracker_entry_t *src_entry = &src_entries[j - 1];
+
+        UVM_ASSERT(k > 0);
+
+        if (i > 0 && (uintptr_t)dst_entries[i - 1].channel > (uintptr_t)src_entry->channel) {
+            dst_entries[--k] = dst_entries[--i];
+        }
+        else if (i > 0 && dst_entries[i - 1].channel == src_entry->channel) {
+            --k;
+            --i;
+            dst_entries[k].channel = src_entry->channel;
+            dst_entries[k].value = max(dst_entries[i].value, src_entry->value);
+            --j;
+        }
+        else {
+            dst_entries[--k] = *src_entry;
+            --j;
+        }
     }
 
+    // The remaining dst entries are already in place
+    UVM_ASSERT(k == i);
+    dst->size = new_size;
+
     return NV_OK;
 }
 
@@ -331,29 +408,40 @@ NV_STATUS uvm_tracker_wait_for_entry(uvm_tracker_entry_t *tracker_entry)
 NV_STATUS uvm_tracker_wait(uvm_tracker_t *tracker)
 {
     NV_STATUS status = NV_OK;
+    uvm_tracker_entry_t *entry;
     uvm_spin_loop_t spin;
 
     uvm_spin_loop_init(&spin);
-    while (!uvm_tracker_is_completed(tracker) && status == NV_OK) {
-        if (UVM_SPIN_LOOP(&spin) == NV_ERR_TIMEOUT_RETRY)
-            uvm_tracker_print_pending_pushes(tracker);
 
-        status = uvm_tracker_check_errors(tracker);
-    }
+    // Wait for one entry at a time so that each spin iteration only polls a
+    // single semaphore instead of walking the whole tracker. Channel errors are
+    // global errors so checking the waited on channel and the global status is
+    // enough.
+    for_each_tracker_entry(entry, tracker) {
+        while (!uvm_tracker_is_entry_completed(entry) && status == NV_OK) {
+            if (UVM_SPIN_LOOP(&spin) == NV_ERR_TIMEOUT_RETRY)
+                uvm_tracker_print_pending_pushes(tracker);
 
-    if (status != NV_OK) {
-        UVM_ASSERT(status == uvm_global_get_status());
+            status = uvm_channel_check_errors(entry->channel);
 
-        // Just clear the tracker without printing anything extra. If one of the
-        // entries from this tracker caused a channel error,
-        // uvm_tracker_check_errors() would have already printed it. And if we
-        // hit a global error for some other reason, we don't want to spam the
-        // log with all other pending entries.
-        //
-        // See the comment for uvm_tracker_wait() on why the entries are cleared.
-        uvm_tracker_clear(tracker);
+            if (status == NV_OK)
+                status = uvm_global_get_status();
+        }
+
+        if (status != NV_OK)
+            break;
     }
 
+    // On success all the entries are completed. On failure, just clear the
+    // tracker without printing anything extra. If one of the entries from this
+    // tracker caused a channel error, uvm_channel_check_errors() would have
+    // already printed it. And if we hit a global error for some other reason,
+    // we don't want to spam the log with all other pending entries.
+    //
+    // See the comment for uvm_tracker_wait() on why the entries are cleared.
+    UVM_ASSERT(status == NV_OK || status == uvm_global_get_status());
+    uvm_tracker_clear(tracker);
+
     return status;
 }
 
@@ -416,21 +504,22 @@ NV_STATUS uvm_tracker_query(uvm_tracker_t *tracker)
 
 void uvm_tracker_remove_completed(uvm_tracker_t *tracker)
 {
-    NvU32 i = 0;
-
     uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 new_size = 0;
+    NvU32 i;
 
-    // Keep removing completed entries until we run out of entries
-    while (i < tracker->size) {
-        if (uvm_tracker_is_entry_completed(&entries[i])) {
-            --tracker->size;
-            if (i != tracker->size)
-                entries[i] = entries[tracker->size];
-        }
-        else {
-            ++i;
-        }
+    // Compact the remaining entries in place, which keeps them sorted
+    for (i = 0; i < tracker->size; i++) {
+        if (uvm_tracker_is_entry_completed(&entries[i]))
+            continue;
+
+        if (i != new_size)
+            entries[new_size] = entries[i];
+
+        ++new_size;
     }
+
+    tracker->size = new_size;
 }
 
 bool uvm_tracker_is_completed(uvm_tracker_t *tracker)
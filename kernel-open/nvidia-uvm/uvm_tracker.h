@@ -56,6 +56,9 @@ typedef struct
     };
 
     // Number of used entries in the tracker
+    //
+    // The tracker keeps at most one entry per channel, with the highest value
+    // added for it, and the entries are sorted by channel.
     NvU32 size;
 
     // Max number of entries that the entries array can store currently
@@ -110,7 +113,8 @@ NV_STATUS uvm_tracker_reserve(uvm_tracker_t *tracker, NvU32 min_free_entries);
 NV_STATUS uvm_tracker_add_push(uvm_tracker_t *tracker, uvm_push_t *push);
 
 // Add a uvm_tracker_entry_t to a tracker
-// This may require allocating memory to fit a new entry in the tracker
+// This may require allocating memory to fit a new entry in the tracker. If the
+// tracker is full, completed entries are removed before growing it.
 NV_STATUS uvm_tracker_add_entry(uvm_tracker_t *tracker, uvm_tracker_entry_t *new_entry);
 
 // Overwrite the tracker with a single entry
@@ -124,7 +128,9 @@ void uvm_tracker_overwrite_with_entry(uvm_tracker_t *tracker, uvm_tracker_entry_
 void uvm_tracker_overwrite_with_push(uvm_tracker_t *tracker, uvm_push_t *push);
 
 // Add all entries from another tracker
-// This may require allocating memory to fit a new entry in the tracker.
+// This may require allocating memory to fit a new entry in the tracker. If the
+// destination doesn't have enough space, completed entries are removed from it
+// before growing it.
 // On error no entries are added to destination tracker.
 NV_STATUS uvm_tracker_add_tracker(uvm_tracker_t *dst, uvm_tracker_t *src);
 
@@ -196,6 +202,7 @@ NV_STATUS uvm_tracker_check_errors(uvm_tracker_t *tracker);
 NV_STATUS uvm_tracker_query(uvm_tracker_t *tracker);
 
 // Query all entries for completion and remove the completed ones
+// The remaining entries stay sorted.
 //
 // This won't change the max size of the tracker.
 void uvm_tracker_remove_completed(uvm_tracker_t *tracker);
@@ -53,6 +53,17 @@ static NV_STATUS assert_tracker_is_not_completed(uvm_tracker_t *tracker)
     return NV_OK;
 }
 
+static NV_STATUS assert_tracker_is_sorted(uvm_tracker_t *tracker)
+{
+    uvm_tracker_entry_t *entries = uvm_tracker_get_entries(tracker);
+    NvU32 i;
+
+    for (i = 1; i < tracker->size; i++)
+        TEST_CHECK_RET((uintptr_t)entries[i - 1].channel < (uintptr_t)entries[i].channel);
+
+    return NV_OK;
+}
+
 // This test schedules some GPU work behind a semaphore and then allows the GPU
 // to progress one tracker entry at a time verifying that the tracker entries
 // are completed as expected.
@@ -218,7 +229,10 @@ static NV_STATUS test_tracker_basic(uvm_va_space_t *va_space)
         }
     }
 
-    TEST_CHECK_GOTO(tracker.size == count, done);
+    // The entries are already completed so they may have been removed when
+    // the tracker needed to grow.
+    TEST_CHECK_GOTO(tracker.size <= count, done);
+    TEST_NV_CHECK_GOTO(assert_tracker_is_sorted(&tracker), done);
 
     // All the entries that we added are already completed
     TEST_CHECK_GOTO(assert_tracker_is_completed(&tracker) == NV_OK, done);
@@ -247,7 +261,8 @@ static NV_STATUS test_tracker_basic(uvm_va_space_t *va_space)
         }
     }
 
-    TEST_CHECK_GOTO(tracker.size == count, done);
+    TEST_CHECK_GOTO(tracker.size <= count, done);
+    TEST_NV_CHECK_GOTO(assert_tracker_is_sorted(&tracker), done);
     TEST_CHECK_GOTO(uvm_tracker_wait(&tracker) == NV_OK, done);
     // After a wait, the tracker should be complete
     TEST_CHECK_GOTO(assert_tracker_is_completed(&tracker) == NV_OK, done);
@@ -318,10 +333,12 @@ static NV_STATUS test_tracker_overwrite(uvm_va_space_t *va_space)
             }
         }
     }
-    TEST_CHECK_GOTO(tracker.size == count, done);
+    // Completed entries may have been removed when the tracker needed to grow
+    TEST_CHECK_GOTO(tracker.size <= count, done);
+    TEST_NV_CHECK_GOTO(assert_tracker_is_sorted(&tracker), done);
 
     status = uvm_tracker_overwrite(&dup_tracker, &tracker);
-    TEST_CHECK_GOTO(dup_tracker.size == count, done);
+    TEST_CHECK_GOTO(dup_tracker.size == tracker.size, done);
     for_each_tracker_entry(dup_entry_iter, &dup_tracker) {
         bool found = false;
         for_each_tracker_entry(entry_iter, &tracker) {
@@ -403,10 +420,13 @@ static NV_STATUS test_tracker_add_tracker(uvm_va_space_t *va_space)
             }
         }
     }
-    TEST_CHECK_GOTO(tracker.size == count, done);
+    // Completed entries may have been removed when the tracker needed to grow
+    TEST_CHECK_GOTO(tracker.size <= count, done);
+    TEST_NV_CHECK_GOTO(assert_tracker_is_sorted(&tracker), done);
 
     status = uvm_tracker_add_tracker_safe(&dup_tracker, &tracker);
-    TEST_CHECK_GOTO(dup_tracker.size == count, done);
+    TEST_CHECK_GOTO(dup_tracker.size == tracker.size, done);
+    TEST_NV_CHECK_GOTO(assert_tracker_is_sorted(&dup_tracker), done);
     for_each_tracker_entry(dup_entry_iter, &dup_tracker) {
         bool found = false;
         for_each_tracker_entry(entry_iter, &tracker) {
@@ -462,3 +482,113 @@ done:
 
     return status;
 }
+
+#define TRACKER_BENCHMARK_MAX_ITERATIONS (1000 * 1000)
+
+NV_STATUS uvm_test_tracker_benchmark(UVM_TEST_TRACKER_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_tracker_t all = UVM_TRACKER_INIT();
+    uvm_tracker_t merge_src = UVM_TRACKER_INIT();
+    uvm_tracker_t merge_dst = UVM_TRACKER_INIT();
+    uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    uvm_tracker_entry_t *entry;
+    uvm_gpu_t *gpu;
+    NvU64 merge_ns = 0;
+    NvU64 wait_ns = 0;
+    NvU32 num_channels = 0;
+    NvU32 i;
+    NV_STATUS status = NV_OK;
+
+    if (params->iterations == 0 || params->iterations > TRACKER_BENCHMARK_MAX_ITERATIONS)
+        return NV_ERR_INVALID_PARAMETER;
+
+    uvm_va_space_down_read_rm(va_space);
+
+    for_each_va_space_gpu(gpu, va_space) {
+        uvm_channel_pool_t *pool;
+
+        uvm_for_each_pool(pool, gpu->channel_manager)
+            num_channels += pool->num_channels;
+    }
+
+    if (num_channels == 0) {
+        status = NV_ERR_INVALID_STATE;
+        goto done;
+    }
+
+    // Reserve all the space upfront so that no entries are removed for
+    // compaction while setting up. All the entries are completed.
+    TEST_NV_CHECK_GOTO(uvm_tracker_reserve(&all, num_channels), done);
+    TEST_NV_CHECK_GOTO(uvm_tracker_reserve(&merge_src, num_channels), done);
+    TEST_NV_CHECK_GOTO(uvm_tracker_reserve(&merge_dst, num_channels), done);
+    TEST_NV_CHECK_GOTO(uvm_tracker_reserve(&tracker, num_channels), done);
+
+    for_each_va_space_gpu(gpu, va_space) {
+        uvm_channel_pool_t *pool;
+
+        uvm_for_each_pool(pool, gpu->channel_manager) {
+            uvm_channel_t *channel;
+
+            uvm_for_each_channel_in_pool(channel, pool) {
+                uvm_tracker_entry_t new_entry;
+
+                new_entry.channel = channel;
+                new_entry.value = uvm_channel_update_completed_value(channel);
+                TEST_NV_CHECK_GOTO(uvm_tracker_add_entry(&all, &new_entry), done);
+            }
+        }
+    }
+
+    // The merged trackers get alternating entries, with every fourth entry in
+    // both of them.
+    i = 0;
+    for_each_tracker_entry(entry, &all) {
+        if (i % 2 == 0 || i % 4 == 1)
+            TEST_NV_CHECK_GOTO(uvm_tracker_add_entry(&merge_dst, entry), done);
+        if (i % 2 == 1)
+            TEST_NV_CHECK_GOTO(uvm_tracker_add_entry(&merge_src, entry), done);
+        ++i;
+    }
+
+    for (i = 0; i < params->iterations; i++) {
+        NvU64 start;
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto done;
+        }
+
+        TEST_NV_CHECK_GOTO(uvm_tracker_overwrite(&tracker, &merge_dst), done);
+
+        start = NV_GETTIME();
+        status = uvm_tracker_add_tracker(&tracker, &merge_src);
+        merge_ns += NV_GETTIME() - start;
+
+        TEST_NV_CHECK_GOTO(status, done);
+        TEST_CHECK_GOTO(tracker.size == all.size, done);
+
+        TEST_NV_CHECK_GOTO(uvm_tracker_overwrite(&tracker, &all), done);
+
+        start = NV_GETTIME();
+        status = uvm_tracker_wait(&tracker);
+        wait_ns += NV_GETTIME() - start;
+
+        TEST_NV_CHECK_GOTO(status, done);
+        TEST_CHECK_GOTO(uvm_tracker_is_empty(&tracker), done);
+    }
+
+    params->num_entries = all.size;
+    params->merge_ns_per_op = merge_ns / params->iterations;
+    params->wait_ns_per_op = wait_ns / params->iterations;
+
+done:
+    uvm_va_space_up_read_rm(va_space);
+
+    uvm_tracker_deinit(&tracker);
+    uvm_tracker_deinit(&merge_dst);
+    uvm_tracker_deinit(&merge_src);
+    uvm_tracker_deinit(&all);
+
+    return status;
+}
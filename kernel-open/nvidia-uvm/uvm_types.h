@@ -223,6 +223,11 @@ typedef enum
     // number of faults reported on the GPU
     //
     UvmCounterNameGpuPageFaultCount = 9,
+    //
+    // User space sizes the counter buffer of tools event trackers with
+    // UVM_TOTAL_COUNTERS, so new counters can't be added without breaking
+    // existing tools.
+    //
     UVM_TOTAL_COUNTERS
 } UvmCounterName;
 
@@ -288,6 +293,7 @@ typedef enum
     UvmEventTypeThrottlingEnd              = 12,
     UvmEventTypeMapRemote                  = 13,
     UvmEventTypeEviction                   = 14,
+    UvmEventTypeThrashingClassified        = 15,
 
     // ---- Add new values above this line
     UvmEventNumTypes,
@@ -321,6 +327,7 @@ typedef enum
 #define UVM_EVENT_ENABLE_THROTTLING_END               ((NvU64)1 << UvmEventTypeThrottlingEnd)
 #define UVM_EVENT_ENABLE_MAP_REMOTE                   ((NvU64)1 << UvmEventTypeMapRemote)
 #define UVM_EVENT_ENABLE_EVICTION                     ((NvU64)1 << UvmEventTypeEviction)
+#define UVM_EVENT_ENABLE_THRASHING_CLASSIFIED         ((NvU64)1 << UvmEventTypeThrashingClassified)
 #define UVM_EVENT_ENABLE_TEST_ACCESS_COUNTER          ((NvU64)1 << UvmEventTypeTestAccessCounter)
 #define UVM_EVENT_ENABLE_TEST_HMM_SPLIT_INVALIDATE    ((NvU64)1 << UvmEventTypeTestHmmSplitInvalidate)
 
@@ -1192,6 +1199,104 @@ typedef struct
     NvU64 timeStamp;        // cpu time stamp when eviction starts on the cpu
 } UvmEventEvictionInfo_V2;
 
+typedef enum
+{
+    UvmEventThrashingClassInvalid          = 0,
+
+    // All, or almost all, of the accesses to the thrashing memory region are
+    // reads
+    UvmEventThrashingClassReadMostly       = 1,
+
+    // A single processor writes to the thrashing memory region and the rest
+    // of processors read from it
+    UvmEventThrashingClassProducerConsumer = 2,
+
+    // Several processors write to the thrashing memory region, or perform
+    // atomic operations on it
+    UvmEventThrashingClassWriteShared      = 3,
+
+    // ---- Add new values above this line
+    UvmEventNumThrashingClasses
+} UvmEventThrashingClass;
+
+typedef enum
+{
+    UvmEventThrashingMitigationInvalid       = 0,
+
+    // Readers get a local copy of the memory region
+    UvmEventThrashingMitigationReadDuplicate = 1,
+
+    // The memory region is pinned on the writer processor memory and the rest
+    // of processors map it remotely
+    UvmEventThrashingMitigationMapRemote     = 2,
+
+    // Access counter notifications from a reader migrated a memory region
+    // pinned on the writer processor memory, after the writer stopped writing
+    // to it
+    UvmEventThrashingMitigationRemigrate     = 3,
+
+    // Processors are throttled and, eventually, the memory region is pinned
+    // on a location accessible from all of them
+    UvmEventThrashingMitigationPin           = 4,
+
+    // ---- Add new values above this line
+    UvmEventNumThrashingMitigations
+} UvmEventThrashingMitigation;
+
+typedef struct
+{
+    //
+    // eventType has to be the 1st argument of this structure.
+    // Setting eventType = UvmEventTypeThrashingClassified helps to identify
+    // event data in a queue.
+    //
+    NvU8 eventType;
+    NvU8 thrashingClass;    // field of type UvmEventThrashingClass
+    NvU8 mitigation;        // field of type UvmEventThrashingMitigation
+    NvU8 processorIndex;    // index of the cpu/gpu whose access triggered the
+                            // decision
+    NvU8 numReads;          // number of recent read accesses to the region
+    NvU8 numWrites;         // number of recent write/atomic accesses to the
+                            // region
+    //
+    // This structure is shared between UVM kernel and tools.
+    // Manually padding the structure so that compiler options like pragma pack
+    // or malign-double will have no effect on the field offsets
+    //
+    NvU16 padding16bits;
+    NvU64 address;          // virtual address of the memory region that is
+                            // thrashing
+    NvU64 size;             // size of the memory region that is thrashing
+    NvU64 timeStamp;        // cpu time stamp when the decision was made
+} UvmEventThrashingClassifiedInfo;
+
+typedef struct
+{
+    //
+    // eventType has to be the 1st argument of this structure.
+    // Setting eventType = UvmEventTypeThrashingClassified helps to identify
+    // event data in a queue.
+    //
+    NvU8 eventType;
+    NvU8 thrashingClass;    // field of type UvmEventThrashingClass
+    NvU16 processorIndex;   // index of the cpu/gpu whose access triggered the
+                            // decision
+    NvU8 mitigation;        // field of type UvmEventThrashingMitigation
+    NvU8 numReads;          // number of recent read accesses to the region
+    NvU8 numWrites;         // number of recent write/atomic accesses to the
+                            // region
+    //
+    // This structure is shared between UVM kernel and tools.
+    // Manually padding the structure so that compiler options like pragma pack
+    // or malign-double will have no effect on the field offsets
+    //
+    NvU8 padding8bits;
+    NvU64 address;          // virtual address of the memory region that is
+                            // thrashing
+    NvU64 size;             // size of the memory region that is thrashing
+    NvU64 timeStamp;        // cpu time stamp when the decision was made
+} UvmEventThrashingClassifiedInfo_V2;
+
 // TODO: Bug 1870362: [uvm] Provide virtual address and processor index in
 // AccessCounter events
 //
@@ -1312,6 +1417,7 @@ typedef struct
             UvmEventThrottlingEndInfo throttlingEnd;
             UvmEventMapRemoteInfo mapRemote;
             UvmEventEvictionInfo eviction;
+            UvmEventThrashingClassifiedInfo thrashingClassified;
         } eventData;
 
         union
@@ -1346,6 +1452,7 @@ typedef struct
             UvmEventThrottlingEndInfo_V2 throttlingEnd;
             UvmEventMapRemoteInfo_V2 mapRemote;
             UvmEventEvictionInfo_V2 eviction;
+            UvmEventThrashingClassifiedInfo_V2 thrashingClassified;
         } eventData;
 
         union
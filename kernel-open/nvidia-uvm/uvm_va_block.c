@@ -40,9 +40,11 @@
 #include "uvm_mem.h"
 #include "uvm_gpu_access_counters.h"
 #include "uvm_va_space_mm.h"
+#include "uvm_test.h"
 #include "uvm_test_ioctl.h"
 #include "uvm_va_policy.h"
 #include "uvm_conf_computing.h"
+#include "uvm_ce_coalescer.h"
 #include "uvm_migrate.h"
 
 typedef enum
@@ -55,9 +57,9 @@ typedef enum
 static NvU64 uvm_perf_authorized_cpu_fault_tracking_window_ns = 300000;
 
 static struct kmem_cache *g_uvm_va_block_cache __read_mostly;
-static struct kmem_cache *g_uvm_va_block_gpu_state_cache __read_mostly;
+static uvm_kvmalloc_cache_t g_uvm_va_block_gpu_state_cache __read_mostly;
 static struct kmem_cache *g_uvm_page_mask_cache __read_mostly;
-static struct kmem_cache *g_uvm_va_block_context_cache __read_mostly;
+static uvm_kvmalloc_cache_t g_uvm_va_block_context_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_block_cpu_node_state_cache __read_mostly;
 
 static int uvm_fault_force_sysmem __read_mostly = 0;
@@ -896,6 +898,8 @@ static block_phys_page_t block_phys_page(uvm_processor_id_t processor, int nid,
 
 NV_STATUS uvm_va_block_init(void)
 {
+    NV_STATUS status;
+
     if (uvm_enable_builtin_tests)
         g_uvm_va_block_cache = NV_KMEM_CACHE_CREATE("uvm_va_block_wrapper_t", uvm_va_block_wrapper_t);
     else
@@ -904,17 +908,17 @@ NV_STATUS uvm_va_block_init(void)
     if (!g_uvm_va_block_cache)
         return NV_ERR_NO_MEMORY;
 
-    g_uvm_va_block_gpu_state_cache = NV_KMEM_CACHE_CREATE("uvm_va_block_gpu_state_t", uvm_va_block_gpu_state_t);
-    if (!g_uvm_va_block_gpu_state_cache)
-        return NV_ERR_NO_MEMORY;
+    status = UVM_KVMALLOC_CACHE_INIT(&g_uvm_va_block_gpu_state_cache, uvm_va_block_gpu_state_t);
+    if (status != NV_OK)
+        return status;
 
     g_uvm_page_mask_cache = NV_KMEM_CACHE_CREATE("uvm_page_mask_t", uvm_page_mask_t);
     if (!g_uvm_page_mask_cache)
         return NV_ERR_NO_MEMORY;
 
-    g_uvm_va_block_context_cache = NV_KMEM_CACHE_CREATE("uvm_va_block_context_t", uvm_va_block_context_t);
-    if (!g_uvm_va_block_context_cache)
-        return NV_ERR_NO_MEMORY;
+    status = UVM_KVMALLOC_CACHE_INIT(&g_uvm_va_block_context_cache, uvm_va_block_context_t);
+    if (status != NV_OK)
+        return status;
 
     g_uvm_va_block_cpu_node_state_cache = NV_KMEM_CACHE_CREATE("uvm_va_block_cpu_node_state_t",
                                                                uvm_va_block_cpu_node_state_t);
@@ -927,9 +931,9 @@ NV_STATUS uvm_va_block_init(void)
 void uvm_va_block_exit(void)
 {
     kmem_cache_destroy_safe(&g_uvm_va_block_cpu_node_state_cache);
-    kmem_cache_destroy_safe(&g_uvm_va_block_context_cache);
+    uvm_kvmalloc_cache_deinit(&g_uvm_va_block_context_cache);
     kmem_cache_destroy_safe(&g_uvm_page_mask_cache);
-    kmem_cache_destroy_safe(&g_uvm_va_block_gpu_state_cache);
+    uvm_kvmalloc_cache_deinit(&g_uvm_va_block_gpu_state_cache);
     kmem_cache_destroy_safe(&g_uvm_va_block_cache);
 }
 
@@ -968,7 +972,7 @@ error:
 
 uvm_va_block_context_t *uvm_va_block_context_alloc(struct mm_struct *mm)
 {
-    uvm_va_block_context_t *block_context = kmem_cache_alloc(g_uvm_va_block_context_cache, NV_UVM_GFP_FLAGS);
+    uvm_va_block_context_t *block_context = uvm_kvmalloc_cache_alloc(&g_uvm_va_block_context_cache);
     NV_STATUS status;
 
     if (!block_context)
@@ -976,7 +980,7 @@ uvm_va_block_context_t *uvm_va_block_context_alloc(struct mm_struct *mm)
 
     status = block_context_alloc_tracking(&block_context->make_resident.cpu_pages_used);
     if (status != NV_OK) {
-        kmem_cache_free(g_uvm_va_block_context_cache, block_context);
+        uvm_kvmalloc_cache_free(&g_uvm_va_block_context_cache, block_context);
         return NULL;
     }
 
@@ -1005,13 +1009,17 @@ void uvm_va_block_context_init(uvm_va_block_context_t *va_block_context, struct
     va_block_context->mm = mm;
     va_block_context->make_resident.dest_nid = NUMA_NO_NODE;
     nodes_clear(va_block_context->make_resident.cpu_pages_used.nodes);
+
+#if UVM_IS_CONFIG_HMM()
+    va_block_context->hmm.migrate_batch = NULL;
+#endif
 }
 
 void uvm_va_block_context_free(uvm_va_block_context_t *va_block_context)
 {
     if (va_block_context) {
         block_context_free_tracking(&va_block_context->make_resident.cpu_pages_used);
-        kmem_cache_free(g_uvm_va_block_context_cache, va_block_context);
+        uvm_kvmalloc_cache_free(&g_uvm_va_block_context_cache, va_block_context);
     }
 }
 
@@ -1414,7 +1422,7 @@ uvm_va_block_gpu_state_t *uvm_va_block_gpu_state_get_alloc(uvm_va_block_t *block
     if (gpu_state)
         return gpu_state;
 
-    gpu_state = nv_kmem_cache_zalloc(g_uvm_va_block_gpu_state_cache, NV_UVM_GFP_FLAGS);
+    gpu_state = uvm_kvmalloc_cache_alloc_zero(&g_uvm_va_block_gpu_state_cache);
     if (!gpu_state)
         return NULL;
 
@@ -1432,7 +1440,7 @@ uvm_va_block_gpu_state_t *uvm_va_block_gpu_state_get_alloc(uvm_va_block_t *block
 
 error:
     uvm_kvfree(gpu_state->chunks);
-    kmem_cache_free(g_uvm_va_block_gpu_state_cache, gpu_state);
+    uvm_kvmalloc_cache_free(&g_uvm_va_block_gpu_state_cache, gpu_state);
     block->gpus[uvm_id_gpu_index(gpu->id)] = NULL;
 
     return NULL;
@@ -3314,8 +3322,13 @@ typedef struct
     uvm_conf_computing_dma_buffer_t *dma_buffer;
 
     // True if at least one CE transfer (such as a memcopy) has already been
-    // pushed to the GPU during the VA block copy thus far.
+    // pushed to the GPU during the VA block copy thus far. Only used for
+    // Confidential Computing copies between the CPU and a GPU, the rest of
+    // copies are pushed through the coalescer.
     bool copy_pushed;
+
+    // Merges the copies of the pages of the block into fewer CE transfers
+    uvm_ce_coalescer_t coalescer;
 } block_copy_state_t;
 
 // Begin a push appropriate for copying data from src_id processor to dst_id
@@ -3505,16 +3518,50 @@ static void block_mark_memory_used(uvm_va_block_t *block, uvm_processor_id_t id)
     }
 }
 
+static void block_mark_memory_accessed(uvm_va_block_t *block, uvm_processor_id_t id, bool hot)
+{
+    uvm_gpu_t *gpu;
+
+    if (UVM_ID_IS_CPU(id))
+        return;
+
+    gpu = uvm_gpu_get(id);
+
+    // Same conditions as in block_mark_memory_used()
+    if (!uvm_va_block_is_hmm(block) &&
+        uvm_va_block_size(block) == UVM_CHUNK_SIZE_MAX &&
+        uvm_parent_gpu_supports_eviction(gpu->parent)) {
+        uvm_gpu_chunk_t *chunk = uvm_va_block_gpu_state_get(block, gpu->id)->chunks[0];
+
+        if (hot)
+            uvm_pmm_gpu_mark_root_chunk_hot(&gpu->pmm, chunk);
+        else
+            uvm_pmm_gpu_mark_root_chunk_accessed(&gpu->pmm, chunk);
+    }
+}
+
 static void block_set_resident_processor(uvm_va_block_t *block, uvm_processor_id_t id)
 {
     UVM_ASSERT(!uvm_page_mask_empty(uvm_va_block_resident_mask_get(block, id, NUMA_NO_NODE)));
 
-    if (uvm_processor_mask_test_and_set(&block->resident, id))
+    // More pages of a block that is already resident on a GPU count as a
+    // reuse of its memory for eviction purposes
+    if (uvm_processor_mask_test_and_set(&block->resident, id)) {
+        block_mark_memory_accessed(block, id, false);
         return;
+    }
 
     block_mark_memory_used(block, id);
 }
 
+void uvm_va_block_mark_gpu_memory_hot(uvm_va_block_t *va_block, uvm_gpu_t *gpu)
+{
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    if (uvm_processor_mask_test(&va_block->resident, gpu->id))
+        block_mark_memory_accessed(va_block, gpu->id, true);
+}
+
 static void block_clear_resident_processor(uvm_va_block_t *block, uvm_processor_id_t id)
 {
     uvm_gpu_t *gpu;
@@ -3813,30 +3860,44 @@ static void block_copy_push(uvm_va_block_t *block,
     uvm_gpu_address_t gpu_dst_address, gpu_src_address;
     uvm_gpu_t *gpu = uvm_push_get_gpu(push);
 
-    // Only the first transfer is not pipelined. Since the callees observe the
-    // caller's pipeline settings, pipelining must be disabled in that first
-    // transfer.
-    if (copy_state->copy_pushed)
-        uvm_push_set_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
-    else
-        UVM_ASSERT(!uvm_push_test_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED));
+    if (is_cc_sysmem_copy(copy_state)) {
+        // Only the first transfer is not pipelined. Since the callees observe
+        // the caller's pipeline settings, pipelining must be disabled in that
+        // first transfer.
+        if (copy_state->copy_pushed)
+            uvm_push_set_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+        else
+            UVM_ASSERT(!uvm_push_test_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED));
 
-    uvm_push_set_flag(push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+        uvm_push_set_flag(push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
 
-    if (is_cc_sysmem_copy(copy_state)) {
         if (UVM_ID_IS_CPU(copy_state->src.id))
             conf_computing_block_copy_push_cpu_to_gpu(block, copy_state, region, push);
         else
             conf_computing_block_copy_push_gpu_to_cpu(block, copy_state, region, push);
+
+        copy_state->copy_pushed = true;
     }
     else {
         gpu_dst_address = block_copy_get_address(block, &copy_state->dst, region.first, gpu);
         gpu_src_address = block_copy_get_address(block, &copy_state->src, region.first, gpu);
 
-        gpu->parent->ce_hal->memcopy(push, gpu_dst_address, gpu_src_address, uvm_va_block_region_size(region));
+        // The coalescer applies the same pipelining and membar settings as
+        // above to the transfers it issues.
+        uvm_ce_coalescer_add(&copy_state->coalescer,
+                             push,
+                             gpu_dst_address,
+                             gpu_src_address,
+                             uvm_va_block_region_size(region));
     }
+}
 
-    copy_state->copy_pushed = true;
+// Migration events recorded by tools take a GPU timestamp in the push, which
+// must come after the copies of the migrated region.
+static void block_copy_flush_for_event(uvm_va_space_t *va_space, block_copy_state_t *copy_state, uvm_push_t *push)
+{
+    if (va_space->tools.enabled)
+        uvm_ce_coalescer_flush(&copy_state->coalescer, push);
 }
 
 static NV_STATUS block_copy_end_push(uvm_va_block_t *block,
@@ -3847,6 +3908,8 @@ static NV_STATUS block_copy_end_push(uvm_va_block_t *block,
 {
     NV_STATUS tracker_status;
 
+    uvm_ce_coalescer_end(&copy_state->coalescer, push);
+
     // TODO: Bug 1766424: If the destination is a GPU and the copy was done
     //       by that GPU, use a GPU-local membar if no peer can currently
     //       map this page. When peer access gets enabled, do a MEMBAR_SYS
@@ -4065,6 +4128,7 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
     copy_state.dst.id = dst_id;
     copy_state.src.nid = src_nid;
     copy_state.dst.nid = dst_nid;
+    uvm_ce_coalescer_init(&copy_state.coalescer, false);
 
     copy_state.src.is_block_contig = is_block_phys_contig(block, src_id, copy_state.src.nid);
     copy_state.dst.is_block_contig = is_block_phys_contig(block, dst_id, copy_state.dst.nid);
@@ -4235,6 +4299,7 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
             }
 
             if (block_copy_should_use_push(block, &copy_state)) {
+                block_copy_flush_for_event(va_space, &copy_state, &push);
                 uvm_perf_event_notify_migration(&va_space->perf_events,
                                                 &push,
                                                 block,
@@ -4284,6 +4349,7 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
         }
 
         if (block_copy_should_use_push(block, &copy_state)) {
+            block_copy_flush_for_event(va_space, &copy_state, &push);
             uvm_perf_event_notify_migration(&va_space->perf_events,
                                             &push,
                                             block,
@@ -4402,9 +4468,64 @@ static NV_STATUS block_copy_resident_pages_from(uvm_va_block_t *block,
     return status;
 }
 
+static NV_STATUS block_copy_resident_pages_from_processor(uvm_va_block_t *block,
+                                                          uvm_va_block_context_t *block_context,
+                                                          uvm_processor_id_t dst_id,
+                                                          uvm_processor_id_t src_id,
+                                                          uvm_va_block_region_t region,
+                                                          const uvm_page_mask_t *page_mask,
+                                                          const uvm_page_mask_t *prefetch_page_mask,
+                                                          uvm_va_block_transfer_mode_t transfer_mode,
+                                                          uvm_page_mask_t *migrated_pages,
+                                                          NvU32 *copied_pages_out,
+                                                          uvm_tracker_t *tracker_out)
+{
+    NV_STATUS status = NV_OK;
+    int nid;
+
+    if (UVM_ID_IS_GPU(src_id)) {
+        return block_copy_resident_pages_from(block,
+                                              block_context,
+                                              dst_id,
+                                              src_id,
+                                              NUMA_NO_NODE,
+                                              region,
+                                              page_mask,
+                                              prefetch_page_mask,
+                                              transfer_mode,
+                                              migrated_pages,
+                                              copied_pages_out,
+                                              tracker_out);
+    }
+
+    for_each_possible_uvm_node(nid) {
+        status = block_copy_resident_pages_from(block,
+                                                block_context,
+                                                dst_id,
+                                                src_id,
+                                                nid,
+                                                region,
+                                                page_mask,
+                                                prefetch_page_mask,
+                                                transfer_mode,
+                                                migrated_pages,
+                                                copied_pages_out,
+                                                tracker_out);
+
+        if (status != NV_OK)
+            break;
+    }
+
+    return status;
+}
+
 // Copy resident pages to the destination from all source processors in the
 // src_processor_mask
 //
+// If preferred_src_id is valid and in src_processor_mask, pages are copied
+// from it first. The remaining processors are used in order of proximity to
+// the destination.
+//
 // The function adds the pages that were successfully copied to the output
 // migrated_pages mask and returns the number of pages in copied_pages. These
 // fields are reliable even if an error is returned.
@@ -4412,6 +4533,7 @@ static NV_STATUS block_copy_resident_pages_mask(uvm_va_block_t *block,
                                                 uvm_va_block_context_t *block_context,
                                                 uvm_processor_id_t dst_id,
                                                 const uvm_processor_mask_t *src_processor_mask,
+                                                uvm_processor_id_t preferred_src_id,
                                                 uvm_va_block_region_t region,
                                                 const uvm_page_mask_t *page_mask,
                                                 const uvm_page_mask_t *prefetch_page_mask,
@@ -4434,43 +4556,37 @@ static NV_STATUS block_copy_resident_pages_mask(uvm_va_block_t *block,
 
     uvm_processor_mask_copy(search_mask, src_processor_mask);
 
-    for_each_closest_id(src_id, search_mask, dst_id, va_space) {
-        if (UVM_ID_IS_CPU(src_id)) {
-            int nid;
+    if (UVM_ID_IS_VALID(preferred_src_id) && uvm_processor_mask_test_and_clear(search_mask, preferred_src_id)) {
+        status = block_copy_resident_pages_from_processor(block,
+                                                          block_context,
+                                                          dst_id,
+                                                          preferred_src_id,
+                                                          region,
+                                                          page_mask,
+                                                          prefetch_page_mask,
+                                                          transfer_mode,
+                                                          migrated_pages,
+                                                          copied_pages_out,
+                                                          tracker_out);
 
-            for_each_possible_uvm_node(nid) {
-                status = block_copy_resident_pages_from(block,
-                                                        block_context,
-                                                        dst_id,
-                                                        src_id,
-                                                        nid,
-                                                        region,
-                                                        page_mask,
-                                                        prefetch_page_mask,
-                                                        transfer_mode,
-                                                        migrated_pages,
-                                                        copied_pages_out,
-                                                        tracker_out);
+        UVM_ASSERT(*copied_pages_out <= max_pages_to_copy);
 
-                if (status != NV_OK)
-                    break;
-            }
-        }
-        else {
-            status = block_copy_resident_pages_from(block,
-                                                    block_context,
-                                                    dst_id,
-                                                    src_id,
-                                                    NUMA_NO_NODE,
-                                                    region,
-                                                    page_mask,
-                                                    prefetch_page_mask,
-                                                    transfer_mode,
-                                                    migrated_pages,
-                                                    copied_pages_out,
-                                                    tracker_out);
+        if (status != NV_OK || *copied_pages_out == max_pages_to_copy)
+            goto out;
+    }
 
-        }
+    for_each_closest_id(src_id, search_mask, dst_id, va_space) {
+        status = block_copy_resident_pages_from_processor(block,
+                                                          block_context,
+                                                          dst_id,
+                                                          src_id,
+                                                          region,
+                                                          page_mask,
+                                                          prefetch_page_mask,
+                                                          transfer_mode,
+                                                          migrated_pages,
+                                                          copied_pages_out,
+                                                          tracker_out);
 
         UVM_ASSERT(*copied_pages_out <= max_pages_to_copy);
 
@@ -4482,6 +4598,7 @@ static NV_STATUS block_copy_resident_pages_mask(uvm_va_block_t *block,
             break;
     }
 
+out:
     uvm_processor_mask_cache_free(search_mask);
     return status;
 }
@@ -4620,8 +4737,9 @@ static void block_select_cpu_node_pages(uvm_va_block_t *block,
 // Copy resident pages from other processors to the destination.
 // All the pages on the destination need to be populated by the caller first.
 // Pages not resident anywhere else need to be zeroed out as well.
-// The transfer_mode is only used to tell uvm_perf_event_notify_migration()
-// whether the copy is for a migration or read duplication.
+// The transfer_mode is used to tell uvm_perf_event_notify_migration()
+// whether the copy is for a migration or read duplication, and to plan the
+// copy sources of read duplications to GPUs.
 static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
                                            uvm_va_block_context_t *block_context,
                                            uvm_processor_id_t dst_id,
@@ -4640,6 +4758,7 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
     NvU32 pages_copied;
     NvU32 pages_copied_to_cpu = 0;
     uvm_processor_mask_t *src_processor_mask = NULL;
+    uvm_processor_id_t preferred_src_id = UVM_ID_INVALID;
     uvm_page_mask_t *copy_page_mask = &block_context->make_resident.page_mask;
     uvm_page_mask_t *migrated_pages = &block_context->make_resident.pages_migrated;
     uvm_page_mask_t *pages_staged = &block_context->make_resident.pages_staged;
@@ -4684,9 +4803,6 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
     }
 
     // TODO: Bug 1753731: Add P2P2P copies staged through a GPU
-    // TODO: Bug 1753731: When a page is resident in multiple locations due to
-    //       read-duplication, spread out the source of the copy so we don't
-    //       bottleneck on a single location.
 
     uvm_processor_mask_zero(src_processor_mask);
 
@@ -4697,6 +4813,14 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
         // staged copies.
         uvm_processor_mask_and(src_processor_mask, block_get_can_copy_from_mask(block, dst_id), &block->resident);
         uvm_processor_mask_clear(src_processor_mask, dst_id);
+
+        // When a page is resident in multiple locations due to
+        // read-duplication, spread out the source of the copy so we don't
+        // bottleneck on a single location.
+        if (transfer_mode == UVM_VA_BLOCK_TRANSFER_MODE_COPY)
+            preferred_src_id = uvm_va_space_broadcast_source(uvm_va_block_get_va_space(block),
+                                                             src_processor_mask,
+                                                             dst_id);
     }
 
     if (UVM_ID_IS_GPU(dst_id)) {
@@ -4704,6 +4828,7 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
                                                 block_context,
                                                 dst_id,
                                                 src_processor_mask,
+                                                preferred_src_id,
                                                 region,
                                                 copy_page_mask,
                                                 prefetch_page_mask,
@@ -4747,6 +4872,7 @@ static NV_STATUS block_copy_resident_pages(uvm_va_block_t *block,
                                                 block_context,
                                                 UVM_ID_CPU,
                                                 src_processor_mask,
+                                                UVM_ID_INVALID,
                                                 region,
                                                 cpu_page_mask,
                                                 prefetch_page_mask,
@@ -4854,6 +4980,100 @@ static void block_cleanup_temp_pinned_gpu_chunks(uvm_va_block_t *va_block, uvm_g
     }
 }
 
+// When a 2M VA block is fully resident on a GPU and none of its pages is
+// resident on the CPU, its CPU chunks don't hold any data. If they are smaller
+// than 2M, typically because 2M allocations failed under fragmentation when
+// the block was populated, replace them with a single 2M chunk so that the
+// next migration to the CPU, and the GPU mappings of the CPU copy, use one
+// physically contiguous chunk. The small chunks are kept if the 2M allocation
+// fails.
+//
+// The migration that makes the block fully resident on the GPU only sets
+// cpu.merge_pending, since its copies are still reading from the chunks being
+// replaced. The merge is done here at the start of the next migration to the
+// CPU, by which time that work has normally completed. If it hasn't, the merge
+// is postponed again rather than stalling the migration.
+//
+// Chunks resident on the CPU can't be merged this way, since that would
+// require copying their data and updating the CPU mappings.
+static void block_merge_cpu_chunks_to_2m_if_unused(uvm_va_block_t *va_block, uvm_va_block_context_t *block_context)
+{
+    uvm_va_block_test_t *block_test = uvm_va_block_get_test(va_block);
+    uvm_va_block_region_t block_region = uvm_va_block_region_from_block(va_block);
+    uvm_cpu_chunk_alloc_flags_t alloc_flags = UVM_CPU_CHUNK_ALLOC_FLAGS_STRICT;
+    uvm_cpu_chunk_t *chunk;
+    uvm_page_index_t page_index;
+    uvm_memcg_context_t memcg_context;
+    int chunk_nid = NUMA_NO_NODE;
+    int nid;
+    NV_STATUS status;
+
+    if (!va_block->cpu.merge_pending)
+        return;
+
+    if (uvm_tracker_query(&va_block->tracker) != NV_OK)
+        return;
+
+    va_block->cpu.merge_pending = false;
+
+    if (!uvm_cpu_chunk_merge_enabled() && !(block_test && block_test->force_cpu_chunk_merge))
+        return;
+
+    if (uvm_va_block_is_hmm(va_block) || uvm_va_block_size(va_block) != UVM_CHUNK_SIZE_2M)
+        return;
+
+    if (!(uvm_cpu_chunk_get_allocation_sizes() & UVM_CHUNK_SIZE_2M))
+        return;
+
+    if (block_test && block_test->cpu_chunk_allocation_size_mask &&
+        !(block_test->cpu_chunk_allocation_size_mask & UVM_CHUNK_SIZE_2M))
+        return;
+
+    if (uvm_processor_mask_test(&va_block->resident, UVM_ID_CPU) ||
+        uvm_page_mask_empty(&va_block->cpu.allocated))
+        return;
+
+    for_each_possible_uvm_node(nid) {
+        for_each_cpu_chunk_in_block(chunk, page_index, va_block, nid) {
+            if (uvm_cpu_chunk_get_size(chunk) == UVM_CHUNK_SIZE_2M)
+                return;
+
+            if (chunk_nid == NUMA_NO_NODE)
+                chunk_nid = nid;
+        }
+    }
+
+    if (block_context->mm)
+        alloc_flags |= UVM_CPU_CHUNK_ALLOC_FLAGS_ACCOUNT;
+
+    if (uvm_va_block_get_va_space(va_block)->test.allow_allocation_from_movable)
+        alloc_flags |= UVM_CPU_CHUNK_ALLOC_FLAGS_ALLOW_MOVABLE;
+
+    // Keep the chunk on the node of the chunks it replaces.
+    uvm_memcg_context_start(&memcg_context, block_context->mm);
+    status = uvm_cpu_chunk_alloc(UVM_CHUNK_SIZE_2M, alloc_flags, chunk_nid, &chunk);
+    uvm_memcg_context_end(&memcg_context);
+    if (status != NV_OK)
+        return;
+
+    uvm_va_block_remove_cpu_chunks(va_block, block_region);
+
+    // The block is left without CPU chunks if any of the steps below fails,
+    // which is a valid state: they will be populated again on demand.
+    if (uvm_cpu_chunk_insert_in_block(va_block, chunk, block_region.first) != NV_OK) {
+        uvm_cpu_chunk_free(chunk);
+        return;
+    }
+
+    if (uvm_va_block_map_cpu_chunk_on_gpus(va_block, chunk) != NV_OK) {
+        uvm_cpu_chunk_remove_from_block(va_block, chunk, uvm_cpu_chunk_get_numa_node(chunk), block_region.first);
+        uvm_cpu_chunk_free(chunk);
+        return;
+    }
+
+    uvm_cpu_chunk_merge_record();
+}
+
 NV_STATUS uvm_va_block_make_resident_copy(uvm_va_block_t *va_block,
                                           uvm_va_block_retry_t *va_block_retry,
                                           uvm_va_block_context_t *va_block_context,
@@ -4881,6 +5101,11 @@ NV_STATUS uvm_va_block_make_resident_copy(uvm_va_block_t *va_block,
     uvm_assert_mutex_locked(&va_block->lock);
     UVM_ASSERT(uvm_va_block_is_hmm(va_block) || va_block->managed_range);
 
+    // This must be done before any of the work below is added to the block
+    // tracker.
+    if (UVM_ID_IS_CPU(dest_id))
+        block_merge_cpu_chunks_to_2m_if_unused(va_block, va_block_context);
+
     unmap_processor_mask = uvm_processor_mask_cache_alloc();
     if (!unmap_processor_mask) {
         status = NV_ERR_NO_MEMORY;
@@ -5075,9 +5300,15 @@ void uvm_va_block_make_resident_finish(uvm_va_block_t *va_block,
     if (uvm_processor_mask_test(&va_block->resident, dst_id))
         block_mark_memory_used(va_block, dst_id);
 
-    if (UVM_ID_IS_GPU(dst_id) && uvm_page_mask_full(uvm_va_block_resident_mask_get(va_block, dst_id, NUMA_NO_NODE)))
+    if (UVM_ID_IS_GPU(dst_id) && uvm_page_mask_full(uvm_va_block_resident_mask_get(va_block, dst_id, NUMA_NO_NODE))) {
         uvm_processor_mask_set(&va_block->ever_fully_resident, dst_id);
 
+        // The copies above may still be reading from the CPU chunks, so only
+        // flag them for block_merge_cpu_chunks_to_2m_if_unused.
+        if (!uvm_page_mask_empty(migrated_pages) && !uvm_page_mask_empty(&va_block->cpu.allocated))
+            va_block->cpu.merge_pending = true;
+    }
+
     // Check state of all chunks after residency change.
     // TODO: Bug 4207783: Check both CPU and GPU chunks.
     UVM_ASSERT(block_check_cpu_chunks(va_block));
@@ -9254,7 +9485,7 @@ static void block_destroy_gpu_state(uvm_va_block_t *block, uvm_va_block_context_
     block_gpu_unmap_phys_all_cpu_pages(block, gpu);
     uvm_processor_mask_clear(&block->evicted_gpus, id);
 
-    kmem_cache_free(g_uvm_va_block_gpu_state_cache, gpu_state);
+    uvm_kvmalloc_cache_free(&g_uvm_va_block_gpu_state_cache, gpu_state);
     block->gpus[uvm_id_gpu_index(id)] = NULL;
 }
 
@@ -9548,6 +9779,7 @@ static NV_STATUS block_evict_pages_from_gpu(uvm_va_block_t *va_block, uvm_gpu_t
                                                  subregion,
                                                  UVM_ID_CPU,
                                                  UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                                 UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                  NULL);
         }
 
@@ -11530,6 +11762,11 @@ static bool can_read_duplicate(uvm_va_block_t *va_block,
         thrashing_hint->type != UVM_PERF_THRASHING_HINT_TYPE_PIN)
         return true;
 
+    // Read-mostly thrashing pages
+    if (policy->read_duplication != UVM_READ_DUPLICATION_DISABLED &&
+        thrashing_hint->type == UVM_PERF_THRASHING_HINT_TYPE_READ_DUPLICATE)
+        return true;
+
     return false;
 }
 
@@ -12813,7 +13050,12 @@ static NV_STATUS block_cpu_fault_locked(uvm_va_block_t *va_block,
     if (skip_cpu_fault_with_valid_permissions(va_block, page_index, fault_access_type))
         return NV_OK;
 
-    thrashing_hint = uvm_perf_thrashing_get_hint(va_block, service_context->block_context, fault_addr, UVM_ID_CPU);
+    thrashing_hint = uvm_perf_thrashing_get_hint(va_block,
+                                                 service_context->block_context,
+                                                 fault_addr,
+                                                 UVM_ID_CPU,
+                                                 uvm_fault_access_type_mask_bit(fault_access_type),
+                                                 UVM_SERVICE_OPERATION_REPLAYABLE_FAULTS);
     // Throttling is implemented by sleeping in the fault handler on the CPU
     if (thrashing_hint.type == UVM_PERF_THRASHING_HINT_TYPE_THROTTLE) {
         service_context->cpu_fault.wakeup_time_stamp = thrashing_hint.throttle.end_time_stamp;
@@ -14049,6 +14291,182 @@ out:
     return status;
 }
 
+// Returns the size of the largest CPU chunk of the block, or 0 if the block has
+// no CPU chunks.
+static uvm_chunk_size_t block_test_max_cpu_chunk_size(uvm_va_block_t *va_block)
+{
+    uvm_chunk_size_t max_size = 0;
+    uvm_cpu_chunk_t *chunk;
+    uvm_page_index_t page_index;
+    int nid;
+
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    for_each_possible_uvm_node(nid) {
+        for_each_cpu_chunk_in_block(chunk, page_index, va_block, nid)
+            max_size = max(max_size, uvm_cpu_chunk_get_size(chunk));
+    }
+
+    return max_size;
+}
+
+static NV_STATUS block_test_make_resident_all_locked(uvm_va_block_t *va_block,
+                                                     uvm_va_block_retry_t *va_block_retry,
+                                                     uvm_va_block_context_t *va_block_context,
+                                                     uvm_processor_id_t dest_id)
+{
+    NV_STATUS status;
+
+    status = uvm_va_block_make_resident(va_block,
+                                        va_block_retry,
+                                        va_block_context,
+                                        dest_id,
+                                        uvm_va_block_region_from_block(va_block),
+                                        NULL,
+                                        NULL,
+                                        UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+    if (status != NV_OK)
+        return status;
+
+    // Wait for the copies, as a synchronous migration would, so that the next
+    // migration finds the block tracker completed.
+    return uvm_tracker_wait(&va_block->tracker);
+}
+
+static NV_STATUS test_cpu_chunk_merge(uvm_va_block_t *va_block,
+                                      uvm_va_block_context_t *va_block_context,
+                                      uvm_gpu_t *gpu)
+{
+    uvm_va_block_test_t *va_block_test = uvm_va_block_get_test(va_block);
+    uvm_va_block_retry_t va_block_retry;
+    uvm_chunk_size_t max_size;
+    bool cpu_resident;
+    NV_STATUS status;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    if (!uvm_page_mask_empty(&va_block->cpu.allocated) || !uvm_processor_mask_empty(&va_block->resident)) {
+        uvm_mutex_unlock(&va_block->lock);
+        return NV_ERR_INVALID_STATE;
+    }
+
+    va_block_test->cpu_chunk_allocation_size_mask = PAGE_SIZE;
+    va_block_test->force_cpu_chunk_merge = true;
+
+    uvm_mutex_unlock(&va_block->lock);
+
+    // Populate the block on the CPU with PAGE_SIZE chunks
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     block_test_make_resident_all_locked(va_block,
+                                                                         &va_block_retry,
+                                                                         va_block_context,
+                                                                         UVM_ID_CPU));
+    if (status != NV_OK)
+        goto out;
+
+    uvm_mutex_lock(&va_block->lock);
+    max_size = block_test_max_cpu_chunk_size(va_block);
+    va_block_test->cpu_chunk_allocation_size_mask = 0;
+    uvm_mutex_unlock(&va_block->lock);
+
+    TEST_CHECK_GOTO(max_size == PAGE_SIZE, out);
+
+    // Making the block fully resident on the GPU must not free the chunks the
+    // copies read from, only flag them for merging.
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     block_test_make_resident_all_locked(va_block,
+                                                                         &va_block_retry,
+                                                                         va_block_context,
+                                                                         gpu->id));
+    if (status != NV_OK)
+        goto out;
+
+    uvm_mutex_lock(&va_block->lock);
+    max_size = block_test_max_cpu_chunk_size(va_block);
+    uvm_mutex_unlock(&va_block->lock);
+
+    TEST_CHECK_GOTO(max_size == PAGE_SIZE, out);
+
+    // The next migration to the CPU merges them
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     block_test_make_resident_all_locked(va_block,
+                                                                         &va_block_retry,
+                                                                         va_block_context,
+                                                                         UVM_ID_CPU));
+    if (status != NV_OK)
+        goto out;
+
+    uvm_mutex_lock(&va_block->lock);
+    max_size = block_test_max_cpu_chunk_size(va_block);
+    cpu_resident = uvm_page_mask_full(uvm_va_block_resident_mask_get(va_block, UVM_ID_CPU, NUMA_NO_NODE));
+    uvm_mutex_unlock(&va_block->lock);
+
+    TEST_CHECK_GOTO(cpu_resident, out);
+
+    if (max_size != UVM_CHUNK_SIZE_2M) {
+        UVM_TEST_PRINT("CPU chunks not merged, largest chunk size 0x%x\n", max_size);
+        status = NV_ERR_INVALID_STATE;
+    }
+
+out:
+    uvm_mutex_lock(&va_block->lock);
+    va_block_test->cpu_chunk_allocation_size_mask = 0;
+    va_block_test->force_cpu_chunk_merge = false;
+    uvm_mutex_unlock(&va_block->lock);
+
+    return status;
+}
+
+NV_STATUS uvm_test_va_block_cpu_chunk_merge(UVM_TEST_VA_BLOCK_CPU_CHUNK_MERGE_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_va_block_context_t *va_block_context = NULL;
+    uvm_va_block_t *va_block;
+    struct mm_struct *mm;
+    uvm_gpu_t *gpu;
+    NV_STATUS status;
+
+    if (!(uvm_cpu_chunk_get_allocation_sizes() & UVM_CHUNK_SIZE_2M))
+        return NV_OK;
+
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto out;
+    }
+
+    status = uvm_va_block_find_create_managed(va_space, params->lookup_address, &va_block);
+    if (status != NV_OK)
+        goto out;
+
+    if (uvm_va_block_size(va_block) != UVM_CHUNK_SIZE_2M) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    va_block_context = uvm_va_block_context_alloc(mm);
+    if (!va_block_context) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    status = test_cpu_chunk_merge(va_block, va_block_context, gpu);
+
+out:
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+    uvm_va_block_context_free(va_block_context);
+
+    return status;
+}
+
 void uvm_va_block_mark_cpu_dirty(uvm_va_block_t *va_block)
 {
     block_mark_region_cpu_dirty(va_block, uvm_va_block_region_from_block(va_block));
@@ -410,6 +410,13 @@ struct uvm_va_block_struct
         // pre_populate_gpu_pde1 in uvm_va_block.c for more information.
         NvU8 ever_mapped        : 1;
 
+        // Whether the block became fully resident on a GPU while holding CPU
+        // chunks smaller than 2M. The chunks are merged the next time the block
+        // is migrated to the CPU, once the copies that read from them have
+        // completed. See block_merge_cpu_chunks_to_2m_if_unused in
+        // uvm_va_block.c.
+        NvU8 merge_pending      : 1;
+
         // We can get "unexpected" faults if multiple CPU threads fault on the
         // same address simultaneously and race to create the mapping. Since
         // our CPU fault handler always unmaps to handle the case where the
@@ -588,6 +595,11 @@ struct uvm_va_block_wrapper_struct
         // Force the next split on this block to fail.
         // Set by error injection ioctl for testing purposes only.
         bool inject_split_error;
+
+        // Merge the CPU chunks of this block regardless of the
+        // uvm_cpu_chunk_merge_gpu_resident module parameter. Used for testing
+        // only.
+        bool force_cpu_chunk_merge;
     } test;
 };
 
@@ -1527,6 +1539,9 @@ uvm_gpu_chunk_t *uvm_va_block_lookup_gpu_chunk(uvm_va_block_t *va_block, uvm_gpu
 // service->block_context->hmm.vma must be valid. See the comments for
 // uvm_hmm_check_context_vma_is_valid() in uvm_hmm.h.
 //
+// cause is reported in the migration events. It is
+// UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE for user-requested migrations.
+//
 // LOCKING: The caller must hold the va_block lock. If
 //          service_context->va_block_context->mm != NULL,
 //          service_context->va_block_context->mm->mmap_lock must be held in at
@@ -1537,6 +1552,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                       uvm_va_block_region_t region,
                                       uvm_processor_id_t dest_id,
                                       uvm_migrate_mode_t mode,
+                                      uvm_make_resident_cause_t cause,
                                       uvm_tracker_t *out_tracker);
 
 // Write block's data from a CPU buffer
@@ -1593,6 +1609,7 @@ NV_STATUS uvm_test_change_pte_mapping(UVM_TEST_CHANGE_PTE_MAPPING_PARAMS *params
 NV_STATUS uvm_test_va_block_info(UVM_TEST_VA_BLOCK_INFO_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_va_residency_info(UVM_TEST_VA_RESIDENCY_INFO_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_va_block_discard_status(UVM_TEST_VA_BLOCK_DISCARD_STATUS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_va_block_cpu_chunk_merge(UVM_TEST_VA_BLOCK_CPU_CHUNK_MERGE_PARAMS *params, struct file *filp);
 
 // Compute the offset in system pages of addr from the start of va_block.
 static uvm_page_index_t uvm_va_block_cpu_page_index(uvm_va_block_t *va_block, NvU64 addr)
@@ -1615,6 +1632,13 @@ size_t uvm_va_block_gpu_chunk_index_range(NvU64 start,
 // If there are any resident CPU pages in the block, mark them as dirty
 void uvm_va_block_mark_cpu_dirty(uvm_va_block_t *va_block);
 
+// If the block is resident on the given GPU, hint the GPU PMM that the memory
+// backing the block is being accessed heavily. See
+// uvm_pmm_gpu_mark_root_chunk_hot().
+//
+// LOCKING: The caller must hold the va_block lock.
+void uvm_va_block_mark_gpu_memory_hot(uvm_va_block_t *va_block, uvm_gpu_t *gpu);
+
 // Sets the internal state required to handle fault cancellation
 //
 // This function may require allocating page tables to split big pages into 4K
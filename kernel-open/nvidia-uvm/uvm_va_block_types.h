@@ -124,6 +124,8 @@ typedef enum
     UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
     UVM_MAKE_RESIDENT_CAUSE_API_SET_RANGE_GROUP,
     UVM_MAKE_RESIDENT_CAUSE_API_HINT,
+    UVM_MAKE_RESIDENT_CAUSE_TIERING_PROMOTION,
+    UVM_MAKE_RESIDENT_CAUSE_TIERING_DEMOTION,
 
     UVM_MAKE_RESIDENT_CAUSE_MAX
 } uvm_make_resident_cause_t;
@@ -335,6 +337,11 @@ typedef struct
 
         // Used for migrate_vma_*() to migrate pages to/from GPU/CPU.
         struct migrate_vma migrate_vma_args;
+
+        // Source pages whose release is deferred until the copies reading
+        // them complete. Only set by uvm_hmm_migrate_ranges(), NULL
+        // otherwise.
+        uvm_hmm_migrate_batch_t *migrate_batch;
 #endif
     } hmm;
 
@@ -37,6 +37,21 @@
 #include "uvm_perf_thrashing.h"
 #include "nv_uvm_interface.h"
 
+// Build the page directories of new managed VA ranges on each GPU VA space
+// eagerly, instead of on the first fault or map of each VA block. Only ranges
+// of at least uvm_perf_va_range_prebuild_pdes_min_blocks VA blocks are
+// considered.
+static int uvm_perf_va_range_prebuild_pdes = 0;
+module_param(uvm_perf_va_range_prebuild_pdes, int, S_IRUGO);
+
+#define UVM_PERF_VA_RANGE_PREBUILD_PDES_MIN_BLOCKS_DEFAULT 16
+static unsigned uvm_perf_va_range_prebuild_pdes_min_blocks = UVM_PERF_VA_RANGE_PREBUILD_PDES_MIN_BLOCKS_DEFAULT;
+module_param(uvm_perf_va_range_prebuild_pdes_min_blocks, uint, S_IRUGO);
+
+// Global post-processed values of the module parameters
+static bool g_uvm_perf_va_range_prebuild_pdes __read_mostly;
+static NvU64 g_uvm_perf_va_range_prebuild_pdes_min_size __read_mostly;
+
 static struct kmem_cache *g_uvm_va_range_managed_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_range_external_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_range_channel_cache __read_mostly;
@@ -74,6 +89,17 @@ NV_STATUS uvm_va_range_init(void)
     if (!g_uvm_vma_wrapper_cache)
         return NV_ERR_NO_MEMORY;
 
+    g_uvm_perf_va_range_prebuild_pdes = uvm_perf_va_range_prebuild_pdes != 0;
+
+    if (uvm_perf_va_range_prebuild_pdes_min_blocks == 0) {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_va_range_prebuild_pdes_min_blocks. Using %u instead\n",
+                       uvm_perf_va_range_prebuild_pdes_min_blocks,
+                       UVM_PERF_VA_RANGE_PREBUILD_PDES_MIN_BLOCKS_DEFAULT);
+        uvm_perf_va_range_prebuild_pdes_min_blocks = UVM_PERF_VA_RANGE_PREBUILD_PDES_MIN_BLOCKS_DEFAULT;
+    }
+
+    g_uvm_perf_va_range_prebuild_pdes_min_size = (NvU64)uvm_perf_va_range_prebuild_pdes_min_blocks * UVM_VA_BLOCK_SIZE;
+
     status = uvm_va_range_device_p2p_init();
     if (status != NV_OK)
         return status;
@@ -206,6 +232,83 @@ static uvm_va_range_managed_t *uvm_va_range_alloc_managed(uvm_va_space_t *va_spa
     return managed_range;
 }
 
+// Eagerly populate the page directories of the given range in the given GPU VA
+// space, see uvm_perf_va_range_prebuild_pdes. The directories are built with
+// the layout used by VA blocks for their largest PTE size: 2M entries if the
+// GPU supports them, big page tables otherwise. Directories for all the
+// entries are written in a pipeline of pushes with a single wait at the end.
+//
+// This is only an optimization, so errors are ignored: VA blocks allocate any
+// missing directories on demand.
+static void va_range_prebuild_pdes(uvm_va_range_managed_t *managed_range, uvm_gpu_va_space_t *gpu_va_space)
+{
+    uvm_page_tree_t *page_tables = &gpu_va_space->page_tables;
+    uvm_gpu_t *gpu = gpu_va_space->gpu;
+    NvU32 gpu_index = uvm_id_gpu_index(gpu->id);
+    NvU64 page_size;
+    NvU64 start;
+    NvU64 end;
+
+    uvm_assert_rwsem_locked_write(&managed_range->va_range.va_space->lock);
+
+    if (!g_uvm_perf_va_range_prebuild_pdes)
+        return;
+
+    if (page_tables->hal->page_sizes() & UVM_PAGE_SIZE_2M)
+        page_size = UVM_PAGE_SIZE_2M;
+    else
+        page_size = page_tables->big_page_size;
+
+    start = UVM_ALIGN_UP(managed_range->va_range.node.start, page_size);
+    end = UVM_ALIGN_DOWN(managed_range->va_range.node.end + 1, page_size);
+    if (end <= start || end - start < g_uvm_perf_va_range_prebuild_pdes_min_size)
+        return;
+
+    if (!uvm_gpu_can_address(gpu, start, end - start))
+        return;
+
+    if (!managed_range->pde_skeletons) {
+        managed_range->pde_skeletons = uvm_kvmalloc_zero(sizeof(*managed_range->pde_skeletons) * UVM_ID_MAX_GPUS);
+        if (!managed_range->pde_skeletons)
+            return;
+    }
+
+    if (managed_range->pde_skeletons[gpu_index])
+        return;
+
+    (void)uvm_page_table_range_vec_create(page_tables,
+                                          start,
+                                          end - start,
+                                          page_size,
+                                          UVM_PMM_ALLOC_FLAGS_NONE,
+                                          &managed_range->pde_skeletons[gpu_index]);
+}
+
+static void va_range_drop_pdes(uvm_va_range_managed_t *managed_range, uvm_gpu_t *gpu)
+{
+    NvU32 gpu_index = uvm_id_gpu_index(gpu->id);
+
+    if (!managed_range->pde_skeletons)
+        return;
+
+    uvm_page_table_range_vec_destroy(managed_range->pde_skeletons[gpu_index]);
+    managed_range->pde_skeletons[gpu_index] = NULL;
+}
+
+static void va_range_drop_all_pdes(uvm_va_range_managed_t *managed_range)
+{
+    NvU32 i;
+
+    if (!managed_range->pde_skeletons)
+        return;
+
+    for (i = 0; i < UVM_ID_MAX_GPUS; i++)
+        uvm_page_table_range_vec_destroy(managed_range->pde_skeletons[i]);
+
+    uvm_kvfree(managed_range->pde_skeletons);
+    managed_range->pde_skeletons = NULL;
+}
+
 NV_STATUS uvm_va_range_create_mmap(uvm_va_space_t *va_space,
                                    struct mm_struct *mm,
                                    uvm_vma_wrapper_t *vma_wrapper,
@@ -231,6 +334,13 @@ NV_STATUS uvm_va_range_create_mmap(uvm_va_space_t *va_space,
     if (status != NV_OK)
         goto error;
 
+    if (g_uvm_perf_va_range_prebuild_pdes) {
+        uvm_gpu_va_space_t *gpu_va_space;
+
+        for_each_gpu_va_space(gpu_va_space, va_space)
+            va_range_prebuild_pdes(managed_range, gpu_va_space);
+    }
+
     if (out_managed_range)
         *out_managed_range = managed_range;
 
@@ -488,6 +598,8 @@ static void uvm_va_range_destroy_managed(uvm_va_range_managed_t *managed_range)
         uvm_kvfree(managed_range->blocks);
     }
 
+    va_range_drop_all_pdes(managed_range);
+
     event_data.range_destroy.range = &managed_range->va_range;
     uvm_perf_event_notify(&managed_range->va_range.va_space->perf_events, UVM_PERF_EVENT_RANGE_DESTROY, &event_data);
 
@@ -785,6 +897,8 @@ static NV_STATUS va_range_add_gpu_va_space_managed(uvm_va_range_managed_t *manag
         managed_range->policy.read_duplication == UVM_READ_DUPLICATION_ENABLED &&
         (uvm_va_space_can_read_duplicate(va_space, NULL) != uvm_va_space_can_read_duplicate(va_space, gpu));
 
+    va_range_prebuild_pdes(managed_range, gpu_va_space);
+
     // Combine conditions to perform a single VA block traversal
     if (gpu_va_space->ats.enabled || should_add_remote_mappings || should_disable_read_duplication) {
         uvm_va_block_t *va_block;
@@ -881,6 +995,8 @@ static void va_range_remove_gpu_va_space_managed(uvm_va_range_managed_t *managed
         if (should_enable_read_duplicate)
             uvm_va_block_set_read_duplication(va_block, va_block_context);
     }
+
+    va_range_drop_pdes(managed_range, gpu_va_space->gpu);
 }
 
 static void va_range_remove_gpu_va_space_external(uvm_va_range_external_t *external_range,
@@ -1373,6 +1489,11 @@ NV_STATUS uvm_va_range_split(uvm_va_range_managed_t *existing_managed_range,
         return status;
     }
 
+    // The eagerly-built page directories are not carried over to the split
+    // ranges. Dropping them only frees the directories that no VA block is
+    // using.
+    va_range_drop_all_pdes(existing_managed_range);
+
     // Finally, update the VA range tree
     uvm_range_tree_split(&va_space->va_range_tree, &existing_managed_range->va_range.node, &new->va_range.node);
 
@@ -286,6 +286,14 @@ struct uvm_va_range_managed_struct
     // (testing purposes only).
     bool inject_split_error;
 
+    // Array of UVM_ID_MAX_GPUS page table ranges, indexed by GPU index, that
+    // cover the range on each GPU VA space. They keep the page directories of
+    // the range populated, so the first mapping of each VA block only needs to
+    // allocate its lowest levels. This is NULL unless the page directories
+    // were built eagerly, see uvm_perf_va_range_prebuild_pdes, and the ranges
+    // are dropped when the VA range is split.
+    uvm_page_table_range_vec_t **pde_skeletons;
+
     uvm_perf_module_data_desc_t perf_modules_data[UVM_PERF_MODULE_TYPE_COUNT];
 };
 
@@ -43,6 +43,14 @@
 #include "nv-kthread-q.h"
 #include <linux/mmzone.h>
 
+// Number of GPUs a GPU forwards read-duplicated pages to when the pages are
+// resident on several processors. 0 disables broadcast planning and the
+// closest resident processor is always used as the copy source.
+static unsigned uvm_read_duplication_broadcast_fanout __read_mostly = 2;
+module_param(uvm_read_duplication_broadcast_fanout, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_read_duplication_broadcast_fanout,
+                 "Number of GPUs each GPU forwards read-duplicated pages to. 0 disables broadcast planning.");
+
 static bool processor_mask_array_test(const uvm_processor_mask_t *mask,
                                       uvm_processor_id_t mask_id,
                                       uvm_processor_id_t id)
@@ -192,6 +200,7 @@ NV_STATUS uvm_va_space_create(struct address_space *mapping, uvm_va_space_t **va
     }
 
     uvm_init_rwsem(&va_space->lock, UVM_LOCK_ORDER_VA_SPACE);
+    uvm_range_lock_init(&va_space->range_lock, UVM_LOCK_ORDER_VA_SPACE_RANGE);
     uvm_mutex_init(&va_space->closest_processors.mask_mutex, UVM_LOCK_ORDER_LEAF);
     uvm_mutex_init(&va_space->serialize_writers_lock, UVM_LOCK_ORDER_VA_SPACE_SERIALIZE_WRITERS);
     uvm_mutex_init(&va_space->read_acquire_write_release_lock,
@@ -234,6 +243,7 @@ NV_STATUS uvm_va_space_create(struct address_space *mapping, uvm_va_space_t **va
 
     va_space->mapping = mapping;
     va_space->test.page_prefetch_enabled = true;
+    va_space->pmm_eviction_policy = uvm_pmm_eviction_default_policy();
 
     init_tools_data(va_space);
 
@@ -316,6 +326,94 @@ static void va_space_parent_gpu_unregister(uvm_va_space_t *va_space, uvm_parent_
     node_info->routing_table[uvm_parent_id_gpu_index(parent->id)] = NULL;
 }
 
+// Rebuild the read duplication broadcast plans after a change in the
+// registered processors or in the copy topology between them.
+static void va_space_update_broadcast_plans(uvm_va_space_t *va_space)
+{
+    uvm_processor_id_t *ids = va_space->broadcast.ids;
+    uvm_broadcast_topology_t *topology;
+    uvm_processor_id_t id;
+    NvU32 num_nodes = 0;
+    NvU32 i, j;
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    va_space->broadcast.num_nodes = 0;
+
+    if (uvm_read_duplication_broadcast_fanout == 0)
+        return;
+
+    // The CPU, which has the lowest id, is included in the tree even when it
+    // isn't a copy source since it can still be the cheapest path between GPUs.
+    if (uvm_processor_mask_get_gpu_count(&va_space->registered_gpus) + 1 > UVM_BROADCAST_MAX_NODES)
+        return;
+
+    // The topology is too big for the stack. Broadcast planning stays disabled
+    // until the next rebuild if the allocation fails.
+    topology = uvm_kvmalloc(sizeof(*topology));
+    if (!topology)
+        return;
+
+    ids[num_nodes++] = UVM_ID_CPU;
+    for_each_gpu_id_in_mask(id, &va_space->registered_gpus)
+        ids[num_nodes++] = id;
+
+    topology->num_nodes = num_nodes;
+    for (i = 0; i < num_nodes; i++) {
+        topology->bandwidth[i][i] = 0;
+        for (j = i + 1; j < num_nodes; j++) {
+            topology->bandwidth[i][j] = uvm_processor_copy_bandwidth_gbps(va_space, ids[i], ids[j]);
+            topology->bandwidth[j][i] = topology->bandwidth[i][j];
+        }
+    }
+
+    // The root is usually sysmem and is read by a single GPU which starts the
+    // forwarding.
+    for (i = 0; i < num_nodes; i++)
+        uvm_broadcast_plan(topology, i, 1, uvm_read_duplication_broadcast_fanout, &va_space->broadcast.plans[i]);
+
+    va_space->broadcast.num_nodes = num_nodes;
+
+    uvm_kvfree(topology);
+}
+
+uvm_processor_id_t uvm_va_space_broadcast_source(uvm_va_space_t *va_space,
+                                                 const uvm_processor_mask_t *candidates,
+                                                 uvm_processor_id_t dst_id)
+{
+    const uvm_processor_id_t *ids = va_space->broadcast.ids;
+    NvU32 num_nodes = va_space->broadcast.num_nodes;
+    const uvm_broadcast_plan_t *plan;
+    NvU32 root = num_nodes;
+    NvU32 dst = num_nodes;
+    NvU32 node;
+    NvU32 i;
+
+    UVM_ASSERT(UVM_ID_IS_GPU(dst_id));
+
+    if (num_nodes == 0 || uvm_processor_mask_get_count(candidates) < 2)
+        return UVM_ID_INVALID;
+
+    // Nodes are sorted by processor id, so the root is the lowest candidate
+    for (i = 0; i < num_nodes && (root == num_nodes || dst == num_nodes); i++) {
+        if (root == num_nodes && uvm_processor_mask_test(candidates, ids[i]))
+            root = i;
+        if (uvm_id_equal(ids[i], dst_id))
+            dst = i;
+    }
+
+    if (root == num_nodes || dst == num_nodes)
+        return UVM_ID_INVALID;
+
+    plan = &va_space->broadcast.plans[root];
+    for (node = plan->parent[dst]; node != UVM_BROADCAST_NO_PARENT; node = plan->parent[node]) {
+        if (uvm_processor_mask_test(candidates, ids[node]))
+            return ids[node];
+    }
+
+    return UVM_ID_INVALID;
+}
+
 // This function does *not* release the GPU, nor the GPU's PCIE peer pairings.
 // Those are returned so the caller can do it after dropping the VA space lock.
 static void unregister_gpu(uvm_va_space_t *va_space,
@@ -401,6 +499,8 @@ static void unregister_gpu(uvm_va_space_t *va_space,
 
     uvm_processor_mask_clear(&va_space->registered_gpus, gpu->id);
 
+    va_space_update_broadcast_plans(va_space);
+
     if (gpu->parent->is_integrated_gpu)
         va_space->num_integrated_gpus--;
 
@@ -626,6 +726,8 @@ void uvm_va_space_destroy(uvm_va_space_t *va_space)
 
     uvm_mutex_unlock(&g_uvm_global.global_lock);
 
+    uvm_range_lock_deinit(&va_space->range_lock);
+
     uvm_kvfree(va_space->mapping);
     uvm_kvfree(va_space);
 }
@@ -955,6 +1057,8 @@ NV_STATUS uvm_va_space_register_gpu(uvm_va_space_t *va_space,
     else
         uvm_va_space_ats_set(va_space, UVM_ATS_VA_SPACE_ATS_UNSUPPORTED);
 
+    va_space_update_broadcast_plans(va_space);
+
     goto done;
 
 cleanup:
@@ -1173,6 +1277,8 @@ static void disable_peers(uvm_va_space_t *va_space,
     __clear_bit(pair_index, va_space->enabled_peers);
 
     va_space_check_processors_masks(va_space);
+
+    va_space_update_broadcast_plans(va_space);
 }
 
 static void enable_egm_peers(uvm_va_space_t *va_space, uvm_gpu_t *gpu0, uvm_gpu_t *gpu1)
@@ -1271,6 +1377,9 @@ static NV_STATUS enable_peers(uvm_va_space_t *va_space, uvm_gpu_t *gpu0, uvm_gpu
         // but uvm_va_range_enable_peer doesn't do anything for them.
         UVM_ASSERT(list_empty(&deferred_free_list));
     }
+    else {
+        va_space_update_broadcast_plans(va_space);
+    }
 
     return status;
 }
@@ -2418,26 +2527,21 @@ NV_STATUS uvm_test_va_space_allow_movable_allocations(UVM_TEST_VA_SPACE_ALLOW_MO
 static LIST_HEAD(g_cpu_service_block_context_list);
 
 static uvm_spinlock_t g_cpu_service_block_context_list_lock;
-static struct kmem_cache *g_uvm_va_block_service_context_cache __read_mostly;
+static uvm_kvmalloc_cache_t g_uvm_va_block_service_context_cache __read_mostly;
 
 static void uvm_va_space_destroy_service_context_cache(void)
 {
-    kmem_cache_destroy_safe(&g_uvm_va_block_service_context_cache);
+    uvm_kvmalloc_cache_deinit(&g_uvm_va_block_service_context_cache);
 }
 
 static NV_STATUS uvm_va_space_alloc_service_context_cache(void)
 {
-    g_uvm_va_block_service_context_cache = NV_KMEM_CACHE_CREATE("uvm_service_block_context_t",
-                                                                uvm_service_block_context_t);
-    if (!g_uvm_va_block_service_context_cache)
-        return NV_ERR_NO_MEMORY;
-
-    return NV_OK;
+    return UVM_KVMALLOC_CACHE_INIT(&g_uvm_va_block_service_context_cache, uvm_service_block_context_t);
 }
 
 uvm_service_block_context_t *uvm_service_block_context_alloc(struct mm_struct *mm)
 {
-    uvm_service_block_context_t *service_context = kmem_cache_alloc(g_uvm_va_block_service_context_cache, NV_UVM_GFP_FLAGS);
+    uvm_service_block_context_t *service_context = uvm_kvmalloc_cache_alloc(&g_uvm_va_block_service_context_cache);
 
     if (!service_context)
         return NULL;
@@ -2447,7 +2551,7 @@ uvm_service_block_context_t *uvm_service_block_context_alloc(struct mm_struct *m
 
     service_context->block_context = uvm_va_block_context_alloc(mm);
     if (!service_context->block_context) {
-        uvm_kvfree(service_context);
+        uvm_kvmalloc_cache_free(&g_uvm_va_block_service_context_cache, service_context);
         service_context = NULL;
     }
 
@@ -2460,7 +2564,7 @@ void uvm_service_block_context_free(uvm_service_block_context_t *service_context
         return;
 
     uvm_va_block_context_free(service_context->block_context);
-    kmem_cache_free(g_uvm_va_block_service_context_cache, service_context);
+    uvm_kvmalloc_cache_free(&g_uvm_va_block_service_context_cache, service_context);
 }
 
 NV_STATUS uvm_service_block_context_init(void)
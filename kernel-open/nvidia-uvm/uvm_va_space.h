@@ -219,6 +219,11 @@ struct uvm_va_space_struct
     // Tree of uvm_va_range_t's
     uvm_range_tree_t va_range_tree;
 
+    // Address range lock taken under the VA space lock in read mode by
+    // operations which update the state of existing VA ranges without
+    // changing va_range_tree. See UVM_LOCK_ORDER_VA_SPACE_RANGE in uvm_lock.h.
+    uvm_range_lock_t range_lock;
+
     // Kernel mapping structure passed to unmap_mapping range to unmap CPU PTEs
     // in this process.
     struct address_space *mapping;
@@ -287,6 +292,20 @@ struct uvm_va_space_struct
     // for atomics in HW. This is a subset of accessible_from.
     uvm_processor_mask_t has_native_atomics[UVM_ID_MAX_PROCESSORS];
 
+    // Read duplication broadcast trees over the copy topology of the CPU and
+    // the registered GPUs, with one plan per possible root. Node i of the
+    // plans is processor ids[i], and nodes are sorted by processor id. They are
+    // rebuilt whenever a GPU is registered or unregistered, or peer access is
+    // enabled or disabled, so that uvm_va_space_broadcast_source() only needs
+    // the VA space lock in read mode. num_nodes is 0 if broadcast planning is
+    // disabled.
+    struct
+    {
+        NvU32 num_nodes;
+        uvm_processor_id_t ids[UVM_BROADCAST_MAX_NODES];
+        uvm_broadcast_plan_t plans[UVM_BROADCAST_MAX_NODES];
+    } broadcast;
+
     // Mask of gpu_va_spaces registered with the va space
     // indexed by gpu->id
     uvm_processor_mask_t registered_gpu_va_spaces;
@@ -352,6 +371,10 @@ struct uvm_va_space_struct
     // Array of modules that are loaded in the va_space, indexed by module type
     uvm_perf_module_t *perf_modules[UVM_PERF_MODULE_TYPE_COUNT];
 
+    // Policy used to pick the GPU root chunks of this VA space for eviction.
+    // See uvm_pmm_gpu_eviction.h. Protected by lock.
+    uvm_pmm_eviction_policy_t pmm_eviction_policy;
+
     // Lists of counters listening for events on this VA space
     // Protected by lock
     struct
@@ -781,6 +804,24 @@ uvm_processor_id_t uvm_processor_mask_find_closest_id(uvm_va_space_t *va_space,
          UVM_ID_IS_VALID(id);                                           \
          uvm_processor_mask_clear(mask, id), id = uvm_processor_mask_find_closest_id(va_space, mask, src))
 
+// Select the source of a read duplication copy to the GPU dst_id among the
+// processors in candidates, which already have a copy of the pages.
+//
+// Picking the closest candidate makes every GPU copy from the same processor
+// when pages are read-duplicated to many GPUs. Instead, the broadcast tree
+// rooted at the lowest candidate id is looked up in the plans precomputed for
+// the VA space, and the closest ancestor of dst_id in the tree which has a copy
+// is returned. Each GPU then forwards the pages to at most
+// uvm_read_duplication_broadcast_fanout GPUs.
+//
+// UVM_ID_INVALID is returned if there is no preference, in which case the
+// closest candidate should be used.
+//
+// LOCKING: The caller must hold the VA space lock.
+uvm_processor_id_t uvm_va_space_broadcast_source(uvm_va_space_t *va_space,
+                                                 const uvm_processor_mask_t *candidates,
+                                                 uvm_processor_id_t dst_id);
+
 static bool uvm_va_space_ats_supported(const uvm_va_space_t *va_space)
 {
     return atomic_read(&va_space->ats.state) == UVM_ATS_VA_SPACE_ATS_SUPPORTED;
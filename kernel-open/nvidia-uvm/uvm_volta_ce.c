@@ -141,6 +141,8 @@ void uvm_hal_volta_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu_a
     if (uvm_gpu_address_is_peer(gpu, dst) && uvm_gpu_get_injected_nvlink_error(gpu) != NV_OK)
         size = 0;
 
+    push->copy_bytes += size;
+
     gpu->parent->ce_hal->memcopy_patch_src(push, &src);
 
     launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
@@ -180,6 +182,67 @@ void uvm_hal_volta_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu_a
     } while (size > 0);
 }
 
+void uvm_hal_volta_ce_memcopy_strided(uvm_push_t *push,
+                                      uvm_gpu_address_t dst,
+                                      NvU32 dst_pitch,
+                                      uvm_gpu_address_t src,
+                                      NvU32 src_pitch,
+                                      NvU32 line_size,
+                                      NvU32 line_count)
+{
+    uvm_gpu_t *gpu = uvm_push_get_gpu(push);
+
+    NvU32 pipelined_value;
+    NvU32 launch_dma_src_dst_type;
+    NvU32 launch_dma_plc_mode;
+    NvU32 copy_type_value = gpu->parent->ce_hal->memcopy_copy_type(dst, src);
+
+    UVM_ASSERT(line_count > 0);
+    UVM_ASSERT(line_size <= dst_pitch);
+    UVM_ASSERT(line_size <= src_pitch);
+
+    UVM_ASSERT_MSG(gpu->parent->ce_hal->memcopy_is_valid(push, dst, src),
+                   "Memcopy validation failed in channel %s, GPU %s.\n",
+                   push->channel->name,
+                   uvm_gpu_name(gpu));
+
+    // See uvm_hal_volta_ce_memcopy
+    if (uvm_gpu_address_is_peer(gpu, dst) && uvm_gpu_get_injected_nvlink_error(gpu) != NV_OK) {
+        line_size = 0;
+        line_count = 1;
+    }
+
+    push->copy_bytes += (NvU64)line_size * line_count;
+
+    gpu->parent->ce_hal->memcopy_patch_src(push, &src);
+
+    launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
+    launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
+
+    if (uvm_push_get_and_reset_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED))
+        pipelined_value = HWCONST(C3B5, LAUNCH_DMA, DATA_TRANSFER_TYPE, PIPELINED);
+    else
+        pipelined_value = HWCONST(C3B5, LAUNCH_DMA, DATA_TRANSFER_TYPE, NON_PIPELINED);
+
+    gpu->parent->ce_hal->offset_in_out(push, src.address, dst.address);
+
+    NV_PUSH_4U(C3B5, PITCH_IN, src_pitch,
+                     PITCH_OUT, dst_pitch,
+                     LINE_LENGTH_IN, line_size,
+                     LINE_COUNT, line_count);
+
+    NV_PUSH_1U(C3B5, LAUNCH_DMA,
+       HWCONST(C3B5, LAUNCH_DMA, SRC_MEMORY_LAYOUT, PITCH) |
+       HWCONST(C3B5, LAUNCH_DMA, DST_MEMORY_LAYOUT, PITCH) |
+       HWCONST(C3B5, LAUNCH_DMA, MULTI_LINE_ENABLE, TRUE) |
+       HWCONST(C3B5, LAUNCH_DMA, REMAP_ENABLE, FALSE) |
+       volta_get_flush_value(push) |
+       launch_dma_src_dst_type |
+       launch_dma_plc_mode |
+       copy_type_value |
+       pipelined_value);
+}
+
 static NvU32 ce_aperture(uvm_aperture_t aperture)
 {
     BUILD_BUG_ON(HWCONST(C3B5, SET_SRC_PHYS_MODE, TARGET, LOCAL_FB) !=
@@ -221,6 +284,8 @@ static void memset_common(uvm_push_t *push, uvm_gpu_address_t dst, size_t size,
                    push->channel->name,
                    uvm_gpu_name(gpu));
 
+    push->copy_bytes += size * memset_element_size;
+
     launch_dma_dst_type = volta_memset_push_phys_mode(push, dst);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
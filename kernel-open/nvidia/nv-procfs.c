@@ -1276,6 +1276,109 @@ static const nv_proc_ops_t nv_procfs_offline_pages_fops = {
     .NV_PROC_OPS_RELEASE = nv_procfs_close_offline_pages,
 };
 
+static void
+nv_procfs_print_ratio(
+    struct seq_file *s,
+    const char *name,
+    NvU64 hits,
+    NvU64 misses
+)
+{
+    NvU64 total = hits + misses;
+    NvU32 basis_points = (total != 0) ? (NvU32)div64_u64(hits * 10000, total) : 0;
+
+    seq_printf(s, "%-20s%u.%02u%%\n", name, basis_points / 100, basis_points % 100);
+}
+
+static int
+nv_procfs_read_numa_magazines(
+    struct seq_file *s,
+    void *v
+)
+{
+    nv_state_t *nv = s->private;
+    nv_linux_state_t *nvl = NV_GET_NVL_FROM_NV_STATE(nv);
+    nvidia_stack_t *sp = NULL;
+    nv_numa_magazine_stats_t stats = { 0 };
+    NV_STATUS rm_status = NV_ERR_NOT_READY;
+
+    if (nv_kmem_cache_alloc_stack(&sp) != 0)
+    {
+        return 0;
+    }
+
+    down(&nvl->ldata_lock);
+    if (nv->flags & NV_FLAG_OPEN)
+    {
+        rm_status = rm_get_gpu_numa_magazine_stats(sp, nv, &stats);
+    }
+    up(&nvl->ldata_lock);
+
+    nv_kmem_cache_free_stack(sp);
+
+    if (rm_status != NV_OK)
+    {
+        seq_printf(s, "Not available\n");
+        return 0;
+    }
+
+    nv_procfs_print_ratio(s, "Alloc hit ratio:", stats.alloc_hits, stats.alloc_misses);
+    seq_printf(s, "Alloc hits:         %llu\n", stats.alloc_hits);
+    seq_printf(s, "Alloc misses:       %llu\n", stats.alloc_misses);
+    nv_procfs_print_ratio(s, "Free hit ratio:", stats.free_hits, stats.free_misses);
+    seq_printf(s, "Free hits:          %llu\n", stats.free_hits);
+    seq_printf(s, "Free misses:        %llu\n", stats.free_misses);
+    seq_printf(s, "Refills:            %llu\n", stats.refills);
+    seq_printf(s, "Flushes:            %llu\n", stats.flushes);
+    seq_printf(s, "Drains:             %llu\n", stats.drains);
+    seq_printf(s, "Drained pages:      %llu\n", stats.drained_pages);
+    seq_printf(s, "Cached 64KB pages:  %llu\n", stats.cached_pages_64k);
+    seq_printf(s, "Cached 2MB pages:   %llu\n", stats.cached_pages_2m);
+
+    return 0;
+}
+
+NV_DEFINE_SINGLE_NVRM_PROCFS_FILE(numa_magazines);
+
+static int
+nv_procfs_read_scrub_stats(
+    struct seq_file *s,
+    void *v
+)
+{
+    nv_state_t *nv = s->private;
+    nv_linux_state_t *nvl = NV_GET_NVL_FROM_NV_STATE(nv);
+    nvidia_stack_t *sp = NULL;
+    nv_scrub_stats_t stats = { 0 };
+    NV_STATUS rm_status = NV_ERR_NOT_READY;
+
+    if (nv_kmem_cache_alloc_stack(&sp) != 0)
+    {
+        return 0;
+    }
+
+    down(&nvl->ldata_lock);
+    if (nv->flags & NV_FLAG_OPEN)
+    {
+        rm_status = rm_get_gpu_scrub_stats(sp, nv, &stats);
+    }
+    up(&nvl->ldata_lock);
+
+    nv_kmem_cache_free_stack(sp);
+
+    if (rm_status != NV_OK)
+    {
+        seq_printf(s, "Not available\n");
+        return 0;
+    }
+
+    seq_printf(s, "Alloc stalls:       %llu\n", stats.alloc_stalls);
+
+    return 0;
+}
+
+NV_DEFINE_SINGLE_NVRM_PROCFS_FILE(scrub_stats);
+
 static int
 nv_procfs_read_text_file(
     struct seq_file *s,
@@ -1415,6 +1518,10 @@ int nv_procfs_add_gpu(nv_linux_state_t *nvl)
     if (!entry)
         goto failed;
 
+    entry = NV_CREATE_PROC_FILE("scrub_stats", proc_nvidia_gpu, scrub_stats, nv);
+    if (!entry)
+        goto failed;
+
     if (IS_EXERCISE_ERROR_FORWARDING_ENABLED())
     {
         entry = NV_CREATE_PROC_FILE("exercise_error_forwarding", proc_nvidia_gpu,
@@ -1441,6 +1548,11 @@ int nv_procfs_add_gpu(nv_linux_state_t *nvl)
                                     nv);
         if (!entry)
             goto failed;
+
+        entry = NV_CREATE_PROC_FILE("numa_magazines", proc_nvidia_gpu, numa_magazines,
+                                    nv);
+        if (!entry)
+            goto failed;
     }
 
     nvl->proc_dir = proc_nvidia_gpu;
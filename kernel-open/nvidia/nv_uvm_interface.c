@@ -473,6 +473,25 @@ NV_STATUS nvUvmInterfacePmaAllocPages(void *pPma,
 }
 EXPORT_SYMBOL(nvUvmInterfacePmaAllocPages);
 
+NV_STATUS nvUvmInterfacePmaAllocPagesBatch(void *pPma,
+                                           UvmPmaAllocationRequest *pRequests,
+                                           NvLength requestCount)
+{
+    nvidia_stack_t *sp = NULL;
+    NV_STATUS status;
+
+    if (nv_kmem_cache_alloc_stack(&sp) != 0)
+    {
+        return NV_ERR_NO_MEMORY;
+    }
+
+    status = rm_gpu_ops_pma_alloc_pages_batch(sp, pPma, (nvgpuPmaAllocationRequest_t)pRequests, requestCount);
+
+    nv_kmem_cache_free_stack(sp);
+    return status;
+}
+EXPORT_SYMBOL(nvUvmInterfacePmaAllocPagesBatch);
+
 NV_STATUS nvUvmInterfacePmaPinPages(void *pPma,
                                     NvU64 *pPages,
                                     NvLength pageCount,
@@ -521,6 +540,18 @@ void nvUvmInterfacePmaFreePages(void *pPma,
 }
 EXPORT_SYMBOL(nvUvmInterfacePmaFreePages);
 
+void nvUvmInterfacePmaFreePagesBatch(void *pPma,
+                                     UvmPmaFreeRequest *pRequests,
+                                     NvLength requestCount)
+{
+    nvidia_stack_t *sp = nvUvmGetSafeStack();
+
+    rm_gpu_ops_pma_free_pages_batch(sp, pPma, (nvgpuPmaFreeRequest_t)pRequests, requestCount);
+
+    nvUvmFreeSafeStack(sp);
+}
+EXPORT_SYMBOL(nvUvmInterfacePmaFreePagesBatch);
+
 NV_STATUS nvUvmInterfaceMemoryCpuMap(uvmGpuAddressSpaceHandle vaSpace,
            UvmGpuPointer gpuPointer, NvLength length, void **cpuPtr,
            NvU64 pageSize)
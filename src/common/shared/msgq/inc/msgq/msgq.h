@@ -163,6 +163,9 @@ void *msgqTxGetWriteBuffer(msgqHandle handle, unsigned n);
  * This is basically "send" function. It submits buffers that were previously
  * filled with msgqTxGetWriteBuffer(). Obviously it may send "trash", if
  * we send more than we filled.
+ * Only the submitted entries are flushed, and the barrier and notification
+ * are issued once per call, so filling several messages and submitting them
+ * together amortizes that cost over the batch.
  */
 int msgqTxSubmitBuffers(msgqHandle handle, unsigned n);
 
@@ -548,11 +548,27 @@ msgqTxSubmitBuffers(msgqHandle handle, unsigned n)
         return -1;
     }
 
-    // flush queues - TODO: make it more precise possibly
-    if (pQueue->fcnFlush != NULL)
+    //
+    // Flush only the entries being submitted. A batch of several messages
+    // then costs one flush of exactly what was written instead of one flush
+    // of the whole ring per message. The range may wrap, in which case it is
+    // flushed in two pieces.
+    //
+    if ((pQueue->fcnFlush != NULL) && (n != 0))
     {
-        pQueue->fcnFlush(pQueue->pOurEntries,
-                         pQueue->tx.msgCount * pQueue->tx.msgSize);
+        NvU32 tail = pQueue->tx.msgCount - pQueue->tx.writePtr;
+
+        if (n <= tail)
+        {
+            pQueue->fcnFlush(pQueue->pOurEntries + (pQueue->tx.writePtr * pQueue->tx.msgSize),
+                             n * pQueue->tx.msgSize);
+        }
+        else
+        {
+            pQueue->fcnFlush(pQueue->pOurEntries + (pQueue->tx.writePtr * pQueue->tx.msgSize),
+                             tail * pQueue->tx.msgSize);
+            pQueue->fcnFlush(pQueue->pOurEntries, (n - tail) * pQueue->tx.msgSize);
+        }
     }
 
     // write pointer
@@ -653,6 +653,8 @@ typedef struct UvmGpuAccessCntrConfig_tag            nvgpuAccessCntrConfig_t;
 typedef struct UvmGpuInfo_tag                        nvgpuInfo_t;
 typedef struct UvmGpuClientInfo_tag                  nvgpuClientInfo_t;
 typedef struct UvmPmaAllocationOptions_tag          *nvgpuPmaAllocationOptions_t;
+typedef struct UvmPmaAllocationRequest_tag          *nvgpuPmaAllocationRequest_t;
+typedef struct UvmPmaFreeRequest_tag                *nvgpuPmaFreeRequest_t;
 typedef struct UvmPmaStatistics_tag                 *nvgpuPmaStatistics_t;
 typedef struct UvmGpuMemoryInfo_tag                 *nvgpuMemoryInfo_t;
 typedef struct UvmGpuExternalMappingInfo_tag        *nvgpuExternalMappingInfo_t;
@@ -728,6 +730,27 @@ typedef struct
     const char *db_support;
 } nv_power_info_t;
 
+/* Counters of the per-CPU NUMA allocation magazines of a GPU */
+typedef struct
+{
+    NvU64 alloc_hits;
+    NvU64 alloc_misses;
+    NvU64 free_hits;
+    NvU64 free_misses;
+    NvU64 refills;
+    NvU64 flushes;
+    NvU64 drains;
+    NvU64 drained_pages;
+    NvU64 cached_pages_64k;
+    NvU64 cached_pages_2m;
+} nv_numa_magazine_stats_t;
+
+/* Counters of the GPU memory scrubber */
+typedef struct
+{
+    NvU64 alloc_stalls;
+} nv_scrub_stats_t;
+
 typedef enum
 {
     NV_MEMORY_TYPE_SYSTEM,      /* Memory mapped for ROM, SBIOS and physical RAM. */
@@ -1202,6 +1225,8 @@ NvBool     NV_API_CALL rm_is_chipset_io_coherent(nv_stack_t *);
 NvBool     NV_API_CALL rm_init_event_locks(nvidia_stack_t *, nv_state_t *);
 void       NV_API_CALL rm_destroy_event_locks(nvidia_stack_t *, nv_state_t *);
 NV_STATUS  NV_API_CALL rm_get_gpu_numa_info(nvidia_stack_t *, nv_state_t *, nv_ioctl_numa_info_t *);
+NV_STATUS  NV_API_CALL rm_get_gpu_numa_magazine_stats(nvidia_stack_t *, nv_state_t *, nv_numa_magazine_stats_t *);
+NV_STATUS  NV_API_CALL rm_get_gpu_scrub_stats(nvidia_stack_t *, nv_state_t *, nv_scrub_stats_t *);
 NV_STATUS  NV_API_CALL rm_gpu_numa_online(nvidia_stack_t *, nv_state_t *);
 NV_STATUS  NV_API_CALL rm_gpu_numa_offline(nvidia_stack_t *, nv_state_t *);
 NvBool     NV_API_CALL rm_is_device_sequestered(nvidia_stack_t *, nv_state_t *);
@@ -41,6 +41,9 @@
 #include "kernel/gpu/mem_mgr/mem_mgr.h"
 
 #include <gpu/mem_sys/kern_mem_sys.h>
+#include <gpu/mem_mgr/heap.h>
+#include <gpu/mem_mgr/phys_mem_allocator/numa.h>
+#include <gpu/mem_mgr/mem_scrub.h>
 
 #include <diagnostics/journal.h>
 #include <nvrm_registry.h>
@@ -5144,6 +5147,123 @@ finish:
     return status;
 }
 
+NV_STATUS NV_API_CALL rm_get_gpu_numa_magazine_stats(
+    nvidia_stack_t           *sp,
+    nv_state_t               *nv,
+    nv_numa_magazine_stats_t *stats
+)
+{
+    PMA_NUMA_MAGAZINE_STATS magazineStats;
+    THREAD_STATE_NODE threadState;
+    void *fp;
+    NV_STATUS rmStatus;
+
+    NV_ENTER_RM_RUNTIME(sp,fp);
+    threadStateInit(&threadState, THREAD_STATE_FLAGS_NONE);
+
+    // LOCK: acquire API lock.
+    if ((rmStatus = rmapiLockAcquire(RMAPI_LOCK_FLAGS_READ, RM_LOCK_MODULES_MEM)) == NV_OK)
+    {
+        OBJGPU *pGpu = NV_GET_NV_PRIV_PGPU(nv);
+
+        if (pGpu == NULL)
+        {
+            rmStatus = NV_ERR_INVALID_STATE;
+        }
+        else if ((rmStatus = rmDeviceGpuLocksAcquire(pGpu, GPUS_LOCK_FLAGS_NONE, RM_LOCK_MODULES_MEM)) == NV_OK)
+        {
+            MemoryManager *pMemoryManager = GPU_GET_MEMORY_MANAGER(pGpu);
+            Heap *pHeap = GPU_GET_HEAP(pGpu);
+
+            if ((pHeap == NULL) || !memmgrIsPmaInitialized(pMemoryManager))
+            {
+                rmStatus = NV_ERR_NOT_SUPPORTED;
+            }
+            else
+            {
+                pmaNumaGetMagazineStats(pHeap->pPmaObject, &magazineStats);
+
+                stats->alloc_hits = magazineStats.allocHits;
+                stats->alloc_misses = magazineStats.allocMisses;
+                stats->free_hits = magazineStats.freeHits;
+                stats->free_misses = magazineStats.freeMisses;
+                stats->refills = magazineStats.refills;
+                stats->flushes = magazineStats.flushes;
+                stats->drains = magazineStats.drains;
+                stats->drained_pages = magazineStats.drainedPages;
+                stats->cached_pages_64k = magazineStats.cachedPages64KB;
+                stats->cached_pages_2m = magazineStats.cachedPages2MB;
+            }
+
+            rmDeviceGpuLocksRelease(pGpu, GPUS_LOCK_FLAGS_NONE, NULL);
+        }
+
+        // UNLOCK: release api lock
+        rmapiLockRelease();
+    }
+
+    threadStateFree(&threadState, THREAD_STATE_FLAGS_NONE);
+    NV_EXIT_RM_RUNTIME(sp,fp);
+
+    return rmStatus;
+}
+
+NV_STATUS NV_API_CALL rm_get_gpu_scrub_stats(
+    nvidia_stack_t   *sp,
+    nv_state_t       *nv,
+    nv_scrub_stats_t *stats
+)
+{
+    THREAD_STATE_NODE threadState;
+    void *fp;
+    NV_STATUS rmStatus;
+
+    NV_ENTER_RM_RUNTIME(sp,fp);
+    threadStateInit(&threadState, THREAD_STATE_FLAGS_NONE);
+
+    // LOCK: acquire API lock.
+    if ((rmStatus = rmapiLockAcquire(RMAPI_LOCK_FLAGS_READ, RM_LOCK_MODULES_MEM)) == NV_OK)
+    {
+        OBJGPU *pGpu = NV_GET_NV_PRIV_PGPU(nv);
+
+        if (pGpu == NULL)
+        {
+            rmStatus = NV_ERR_INVALID_STATE;
+        }
+        else if ((rmStatus = rmDeviceGpuLocksAcquire(pGpu, GPUS_LOCK_FLAGS_NONE, RM_LOCK_MODULES_MEM)) == NV_OK)
+        {
+            MemoryManager *pMemoryManager = GPU_GET_MEMORY_MANAGER(pGpu);
+            Heap *pHeap = GPU_GET_HEAP(pGpu);
+            OBJMEMSCRUB *pScrubber = NULL;
+
+            // The scrubber is torn down with the GPU lock held
+            if ((pHeap != NULL) && memmgrIsPmaInitialized(pMemoryManager))
+            {
+                pScrubber = pmaGetMemScrub(pHeap->pPmaObject);
+            }
+
+            if (pScrubber == NULL)
+            {
+                rmStatus = NV_ERR_NOT_SUPPORTED;
+            }
+            else
+            {
+                stats->alloc_stalls = scrubGetAllocStalls(pScrubber);
+            }
+
+            rmDeviceGpuLocksRelease(pGpu, GPUS_LOCK_FLAGS_NONE, NULL);
+        }
+
+        // UNLOCK: release api lock
+        rmapiLockRelease();
+    }
+
+    threadStateFree(&threadState, THREAD_STATE_FLAGS_NONE);
+    NV_EXIT_RM_RUNTIME(sp,fp);
+
+    return rmStatus;
+}
+
 NV_STATUS NV_API_CALL rm_gpu_numa_online(
     nvidia_stack_t *sp,
     nv_state_t *nv
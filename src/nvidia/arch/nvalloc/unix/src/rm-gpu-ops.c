@@ -228,6 +228,19 @@ NV_STATUS  NV_API_CALL  rm_gpu_ops_pma_alloc_pages(
     return rmStatus;
 }
 
+NV_STATUS  NV_API_CALL  rm_gpu_ops_pma_alloc_pages_batch(
+    nvidia_stack_t *sp, void *pPma,
+    nvgpuPmaAllocationRequest_t pRequests,
+    NvLength requestCount)
+{
+    NV_STATUS rmStatus;
+    void *fp;
+    NV_ENTER_RM_RUNTIME(sp,fp);
+    rmStatus = nvGpuOpsPmaAllocPagesBatch(pPma, pRequests, requestCount);
+    NV_EXIT_RM_RUNTIME(sp,fp);
+    return rmStatus;
+}
+
 NV_STATUS  NV_API_CALL  rm_gpu_ops_pma_pin_pages(
     nvidia_stack_t *sp, void *pPma,
     NvU64 *pPages, NvLength pageCount, NvU64 pageSize, NvU32 flags)
@@ -321,6 +334,16 @@ NV_STATUS  NV_API_CALL  rm_gpu_ops_pma_free_pages(nvidia_stack_t *sp,
     return NV_OK;
 }
 
+NV_STATUS  NV_API_CALL  rm_gpu_ops_pma_free_pages_batch(nvidia_stack_t *sp,
+    void *pPma, nvgpuPmaFreeRequest_t pRequests, NvLength requestCount)
+{
+    void *fp;
+    NV_ENTER_RM_RUNTIME(sp,fp);
+    nvGpuOpsPmaFreePagesBatch(pPma, pRequests, requestCount);
+    NV_EXIT_RM_RUNTIME(sp,fp);
+    return NV_OK;
+}
+
 NV_STATUS  NV_API_CALL rm_gpu_ops_memory_free(
     nvidia_stack_t *sp, gpuAddressSpaceHandle vaspace, NvU64 gpuOffset)
 {
@@ -39,6 +39,16 @@ NV_STATUS GspMsgQueuesInit(OBJGPU *pGpu, MESSAGE_QUEUE_COLLECTION **ppMQCollecti
 void      GspMsgQueuesCleanup(MESSAGE_QUEUE_COLLECTION **ppMQCollection);
 NV_STATUS GspStatusQueueInit(OBJGPU *pGpu, MESSAGE_QUEUE_INFO **ppMQI);
 NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu);
+NV_STATUS GspMsgQueueQueueCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu);
+NV_STATUS GspMsgQueueSubmitCommands(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu);
+NvU32     GspMsgQueueGetPendingCommands(MESSAGE_QUEUE_INFO *pMQI);
 NV_STATUS GspMsgQueueReceiveStatus(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu);
 
+//
+// Batch the RPCs sent on pRpc, so that they reach the GSP with one queue
+// update and one doorbell when the outermost batch ends. Batches nest.
+//
+void      kgspRpcBatchBegin(OBJGPU *pGpu, struct OBJRPC *pRpc);
+NV_STATUS kgspRpcBatchEnd(OBJGPU *pGpu, struct OBJRPC *pRpc);
+
 #endif // _MESSAGE_QUEUE_H_
@@ -69,6 +69,8 @@ typedef struct _message_queue_info
     NvU32                  txSeqNum;            // Next sequence number for tx.
     NvU32                  rxSeqNum;            // Next sequence number for rx.
     NvU32                  txBufferFull;
+    NvU32                  txPendingElems;      // Elements written to the queue but not yet submitted.
+    NvU32                  txPendingMsgs;       // Messages written to the queue but not yet submitted.
     NvU32                  queueIdx;            // QueueIndex used to identify which task the message is supposed to be sent to.
 } MESSAGE_QUEUE_INFO;
 
@@ -101,6 +101,8 @@ typedef struct OBJMEMSCRUB {
     struct OBJGPU                     *pGpu;
     VGPU_GUEST_PMA_SCRUB_BUFFER_RING   vgpuScrubBuffRing;
     NvBool                             bVgpuScrubberEnabled;
+    // Allocations that had to wait for in-flight scrub work to complete
+    volatile NvU64                     allocStalls;
 } OBJMEMSCRUB;
 
 ct_assert(VGPU_GUEST_PMA_MAX_SCRUB_ITEMS == MAX_SCRUB_ITEMS);
@@ -198,4 +200,12 @@ NV_STATUS scrubWaitPages(OBJMEMSCRUB *pScrubber, NvU64 chunkSize, NvU64* pages,
  */
 NV_STATUS scrubCheckAndWaitForSize (OBJMEMSCRUB *pScrubber, NvU64 numPages,
                                     NvU64 pageSize, PSCRUB_NODE *ppList, NvU64 *pSize);
+
+/**
+ *  Returns the number of times scrubCheckAndWaitForSize had to wait for
+ *  pending scrub work before an allocation could be satisfied.
+ *
+ * @param[in]  pScrubber OBJMEMSCRUB pointer
+ */
+NvU64 scrubGetAllocStalls(OBJMEMSCRUB *pScrubber);
 #endif // MEM_SCRUB_H
@@ -70,6 +70,57 @@ NV_STATUS pmaNumaAllocate(PMA *pPma, NvLength allocationCount, NvU64 pageSize,
 void pmaNumaFreeInternal(PMA *pPma, NvU64 *pPages, NvU64 pageCount, NvU64 size, NvU32 flag);
 
 void pmaNumaSetReclaimSkipThreshold(PMA *pPma, NvU32 skipReclaimPercent);
+
+/*!
+ * @brief Counters of the per-CPU NUMA allocation magazines, summed over all
+ * CPUs.
+ */
+typedef struct
+{
+    NvU64 allocHits;        // Allocations served from a magazine
+    NvU64 allocMisses;      // Allocations that found their magazine empty
+    NvU64 freeHits;         // Frees kept in a magazine
+    NvU64 freeMisses;       // Frees of cacheable sizes released to the kernel
+    NvU64 refills;          // Batched refills from the kernel
+    NvU64 flushes;          // Batched flushes of full magazines to the kernel
+    NvU64 drains;           // Times all magazines were emptied
+    NvU64 drainedPages;     // Pages returned to the kernel by drains
+    NvU64 cachedPages64KB;  // 64KB pages currently cached
+    NvU64 cachedPages2MB;   // 2MB pages currently cached
+} PMA_NUMA_MAGAZINE_STATS;
+
+/*!
+ * @brief Creates one allocation magazine per CPU.
+ *
+ * Single 64KB and 2MB page allocations that do not need scrubbing are then
+ * served from the magazine of the current CPU, and frees of such pages are
+ * kept there instead of going back to the kernel right away. Must be called
+ * before the node is onlined.
+ *
+ * @return NV_ERR_NO_MEMORY if the magazines could not be allocated. PMA keeps
+ *         working without them.
+ */
+NV_STATUS pmaNumaMagazinesCreate(PMA *pPma);
+
+/*!
+ * @brief Drains and frees the magazines created by pmaNumaMagazinesCreate().
+ */
+void pmaNumaMagazinesDestroy(PMA *pPma);
+
+/*!
+ * @brief Returns all pages cached in the magazines to the kernel.
+ *
+ * The PMA lock must be held.
+ *
+ * @return The number of pages that were released.
+ */
+NvU64 pmaNumaMagazinesDrain(PMA *pPma);
+
+/*!
+ * @brief Reads the magazine counters. All counters are zero if the magazines
+ * are disabled.
+ */
+void pmaNumaGetMagazineStats(PMA *pPma, PMA_NUMA_MAGAZINE_STATS *pStats);
 #ifdef __cplusplus
 }
 #endif
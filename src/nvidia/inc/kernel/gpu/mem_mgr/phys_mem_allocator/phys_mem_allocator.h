@@ -117,6 +117,31 @@ typedef struct
     NvU32 resultFlags;          // valid if the allocation function returns NV_OK
 } PMA_ALLOCATION_OPTIONS;
 
+//
+// A single request of a pmaAllocatePagesBatch call. The fields mirror the
+// arguments of pmaAllocatePages, and status holds the result of the request.
+//
+typedef struct
+{
+    NvLength               pageCount;
+    NvU64                  pageSize;
+    PMA_ALLOCATION_OPTIONS options;
+    NvU64                 *pPages;
+    NV_STATUS              status;
+} PMA_ALLOCATION_REQUEST;
+
+//
+// A single request of a pmaFreePagesBatch call. The fields mirror the
+// arguments of pmaFreePages.
+//
+typedef struct
+{
+    NvU64 *pPages;
+    NvU64  pageCount;
+    NvU64  size;
+    NvU32  flags;
+} PMA_FREE_REQUEST;
+
 //
 // Explanation: This struct will be provided when UVM/RM registers a region with PMA,
 // after which the struct is stored locally in PMA. The internal "filter" function will
@@ -350,6 +375,34 @@ NV_STATUS pmaRegisterRegion(PMA *pPma, NvU32 id, NvBool bAsyncEccScrub,
 NV_STATUS pmaAllocatePages(PMA *pPma, NvLength pageCount, NvU64 pageSize,
     PMA_ALLOCATION_OPTIONS *pAllocationOptions, NvU64 *pPages);
 
+/*!
+ * @brief Allocates pages for a set of requests that may use different page
+ * sizes and options.
+ *
+ * Requests that can be satisfied from free memory are allocated in order
+ * under a single hold of the PMA lock, and the stats callback is invoked once
+ * for all of them. Discontiguous requests that allow partial allocation get
+ * the free pages found there, unless they need scrubbing. Requests that need
+ * eviction, localization, reverse allocation or blacklist handling, and
+ * requests that don't fit in free memory, are then serviced one by one through
+ * pmaAllocatePages.
+ *
+ * @param[in] pPma
+ *      The input PMA object
+ *
+ * @param[in/out] pRequests
+ *      Array of requests. Each request takes the same inputs as
+ *      pmaAllocatePages and reports its own status.
+ *
+ * @param[in] requestCount
+ *      Number of requests in pRequests
+ *
+ * @return
+ *      NV_OK if all requests succeeded, otherwise the status of the first
+ *      request that failed.
+ */
+NV_STATUS pmaAllocatePagesBatch(PMA *pPma, PMA_ALLOCATION_REQUEST *pRequests, NvLength requestCount);
+
 /*!
  * @brief Marks previously unpinned pages as pinned.
  *
@@ -408,6 +461,24 @@ NV_STATUS pmaPinPages(PMA *pPma, NvU64 *pPages, NvLength pageCount, NvU64 pageSi
  */
 void pmaFreePages(PMA *pPma, NvU64 *pPages, NvU64 pageCount, NvU64 size, NvU32 flag);
 
+/*!
+ * @brief Frees a set of page lists that may use different page sizes.
+ *
+ * All requests update the PMA maps under a single hold of the PMA lock.
+ * Physically contiguous pages are coalesced into one range update, as they
+ * are in pmaFreePages. Scrub on free is submitted per request after the lock
+ * is dropped. This function does not fail.
+ *
+ * @param[in] pRequests
+ *      Array of requests. Each request takes the same inputs as pmaFreePages.
+ *
+ * @param[in] requestCount
+ *      Number of requests in pRequests
+ *
+ * @return Void
+ */
+void pmaFreePagesBatch(PMA *pPma, PMA_FREE_REQUEST *pRequests, NvLength requestCount);
+
 /*!
  * @brief Clears scrubbing bit on PMA pages within the supplied range.
  *
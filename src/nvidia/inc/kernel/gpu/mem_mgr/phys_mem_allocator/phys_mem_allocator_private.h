@@ -52,6 +52,26 @@ typedef struct SCRUB_NODE SCRUB_NODE;
 typedef struct _PMA_MAP_INFO PMA_MAP_INFO;
 typedef struct _PMA PMA;
 
+//
+// Page sizes cached by the NUMA magazines: index 0 holds 64KB pages and index 1
+// holds 2MB pages. See numa.c.
+//
+#define PMA_NUMA_MAGAZINE_SIZES             2
+#define PMA_NUMA_MAGAZINE_MAX_CAPACITY      16
+
+typedef struct _PMA_NUMA_MAGAZINE
+{
+    PORT_SPINLOCK          *pLock;                              // Protects everything below
+    NvU32                   count[PMA_NUMA_MAGAZINE_SIZES];     // Number of cached pages per size
+    NvU64                   pages[PMA_NUMA_MAGAZINE_SIZES][PMA_NUMA_MAGAZINE_MAX_CAPACITY];
+    NvU64                   allocHits;                          // Allocations served from the magazine
+    NvU64                   allocMisses;                        // Allocations that had to refill
+    NvU64                   freeHits;                           // Frees kept in the magazine
+    NvU64                   freeMisses;                         // Frees of cacheable sizes released to the kernel
+    NvU64                   refills;                            // Batched refills from the kernel
+    NvU64                   flushes;                            // Batched flushes to the kernel
+} PMA_NUMA_MAGAZINE;
+
 /*!
  * @brief Pluggable data structure management. Currently we have regmap.
  */
@@ -132,6 +152,10 @@ struct _PMA
     NvU64                   coherentCpuFbSize;                  // Used for error checking only
     NvU32                   numaReclaimSkipThreshold;           // percent value below which __GFP_RECLAIM will not be used.
     NvBool                  bNumaAutoOnline;                    // If NUMA memory is auto-onlined
+    PMA_NUMA_MAGAZINE      *pNumaMagazines;                     // Per-CPU caches of NUMA pages, NULL if disabled
+    NvU32                   numaMagazineCount;                  // Number of entries in pNumaMagazines
+    NvU64                   numaMagazineDrains;                 // Times all magazines were drained
+    NvU64                   numaMagazineDrainedPages;           // Pages returned to the kernel by drains
 
     // Blacklist related states
     PMA_BLACKLIST_CHUNK    *pBlacklistChunks;                   // Tracking for blacklist pages
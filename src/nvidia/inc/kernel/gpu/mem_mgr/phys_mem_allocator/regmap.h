@@ -39,6 +39,21 @@
 extern "C" {
 #endif
 
+//
+// Summary levels layered on top of each bit map. A group covers 64 map words
+// (4096 frames) and a region covers 64 groups. Each group counts its map words
+// that have every bit set, and each region counts its groups that are full.
+// The scans use them to step over fully set stretches of a map without reading
+// every word.
+//
+// Each group also counts its frames that are clear in both allocation state
+// maps, and its frames that are not pinned. These bound the frames a scan can
+// use in the group, so fragmented groups that no single map has full are
+// stepped over too when they can't hold the aligned run being searched for.
+//
+#define PMA_REGMAP_SUMMARY_SHIFT 6
+#define PMA_REGMAP_SUMMARY_SIZE  (1llu << PMA_REGMAP_SUMMARY_SHIFT)
+
 //
 // Store the type here because we might use different algorithms for
 // different types of memory scan
@@ -48,6 +63,12 @@ typedef struct pma_regmap
     NvU64 totalFrames;                /* Total number of frames */
     NvU64 mapLength;                  /* Length of the map */
     NvU64 *map[PMA_BITS_PER_PAGE];    /* The bit map */
+    NvU64 groupCount;                 /* Number of 64-word groups per map */
+    NvU64 regionCount;                /* Number of 64-group regions per map */
+    NvU8  *fullWords[PMA_BITS_PER_PAGE];  /* Per group, number of map words with all bits set */
+    NvU8  *fullGroups[PMA_BITS_PER_PAGE]; /* Per region, number of groups with all words set */
+    NvU16 *freeFrames;                /* Per group, number of frames neither pinned nor unpinned */
+    NvU16 *pinFreeFrames;             /* Per group, number of frames not pinned */
     NvU64 frameEvictionsInProcess;    /* Count of frame evictions in-process */
     PMA_STATS *pPmaStats;             /* Point back to the public struct in PMA structure */
     NvBool bProtected;                /* The memory segment tracked by this regmap is protected (VPR/CPR) */
@@ -98,6 +98,9 @@ struct OBJRPC{
     NvU32 timeoutCount;
     NvBool bQuietPrints;
 
+    /* Nesting depth of open RPC batches, see kgspRpcBatchBegin */
+    NvU32 batchDepth;
+
     OBJRPCSTRUCTURECOPY rpcStructureCopy;
 };
 
@@ -98,12 +98,20 @@ NV_STATUS nvGpuOpsPmaAllocPages(void *pPma,
                                 gpuPmaAllocationOptions *pPmaAllocOptions,
                                 NvU64 *pPages);
 
+NV_STATUS nvGpuOpsPmaAllocPagesBatch(void *pPma,
+                                     gpuPmaAllocationRequest *pRequests,
+                                     NvLength requestCount);
+
 void nvGpuOpsPmaFreePages(void *pPma,
                           NvU64 *pPages,
                           NvLength pageCount,
                           NvU64 pageSize,
                           NvU32 flags);
 
+void nvGpuOpsPmaFreePagesBatch(void *pPma,
+                               gpuPmaFreeRequest *pRequests,
+                               NvLength requestCount);
+
 NV_STATUS nvGpuOpsPmaPinPages(void *pPma,
                               NvU64 *pPages,
                               NvLength pageCount,
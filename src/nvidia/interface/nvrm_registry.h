@@ -1167,6 +1167,18 @@
 #define NV_REG_STR_RM_NUMA_ALLOC_SKIP_RECLAIM_PERCENTAGE_MIN        0
 #define NV_REG_STR_RM_NUMA_ALLOC_SKIP_RECLAIM_PERCENTAGE_MAX      100
 
+//
+// Type DWORD
+// Numa allocations of single 64KB and 2MB pages are served from per-CPU magazines
+// of pages reserved from the kernel, which are refilled and flushed in batches.
+// 0 - Disable the magazines
+// 1 - Enable the magazines (default)
+//
+#define NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES                "RmNumaAllocMagazines"
+#define NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_DISABLE        0
+#define NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_ENABLE         1
+#define NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_DEFAULT        NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_ENABLE
+
 //
 // Disable 64KB BAR1 mappings
 // 0 - Disable 64KB BAR1 mappings
@@ -384,8 +384,42 @@ _kgspCompleteRpcHistoryEntry
     }
 }
 
+/*!
+ * Submit every RPC queued in the current batch and ring the doorbell once
+ * for all of them.
+ */
+static NV_STATUS
+_kgspRpcSubmitBatch
+(
+    OBJGPU *pGpu,
+    KernelGsp *pKernelGsp,
+    OBJRPC *pRpc
+)
+{
+    MESSAGE_QUEUE_INFO *pMQI = pRpc->pMessageQueueInfo;
+    NV_STATUS nvStatus;
+
+    if ((pMQI == NULL) || (GspMsgQueueGetPendingCommands(pMQI) == 0))
+        return NV_OK;
+
+    nvStatus = GspMsgQueueSubmitCommands(pMQI, pGpu);
+    if (nvStatus != NV_OK)
+    {
+        NV_PRINTF(LEVEL_ERROR, "GspMsgQueueSubmitCommands failed on GPU%d: 0x%x\n",
+                  gpuGetInstance(pGpu), nvStatus);
+        return nvStatus;
+    }
+
+    kgspSetCmdQueueHead_HAL(pGpu, pKernelGsp, pMQI->queueIdx, 0);
+
+    return NV_OK;
+}
+
 /*!
  * GSP client RM RPC send routine
+ *
+ * Inside a kgspRpcBatchBegin/kgspRpcBatchEnd pair the RPC is only queued
+ * behind the rest of the batch, and the GSP is notified when the batch ends.
  */
 static NV_STATUS
 _kgspRpcSendMessage
@@ -408,7 +442,19 @@ _kgspRpcSendMessage
 
     NV_CHECK_OK_OR_RETURN(LEVEL_SILENT, _kgspRpcSanityCheck(pGpu, pKernelGsp, pRpc));
 
-    nvStatus = GspMsgQueueSendCommand(pRpc->pMessageQueueInfo, pGpu);
+    nvStatus = GspMsgQueueQueueCommand(pRpc->pMessageQueueInfo, pGpu);
+    if ((nvStatus == NV_ERR_BUSY_RETRY) &&
+        (GspMsgQueueGetPendingCommands(pRpc->pMessageQueueInfo) != 0))
+    {
+        // No room behind the batch, so hand it to the GSP and wait for space.
+        nvStatus = _kgspRpcSubmitBatch(pGpu, pKernelGsp, pRpc);
+        if (nvStatus == NV_OK)
+            nvStatus = GspMsgQueueQueueCommand(pRpc->pMessageQueueInfo, pGpu);
+    }
+
+    if ((nvStatus == NV_OK) && (pRpc->batchDepth == 0))
+        nvStatus = _kgspRpcSubmitBatch(pGpu, pKernelGsp, pRpc);
+
     if (nvStatus != NV_OK)
     {
         if (nvStatus == NV_ERR_TIMEOUT ||
@@ -417,13 +463,11 @@ _kgspRpcSendMessage
             _kgspRpcIncrementTimeoutCountAndRateLimitPrints(pGpu, pRpc);
         }
         NV_PRINTF_COND(pRpc->bQuietPrints, LEVEL_INFO, LEVEL_ERROR,
-                       "GspMsgQueueSendCommand failed on GPU%d: 0x%x\n",
+                       "GspMsgQueueQueueCommand failed on GPU%d: 0x%x\n",
                        gpuGetInstance(pGpu), nvStatus);
         return nvStatus;
     }
 
-    kgspSetCmdQueueHead_HAL(pGpu, pKernelGsp, pRpc->pMessageQueueInfo->queueIdx, 0);
-
     _kgspAddRpcHistoryEntry(pRpc, pRpc->rpcHistory, &pRpc->rpcHistoryCurrent);
 
     return NV_OK;
@@ -2028,6 +2072,43 @@ kgspLogRpcDebugInfoToProtobuf
     prbEncNestedEnd(pProtobufData);
 }
 
+/*!
+ * Start batching RPCs sent on pRpc.
+ *
+ * Until the matching kgspRpcBatchEnd, RPCs are copied into the command queue
+ * but the GSP is not notified, so a burst of RPCs costs a single queue update
+ * and doorbell. Batches nest. Waiting for an RPC response submits whatever is
+ * queued first.
+ */
+void
+kgspRpcBatchBegin
+(
+    OBJGPU *pGpu,
+    OBJRPC *pRpc
+)
+{
+    pRpc->batchDepth++;
+}
+
+/*!
+ * End a batch started by kgspRpcBatchBegin. Ending the outermost batch
+ * submits every queued RPC and notifies the GSP once.
+ */
+NV_STATUS
+kgspRpcBatchEnd
+(
+    OBJGPU *pGpu,
+    OBJRPC *pRpc
+)
+{
+    NV_ASSERT_OR_RETURN(pRpc->batchDepth != 0, NV_ERR_INVALID_STATE);
+
+    if (--pRpc->batchDepth != 0)
+        return NV_OK;
+
+    return _kgspRpcSubmitBatch(pGpu, GPU_GET_KERNEL_GSP(pGpu), pRpc);
+}
+
 void
 kgspLogRpcDebugInfo
 (
@@ -2300,6 +2381,13 @@ _kgspRpcRecvPoll
     // This assert is meant to catch and loudly fail such cases.
     //
     NV_ASSERT_OR_RETURN(!pKernelGsp->bPollingForRpcResponse, NV_ERR_INVALID_STATE);
+
+    //
+    // The GSP cannot answer an RPC that is still queued in an open batch, so
+    // submit the batch before waiting.
+    //
+    NV_ASSERT_OK_OR_RETURN(_kgspRpcSubmitBatch(pGpu, pKernelGsp, pRpc));
+
     pKernelGsp->bPollingForRpcResponse = NV_TRUE;
 
     //
@@ -3562,23 +3650,38 @@ kgspQueueAsyncInitRpcs_IMPL
     KernelGsp *pKernelGsp
 )
 {
+    OBJRPC   *pRpc = GPU_GET_RPC(pGpu);
     NV_STATUS status = NV_OK;
+    NV_STATUS batchStatus;
+
+    NV_ASSERT_OR_RETURN(pRpc != NULL, NV_ERR_INSUFFICIENT_RESOURCES);
+
+    //
+    // None of these RPCs wait for a reply, so queue them all and publish
+    // them with a single queue update and doorbell.
+    //
+    kgspRpcBatchBegin(pGpu, pRpc);
 
     NV_RM_RPC_GSP_SET_SYSTEM_INFO(pGpu, status);
     if (status != NV_OK)
     {
         NV_ASSERT_OK_FAILED("NV_RM_RPC_GSP_SET_SYSTEM_INFO", status);
-        return status;
+        goto done;
     }
 
     NV_RM_RPC_SET_REGISTRY(pGpu, status);
     if (status != NV_OK)
     {
         NV_ASSERT_OK_FAILED("NV_RM_RPC_SET_REGISTRY", status);
-        return status;
+        goto done;
     }
 
-    return NV_OK;
+done:
+    batchStatus = kgspRpcBatchEnd(pGpu, pRpc);
+    if (status == NV_OK)
+        status = batchStatus;
+
+    return status;
 }
 
 static void
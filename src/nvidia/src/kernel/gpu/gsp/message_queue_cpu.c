@@ -51,6 +51,7 @@
 #include "msgq/msgq_priv.h"
 #include "gpu/gsp/kernel_gsp.h"
 #include "nvrm_registry.h"
+#include "platform/chipset/chipset.h"
 #include "gpu/conf_compute/ccsl.h"
 #include "gpu/conf_compute/conf_compute.h"
 
@@ -58,6 +59,21 @@ ct_assert(GSP_MSG_QUEUE_HEADER_SIZE > sizeof(msgqTxHeader) + sizeof(msgqRxHeader
 
 static void _gspMsgQueueCleanup(MESSAGE_QUEUE_INFO *pMQI);
 
+/*!
+ * msgq tx flush hook, used when the GSP does not snoop CPU writes to the
+ * queue. Drains the CPU write buffers so that the entries submitted, and then
+ * the write pointer, reach memory before the GSP is notified.
+ */
+static void
+_gspMsgQueueTxFlush
+(
+    const volatile void *pAddr,
+    unsigned size
+)
+{
+    osFlushCpuWriteCombineBuffer();
+}
+
 static void
 _getMsgQueueParams
 (
@@ -198,6 +214,7 @@ GspMsgQueuesInit
     NvLength     sharedBufSize;
     NvP64        lastQueueVa;
     NvLength     lastQueueSize;
+    OBJCL       *pCl;
     NvU64 flags = MEMDESC_FLAGS_NONE;
 
     if (*ppMQCollection != NULL)
@@ -303,6 +320,17 @@ GspMsgQueuesInit
     NV_ASSERT_OK_OR_GOTO(nvStatus, _gspMsgQueueInit(pRmQueueInfo), error_ret);
     pRmQueueInfo->queueIdx = RPC_TASK_RM_QUEUE_IDX;
 
+    //
+    // Without IO coherence the store fence in GspMsgQueueSubmitCommands is not
+    // enough for the GSP to see the entries, so have msgq flush them. msgq
+    // flushes once per submit, covering every record in the batch.
+    //
+    pCl = SYS_GET_CL(SYS_GET_INSTANCE());
+    if ((pCl != NULL) && !pCl->getProperty(pCl, PDB_PROP_CL_IS_CHIPSET_IO_COHERENT))
+    {
+        msgqSetTxFlush(pRmQueueInfo->hQueue, _gspMsgQueueTxFlush);
+    }
+
     *ppMQCollection             = pMQCollection;
     pMQCollection->sharedMemPA  = pPageTbl[0];
 
@@ -443,23 +471,32 @@ void GspMsgQueuesCleanup(MESSAGE_QUEUE_COLLECTION **ppMQCollection)
 }
 
 /*!
- * GspMsgQueueSendCommand
+ * GspMsgQueueQueueCommand
+ *
+ * Move a command record from our staging area to the command queue, behind
+ * any records already queued, without making it visible to the GSP. The
+ * record is sent by the next GspMsgQueueSubmitCommands, together with every
+ * other record queued before it.
  *
- * Move a command record from our staging area to the command queue.
+ * Outside of Confidential Compute only the bytes covered by the checksum are
+ * copied into the queue, rather than every element in full.
  *
  * Returns
- *  NV_OK                       - Record sucessfully sent.
+ *  NV_OK                       - Record sucessfully queued.
  *  NV_ERR_INVALID_PARAM_STRUCT - Bad record length.
- *  NV_ERR_BUSY_RETRY           - No space in the queue.
+ *  NV_ERR_BUSY_RETRY           - No space in the queue. If records are already
+ *                                queued, they must be submitted first.
  *  NV_ERR_INVALID_STATE        - Something really bad happenned.
  */
-NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
+NV_STATUS GspMsgQueueQueueCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
 {
     GSP_MSG_QUEUE_ELEMENT *pCQE = pMQI->pCmdQueueElement;
     NvU8      *pSrc             = (NvU8 *)pCQE;
     NvU8      *pNextElement     = NULL;
-    int        nRet;
     NvU32      i;
+    NvU32      elemCount;
+    NvU32      copyLen;
+    NvU32      timeoutFlags     = 0;
     RMTIMEOUT  timeout;
     NV_STATUS  nvStatus         = NV_OK;
     NvU32      msgLen           = GSP_MSG_QUEUE_ELEMENT_HDR_SIZE +
@@ -470,16 +507,62 @@ NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
     {
         NV_PRINTF(LEVEL_ERROR, "Incorrect message length %u\n",
             pMQI->pCmdQueueElement->rpc.length);
-        nvStatus = NV_ERR_INVALID_PARAM_STRUCT;
-        goto done;
+        return NV_ERR_INVALID_PARAM_STRUCT;
     }
 
+    elemCount = GSP_MSG_QUEUE_BYTES_TO_ELEMENTS(msgLen);
+
+    //
+    // Wait for space for the whole record before touching it, so that a full
+    // queue never leaves an encrypted record behind in our working space.
+    // The last element of the record is free only if all of them are.
+    //
+    if (pMQI->txBufferFull)
+        timeoutFlags |= GPU_TIMEOUT_FLAGS_BYPASS_JOURNAL_LOG;
+
+    // Set a timeout of 1 sec
+    gpuSetTimeout(pGpu, 1000000, &timeout, timeoutFlags);
+
+    while (NV_TRUE)
+    {
+        pNextElement = (NvU8 *)msgqTxGetWriteBuffer(pMQI->hQueue,
+                                                    pMQI->txPendingElems + elemCount - 1);
+
+        if (pNextElement != NULL)
+            break;
+
+        //
+        // The GSP cannot free up space for records it has not been told
+        // about, so let the caller submit them instead of waiting here.
+        //
+        if (pMQI->txPendingElems != 0)
+            return NV_ERR_BUSY_RETRY;
+
+        if (gpuCheckTimeout(pGpu, &timeout) != NV_OK)
+            break;
+
+        portAtomicMemoryFenceFull();
+
+        osSpinLoop();
+    }
+
+    if (pNextElement == NULL)
+    {
+        pMQI->txBufferFull++;
+        NV_PRINTF_COND(pMQI->txBufferFull == 1, LEVEL_ERROR, LEVEL_INFO,
+                       "buffer is full (waiting for %d free elements)\n",
+                       elemCount);
+        return NV_ERR_BUSY_RETRY;
+    }
+
+    pMQI->txBufferFull = 0;
+
     // Make sure the queue element in our working space is zero padded for checksum.
     if ((msgLen & 7) != 0)
         portMemSet(pSrc + msgLen, 0, 8 - (msgLen & 7));
 
     pCQE->seqNum    = pMQI->txSeqNum;
-    pCQE->elemCount = GSP_MSG_QUEUE_BYTES_TO_ELEMENTS(msgLen);
+    pCQE->elemCount = elemCount;
     pCQE->checkSum  = 0; // The checkSum field is included in the checksum calculation, so zero it.
 
     if (gpuIsCCFeatureEnabled(pGpu))
@@ -512,58 +595,63 @@ NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
         }
 
         // Now that encryption covers elements completely, include them in checksum.
-        pCQE->checkSum = _checkSum32(pSrc, pCQE->elemCount * GSP_MSG_QUEUE_ELEMENT_SIZE_MIN);
+        copyLen = pCQE->elemCount * GSP_MSG_QUEUE_ELEMENT_SIZE_MIN;
+        pCQE->checkSum = _checkSum32(pSrc, copyLen);
     }
     else
     {
+        //
+        // The GSP only reads the record up to its checksummed length, so
+        // there is no need to copy the rest of the last element.
+        //
+        copyLen = NV_ALIGN_UP(msgLen, 8);
         pCQE->checkSum = _checkSum32(pSrc, msgLen);
     }
 
     for (i = 0; i < pCQE->elemCount; i++)
     {
-        NvU32 timeoutFlags = 0;
-
-        if (pMQI->txBufferFull)
-            timeoutFlags |= GPU_TIMEOUT_FLAGS_BYPASS_JOURNAL_LOG;
+        NvU32 elemLen = NV_MIN(copyLen, GSP_MSG_QUEUE_ELEMENT_SIZE_MIN);
 
-        // Set a timeout of 1 sec
-        gpuSetTimeout(pGpu, 1000000, &timeout, timeoutFlags);
-
-        // Wait for space to put the next element.
-        while (NV_TRUE)
+        // Must get the buffers one at a time, since they could wrap.
+        pNextElement = (NvU8 *)msgqTxGetWriteBuffer(pMQI->hQueue, pMQI->txPendingElems + i);
+        if (pNextElement == NULL)
         {
-            // Must get the buffers one at a time, since they could wrap.
-            pNextElement = (NvU8 *)msgqTxGetWriteBuffer(pMQI->hQueue, i);
+            NV_PRINTF(LEVEL_ERROR, "Lost queue space for element %u of %u\n",
+                      i, pCQE->elemCount);
+            return NV_ERR_INVALID_STATE;
+        }
 
-            if (pNextElement != NULL)
-                break;
+        portMemCopy(pNextElement, elemLen, pSrc, elemLen);
+        pSrc    += elemLen;
+        copyLen -= elemLen;
+    }
 
-            if (gpuCheckTimeout(pGpu, &timeout) != NV_OK)
-                break;
+    pMQI->txPendingElems += pCQE->elemCount;
+    pMQI->txPendingMsgs++;
 
-            portAtomicMemoryFenceFull();
+    // The record owns this seq num now, whether or not it is submitted yet.
+    pMQI->txSeqNum++;
 
-            osSpinLoop();
-        }
+    return NV_OK;
+}
 
-        if (pNextElement == NULL)
-        {
-            pMQI->txBufferFull++;
-            NV_PRINTF_COND(pMQI->txBufferFull == 1, LEVEL_ERROR, LEVEL_INFO,
-                           "buffer is full (waiting for %d free elements, got %d)\n",
-                           pCQE->elemCount, i);
-            nvStatus = NV_ERR_BUSY_RETRY;
-            goto done;
-        }
-        else
-        {
-            pMQI->txBufferFull = 0;
-        }
+/*!
+ * GspMsgQueueSubmitCommands
+ *
+ * Make every record queued by GspMsgQueueQueueCommand visible to the GSP
+ * with a single queue update. The caller is still responsible for notifying
+ * the GSP.
+ *
+ * Returns
+ *  NV_OK                       - Records sucessfully submitted, or none queued.
+ *  NV_ERR_INVALID_STATE        - Something really bad happenned.
+ */
+NV_STATUS GspMsgQueueSubmitCommands(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
+{
+    int nRet;
 
-        portMemCopy(pNextElement, GSP_MSG_QUEUE_ELEMENT_SIZE_MIN,
-                    pSrc,         GSP_MSG_QUEUE_ELEMENT_SIZE_MIN);
-        pSrc += GSP_MSG_QUEUE_ELEMENT_SIZE_MIN;
-    }
+    if (pMQI->txPendingElems == 0)
+        return NV_OK;
 
     //
     // If write after write (WAW) memory ordering is relaxed in a CPU, then
@@ -575,22 +663,56 @@ NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
     //
     portAtomicMemoryFenceStore();
 
-    nRet = msgqTxSubmitBuffers(pMQI->hQueue, pCQE->elemCount);
+    nRet = msgqTxSubmitBuffers(pMQI->hQueue, pMQI->txPendingElems);
 
     if (nRet != 0)
     {
         NV_PRINTF(LEVEL_ERROR, "msgqTxSubmitBuffers failed: %d\n", nRet);
-        nvStatus = NV_ERR_INVALID_STATE;
-        goto done;
+
+        // The records were never sent, so give back their seq nums.
+        pMQI->txSeqNum      -= pMQI->txPendingMsgs;
+        pMQI->txPendingElems = 0;
+        pMQI->txPendingMsgs  = 0;
+        return NV_ERR_INVALID_STATE;
     }
 
-    // Advance seq num only if we actually used it.
-    pMQI->txSeqNum++;
+    pMQI->txPendingElems = 0;
+    pMQI->txPendingMsgs  = 0;
 
-    nvStatus = NV_OK;
+    return NV_OK;
+}
 
-done:
-    return nvStatus;
+/*!
+ * GspMsgQueueGetPendingCommands
+ *
+ * Returns the number of records queued but not yet submitted.
+ */
+NvU32 GspMsgQueueGetPendingCommands(MESSAGE_QUEUE_INFO *pMQI)
+{
+    return pMQI->txPendingMsgs;
+}
+
+/*!
+ * GspMsgQueueSendCommand
+ *
+ * Move a command record from our staging area to the command queue, and
+ * submit it along with any records queued before it.
+ *
+ * Returns
+ *  NV_OK                       - Record sucessfully sent.
+ *  NV_ERR_INVALID_PARAM_STRUCT - Bad record length.
+ *  NV_ERR_BUSY_RETRY           - No space in the queue.
+ *  NV_ERR_INVALID_STATE        - Something really bad happenned.
+ */
+NV_STATUS GspMsgQueueSendCommand(MESSAGE_QUEUE_INFO *pMQI, OBJGPU *pGpu)
+{
+    NV_STATUS nvStatus;
+
+    nvStatus = GspMsgQueueQueueCommand(pMQI, pGpu);
+    if (nvStatus != NV_OK)
+        return nvStatus;
+
+    return GspMsgQueueSubmitCommands(pMQI, pGpu);
 }
 
 /*!
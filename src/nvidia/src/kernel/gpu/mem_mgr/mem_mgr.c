@@ -3338,6 +3338,7 @@ memmgrPmaInitialize_IMPL
     {
         KernelMemorySystem *pKernelMemorySystem = GPU_GET_KERNEL_MEMORY_SYSTEM(pGpu);
         NvU32 numaSkipReclaimVal = NV_REG_STR_RM_NUMA_ALLOC_SKIP_RECLAIM_PERCENTAGE_DEFAULT;
+        NvU32 numaMagazines = NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_DEFAULT;
 
         if (osReadRegistryDword(pGpu, NV_REG_STR_RM_NUMA_ALLOC_SKIP_RECLAIM_PERCENTAGE, &numaSkipReclaimVal) == NV_OK)
         {
@@ -3348,6 +3349,16 @@ memmgrPmaInitialize_IMPL
         }
         pmaNumaSetReclaimSkipThreshold(pPma, numaSkipReclaimVal);
 
+        if ((osReadRegistryDword(pGpu, NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES, &numaMagazines) != NV_OK) ||
+            (numaMagazines != NV_REG_STR_RM_NUMA_ALLOC_MAGAZINES_DISABLE))
+        {
+            // Not fatal, allocations just always go to the kernel
+            if (pmaNumaMagazinesCreate(pPma) != NV_OK)
+            {
+                NV_PRINTF(LEVEL_WARNING, "Failed to create NUMA allocation magazines\n");
+            }
+        }
+
         // Full FB memory is added and onlined already
         if (pKernelMemorySystem->memPartitionNumaInfo[0].bInUse)
         {
@@ -616,6 +616,8 @@ scrubCheckAndWaitForSize
     }
 
     if (requiredItemsToSave != 0) {
+        portAtomicExIncrementU64(&pScrubber->allocStalls);
+
         pList = (PSCRUB_NODE) portMemAllocNonPaged(sizeof(SCRUB_NODE) * requiredItemsToSave);
         if (pList == NULL)
         {
@@ -649,6 +651,15 @@ exit:
     return status;
 }
 
+NvU64
+scrubGetAllocStalls
+(
+    OBJMEMSCRUB *pScrubber
+)
+{
+    return portAtomicExAddU64(&pScrubber->allocStalls, 0);
+}
+
 /**
  * helper function to copy elements from scrub list to the temporary list to
  * return to the caller.
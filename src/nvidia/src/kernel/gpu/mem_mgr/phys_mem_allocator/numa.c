@@ -203,6 +203,456 @@ _pmaTranslateKernelPage
     return pmaCheckRangeAgainstRegionDesc(pPma, *pGpaPhysAddr, pageSize);
 }
 
+//
+// NUMA allocation magazines
+//
+// Every NUMA allocation goes through the PMA lock and the kernel page allocator.
+// To take both off the path of small allocations, each CPU gets a magazine of
+// 64KB and 2MB pages reserved from the kernel. Single-page allocations that do
+// not need scrubbing pop a page from the magazine of the current CPU, and frees
+// of such pages push it back. An empty magazine is refilled from the kernel in
+// a batch of half its capacity, and a full one flushes half of its pages back.
+//
+// Cached pages are marked STATE_PIN in the regmap so the eviction scans never
+// pick them. Pinned allocations served from a magazine therefore never take the
+// PMA lock. Before PMA calls into the eviction callbacks, all magazines are
+// drained so that UVM is not asked to evict memory that PMA is just holding on
+// to.
+//
+// Lock order is the PMA lock, then a magazine lock.
+//
+#define PMA_NUMA_MAGAZINE_ALLOC_FLAGS (PMA_ALLOCATE_DONT_EVICT     | \
+                                       PMA_ALLOCATE_PINNED         | \
+                                       PMA_ALLOCATE_CONTIGUOUS     | \
+                                       PMA_ALLOCATE_NO_ZERO        | \
+                                       PMA_ALLOCATE_ALLOW_PARTIAL)
+
+static const NvU32 _pmaNumaMagazineCapacity[PMA_NUMA_MAGAZINE_SIZES] = { 16, 4 };
+
+static NvU32
+_pmaNumaMagazineSizeIndex(NvU64 pageSize)
+{
+    if (pageSize == _PMA_64KB)
+        return 0;
+
+    if (pageSize == _PMA_2MB)
+        return 1;
+
+    return PMA_NUMA_MAGAZINE_SIZES;
+}
+
+static NvU64
+_pmaNumaMagazinePageSize(NvU32 sizeIdx)
+{
+    return (sizeIdx == 0) ? _PMA_64KB : _PMA_2MB;
+}
+
+static PMA_NUMA_MAGAZINE *
+_pmaNumaMagazineGet(PMA *pPma)
+{
+    //
+    // The thread may migrate right after reading the CPU number. That only
+    // costs locality, the magazine lock keeps the magazine consistent.
+    //
+    return &pPma->pNumaMagazines[osGetCurrentProcessorNumber() % pPma->numaMagazineCount];
+}
+
+//
+// Sets the regmap state of a whole page. The PMA lock must be held.
+//
+static void
+_pmaNumaSetPageState
+(
+    PMA            *pPma,
+    NvU64           page,
+    NvU64           pageSize,
+    PMA_PAGESTATUS  newState
+)
+{
+    NvU32 regId = findRegionID(pPma, page);
+    NvU64 frameNum = PMA_ADDR2FRAME(page, pPma->pRegDescriptors[regId]->base);
+
+    pPma->pMapInfo->pmaMapChangeBlockStateAttrib(pPma->pRegions[regId], frameNum,
+                                                 pageSize >> PMA_PAGE_SHIFT, newState, MAP_MASK);
+}
+
+//
+// Releases a page cached in a magazine to the kernel. The PMA lock must be
+// held.
+//
+static void
+_pmaNumaMagazineReleasePage
+(
+    PMA   *pPma,
+    NvU64  page,
+    NvU64  pageSize
+)
+{
+    NvU8  osPageShift = osGetPageShift();
+    NvU64 sysPhysAddr = page + pPma->coherentCpuFbBase;
+    NvU64 j;
+
+    for (j = 0; j < (pageSize >> PMA_PAGE_SHIFT); j++)
+    {
+        osAllocReleasePage(sysPhysAddr + (j << PMA_PAGE_SHIFT), 1 << (PMA_PAGE_SHIFT - osPageShift));
+    }
+
+    _pmaNumaSetPageState(pPma, page, pageSize, STATE_FREE);
+}
+
+//
+// Allocates up to pageCount pages from the kernel and marks them as cached.
+// Called without any lock held. Returns the number of pages allocated.
+//
+static NvU32
+_pmaNumaMagazineRefill
+(
+    PMA   *pPma,
+    NvU64  pageSize,
+    NvU64 *pPages,
+    NvU32  pageCount
+)
+{
+    NvU8  osPageShift = osGetPageShift();
+    NvU32 flags = OS_ALLOC_PAGES_NODE_NONE;
+    NvS32 numaNodeId;
+    NvU64 sysPhysAddr;
+    NvU32 i;
+    NvU32 j;
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+
+    // Do not reserve more than needed when memory is getting tight
+    if (_pmaCheckFreeFramesToSkipReclaim(pPma))
+    {
+        flags = OS_ALLOC_PAGES_NODE_SKIP_RECLAIM;
+        pageCount = 1;
+    }
+    numaNodeId = pPma->numaNodeId;
+
+    portSyncSpinlockRelease(pPma->pPmaLock);
+
+    if (numaNodeId == PMA_NUMA_NO_NODE)
+        return 0;
+
+    for (i = 0; i < pageCount; i++)
+    {
+        if (osAllocPagesNode((int)numaNodeId, (NvLength)pageSize, flags, &sysPhysAddr) != NV_OK)
+            break;
+
+        if (_pmaTranslateKernelPage(pPma, sysPhysAddr, pageSize, &pPages[i]) != NV_OK)
+        {
+            NV_PRINTF(LEVEL_ERROR, "Alloc from OS invalid for sysPhysAddr = 0x%llx pageSize = 0x%llx!\n",
+                                   sysPhysAddr, pageSize);
+            break;
+        }
+
+        // Skip the first page as it is refcounted at allocation.
+        osAllocAcquirePage(sysPhysAddr + (1ULL << osPageShift), (NvU32)((pageSize >> osPageShift) - 1));
+    }
+
+    if (i == 0)
+        return 0;
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+    for (j = 0; j < i; j++)
+    {
+        _pmaNumaSetPageState(pPma, pPages[j], pageSize, STATE_PIN);
+    }
+    pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
+    portSyncSpinlockRelease(pPma->pPmaLock);
+
+    return i;
+}
+
+//
+// Serves a single page allocation from the magazine of the current CPU,
+// refilling it if it is empty. Called without any lock held.
+//
+static NV_STATUS
+_pmaNumaMagazineAllocate
+(
+    PMA    *pPma,
+    NvU64   pageSize,
+    NvBool  bPinned,
+    NvU64  *pPage
+)
+{
+    NvU32 sizeIdx = _pmaNumaMagazineSizeIndex(pageSize);
+    NvU32 capacity = _pmaNumaMagazineCapacity[sizeIdx];
+    PMA_NUMA_MAGAZINE *pMagazine = _pmaNumaMagazineGet(pPma);
+    NvU64 refillPages[PMA_NUMA_MAGAZINE_MAX_CAPACITY / 2];
+    NvU32 refillCount = 0;
+    NvU32 i;
+
+    portSyncSpinlockAcquire(pMagazine->pLock);
+    if (pMagazine->count[sizeIdx] > 0)
+    {
+        *pPage = pMagazine->pages[sizeIdx][--pMagazine->count[sizeIdx]];
+        pMagazine->allocHits++;
+        portSyncSpinlockRelease(pMagazine->pLock);
+        goto allocated;
+    }
+    pMagazine->allocMisses++;
+    portSyncSpinlockRelease(pMagazine->pLock);
+
+    refillCount = _pmaNumaMagazineRefill(pPma, pageSize, refillPages, capacity / 2);
+    if (refillCount == 0)
+        return NV_ERR_NO_MEMORY;
+
+    // Keep the last page for this allocation and cache the rest
+    *pPage = refillPages[--refillCount];
+
+    portSyncSpinlockAcquire(pMagazine->pLock);
+    pMagazine->refills++;
+    while ((refillCount > 0) && (pMagazine->count[sizeIdx] < capacity))
+    {
+        pMagazine->pages[sizeIdx][pMagazine->count[sizeIdx]++] = refillPages[--refillCount];
+    }
+    portSyncSpinlockRelease(pMagazine->pLock);
+
+allocated:
+    if (!bPinned || (refillCount > 0))
+    {
+        portSyncSpinlockAcquire(pPma->pPmaLock);
+
+        if (!bPinned)
+            _pmaNumaSetPageState(pPma, *pPage, pageSize, STATE_UNPIN);
+
+        // Frees on this CPU may have filled the magazine while it was refilled
+        for (i = 0; i < refillCount; i++)
+        {
+            _pmaNumaMagazineReleasePage(pPma, refillPages[i], pageSize);
+        }
+
+        if (refillCount > 0)
+            pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
+
+        portSyncSpinlockRelease(pPma->pPmaLock);
+    }
+
+    return NV_OK;
+}
+
+//
+// Tries to keep a freed page in the magazine of the current CPU. Returns
+// NV_FALSE if the page has to be released to the kernel by the caller. The PMA
+// lock must be held.
+//
+static NvBool
+_pmaNumaMagazineFree
+(
+    PMA   *pPma,
+    NvU64  page,
+    NvU64  pageSize
+)
+{
+    NvU32 sizeIdx = _pmaNumaMagazineSizeIndex(pageSize);
+    PMA_NUMA_MAGAZINE *pMagazine;
+    NvU64 flushPages[PMA_NUMA_MAGAZINE_MAX_CAPACITY / 2];
+    NvU32 flushCount = 0;
+    NvU32 capacity;
+    NvU32 regId;
+    NvU64 frameNum;
+    NvU64 j;
+
+    if ((pPma->pNumaMagazines == NULL) || (sizeIdx == PMA_NUMA_MAGAZINE_SIZES))
+        return NV_FALSE;
+
+    capacity = _pmaNumaMagazineCapacity[sizeIdx];
+    pMagazine = _pmaNumaMagazineGet(pPma);
+
+    // Pages under eviction are handed over to the new owner, never cached
+    regId = findRegionID(pPma, page);
+    frameNum = PMA_ADDR2FRAME(page, pPma->pRegDescriptors[regId]->base);
+    for (j = 0; j < (pageSize >> PMA_PAGE_SHIFT); j++)
+    {
+        if (pPma->pMapInfo->pmaMapRead(pPma->pRegions[regId], frameNum + j, NV_TRUE) & ATTRIB_EVICTING)
+            return NV_FALSE;
+    }
+
+    if (_pmaCheckFreeFramesToSkipReclaim(pPma))
+    {
+        portSyncSpinlockAcquire(pMagazine->pLock);
+        pMagazine->freeMisses++;
+        portSyncSpinlockRelease(pMagazine->pLock);
+        return NV_FALSE;
+    }
+
+    // The page may be handed out as soon as it is in the magazine
+    _pmaNumaSetPageState(pPma, page, pageSize, STATE_PIN);
+
+    portSyncSpinlockAcquire(pMagazine->pLock);
+    if (pMagazine->count[sizeIdx] == capacity)
+    {
+        while (flushCount < capacity / 2)
+        {
+            flushPages[flushCount++] = pMagazine->pages[sizeIdx][--pMagazine->count[sizeIdx]];
+        }
+        pMagazine->flushes++;
+    }
+    pMagazine->pages[sizeIdx][pMagazine->count[sizeIdx]++] = page;
+    pMagazine->freeHits++;
+    portSyncSpinlockRelease(pMagazine->pLock);
+
+    for (j = 0; j < flushCount; j++)
+    {
+        _pmaNumaMagazineReleasePage(pPma, flushPages[j], pageSize);
+    }
+
+    return NV_TRUE;
+}
+
+NvU64
+pmaNumaMagazinesDrain(PMA *pPma)
+{
+    NvU64 pages[PMA_NUMA_MAGAZINE_MAX_CAPACITY];
+    NvU64 drained = 0;
+    NvU32 count;
+    NvU32 sizeIdx;
+    NvU32 i;
+    NvU32 j;
+
+    if (pPma->pNumaMagazines == NULL)
+        return 0;
+
+    for (i = 0; i < pPma->numaMagazineCount; i++)
+    {
+        PMA_NUMA_MAGAZINE *pMagazine = &pPma->pNumaMagazines[i];
+
+        for (sizeIdx = 0; sizeIdx < PMA_NUMA_MAGAZINE_SIZES; sizeIdx++)
+        {
+            portSyncSpinlockAcquire(pMagazine->pLock);
+            count = pMagazine->count[sizeIdx];
+            portMemCopy(pages, count * sizeof(pages[0]), pMagazine->pages[sizeIdx], count * sizeof(pages[0]));
+            pMagazine->count[sizeIdx] = 0;
+            portSyncSpinlockRelease(pMagazine->pLock);
+
+            for (j = 0; j < count; j++)
+            {
+                _pmaNumaMagazineReleasePage(pPma, pages[j], _pmaNumaMagazinePageSize(sizeIdx));
+            }
+            drained += count;
+        }
+    }
+
+    pPma->numaMagazineDrains++;
+    pPma->numaMagazineDrainedPages += drained;
+
+    if (drained > 0)
+        pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
+
+    return drained;
+}
+
+NV_STATUS
+pmaNumaMagazinesCreate(PMA *pPma)
+{
+    NvU32 count = osGetCpuCount();
+    NvU32 i;
+
+    NV_ASSERT_OR_RETURN(pPma->bNuma, NV_ERR_INVALID_STATE);
+    NV_ASSERT_OR_RETURN(!pPma->nodeOnlined, NV_ERR_INVALID_STATE);
+    NV_ASSERT_OR_RETURN(pPma->pNumaMagazines == NULL, NV_ERR_INVALID_STATE);
+
+    if (count == 0)
+        return NV_ERR_NOT_SUPPORTED;
+
+    pPma->pNumaMagazines = portMemAllocNonPaged(count * sizeof(PMA_NUMA_MAGAZINE));
+    if (pPma->pNumaMagazines == NULL)
+        return NV_ERR_NO_MEMORY;
+
+    portMemSet(pPma->pNumaMagazines, 0, count * sizeof(PMA_NUMA_MAGAZINE));
+    pPma->numaMagazineCount = count;
+
+    for (i = 0; i < count; i++)
+    {
+        PMA_NUMA_MAGAZINE *pMagazine = &pPma->pNumaMagazines[i];
+
+        pMagazine->pLock = (PORT_SPINLOCK *)portMemAllocNonPaged(portSyncSpinlockSize);
+        if ((pMagazine->pLock == NULL) || (portSyncSpinlockInitialize(pMagazine->pLock) != NV_OK))
+        {
+            portMemFree(pMagazine->pLock);
+            goto error;
+        }
+    }
+
+    return NV_OK;
+
+error:
+    while (i-- > 0)
+    {
+        portSyncSpinlockDestroy(pPma->pNumaMagazines[i].pLock);
+        portMemFree(pPma->pNumaMagazines[i].pLock);
+    }
+
+    portMemFree(pPma->pNumaMagazines);
+    pPma->pNumaMagazines = NULL;
+    pPma->numaMagazineCount = 0;
+
+    return NV_ERR_NO_MEMORY;
+}
+
+void
+pmaNumaMagazinesDestroy(PMA *pPma)
+{
+    NvU32 i;
+
+    if (pPma->pNumaMagazines == NULL)
+        return;
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+    (void)pmaNumaMagazinesDrain(pPma);
+    portSyncSpinlockRelease(pPma->pPmaLock);
+
+    for (i = 0; i < pPma->numaMagazineCount; i++)
+    {
+        portSyncSpinlockDestroy(pPma->pNumaMagazines[i].pLock);
+        portMemFree(pPma->pNumaMagazines[i].pLock);
+    }
+
+    portMemFree(pPma->pNumaMagazines);
+    pPma->pNumaMagazines = NULL;
+    pPma->numaMagazineCount = 0;
+}
+
+void
+pmaNumaGetMagazineStats(PMA *pPma, PMA_NUMA_MAGAZINE_STATS *pStats)
+{
+    NvU32 i;
+
+    portMemSet(pStats, 0, sizeof(*pStats));
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+
+    if (pPma->pNumaMagazines == NULL)
+    {
+        portSyncSpinlockRelease(pPma->pPmaLock);
+        return;
+    }
+
+    pStats->drains = pPma->numaMagazineDrains;
+    pStats->drainedPages = pPma->numaMagazineDrainedPages;
+
+    for (i = 0; i < pPma->numaMagazineCount; i++)
+    {
+        PMA_NUMA_MAGAZINE *pMagazine = &pPma->pNumaMagazines[i];
+
+        portSyncSpinlockAcquire(pMagazine->pLock);
+        pStats->allocHits += pMagazine->allocHits;
+        pStats->allocMisses += pMagazine->allocMisses;
+        pStats->freeHits += pMagazine->freeHits;
+        pStats->freeMisses += pMagazine->freeMisses;
+        pStats->refills += pMagazine->refills;
+        pStats->flushes += pMagazine->flushes;
+        pStats->cachedPages64KB += pMagazine->count[0];
+        pStats->cachedPages2MB += pMagazine->count[1];
+        portSyncSpinlockRelease(pMagazine->pLock);
+    }
+
+    portSyncSpinlockRelease(pPma->pPmaLock);
+}
+
 /*!
  * @brief  Allocate contiguous memory for Numa
  *
@@ -511,7 +961,7 @@ exit:
 }
 
 
-NV_STATUS pmaNumaAllocate
+static NV_STATUS _pmaNumaAllocate
 (
     PMA                    *pPma,
     NvLength                allocationCount,
@@ -563,6 +1013,22 @@ NV_STATUS pmaNumaAllocate
         return NV_ERR_INVALID_STATE;
     }
 
+    if ((pPma->pNumaMagazines != NULL) &&
+        !allowEvict &&
+        (allocationCount == 1) &&
+        !(flags & ~PMA_NUMA_MAGAZINE_ALLOC_FLAGS) &&
+        (_pmaNumaMagazineSizeIndex(pageSize) < PMA_NUMA_MAGAZINE_SIZES) &&
+        (!pPma->bScrubOnFree || bSkipScrubFlag))
+    {
+        // Requests that need neither scrubbing nor eviction may hit a magazine
+        if (_pmaNumaMagazineAllocate(pPma, pageSize, !!(flags & PMA_ALLOCATE_PINNED), pPages) == NV_OK)
+        {
+            allocationOptions->resultFlags = 0;
+            allocationOptions->numPagesAllocated = 1;
+            return NV_OK;
+        }
+    }
+
     if (localizedFlag)
     {
         if (contigFlag && ((allocationCount * pageSize) > PMA_LOCALIZED_MEMORY_ALLOC_STRIDE))
@@ -794,6 +1260,52 @@ NV_STATUS pmaNumaAllocate
     return status;
 }
 
+NV_STATUS pmaNumaAllocate
+(
+    PMA                    *pPma,
+    NvLength                allocationCount,
+    NvU64                   pageSize,
+    PMA_ALLOCATION_OPTIONS *allocationOptions,
+    NvU64                  *pPages
+)
+{
+    NvU32     flags = allocationOptions->flags;
+    NvU64     drained;
+    NV_STATUS status;
+
+    if (pPma->pNumaMagazines == NULL)
+        return _pmaNumaAllocate(pPma, allocationCount, pageSize, allocationOptions, pPages);
+
+    //
+    // Try without eviction first. If that runs out of memory, return the
+    // pages cached in the magazines to the kernel and retry once, with
+    // eviction if the caller allows it. This way UVM is never asked to evict
+    // memory PMA is holding, and DONT_EVICT callers don't fail with free
+    // pages sitting in the magazines.
+    //
+    // For callers that allow eviction the first attempt is all or nothing:
+    // a partial allocation without eviction would be returned as a success,
+    // and the caller would get fewer pages than eviction could provide.
+    //
+    allocationOptions->flags |= PMA_ALLOCATE_DONT_EVICT;
+    if (!(flags & PMA_ALLOCATE_DONT_EVICT))
+        allocationOptions->flags &= ~PMA_ALLOCATE_ALLOW_PARTIAL;
+    status = _pmaNumaAllocate(pPma, allocationCount, pageSize, allocationOptions, pPages);
+    allocationOptions->flags = flags;
+
+    if (status != NV_ERR_NO_MEMORY)
+        return status;
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+    drained = pmaNumaMagazinesDrain(pPma);
+    portSyncSpinlockRelease(pPma->pPmaLock);
+
+    if ((drained == 0) && (flags & PMA_ALLOCATE_DONT_EVICT))
+        return status;
+
+    return _pmaNumaAllocate(pPma, allocationCount, pageSize, allocationOptions, pPages);
+}
+
 void pmaNumaFreeInternal
 (
     PMA   *pPma,
@@ -850,6 +1362,10 @@ void pmaNumaFreeInternal
             }
             nextPage = NV_ALIGN_UP64(pPages[i] + 1, PMA_LOCALIZED_MEMORY_RESERVE_SIZE);
         }
+        else if (_pmaNumaMagazineFree(pPma, pPages[i], size))
+        {
+            continue;
+        }
 
         regId    = findRegionID(pPma, pPages[i]);
         addrBase = pPma->pRegDescriptors[regId]->base;
@@ -395,6 +395,8 @@ pmaNumaOfflined(PMA *pPma)
     }
 
     portSyncSpinlockAcquire(pPma->pPmaLock);
+    // Pages cached in the magazines must go back before the node goes away
+    (void)pmaNumaMagazinesDrain(pPma);
     pPma->nodeOnlined = NV_FALSE;
     pPma->numaNodeId = PMA_NUMA_NO_NODE;
     portSyncSpinlockRelease(pPma->pPmaLock);
@@ -430,6 +432,8 @@ pmaDestroy(PMA *pPma)
             NV_PRINTF(LEVEL_WARNING, "Destroying PMA before node %d is offlined\n",
                                      pPma->numaNodeId);
         }
+
+        pmaNumaMagazinesDestroy(pPma);
     }
 
     for (i = 0; i < pPma->regSize; i++)
@@ -1306,6 +1310,295 @@ scrub_fatal:
 
 }
 
+//
+// Allocation flags that pmaAllocatePagesBatch services under the shared lock
+// hold. Requests using any other flag go through pmaAllocatePages.
+//
+#define PMA_ALLOCATE_BATCH_FLAGS (PMA_ALLOCATE_DONT_EVICT              | \
+                                  PMA_ALLOCATE_PINNED                  | \
+                                  PMA_ALLOCATE_SPECIFY_MINIMUM_SPEED   | \
+                                  PMA_ALLOCATE_SPECIFY_ADDRESS_RANGE   | \
+                                  PMA_ALLOCATE_SPECIFY_REGION_ID       | \
+                                  PMA_ALLOCATE_PREFER_SLOWEST          | \
+                                  PMA_ALLOCATE_CONTIGUOUS              | \
+                                  PMA_ALLOCATE_PERSISTENT              | \
+                                  PMA_ALLOCATE_PROTECTED_REGION        | \
+                                  PMA_ALLOCATE_FORCE_ALIGNMENT         | \
+                                  PMA_ALLOCATE_NO_ZERO                 | \
+                                  PMA_ALLOCATE_ALLOW_PARTIAL)
+
+static NvBool
+_pmaBatchRequestIsSimple
+(
+    PMA_ALLOCATION_REQUEST *pRequest
+)
+{
+    PMA_ALLOCATION_OPTIONS *pOptions = &pRequest->options;
+    NvU64 pageSize = pRequest->pageSize;
+
+    if ((pRequest->pPages == NULL) || (pRequest->pageCount == 0) ||
+        ((pageSize != _PMA_64KB) && (pageSize != _PMA_128KB) && (pageSize != _PMA_2MB) && (pageSize != _PMA_512MB)))
+    {
+        return NV_FALSE;
+    }
+
+    if ((pOptions->flags & ~PMA_ALLOCATE_BATCH_FLAGS) != 0)
+    {
+        return NV_FALSE;
+    }
+
+    if ((pOptions->flags & PMA_ALLOCATE_ALLOW_PARTIAL) && (pOptions->flags & PMA_ALLOCATE_CONTIGUOUS))
+    {
+        return NV_FALSE;
+    }
+
+    if ((pOptions->flags & PMA_ALLOCATE_SPECIFY_ADDRESS_RANGE) &&
+        (!NV_IS_ALIGNED(pOptions->physBegin, pageSize) || !NV_IS_ALIGNED((pOptions->physEnd + 1), pageSize) ||
+         (pOptions->physBegin > pOptions->physEnd)))
+    {
+        return NV_FALSE;
+    }
+
+    if ((pOptions->flags & PMA_ALLOCATE_FORCE_ALIGNMENT) &&
+        (!NV_IS_ALIGNED(pOptions->alignment, _PMA_64KB) || !portUtilIsPowerOfTwo(pOptions->alignment) ||
+         (!(pOptions->flags & PMA_ALLOCATE_CONTIGUOUS) && (pOptions->alignment > pageSize))))
+    {
+        return NV_FALSE;
+    }
+
+    return NV_TRUE;
+}
+
+//
+// Allocate a request from free memory only and mark the pages allocated.
+// Physically contiguous pages are marked with a single range update.
+//
+// Must be called with the PMA lock held. Returns NV_ERR_NO_MEMORY without
+// changing any state if the request doesn't fit in free memory.
+//
+// Partial requests succeed with the free pages found, unless the allocation is
+// scrubbed: pmaAllocatePages then waits for the scrubber before settling for a
+// partial allocation, so those are left to it.
+//
+static NV_STATUS
+_pmaAllocatePagesNoEvictLocked
+(
+    PMA                    *pPma,
+    PMA_ALLOCATION_REQUEST *pRequest
+)
+{
+    PMA_ALLOCATION_OPTIONS *pOptions = &pRequest->options;
+    NvS32 regionList[PMA_REGION_SIZE];
+    NvBool contigFlag = !!(pOptions->flags & PMA_ALLOCATE_CONTIGUOUS);
+    NvBool rangeFlag = !!(pOptions->flags & PMA_ALLOCATE_SPECIFY_ADDRESS_RANGE);
+    NvBool persistFlag = pPma->bForcePersistence || !!(pOptions->flags & PMA_ALLOCATE_PERSISTENT);
+    NvBool partialFlag = !!(pOptions->flags & PMA_ALLOCATE_ALLOW_PARTIAL) &&
+                         (!pPma->bScrubOnFree || !!(pOptions->flags & PMA_ALLOCATE_NO_ZERO));
+    NvU64 pageSize = pRequest->pageSize;
+    NvU64 alignment = pageSize;
+    NvU64 framesPerPage = pageSize >> PMA_PAGE_SHIFT;
+    NvU64 numPagesAllocatedSoFar = 0;
+    PMA_PAGESTATUS pinOption;
+    scanFunc useFunc;
+    NV_STATUS status;
+    NvU32 regionIdx;
+    NvU64 i, j;
+
+    if (pOptions->flags & PMA_ALLOCATE_FORCE_ALIGNMENT)
+    {
+        alignment = NV_MAX(pageSize, pOptions->alignment);
+    }
+
+    pinOption = (pOptions->flags & PMA_ALLOCATE_PINNED) ? STATE_PIN : STATE_UNPIN;
+    pinOption |= persistFlag ? ATTRIB_PERSISTENT : 0;
+
+    useFunc = contigFlag ? (pPma->pMapInfo->pmaMapScanContiguous) :
+                           (pPma->pMapInfo->pmaMapScanDiscontiguous);
+
+    status = pmaSelector(pPma, pOptions, regionList);
+    if (status != NV_OK)
+    {
+        return status;
+    }
+
+    status = NV_ERR_NO_MEMORY;
+    for (regionIdx = 0; (regionIdx < pPma->regSize) && (regionList[regionIdx] != -1); regionIdx++)
+    {
+        NvU32 regId = (NvU32)regionList[regionIdx];
+        NvU64 addrBase = pPma->pRegDescriptors[regId]->base;
+        NvU64 rangeStart = 0, rangeEnd = 0;
+        NvU64 numPagesAllocatedThisTime = 0;
+
+        if (rangeFlag)
+        {
+            rangeStart = (pOptions->physBegin >= addrBase) ? (pOptions->physBegin - addrBase) : 0;
+            rangeEnd   = (pOptions->physEnd >= addrBase) ? (pOptions->physEnd - addrBase) : 0;
+            if (rangeStart > rangeEnd)
+            {
+                return NV_ERR_INVALID_ARGUMENT;
+            }
+        }
+
+        status = (*useFunc)(pPma->pRegions[regId], addrBase, rangeStart, rangeEnd,
+                            pRequest->pageCount - numPagesAllocatedSoFar,
+                            pRequest->pPages + numPagesAllocatedSoFar, pageSize, alignment, 0, 0,
+                            &numPagesAllocatedThisTime, NV_TRUE, NV_FALSE);
+
+        numPagesAllocatedSoFar += numPagesAllocatedThisTime;
+        if (status == NV_OK)
+        {
+            break;
+        }
+    }
+
+    if ((status == NV_ERR_NO_MEMORY) && partialFlag && (numPagesAllocatedSoFar > 0))
+    {
+        status = NV_OK;
+    }
+
+    if (status != NV_OK)
+    {
+        return NV_ERR_NO_MEMORY;
+    }
+
+    NV_ASSERT(contigFlag || partialFlag || (numPagesAllocatedSoFar == pRequest->pageCount));
+
+    if (contigFlag)
+    {
+        framesPerPage *= pRequest->pageCount;
+        numPagesAllocatedSoFar = 1;
+    }
+
+    for (i = 0; i < numPagesAllocatedSoFar; i = j)
+    {
+        NvU32 regId = findRegionID(pPma, pRequest->pPages[i]);
+        NvU64 addrBase = pPma->pRegDescriptors[regId]->base;
+        NvU64 addrLimit = pPma->pRegDescriptors[regId]->limit;
+
+        for (j = i + 1; j < numPagesAllocatedSoFar; j++)
+        {
+            if ((pRequest->pPages[j] != pRequest->pPages[j - 1] + pageSize) || (pRequest->pPages[j] > addrLimit))
+            {
+                break;
+            }
+        }
+
+        pPma->pMapInfo->pmaMapChangeBlockStateAttrib(pPma->pRegions[regId],
+                                                     PMA_ADDR2FRAME(pRequest->pPages[i], addrBase),
+                                                     (j - i) * framesPerPage, pinOption, MAP_MASK);
+    }
+
+    pOptions->numPagesAllocated = contigFlag ? pRequest->pageCount : numPagesAllocatedSoFar;
+
+    return NV_OK;
+}
+
+NV_STATUS
+pmaAllocatePagesBatch
+(
+    PMA                    *pPma,
+    PMA_ALLOCATION_REQUEST *pRequests,
+    NvLength                requestCount
+)
+{
+    NV_STATUS status = NV_OK;
+    NvBool bScrubValid = NV_TRUE;
+    NvBool bAllocated = NV_FALSE;
+    NvLength i;
+
+    if ((pPma == NULL) || (pRequests == NULL) || (requestCount == 0))
+    {
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    // Requests keep NV_ERR_BUSY_RETRY until they have been serviced
+    for (i = 0; i < requestCount; i++)
+    {
+        pRequests[i].status = NV_ERR_BUSY_RETRY;
+    }
+
+    // NUMA allocations come from the OS and can't share the PMA lock hold
+    if (pPma->bNuma)
+    {
+        goto single_requests;
+    }
+
+    if (pPma->bScrubOnFree)
+    {
+        portSyncMutexAcquire(pPma->pAllocLock);
+        portSyncRwLockAcquireRead(pPma->pScrubberValidLock);
+        bScrubValid = (pmaPortAtomicGet(&pPma->scrubberValid) == PMA_SCRUBBER_VALID) &&
+                      (_pmaCheckScrubbedPages(pPma, 0, NULL, 0) == NV_OK);
+    }
+
+    if (bScrubValid)
+    {
+        portSyncSpinlockAcquire(pPma->pPmaLock);
+
+        NV_ASSERT(pmaStateCheck(pPma));
+
+        for (i = 0; i < requestCount; i++)
+        {
+            PMA_ALLOCATION_REQUEST *pRequest = &pRequests[i];
+            NvBool bScrubOnFree = pPma->bScrubOnFree && !(pRequest->options.flags & PMA_ALLOCATE_NO_ZERO);
+
+            if (!_pmaBatchRequestIsSimple(pRequest))
+            {
+                continue;
+            }
+
+            // A concurrent free may have invalidated the scrubber, leave the rest to pmaAllocatePages
+            if (pPma->bScrubOnFree && (pmaPortAtomicGet(&pPma->scrubberValid) != PMA_SCRUBBER_VALID))
+            {
+                break;
+            }
+
+            if (_pmaAllocatePagesNoEvictLocked(pPma, pRequest) == NV_OK)
+            {
+                pRequest->options.resultFlags = bScrubOnFree ? PMA_ALLOCATE_RESULT_IS_ZERO : 0;
+                pRequest->status = NV_OK;
+                bAllocated = NV_TRUE;
+            }
+        }
+
+        if (bAllocated)
+        {
+            pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
+        }
+
+        portSyncSpinlockRelease(pPma->pPmaLock);
+    }
+
+    if (pPma->bScrubOnFree)
+    {
+        portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
+        portSyncMutexRelease(pPma->pAllocLock);
+    }
+
+single_requests:
+    //
+    // Requests that need eviction, scrubber waits or the less common options
+    // take the full allocation path one at a time.
+    //
+    for (i = 0; i < requestCount; i++)
+    {
+        PMA_ALLOCATION_REQUEST *pRequest = &pRequests[i];
+
+        if (pRequest->status == NV_ERR_BUSY_RETRY)
+        {
+            pRequest->status = pmaAllocatePages(pPma, pRequest->pageCount, pRequest->pageSize,
+                                                &pRequest->options, pRequest->pPages);
+        }
+
+        if ((status == NV_OK) && (pRequest->status != NV_OK))
+        {
+            status = pRequest->status;
+        }
+    }
+
+    return status;
+}
+
 NV_STATUS
 pmaPinPages
 (
@@ -1394,94 +1687,83 @@ done:
     return status;
 }
 
-void
-pmaFreePages
+//
+// Check if any scrubbing is done before pages are freed. Returns NV_TRUE with
+// the scrubber valid lock held for reading if freed pages can be scrubbed.
+//
+static NvBool
+_pmaFreeAcquireScrubber
 (
-    PMA   *pPma,
-    NvU64 *pPages,
-    NvU64  pageCount,
-    NvU64  size,
-    NvU32  flag
+    PMA *pPma
 )
 {
-    // TODO Support free of multiple regions in one call??
-    NvU64 i, j, frameNum, framesPerPage, addrBase;
-    NvU32 regId;
-    NvU32 scrubFlags = 0;
-    NvBool bScrubValid = NV_TRUE;
-    NvBool bNeedScrub = pPma->bScrubOnFree && !(flag & PMA_FREE_SKIP_SCRUB);
-
-    NV_ASSERT(pPma != NULL);
-    NV_ASSERT(pageCount != 0);
-    NV_ASSERT(pPages != NULL);
-
-    if (pageCount != 1)
-    {
-        NV_ASSERT((size == _PMA_64KB)  ||
-                  (size == _PMA_128KB) ||
-                  (size == _PMA_2MB)   ||
-                  (size == _PMA_512MB));
-    }
-
-    // Fork out new code path for NUMA sub-allocation from OS
-    if (pPma->bNuma)
+    portSyncRwLockAcquireRead(pPma->pScrubberValidLock);
+    if (pmaPortAtomicGet(&pPma->scrubberValid) == PMA_SCRUBBER_VALID)
     {
-        portSyncSpinlockAcquire(pPma->pPmaLock);
-        pmaNumaFreeInternal(pPma, pPages, pageCount, size, flag);
-        portSyncSpinlockRelease(pPma->pPmaLock);
-
-        return;
-    }
-
-    // Check if any scrubbing is done before we actually free
-    if (bNeedScrub)
-    {
-        portSyncRwLockAcquireRead(pPma->pScrubberValidLock);
-        if (pmaPortAtomicGet(&pPma->scrubberValid) == PMA_SCRUBBER_VALID)
-        {
-            if (_pmaCheckScrubbedPages(pPma, 0, NULL, 0) != NV_OK)
-            {
-                portAtomicSetSize(&pPma->scrubberValid, PMA_SCRUBBER_INVALID);
-                portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
-                bScrubValid = NV_FALSE;
-                NV_PRINTF(LEVEL_WARNING, "Scrubber object is not valid\n");
-            }
-        }
-        else
+        if (_pmaCheckScrubbedPages(pPma, 0, NULL, 0) == NV_OK)
         {
-            // We allow free with invalid scrubber object
-            portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
-            bScrubValid = NV_FALSE;
-            NV_PRINTF(LEVEL_WARNING, "Scrubber object is not valid\n");
+            return NV_TRUE;
         }
+        portAtomicSetSize(&pPma->scrubberValid, PMA_SCRUBBER_INVALID);
     }
-    // Only hold Reader lock here if (bScrubValid && bNeedScrub)
 
-    portSyncSpinlockAcquire(pPma->pPmaLock);
+    // We allow free with invalid scrubber object
+    portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
+    NV_PRINTF(LEVEL_WARNING, "Scrubber object is not valid\n");
+    return NV_FALSE;
+}
+
+//
+// Mark pages as newStatus and reclaim localized memory they were the last users
+// of. Physically contiguous pages are updated as a single range.
+//
+// Must be called with the PMA lock held. Returns the flags to submit the pages
+// to the scrubber with.
+//
+static NvU32
+_pmaFreePagesLocked
+(
+    PMA           *pPma,
+    NvU64         *pPages,
+    NvU64          pageCount,
+    NvU64          size,
+    PMA_PAGESTATUS newStatus
+)
+{
+    NvU64 i, j, k, frameNum, framesPerPage, addrBase, addrLimit;
+    NvU32 regId;
+    NvU32 scrubFlags = 0;
+    PMA_PAGESTATUS exceptedMask = ATTRIB_EVICTING | ATTRIB_BLACKLIST | ATTRIB_LOCALIZED;
 
     framesPerPage = size >> PMA_PAGE_SHIFT;
 
-    for (i = 0; i < pageCount; i++)
+    for (i = 0; i < pageCount; i = j)
     {
-        regId    = findRegionID(pPma, pPages[i]);
-        addrBase = pPma->pRegDescriptors[regId]->base;
-        frameNum = PMA_ADDR2FRAME(pPages[i], addrBase);
-
-        _pmaReallocBlacklistPages(pPma, regId, pPages[i], pageCount * size);
+        regId     = findRegionID(pPma, pPages[i]);
+        addrBase  = pPma->pRegDescriptors[regId]->base;
+        addrLimit = pPma->pRegDescriptors[regId]->limit;
+        frameNum  = PMA_ADDR2FRAME(pPages[i], addrBase);
 
-        for (j = 0; j < framesPerPage; j++)
+        // Coalesce the run of physically contiguous pages within the region
+        for (j = i + 1; j < pageCount; j++)
         {
-            PMA_PAGESTATUS newStatus = (bScrubValid && bNeedScrub) ? ATTRIB_SCRUBBING : STATE_FREE;
-            PMA_PAGESTATUS exceptedMask = ATTRIB_EVICTING | ATTRIB_BLACKLIST;
-
-            exceptedMask |= ATTRIB_LOCALIZED;
+            if ((pPages[j] != pPages[j - 1] + size) || (pPages[j] > addrLimit))
+            {
+                break;
+            }
+        }
 
-            //
-            // Reset everything except for the (ATTRIB_EVICTING and ATTRIB_BLACKLIST) state to support memory being freed
-            // after being picked for eviction.
-            //
-            pPma->pMapInfo->pmaMapChangeStateAttrib(pPma->pRegions[regId], (frameNum + j), newStatus, ~(exceptedMask));
+        for (k = i; k < j; k++)
+        {
+            _pmaReallocBlacklistPages(pPma, regId, pPages[k], pageCount * size);
         }
+
+        //
+        // Reset everything except for the (ATTRIB_EVICTING and ATTRIB_BLACKLIST) state to support memory being freed
+        // after being picked for eviction.
+        //
+        pPma->pMapInfo->pmaMapChangeBlockStateAttrib(pPma->pRegions[regId], frameNum, (j - i) * framesPerPage,
+                                                     newStatus, ~(exceptedMask));
     }
 
     {
@@ -1495,7 +1777,7 @@ pmaFreePages
         //
         if (pageCount < 1)
         {
-            goto localized_done;
+            return scrubFlags;
         }
 
         regId = findRegionID(pPma, pPages[0]);
@@ -1504,7 +1786,7 @@ pmaFreePages
         state = pPma->pMapInfo->pmaMapRead(pPma->pRegions[regId], frameNum, NV_TRUE);
         if ((state & ATTRIB_LOCALIZED) == 0)
         {
-            goto localized_done;
+            return scrubFlags;
         }
     }
 
@@ -1537,7 +1819,7 @@ pmaFreePages
         if (state & ATTRIB_EVICTING)
         {
             NV_PRINTF(LEVEL_ERROR, "Localizing and evicting state is undefined, exiting\n");
-            goto localized_done;
+            return scrubFlags;
         }
 
         state &= ~ATTRIB_SCRUBBING;
@@ -1568,7 +1850,90 @@ pmaFreePages
         }
     }
 
-localized_done:
+    return scrubFlags;
+}
+
+//
+// Submit freed pages to the scrubber. Must be called without the PMA lock and
+// with the scrubber valid lock held for reading.
+//
+static void
+_pmaFreeSubmitScrub
+(
+    PMA   *pPma,
+    NvU64 *pPages,
+    NvU64  pageCount,
+    NvU64  size,
+    NvU32  scrubFlags
+)
+{
+    PSCRUB_NODE pPmaScrubList = NULL;
+    NvU64 count;
+
+    if (scrubSubmitPages(pPma->pScrubObj, size, pPages, pageCount,
+                         &pPmaScrubList, &count, scrubFlags) == NV_OK)
+    {
+        if (count > 0)
+        {
+            _pmaClearScrubBit(pPma, pPmaScrubList, count);
+        }
+    }
+    else
+    {
+        portAtomicSetSize(&pPma->scrubberValid, PMA_SCRUBBER_INVALID);
+    }
+
+    // Free the actual list, although allocated by objscrub
+    portMemFree(pPmaScrubList);
+}
+
+void
+pmaFreePages
+(
+    PMA   *pPma,
+    NvU64 *pPages,
+    NvU64  pageCount,
+    NvU64  size,
+    NvU32  flag
+)
+{
+    NvU32 scrubFlags;
+    NvBool bScrubValid = NV_TRUE;
+    NvBool bNeedScrub = pPma->bScrubOnFree && !(flag & PMA_FREE_SKIP_SCRUB);
+
+    NV_ASSERT(pPma != NULL);
+    NV_ASSERT(pageCount != 0);
+    NV_ASSERT(pPages != NULL);
+
+    if (pageCount != 1)
+    {
+        NV_ASSERT((size == _PMA_64KB)  ||
+                  (size == _PMA_128KB) ||
+                  (size == _PMA_2MB)   ||
+                  (size == _PMA_512MB));
+    }
+
+    // Fork out new code path for NUMA sub-allocation from OS
+    if (pPma->bNuma)
+    {
+        portSyncSpinlockAcquire(pPma->pPmaLock);
+        pmaNumaFreeInternal(pPma, pPages, pageCount, size, flag);
+        portSyncSpinlockRelease(pPma->pPmaLock);
+
+        return;
+    }
+
+    // Check if any scrubbing is done before we actually free
+    if (bNeedScrub)
+    {
+        bScrubValid = _pmaFreeAcquireScrubber(pPma);
+    }
+    // Only hold Reader lock here if (bScrubValid && bNeedScrub)
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+
+    scrubFlags = _pmaFreePagesLocked(pPma, pPages, pageCount, size,
+                                     (bScrubValid && bNeedScrub) ? ATTRIB_SCRUBBING : STATE_FREE);
 
     pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
 
@@ -1577,27 +1942,97 @@ localized_done:
     // Maybe we need to scrub the page on free
     if (bScrubValid && bNeedScrub)
     {
-        PSCRUB_NODE pPmaScrubList = NULL;
-        NvU64 count;
+        _pmaFreeSubmitScrub(pPma, pPages, pageCount, size, scrubFlags);
+
+        portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
+    }
+}
+
+void
+pmaFreePagesBatch
+(
+    PMA              *pPma,
+    PMA_FREE_REQUEST *pRequests,
+    NvLength          requestCount
+)
+{
+    NvU32 *pScrubFlags = NULL;
+    NvBool bNeedScrub = NV_FALSE;
+    NvBool bScrubValid = NV_FALSE;
+    NvLength i;
+
+    NV_ASSERT(pPma != NULL);
+    NV_ASSERT(pRequests != NULL);
+
+    for (i = 0; i < requestCount; i++)
+    {
+        bNeedScrub = bNeedScrub || (pPma->bScrubOnFree && !(pRequests[i].flags & PMA_FREE_SKIP_SCRUB));
+    }
 
-        if (scrubSubmitPages(pPma->pScrubObj, size, pPages, pageCount,
-                             &pPmaScrubList, &count, scrubFlags) == NV_OK)
+    //
+    // The scrub flags of each request are only known once its pages are freed,
+    // and are needed to submit them after the PMA lock is dropped. Fall back to
+    // freeing one request at a time if they can't be tracked.
+    //
+    if (bNeedScrub && !pPma->bNuma)
+    {
+        pScrubFlags = portMemAllocNonPaged(requestCount * sizeof(*pScrubFlags));
+    }
+
+    if (pPma->bNuma || (bNeedScrub && (pScrubFlags == NULL)))
+    {
+        for (i = 0; i < requestCount; i++)
         {
-            if (count > 0)
-            {
-                _pmaClearScrubBit(pPma, pPmaScrubList, count);
-            }
+            pmaFreePages(pPma, pRequests[i].pPages, pRequests[i].pageCount, pRequests[i].size, pRequests[i].flags);
         }
-        else
+        return;
+    }
+
+    if (bNeedScrub)
+    {
+        bScrubValid = _pmaFreeAcquireScrubber(pPma);
+    }
+
+    portSyncSpinlockAcquire(pPma->pPmaLock);
+
+    for (i = 0; i < requestCount; i++)
+    {
+        PMA_FREE_REQUEST *pRequest = &pRequests[i];
+        NvBool bScrubRequest = bScrubValid && !(pRequest->flags & PMA_FREE_SKIP_SCRUB);
+        NvU32 scrubFlags;
+
+        NV_ASSERT(pRequest->pageCount != 0);
+        NV_ASSERT(pRequest->pPages != NULL);
+
+        scrubFlags = _pmaFreePagesLocked(pPma, pRequest->pPages, pRequest->pageCount, pRequest->size,
+                                         bScrubRequest ? ATTRIB_SCRUBBING : STATE_FREE);
+        if (pScrubFlags != NULL)
         {
-            portAtomicSetSize(&pPma->scrubberValid, PMA_SCRUBBER_INVALID);
+            pScrubFlags[i] = scrubFlags;
         }
+    }
+
+    pPma->pStatsUpdateCb(pPma->pStatsUpdateCtx, pPma->pmaStats.numFreeFrames);
 
-        // Free the actual list, although allocated by objscrub
-        portMemFree(pPmaScrubList);
+    portSyncSpinlockRelease(pPma->pPmaLock);
+
+    if (bScrubValid)
+    {
+        for (i = 0; i < requestCount; i++)
+        {
+            if (pRequests[i].flags & PMA_FREE_SKIP_SCRUB)
+            {
+                continue;
+            }
+
+            _pmaFreeSubmitScrub(pPma, pRequests[i].pPages, pRequests[i].pageCount, pRequests[i].size,
+                                pScrubFlags[i]);
+        }
 
         portSyncRwLockReleaseRead(pPma->pScrubberValidLock);
     }
+
+    portMemFree(pScrubFlags);
 }
 
 
@@ -209,6 +209,270 @@ static NvU64 alignDownToMod(NvU64 frame, NvU64 alignment, NvU64 mod)
     return ((frame - mod) & ~(alignment - 1ll)) + mod;
 }
 
+#define WORD_TO_GROUP(n)            ((n) >> PMA_REGMAP_SUMMARY_SHIFT)
+#define GROUP_TO_REGION(n)          ((n) >> PMA_REGMAP_SUMMARY_SHIFT)
+#define GROUP_TO_WORD(n)            ((n) << PMA_REGMAP_SUMMARY_SHIFT)
+#define REGION_TO_WORD(n)           ((n) << (2 * PMA_REGMAP_SUMMARY_SHIFT))
+#define FRAME_TO_GROUP(n)           ((n) >> (FRAME_TO_U64_SHIFT + PMA_REGMAP_SUMMARY_SHIFT))
+#define GROUP_TO_FRAME(n)           ((n) << (FRAME_TO_U64_SHIFT + PMA_REGMAP_SUMMARY_SHIFT))
+
+//
+// Update the summary counters of map mapIdx after word idx changed from
+// oldBits to newBits. Must be called for every write to a map word, with the
+// other maps' words at idx already holding their current value.
+//
+static NV_FORCEINLINE void
+_pmaRegmapSummaryUpdate
+(
+    PMA_REGMAP *pRegmap,
+    NvU32 mapIdx,
+    NvU64 idx,
+    NvU64 oldBits,
+    NvU64 newBits
+)
+{
+    NvU64 groupIdx = WORD_TO_GROUP(idx);
+
+    if (mapIdx == MAP_IDX_ALLOC_PIN)
+    {
+        NvU64 unpinBits = pRegmap->map[MAP_IDX_ALLOC_UNPIN][idx];
+
+        pRegmap->pinFreeFrames[groupIdx] += nvPopCount64(oldBits) - nvPopCount64(newBits);
+        pRegmap->freeFrames[groupIdx] += nvPopCount64(oldBits | unpinBits) -
+                                         nvPopCount64(newBits | unpinBits);
+    }
+    else if (mapIdx == MAP_IDX_ALLOC_UNPIN)
+    {
+        NvU64 pinBits = pRegmap->map[MAP_IDX_ALLOC_PIN][idx];
+
+        pRegmap->freeFrames[groupIdx] += nvPopCount64(oldBits | pinBits) -
+                                         nvPopCount64(newBits | pinBits);
+    }
+
+    if ((oldBits == NV_U64_MAX) == (newBits == NV_U64_MAX))
+    {
+        return;
+    }
+
+    if (newBits == NV_U64_MAX)
+    {
+        if (++pRegmap->fullWords[mapIdx][groupIdx] == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            pRegmap->fullGroups[mapIdx][GROUP_TO_REGION(groupIdx)]++;
+        }
+    }
+    else
+    {
+        if (pRegmap->fullWords[mapIdx][groupIdx]-- == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            pRegmap->fullGroups[mapIdx][GROUP_TO_REGION(groupIdx)]--;
+        }
+    }
+}
+
+static NV_FORCEINLINE void
+_pmaRegmapWriteWord
+(
+    PMA_REGMAP *pRegmap,
+    NvU32 mapIdx,
+    NvU64 idx,
+    NvU64 newBits
+)
+{
+    _pmaRegmapSummaryUpdate(pRegmap, mapIdx, idx, pRegmap->map[mapIdx][idx], newBits);
+    pRegmap->map[mapIdx][idx] = newBits;
+}
+
+//
+// Find the first word in [*pIdx, lastIdx] of map mapIdx that has a clear bit,
+// stepping over full regions and groups using the summary counters.
+//
+// Returns NV_TRUE and updates *pIdx if such a word exists.
+//
+static NvBool
+_pmaRegmapFindNotFullWord
+(
+    PMA_REGMAP *pRegmap,
+    NvU32 mapIdx,
+    NvU64 *pIdx,
+    NvU64 lastIdx
+)
+{
+    NvU64 idx = *pIdx;
+
+    while (idx <= lastIdx)
+    {
+        NvU64 groupIdx = WORD_TO_GROUP(idx);
+        NvU64 groupEnd;
+
+        if (pRegmap->fullGroups[mapIdx][GROUP_TO_REGION(groupIdx)] == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            idx = REGION_TO_WORD(GROUP_TO_REGION(groupIdx) + 1);
+            continue;
+        }
+        if (pRegmap->fullWords[mapIdx][groupIdx] == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            idx = GROUP_TO_WORD(groupIdx + 1);
+            continue;
+        }
+
+        groupEnd = NV_MIN(GROUP_TO_WORD(groupIdx + 1) - 1, lastIdx);
+        for (; idx <= groupEnd; idx++)
+        {
+            if (pRegmap->map[mapIdx][idx] != NV_U64_MAX)
+            {
+                *pIdx = idx;
+                return NV_TRUE;
+            }
+        }
+    }
+
+    return NV_FALSE;
+}
+
+//
+// Reverse counterpart of _pmaRegmapFindNotFullWord, searching the words in
+// [firstIdx, *pIdx) from the top down.
+//
+static NvBool
+_pmaRegmapFindNotFullWordReverse
+(
+    PMA_REGMAP *pRegmap,
+    NvU32 mapIdx,
+    NvU64 *pIdx,
+    NvU64 firstIdx
+)
+{
+    NvU64 idx = *pIdx;
+
+    while (idx > firstIdx)
+    {
+        NvU64 groupIdx = WORD_TO_GROUP(idx - 1);
+        NvU64 groupStart;
+
+        if (pRegmap->fullGroups[mapIdx][GROUP_TO_REGION(groupIdx)] == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            idx = REGION_TO_WORD(GROUP_TO_REGION(groupIdx));
+            continue;
+        }
+        if (pRegmap->fullWords[mapIdx][groupIdx] == PMA_REGMAP_SUMMARY_SIZE)
+        {
+            idx = GROUP_TO_WORD(groupIdx);
+            continue;
+        }
+
+        groupStart = NV_MAX(GROUP_TO_WORD(groupIdx), firstIdx);
+        for (; idx > groupStart; idx--)
+        {
+            if (pRegmap->map[mapIdx][idx - 1] != NV_U64_MAX)
+            {
+                *pIdx = idx - 1;
+                return NV_TRUE;
+            }
+        }
+    }
+
+    return NV_FALSE;
+}
+
+//
+// Upper bound of the frames in group groupIdx that a scan can use. A usable
+// frame is never pinned, and is also not unpinned unless the scan accepts
+// evictable frames.
+//
+static NV_FORCEINLINE NvU64
+_pmaRegmapGroupUsableFrames
+(
+    PMA_REGMAP *pRegmap,
+    NvU64 groupIdx,
+    NvBool bSearchEvictable
+)
+{
+    return bSearchEvictable ? pRegmap->pinFreeFrames[groupIdx] : pRegmap->freeFrames[groupIdx];
+}
+
+//
+// Move frameBaseIdx, the start of a run of numFrames, up to the first aligned
+// start whose run could fit in the usable frames of its group. A run starting
+// before groupEnd - usable needs more than usable frames of that group, so
+// those starts are skipped without reading the maps. This also covers groups
+// that are fragmented across the pinned and unpinned maps. Once a start passes,
+// every later start in the same group does too, so callers only need to check
+// again after moving into another group.
+//
+static NvU64
+_pmaRegmapSkipGroups
+(
+    PMA_REGMAP *pRegmap,
+    NvU64 frameBaseIdx,
+    NvU64 localEnd,
+    NvU64 numFrames,
+    NvU64 frameAlignment,
+    NvU64 frameAlignmentPadding,
+    NvBool bSearchEvictable
+)
+{
+    while (frameBaseIdx <= localEnd)
+    {
+        NvU64 groupIdx = FRAME_TO_GROUP(frameBaseIdx);
+        NvU64 groupEnd = GROUP_TO_FRAME(groupIdx + 1);
+        NvU64 usable = _pmaRegmapGroupUsableFrames(pRegmap, groupIdx, bSearchEvictable);
+
+        if (usable >= NV_MIN(numFrames, groupEnd - frameBaseIdx))
+        {
+            break;
+        }
+
+        frameBaseIdx = alignUpToMod(groupEnd - usable, frameAlignment, frameAlignmentPadding);
+    }
+
+    return frameBaseIdx;
+}
+
+//
+// Reverse counterpart of _pmaRegmapSkipGroups, moving frameEndIdx, the
+// exclusive end of the run, down. Returns 0 if no run fits above localStart.
+//
+static NvU64
+_pmaRegmapSkipGroupsReverse
+(
+    PMA_REGMAP *pRegmap,
+    NvU64 frameEndIdx,
+    NvU64 localStart,
+    NvU64 numFrames,
+    NvU64 frameAlignment,
+    NvU64 endAlignmentPadding,
+    NvBool bSearchEvictable
+)
+{
+    while (frameEndIdx >= (localStart + numFrames))
+    {
+        NvU64 groupIdx = FRAME_TO_GROUP(frameEndIdx - 1llu);
+        NvU64 groupStart = GROUP_TO_FRAME(groupIdx);
+        NvU64 usable = _pmaRegmapGroupUsableFrames(pRegmap, groupIdx, bSearchEvictable);
+        NvU64 nextEnd;
+
+        if (usable >= NV_MIN(numFrames, frameEndIdx - groupStart))
+        {
+            break;
+        }
+
+        if ((groupStart + usable) < (localStart + numFrames))
+        {
+            return 0;
+        }
+
+        nextEnd = alignDownToMod(groupStart + usable, frameAlignment, endAlignmentPadding);
+        if (nextEnd >= frameEndIdx)
+        {
+            return 0;
+        }
+        frameEndIdx = nextEnd;
+    }
+
+    return frameEndIdx;
+}
+
 //
 // Check whether the specified frame range is available completely for eviction
 //
@@ -450,6 +714,38 @@ pmaRegmapInit
         }
         portMemSet(newMap->map[i], 0, (NvLength) (newMap->mapLength * sizeof(NvU64)));
     }
+
+    newMap->groupCount = WORD_TO_GROUP(newMap->mapLength - 1) + 1;
+    newMap->regionCount = GROUP_TO_REGION(newMap->groupCount - 1) + 1;
+    for (i = 0; i < PMA_BITS_PER_PAGE; i++)
+    {
+        newMap->fullWords[i] = (NvU8 *) portMemAllocNonPaged((NvLength)newMap->groupCount);
+        newMap->fullGroups[i] = (NvU8 *) portMemAllocNonPaged((NvLength)newMap->regionCount);
+        if ((newMap->fullWords[i] == NULL) || (newMap->fullGroups[i] == NULL))
+        {
+            pmaRegmapDestroy(newMap);
+            return NULL;
+        }
+        portMemSet(newMap->fullWords[i], 0, (NvLength)newMap->groupCount);
+        portMemSet(newMap->fullGroups[i], 0, (NvLength)newMap->regionCount);
+    }
+
+    newMap->freeFrames = (NvU16 *) portMemAllocNonPaged((NvLength)(newMap->groupCount * sizeof(NvU16)));
+    newMap->pinFreeFrames = (NvU16 *) portMemAllocNonPaged((NvLength)(newMap->groupCount * sizeof(NvU16)));
+    if ((newMap->freeFrames == NULL) || (newMap->pinFreeFrames == NULL))
+    {
+        pmaRegmapDestroy(newMap);
+        return NULL;
+    }
+    for (i = 0; i < newMap->groupCount; i++)
+    {
+        // Only the last group may cover fewer than PMA_REGMAP_SUMMARY_SIZE words
+        NvU64 groupWords = NV_MIN(newMap->mapLength - GROUP_TO_WORD(i), PMA_REGMAP_SUMMARY_SIZE);
+
+        newMap->freeFrames[i] = (NvU16)(groupWords * FRAME_TO_U64_SIZE);
+        newMap->pinFreeFrames[i] = (NvU16)(groupWords * FRAME_TO_U64_SIZE);
+    }
+
     {
         //
         // Simplify logic for 2M tracking. Set the last few nonaligned bits as pinned
@@ -458,7 +754,7 @@ pmaRegmapInit
         NvU64 endOffs = (numFrames - 1llu) >> FRAME_TO_U64_SHIFT;
         NvU64 endBit = (numFrames - 1llu) & FRAME_TO_U64_MASK;
         NvU64 endMask = endBit == FRAME_TO_U64_MASK ? 0llu : ~(NV_U64_MAX >> (FRAME_TO_U64_MASK - endBit));
-        newMap->map[MAP_IDX_ALLOC_PIN][endOffs] |= endMask;
+        _pmaRegmapWriteWord(newMap, MAP_IDX_ALLOC_PIN, endOffs, newMap->map[MAP_IDX_ALLOC_PIN][endOffs] | endMask);
     }
 
     return (void *)newMap;
@@ -474,7 +770,11 @@ pmaRegmapDestroy(void *pMap)
     for (i = 0; i < PMA_BITS_PER_PAGE; i++)
     {
         portMemFree(pRegmap->map[i]);
+        portMemFree(pRegmap->fullWords[i]);
+        portMemFree(pRegmap->fullGroups[i]);
     }
+    portMemFree(pRegmap->freeFrames);
+    portMemFree(pRegmap->pinFreeFrames);
 
     pRegmap->pPmaStats->numFreeFrames -= pRegmap->totalFrames;
 
@@ -562,8 +862,8 @@ _pmaRegmapDoSingleStateChange
     NvU64 xored = initialState ^ finalState;
 
     // Write out new bits
-    pRegmap->map[MAP_IDX_ALLOC_PIN][idx] = pinOut;
-    pRegmap->map[MAP_IDX_ALLOC_UNPIN][idx] = unpinOut;
+    _pmaRegmapWriteWord(pRegmap, MAP_IDX_ALLOC_PIN, idx, pinOut);
+    _pmaRegmapWriteWord(pRegmap, MAP_IDX_ALLOC_UNPIN, idx, unpinOut);
 
     // Update deltas
     (*delta64k) += nvPopCount64(xored);
@@ -606,22 +906,19 @@ pmaRegmapChangeBlockStateAttrib
         }
         if (initialIdx == finalIdx)
         {
-            pRegmap->map[i][initialIdx] &= ~(initialMask & finalMask);
-            pRegmap->map[i][initialIdx] |= toWrite & (initialMask & finalMask);
+            _pmaRegmapWriteWord(pRegmap, i, initialIdx,
+                                SETBITS(pRegmap->map[i][initialIdx], (initialMask & finalMask), toWrite));
             continue;
         }
-       
-        pRegmap->map[i][initialIdx] &= ~initialMask;
-        pRegmap->map[i][initialIdx] |= toWrite & initialMask;
-        
+
+        _pmaRegmapWriteWord(pRegmap, i, initialIdx, SETBITS(pRegmap->map[i][initialIdx], initialMask, toWrite));
+
         for (j = initialIdx + 1; j < finalIdx; j++)
         {
-            pRegmap->map[i][j] = toWrite;
-            
+            _pmaRegmapWriteWord(pRegmap, i, j, toWrite);
         }
-        pRegmap->map[i][finalIdx] &= ~finalMask;
-        pRegmap->map[i][finalIdx] |= toWrite & finalMask;
-        
+        _pmaRegmapWriteWord(pRegmap, i, finalIdx, SETBITS(pRegmap->map[i][finalIdx], finalMask, toWrite));
+
     }
 
     if (!(writeMask & STATE_MASK))
@@ -728,6 +1025,7 @@ static NvS64 _scanContiguousSearchLoop
     NvU64 frameBaseIdx = alignUpToMod(localStart, frameAlignment, frameAlignmentPadding); // this is already done by the caller
     NvU64 nextStrideStart;
     NvU64 latestFree[PMA_BITS_PER_PAGE];
+    NvU64 checkedGroup = NV_U64_MAX;
     NvU64 i;
 
     // _scanContiguousSearchLoop can only be called for <32MB localized memory, enforced by PMA
@@ -820,6 +1118,14 @@ loop_begin:
         }
     }
 
+    // Skip the starts whose run can't fit in the free frames of its group
+    if ((localStride == 0) && (FRAME_TO_GROUP(frameBaseIdx) != checkedGroup))
+    {
+        frameBaseIdx = _pmaRegmapSkipGroups(pRegmap, frameBaseIdx, localEnd, numFrames,
+                                            frameAlignment, frameAlignmentPadding, bSearchEvictable);
+        checkedGroup = FRAME_TO_GROUP(frameBaseIdx);
+    }
+
     //
     // Always start a loop iteration with an updated frameBaseIdx by ensuring that latestFree is always >= frameBaseIdx
     // frameBaseIdx == latestFree[i] means that there are no observed 0s so far in the current run
@@ -880,16 +1186,11 @@ loop_begin:
                     goto free_found;
                 }
                 curMapIdx++;
-                frameBaseIdx += FRAME_TO_U64_SIZE;
-                while (frameBaseIdx <= localEnd)
+                if (_pmaRegmapFindNotFullWord(pRegmap, i, &curMapIdx, PAGE_MAPIDX(localEnd)))
                 {
                     curMap = pRegmap->map[i][curMapIdx];
-                    if(curMap != NV_U64_MAX)
-                    {
-                        goto free_found;
-                    }
-                    frameBaseIdx += FRAME_TO_U64_SIZE;
-                    curMapIdx++;
+                    frameBaseIdx = curMapIdx << FRAME_TO_U64_SHIFT;
+                    goto free_found;
                 }
                 // No more free pages, exit
                 return -1;
@@ -924,12 +1225,21 @@ static NvS64 _scanContiguousSearchLoopReverse
     // ie we have the needed pages if frameBaseIdx - numPages == latestFree. Initialize to last aligned frame
     //
     NvU64 latestFree[PMA_BITS_PER_PAGE];
+    NvU64 checkedGroup = NV_U64_MAX;
     NvU64 i;
     for (i = 0; i < PMA_BITS_PER_PAGE; i++)
     {
             latestFree[i] = frameBaseIdx;
     }
 loop_begin:
+    // Skip the ends whose run can't fit in the free frames of its group, 0 ends the search
+    if (FRAME_TO_GROUP(frameBaseIdx - 1llu) != checkedGroup)
+    {
+        frameBaseIdx = _pmaRegmapSkipGroupsReverse(pRegmap, frameBaseIdx, localStart, numFrames,
+                                                   frameAlignment, realAlign, bSearchEvictable);
+        checkedGroup = FRAME_TO_GROUP(frameBaseIdx - 1llu);
+    }
+
     //
     // Always start a loop iteration with an updated frameBaseIdx by ensuring that latestFree is always <= frameBaseIdx
     // frameBaseIdx == latestFree[i] means that there are no observed 0s so far in the current run
@@ -983,17 +1293,11 @@ loop_begin:
                 {
                     goto free_found;
                 }
-                curMapIdx--;
-                frameBaseIdx -= FRAME_TO_U64_SIZE;
-                while (frameBaseIdx > localStart)
+                if (_pmaRegmapFindNotFullWordReverse(pRegmap, i, &curMapIdx, PAGE_MAPIDX(localStart)))
                 {
                     curMap = pRegmap->map[i][curMapIdx];
-                    if(curMap != NV_U64_MAX)
-                    {
-                        goto free_found;
-                    }
-                    frameBaseIdx -= FRAME_TO_U64_SIZE;
-                    curMapIdx--;
+                    frameBaseIdx = (curMapIdx + 1llu) << FRAME_TO_U64_SHIFT;
+                    goto free_found;
                 }
                 // No more free pages, exit
                 return -1;
@@ -1038,6 +1342,7 @@ _scanDiscontiguousSearchLoop
     // Evictable pages count down from end of array
     NvU64 curEvictPage = numPages;
     NvBool bEvictablePage = NV_FALSE;
+    NvU64 checkedGroup = NV_U64_MAX;
     NvU64 i;
 
     //
@@ -1121,6 +1426,15 @@ loop_begin:
         }
     }
 
+    // Skip the groups that can't hold a whole page of the kind being collected
+    if ((localStride == 0) && (FRAME_TO_GROUP(frameBaseIdx) != checkedGroup))
+    {
+        frameBaseIdx = _pmaRegmapSkipGroups(pRegmap, frameBaseIdx, localEnd, framesPerPage,
+                                            frameAlignment, frameAlignmentPadding,
+                                            curEvictPage > totalFound);
+        checkedGroup = FRAME_TO_GROUP(frameBaseIdx);
+    }
+
     //
     // Always start a loop iteration with an updated frameBaseIdx by ensuring that latestFree is always >= frameBaseIdx
     // frameBaseIdx == latestFree[i] means that there are no observed 0s so far in the current run
@@ -1184,16 +1498,11 @@ loop_begin:
                         goto free_found;
                     }
                     curMapIdx++;
-                    frameBaseIdx += FRAME_TO_U64_SIZE;
-                    while (frameBaseIdx <= localEnd)
+                    if (_pmaRegmapFindNotFullWord(pRegmap, i, &curMapIdx, PAGE_MAPIDX(localEnd)))
                     {
-                        curMap =  pRegmap->map[i][curMapIdx];
-                        if(curMap != NV_U64_MAX)
-                        {
-                            goto free_found;
-                        }
-                        frameBaseIdx += FRAME_TO_U64_SIZE;
-                        curMapIdx++;
+                        curMap = pRegmap->map[i][curMapIdx];
+                        frameBaseIdx = curMapIdx << FRAME_TO_U64_SHIFT;
+                        goto free_found;
                     }
                     // No more free pages, exit
                     *pNumEvictablePages = numPages - curEvictPage;
@@ -1278,6 +1587,7 @@ _scanDiscontiguousSearchLoopReverse
     // Evictable pages count down from end of array
     NvU64 curEvictPage = numPages;
     NvBool bEvictablePage = NV_FALSE;
+    NvU64 checkedGroup = NV_U64_MAX;
     NvU64 i;
 
     for (i = 0; i < PMA_BITS_PER_PAGE; i++)
@@ -1285,6 +1595,14 @@ _scanDiscontiguousSearchLoopReverse
         latestFree[i] = frameBaseIdx;
     }
 loop_begin:
+    // Skip the groups that can't hold a whole page of the kind being collected, 0 ends the search
+    if (FRAME_TO_GROUP(frameBaseIdx - 1llu) != checkedGroup)
+    {
+        frameBaseIdx = _pmaRegmapSkipGroupsReverse(pRegmap, frameBaseIdx, localStart, framesPerPage,
+                                                   frameAlignment, realAlign, curEvictPage > totalFound);
+        checkedGroup = FRAME_TO_GROUP(frameBaseIdx - 1llu);
+    }
+
     //
     // Always start a loop iteration with an updated frameBaseIdx by ensuring that latestFree is always <= frameBaseIdx
     // frameBaseIdx == latestFree[i] means that there are no observed 0s so far in the current run
@@ -1343,17 +1661,11 @@ loop_begin:
                     {
                         goto free_found;
                     }
-                    curMapIdx--;
-                    frameBaseIdx -= 64;
-                    while (frameBaseIdx > localStart)
+                    if (_pmaRegmapFindNotFullWordReverse(pRegmap, i, &curMapIdx, PAGE_MAPIDX(localStart)))
                     {
                         curMap = pRegmap->map[i][curMapIdx];
-                        if(curMap != NV_U64_MAX)
-                        {
-                            goto free_found;
-                        }
-                        frameBaseIdx -= 64;
-                        curMapIdx--;
+                        frameBaseIdx = (curMapIdx + 1llu) << FRAME_TO_U64_SHIFT;
+                        goto free_found;
                     }
 
                     // No more free pages, exit
@@ -1720,8 +2032,31 @@ pmaRegmapGetLargestFree
     while (mapIndex <= mapMaxIndex)
     {
         NvU64 bitmap = pRegmap->map[MAP_IDX_ALLOC_UNPIN][mapIndex] | pRegmap->map[MAP_IDX_ALLOC_PIN][mapIndex];
+        NvU64 groupIdx = WORD_TO_GROUP(mapIndex);
         NvU32 startingPos;
 
+        // A group with no free frames ends the current run
+        if (pRegmap->freeFrames[groupIdx] == 0)
+        {
+            if (mapTrailZeros > regionMaxZeros)
+            {
+                regionMaxZeros = mapTrailZeros;
+                regionMaxZeroStartingOffset = mapIndex * FRAME_TO_U64_SIZE - regionMaxZeros;
+            }
+            mapTrailZeros = 0;
+            mapIndex = GROUP_TO_WORD(groupIdx + 1);
+            continue;
+        }
+
+        // A group with all of its frames free extends the current run
+        if ((mapIndex == GROUP_TO_WORD(groupIdx)) &&
+            (pRegmap->freeFrames[groupIdx] == GROUP_TO_FRAME(1)))
+        {
+            mapTrailZeros += GROUP_TO_FRAME(1);
+            mapIndex = GROUP_TO_WORD(groupIdx + 1);
+            continue;
+        }
+
         // If the last map[] is only partially used, mask the valid bits
         if (mapIndex == mapMaxIndex && (PAGE_BITIDX(pRegmap->totalFrames) != 0))
         {
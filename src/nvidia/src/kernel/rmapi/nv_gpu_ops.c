@@ -5424,6 +5424,33 @@ NV_STATUS nvGpuOpsPmaAllocPages(void *pPma, NvLength pageCount, NvU64 pageSize,
     return status;
 }
 
+ct_assert(sizeof(UvmPmaAllocationOptions) == sizeof(PMA_ALLOCATION_OPTIONS));
+ct_assert(sizeof(UvmPmaAllocationRequest) == sizeof(PMA_ALLOCATION_REQUEST));
+ct_assert(NV_OFFSETOF(UvmPmaAllocationRequest, pageCount) == NV_OFFSETOF(PMA_ALLOCATION_REQUEST, pageCount));
+ct_assert(NV_OFFSETOF(UvmPmaAllocationRequest, pageSize) == NV_OFFSETOF(PMA_ALLOCATION_REQUEST, pageSize));
+ct_assert(NV_OFFSETOF(UvmPmaAllocationRequest, options) == NV_OFFSETOF(PMA_ALLOCATION_REQUEST, options));
+ct_assert(NV_OFFSETOF(UvmPmaAllocationRequest, pPages) == NV_OFFSETOF(PMA_ALLOCATION_REQUEST, pPages));
+ct_assert(NV_OFFSETOF(UvmPmaAllocationRequest, status) == NV_OFFSETOF(PMA_ALLOCATION_REQUEST, status));
+
+NV_STATUS nvGpuOpsPmaAllocPagesBatch(void *pPma,
+                                     gpuPmaAllocationRequest *pRequests,
+                                     NvLength requestCount)
+{
+    NV_STATUS status;
+    THREAD_STATE_NODE threadState;
+
+    if (!pPma || !pRequests)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    threadStateInit(&threadState, THREAD_STATE_FLAGS_NONE);
+
+    // Invoke PMA module to alloc pages for all the requests.
+    status = pmaAllocatePagesBatch((PMA *)pPma, (PMA_ALLOCATION_REQUEST *)pRequests, requestCount);
+
+    threadStateFree(&threadState, THREAD_STATE_FLAGS_NONE);
+    return status;
+}
+
 //
 // When this API is called from UVM as part of PMA eviction, the thread state
 // should have been initialized already and recursive re-init needs to be
@@ -5484,6 +5511,63 @@ void nvGpuOpsPmaFreePages(void *pPma,
         threadStateFree(&threadState, THREAD_STATE_FLAGS_NONE);
 }
 
+void nvGpuOpsPmaFreePagesBatch(void *pPma,
+                               gpuPmaFreeRequest *pRequests,
+                               NvLength requestCount)
+{
+    THREAD_STATE_NODE threadState;
+    PMA_FREE_REQUEST *pPmaRequests;
+    NvLength i;
+
+    if (!pPma || !pRequests || requestCount == 0)
+        return;
+
+    threadStateInit(&threadState, THREAD_STATE_FLAGS_NONE);
+
+    pPmaRequests = portMemAllocNonPaged(requestCount * sizeof(*pPmaRequests));
+    if (pPmaRequests == NULL)
+    {
+        // Freeing can't fail, fall back to one request at a time
+        for (i = 0; i < requestCount; i++)
+        {
+            NvU32 pmaFreeFlag = ((pRequests[i].flags & UVM_PMA_FREE_IS_ZERO) ? PMA_FREE_SKIP_SCRUB : 0);
+
+            if (pRequests[i].flags & UVM_PMA_ALLOCATE_CONTIGUOUS)
+                pmaFreePages((PMA *)pPma, pRequests[i].pPages, 1, pRequests[i].pageCount * pRequests[i].pageSize,
+                             pmaFreeFlag);
+            else
+                pmaFreePages((PMA *)pPma, pRequests[i].pPages, pRequests[i].pageCount, pRequests[i].pageSize,
+                             pmaFreeFlag);
+        }
+        goto done;
+    }
+
+    for (i = 0; i < requestCount; i++)
+    {
+        pPmaRequests[i].pPages = pRequests[i].pPages;
+        pPmaRequests[i].flags = ((pRequests[i].flags & UVM_PMA_FREE_IS_ZERO) ? PMA_FREE_SKIP_SCRUB : 0);
+
+        if (pRequests[i].flags & UVM_PMA_ALLOCATE_CONTIGUOUS)
+        {
+            pPmaRequests[i].pageCount = 1;
+            pPmaRequests[i].size = pRequests[i].pageCount * pRequests[i].pageSize;
+        }
+        else
+        {
+            pPmaRequests[i].pageCount = pRequests[i].pageCount;
+            pPmaRequests[i].size = pRequests[i].pageSize;
+        }
+    }
+
+    // Invoke PMA module to free the pages of all the requests.
+    pmaFreePagesBatch((PMA *)pPma, pPmaRequests, requestCount);
+
+    portMemFree(pPmaRequests);
+
+done:
+    threadStateFree(&threadState, THREAD_STATE_FLAGS_NONE);
+}
+
 static NV_STATUS nvGpuOpsChannelGetHwChannelId(struct gpuChannel *channel,
                                                NvU32 *hwChannelId)
 {
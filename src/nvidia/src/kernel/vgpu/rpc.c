@@ -2039,27 +2039,25 @@ static NV_STATUS _issueRpcAsync(OBJGPU *pGpu, OBJRPC *pRpc)
     return NV_OK;
 }
 
-static NV_STATUS _issueRpcLarge
+/*
+ * Sends a large RPC as its first record followed by as many continuation
+ * records as needed to carry the rest of pBuffer.
+ */
+static NV_STATUS _sendRpcLargeRecords
 (
     OBJGPU *pGpu,
     OBJRPC *pRpc,
     NvU32 bufSize,
     const void *pBuffer,
-    NvBool bBidirectional,
-    NvBool bWait
+    NvU32 *pLastSequence,
+    NvU32 *pRecordCount
 )
 {
     NvU8      *pBuf8         = (NvU8 *)pBuffer;
     NV_STATUS  nvStatus      = NV_OK;
     NvU32      expectedFunc  = vgpu_rpc_message_header_v->function;
-    NvU32      firstSequence = pRpc->sequence;
-    NvU32      lastSequence, waitSequence;
     NvU32      entryLength;
     NvU32      remainingSize = bufSize;
-    NvU32      recordCount   = 0;
-
-    // should not be called in broadcast mode
-    NV_ASSERT_OR_RETURN(!gpumgrGetBcEnabledStatus(pGpu), NV_ERR_INVALID_STATE);
 
     // Copy the initial buffer
     entryLength = NV_MIN(bufSize, pRpc->maxRpcSize);
@@ -2070,7 +2068,7 @@ static NV_STATUS _issueRpcLarge
     // Set the correct length for this queue entry.
     vgpu_rpc_message_header_v->length = entryLength;
 
-    nvStatus = rpcSendMessage(pGpu, pRpc, &lastSequence);
+    nvStatus = rpcSendMessage(pGpu, pRpc, pLastSequence);
     if (nvStatus != NV_OK)
     {
         NV_PRINTF(LEVEL_ERROR, "rpcSendMessage failed with status 0x%08x for fn %d!\n",
@@ -2106,7 +2104,7 @@ static NV_STATUS _issueRpcLarge
         vgpu_rpc_message_header_v->length   = entryLength + sizeof(rpc_message_header_v);
         vgpu_rpc_message_header_v->function = NV_VGPU_MSG_FUNCTION_CONTINUATION_RECORD;
 
-        nvStatus = rpcSendMessage(pGpu, pRpc, &lastSequence);
+        nvStatus = rpcSendMessage(pGpu, pRpc, pLastSequence);
         if (nvStatus != NV_OK)
         {
             NV_PRINTF(LEVEL_ERROR,
@@ -2124,9 +2122,55 @@ static NV_STATUS _issueRpcLarge
 
         remainingSize -= entryLength;
         pBuf8         += entryLength;
-        recordCount++;
+        (*pRecordCount)++;
     }
 
+    return NV_OK;
+}
+
+static NV_STATUS _issueRpcLarge
+(
+    OBJGPU *pGpu,
+    OBJRPC *pRpc,
+    NvU32 bufSize,
+    const void *pBuffer,
+    NvBool bBidirectional,
+    NvBool bWait
+)
+{
+    NvU8      *pBuf8         = (NvU8 *)pBuffer;
+    NV_STATUS  nvStatus      = NV_OK;
+    NvU32      expectedFunc  = vgpu_rpc_message_header_v->function;
+    NvU32      firstSequence = pRpc->sequence;
+    NvU32      lastSequence, waitSequence;
+    NvU32      entryLength;
+    NvU32      remainingSize = bufSize;
+    NvU32      recordCount   = 0;
+
+    // should not be called in broadcast mode
+    NV_ASSERT_OR_RETURN(!gpumgrGetBcEnabledStatus(pGpu), NV_ERR_INVALID_STATE);
+
+    //
+    // On GSP clients, queue the first record and its continuation records as
+    // one batch so that GSP is notified once for the whole RPC.
+    //
+    if (IS_GSP_CLIENT(pGpu))
+        kgspRpcBatchBegin(pGpu, pRpc);
+
+    nvStatus = _sendRpcLargeRecords(pGpu, pRpc, bufSize, pBuffer,
+                                    &lastSequence, &recordCount);
+
+    if (IS_GSP_CLIENT(pGpu))
+    {
+        NV_STATUS batchStatus = kgspRpcBatchEnd(pGpu, pRpc);
+
+        if (nvStatus == NV_OK)
+            nvStatus = batchStatus;
+    }
+
+    if (nvStatus != NV_OK)
+        return nvStatus;
+
     NV_ASSERT(lastSequence == (firstSequence + recordCount));
 
     if (!bWait)
@@ -0,0 +1,316 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Userspace loopback test and benchmark for msgq.
+ *
+ * Links both ends of a queue pair in one process, laid out the way the CPU
+ * and GSP sides link the RPC queues: each end creates its own tx queue with
+ * MSGQ_FLAGS_SWAP_RX and links the other end's as rx. A producer thread
+ * writes messages in batches of 1 to 62, the most the ring holds, and submits
+ * each batch with one msgqTxSubmitBuffers call. A consumer thread drains
+ * everything available per msgqRxSync pass and checks the sequence numbers
+ * and payloads.
+ *
+ * For each batch size it reports messages/sec, write-to-read latency
+ * percentiles, and the tx flush calls and bytes per message, as seen by a
+ * counting flush hook. The flushed bytes should stay at about one element per
+ * message, where flushing the whole ring on every submit would cost the ring
+ * size divided by the batch size.
+ *
+ * Build and run from the top of the tree:
+ *
+ *   cc -O2 -pthread -Isrc/common/sdk/nvidia/inc -Isrc/common/shared/msgq/inc \
+ *     -o /tmp/msgq_loopback_test src/common/shared/msgq/msgq.c \
+ *     tools/msgq_loopback_test/msgq_loopback_test.c
+ *   /tmp/msgq_loopback_test [messages]
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <nvtypes.h>
+#include "msgq/msgq.h"
+
+#define QUEUE_SIZE      0x40000     // 256 KB, as for the RPC queues
+#define MSG_SIZE        4096        // One GSP queue element
+#define HDR_ALIGN       4
+#define ENTRY_ALIGN     12
+#define PAYLOAD_SIZE    256
+
+typedef struct
+{
+    NvU64 seq;
+    NvU64 writeNs;
+    NvU8  payload[PAYLOAD_SIZE];
+} LOOPBACK_MSG;
+
+typedef struct
+{
+    msgqHandle hQueue;
+    void      *pMeta;
+    void      *pTxBuf;
+} LOOPBACK_END;
+
+static LOOPBACK_END producer, consumer;
+static NvU64 numMessages;
+static unsigned batchSize;
+static NvU64 *pLatencies;
+static unsigned failures;
+
+// Only the producer's tx queue counts its flushes
+static NvU64 txFlushCalls;
+static NvU64 txFlushBytes;
+
+static NvU64 nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (NvU64)ts.tv_sec * 1000000000llu + (NvU64)ts.tv_nsec;
+}
+
+static void countingTxFlush(const volatile void *pAddr, unsigned size)
+{
+    txFlushCalls++;
+    txFlushBytes += size;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void fullBarrier(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static void *alignedAlloc(size_t size)
+{
+    void *p = NULL;
+
+    if (posix_memalign(&p, 1 << ENTRY_ALIGN, size) != 0)
+    {
+        return NULL;
+    }
+    memset(p, 0, size);
+    return p;
+}
+
+static int endInit(LOOPBACK_END *pEnd, msgqFcnCacheOp fcnTxFlush)
+{
+    pEnd->pMeta = alignedAlloc(msgqGetMetaSize());
+    pEnd->pTxBuf = alignedAlloc(QUEUE_SIZE);
+    if ((pEnd->pMeta == NULL) || (pEnd->pTxBuf == NULL))
+    {
+        return -1;
+    }
+    if (msgqInit(&pEnd->hQueue, pEnd->pMeta) != 0)
+    {
+        return -1;
+    }
+    msgqSetBarrier(pEnd->hQueue, fullBarrier);
+    if (fcnTxFlush != NULL)
+    {
+        msgqSetTxFlush(pEnd->hQueue, fcnTxFlush);
+    }
+    return msgqTxCreate(pEnd->hQueue, pEnd->pTxBuf, QUEUE_SIZE, MSG_SIZE,
+                        HDR_ALIGN, ENTRY_ALIGN, MSGQ_FLAGS_SWAP_RX);
+}
+
+static void endFree(LOOPBACK_END *pEnd)
+{
+    free(pEnd->pMeta);
+    free(pEnd->pTxBuf);
+}
+
+static int setup(void)
+{
+    if ((endInit(&producer, countingTxFlush) != 0) ||
+        (endInit(&consumer, NULL) != 0))
+    {
+        return -1;
+    }
+    if ((msgqRxLink(consumer.hQueue, producer.pTxBuf, QUEUE_SIZE, MSG_SIZE) != 0) ||
+        (msgqRxLink(producer.hQueue, consumer.pTxBuf, QUEUE_SIZE, MSG_SIZE) != 0))
+    {
+        return -1;
+    }
+    txFlushCalls = 0;
+    txFlushBytes = 0;
+    return 0;
+}
+
+static void *producerThread(void *pArg)
+{
+    NvU64 seq = 0;
+
+    while (seq < numMessages)
+    {
+        unsigned n = (unsigned)((numMessages - seq < batchSize) ? (numMessages - seq) : batchSize);
+        unsigned i;
+
+        while (msgqTxGetFreeSpace(producer.hQueue) < n)
+        {
+            // Let the consumer run when both threads share a CPU
+            if ((unsigned)msgqTxSync(producer.hQueue) < n)
+            {
+                sched_yield();
+            }
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            LOOPBACK_MSG *pMsg = msgqTxGetWriteBuffer(producer.hQueue, i);
+
+            pMsg->seq = seq + i;
+            memset(pMsg->payload, (int)((seq + i) & 0xff), sizeof(pMsg->payload));
+            pMsg->writeNs = nowNs();
+        }
+
+        // Same store ordering that GspMsgQueueSubmitCommands relies on
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        if (msgqTxSubmitBuffers(producer.hQueue, n) != 0)
+        {
+            fprintf(stderr, "msgqTxSubmitBuffers failed at seq %llu\n", seq);
+            failures++;
+            break;
+        }
+        seq += n;
+    }
+    return NULL;
+}
+
+static void *consumerThread(void *pArg)
+{
+    NvU64 expected = 0;
+
+    while (expected < numMessages)
+    {
+        int avail = msgqRxSync(consumer.hQueue);
+        int i;
+
+        if (avail <= 0)
+        {
+            sched_yield();
+            continue;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        for (i = 0; i < avail; i++)
+        {
+            const LOOPBACK_MSG *pMsg = msgqRxGetReadBuffer(consumer.hQueue, i);
+            NvU64 readNs = nowNs();
+
+            if ((pMsg == NULL) || (pMsg->seq != expected) ||
+                (pMsg->payload[PAYLOAD_SIZE - 1] != (NvU8)(expected & 0xff)))
+            {
+                fprintf(stderr, "bad message %d of %d: expected seq %llu\n", i, avail, expected);
+                failures++;
+                return NULL;
+            }
+            pLatencies[expected++] = readNs - pMsg->writeNs;
+        }
+
+        if (msgqRxMarkConsumed(consumer.hQueue, (unsigned)avail) != 0)
+        {
+            fprintf(stderr, "msgqRxMarkConsumed failed\n");
+            failures++;
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static int cmpU64(const void *a, const void *b)
+{
+    NvU64 x = *(const NvU64 *)a, y = *(const NvU64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+static NvU64 percentile(double p)
+{
+    return pLatencies[(NvU64)(p * (double)(numMessages - 1))];
+}
+
+static void runBatch(unsigned batch)
+{
+    pthread_t prodThread, consThread;
+    NvU64 start, elapsed;
+
+    batchSize = batch;
+    if (setup() != 0)
+    {
+        fprintf(stderr, "queue setup failed\n");
+        failures++;
+        return;
+    }
+
+    start = nowNs();
+    pthread_create(&consThread, NULL, consumerThread, NULL);
+    pthread_create(&prodThread, NULL, producerThread, NULL);
+    pthread_join(prodThread, NULL);
+    pthread_join(consThread, NULL);
+    elapsed = nowNs() - start;
+
+    qsort(pLatencies, numMessages, sizeof(NvU64), cmpU64);
+    printf("  batch %2u: %10.0f msgs/sec  latency ns p50 %6llu p90 %6llu p99 %7llu p99.9 %7llu"
+           "  flush %.2f calls %6.0f bytes/msg\n",
+           batch, (double)numMessages * 1e9 / (double)elapsed,
+           percentile(0.50), percentile(0.90), percentile(0.99), percentile(0.999),
+           (double)txFlushCalls / (double)numMessages,
+           (double)txFlushBytes / (double)numMessages);
+
+    endFree(&producer);
+    endFree(&consumer);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned batches[] = { 1, 2, 4, 8, 16, 32, 62 };
+    unsigned i;
+
+    numMessages = (argc > 1) ? strtoull(argv[1], NULL, 0) : 1000000;
+    if (numMessages == 0)
+    {
+        return 1;
+    }
+    pLatencies = calloc(numMessages, sizeof(NvU64));
+    if (pLatencies == NULL)
+    {
+        return 1;
+    }
+
+    printf("msgq loopback, %llu messages of %u bytes in %u byte elements:\n",
+           numMessages, (unsigned)sizeof(LOOPBACK_MSG), MSG_SIZE);
+    for (i = 0; i < sizeof(batches) / sizeof(batches[0]); i++)
+    {
+        runBatch(batches[i]);
+    }
+
+    free(pLatencies);
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
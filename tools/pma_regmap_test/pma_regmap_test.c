@@ -0,0 +1,757 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2026 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Userspace test and benchmark for the PMA regmap.
+ *
+ * Links regmap.c against a shadow array of frame states, and checks the
+ * contiguous and discontiguous scans, the largest free search and the
+ * per-group summary counters against naive scans of the shadow after random
+ * state changes. It then times 2MB and 512MB aligned searches on fragmented
+ * maps, next to the naive scan.
+ *
+ * Finally, several threads allocate and free single frames against one regmap,
+ * either each under a single lock like the PMA lock, or through per-thread
+ * magazines that refill and flush in batches like the NUMA magazines in
+ * numa.c. The harness checks that no frame is handed out twice and reports
+ * the time and the lock acquisitions per operation.
+ *
+ * Build and run from src/nvidia:
+ *
+ *   RMFLAGS="-O2 -DNVRM -DPORT_IS_KERNEL_BUILD=1 -DPORT_IS_CHECKED_BUILD=0 \
+ *     -DPORT_MODULE_memory=1 -DPORT_MODULE_util=1 -DPORT_MODULE_debug=1 \
+ *     -DPORT_MODULE_safe=1 -DPORT_MODULE_string=1 -DPORT_MODULE_atomic=1 \
+ *     -DPORT_MODULE_sync=1 -DPORT_MODULE_cpu=1 -DPORT_MODULE_thread=1 \
+ *     -DPORT_MODULE_crypto=1 -DPORT_MODULE_core=1 \
+ *     -include ../common/sdk/nvidia/inc/cpuopsys.h \
+ *     -Iinc/libraries -Iinc/kernel -Iinc -Iinc/os -Ikernel/inc -Iinterface \
+ *     -Igenerated -I../common/sdk/nvidia/inc -I../common/inc \
+ *     -I../common/shared/inc -Iarch/nvalloc/common/inc \
+ *     -Iarch/nvalloc/unix/include -Isrc/libraries"
+ *   cc $RMFLAGS -pthread -o /tmp/pma_regmap_test \
+ *     src/kernel/gpu/mem_mgr/phys_mem_allocator/regmap.c \
+ *     ../../tools/pma_regmap_test/pma_regmap_test.c
+ *   /tmp/pma_regmap_test [iterations [max threads]]
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gpu/mem_mgr/phys_mem_allocator/regmap.h"
+#include "gpu/mem_mgr/phys_mem_allocator/phys_mem_allocator_util.h"
+#include "utils/nvassert.h"
+#include "nvport/nvport.h"
+
+#define FRAMES_PER_GROUP   4096llu
+#define FRAME_SIZE         (1llu << PMA_PAGE_SHIFT)
+#define FRAMES_2MB         (_PMA_2MB >> PMA_PAGE_SHIFT)
+#define FRAMES_512MB       (_PMA_512MB >> PMA_PAGE_SHIFT)
+
+enum { SHADOW_FREE, SHADOW_UNPIN, SHADOW_PIN };
+
+static PMA_REGMAP *pRegmap;
+static NvU8 *pShadow;
+static NvU64 numFrames;
+static unsigned failures;
+
+//
+// The few RM services regmap.c links against
+//
+void *portMemAllocNonPaged(NvLength lengthBytes)
+{
+    return malloc(lengthBytes);
+}
+
+void portMemFree(void *pData)
+{
+    free(pData);
+}
+
+void *portMemSet(void *pData, NvU8 value, NvLength lengthBytes)
+{
+    return memset(pData, value, lengthBytes);
+}
+
+void nvAssertFailedNoLog(NV_ASSERT_FAILED_FUNC_TYPE)
+{
+    fprintf(stderr, "regmap assert failed\n");
+    failures++;
+}
+
+void nvDbg_Printf(const char *file, int line, const char *function, int debuglevel, const char *s, ...)
+{
+}
+
+#define CHECK(cond, ...)                                         \
+    do                                                           \
+    {                                                            \
+        if (!(cond))                                             \
+        {                                                        \
+            fprintf(stderr, "FAIL %s:%d: ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);                        \
+            fprintf(stderr, "\n");                               \
+            failures++;                                          \
+        }                                                        \
+    } while (0)
+
+static NvU64 rnd(void)
+{
+    static NvU64 x = 0x9e3779b97f4a7c15llu;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+static double nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void setup(NvU64 frames)
+{
+    static PMA_STATS stats;
+
+    memset(&stats, 0, sizeof(stats));
+    numFrames = frames;
+    pRegmap = pmaRegmapInit(frames, 0, &stats, NV_FALSE);
+    pShadow = calloc(frames, 1);
+    if ((pRegmap == NULL) || (pShadow == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+}
+
+static void teardown(void)
+{
+    pmaRegmapDestroy(pRegmap);
+    free(pShadow);
+}
+
+static void setState(NvU64 frame, NvU64 count, NvU8 state)
+{
+    static const PMA_PAGESTATUS toStatus[] = { STATE_FREE, STATE_UNPIN, STATE_PIN };
+
+    if (frame + count > numFrames)
+    {
+        count = numFrames - frame;
+    }
+    pmaRegmapChangeBlockStateAttrib(pRegmap, frame, count, toStatus[state], STATE_MASK);
+    memset(pShadow + frame, state, count);
+}
+
+static NvBool shadowRunOk(NvU64 frame, NvU64 count, NvBool bEvictable)
+{
+    NvU64 i;
+
+    for (i = frame; i < frame + count; i++)
+    {
+        if ((pShadow[i] == SHADOW_PIN) || (!bEvictable && (pShadow[i] != SHADOW_FREE)))
+        {
+            return NV_FALSE;
+        }
+    }
+    return NV_TRUE;
+}
+
+//
+// Naive contiguous scan: lowest (or highest when reversed) aligned start whose
+// frames are all usable.
+//
+static NvS64 naiveContiguous(NvU64 count, NvU64 align, NvBool bEvictable, NvBool bReverse)
+{
+    NvS64 start;
+
+    if (count > numFrames)
+    {
+        return -1;
+    }
+    if (!bReverse)
+    {
+        for (start = 0; (NvU64)start + count <= numFrames; start += align)
+        {
+            if (shadowRunOk(start, count, bEvictable))
+            {
+                return start;
+            }
+        }
+    }
+    else
+    {
+        for (start = ((numFrames - count) / align) * align; start >= 0; start -= align)
+        {
+            if (shadowRunOk(start, count, bEvictable))
+            {
+                return start;
+            }
+        }
+    }
+    return -1;
+}
+
+//
+// Naive discontiguous scan following the regmap conventions: free pages fill
+// the list from the front, evictable pages from the back until the two meet.
+//
+static NvU64 naiveDiscontiguous(NvU64 numPages, NvU64 framesPerPage, NvBool bReverse,
+                                NvU64 *pPages, NvU64 *pNumEvictable)
+{
+    NvU64 lastPage = (numFrames / framesPerPage);
+    NvU64 totalFound = 0;
+    NvU64 curEvictPage = numPages;
+    NvU64 n;
+
+    for (n = 0; n < lastPage; n++)
+    {
+        NvU64 frame = (bReverse ? (lastPage - 1 - n) : n) * framesPerPage;
+
+        if (shadowRunOk(frame, framesPerPage, NV_FALSE))
+        {
+            pPages[totalFound++] = frame;
+            if (totalFound == numPages)
+            {
+                *pNumEvictable = 0;
+                return totalFound;
+            }
+        }
+        else if ((curEvictPage > totalFound) && shadowRunOk(frame, framesPerPage, NV_TRUE))
+        {
+            pPages[--curEvictPage] = frame;
+        }
+    }
+    *pNumEvictable = numPages - curEvictPage;
+    return totalFound;
+}
+
+static void checkSummary(void)
+{
+    NvU64 group;
+
+    for (group = 0; group < pRegmap->groupCount; group++)
+    {
+        NvU64 start = group * FRAMES_PER_GROUP;
+        NvU64 end = NV_MIN(start + FRAMES_PER_GROUP, numFrames);
+        NvU64 free = 0, pinFree = 0;
+        NvU64 i;
+
+        for (i = start; i < end; i++)
+        {
+            free += (pShadow[i] == SHADOW_FREE);
+            pinFree += (pShadow[i] != SHADOW_PIN);
+        }
+        CHECK(pRegmap->freeFrames[group] == free, "group %llu freeFrames %u expected %llu",
+              group, pRegmap->freeFrames[group], free);
+        CHECK(pRegmap->pinFreeFrames[group] == pinFree, "group %llu pinFreeFrames %u expected %llu",
+              group, pRegmap->pinFreeFrames[group], pinFree);
+    }
+}
+
+static void checkContiguous(NvU64 count, NvU64 align, NvBool bReverse)
+{
+    NvS64 expectFree = naiveContiguous(count, align, NV_FALSE, bReverse);
+    NvS64 expectEvict = naiveContiguous(count, align, NV_TRUE, bReverse);
+    NvU64 addr = 0, numAlloc = 0;
+    NV_STATUS status;
+
+    status = pmaRegmapScanContiguous(pRegmap, 0, 0, 0, 1, &addr, count * FRAME_SIZE,
+                                     align * FRAME_SIZE, 0, 0, &numAlloc, NV_FALSE, bReverse);
+    if (expectFree >= 0)
+    {
+        CHECK((status == NV_OK) && (addr == (NvU64)expectFree * FRAME_SIZE),
+              "contig %llu frames align %llu rev %d: status 0x%x frame %llu expected free %lld",
+              count, align, bReverse, status, addr / FRAME_SIZE, expectFree);
+    }
+    else if (expectEvict >= 0)
+    {
+        CHECK((status == NV_ERR_IN_USE) && (addr == (NvU64)expectEvict * FRAME_SIZE),
+              "contig %llu frames align %llu rev %d: status 0x%x frame %llu expected evictable %lld",
+              count, align, bReverse, status, addr / FRAME_SIZE, expectEvict);
+    }
+    else
+    {
+        CHECK(status == NV_ERR_NO_MEMORY, "contig %llu frames align %llu rev %d: status 0x%x expected no memory",
+              count, align, bReverse, status);
+    }
+}
+
+static int cmpU64(const void *a, const void *b)
+{
+    NvU64 x = *(const NvU64 *)a, y = *(const NvU64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void checkDiscontiguous(NvU64 numPages, NvU64 framesPerPage, NvBool bReverse)
+{
+    NvU64 *pPages = calloc(numPages, sizeof(NvU64));
+    NvU64 *pExpect = calloc(numPages, sizeof(NvU64));
+    NvU64 numAlloc = 0, numEvict = 0, freeFound, evictFound, i;
+    NV_STATUS status, expectStatus = NV_OK;
+
+    freeFound = naiveDiscontiguous(numPages, framesPerPage, bReverse, pExpect, &numEvict);
+    evictFound = (freeFound + numEvict > numPages) ? numPages - freeFound : numEvict;
+    if (freeFound + evictFound != numPages)
+    {
+        expectStatus = NV_ERR_NO_MEMORY;
+    }
+    else if (evictFound != 0)
+    {
+        expectStatus = NV_ERR_IN_USE;
+    }
+
+    status = pmaRegmapScanDiscontiguous(pRegmap, 0, 0, 0, numPages, pPages, framesPerPage * FRAME_SIZE,
+                                        framesPerPage * FRAME_SIZE, 0, 0, &numAlloc, NV_FALSE, bReverse);
+
+    CHECK((status == expectStatus) && (numAlloc == freeFound),
+          "discontig %llu x %llu frames rev %d: status 0x%x found %llu expected 0x%x %llu",
+          numPages, framesPerPage, bReverse, status, numAlloc, expectStatus, freeFound);
+    for (i = 0; (i < freeFound) && (i < numAlloc); i++)
+    {
+        CHECK(pPages[i] == pExpect[i] * FRAME_SIZE, "discontig page %llu frame %llu expected %llu",
+              i, pPages[i] / FRAME_SIZE, pExpect[i]);
+    }
+    if ((status == NV_ERR_IN_USE) && (expectStatus == NV_ERR_IN_USE))
+    {
+        for (i = freeFound; i < numPages; i++)
+        {
+            pPages[i] /= FRAME_SIZE;
+        }
+        qsort(pPages + freeFound, evictFound, sizeof(NvU64), cmpU64);
+        qsort(pExpect + numPages - evictFound, evictFound, sizeof(NvU64), cmpU64);
+        CHECK(memcmp(pPages + freeFound, pExpect + numPages - evictFound, evictFound * sizeof(NvU64)) == 0,
+              "discontig %llu x %llu frames rev %d: evictable pages differ", numPages, framesPerPage, bReverse);
+    }
+    free(pPages);
+    free(pExpect);
+}
+
+static void checkLargestFree(void)
+{
+    NvU64 largest = 0, offset = 0, run = 0, expect = 0, i;
+
+    for (i = 0; i < numFrames; i++)
+    {
+        run = (pShadow[i] == SHADOW_FREE) ? run + 1 : 0;
+        expect = NV_MAX(expect, run);
+    }
+    pmaRegmapGetLargestFree(pRegmap, &largest, &offset);
+    CHECK(largest == expect * FRAME_SIZE, "largest free %llu frames expected %llu", largest / FRAME_SIZE, expect);
+    CHECK(shadowRunOk(offset / FRAME_SIZE, largest / FRAME_SIZE, NV_FALSE) &&
+          (offset / FRAME_SIZE + largest / FRAME_SIZE <= numFrames),
+          "largest free offset %llu is not a free run", offset / FRAME_SIZE);
+}
+
+//
+// Random block state changes of mixed sizes, leaving a mix of full, empty and
+// fragmented groups.
+//
+static void randomize(unsigned changes)
+{
+    unsigned i;
+
+    for (i = 0; i < changes; i++)
+    {
+        NvU64 r = rnd();
+        NvU64 count = (r & 3) == 0 ? (rnd() % (FRAMES_PER_GROUP * 2)) + 1 : (rnd() % 40) + 1;
+
+        setState(rnd() % numFrames, count, (NvU8)(rnd() % 3));
+    }
+}
+
+static void runCorrectness(unsigned iterations)
+{
+    static const NvU64 sizes[] = { 1, 2, 16, 32, 33, 100, 4096, 8192 };
+    unsigned iter, i;
+
+    // Not a multiple of the group size, so the last group is partial
+    setup(FRAMES_PER_GROUP * 40 + 1234);
+
+    for (iter = 0; iter < iterations; iter++)
+    {
+        randomize(iter % 2 ? 50 : 400);
+        if ((iter % 8) == 0)
+        {
+            // Occasionally free a wide stretch so that large runs exist
+            setState(rnd() % numFrames, FRAMES_PER_GROUP * 6, SHADOW_FREE);
+        }
+
+        checkSummary();
+        checkLargestFree();
+        for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        {
+            NvU64 align = (sizes[i] & (sizes[i] - 1)) == 0 ? sizes[i] : 1;
+
+            checkContiguous(sizes[i], align, NV_FALSE);
+            checkContiguous(sizes[i], align, NV_TRUE);
+        }
+        checkDiscontiguous(8, FRAMES_2MB, NV_FALSE);
+        checkDiscontiguous(8, FRAMES_2MB, NV_TRUE);
+        checkDiscontiguous(64, 1, NV_FALSE);
+        checkDiscontiguous(3, FRAMES_PER_GROUP, NV_TRUE);
+    }
+
+    teardown();
+}
+
+static void benchContiguous(const char *name, NvU64 count, NvBool bReverse, unsigned reps)
+{
+    NvU64 addr = 0, numAlloc = 0;
+    NV_STATUS status = NV_OK;
+    double t0, tRegmap, tNaive;
+    NvS64 naive = -1;
+    unsigned i;
+
+    t0 = nowNs();
+    for (i = 0; i < reps; i++)
+    {
+        status = pmaRegmapScanContiguous(pRegmap, 0, 0, 0, 1, &addr, count * FRAME_SIZE, count * FRAME_SIZE,
+                                         0, 0, &numAlloc, NV_TRUE, bReverse);
+    }
+    tRegmap = (nowNs() - t0) / reps;
+
+    t0 = nowNs();
+    for (i = 0; i < reps; i++)
+    {
+        naive = naiveContiguous(count, count, NV_FALSE, bReverse);
+    }
+    tNaive = (nowNs() - t0) / reps;
+
+    CHECK((status == NV_OK) == (naive >= 0), "%s: status 0x%x naive %lld", name, status, naive);
+    printf("  %-34s %10.0f ns/scan  (naive %10.0f ns/scan)\n", name, tRegmap, tNaive);
+}
+
+static void runBenchmark(void)
+{
+    NvU64 frame;
+
+    // 64GB of FB
+    setup(1llu << 20);
+
+    //
+    // Every group holds only 16 free frames scattered over its words: no word
+    // or group is full, yet no 2MB page fits until the free tail.
+    //
+    printf("sparse free frames, free tail at the end:\n");
+    setState(0, numFrames, SHADOW_PIN);
+    for (frame = 0; frame < numFrames; frame += 256)
+    {
+        setState(frame + 7, 1, SHADOW_FREE);
+    }
+    setState(numFrames - FRAMES_512MB, FRAMES_512MB, SHADOW_FREE);
+    benchContiguous("2MB forward", FRAMES_2MB, NV_FALSE, 200);
+    benchContiguous("512MB forward", FRAMES_512MB, NV_FALSE, 200);
+    setState(numFrames - FRAMES_512MB, FRAMES_512MB, SHADOW_PIN);
+    setState(0, FRAMES_512MB, SHADOW_FREE);
+    benchContiguous("2MB reverse", FRAMES_2MB, NV_TRUE, 200);
+    benchContiguous("512MB reverse", FRAMES_512MB, NV_TRUE, 200);
+
+    //
+    // Half the frames pinned at random: plenty of 2MB pages' worth of free
+    // frames per group, so the counts can't skip and must not slow the scan.
+    //
+    printf("random half pinned:\n");
+    setState(0, numFrames, SHADOW_FREE);
+    for (frame = 0; frame < numFrames; frame++)
+    {
+        if (rnd() & 1)
+        {
+            setState(frame, 1, SHADOW_PIN);
+        }
+    }
+    benchContiguous("2MB forward (none fit)", FRAMES_2MB, NV_FALSE, 20);
+    benchContiguous("64KB forward", 1, NV_FALSE, 2000);
+
+    teardown();
+}
+
+//
+// Contention benchmark. Each thread repeatedly allocates a burst of up to
+// CONTENTION_LIVE frames and frees them again. A mutex stands in for the PMA
+// spinlock,
+// so that a preempted holder doesn't make the others spin on machines with
+// few CPUs.
+//
+#define CONTENTION_LIVE    32
+#define MAGAZINE_CAPACITY  16
+#define NO_FRAME           (~0llu)
+
+typedef struct
+{
+    pthread_t  thread;
+    unsigned   id;
+    unsigned   ops;
+    NvBool     bMagazine;
+    NvU64      live[CONTENTION_LIVE];
+    NvU64      magazine[MAGAZINE_CAPACITY];
+    unsigned   magazineCount;
+    NvU64      lockAcquires;
+    unsigned   errors;
+    NvU64      seed;
+} CONTENTION_THREAD;
+
+static pthread_mutex_t regmapLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Thread id + 1 of the user of each frame, 0 if the frame is not handed out
+static unsigned *pOwner;
+
+static void contentionLock(CONTENTION_THREAD *pThread)
+{
+    pthread_mutex_lock(&regmapLock);
+    pThread->lockAcquires++;
+}
+
+static void contentionUnlock(void)
+{
+    pthread_mutex_unlock(&regmapLock);
+}
+
+static void regmapSetFrame(NvU64 frame, PMA_PAGESTATUS state)
+{
+    pmaRegmapChangeBlockStateAttrib(pRegmap, frame, 1, state, STATE_MASK);
+}
+
+//
+// Takes up to count free frames from the regmap and pins them. Called with the
+// lock held.
+//
+static unsigned regmapTakeFrames(NvU64 *pFrames, unsigned count)
+{
+    NvU64 numAlloc = 0;
+    unsigned i;
+
+    (void)pmaRegmapScanDiscontiguous(pRegmap, 0, 0, 0, count, pFrames, FRAME_SIZE, FRAME_SIZE,
+                                     0, 0, &numAlloc, NV_TRUE, NV_FALSE);
+    for (i = 0; i < numAlloc; i++)
+    {
+        pFrames[i] /= FRAME_SIZE;
+        regmapSetFrame(pFrames[i], STATE_PIN);
+    }
+    return (unsigned)numAlloc;
+}
+
+static NvU64 contentionAlloc(CONTENTION_THREAD *pThread)
+{
+    NvU64 frame = NO_FRAME;
+
+    if (!pThread->bMagazine)
+    {
+        contentionLock(pThread);
+        if (regmapTakeFrames(&frame, 1) == 0)
+        {
+            frame = NO_FRAME;
+        }
+        contentionUnlock();
+    }
+    else
+    {
+        if (pThread->magazineCount == 0)
+        {
+            // Refill half the magazine per lock acquisition, as numa.c does
+            contentionLock(pThread);
+            pThread->magazineCount = regmapTakeFrames(pThread->magazine, MAGAZINE_CAPACITY / 2);
+            contentionUnlock();
+        }
+        if (pThread->magazineCount > 0)
+        {
+            frame = pThread->magazine[--pThread->magazineCount];
+        }
+    }
+
+    if ((frame != NO_FRAME) && (__atomic_exchange_n(&pOwner[frame], pThread->id + 1, __ATOMIC_RELAXED) != 0))
+    {
+        fprintf(stderr, "FAIL thread %u: frame %llu handed out twice\n", pThread->id, frame);
+        pThread->errors++;
+    }
+    return frame;
+}
+
+static void contentionFree(CONTENTION_THREAD *pThread, NvU64 frame)
+{
+    if (__atomic_exchange_n(&pOwner[frame], 0, __ATOMIC_RELAXED) != pThread->id + 1)
+    {
+        fprintf(stderr, "FAIL thread %u: frame %llu freed by a thread that doesn't own it\n", pThread->id, frame);
+        pThread->errors++;
+    }
+
+    if (!pThread->bMagazine)
+    {
+        contentionLock(pThread);
+        regmapSetFrame(frame, STATE_FREE);
+        contentionUnlock();
+        return;
+    }
+
+    if (pThread->magazineCount == MAGAZINE_CAPACITY)
+    {
+        // Flush the older half of the magazine back to the regmap
+        unsigned i;
+
+        contentionLock(pThread);
+        for (i = 0; i < MAGAZINE_CAPACITY / 2; i++)
+        {
+            regmapSetFrame(pThread->magazine[i], STATE_FREE);
+        }
+        contentionUnlock();
+
+        memmove(pThread->magazine, pThread->magazine + MAGAZINE_CAPACITY / 2,
+                (MAGAZINE_CAPACITY / 2) * sizeof(pThread->magazine[0]));
+        pThread->magazineCount -= MAGAZINE_CAPACITY / 2;
+    }
+    pThread->magazine[pThread->magazineCount++] = frame;
+}
+
+static void *contentionThread(void *pArg)
+{
+    CONTENTION_THREAD *pThread = pArg;
+    unsigned done = 0;
+    unsigned burst, i;
+
+    while (done < pThread->ops)
+    {
+        // rnd() is not thread safe, so each thread has its own xorshift
+        pThread->seed ^= pThread->seed << 13;
+        pThread->seed ^= pThread->seed >> 7;
+        pThread->seed ^= pThread->seed << 17;
+        burst = NV_MIN((unsigned)(pThread->seed % CONTENTION_LIVE) + 1, pThread->ops - done);
+
+        for (i = 0; i < burst; i++)
+        {
+            pThread->live[i] = contentionAlloc(pThread);
+            if (pThread->live[i] == NO_FRAME)
+            {
+                fprintf(stderr, "FAIL thread %u: out of frames\n", pThread->id);
+                pThread->errors++;
+            }
+        }
+        for (i = 0; i < burst; i++)
+        {
+            if (pThread->live[i] != NO_FRAME)
+            {
+                contentionFree(pThread, pThread->live[i]);
+            }
+        }
+        done += burst;
+    }
+
+    contentionLock(pThread);
+    while (pThread->magazineCount > 0)
+    {
+        regmapSetFrame(pThread->magazine[--pThread->magazineCount], STATE_FREE);
+    }
+    contentionUnlock();
+
+    return NULL;
+}
+
+static void contentionRun(unsigned numThreads, unsigned ops, NvBool bMagazine)
+{
+    CONTENTION_THREAD *pThreads = calloc(numThreads, sizeof(*pThreads));
+    NvU64 lockAcquires = 0;
+    double t0, elapsed;
+    unsigned i;
+
+    if (pThreads == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    t0 = nowNs();
+    for (i = 0; i < numThreads; i++)
+    {
+        pThreads[i].id = i;
+        pThreads[i].ops = ops;
+        pThreads[i].bMagazine = bMagazine;
+        pThreads[i].seed = 0x9e3779b97f4a7c15llu * (i + 1);
+        if (pthread_create(&pThreads[i].thread, NULL, contentionThread, &pThreads[i]) != 0)
+        {
+            fprintf(stderr, "pthread_create failed\n");
+            exit(1);
+        }
+    }
+    for (i = 0; i < numThreads; i++)
+    {
+        pthread_join(pThreads[i].thread, NULL);
+        lockAcquires += pThreads[i].lockAcquires;
+        failures += pThreads[i].errors;
+    }
+    elapsed = nowNs() - t0;
+
+    // Every frame went back to the regmap, which the shadow still describes
+    checkSummary();
+    checkLargestFree();
+
+    printf("  %2u threads %-10s %8.0f ns/op  %5.3f lock acquisitions/op\n", numThreads,
+           bMagazine ? "magazine" : "lock", elapsed / ((double)numThreads * ops),
+           (double)lockAcquires / ((double)numThreads * ops));
+    free(pThreads);
+}
+
+static void runContention(unsigned maxThreads, unsigned ops)
+{
+    unsigned numThreads;
+
+    setup(FRAMES_PER_GROUP * 16);
+    pOwner = calloc(numFrames, sizeof(*pOwner));
+    if (pOwner == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    printf("contention, %u alloc/free pairs per thread:\n", ops);
+    for (numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        contentionRun(numThreads, ops, NV_FALSE);
+        contentionRun(numThreads, ops, NV_TRUE);
+    }
+
+    free(pOwner);
+    pOwner = NULL;
+    teardown();
+}
+
+int main(int argc, char **argv)
+{
+    unsigned iterations = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : 200;
+    unsigned maxThreads = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 0) : 8;
+
+    runCorrectness(iterations);
+    printf("correctness: %u iterations, %u failures\n", iterations, failures);
+
+    runBenchmark();
+
+    runContention(maxThreads, 20000);
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}